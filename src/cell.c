@@ -49,6 +49,7 @@
 /* Local headers. */
 #include "engine.h"
 #include "error.h"
+#include "mac_cache.h"
 #include "multipole.h"
 #include "space.h"
 #include "tools.h"
@@ -1422,6 +1423,9 @@ void cell_check_sort_flags(const struct cell *c) {
  * (1) or current data (0)?
  * @param is_tree_walk Are we calling this in the tree walk (1) or for the
  * top-level task construction (0)?
+ *
+ * When the engine holds a #mac_cache, decisions based on the current data
+ * may be re-used from an earlier step.
  */
 int cell_can_use_pair_mm(const struct cell *restrict ci,
                          const struct cell *restrict cj, const struct engine *e,
@@ -1461,6 +1465,11 @@ int cell_can_use_pair_mm(const struct cell *restrict ci,
   }
   const double r2 = dx * dx + dy * dy + dz * dz;
 
+  /* Can we re-use an earlier decision for this pair? */
+  if (!use_rebuild_data && e->mac_cache != NULL)
+    return mac_cache_can_use_pair_mm(e->mac_cache, props, ci, cj, r2, periodic,
+                                     e->ti_current);
+
   return gravity_M2L_accept_symmetric(props, multi_i, multi_j, r2,
                                       use_rebuild_data, periodic);
 }
@@ -27,6 +27,8 @@
 #include <config.h>
 
 /* Includes. */
+#include <float.h>
+#include <math.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
@@ -115,6 +117,14 @@ struct pcell {
     /*! Maximal smoothing length. */
     float h_max;
 
+    /*! Lower corner of the bounding box of the #part at the last rebuild,
+     * relative to the cell's corner. */
+    float bbox_min_rebuild[3];
+
+    /*! Upper corner of the bounding box of the #part at the last rebuild,
+     * relative to the cell's corner. */
+    float bbox_max_rebuild[3];
+
     /*! Minimal integer end-of-timestep in this cell for hydro tasks */
     integertime_t ti_end_min;
 
@@ -346,9 +356,10 @@ enum cell_flags {
   cell_flag_do_hydro_sub_sync = (1UL << 18),
   cell_flag_unskip_self_grav_processed = (1UL << 19),
   cell_flag_unskip_pair_grav_processed = (1UL << 20),
-  cell_flag_skip_rt_sort = (1UL << 21),    /* skip rt_sort after a RT recv? */
-  cell_flag_do_rt_sub_sort = (1UL << 22),  /* same as hydro_sub_sort for RT */
-  cell_flag_rt_requests_sort = (1UL << 23) /* was this sort requested by RT? */
+  cell_flag_skip_rt_sort = (1UL << 21),     /* skip rt_sort after a RT recv? */
+  cell_flag_do_rt_sub_sort = (1UL << 22),   /* same as hydro_sub_sort for RT */
+  cell_flag_rt_requests_sort = (1UL << 23), /* was this sort requested by RT? */
+  cell_flag_fof_moved = (1UL << 24) /* particles to search again in FOF? */
 };
 
 /**
@@ -517,6 +528,11 @@ void cell_split(struct cell *c, ptrdiff_t parts_offset, ptrdiff_t sparts_offset,
                 struct cell_buff *buff, struct cell_buff *sbuff,
                 struct cell_buff *bbuff, struct cell_buff *gbuff,
                 struct cell_buff *sinkbuff);
+void cell_sfc_order_leaf(struct cell *c, const ptrdiff_t parts_offset,
+                         const ptrdiff_t sparts_offset,
+                         const ptrdiff_t bparts_offset,
+                         const ptrdiff_t sinks_offset,
+                         const enum space_sfc_ordering_type ordering);
 void cell_sanitize(struct cell *c, int treated);
 int cell_locktree(struct cell *c);
 void cell_unlocktree(struct cell *c);
@@ -790,6 +806,141 @@ cell_can_recurse_in_pair_hydro_task(const struct cell *c) {
                        c->hydro.dx_max_part_old) < 0.5f * c->dmin);
 }
 
+/**
+ * @brief Store a bounding box of #part relative to the corner of a cell.
+ *
+ * The corners are rounded outwards to single precision, such that the
+ * stored box still holds all the #part. An empty box (min > max) stays
+ * empty.
+ *
+ * @param c The #cell.
+ * @param box_min The lower corner of the box.
+ * @param box_max The upper corner of the box.
+ * @param rel_min (return) The lower corner relative to the cell's corner.
+ * @param rel_max (return) The upper corner relative to the cell's corner.
+ */
+__attribute__((always_inline)) INLINE static void cell_bbox_store(
+    const struct cell *c, const double box_min[3], const double box_max[3],
+    float rel_min[3], float rel_max[3]) {
+
+  for (int k = 0; k < 3; k++) {
+    if (box_min[k] > box_max[k]) {
+      rel_min[k] = FLT_MAX;
+      rel_max[k] = -FLT_MAX;
+    } else {
+      rel_min[k] = nextafterf((float)(box_min[k] - c->loc[k]), -FLT_MAX);
+      rel_max[k] = nextafterf((float)(box_max[k] - c->loc[k]), FLT_MAX);
+    }
+  }
+}
+
+/**
+ * @brief Recover a bounding box of #part stored by cell_bbox_store().
+ *
+ * @param c The #cell.
+ * @param rel_min The lower corner relative to the cell's corner.
+ * @param rel_max The upper corner relative to the cell's corner.
+ * @param box_min (return) The lower corner of the box.
+ * @param box_max (return) The upper corner of the box.
+ */
+__attribute__((always_inline)) INLINE static void cell_bbox_load(
+    const struct cell *c, const float rel_min[3], const float rel_max[3],
+    double box_min[3], double box_max[3]) {
+
+  for (int k = 0; k < 3; k++) {
+    box_min[k] = c->loc[k] + rel_min[k];
+    box_max[k] = c->loc[k] + rel_max[k];
+  }
+}
+
+/**
+ * @brief Square of the distance between two particle bounding boxes.
+ *
+ * @param bi_min The lower corner of the first box.
+ * @param bi_max The upper corner of the first box.
+ * @param bj_min The lower corner of the second box.
+ * @param bj_max The upper corner of the second box.
+ * @param shift The periodic shift to apply to the second box.
+ */
+__attribute__((always_inline)) INLINE static double cell_bbox_dist2(
+    const double bi_min[3], const double bi_max[3], const double bj_min[3],
+    const double bj_max[3], const double shift[3]) {
+
+  double r2 = 0.;
+  for (int k = 0; k < 3; k++) {
+    const double d = max3(0., bj_min[k] + shift[k] - bi_max[k],
+                          bi_min[k] - bj_max[k] - shift[k]);
+    r2 += d * d;
+  }
+  return r2;
+}
+
+/**
+ * @brief Can the progeny pair of a sub-pair hydro task be skipped because
+ * their particles are out of range of each other?
+ *
+ * The particles are within dx_max_part of the bounding box of the last
+ * rebuild.
+ *
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param shift The periodic shift to apply to cj.
+ */
+__attribute__((always_inline)) INLINE static int cell_can_skip_pair_hydro_task(
+    const struct cell *ci, const struct cell *cj, const double shift[3]) {
+
+  /* Note: We use the _old values so that the task activation and the
+   * tasks take the same decision */
+  const double r_max =
+      kernel_gamma * max(ci->hydro.h_max_old, cj->hydro.h_max_old) +
+      ci->hydro.dx_max_part_old + cj->hydro.dx_max_part_old;
+
+  double bi_min[3], bi_max[3], bj_min[3], bj_max[3];
+  cell_bbox_load(ci, ci->hydro.bbox_min_rebuild, ci->hydro.bbox_max_rebuild,
+                 bi_min, bi_max);
+  cell_bbox_load(cj, cj->hydro.bbox_min_rebuild, cj->hydro.bbox_max_rebuild,
+                 bj_min, bj_max);
+  return cell_bbox_dist2(bi_min, bi_max, bj_min, bj_max, shift) >
+         r_max * r_max;
+}
+
+/**
+ * @brief Can the progeny pair of a sub-pair hydro task be skipped by the
+ * task itself?
+ *
+ * On top of the pairs skipped during the activation, the pairs of local
+ * cells drifted to the current time are tested with the bounding boxes of
+ * the drift and the current smoothing lengths.
+ *
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param shift The periodic shift to apply to cj.
+ * @param ti_current The current integer time.
+ * @param nodeID The ID of this node.
+ */
+__attribute__((always_inline)) INLINE static int
+cell_can_skip_drifted_pair_hydro_task(const struct cell *ci,
+                                      const struct cell *cj,
+                                      const double shift[3],
+                                      const integertime_t ti_current,
+                                      const int nodeID) {
+
+  if (cell_can_skip_pair_hydro_task(ci, cj, shift)) return 1;
+
+  if (ci->nodeID != nodeID || cj->nodeID != nodeID) return 0;
+  if (ci->hydro.ti_old_part != ti_current ||
+      cj->hydro.ti_old_part != ti_current)
+    return 0;
+
+  const double r_max = kernel_gamma * max(ci->hydro.h_max, cj->hydro.h_max);
+
+  double bi_min[3], bi_max[3], bj_min[3], bj_max[3];
+  cell_bbox_load(ci, ci->hydro.bbox_min, ci->hydro.bbox_max, bi_min, bi_max);
+  cell_bbox_load(cj, cj->hydro.bbox_min, cj->hydro.bbox_max, bj_min, bj_max);
+  return cell_bbox_dist2(bi_min, bi_max, bj_min, bj_max, shift) >
+         r_max * r_max;
+}
+
 /**
  * @brief Can a sub-self hydro task recurse to a lower level based
  * on the status of the particles in the cell.
@@ -1183,6 +1334,7 @@ __attribute__((always_inline)) INLINE static void cell_malloc_hydro_sorts(
       } else if (flags & (1 << j)) {
         ++to;
         c->hydro.sort_allocated |= (1 << j);
+        c->hydro.sort_reusable &= ~(1 << j);
       }
     }
 
@@ -1193,6 +1345,7 @@ __attribute__((always_inline)) INLINE static void cell_malloc_hydro_sorts(
   } else {
 
     c->hydro.sort_allocated = flags;
+    c->hydro.sort_reusable = 0;
 
     /* Start by counting how many dimensions we need */
     const int num_arrays = intrinsics_popcount(flags);
@@ -1222,6 +1375,7 @@ __attribute__((always_inline)) INLINE static void cell_free_hydro_sorts(
     swift_free("hydro.sort", c->hydro.sort);
     c->hydro.sort = NULL;
     c->hydro.sort_allocated = 0;
+    c->hydro.sort_reusable = 0;
   }
 #endif
 }
@@ -1438,6 +1592,74 @@ __attribute__((always_inline)) INLINE static struct task *cell_get_recv(
 #endif
 }
 
+/**
+ * @brief Find the leaf of a cell hierarchy holding a given #part.
+ *
+ * @param c The #cell containing the particle.
+ * @param p The #part.
+ */
+__attribute__((always_inline)) INLINE static struct cell *cell_get_part_leaf(
+    struct cell *c, const struct part *p) {
+
+  while (c->split) {
+    struct cell *next = NULL;
+    for (int k = 0; k < 8; k++) {
+      struct cell *cp = c->progeny[k];
+      if (cp != NULL && p >= cp->hydro.parts &&
+          p < cp->hydro.parts + cp->hydro.count) {
+        next = cp;
+        break;
+      }
+    }
+#ifdef SWIFT_DEBUG_CHECKS
+    if (next == NULL) error("Particle not found in any of the progeny!");
+#endif
+    if (next == NULL) break;
+    c = next;
+  }
+  return c;
+}
+
+/**
+ * @brief Record a #part woken up by the time-step limiter in the list of
+ * candidates of its leaf.
+ *
+ * The limiter task then only looks at the recorded particles. If the list
+ * overflows, or the leaf has none, the task reverts to a scan of the whole
+ * leaf.
+ *
+ * @param c The local #cell containing the particle.
+ * @param p The #part.
+ */
+__attribute__((always_inline)) INLINE static void cell_add_limiter_candidate(
+    struct cell *c, const struct part *p) {
+
+  struct cell *leaf = cell_get_part_leaf(c, p);
+  struct cell_hydro_candidates *list = leaf->hydro.candidates;
+  if (list == NULL) return;
+
+  const int n = atomic_inc(&list->limiter_count);
+  if (n < cell_hydro_max_candidates) list->limiter[n] = p - leaf->hydro.parts;
+}
+
+/**
+ * @brief Record a #part flagged for synchronization in the list of
+ * candidates of its leaf.
+ *
+ * @param c The local #cell containing the particle.
+ * @param p The #part.
+ */
+__attribute__((always_inline)) INLINE static void cell_add_sync_candidate(
+    struct cell *c, const struct part *p) {
+
+  struct cell *leaf = cell_get_part_leaf(c, p);
+  struct cell_hydro_candidates *list = leaf->hydro.candidates;
+  if (list == NULL) return;
+
+  const int n = atomic_inc(&list->sync_count);
+  if (n < cell_hydro_max_candidates) list->sync[n] = p - leaf->hydro.parts;
+}
+
 /**
  * @brief Generate the cell ID for top level cells. Only used for debugging.
  *
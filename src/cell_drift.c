@@ -22,6 +22,9 @@
 /* Config parameters. */
 #include <config.h>
 
+/* Some standard headers. */
+#include <float.h>
+
 /* This object's header. */
 #include "cell.h"
 
@@ -175,6 +178,8 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
   float dx_max_sort = 0.0f, dx2_max_sort = 0.f;
   float cell_h_max = 0.f;
   float cell_h_max_active = 0.f;
+  double bbox_min[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
+  double bbox_max[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
 
   /* Drift irrespective of cell flags? */
   force = (force || cell_get_flag(c, cell_flag_do_hydro_drift));
@@ -224,6 +229,15 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
         dx_max_sort = max(dx_max_sort, cp->hydro.dx_max_sort);
         cell_h_max = max(cell_h_max, cp->hydro.h_max);
         cell_h_max_active = max(cell_h_max_active, cp->hydro.h_max_active);
+        if (cp->hydro.count > 0) {
+          double cp_min[3], cp_max[3];
+          cell_bbox_load(cp, cp->hydro.bbox_min, cp->hydro.bbox_max, cp_min,
+                         cp_max);
+          for (int i = 0; i < 3; i++) {
+            bbox_min[i] = min(bbox_min[i], cp_min[i]);
+            bbox_max[i] = max(bbox_max[i], cp_max[i]);
+          }
+        }
       }
     }
 
@@ -232,6 +246,8 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
     c->hydro.h_max_active = cell_h_max_active;
     c->hydro.dx_max_part = dx_max;
     c->hydro.dx_max_sort = dx_max_sort;
+    cell_bbox_store(c, bbox_min, bbox_max, c->hydro.bbox_min,
+                    c->hydro.bbox_max);
 
     /* Update the time of the last drift */
     c->hydro.ti_old_part = ti_current;
@@ -345,6 +361,12 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
       /* Update the maximal smoothing length in the cell */
       cell_h_max = max(cell_h_max, p->h);
 
+      /* Update the bounding box of the cell */
+      for (int i = 0; i < 3; i++) {
+        bbox_min[i] = min(bbox_min[i], p->x[i]);
+        bbox_max[i] = max(bbox_max[i], p->x[i]);
+      }
+
       /* Mark the particle has not being swallowed */
       black_holes_mark_part_as_not_swallowed(&p->black_holes_data);
 
@@ -387,6 +409,8 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
     c->hydro.h_max_active = cell_h_max_active;
     c->hydro.dx_max_part = dx_max;
     c->hydro.dx_max_sort = dx_max_sort;
+    cell_bbox_store(c, bbox_min, bbox_max, c->hydro.bbox_min,
+                    c->hydro.bbox_max);
 
     /* Update the time of the last drift */
     c->hydro.ti_old_part = ti_current;
@@ -28,6 +28,37 @@
 #include "lock.h"
 #include "timeline.h"
 
+/* Forward declarations */
+struct hydro_nlist;
+
+/*! Number of wake-up and sync candidates a leaf cell can record before its
+ * time-step limiter and sync tasks fall back to a scan of all its #part */
+#define cell_hydro_max_candidates 16
+
+/**
+ * @brief The #part of a leaf cell flagged by the time-step limiter and by
+ * the synchronization.
+ *
+ * Only the local leaves holding #part get one. They live in an array of the
+ * #space refilled at every rebuild.
+ */
+struct cell_hydro_candidates {
+
+  /*! Offsets of the #part of the leaf woken up by the limiter loop */
+  int limiter[cell_hydro_max_candidates];
+
+  /*! Offsets of the #part of the leaf flagged for synchronization */
+  int sync[cell_hydro_max_candidates];
+
+  /*! Number of #part recorded in limiter (can exceed the size of the array,
+   * in which case the list is incomplete) */
+  int limiter_count;
+
+  /*! Number of #part recorded in sync (can exceed the size of the array, in
+   * which case the list is incomplete) */
+  int sync_count;
+};
+
 /**
  * @brief Hydro-related cell variables.
  */
@@ -124,6 +155,22 @@ struct cell_hydro {
     /*! Values of dx_max_sort before the drifts, used for sub-cell tasks. */
     float dx_max_sort_old;
 
+    /*! Lower corner of the bounding box of the #part at the last rebuild,
+     * relative to loc (see cell_bbox_store()). */
+    float bbox_min_rebuild[3];
+
+    /*! Upper corner of the bounding box of the #part at the last rebuild,
+     * relative to loc (see cell_bbox_store()). */
+    float bbox_max_rebuild[3];
+
+    /*! Lower corner of the bounding box of the #part at the last drift,
+     * relative to loc (see cell_bbox_store()). */
+    float bbox_min[3];
+
+    /*! Upper corner of the bounding box of the #part at the last drift,
+     * relative to loc (see cell_bbox_store()). */
+    float bbox_max[3];
+
     /*! Nr of #part this cell can hold after addition of new #part. */
     int count_total;
 
@@ -139,6 +186,25 @@ struct cell_hydro {
     /*! Bit-mask indicating the sorted directions */
     uint16_t sort_allocated;
 
+    /*! Bit-mask of the allocated sort arrays holding a complete, possibly
+     * outdated, ordering of the particles */
+    uint16_t sort_reusable;
+
+    /*! Neighbour lists of the pairs in which this cell is the first cell and
+     * of the cell itself (see hydro_nlist.h) */
+    struct hydro_nlist *nlists;
+
+    /*! Engine launch during which the neighbour lists were built */
+    int nlist_epoch;
+
+    /*! Engine launch during which a smoothing length of this cell grew
+     * beyond the skin of the neighbour lists */
+    int nlist_invalid_epoch;
+
+    /*! Wake-up and sync candidates of this leaf (NULL if it has none, in
+     * which case the limiter and sync tasks scan all its #part) */
+    struct cell_hydro_candidates *candidates;
+
 #ifdef SWIFT_DEBUG_CHECKS
 
     /*! Last (integer) time the cell's sort arrays were updated. */
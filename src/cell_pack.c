@@ -42,6 +42,10 @@ int cell_pack(struct cell *restrict c, struct pcell *restrict pc,
 
   /* Start by packing the data of the current cell. */
   pc->hydro.h_max = c->hydro.h_max;
+  for (int k = 0; k < 3; k++) {
+    pc->hydro.bbox_min_rebuild[k] = c->hydro.bbox_min_rebuild[k];
+    pc->hydro.bbox_max_rebuild[k] = c->hydro.bbox_max_rebuild[k];
+  }
   pc->stars.h_max = c->stars.h_max;
   pc->black_holes.h_max = c->black_holes.h_max;
   pc->sinks.r_cut_max = c->sinks.r_cut_max;
@@ -244,6 +248,12 @@ int cell_unpack(struct pcell *restrict pc, struct cell *restrict c,
 
   /* Unpack the current pcell. */
   c->hydro.h_max = pc->hydro.h_max;
+  for (int k = 0; k < 3; k++) {
+    c->hydro.bbox_min_rebuild[k] = pc->hydro.bbox_min_rebuild[k];
+    c->hydro.bbox_max_rebuild[k] = pc->hydro.bbox_max_rebuild[k];
+    c->hydro.bbox_min[k] = pc->hydro.bbox_min_rebuild[k];
+    c->hydro.bbox_max[k] = pc->hydro.bbox_max_rebuild[k];
+  }
   c->stars.h_max = pc->stars.h_max;
   c->black_holes.h_max = pc->black_holes.h_max;
   c->sinks.r_cut_max = pc->sinks.r_cut_max;
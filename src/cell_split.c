@@ -22,12 +22,19 @@
 /* Config parameters. */
 #include <config.h>
 
+/* Some standard headers. */
+#include <stdlib.h>
+
 /* This object's header. */
 #include "cell.h"
 
 /* Local headers. */
 #include "memswap.h"
 
+/*! Number of bits per dimension of the keys of the space-filling curves used
+ * to order the particles within the leaves */
+#define cell_sfc_key_bits 10
+
 /**
  * @brief Sort the parts into eight bins along the given pivots.
  *
@@ -462,6 +469,216 @@ void cell_split(struct cell *c, const ptrdiff_t parts_offset,
   }
 }
 
+/**
+ * @brief Spread the lowest 10 bits of an integer such that there are two
+ * zero bits between each of them.
+ *
+ * @param v The integer to spread.
+ */
+__attribute__((always_inline, const)) INLINE static uint32_t
+cell_sfc_spread_bits(uint32_t v) {
+
+  v &= 0x3ff;
+  v = (v | (v << 16)) & 0x030000ff;
+  v = (v | (v << 8)) & 0x0300f00f;
+  v = (v | (v << 4)) & 0x030c30c3;
+  v = (v | (v << 2)) & 0x09249249;
+  return v;
+}
+
+/**
+ * @brief Compute the key of a position along a space-filling curve covering
+ * a #cell.
+ *
+ * The cell is discretised into 2^10 intervals along each axis. The Hilbert
+ * key is obtained from the coordinates with Skilling's transposition (AIP
+ * Conf. Proc. 707, 381, 2004) before the bits are interleaved.
+ *
+ * @param loc The lower corner of the #cell.
+ * @param width The width of the #cell.
+ * @param x The position.
+ * @param ordering The #space_sfc_ordering_type of the curve.
+ */
+__attribute__((always_inline)) INLINE static uint32_t cell_sfc_key(
+    const double loc[3], const double width[3], const double x[3],
+    const enum space_sfc_ordering_type ordering) {
+
+  const int bits = cell_sfc_key_bits;
+  const uint32_t max_coord = (1u << bits) - 1;
+
+  /* Integer coordinates within the cell */
+  uint32_t X[3];
+  for (int k = 0; k < 3; k++) {
+    const double u = (x[k] - loc[k]) / width[k];
+    if (u <= 0.)
+      X[k] = 0;
+    else if (u >= 1.)
+      X[k] = max_coord;
+    else
+      X[k] = min((uint32_t)(u * (max_coord + 1)), max_coord);
+  }
+
+  if (ordering == space_sfc_ordering_hilbert) {
+
+    /* Inverse undo */
+    for (uint32_t Q = 1u << (bits - 1); Q > 1; Q >>= 1) {
+      const uint32_t P = Q - 1;
+      for (int k = 0; k < 3; k++) {
+        if (X[k] & Q) {
+          X[0] ^= P;
+        } else {
+          const uint32_t t = (X[0] ^ X[k]) & P;
+          X[0] ^= t;
+          X[k] ^= t;
+        }
+      }
+    }
+
+    /* Gray encode */
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    uint32_t t = 0;
+    for (uint32_t Q = 1u << (bits - 1); Q > 1; Q >>= 1)
+      if (X[2] & Q) t ^= Q - 1;
+    X[0] ^= t;
+    X[1] ^= t;
+    X[2] ^= t;
+  }
+
+  return (cell_sfc_spread_bits(X[0]) << 2) |
+         (cell_sfc_spread_bits(X[1]) << 1) | cell_sfc_spread_bits(X[2]);
+}
+
+/**
+ * @brief A particle's key along the space-filling curve and its index.
+ */
+struct cell_sfc_entry {
+  uint32_t key;
+  int index;
+};
+
+/**
+ * @brief Comparison function for the qsort call ordering #cell_sfc_entry by
+ * key. Equal keys keep their original order.
+ */
+static int cell_sfc_entry_compare(const void *a, const void *b) {
+  const struct cell_sfc_entry *ea = (const struct cell_sfc_entry *)a;
+  const struct cell_sfc_entry *eb = (const struct cell_sfc_entry *)b;
+  if (ea->key != eb->key) return (ea->key < eb->key) ? -1 : 1;
+  return ea->index - eb->index;
+}
+
+/**
+ * @brief Compute, for each particle of a leaf, its position along a
+ * space-filling curve.
+ *
+ * @param c The #cell.
+ * @param x The positions of the particles (as the first member of
+ *        structures of size @c stride).
+ * @param stride The size of the particle structure.
+ * @param count The number of particles.
+ * @param ordering The #space_sfc_ordering_type of the curve.
+ * @param entries Buffer of at least @c count entries.
+ * @param dest (return) The new index of each particle.
+ */
+static void cell_sfc_destinations(const struct cell *c, const char *x,
+                                  const size_t stride, const int count,
+                                  const enum space_sfc_ordering_type ordering,
+                                  struct cell_sfc_entry *entries, int *dest) {
+
+  for (int k = 0; k < count; k++) {
+    entries[k].key = cell_sfc_key(
+        c->loc, c->width, (const double *)(x + k * stride), ordering);
+    entries[k].index = k;
+  }
+  qsort(entries, count, sizeof(struct cell_sfc_entry), cell_sfc_entry_compare);
+  for (int k = 0; k < count; k++) dest[entries[k].index] = k;
+}
+
+/**
+ * @brief Order the particles of a leaf #cell along a space-filling curve.
+ *
+ * The #part and #xpart are permuted together, as are the #gpart, and the
+ * links between the #gpart and the other particle types are restored.
+ * Must be called before any of the leaf's sorts are built.
+ *
+ * @param c The leaf #cell.
+ * @param parts_offset Offset of the cell parts array relative to the
+ *        space's parts array, i.e. c->hydro.parts - s->parts.
+ * @param sparts_offset Offset of the cell sparts array relative to the
+ *        space's sparts array, i.e. c->stars.parts - s->stars.parts.
+ * @param bparts_offset Offset of the cell bparts array relative to the
+ *        space's bparts array, i.e. c->black_holes.parts -
+ *        s->black_holes.parts.
+ * @param sinks_offset Offset of the cell sink array relative to the
+ *        space's sink array, i.e. c->sinks.parts - s->sinks.parts.
+ * @param ordering The #space_sfc_ordering_type of the curve.
+ */
+void cell_sfc_order_leaf(struct cell *c, const ptrdiff_t parts_offset,
+                         const ptrdiff_t sparts_offset,
+                         const ptrdiff_t bparts_offset,
+                         const ptrdiff_t sinks_offset,
+                         const enum space_sfc_ordering_type ordering) {
+
+  const int count = c->hydro.count, gcount = c->grav.count;
+  struct part *parts = c->hydro.parts;
+  struct xpart *xparts = c->hydro.xparts;
+  struct gpart *gparts = c->grav.parts;
+
+  if (ordering == space_sfc_ordering_none) return;
+  if (count < 2 && gcount < 2) return;
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (c->split) error("Ordering the particles of a split cell!");
+#endif
+
+  const int max_count = max(count, gcount);
+  struct cell_sfc_entry *entries =
+      (struct cell_sfc_entry *)malloc(sizeof(struct cell_sfc_entry) * max_count);
+  int *dest = (int *)malloc(sizeof(int) * max_count);
+  if (entries == NULL || dest == NULL)
+    error("Failed to allocate space-filling curve buffers.");
+
+  /* Move the parts and xparts to their place along the curve. */
+  if (count > 1) {
+    cell_sfc_destinations(c, (const char *)parts[0].x, sizeof(struct part),
+                          count, ordering, entries, dest);
+    for (int k = 0; k < count; k++) {
+      while (dest[k] != k) {
+        const int j = dest[k];
+        memswap(&parts[k], &parts[j], sizeof(struct part));
+        memswap(&xparts[k], &xparts[j], sizeof(struct xpart));
+        dest[k] = dest[j];
+        dest[j] = j;
+      }
+    }
+    part_relink_gparts_to_parts(parts, count, parts_offset);
+  }
+
+  /* Move the gparts to their place along the curve. */
+  if (gcount > 1) {
+    cell_sfc_destinations(c, (const char *)gparts[0].x, sizeof(struct gpart),
+                          gcount, ordering, entries, dest);
+    for (int k = 0; k < gcount; k++) {
+      while (dest[k] != k) {
+        const int j = dest[k];
+        memswap_unaligned(&gparts[k], &gparts[j], sizeof(struct gpart));
+        dest[k] = dest[j];
+        dest[j] = j;
+      }
+    }
+    part_relink_parts_to_gparts(gparts, gcount, parts - parts_offset);
+    part_relink_sparts_to_gparts(gparts, gcount,
+                                 c->stars.parts - sparts_offset);
+    part_relink_bparts_to_gparts(gparts, gcount,
+                                 c->black_holes.parts - bparts_offset);
+    part_relink_sinks_to_gparts(gparts, gcount, c->sinks.parts - sinks_offset);
+  }
+
+  free(entries);
+  free(dest);
+}
+
 /**
  * @brief Re-arrange the #part in a top-level cell such that all the extra
  * ones for on-the-fly creation are located at the end of the array.
@@ -791,6 +791,35 @@ void cell_activate_stars_sorts(struct cell *c, int sid, struct scheduler *s) {
   }
 }
 
+/**
+ * @brief Can the progeny pair of a sub-pair hydro task be skipped during the
+ * activation?
+ *
+ * The values the tasks will test are stored first, so that they take the
+ * same decision even if the pair is never visited.
+ *
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param s The task #scheduler.
+ * @param shift The periodic shift to apply to cj.
+ */
+static int cell_activate_can_skip_hydro_pair(struct cell *ci, struct cell *cj,
+                                             struct scheduler *s,
+                                             const double shift[3]) {
+
+  /* Store the current dx_max and h_max values. */
+  ci->hydro.dx_max_part_old = ci->hydro.dx_max_part;
+  ci->hydro.h_max_old = ci->hydro.h_max;
+  cj->hydro.dx_max_part_old = cj->hydro.dx_max_part;
+  cj->hydro.h_max_old = cj->hydro.h_max;
+
+  if (cell_can_skip_pair_hydro_task(ci, cj, shift)) {
+    atomic_inc(&s->nr_culled_subpairs);
+    return 1;
+  }
+  return 0;
+}
+
 /**
  * @brief Traverse a sub-cell task and activate the hydro drift tasks that are
  * required by a hydro task
@@ -822,14 +851,19 @@ void cell_activate_subcell_hydro_tasks(struct cell *ci, struct cell *cj,
     /* Recurse? */
     if (cell_can_recurse_in_self_hydro_task(ci)) {
       /* Loop over all progenies and pairs of progenies */
+      const double shift[3] = {0., 0., 0.};
       for (int j = 0; j < 8; j++) {
         if (ci->progeny[j] != NULL) {
           cell_activate_subcell_hydro_tasks(ci->progeny[j], NULL, s,
                                             with_timestep_limiter);
-          for (int k = j + 1; k < 8; k++)
-            if (ci->progeny[k] != NULL)
-              cell_activate_subcell_hydro_tasks(ci->progeny[j], ci->progeny[k],
-                                                s, with_timestep_limiter);
+          for (int k = j + 1; k < 8; k++) {
+            if (ci->progeny[k] == NULL) continue;
+            if (cell_activate_can_skip_hydro_pair(ci->progeny[j],
+                                                  ci->progeny[k], s, shift))
+              continue;
+            cell_activate_subcell_hydro_tasks(ci->progeny[j], ci->progeny[k],
+                                              s, with_timestep_limiter);
+          }
         }
       }
     } else {
@@ -856,9 +890,13 @@ void cell_activate_subcell_hydro_tasks(struct cell *ci, struct cell *cj,
       for (int k = 0; k < csp->count; k++) {
         const int pid = csp->pairs[k].pid;
         const int pjd = csp->pairs[k].pjd;
-        if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL)
+        if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL) {
+          if (cell_activate_can_skip_hydro_pair(ci->progeny[pid],
+                                                cj->progeny[pjd], s, shift))
+            continue;
           cell_activate_subcell_hydro_tasks(ci->progeny[pid], cj->progeny[pjd],
                                             s, with_timestep_limiter);
+        }
       }
     }
 
@@ -1565,13 +1603,18 @@ void cell_activate_subcell_rt_tasks(struct cell *ci, struct cell *cj,
     /* Recurse? */
     if (cell_can_recurse_in_self_hydro_task(ci)) {
       /* Loop over all progenies and pairs of progenies */
+      const double shift[3] = {0., 0., 0.};
       for (int j = 0; j < 8; j++) {
         if (ci->progeny[j] != NULL) {
           cell_activate_subcell_rt_tasks(ci->progeny[j], NULL, s, sub_cycle);
-          for (int k = j + 1; k < 8; k++)
-            if (ci->progeny[k] != NULL)
-              cell_activate_subcell_rt_tasks(ci->progeny[j], ci->progeny[k], s,
-                                             sub_cycle);
+          for (int k = j + 1; k < 8; k++) {
+            if (ci->progeny[k] == NULL) continue;
+            if (cell_activate_can_skip_hydro_pair(ci->progeny[j],
+                                                  ci->progeny[k], s, shift))
+              continue;
+            cell_activate_subcell_rt_tasks(ci->progeny[j], ci->progeny[k], s,
+                                           sub_cycle);
+          }
         }
       }
     }
@@ -1595,9 +1638,13 @@ void cell_activate_subcell_rt_tasks(struct cell *ci, struct cell *cj,
       for (int k = 0; k < csp->count; k++) {
         const int pid = csp->pairs[k].pid;
         const int pjd = csp->pairs[k].pjd;
-        if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL)
+        if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL) {
+          if (cell_activate_can_skip_hydro_pair(ci->progeny[pid],
+                                                cj->progeny[pjd], s, shift))
+            continue;
           cell_activate_subcell_rt_tasks(ci->progeny[pid], cj->progeny[pjd], s,
                                          sub_cycle);
+        }
       }
     }
 
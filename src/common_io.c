@@ -834,6 +834,7 @@ void io_write_part_type_names(hid_t h_grp) {
   /* Create an array of partcle type names */
   const int name_length = 128;
   char names[swift_type_count][name_length];
+  bzero(names, sizeof(names));
   for (int i = 0; i < swift_type_count; ++i)
     strcpy(names[i], part_type_names[i]);
 
@@ -47,6 +47,7 @@
 #include "hydro_io.h"
 #include "hydro_properties.h"
 #include "io_compression.h"
+#include "io_parallel_compression.h"
 #include "io_properties.h"
 #include "memuse.h"
 #include "output_list.h"
@@ -80,6 +81,7 @@ static const int io_max_size_output_list = 100;
  * @param lossy_compression Level of lossy compression to use for this field.
  * @param internal_units The #unit_system used internally
  * @param snapshot_units The #unit_system used in the snapshots
+ * @param stats (return) The #io_write_stats to update.
  *
  * @todo A better version using HDF5 hyper-slabs to write the file directly from
  * the part array will be written once the structures have been stabilized.
@@ -89,7 +91,7 @@ void write_distributed_array(
     const char* partTypeGroupName, const struct io_props props, const size_t N,
     const enum lossy_compression_schemes lossy_compression,
     const struct unit_system* internal_units,
-    const struct unit_system* snapshot_units) {
+    const struct unit_system* snapshot_units, struct io_write_stats* stats) {
 
 #ifdef IO_SPEED_MEASUREMENT
   const ticks tic_total = getticks();
@@ -111,7 +113,10 @@ void write_distributed_array(
 #endif
 
   /* Copy the particle data to the temporary buffer */
+  ticks tic_stage = getticks();
   io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+  stats->convert_ticks += getticks() - tic_stage;
+  stats->converted_bytes += num_elements * typeSize;
 
 #ifdef IO_SPEED_MEASUREMENT
   if (engine_rank == IO_SPEED_MEASUREMENT || IO_SPEED_MEASUREMENT == -1)
@@ -129,9 +134,23 @@ void write_distributed_array(
   if (h_space < 0)
     error("Error while creating data space for field '%s'.", props.name);
 
+  /* Can we run the lossless filters ourselves, in parallel over the chunks,
+   * rather than leave them to HDF5? */
+  int parallel_compression = 0;
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+  parallel_compression = N > 0 && e->snapshot_compression > 0 &&
+                         lossy_compression == compression_write_lossless;
+#endif
+
   /* Decide what chunk size to use based on compression */
   int log2_chunk_size = 20;
 
+  /* Use smaller chunks if there are not enough to keep all threads busy. */
+  if (parallel_compression)
+    while (log2_chunk_size > 16 &&
+           (N >> log2_chunk_size) < (size_t)(4 * e->threadpool.num_threads))
+      log2_chunk_size--;
+
   int rank;
   hsize_t shape[2];
   hsize_t chunk_shape[2];
@@ -208,10 +227,42 @@ void write_distributed_array(
   tic = getticks();
 #endif
 
-  /* Write temporary buffer to HDF5 dataspace */
-  h_err = H5Dwrite(h_data, io_hdf5_type(props.type), h_space, H5S_ALL,
-                   H5P_DEFAULT, temp);
-  if (h_err < 0) error("Error while writing data array '%s'.", props.name);
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+  /* Compress the chunks and release the uncompressed data. */
+  struct io_compressed_dataset compressed = {NULL, 0, 0, 0};
+  if (parallel_compression) {
+    tic_stage = getticks();
+    io_parallel_compress((struct threadpool*)&e->threadpool, temp, N,
+                         props.dimension, typeSize, chunk_shape[0],
+                         e->snapshot_compression, &compressed);
+    stats->compress_ticks += getticks() - tic_stage;
+    stats->compressed_in_bytes += compressed.raw_bytes;
+    stats->compressed_out_bytes += compressed.compressed_bytes;
+
+    swift_free("writebuff", temp);
+    temp = NULL;
+  }
+#endif
+
+  /* Write temporary buffer to HDF5 dataspace, unless the background writer
+   * does it once the attributes are in place. */
+  if (e->snapshot_async_writer == NULL) {
+    tic_stage = getticks();
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+    if (parallel_compression) {
+      io_parallel_compression_write(h_data, &compressed, props.name);
+      stats->written_bytes += compressed.compressed_bytes;
+      io_parallel_compression_free(&compressed);
+    } else
+#endif
+    {
+      h_err = H5Dwrite(h_data, io_hdf5_type(props.type), h_space, H5S_ALL,
+                       H5P_DEFAULT, temp);
+      if (h_err < 0) error("Error while writing data array '%s'.", props.name);
+      stats->written_bytes += num_elements * typeSize;
+    }
+    stats->write_ticks += getticks() - tic_stage;
+  }
 
 #ifdef IO_SPEED_MEASUREMENT
   ticks toc = getticks();
@@ -263,8 +314,25 @@ void write_distributed_array(
   /* Write the full description */
   io_write_attribute_s(h_data, "Description", props.description);
 
+  /* Hand the data over to the background writer, which will free the buffer
+   * and close the dataset once written. */
+  if (e->snapshot_async_writer != NULL) {
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+    if (parallel_compression)
+      io_async_writer_write_chunks(e->snapshot_async_writer, h_data, h_space,
+                                   &compressed, props.name);
+    else
+#endif
+      io_async_writer_write_dataset(e->snapshot_async_writer, h_data, h_space,
+                                    io_hdf5_type(props.type), temp,
+                                    num_elements * typeSize, props.name);
+    H5Tclose(h_type);
+    H5Pclose(h_prop);
+    return;
+  }
+
   /* Free and close everything */
-  swift_free("writebuff", temp);
+  if (temp != NULL) swift_free("writebuff", temp);
   H5Tclose(h_type);
   H5Pclose(h_prop);
   H5Dclose(h_data);
@@ -818,6 +886,10 @@ void write_output_distributed(struct engine* e,
   const size_t Nstars = e->s->nr_sparts;
   const size_t Nblackholes = e->s->nr_bparts;
 
+  /* Time spent in each stage of the writing of the particle arrays */
+  struct io_write_stats stats;
+  bzero(&stats, sizeof(struct io_write_stats));
+
   /* Determine if we are writing a reduced snapshot, and if so which
    * output selection type to use */
   char current_selection_name[FIELD_BUFFER_SIZE] =
@@ -1477,7 +1549,7 @@ void write_output_distributed(struct engine* e,
       if (compression_level != compression_do_not_write) {
         write_distributed_array(e, h_grp, fileName, partTypeGroupName, list[i],
                                 Nparticles, compression_level, internal_units,
-                                snapshot_units);
+                                snapshot_units, &stats);
         num_fields_written++;
       }
     }
@@ -1501,9 +1573,14 @@ void write_output_distributed(struct engine* e,
 
   /* message("Done writing particles..."); */
 
-  /* Close file */
+  /* Close file. If datasets are still being written in the background, the
+   * library keeps it open until the last one is closed. */
   H5Fclose(h_file);
   H5Pclose(h_props);
+  if (e->snapshot_async_writer != NULL)
+    io_async_writer_end_file(e->snapshot_async_writer, fileName);
+
+  if (e->verbose && mpi_rank == 0) io_write_stats_print(&stats, fileName);
 
 #if H5_VERSION_GE(1, 10, 0)
 
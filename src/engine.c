@@ -78,6 +78,7 @@
 #include "lightcone/lightcone.h"
 #include "lightcone/lightcone_array.h"
 #include "line_of_sight.h"
+#include "mac_cache.h"
 #include "map.h"
 #include "memuse.h"
 #include "minmax.h"
@@ -1279,6 +1280,11 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   /* Re-build the space. */
   space_rebuild(e->s, repartitioned, e->verbose);
 
+  /* The cached MAC decisions refer to the old cells */
+  if (e->mac_cache != NULL)
+    mac_cache_reset(e->mac_cache, e->s->nr_cells + e->s->tot_cells,
+                    e->verbose);
+
   /* Report the number of cells and memory */
   if (e->verbose)
     message(
@@ -1782,9 +1788,18 @@ void engine_launch(struct engine *e, const char *call) {
   space_reset_task_counters(e->s);
 #endif
 
-  /* reset the active time counters for the runners */
+  /* reset the active time and sort counters for the runners */
   for (int i = 0; i < e->nr_threads; ++i) {
     runner_reset_active_time(&e->runners[i]);
+    runner_reset_sort_counts(&e->runners[i]);
+  }
+
+  /* Forget the neighbour lists of the previous launch */
+  const int with_nlists = e->hydro_properties->use_neighbour_lists;
+  if (with_nlists) {
+    e->hydro_nlist_epoch++;
+    for (int i = 0; i < e->nr_threads; ++i)
+      hydro_nlist_arena_reset(&e->runners[i].nlist_arena);
   }
 
   /* Prepare the scheduler. */
@@ -1820,6 +1835,46 @@ void engine_launch(struct engine *e, const char *call) {
   e->sched.last_successful_task_fetch = 0LL;
 #endif
 
+  if (e->verbose) {
+    long long sort_counts[runner_sort_count] = {0};
+    long long sort_total = 0;
+    for (int i = 0; i < e->nr_threads; ++i)
+      for (int k = 0; k < runner_sort_count; ++k) {
+        sort_counts[k] += e->runners[i].sort_counts[k];
+        sort_total += e->runners[i].sort_counts[k];
+      }
+    if (sort_total > 0)
+      message("(%s) leaf sorts: %lld full, %lld repaired, %lld repairs failed.",
+              call, sort_counts[runner_sort_full],
+              sort_counts[runner_sort_repaired],
+              sort_counts[runner_sort_repair_failed]);
+
+    long long culled_subpairs = 0;
+    for (int i = 0; i < e->nr_threads; ++i)
+      culled_subpairs += e->runners[i].culled_subpairs;
+    if (culled_subpairs > 0)
+      message("(%s) hydro sub-cell pairs skipped out of range: %lld.", call,
+              culled_subpairs);
+  }
+
+  if (e->verbose && with_nlists) {
+    long long built = 0, entries = 0, reused = 0, missed = 0;
+    size_t size = 0;
+    for (int i = 0; i < e->nr_threads; ++i) {
+      const struct hydro_nlist_arena *arena = &e->runners[i].nlist_arena;
+      built += arena->built;
+      entries += arena->entries;
+      reused += arena->reused;
+      missed += arena->missed;
+      size += hydro_nlist_arena_size(arena);
+    }
+    if (built > 0)
+      message(
+          "(%s) neighbour lists: %lld built (%lld pairs, %.3f MB), %lld "
+          "re-used, %lld searched again.",
+          call, built, entries, size / (1024. * 1024.), reused, missed);
+  }
+
   if (e->verbose)
     message("(%s) took %.3f %s.", call, clocks_from_ticks(getticks() - tic),
             clocks_getunit());
@@ -3190,6 +3245,26 @@ void engine_numa_policies(int rank, int verbose) {
 #endif
 }
 
+/**
+ * @brief Allocate the cache of multipole acceptance decisions if the
+ * gravity scheme uses one.
+ *
+ * The cache is only filled once the tree has been built.
+ *
+ * @param e The #engine.
+ */
+static void engine_init_mac_cache(struct engine *e) {
+
+  e->mac_cache = NULL;
+  if ((e->policy & engine_policy_self_gravity) &&
+      e->gravity_properties->use_MAC_cache) {
+    e->mac_cache = (struct mac_cache *)malloc(sizeof(struct mac_cache));
+    if (e->mac_cache == NULL) error("Failed to allocate the MAC cache.");
+    mac_cache_init(e->mac_cache, e->gravity_properties->MAC_cache_tolerance,
+                   e->gravity_properties->MAC_cache_entries_per_cell);
+  }
+}
+
 /**
  * @brief init an engine struct with the necessary properties for the
  *        simulation.
@@ -3353,6 +3428,8 @@ void engine_init(
   e->free_foreign_when_rebuilding = parser_get_opt_param_int(
       params, "Scheduler:free_foreign_during_rebuild", 0);
   e->snapshot_output_count = 0;
+  e->snapshot_async_writer = NULL;
+  e->restart_async_writer = NULL;
   e->stf_output_count = 0;
   e->los_output_count = 0;
   e->ps_output_count = 0;
@@ -3389,6 +3466,8 @@ void engine_init(
   e->neutrino_properties = neutrinos;
   e->neutrino_response = neutrino_response;
   e->mesh = mesh;
+  engine_init_mac_cache(e);
+  e->hydro_nlist_epoch = 0;
   e->power_data = pow_data;
   e->external_potential = potential;
   e->forcing_terms = forcing_terms;
@@ -3783,8 +3862,25 @@ void engine_clean(struct engine *e, const int fof, const int restart) {
 #endif
     gravity_cache_clean(&e->runners[k].ci_gravity_cache);
     gravity_cache_clean(&e->runners[k].cj_gravity_cache);
+    hydro_hot_cache_clean(&e->runners[k].ci_hot_cache);
+    hydro_hot_cache_clean(&e->runners[k].cj_hot_cache);
+    hydro_nlist_arena_clean(&e->runners[k].nlist_arena);
   }
   swift_free("runners", e->runners);
+
+  /* Let the background writer finish any pending snapshot. */
+  if (e->snapshot_async_writer != NULL) {
+    io_async_writer_clean(e->snapshot_async_writer);
+    free(e->snapshot_async_writer);
+    e->snapshot_async_writer = NULL;
+  }
+
+  /* And for any restart file still being written. */
+  if (e->restart_async_writer != NULL) {
+    io_async_writer_clean(e->restart_async_writer);
+    free(e->restart_async_writer);
+    e->restart_async_writer = NULL;
+  }
   free(e->snapshot_units);
 
   output_list_clean(&e->output_list_snapshots);
@@ -3806,6 +3902,10 @@ void engine_clean(struct engine *e, const int fof, const int restart) {
 #endif
   scheduler_clean(&e->sched);
   space_clean(e->s);
+  if (e->mac_cache != NULL) {
+    mac_cache_clean(e->mac_cache);
+    free(e->mac_cache);
+  }
   threadpool_clean(&e->threadpool);
 #if defined(WITH_MPI)
   for (int i = 0; i < e->nr_proxies; ++i) {
@@ -3964,6 +4064,8 @@ void engine_struct_restore(struct engine *e, FILE *stream) {
   e->sched.tasks_ind = NULL;
   e->sched.tid_active = NULL;
   e->sched.size = 0;
+  e->snapshot_async_writer = NULL;
+  e->restart_async_writer = NULL;
 
   /* Now for the other pointers, these use their own restore functions. */
   /* Note all this memory leaks, but is used once. */
@@ -4014,6 +4116,7 @@ void engine_struct_restore(struct engine *e, FILE *stream) {
       (struct gravity_props *)malloc(sizeof(struct gravity_props));
   gravity_props_struct_restore(gravity_properties, stream);
   e->gravity_properties = gravity_properties;
+  engine_init_mac_cache(e);
 
   struct stars_props *stars_properties =
       (struct stars_props *)malloc(sizeof(struct stars_props));
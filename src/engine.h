@@ -38,6 +38,7 @@
 #include "collectgroup.h"
 #include "gpu_params.h"
 #include "ic_info.h"
+#include "io_async_writer.h"
 #include "lightcone/lightcone.h"
 #include "lightcone/lightcone_array.h"
 #include "mesh_gravity.h"
@@ -361,6 +362,9 @@ struct engine {
   double snapshot_delta_from_edge;
   int snapshot_output_count;
 
+  /* Background writer for the snapshots (NULL if writing synchronously) */
+  struct io_async_writer *snapshot_async_writer;
+
   /* Snapshot recording trigger mechanism counters */
   double snapshot_recording_triggers_part[num_snapshot_triggers_part];
   double snapshot_recording_triggers_desired_part[num_snapshot_triggers_part];
@@ -535,6 +539,13 @@ struct engine {
   /* Properties of the self-gravity scheme */
   struct gravity_props *gravity_properties;
 
+  /* Cache of the multipole acceptance decisions of the tree walk */
+  struct mac_cache *mac_cache;
+
+  /* Number of launches with neighbour lists, used to tag the lists built
+   * during the current one */
+  int hydro_nlist_epoch;
+
   /* The mesh used for long-range gravity forces */
   struct pm_mesh *mesh;
 
@@ -593,6 +604,15 @@ struct engine {
   /* Number of Lustre OSTs on the system to use as rank-based striping offset */
   int restart_lustre_OST_count;
 
+  /* Write the restart files as independently compressed ranges? */
+  int restart_stream_format;
+
+  /* Deflate level of the restart files, 0 for no compression. */
+  int restart_compression;
+
+  /* Background writer for the restart files (NULL if writing synchronously) */
+  struct io_async_writer *restart_async_writer;
+
   /* Do we free the foreign data before writing restart files? */
   int free_foreign_when_dumping_restart;
 
@@ -42,6 +42,7 @@
 #include "part.h"
 #include "pressure_floor.h"
 #include "proxy.h"
+#include "restart_stream.h"
 #include "rt.h"
 #include "star_formation.h"
 #include "star_formation_logger.h"
@@ -201,6 +202,7 @@ void engine_config(int restart, int fof, struct engine *e,
   e->verbose = verbose;
   e->wallclock_time = 0.f;
   e->restart_dump = 0;
+  e->restart_stream_format = 0;
   e->restart_dir = restart_dir;
   e->restart_file = restart_file;
   e->resubmit = 0;
@@ -835,6 +837,23 @@ void engine_config(int restart, int fof, struct engine *e,
     e->restart_lustre_OST_count =
         parser_get_opt_param_int(params, "Restarts:lustre_OST_count", 0);
 
+    /* Whether to write the restart files as compressed ranges. */
+    e->restart_stream_format =
+        parser_get_opt_param_int(params, "Restarts:stream_format", 0);
+    if (e->restart_stream_format && !restart_stream_is_supported()) {
+      if (e->nodeID == 0)
+        message(
+            "WARNING: The restart stream format requires zlib. Restart files "
+            "will be written in the plain format.");
+      e->restart_stream_format = 0;
+    }
+
+    /* Deflate level of the ranges of the restart files. */
+    e->restart_compression =
+        parser_get_opt_param_int(params, "Restarts:compression", 1);
+    if (e->restart_compression < 0 || e->restart_compression > 9)
+      error("Restarts:compression must be between 0 and 9.");
+
     /* Hours between restart dumps. Can be changed on restart. */
     float dhours =
         parser_get_opt_param_float(params, "Restarts:delta_hours", 5.0f);
@@ -880,6 +899,81 @@ void engine_config(int restart, int fof, struct engine *e,
   if (e->nodeID == 0)
     message("Using %d threads in the thread-pool", nr_pool_threads);
 
+  /* Start the background snapshot writer if requested. */
+  e->snapshot_async_writer = NULL;
+  if (parser_get_opt_param_int(params, "Snapshots:async_write", 0)) {
+#if defined(HAVE_HDF5)
+#if defined(WITH_MPI)
+    /* Only the distributed snapshots have one file per rank that each rank
+     * can write on its own. */
+    const int async_possible = e->snapshot_distributed;
+#else
+    const int async_possible = 1;
+#endif
+    const float max_memory_MB = parser_get_opt_param_float(
+        params, "Snapshots:async_max_memory_MB", 4096.f);
+    if (max_memory_MB <= 0.f)
+      error("Snapshots:async_max_memory_MB must be positive.");
+
+    if (!async_possible) {
+      if (e->nodeID == 0)
+        message(
+            "WARNING: Asynchronous snapshot writing is only available for "
+            "distributed snapshots in MPI runs. Snapshots will be written "
+            "synchronously.");
+    } else if (io_async_writer_is_supported()) {
+      e->snapshot_async_writer =
+          (struct io_async_writer *)malloc(sizeof(struct io_async_writer));
+      if (e->snapshot_async_writer == NULL)
+        error("Failed to allocate the asynchronous snapshot writer.");
+      io_async_writer_init(e->snapshot_async_writer,
+                           (size_t)(max_memory_MB * 1024. * 1024.), e->verbose);
+      if (e->nodeID == 0)
+        message(
+            "Writing snapshots in the background with at most %.1f MB of "
+            "buffered data.",
+            max_memory_MB);
+    } else if (e->nodeID == 0) {
+      message(
+          "WARNING: The HDF5 library is not thread-safe. Snapshots will be "
+          "written synchronously.");
+    }
+#else
+    if (e->nodeID == 0)
+      message(
+          "WARNING: Asynchronous snapshot writing requires HDF5. Snapshots "
+          "will be written synchronously.");
+#endif
+  }
+
+  /* Start the background restart file writer if requested. */
+  e->restart_async_writer = NULL;
+  if (parser_get_opt_param_int(params, "Restarts:async_write", 0)) {
+    const float max_memory_MB = parser_get_opt_param_float(
+        params, "Restarts:async_max_memory_MB", 4096.f);
+    if (max_memory_MB <= 0.f)
+      error("Restarts:async_max_memory_MB must be positive.");
+
+    if (e->restart_stream_format) {
+      e->restart_async_writer =
+          (struct io_async_writer *)malloc(sizeof(struct io_async_writer));
+      if (e->restart_async_writer == NULL)
+        error("Failed to allocate the asynchronous restart writer.");
+      io_async_writer_init(e->restart_async_writer,
+                           (size_t)(max_memory_MB * 1024. * 1024.),
+                           e->verbose || e->nodeID == 0);
+      if (e->nodeID == 0)
+        message(
+            "Writing restart files in the background with at most %.1f MB "
+            "of buffered data.",
+            max_memory_MB);
+    } else if (e->nodeID == 0) {
+      message(
+          "WARNING: Asynchronous restart writing requires the stream "
+          "format. Restart files will be written synchronously.");
+    }
+  }
+
   /* Cells per thread buffer. */
   e->s->cells_sub =
       (struct cell **)calloc(nr_pool_threads + 1, sizeof(struct cell *));
@@ -1021,6 +1115,11 @@ void engine_config(int restart, int fof, struct engine *e,
     e->runners[k].cj_gravity_cache.count = 0;
     gravity_cache_init(&e->runners[k].ci_gravity_cache, space_splitsize);
     gravity_cache_init(&e->runners[k].cj_gravity_cache, space_splitsize);
+    e->runners[k].ci_hot_cache.count = 0;
+    e->runners[k].cj_hot_cache.count = 0;
+    hydro_hot_cache_init(&e->runners[k].ci_hot_cache, space_splitsize);
+    hydro_hot_cache_init(&e->runners[k].cj_hot_cache, space_splitsize);
+    hydro_nlist_arena_init(&e->runners[k].nlist_arena);
 #ifdef WITH_VECTORIZATION
     e->runners[k].ci_cache.count = 0;
     e->runners[k].cj_cache.count = 0;
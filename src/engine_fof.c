@@ -157,6 +157,11 @@ void engine_fof(struct engine *e, const int dump_results,
   /* Initialise FOF parameters and allocate FOF arrays. */
   fof_allocate(e->s, e->fof_properties);
 
+  /* Re-use the groups of the last full search when only seeding black holes */
+  fof_prepare_incremental(e->fof_properties, e->s,
+                          /*allow_incremental=*/seed_black_holes &&
+                              !dump_results);
+
   /* Make FOF tasks */
   engine_make_fof_tasks(e);
 
@@ -172,6 +177,9 @@ void engine_fof(struct engine *e, const int dump_results,
   /* Compute group sizes (only of local fragments with MPI) */
   fof_compute_local_sizes(e->fof_properties, e->s);
 
+  /* Remember the cores of a full search for the next incremental calls */
+  fof_store_incremental_labels(e->fof_properties, e->s);
+
 #ifdef WITH_MPI
 
   /* Allocate buffers to receive the gpart fof information */
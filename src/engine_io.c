@@ -208,6 +208,16 @@ int engine_dump_restarts(struct engine *e, const int drifted_all,
         message("Writing restart files");
       }
 
+      /* The previous dump may still be being written in the background.
+       * Wait for it to complete on all the ranks before we touch any of its
+       * files, such that we always keep a complete set. */
+      if (e->restart_async_writer != NULL) {
+        io_async_writer_wait(e->restart_async_writer);
+#ifdef WITH_MPI
+        MPI_Barrier(MPI_COMM_WORLD);
+#endif
+      }
+
       /* Clean out the previous saved files, if found. Do this now as we are
        * MPI synchronized. */
       restart_remove_previous(e->restart_file);
@@ -234,10 +244,15 @@ int engine_dump_restarts(struct engine *e, const int drifted_all,
 
       restart_write(e, e->restart_file);
 
+      /* Complete the files before we stop. */
+      if (e->restart_async_writer != NULL && (exit_run || force))
+        io_async_writer_wait(e->restart_async_writer);
+
 #ifdef WITH_MPI
       /* Make sure all ranks finished writing to avoid having incomplete
        * sets of restart files should the code crash before all the ranks
-       * are done */
+       * are done. Files still being written in the background are only
+       * complete once waited for, either above or before the next dump. */
       MPI_Barrier(MPI_COMM_WORLD);
 
       /* Reallocate freed memory */
@@ -370,9 +385,19 @@ void engine_dump_snapshot(struct engine *e, const int fof) {
 
   clocks_gettime(&time2);
   if (e->verbose)
-    message("writing particle properties took %.3f %s.",
+    message("%s particle properties took %.3f %s.",
+            e->snapshot_async_writer != NULL ? "staging" : "writing",
             (float)clocks_diff(&time1, &time2), clocks_getunit());
 
+#ifdef WITH_MPI
+  /* The command must only see complete files, including those of the other
+   * ranks still being written in the background. */
+  if (e->snapshot_run_on_dump && e->snapshot_async_writer != NULL) {
+    io_async_writer_wait(e->snapshot_async_writer);
+    MPI_Barrier(MPI_COMM_WORLD);
+  }
+#endif
+
   /* Run the post-dump command if required */
   if (e->nodeID == 0) {
     engine_run_on_dump(e);
@@ -396,6 +421,13 @@ void engine_run_on_dump(struct engine *e) {
     snprintf(dump_command_buf, buf_size, "%s %s %04d", e->snapshot_dump_command,
              e->snapshot_base_name, e->snapshot_output_count - 1);
 
+    /* If the snapshot is being written in the background, the command has
+     * to wait for it to be complete. */
+    if (e->snapshot_async_writer != NULL) {
+      io_async_writer_run_command(e->snapshot_async_writer, dump_command_buf);
+      return;
+    }
+
     /* Let's trust the user's command... */
     const int result = system(dump_command_buf);
     if (result != 0) {
@@ -400,6 +400,8 @@ void engine_unskip(struct engine *e) {
   ProfilerStart(filename);
 #endif  // WITH_PROFILER
 
+  e->sched.nr_culled_subpairs = 0;
+
   /* Move the active local cells to the top of the list. */
   int *local_cells = e->s->local_cells_with_tasks_top;
   int num_active_cells = 0;
@@ -503,6 +505,10 @@ void engine_unskip(struct engine *e) {
     free(local_active_cells);
   }
 
+  if (e->verbose && e->sched.nr_culled_subpairs > 0)
+    message("skipped %d hydro sub-cell pairs out of range.",
+            e->sched.nr_culled_subpairs);
+
   if (e->verbose)
     message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
             clocks_getunit());
@@ -24,6 +24,7 @@
 
 /* Some standard headers. */
 #include <errno.h>
+#include <float.h>
 #include <libgen.h>
 #include <unistd.h>
 
@@ -40,8 +41,10 @@
 #include "common_io.h"
 #include "engine.h"
 #include "fof_catalogue_io.h"
+#include "fof_union_find.h"
 #include "hashmap.h"
 #include "memuse.h"
+#include "periodic.h"
 #include "proxy.h"
 #include "threadpool.h"
 #include "tools.h"
@@ -53,7 +56,10 @@
 
 /* Constants. */
 #define UNION_BY_SIZE_OVER_MPI (1)
-#define FOF_COMPRESS_PATHS_MIN_LENGTH (2)
+
+/*! Number of particle pairs in a leaf search above which the particles are
+ * binned on a grid of the size of the linking length */
+#define fof_grid_min_pairs (1024)
 
 /* The FoF policy we are running */
 int current_fof_linking_type;
@@ -178,6 +184,28 @@ void fof_init(struct fof_props *props, struct swift_params *params,
     props->seed_halo_mass *= phys_const->const_solar_mass;
   }
 
+  /* Read the displacement (in units of the linking length) below which the
+   * particles keep their links between two seeding calls. */
+  props->incremental_tolerance_ratio = parser_get_opt_param_double(
+      params, "FOF:incremental_tolerance_ratio", 0.);
+
+  if (props->incremental_tolerance_ratio < 0.)
+    error("The FOF incremental tolerance can't be negative!");
+
+  /* Links within twice the tolerance of the linking length are re-checked */
+  if (props->incremental_tolerance_ratio >= 0.5)
+    error("The FOF incremental tolerance must be smaller than 0.5!");
+
+  props->incremental_search = 0;
+  props->incremental_records = NULL;
+  props->incremental_num_records = 0;
+  props->incremental_num_labels = 0;
+  props->incremental_label = NULL;
+  props->incremental_gpart_marginal = NULL;
+  props->incremental_label_moved = NULL;
+  props->incremental_label_count = NULL;
+  props->incremental_label_root = NULL;
+
   /* Read what particle types we want to run FOF on */
   parser_get_param_int_array(params, "FOF:linking_types", swift_type_count,
                              props->fof_linking_types);
@@ -709,109 +737,6 @@ __attribute__((always_inline)) INLINE static int gpart_is_ignorable(
   return current_fof_ignore_type & (1 << (gp->type + 1));
 }
 
-/**
- * @brief Finds the local root ID of the group a particle exists in.
- *
- * We follow the group_index array until reaching the root of the group.
- *
- * Also performs path compression if the path is long.
- *
- * @param i The index of the particle.
- * @param group_index Array of group root indices.
- */
-__attribute__((always_inline)) INLINE static size_t fof_find(
-    const size_t i, size_t *group_index) {
-
-  size_t root = i;
-  int tree_depth = 0;
-
-  while (root != group_index[root]) {
-#ifdef PATH_HALVING
-    atomic_cas(&group_index[root], group_index[root],
-               group_index[group_index[root]]);
-#endif
-    root = group_index[root];
-    tree_depth++;
-  }
-
-  /* Only perform path compression on trees with a depth of
-   * FOF_COMPRESS_PATHS_MIN_LENGTH or higher. */
-  if (tree_depth >= FOF_COMPRESS_PATHS_MIN_LENGTH)
-    atomic_cas(&group_index[i], group_index[i], root);
-
-  return root;
-}
-
-/**
- * @brief Atomically update the root of a group
- *
- * @param address The address of the value to update.
- * @param y The new value to write.
- *
- * @return 1 If successful, 0 otherwise.
- */
-__attribute__((always_inline)) INLINE static int atomic_update_root(
-    volatile size_t *address, const size_t y) {
-
-  size_t *size_t_ptr = (size_t *)address;
-
-  size_t old_val = *address;
-  size_t test_val = old_val;
-  size_t new_val = y;
-
-  /* atomic_cas returns old_val if *size_t_ptr has not changed since being
-   * read.*/
-  old_val = atomic_cas(size_t_ptr, test_val, new_val);
-
-  if (test_val == old_val)
-    return 1;
-  else
-    return 0;
-}
-
-/**
- * @brief Unifies two groups by setting them to the same root.
- *
- * @param root_i The root of the first group. Will be updated.
- * @param root_j The root of the second group.
- * @param group_index The list of group roots.
- */
-__attribute__((always_inline)) INLINE static void fof_union(
-    size_t *restrict root_i, const size_t root_j,
-    size_t *restrict group_index) {
-
-  int result = 0;
-
-  /* Loop until the root can be set to a new value. */
-  do {
-    size_t root_i_new = fof_find(*root_i, group_index);
-    const size_t root_j_new = fof_find(root_j, group_index);
-
-    /* Skip particles in the same group. */
-    if (root_i_new == root_j_new) return;
-
-    /* If the root ID of pj is lower than pi's root ID set pi's root to point to
-     * pj's. Otherwise set pj's root to point to pi's.*/
-    if (root_j_new < root_i_new) {
-
-      /* Updates the root and checks that its value has not been changed since
-       * being read. */
-      result = atomic_update_root(&group_index[root_i_new], root_j_new);
-
-      /* Update root_i on the fly. */
-      *root_i = root_j_new;
-    } else {
-
-      /* Updates the root and checks that its value has not been changed since
-       * being read. */
-      result = atomic_update_root(&group_index[root_j_new], root_i_new);
-
-      /* Update root_i on the fly. */
-      *root_i = root_i_new;
-    }
-  } while (result != 1);
-}
-
 /**
  * @brief Compute th minimal distance between any two points in two cells.
  *
@@ -961,6 +886,340 @@ __attribute__((always_inline)) INLINE static void fof_compute_send_recv_offsets(
 
 #endif /* WITH_MPI */
 
+/**
+ * @brief A grid of bins, at least as wide as the linking length, holding the
+ * linkable #gpart of a leaf cell.
+ *
+ * Two particles closer than the linking length are in the same or in adjacent
+ * bins, so each particle only needs to be tested against 27 bins.
+ */
+struct fof_grid {
+
+  /*! Lower corner of the binned particles */
+  double min[3];
+
+  /*! Inverse of the size of the bins */
+  double inv_bin_size[3];
+
+  /*! Number of bins along each axis */
+  int dim[3];
+
+  /*! Start of each bin in the list of indices (one extra entry at the end) */
+  int *bin_start;
+
+  /*! Indices of the particles ordered by bin */
+  int *index;
+};
+
+/**
+ * @brief Is a #gpart of a leaf considered by the FOF linking search?
+ */
+__attribute__((always_inline)) INLINE static int fof_gpart_is_searched(
+    const struct gpart *gp) {
+
+  return gp->time_bin < time_bin_inhibited && !gpart_is_ignorable(gp) &&
+         gpart_is_linkable(gp);
+}
+
+/**
+ * @brief Index of the bin containing a coordinate along a given axis.
+ *
+ * Can be outside the grid for points not used to construct it.
+ */
+__attribute__((always_inline)) INLINE static int fof_grid_coord(
+    const struct fof_grid *grid, const double x, const int k) {
+
+  return (int)floor((x - grid->min[k]) * grid->inv_bin_size[k]);
+}
+
+/**
+ * @brief Bin the linkable #gpart of a leaf on a grid of bins of at least the
+ * linking length.
+ *
+ * The bins are also made large enough to hold a particle on average such
+ * that the grid never has more bins than particles.
+ *
+ * @param grid The #fof_grid to construct.
+ * @param gparts The #gpart of the cell.
+ * @param count The number of #gpart in the cell.
+ * @param l_x The FOF linking length.
+ */
+static void fof_grid_build(struct fof_grid *grid, const struct gpart *gparts,
+                           const size_t count, const double l_x) {
+
+  /* Bounding box of the particles to bin */
+  double max_x[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
+  int num_binned = 0;
+  for (int k = 0; k < 3; k++) grid->min[k] = DBL_MAX;
+  for (size_t i = 0; i < count; i++) {
+    if (!fof_gpart_is_searched(&gparts[i])) continue;
+    for (int k = 0; k < 3; k++) {
+      grid->min[k] = min(grid->min[k], gparts[i].x[k]);
+      max_x[k] = max(max_x[k], gparts[i].x[k]);
+    }
+    num_binned++;
+  }
+
+  /* Size of the bins, with a margin for the single-precision distances */
+  double bin_size = 1.001 * l_x;
+  if (num_binned > 0) {
+    const double volume = (max_x[0] - grid->min[0]) *
+                          (max_x[1] - grid->min[1]) *
+                          (max_x[2] - grid->min[2]);
+    bin_size = max(bin_size, cbrt(volume / num_binned));
+  }
+
+  int num_bins = 1;
+  for (int k = 0; k < 3; k++) {
+    const double extent = (num_binned > 0) ? max_x[k] - grid->min[k] : 0.;
+    grid->dim[k] = max((int)(extent / bin_size), 1);
+
+    /* Never let the bins get narrower than the linking length */
+    grid->inv_bin_size[k] = 1. / max(extent / grid->dim[k], bin_size);
+    if (num_binned == 0) grid->min[k] = 0.;
+    num_bins *= grid->dim[k];
+  }
+
+  grid->bin_start = (int *)calloc(num_bins + 1, sizeof(int));
+  grid->index = (int *)malloc(max(num_binned, 1) * sizeof(int));
+  int *bin = (int *)malloc(max(count, (size_t)1) * sizeof(int));
+  int *fill = (int *)malloc(num_bins * sizeof(int));
+  if (grid->bin_start == NULL || grid->index == NULL || bin == NULL ||
+      fill == NULL)
+    error("Failed to allocate the FOF search grid.");
+
+  /* Count the particles in each bin... */
+  for (size_t i = 0; i < count; i++) {
+    if (!fof_gpart_is_searched(&gparts[i])) continue;
+    int b[3];
+    for (int k = 0; k < 3; k++)
+      b[k] = min(fof_grid_coord(grid, gparts[i].x[k], k), grid->dim[k] - 1);
+    bin[i] = (b[0] * grid->dim[1] + b[1]) * grid->dim[2] + b[2];
+    grid->bin_start[bin[i] + 1]++;
+  }
+  for (int b = 0; b < num_bins; b++)
+    grid->bin_start[b + 1] += grid->bin_start[b];
+
+  /* ...and store them in bin order. */
+  memcpy(fill, grid->bin_start, num_bins * sizeof(int));
+  for (size_t i = 0; i < count; i++) {
+    if (!fof_gpart_is_searched(&gparts[i])) continue;
+    grid->index[fill[bin[i]]++] = i;
+  }
+
+  free(fill);
+  free(bin);
+}
+
+/**
+ * @brief Release the memory of a #fof_grid.
+ */
+static void fof_grid_clean(struct fof_grid *grid) {
+  free(grid->bin_start);
+  free(grid->index);
+}
+
+/**
+ * @brief Perform a FOF search using union-find on a given leaf-cell,
+ * restricting the search of each particle to the adjacent bins of a grid.
+ *
+ * @param l_x2 The square of the FOF linking length.
+ * @param c The #cell in which to perform FOF.
+ * @param offset The group indices of the particles of the cell.
+ * @param group_index Array of group root indices.
+ */
+static void fof_search_self_cell_grid(const double l_x2, const struct cell *c,
+                                      size_t *const offset,
+                                      size_t *const group_index) {
+
+  const struct gpart *gparts = c->grav.parts;
+
+  struct fof_grid grid;
+  fof_grid_build(&grid, gparts, c->grav.count, sqrt(l_x2));
+
+  /* Loop over the bins... */
+  for (int bx = 0; bx < grid.dim[0]; bx++) {
+    for (int by = 0; by < grid.dim[1]; by++) {
+      for (int bz = 0; bz < grid.dim[2]; bz++) {
+
+        const int b = (bx * grid.dim[1] + by) * grid.dim[2] + bz;
+
+        /* ...and the particles in them. */
+        for (int ii = grid.bin_start[b]; ii < grid.bin_start[b + 1]; ii++) {
+
+          const int i = grid.index[ii];
+          const struct gpart *pi = &gparts[i];
+
+#ifdef SWIFT_DEBUG_CHECKS
+          if (pi->ti_drift != ti_current)
+            error("Running FOF on an un-drifted particle!");
+#endif
+
+          const double pix = pi->x[0];
+          const double piy = pi->x[1];
+          const double piz = pi->x[2];
+
+          /* Find the root of pi. */
+          size_t root_i = fof_find(offset[i], group_index);
+
+          /* Loop over the adjacent bins. */
+          for (int nx = max(bx - 1, 0); nx <= min(bx + 1, grid.dim[0] - 1);
+               nx++) {
+            for (int ny = max(by - 1, 0); ny <= min(by + 1, grid.dim[1] - 1);
+                 ny++) {
+              for (int nz = max(bz - 1, 0);
+                   nz <= min(bz + 1, grid.dim[2] - 1); nz++) {
+
+                const int nb = (nx * grid.dim[1] + ny) * grid.dim[2] + nz;
+
+                for (int jj = grid.bin_start[nb]; jj < grid.bin_start[nb + 1];
+                     jj++) {
+
+                  /* Only consider each pair once. */
+                  const int j = grid.index[jj];
+                  if (j <= i) continue;
+
+                  const struct gpart *pj = &gparts[j];
+
+                  /* Find the root of pj. */
+                  const size_t root_j = fof_find(offset[j], group_index);
+
+                  /* Skip particles in the same group. */
+                  if (root_i == root_j) continue;
+
+                  /* Compute the pairwise distance */
+                  float dx[3], r2 = 0.0f;
+                  dx[0] = pix - pj->x[0];
+                  dx[1] = piy - pj->x[1];
+                  dx[2] = piz - pj->x[2];
+
+                  for (int k = 0; k < 3; k++) r2 += dx[k] * dx[k];
+
+                  /* Hit or miss? */
+                  if (r2 < l_x2) {
+
+                    /* Merge the groups */
+                    fof_union(&root_i, root_j, group_index);
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  fof_grid_clean(&grid);
+}
+
+/**
+ * @brief Perform a FOF search using union-find between two cells, binning
+ * the particles of the second cell on a grid.
+ *
+ * Particles of the first cell further than one bin away from the grid are
+ * skipped altogether.
+ *
+ * @param l_x2 The square of the FOF linking length.
+ * @param shift The periodic shift to apply to the particles of ci.
+ * @param ci The first #cell in which to perform FOF.
+ * @param cj The second #cell in which to perform FOF.
+ * @param offset_i The group indices of the particles of ci.
+ * @param offset_j The group indices of the particles of cj.
+ * @param group_index Array of group root indices.
+ */
+static void fof_search_pair_cells_grid(
+    const double l_x2, const double shift[3], const struct cell *restrict ci,
+    const struct cell *restrict cj, size_t *const offset_i,
+    size_t *const offset_j, size_t *const group_index) {
+
+  const size_t count_i = ci->grav.count;
+  const struct gpart *gparts_i = ci->grav.parts;
+  const struct gpart *gparts_j = cj->grav.parts;
+
+  struct fof_grid grid;
+  fof_grid_build(&grid, gparts_j, cj->grav.count, sqrt(l_x2));
+
+  /* Loop over particles and find which particles belong in the same group. */
+  for (size_t i = 0; i < count_i; i++) {
+
+    const struct gpart *restrict pi = &gparts_i[i];
+
+    /* Ignore inhibited, ignored and non-linking particles */
+    if (!fof_gpart_is_searched(pi)) continue;
+
+#ifdef SWIFT_DEBUG_CHECKS
+    if (pi->ti_drift != ti_current)
+      error("Running FOF on an un-drifted particle!");
+#endif
+
+    const double pix = pi->x[0] - shift[0];
+    const double piy = pi->x[1] - shift[1];
+    const double piz = pi->x[2] - shift[2];
+
+    /* Bin of pi on the grid of cj */
+    const int bx = fof_grid_coord(&grid, pix, 0);
+    const int by = fof_grid_coord(&grid, piy, 1);
+    const int bz = fof_grid_coord(&grid, piz, 2);
+
+    /* Early abort if pi is out of range of all the particles of cj */
+    if (bx < -1 || bx > grid.dim[0] || by < -1 || by > grid.dim[1] ||
+        bz < -1 || bz > grid.dim[2])
+      continue;
+
+    /* Find the root of pi. */
+    size_t root_i = fof_find(offset_i[i], group_index);
+
+    /* Loop over the adjacent bins. */
+    for (int nx = max(bx - 1, 0); nx <= min(bx + 1, grid.dim[0] - 1); nx++) {
+      for (int ny = max(by - 1, 0); ny <= min(by + 1, grid.dim[1] - 1);
+           ny++) {
+        for (int nz = max(bz - 1, 0); nz <= min(bz + 1, grid.dim[2] - 1);
+             nz++) {
+
+          const int nb = (nx * grid.dim[1] + ny) * grid.dim[2] + nz;
+
+          for (int jj = grid.bin_start[nb]; jj < grid.bin_start[nb + 1];
+               jj++) {
+
+            const int j = grid.index[jj];
+            const struct gpart *restrict pj = &gparts_j[j];
+
+#ifdef SWIFT_DEBUG_CHECKS
+            if (pj->ti_drift != ti_current)
+              error("Running FOF on an un-drifted particle!");
+#endif
+
+            /* Find the root of pj. */
+            const size_t root_j = fof_find(offset_j[j], group_index);
+
+            /* Skip particles in the same group. */
+            if (root_i == root_j) continue;
+
+            /* Compute pairwise distance (periodic BCs were accounted
+             for by the shift vector) */
+            float dx[3], r2 = 0.0f;
+            dx[0] = pix - pj->x[0];
+            dx[1] = piy - pj->x[1];
+            dx[2] = piz - pj->x[2];
+
+            for (int k = 0; k < 3; k++) r2 += dx[k] * dx[k];
+
+            /* Hit or miss? */
+            if (r2 < l_x2) {
+
+              /* Merge the groups */
+              fof_union(&root_i, root_j, group_index);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  fof_grid_clean(&grid);
+}
+
 /**
  * @brief Perform a FOF search using union-find on a given leaf-cell
  *
@@ -991,6 +1250,12 @@ void fof_search_self_cell(const struct fof_props *props, const double l_x2,
     error("Performing self FOF search on foreign cell.");
 #endif
 
+  /* Large enough to be worth restricting the search to nearby particles? */
+  if (count * count / 2 > fof_grid_min_pairs) {
+    fof_search_self_cell_grid(l_x2, c, offset, group_index);
+    return;
+  }
+
   /* Loop over particles and find which particles belong in the same group. */
   for (size_t i = 0; i < count; i++) {
 
@@ -1119,6 +1384,13 @@ void fof_search_pair_cells(const struct fof_props *props, const double dim[3],
     diff[k] += shift[k];
   }
 
+  /* Large enough to be worth restricting the search to nearby particles? */
+  if (count_i * count_j > fof_grid_min_pairs) {
+    fof_search_pair_cells_grid(l_x2, shift, ci, cj, offset_i, offset_j,
+                               group_index);
+    return;
+  }
+
   /* Loop over particles and find which particles belong in the same group. */
   for (size_t i = 0; i < count_i; i++) {
 
@@ -1413,6 +1685,11 @@ void rec_fof_search_pair(const struct fof_props *props, const double dim[3],
   /* Return if cells are out of range of each other. */
   if (r2 > search_r2) return;
 
+  /* Nothing to search again in either cell? */
+  if (props->incremental_search && !cell_get_flag(ci, cell_flag_fof_moved) &&
+      !cell_get_flag(cj, cell_flag_fof_moved))
+    return;
+
   /* Recurse on both cells if they are both split. */
   if (ci->split && cj->split) {
     for (int k = 0; k < 8; k++) {
@@ -1520,6 +1797,10 @@ void rec_fof_search_self(const struct fof_props *props, const double dim[3],
                          const struct gpart *const space_gparts,
                          struct cell *c) {
 
+  /* Nothing to search again in here? */
+  if (props->incremental_search && !cell_get_flag(c, cell_flag_fof_moved))
+    return;
+
   /* Recurse? */
   if (c->split) {
 
@@ -1542,6 +1823,351 @@ void rec_fof_search_self(const struct fof_props *props, const double dim[3],
     fof_search_self_cell(props, search_r2, space_gparts, c);
 }
 
+/**
+ * @brief Returns the ID of the particle a #gpart belongs to.
+ *
+ * @param s The #space containing the particles.
+ * @param gp The #gpart.
+ */
+static long long fof_gpart_id(const struct space *s, const struct gpart *gp) {
+
+  switch (gp->type) {
+    case swift_type_gas:
+      return s->parts[-gp->id_or_neg_offset].id;
+    case swift_type_stars:
+      return s->sparts[-gp->id_or_neg_offset].id;
+    case swift_type_sink:
+      return s->sinks[-gp->id_or_neg_offset].id;
+    case swift_type_black_hole:
+      return s->bparts[-gp->id_or_neg_offset].id;
+    default:
+      return gp->id_or_neg_offset;
+  }
+}
+
+/**
+ * @brief Comparison function for qsort and bsearch calls comparing the IDs
+ * of #fof_incremental_record.
+ */
+static int fof_incremental_record_cmp(const void *a, const void *b) {
+
+  const struct fof_incremental_record *ra =
+      (const struct fof_incremental_record *)a;
+  const struct fof_incremental_record *rb =
+      (const struct fof_incremental_record *)b;
+
+  return (ra->id > rb->id) - (ra->id < rb->id);
+}
+
+/**
+ * @brief Release the arrays used by a single incremental FOF call.
+ *
+ * @param props The properties of the FOF scheme.
+ */
+static void fof_free_incremental_arrays(struct fof_props *props) {
+
+  swift_free("fof_incremental_label", props->incremental_label);
+  swift_free("fof_incremental_marginal", props->incremental_gpart_marginal);
+  swift_free("fof_incremental_moved", props->incremental_label_moved);
+  swift_free("fof_incremental_count", props->incremental_label_count);
+  swift_free("fof_incremental_root", props->incremental_label_root);
+  props->incremental_label = NULL;
+  props->incremental_gpart_marginal = NULL;
+  props->incremental_label_moved = NULL;
+  props->incremental_label_count = NULL;
+  props->incremental_label_root = NULL;
+}
+
+/**
+ * @brief Do the links of a #gpart have to be searched for again in an
+ * incremental FOF call?
+ *
+ * That is the case for particles not seen by the last full search, for the
+ * marginal particles and for all the particles of a core in which a particle
+ * moved too much or is gone.
+ *
+ * @param props The properties of the FOF scheme.
+ * @param index The index of the #gpart in the #space.
+ */
+__attribute__((always_inline)) INLINE static int fof_gpart_searched_again(
+    const struct fof_props *props, const size_t index) {
+
+  const size_t label = props->incremental_label[index];
+
+  return label == props->incremental_num_labels ||
+         props->incremental_gpart_marginal[index] ||
+         props->incremental_label_moved[label];
+}
+
+/**
+ * @brief Mapper function to find the record of the last full FOF search of
+ * each #gpart and flag the cores in which particles moved too much since.
+ *
+ * @param map_data The array of #gpart.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to the #space.
+ */
+void fof_match_incremental_records_mapper(void *map_data, int num_elements,
+                                          void *extra_data) {
+
+  const struct space *s = (struct space *)extra_data;
+  struct fof_props *props = s->e->fof_properties;
+  const struct gpart *gparts = (const struct gpart *)map_data;
+  const int periodic = s->periodic;
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+
+  /* Offset into the global list of particles */
+  const ptrdiff_t offset = gparts - s->gparts;
+
+  const double tolerance =
+      props->incremental_tolerance_ratio * sqrt(props->l_x2);
+  const double tolerance2 = tolerance * tolerance;
+
+  for (int i = 0; i < num_elements; ++i) {
+
+    const struct gpart *gp = &gparts[i];
+    const size_t index = offset + i;
+
+    /* Start without a label */
+    props->incremental_label[index] = props->incremental_num_labels;
+    props->incremental_gpart_marginal[index] = 0;
+
+    if (!fof_gpart_is_searched(gp)) continue;
+
+    struct fof_incremental_record key;
+    key.id = fof_gpart_id(s, gp);
+    const struct fof_incremental_record *record =
+        (const struct fof_incremental_record *)bsearch(
+            &key, props->incremental_records, props->incremental_num_records,
+            sizeof(struct fof_incremental_record), fof_incremental_record_cmp);
+
+    /* Not linkable here at the last full search? */
+    if (record == NULL) continue;
+
+    props->incremental_label[index] = record->label;
+    props->incremental_gpart_marginal[index] = record->marginal;
+    atomic_inc(&props->incremental_label_count[record->label]);
+
+    /* Displacement since the last full search */
+    double r2 = 0.;
+    for (int k = 0; k < 3; k++) {
+      double dx = gp->x[k] - record->x[k];
+      if (periodic) dx = nearest(dx, dim[k]);
+      r2 += dx * dx;
+    }
+
+    if (r2 > tolerance2) props->incremental_label_moved[record->label] = 1;
+  }
+}
+
+/**
+ * @brief Mapper function to link again the particles of the cores of the
+ * last full FOF search that can be trusted.
+ *
+ * @param map_data The array of #gpart.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to the #space.
+ */
+void fof_seed_incremental_groups_mapper(void *map_data, int num_elements,
+                                        void *extra_data) {
+
+  const struct space *s = (struct space *)extra_data;
+  const struct fof_props *props = s->e->fof_properties;
+  const struct gpart *gparts = (const struct gpart *)map_data;
+  size_t *group_index = props->group_index;
+
+  /* Offset into the global list of particles */
+  const ptrdiff_t offset = gparts - s->gparts;
+
+  for (int i = 0; i < num_elements; ++i) {
+
+    const size_t index = offset + i;
+
+    if (!fof_gpart_is_searched(&gparts[i])) continue;
+
+    /* The label of a particle is only trusted if it is not searched again */
+    const size_t label = props->incremental_label[index];
+    if (label == props->incremental_num_labels ||
+        props->incremental_label_moved[label])
+      continue;
+
+    /* The first particle of a core is the one all the others link to */
+    const size_t first =
+        atomic_cas(&props->incremental_label_root[label], (size_t)-1, index);
+
+    if (first != (size_t)-1) {
+      size_t root_i = fof_find(index, group_index);
+      const size_t root_j = fof_find(first, group_index);
+      if (root_i != root_j) fof_union(&root_i, root_j, group_index);
+    }
+  }
+}
+
+/**
+ * @brief Recursively flag the cells containing particles whose links have to
+ * be searched for again.
+ *
+ * @param s The #space containing the particles.
+ * @param c The #cell.
+ *
+ * @return Whether the cell was flagged.
+ */
+static int fof_flag_moved_cells_rec(const struct space *s, struct cell *c) {
+
+  int moved = 0;
+
+  if (c->split) {
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        moved |= fof_flag_moved_cells_rec(s, c->progeny[k]);
+  } else {
+    const size_t offset = c->grav.parts - s->gparts;
+    for (int i = 0; i < c->grav.count; i++) {
+      if (fof_gpart_is_searched(&c->grav.parts[i]) &&
+          fof_gpart_searched_again(s->e->fof_properties, offset + i)) {
+        moved = 1;
+        break;
+      }
+    }
+  }
+
+  if (moved)
+    cell_set_flag(c, cell_flag_fof_moved);
+  else
+    cell_clear_flag(c, cell_flag_fof_moved);
+
+  return moved;
+}
+
+/**
+ * @brief Mapper function to flag the local cells containing particles whose
+ * links have to be searched for again.
+ *
+ * @param map_data The list of local top-level cell indices.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to the #space.
+ */
+void fof_flag_moved_cells_mapper(void *map_data, int num_elements,
+                                 void *extra_data) {
+
+  const struct space *s = (struct space *)extra_data;
+  const int *local_cells = (int *)map_data;
+
+  for (int ind = 0; ind < num_elements; ind++)
+    fof_flag_moved_cells_rec(s, &s->cells_top[local_cells[ind]]);
+}
+
+/**
+ * @brief Prepare an incremental FOF search re-using the groups of the last
+ * full search.
+ *
+ * The last full search split its groups into cores, linked by separations
+ * shorter than the linking length minus twice the tolerance, and flagged as
+ * marginal the particles of different cores with a separation within twice
+ * the tolerance of the linking length (see fof_store_incremental_labels()).
+ * As long as none of their particles moved by more than the tolerance, the
+ * cores are still linked and are linked together again right away. All the
+ * other separations that can have crossed the linking length involve a
+ * marginal particle, a particle of a core that cannot be trusted or a
+ * particle unknown to the last search. Only the cells containing such
+ * particles are searched, both internally and against all their neighbours,
+ * such that the groups are exactly the ones a full search would find.
+ *
+ * Does nothing (and the next search is a full one) if the incremental mode
+ * is switched off, if there was no full search yet, if not allowed by the
+ * caller or if more than half of the particles would be searched again.
+ *
+ * Must be called after fof_allocate().
+ *
+ * @param props The properties of the FOF scheme.
+ * @param s The #space containing the particles.
+ * @param allow_incremental Can the current call be incremental?
+ */
+void fof_prepare_incremental(struct fof_props *props, const struct space *s,
+                             const int allow_incremental) {
+
+  props->incremental_search = 0;
+
+  if (props->incremental_tolerance_ratio <= 0. || !allow_incremental ||
+      props->incremental_records == NULL)
+    return;
+
+  const int verbose = s->e->verbose;
+  const ticks tic = getticks();
+
+  const size_t nr_gparts = s->nr_gparts;
+  const size_t num_labels = props->incremental_num_labels;
+
+  props->incremental_label = (size_t *)swift_malloc(
+      "fof_incremental_label", nr_gparts * sizeof(size_t));
+  props->incremental_gpart_marginal = (char *)swift_malloc(
+      "fof_incremental_marginal", nr_gparts * sizeof(char));
+  props->incremental_label_moved = (char *)swift_malloc(
+      "fof_incremental_moved", num_labels * sizeof(char));
+  props->incremental_label_count = (size_t *)swift_malloc(
+      "fof_incremental_count", num_labels * sizeof(size_t));
+  props->incremental_label_root = (size_t *)swift_malloc(
+      "fof_incremental_root", num_labels * sizeof(size_t));
+  if ((nr_gparts > 0 && (props->incremental_label == NULL ||
+                         props->incremental_gpart_marginal == NULL)) ||
+      (num_labels > 0 && (props->incremental_label_moved == NULL ||
+                          props->incremental_label_count == NULL ||
+                          props->incremental_label_root == NULL)))
+    error("Failed to allocate the labels for an incremental FOF search.");
+
+  bzero(props->incremental_label_moved, num_labels * sizeof(char));
+  bzero(props->incremental_label_count, num_labels * sizeof(size_t));
+  memset(props->incremental_label_root, 0xff, num_labels * sizeof(size_t));
+
+  /* Find the particles of the last full search and the cores in which
+   * particles moved too much... */
+  threadpool_map(&s->e->threadpool, fof_match_incremental_records_mapper,
+                 s->gparts, nr_gparts, sizeof(struct gpart),
+                 threadpool_auto_chunk_size, (void *)s);
+
+  /* ...as well as the cores of which particles are gone. */
+  for (size_t i = 0; i < props->incremental_num_records; ++i)
+    props->incremental_label_count[props->incremental_records[i].label]--;
+  for (size_t i = 0; i < num_labels; ++i)
+    if (props->incremental_label_count[i] != 0)
+      props->incremental_label_moved[i] = 1;
+
+  /* Count the particles to search again */
+  size_t num_searched = 0, num_again = 0;
+  for (size_t i = 0; i < nr_gparts; ++i) {
+    if (!fof_gpart_is_searched(&s->gparts[i])) continue;
+    num_searched++;
+    num_again += fof_gpart_searched_again(props, i);
+  }
+
+  /* Not worth it? Search everything and start afresh. */
+  if (2 * num_again > num_searched) {
+    fof_free_incremental_arrays(props);
+
+    if (verbose)
+      message("%zu of %zu particles to search again, running a full search.",
+              num_again, num_searched);
+    return;
+  }
+
+  /* Link the trusted cores again... */
+  threadpool_map(&s->e->threadpool, fof_seed_incremental_groups_mapper,
+                 s->gparts, nr_gparts, sizeof(struct gpart),
+                 threadpool_auto_chunk_size, (void *)s);
+
+  /* ...and find the cells to search. */
+  threadpool_map(&s->e->threadpool, fof_flag_moved_cells_mapper,
+                 s->local_cells_top, s->nr_local_cells, sizeof(int),
+                 threadpool_auto_chunk_size, (void *)s);
+
+  props->incremental_search = 1;
+
+  if (verbose)
+    message("%zu of %zu particles to search again. took %.3f %s.", num_again,
+            num_searched, clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+}
+
 /**
  * @brief Perform the attaching operation using union-find on a given leaf-cell
  *
@@ -2078,6 +2704,31 @@ void fof_update_group_size_mapper(hashmap_key_t key, hashmap_value_t *value,
   atomic_add(&group_size[key], value->value_st);
 }
 
+/**
+ * @brief Mapper function to point every particle directly at its root once
+ * the local linking is complete.
+ *
+ * @param map_data An array of #gpart%s.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to a #space.
+ */
+void fof_flatten_group_index_mapper(void *map_data, int num_elements,
+                                    void *extra_data) {
+
+  /* Retrieve mapped data. */
+  struct space *s = (struct space *)extra_data;
+  struct gpart *gparts = (struct gpart *)map_data;
+  size_t *restrict group_index = s->e->fof_properties->group_index;
+
+  /* Offset into gparts array. */
+  const size_t gparts_offset = (size_t)(gparts - s->gparts);
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const size_t i = gparts_offset + ind;
+    group_index[i] = fof_find(i, group_index);
+  }
+}
+
 /**
  * @brief Mapper function to calculate the group sizes.
  *
@@ -2148,27 +2799,49 @@ static INLINE void fof_update_group_size_iterator(hashmap_key_t key,
   atomic_add(&group_size[key], value->value_st);
 }
 
+/* Merger function to add the group masses and sizes of two hash tables. */
+static INLINE void fof_merge_group_mass_merger(hashmap_key_t key,
+                                               hashmap_value_t *value,
+                                               const hashmap_value_t *other,
+                                               void *data) {
+  value->value_dbl += other->value_dbl;
+  value->value_st += other->value_st;
+}
+
+/*! Data passed to #fof_calc_group_mass_mapper. */
+struct fof_calc_group_mass_data {
+
+  /*! The #space we work on. */
+  const struct space *s;
+
+  /*! One hash table per thread of the threadpool. */
+  hashmap_t *maps;
+};
+
 /**
  * @brief Mapper function to calculate the group masses.
  *
+ * The masses and sizes are accumulated in the hash table of the calling
+ * thread. They are merged and copied to the group arrays once all the
+ * particles have been processed.
+ *
  * @param map_data An array of #gpart%s.
  * @param num_elements Chunk size.
- * @param extra_data Pointer to a #space.
+ * @param extra_data Pointer to a #fof_calc_group_mass_data.
  */
 void fof_calc_group_mass_mapper(void *map_data, int num_elements,
                                 void *extra_data) {
 
   /* Retrieve mapped data. */
-  struct space *s = (struct space *)extra_data;
+  struct fof_calc_group_mass_data *mass_data =
+      (struct fof_calc_group_mass_data *)extra_data;
+  const struct space *s = mass_data->s;
   struct gpart *gparts = (struct gpart *)map_data;
-  double *group_mass = s->e->fof_properties->group_mass;
-  long long *group_size = s->e->fof_properties->final_group_size;
   const size_t group_id_default = s->e->fof_properties->group_id_default;
   const size_t group_id_offset = s->e->fof_properties->group_id_offset;
 
-  /* Create hash table. */
-  hashmap_t map;
-  hashmap_init(&map);
+  /* Hash table of this thread. */
+  hashmap_t *map = &mass_data->maps[threadpool_gettid()];
 
   /* Loop over particles and increment the group mass for groups above
    * min_group_size. */
@@ -2178,7 +2851,7 @@ void fof_calc_group_mass_mapper(void *map_data, int num_elements,
     if (gparts[ind].fof_data.group_id != group_id_default) {
 
       hashmap_key_t index = gparts[ind].fof_data.group_id - group_id_offset;
-      hashmap_value_t *data = hashmap_get(&map, index);
+      hashmap_value_t *data = hashmap_get(map, index);
 
       /* Update group mass */
       if (data != NULL) {
@@ -2188,14 +2861,6 @@ void fof_calc_group_mass_mapper(void *map_data, int num_elements,
         error("Couldn't find key (%zu) or create new one.", index);
     }
   }
-
-  /* Update the group mass array. */
-  if (map.size > 0)
-    hashmap_iterate(&map, fof_update_group_mass_iterator, group_mass);
-  if (map.size > 0)
-    hashmap_iterate(&map, fof_update_group_size_iterator, group_size);
-
-  hashmap_free(&map);
 }
 
 #ifdef WITH_MPI
@@ -2636,10 +3301,30 @@ void fof_calc_group_mass(struct fof_props *props, const struct space *s,
 
 #else
 
-  /* Increment the group mass for groups above min_group_size. */
-  threadpool_map(&s->e->threadpool, fof_calc_group_mass_mapper, gparts,
-                 nr_gparts, sizeof(struct gpart), threadpool_auto_chunk_size,
-                 (struct space *)s);
+  /* Increment the group mass for groups above min_group_size, using one
+   * hash table per thread. */
+  struct threadpool *tp = &s->e->threadpool;
+  struct fof_calc_group_mass_data mass_data;
+  mass_data.s = s;
+  mass_data.maps = (hashmap_t *)malloc(tp->num_threads * sizeof(hashmap_t));
+  if (mass_data.maps == NULL)
+    error("Failed to allocate the hash tables for the group masses.");
+  for (int k = 0; k < tp->num_threads; k++) hashmap_init(&mass_data.maps[k]);
+
+  threadpool_map(tp, fof_calc_group_mass_mapper, gparts, nr_gparts,
+                 sizeof(struct gpart), threadpool_auto_chunk_size, &mass_data);
+
+  /* Combine the tables and update the group mass and size arrays. */
+  hashmap_merge_parallel(mass_data.maps, tp->num_threads,
+                         fof_merge_group_mass_merger, /*data=*/NULL, tp);
+  hashmap_t *map = &mass_data.maps[0];
+  if (map->size > 0) {
+    hashmap_iterate(map, fof_update_group_mass_iterator, group_mass);
+    hashmap_iterate(map, fof_update_group_size_iterator,
+                    props->final_group_size);
+  }
+  hashmap_free(map);
+  free(mass_data.maps);
 
   /* Direct pointers to the arrays */
   long long *max_part_density_index = props->max_part_density_index;
@@ -3916,6 +4601,17 @@ void fof_compute_local_sizes(struct fof_props *props, struct space *s) {
   node_offset = nr_gparts_cumulative - nr_gparts_local;
 #endif
 
+  /* Now that no more links are created, point all the particles directly at
+   * their local root so that all the later finds are a single hop */
+  const ticks tic_flatten = getticks();
+
+  threadpool_map(&s->e->threadpool, fof_flatten_group_index_mapper, gparts,
+                 nr_gparts, sizeof(struct gpart), threadpool_auto_chunk_size,
+                 s);
+  if (verbose)
+    message("FOF flattening of the group index took (FOF SCALING): %.3f %s.",
+            clocks_from_ticks(getticks() - tic_flatten), clocks_getunit());
+
   /* Compute the group sizes of the local fragments
    * (in non-MPI land that is the final group size of the haloes) */
   const ticks tic_calc_group_size = getticks();
@@ -3933,6 +4629,376 @@ void fof_compute_local_sizes(struct fof_props *props, struct space *s) {
             clocks_getunit());
 }
 
+/**
+ * @brief Find the cores or the marginal particles between two leaf cells (or
+ * within a single one).
+ *
+ * Pairs closer than the linking length minus twice the tolerance are linked
+ * into cores. Once the cores are complete, both particles of a pair of
+ * different cores within twice the tolerance of the linking length are
+ * flagged as marginal.
+ *
+ * @param s The #space containing the particles.
+ * @param mark_marginal Flag the marginal particles rather than link cores?
+ * @param ci The first #cell.
+ * @param cj The second #cell (or ci for a self search).
+ */
+static void fof_mark_cores_leaves(const struct space *s,
+                                  const int mark_marginal,
+                                  const struct cell *ci,
+                                  const struct cell *cj) {
+
+  const struct fof_props *props = s->e->fof_properties;
+  size_t *core_index = props->incremental_label;
+  char *marginal = props->incremental_gpart_marginal;
+
+  /* Width of the band around the linking length, with a margin for the
+   * single-precision distances of the search */
+  const double l_x = sqrt(props->l_x2);
+  const double band = 2.001 * props->incremental_tolerance_ratio * l_x;
+  const double inner = max(l_x - band, 0.);
+  const double inner2 = inner * inner;
+  const double outer2 = (l_x + band) * (l_x + band);
+
+  const int self = (ci == cj);
+  const struct gpart *gparts_i = ci->grav.parts;
+  const struct gpart *gparts_j = cj->grav.parts;
+  const size_t offset_i = gparts_i - s->gparts;
+  const size_t offset_j = gparts_j - s->gparts;
+
+  /* Account for boundary conditions */
+  double shift[3] = {0.0, 0.0, 0.0};
+  for (int k = 0; k < 3; k++) {
+    const double diff = cj->loc[k] - ci->loc[k];
+    if (s->periodic && diff < -s->dim[k] * 0.5)
+      shift[k] = s->dim[k];
+    else if (s->periodic && diff > s->dim[k] * 0.5)
+      shift[k] = -s->dim[k];
+  }
+
+  struct fof_grid grid;
+  fof_grid_build(&grid, gparts_j, cj->grav.count, l_x + band);
+
+  for (int i = 0; i < ci->grav.count; i++) {
+
+    const struct gpart *pi = &gparts_i[i];
+    if (!fof_gpart_is_searched(pi)) continue;
+
+    const double pix = pi->x[0] - shift[0];
+    const double piy = pi->x[1] - shift[1];
+    const double piz = pi->x[2] - shift[2];
+
+    /* Bin of pi on the grid of cj */
+    const int bx = fof_grid_coord(&grid, pix, 0);
+    const int by = fof_grid_coord(&grid, piy, 1);
+    const int bz = fof_grid_coord(&grid, piz, 2);
+
+    /* Early abort if pi is out of range of all the particles of cj */
+    if (bx < -1 || bx > grid.dim[0] || by < -1 || by > grid.dim[1] ||
+        bz < -1 || bz > grid.dim[2])
+      continue;
+
+    size_t root_i = fof_find(offset_i + i, core_index);
+
+    /* Loop over the adjacent bins. */
+    for (int nx = max(bx - 1, 0); nx <= min(bx + 1, grid.dim[0] - 1); nx++) {
+      for (int ny = max(by - 1, 0); ny <= min(by + 1, grid.dim[1] - 1);
+           ny++) {
+        for (int nz = max(bz - 1, 0); nz <= min(bz + 1, grid.dim[2] - 1);
+             nz++) {
+
+          const int nb = (nx * grid.dim[1] + ny) * grid.dim[2] + nz;
+
+          for (int jj = grid.bin_start[nb]; jj < grid.bin_start[nb + 1];
+               jj++) {
+
+            /* Only consider each pair once. */
+            const int j = grid.index[jj];
+            if (self && j <= i) continue;
+
+            const struct gpart *pj = &gparts_j[j];
+
+            const double dx = pix - pj->x[0];
+            const double dy = piy - pj->x[1];
+            const double dz = piz - pj->x[2];
+            const double r2 = dx * dx + dy * dy + dz * dz;
+
+            if (!mark_marginal && r2 < inner2) {
+              const size_t root_j = fof_find(offset_j + j, core_index);
+              if (root_i != root_j) fof_union(&root_i, root_j, core_index);
+            } else if (mark_marginal && r2 >= inner2 && r2 < outer2 &&
+                       root_i != fof_find(offset_j + j, core_index)) {
+              marginal[offset_i + i] = 1;
+              marginal[offset_j + j] = 1;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  fof_grid_clean(&grid);
+}
+
+/**
+ * @brief Recursively find the cores or the marginal particles between two
+ * cells.
+ *
+ * @param s The #space containing the particles.
+ * @param mark_marginal Flag the marginal particles rather than link cores?
+ * @param search_r2 The square of the largest separation of interest.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ */
+static void fof_mark_cores_pair_rec(const struct space *s,
+                                    const int mark_marginal,
+                                    const double search_r2,
+                                    const struct cell *ci,
+                                    const struct cell *cj) {
+
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+
+  /* Return if cells are out of range of each other. */
+  if (cell_min_dist(ci, cj, dim) > search_r2) return;
+
+  if (ci->split && cj->split) {
+    for (int k = 0; k < 8; k++)
+      if (ci->progeny[k] != NULL)
+        for (int l = 0; l < 8; l++)
+          if (cj->progeny[l] != NULL)
+            fof_mark_cores_pair_rec(s, mark_marginal, search_r2,
+                                    ci->progeny[k], cj->progeny[l]);
+  } else if (ci->split) {
+    for (int k = 0; k < 8; k++)
+      if (ci->progeny[k] != NULL)
+        fof_mark_cores_pair_rec(s, mark_marginal, search_r2, ci->progeny[k],
+                                cj);
+  } else if (cj->split) {
+    for (int k = 0; k < 8; k++)
+      if (cj->progeny[k] != NULL)
+        fof_mark_cores_pair_rec(s, mark_marginal, search_r2, ci,
+                                cj->progeny[k]);
+  } else {
+    fof_mark_cores_leaves(s, mark_marginal, ci, cj);
+  }
+}
+
+/**
+ * @brief Recursively find the cores or the marginal particles in a cell.
+ *
+ * @param s The #space containing the particles.
+ * @param mark_marginal Flag the marginal particles rather than link cores?
+ * @param search_r2 The square of the largest separation of interest.
+ * @param c The #cell.
+ */
+static void fof_mark_cores_self_rec(const struct space *s,
+                                    const int mark_marginal,
+                                    const double search_r2,
+                                    const struct cell *c) {
+
+  if (c->split) {
+    for (int k = 0; k < 8; k++) {
+      if (c->progeny[k] != NULL) {
+        fof_mark_cores_self_rec(s, mark_marginal, search_r2, c->progeny[k]);
+
+        for (int l = k + 1; l < 8; l++)
+          if (c->progeny[l] != NULL)
+            fof_mark_cores_pair_rec(s, mark_marginal, search_r2,
+                                    c->progeny[k], c->progeny[l]);
+      }
+    }
+  } else {
+    fof_mark_cores_leaves(s, mark_marginal, c, c);
+  }
+}
+
+/**
+ * @brief Find the cores or the marginal particles of some local top-level
+ * cells and of their local neighbours.
+ *
+ * @param s The #space containing the particles.
+ * @param mark_marginal Flag the marginal particles rather than link cores?
+ * @param local_cells The list of local top-level cell indices.
+ * @param num_cells The number of cells in the list.
+ */
+static void fof_mark_cores_top_cells(const struct space *s,
+                                     const int mark_marginal,
+                                     const int *local_cells,
+                                     const int num_cells) {
+
+  const struct fof_props *props = s->e->fof_properties;
+  const int *cdim = s->cdim;
+  const int nodeID = s->e->nodeID;
+
+  const double l_x = sqrt(props->l_x2);
+  const double band = 2.001 * props->incremental_tolerance_ratio * l_x;
+  const double search_r2 = (l_x + band) * (l_x + band);
+
+  for (int ind = 0; ind < num_cells; ind++) {
+
+    const int cid = local_cells[ind];
+    const struct cell *ci = &s->cells_top[cid];
+    if (ci->grav.count == 0) continue;
+
+    fof_mark_cores_self_rec(s, mark_marginal, search_r2, ci);
+
+    /* Loop over the local neighbours, as for the FOF pair tasks */
+    const int i = cid / (cdim[1] * cdim[2]);
+    const int j = (cid / cdim[2]) % cdim[1];
+    const int k = cid % cdim[2];
+
+    for (int ii = -1; ii < 2; ii++) {
+      int iii = i + ii;
+      if (!s->periodic && (iii < 0 || iii >= cdim[0])) continue;
+      iii = (iii + cdim[0]) % cdim[0];
+      for (int jj = -1; jj < 2; jj++) {
+        int jjj = j + jj;
+        if (!s->periodic && (jjj < 0 || jjj >= cdim[1])) continue;
+        jjj = (jjj + cdim[1]) % cdim[1];
+        for (int kk = -1; kk < 2; kk++) {
+          int kkk = k + kk;
+          if (!s->periodic && (kkk < 0 || kkk >= cdim[2])) continue;
+          kkk = (kkk + cdim[2]) % cdim[2];
+
+          const int cjd = cell_getid(cdim, iii, jjj, kkk);
+          const struct cell *cj = &s->cells_top[cjd];
+
+          if (cid >= cjd || cj->grav.count == 0 || cj->nodeID != nodeID)
+            continue;
+
+          fof_mark_cores_pair_rec(s, mark_marginal, search_r2, ci, cj);
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Mapper function to link the cores of the local top-level cells.
+ *
+ * @param map_data The list of local top-level cell indices.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to the #space.
+ */
+void fof_link_cores_mapper(void *map_data, int num_elements,
+                           void *extra_data) {
+
+  fof_mark_cores_top_cells((struct space *)extra_data,
+                           /*mark_marginal=*/0, (int *)map_data,
+                           num_elements);
+}
+
+/**
+ * @brief Mapper function to flag the marginal particles of the local
+ * top-level cells.
+ *
+ * @param map_data The list of local top-level cell indices.
+ * @param num_elements Chunk size.
+ * @param extra_data Pointer to the #space.
+ */
+void fof_mark_marginal_mapper(void *map_data, int num_elements,
+                              void *extra_data) {
+
+  fof_mark_cores_top_cells((struct space *)extra_data,
+                           /*mark_marginal=*/1, (int *)map_data,
+                           num_elements);
+}
+
+/**
+ * @brief Remember the particles of a full FOF search such that the next
+ * calls can be incremental.
+ *
+ * The particles are split into cores, linked by separations shorter than the
+ * linking length minus twice the tolerance. Such links survive as long as
+ * none of their two particles moves by more than the tolerance. The
+ * particles of different cores with a separation within twice the tolerance
+ * of the linking length are flagged as marginal and always searched again.
+ * The records are kept, sorted by particle ID, until the next full search.
+ *
+ * An incremental call only releases its own arrays. Must be called after the
+ * local linking.
+ *
+ * @param props The properties of the FOF scheme.
+ * @param s The #space containing the particles.
+ */
+void fof_store_incremental_labels(struct fof_props *props,
+                                  const struct space *s) {
+
+  if (props->incremental_tolerance_ratio <= 0.) return;
+
+  /* Keep the records of the last full search */
+  if (props->incremental_search) {
+    fof_free_incremental_arrays(props);
+    props->incremental_search = 0;
+    return;
+  }
+
+  const ticks tic = getticks();
+
+  const size_t nr_gparts = s->nr_gparts;
+  struct gpart *gparts = s->gparts;
+
+  /* The arrays of the incremental search hold the cores and marginal flags */
+  props->incremental_label = (size_t *)swift_malloc(
+      "fof_incremental_label", nr_gparts * sizeof(size_t));
+  props->incremental_gpart_marginal = (char *)swift_malloc(
+      "fof_incremental_marginal", nr_gparts * sizeof(char));
+  if (nr_gparts > 0 && (props->incremental_label == NULL ||
+                        props->incremental_gpart_marginal == NULL))
+    error("Failed to allocate the cores of the FOF search.");
+
+  threadpool_map(&s->e->threadpool, fof_set_initial_group_index_mapper,
+                 props->incremental_label, nr_gparts, sizeof(size_t),
+                 threadpool_auto_chunk_size, props->incremental_label);
+  bzero(props->incremental_gpart_marginal, nr_gparts * sizeof(char));
+
+  /* Link the cores first, then find the links in between them that can have
+   * crossed the linking length */
+  threadpool_map(&s->e->threadpool, fof_link_cores_mapper,
+                 s->local_cells_top, s->nr_local_cells, sizeof(int),
+                 threadpool_auto_chunk_size, (void *)s);
+  threadpool_map(&s->e->threadpool, fof_mark_marginal_mapper,
+                 s->local_cells_top, s->nr_local_cells, sizeof(int),
+                 threadpool_auto_chunk_size, (void *)s);
+
+  /* Record the linkable particles... */
+  size_t num_records = 0;
+  for (size_t i = 0; i < nr_gparts; ++i)
+    num_records += fof_gpart_is_searched(&gparts[i]);
+
+  swift_free("fof_incremental_records", props->incremental_records);
+  props->incremental_records = (struct fof_incremental_record *)swift_malloc(
+      "fof_incremental_records",
+      max(num_records, (size_t)1) * sizeof(struct fof_incremental_record));
+  if (props->incremental_records == NULL)
+    error("Failed to allocate the records of the FOF search.");
+
+  size_t count = 0;
+  for (size_t i = 0; i < nr_gparts; ++i) {
+    if (!fof_gpart_is_searched(&gparts[i])) continue;
+
+    struct fof_incremental_record *record = &props->incremental_records[count];
+    record->id = fof_gpart_id(s, &gparts[i]);
+    record->label = fof_find(i, props->incremental_label);
+    record->marginal = props->incremental_gpart_marginal[i];
+    for (int k = 0; k < 3; k++) record->x[k] = gparts[i].x[k];
+    count++;
+  }
+
+  /* ...sorted by ID to find them again. */
+  qsort(props->incremental_records, num_records,
+        sizeof(struct fof_incremental_record), fof_incremental_record_cmp);
+
+  props->incremental_num_records = num_records;
+  props->incremental_num_labels = nr_gparts;
+
+  fof_free_incremental_arrays(props);
+
+  if (s->e->verbose)
+    message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
+            clocks_getunit());
+}
+
 /**
  * @brief Compute all the group properties
  *
@@ -4367,6 +5433,14 @@ void fof_struct_dump(const struct fof_props *props, FILE *stream) {
   temp.max_part_density_index = NULL;
   temp.max_part_density = NULL;
   temp.group_links = NULL;
+  temp.incremental_search = 0;
+  temp.incremental_records = NULL;
+  temp.incremental_num_records = 0;
+  temp.incremental_label = NULL;
+  temp.incremental_gpart_marginal = NULL;
+  temp.incremental_label_moved = NULL;
+  temp.incremental_label_count = NULL;
+  temp.incremental_label_root = NULL;
 
   restart_write_blocks((void *)&temp, sizeof(struct fof_props), 1, stream,
                        "fof_props", "fof_props");
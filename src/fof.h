@@ -75,6 +75,39 @@ struct fof_props {
   /*! The types of particles to use for attaching */
   int fof_attach_types[swift_type_count];
 
+  /* ----------- Incremental FOF for black hole seeding ------- */
+
+  /*! Displacement, in units of the linking length, above which the links of
+   *  a particle are searched for again in an incremental call (0 = off). */
+  double incremental_tolerance_ratio;
+
+  /*! Is the current call re-using the groups of the last full search? */
+  int incremental_search;
+
+  /*! The linkable particles of the last full search, sorted by ID. */
+  struct fof_incremental_record *incremental_records;
+
+  /*! Number of records of the last full search. */
+  size_t incremental_num_records;
+
+  /*! Number of core labels given out by the last full search. */
+  size_t incremental_num_labels;
+
+  /*! For each #gpart: label of its core at the last full search. */
+  size_t *incremental_label;
+
+  /*! For each #gpart: was it marginal at the last full search? */
+  char *incremental_gpart_marginal;
+
+  /*! For each label: has any of its particles moved too much or gone? */
+  char *incremental_label_moved;
+
+  /*! For each label: number of its particles found in this call. */
+  size_t *incremental_label_count;
+
+  /*! For each label: index of its first particle in this call. */
+  size_t *incremental_label_root;
+
   /* ------------  Group properties ----------------- */
 
   /*! Number of groups */
@@ -141,6 +174,22 @@ struct group_length {
 
 } SWIFT_STRUCT_ALIGN;
 
+/* A linkable particle as seen by the last full FOF search. */
+struct fof_incremental_record {
+
+  /*! ID of the particle */
+  long long id;
+
+  /*! Label of the core (see fof_store_incremental_labels()) */
+  size_t label;
+
+  /*! Position of the particle */
+  double x[3];
+
+  /*! Was a link of the particle too close to the linking length? */
+  char marginal;
+};
+
 #ifdef WITH_MPI
 
 /* MPI message required for FOF. */
@@ -195,7 +244,11 @@ void fof_init(struct fof_props *props, struct swift_params *params,
               const int stand_alone_fof);
 void fof_create_mpi_types(void);
 void fof_allocate(const struct space *s, struct fof_props *props);
+void fof_prepare_incremental(struct fof_props *props, const struct space *s,
+                             const int allow_incremental);
 void fof_compute_local_sizes(struct fof_props *props, struct space *s);
+void fof_store_incremental_labels(struct fof_props *props,
+                                  const struct space *s);
 void fof_search_foreign_cells(struct fof_props *props, const struct space *s);
 void fof_link_attachable_particles(struct fof_props *props,
                                    const struct space *s);
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2018 James Willis (james.s.willis@durham.ac.uk)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_FOF_UNION_FIND_H
+#define SWIFT_FOF_UNION_FIND_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <stddef.h>
+
+/* Local headers. */
+#include "atomic.h"
+#include "inline.h"
+
+/**
+ * @brief Finds the local root ID of the group a particle exists in.
+ *
+ * We follow the group_index array until reaching the root of the group and
+ * halve the path on the way: every element visited is re-pointed to its
+ * grand-parent. The re-pointing is a compare-and-swap that only succeeds if
+ * the element still points to the parent we read, so that concurrent finds
+ * and unions never lose a link and no thread ever waits on another.
+ *
+ * @param i The index of the particle.
+ * @param group_index Array of group root indices.
+ */
+__attribute__((always_inline)) INLINE static size_t fof_find(
+    const size_t i, size_t *group_index) {
+
+  size_t root = i;
+  size_t parent = group_index[root];
+
+  while (root != parent) {
+
+    /* Skip a level, both in the array and in our walk. */
+    const size_t grandparent = group_index[parent];
+    if (grandparent != parent)
+      atomic_cas(&group_index[root], parent, grandparent);
+
+    root = grandparent;
+    parent = group_index[root];
+  }
+
+  return root;
+}
+
+/**
+ * @brief Atomically link a root to a new root.
+ *
+ * @param group_index The list of group roots.
+ * @param root The root to link.
+ * @param new_root The root it should point to.
+ *
+ * @return 1 If successful, 0 if another thread linked root in the meantime.
+ */
+__attribute__((always_inline)) INLINE static int fof_link_root(
+    size_t *group_index, const size_t root, const size_t new_root) {
+
+  return atomic_cas(&group_index[root], root, new_root) == root;
+}
+
+/**
+ * @brief Unifies two groups by setting them to the same root.
+ *
+ * We always link the root with the larger index to the one with the smaller
+ * index. Chains can hence only go down in index which guarantees the absence
+ * of cycles when many threads link concurrently.
+ *
+ * @param root_i The root of the first group. Will be updated.
+ * @param root_j The root of the second group.
+ * @param group_index The list of group roots.
+ */
+__attribute__((always_inline)) INLINE static void fof_union(
+    size_t *restrict root_i, const size_t root_j,
+    size_t *restrict group_index) {
+
+  int result = 0;
+
+  /* Loop until the root can be set to a new value. */
+  do {
+    const size_t root_i_new = fof_find(*root_i, group_index);
+    const size_t root_j_new = fof_find(root_j, group_index);
+
+    /* Skip particles in the same group. */
+    if (root_i_new == root_j_new) {
+      *root_i = root_i_new;
+      return;
+    }
+
+    /* If the root ID of pj is lower than pi's root ID set pi's root to point to
+     * pj's. Otherwise set pj's root to point to pi's.*/
+    if (root_j_new < root_i_new) {
+
+      /* Link the root, provided it is still a root. */
+      result = fof_link_root(group_index, root_i_new, root_j_new);
+
+      /* Update root_i on the fly. */
+      *root_i = root_j_new;
+    } else {
+
+      /* Link the root, provided it is still a root. */
+      result = fof_link_root(group_index, root_j_new, root_i_new);
+
+      /* Update root_i on the fly. */
+      *root_i = root_i_new;
+    }
+  } while (result != 1);
+}
+
+#endif /* SWIFT_FOF_UNION_FIND_H */
@@ -41,8 +41,14 @@
 #define gravity_props_default_rebuild_frequency 0.01f
 #define gravity_props_default_rebuild_active_fraction 1.01f  // > 1 means never
 #define gravity_props_default_distributed_mesh 0
+#define gravity_props_default_distributed_mesh_pencils 0
+#define gravity_props_default_mesh_assignment_order 2
+#define gravity_props_default_mesh_interlacing 0
 #define gravity_props_default_max_adaptive_softening FLT_MAX
 #define gravity_props_default_min_adaptive_softening 0.f
+#define gravity_props_default_use_MAC_cache 0
+#define gravity_props_default_MAC_cache_tolerance 0.1f
+#define gravity_props_default_MAC_cache_entries_per_cell 4.f
 
 void gravity_props_init(struct gravity_props *p, struct swift_params *params,
                         const struct phys_const *phys_const,
@@ -71,8 +77,17 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
     p->distributed_mesh =
         parser_get_opt_param_int(params, "Gravity:distributed_mesh",
                                  gravity_props_default_distributed_mesh);
+    p->distributed_mesh_pencils = parser_get_opt_param_int(
+        params, "Gravity:distributed_mesh_pencils",
+        gravity_props_default_distributed_mesh_pencils);
     p->mesh_uses_local_patches =
         parser_get_opt_param_int(params, "Gravity:mesh_uses_local_patches", 1);
+    p->mesh_assignment_order =
+        parser_get_opt_param_int(params, "Gravity:mesh_assignment_order",
+                                 gravity_props_default_mesh_assignment_order);
+    p->mesh_interlacing =
+        parser_get_opt_param_int(params, "Gravity:mesh_interlacing",
+                                 gravity_props_default_mesh_interlacing);
     p->a_smooth = parser_get_opt_param_float(params, "Gravity:a_smooth",
                                              gravity_props_default_a_smooth);
     p->r_cut_max_ratio = parser_get_opt_param_float(
@@ -90,13 +105,32 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
     if (p->a_smooth <= 0.)
       error("The mesh smoothing scale 'a_smooth' must be > 0.");
 
-#if !defined(WITH_MPI) || !defined(HAVE_MPI_FFTW)
+#if !defined(WITH_MPI)
     if (p->distributed_mesh)
       error(
           "Need to use MPI and FFTW MPI library (i.e. compile with "
           "--enable-mpi-mesh-gravity) to run with distributed mesh.");
+#elif !defined(HAVE_MPI_FFTW)
+    if (p->distributed_mesh && !p->distributed_mesh_pencils)
+      error(
+          "Need to use the FFTW MPI library (i.e. compile with "
+          "--enable-mpi-mesh-gravity) to run with the slab-distributed mesh. "
+          "The pencil-distributed mesh (distributed_mesh_pencils: 1) only "
+          "needs the serial FFTW library.");
 #endif
 
+    if (p->mesh_assignment_order < 2 || p->mesh_assignment_order > 4)
+      error(
+          "The mesh assignment order must be 2 (CIC), 3 (TSC) or 4 (PCS). "
+          "Got %d.",
+          p->mesh_assignment_order);
+
+    if (p->distributed_mesh &&
+        (p->mesh_assignment_order != 2 || p->mesh_interlacing))
+      error(
+          "The distributed mesh only supports CIC assignment without "
+          "interlacing.");
+
     if (2. * p->a_smooth * p->r_cut_max_ratio > p->mesh_size)
       error("Mesh too small given r_cut_max. Should be at least %d cells wide.",
             (int)(2. * p->a_smooth * p->r_cut_max_ratio) + 1);
@@ -110,6 +144,9 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
   } else {
     p->mesh_size = 0;
     p->distributed_mesh = 0;
+    p->distributed_mesh_pencils = 0;
+    p->mesh_assignment_order = 0;
+    p->mesh_interlacing = 0;
     p->a_smooth = 0.f;
     p->r_s = FLT_MAX;
     p->r_s_inv = 0.f;
@@ -160,6 +197,20 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
   p->use_tree_below_softening =
       parser_get_opt_param_int(params, "Gravity:use_tree_below_softening", 0);
 
+  /* Are we re-using the MAC decisions from one step to the next? */
+  p->use_MAC_cache = parser_get_opt_param_int(
+      params, "Gravity:use_MAC_cache", gravity_props_default_use_MAC_cache);
+  p->MAC_cache_tolerance =
+      parser_get_opt_param_float(params, "Gravity:MAC_cache_tolerance",
+                                 gravity_props_default_MAC_cache_tolerance);
+  if (p->MAC_cache_tolerance < 0.f)
+    error("The MAC cache tolerance must be positive.");
+  p->MAC_cache_entries_per_cell = parser_get_opt_param_float(
+      params, "Gravity:MAC_cache_entries_per_cell",
+      gravity_props_default_MAC_cache_entries_per_cell);
+  if (p->MAC_cache_entries_per_cell <= 0.f)
+    error("The number of MAC cache entries per cell must be positive.");
+
 #ifdef GADGET2_SOFTENING_CORRECTION
   if (p->use_tree_below_softening)
     error(
@@ -327,6 +378,12 @@ void gravity_props_print(const struct gravity_props *p) {
     message("Self-gravity opening angle:  theta_cr=%.4f", p->theta_crit);
   }
 
+  if (p->use_MAC_cache)
+    message(
+        "Self-gravity MAC decisions cached with tolerance: %.3f (%.1f slots "
+        "per cell)",
+        p->MAC_cache_tolerance, p->MAC_cache_entries_per_cell);
+
   message("Self-gravity softening functional form: %s",
           kernel_gravity_softening_name);
 
@@ -371,7 +428,10 @@ void gravity_props_print(const struct gravity_props *p) {
 
   message("Self-gravity mesh side-length: N=%d", p->mesh_size);
   message("Self-gravity mesh smoothing-scale: a_smooth=%f", p->a_smooth);
-  message("Self-gravity distributed mesh enabled: %d", p->distributed_mesh);
+  message("Self-gravity distributed mesh enabled: %d (pencils: %d)",
+          p->distributed_mesh, p->distributed_mesh_pencils);
+  message("Self-gravity mesh assignment order: %d (interlacing: %d)",
+          p->mesh_assignment_order, p->mesh_interlacing);
 
   message("Self-gravity tree cut-off ratio: r_cut_max=%f", p->r_cut_max_ratio);
   message("Self-gravity truncation cut-off ratio: r_cut_min=%f",
@@ -82,6 +82,16 @@ struct gravity_props {
   /*! Are we applying long-range truncation to the forces in the MAC? */
   int consider_truncation_in_MAC;
 
+  /*! Are we caching the MAC decisions of the cell pairs between steps? */
+  int use_MAC_cache;
+
+  /*! Fractional growth of the multipole sizes over which a cached MAC
+   * decision remains valid */
+  float MAC_cache_tolerance;
+
+  /*! Number of slots of the MAC cache per cell of the tree */
+  float MAC_cache_entries_per_cell;
+
   /* ------------- Properties of the softened gravity ------------------ */
 
   /*! Co-moving softening length for for high-res. DM particles */
@@ -134,10 +144,21 @@ struct gravity_props {
   /*! Whether mesh is distributed between MPI ranks when we use MPI  */
   int distributed_mesh;
 
+  /*! Whether the distributed mesh uses a pencil rather than a slab
+   * decomposition */
+  int distributed_mesh_pencils;
+
   /*! Whether or not to use local patches rather than
    * direct atomic writes to the mesh when running without MPI */
   int mesh_uses_local_patches;
 
+  /*! Order of the mass assignment window (2: CIC, 3: TSC, 4: PCS) */
+  int mesh_assignment_order;
+
+  /*! Whether or not to use a second mesh shifted by half a cell to reduce
+   * the aliasing of the mass assignment */
+  int mesh_interlacing;
+
   /*! Mesh smoothing scale in units of top-level cell size */
   float a_smooth;
 
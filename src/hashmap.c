@@ -26,119 +26,87 @@
  * Modified by Pete Warden to fix a serious performance problem, support strings
  * as keys and removed thread synchronization - http://petewarden.typepad.com
  */
+/* Config parameters. */
+#include <config.h>
+
 #include "hashmap.h"
 
 #include "error.h"
+#include "inline.h"
 #include "memuse.h"
+#include "threadpool.h"
 
 #include <float.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define INITIAL_NUM_CHUNKS (1)
+#ifdef HAVE_IMMINTRIN_H
+/* Include the header file with the intrinsics for Intel architecture. */
+#include <immintrin.h>
+#endif
+
 #define HASHMAP_GROWTH_FACTOR (2)
-#define HASHMAP_MAX_FILL_RATIO (1.0)
-#define HASHMAP_MAX_CHUNK_FILL_RATIO (0.5)
+#define HASHMAP_MAX_FILL_RATIO (0.875)
+#define HASHMAP_CTRL_EMPTY ((hashmap_ctrl_t)-128)
 
 /**
- * @brief Pre-allocate a number of chunks for the graveyard.
+ * @brief Hash function for the keys.
+ *
+ * This is the finaliser of MurmurHash3, which mixes all the bits of the key
+ * so that both the top bits (used to pick a group) and the bottom seven bits
+ * (stored in the control bytes) are well distributed.
  */
-void hashmap_allocate_chunks(hashmap_t *m, int num_chunks) {
-  /* Allocate a fresh set of chunks. */
-  hashmap_chunk_t *alloc;
-  if ((alloc = (hashmap_chunk_t *)swift_calloc(
-           "hashmap", num_chunks, sizeof(hashmap_chunk_t))) == NULL) {
-    error("Unable to allocate chunks.");
-  }
-
-  /* Hook up the alloc, so that we can clean it up later. */
-  if (m->allocs_count == m->allocs_size) {
-    m->allocs_size *= 2;
-
-    void **new_allocs =
-        (void **)swift_malloc("hashmap", sizeof(void *) * m->allocs_size);
-    if (new_allocs == NULL) error("Unable to allocate new chunks.");
-
-    memcpy(new_allocs, m->allocs, sizeof(void *) * m->allocs_count);
-    swift_free("hashmap", m->allocs);
-    m->allocs = new_allocs;
-  }
-  m->allocs[m->allocs_count++] = alloc;
-
-  /* Link the chunks together. */
-  for (int k = 0; k < num_chunks - 1; k++) {
-    alloc[k].next = &alloc[k + 1];
-  }
-
-  /* Last chunk points to current graveyard. */
-  alloc[num_chunks - 1].next = m->graveyard;
-
-  /* Graveyard points to first new chunk. */
-  m->graveyard = alloc;
-}
-
-void hashmap_init(hashmap_t *m) {
-  /* Allocate the first (empty) list of chunks. */
-  m->nr_chunks = INITIAL_NUM_CHUNKS;
-  if ((m->chunks = (hashmap_chunk_t **)swift_calloc(
-           "hashmap", m->nr_chunks, sizeof(hashmap_chunk_t *))) == NULL) {
-    error("Unable to allocate hashmap chunks.");
-  }
-
-  /* The graveyard is currently empty. */
-  m->graveyard = NULL;
-  m->allocs = NULL;
-
-  /* Init the array of allocations. */
-  m->allocs_size = HASHMAP_ALLOCS_INITIAL_SIZE;
-  if ((m->allocs = (void **)swift_malloc(
-           "hashmap", sizeof(void *) * m->allocs_size)) == NULL) {
-    error("Unable to allocate allocs pointer array.");
-  }
-  m->allocs_count = 0;
-
-  /* Set initial sizes. */
-  m->table_size = m->nr_chunks * HASHMAP_ELEMENTS_PER_CHUNK;
-  m->size = 0;
-
-  /* Inform the men. */
-  if (HASHMAP_DEBUG_OUTPUT) {
-    message(
-        "Created hash table of size: %zu each element is %zu bytes. Allocated "
-        "%zu empty chunks.",
-        m->table_size * sizeof(hashmap_element_t), sizeof(hashmap_element_t),
-        m->nr_chunks);
-  }
+__attribute__((always_inline)) INLINE static uint64_t hashmap_hash(
+    hashmap_key_t key) {
+  uint64_t h = (uint64_t)key;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
 }
 
 /**
- * @brief Put a used chunk back into the recycling bin.
+ * @brief Returns a bitmask of the slots of a group whose control byte is
+ * equal to `tag`.
+ *
+ * @param ctrl The (aligned) control bytes of the group.
+ * @param tag The control byte to look for.
  */
-void hashmap_release_chunk(hashmap_t *m, hashmap_chunk_t *chunk) {
-  /* Clear all the chunk's data. */
-  memset(chunk, 0, sizeof(hashmap_chunk_t));
-
-  /* Hook it up with the other stiffs in the graveyard. */
-  chunk->next = m->graveyard;
-  m->graveyard = chunk;
+__attribute__((always_inline)) INLINE static unsigned int hashmap_group_match(
+    const hashmap_ctrl_t *ctrl, const hashmap_ctrl_t tag) {
+#ifdef __SSE2__
+  const __m128i group = _mm_load_si128((const __m128i *)ctrl);
+  return (unsigned int)_mm_movemask_epi8(
+      _mm_cmpeq_epi8(group, _mm_set1_epi8(tag)));
+#else
+  unsigned int match = 0;
+  for (int k = 0; k < HASHMAP_GROUP_SIZE; k++)
+    match |= ((unsigned int)(ctrl[k] == tag)) << k;
+  return match;
+#endif
 }
 
 /**
- * @brief Return a new chunk, either recycled or freshly allocated.
+ * @brief Set the initial value of a freshly created element.
  */
-hashmap_chunk_t *hashmap_get_chunk(hashmap_t *m) {
-  int num_chunks = m->nr_chunks * HASHMAP_ALLOC_SIZE_FRACTION;
-  if (!num_chunks) num_chunks = 1;
-  if (m->graveyard == NULL) {
-    hashmap_allocate_chunks(m, num_chunks);
-  }
-
-  hashmap_chunk_t *res = (hashmap_chunk_t *)m->graveyard;
-  m->graveyard = (hashmap_chunk_t *)res->next;
-  res->next = NULL;
+__attribute__((always_inline)) INLINE static void hashmap_init_element(
+    hashmap_element_t *element, hashmap_key_t key) {
+  memset(element, 0, sizeof(hashmap_element_t));
+  element->key = key;
+  element->value.value_array2_dbl[0] = -FLT_MAX;
+  element->value.value_array2_dbl[1] = -FLT_MAX;
+  element->value.value_array2_dbl[2] = -FLT_MAX;
+}
 
-  return res;
+void hashmap_init(hashmap_t *m) {
+  /* The table is only allocated once we need it. */
+  m->table_size = 0;
+  m->size = 0;
+  m->ctrl = NULL;
+  m->data = NULL;
 }
 
 /**
@@ -150,16 +118,18 @@ hashmap_chunk_t *hashmap_get_chunk(hashmap_t *m) {
  *
  * If the hashmap is full, NULL is returned.
  *
- * We use `rand_r` as a hashing function. The key is first hashed to obtain an
- * initial global position. If there is a collision, the hashing function is
- * re-applied to the key to obtain a new offset *within the same bucket*. This
- * is repeated for at most HASHMAP_MAX_CHAIN_LENGTH steps, at which point
- * insertion fails.
+ * The key is hashed once. The top bits of the hash select a first group of
+ * #HASHMAP_GROUP_SIZE slots and the bottom seven bits are the tag stored in
+ * the control byte of the slot. The control bytes of a group are compared
+ * to the tag all at once, and only the matching elements are compared to
+ * the key. If the group has no match and no empty slot, the next group is
+ * picked by triangular probing, which visits every group of a power-of-two
+ * table. Since elements are never removed, an empty slot ends the search.
  */
 hashmap_element_t *hashmap_find(hashmap_t *m, hashmap_key_t key, int create_new,
                                 int *chain_length, int *created_new_element) {
   /* If full, return immediately */
-  if (create_new && m->size > m->table_size * HASHMAP_MAX_FILL_RATIO) {
+  if (create_new && m->size + 1 > m->table_size * HASHMAP_MAX_FILL_RATIO) {
     if (HASHMAP_DEBUG_OUTPUT) {
       message("hashmap is too full (%zu of %zu elements used), re-hashing.",
               m->size, m->table_size);
@@ -167,90 +137,76 @@ hashmap_element_t *hashmap_find(hashmap_t *m, hashmap_key_t key, int create_new,
     return NULL;
   }
 
-  /* We will use rand_r as our hash function. */
-  unsigned int curr = (unsigned int)key;
+  /* Nothing to look for in an empty table. */
+  if (m->table_size == 0) return NULL;
 
-  /* Get offsets to the entry, its chunk, it's mask, etc. */
-  const size_t offset = rand_r(&curr) % m->table_size;
-  const size_t chunk_offset = offset / HASHMAP_ELEMENTS_PER_CHUNK;
-  size_t offset_in_chunk = offset - chunk_offset * HASHMAP_ELEMENTS_PER_CHUNK;
+  const uint64_t hash = hashmap_hash(key);
+  const hashmap_ctrl_t tag = (hashmap_ctrl_t)(hash & 0x7f);
+  const size_t group_mask = m->table_size / HASHMAP_GROUP_SIZE - 1;
+  size_t group = (size_t)(hash >> 7) & group_mask;
 
-  /* Allocate the chunk if needed. */
-  if (m->chunks[chunk_offset] == NULL) {
-    /* Quit here if we don't want to create a new entry. */
-    if (!create_new) return NULL;
+  for (size_t step = 1;; step++) {
+    /* Record the chain_length, if not NULL. */
+    if (chain_length) *chain_length = (int)step - 1;
 
-    /* Get a new chunk for this offset. */
-    m->chunks[chunk_offset] = hashmap_get_chunk(m);
-  }
-  hashmap_chunk_t *chunk = m->chunks[chunk_offset];
+    const size_t offset = group * HASHMAP_GROUP_SIZE;
+    hashmap_ctrl_t *ctrl = &m->ctrl[offset];
 
-  /* Count the number of free elements in this chunk and bail if it is too low.
-   */
-  int chunk_count = 0;
-  for (int k = 0; k < HASHMAP_MASKS_PER_CHUNK; k++) {
-    chunk_count += __builtin_popcountll(chunk->masks[k]);
-  }
-  if (create_new &&
-      chunk_count > HASHMAP_ELEMENTS_PER_CHUNK * HASHMAP_MAX_CHUNK_FILL_RATIO) {
-    if (HASHMAP_DEBUG_OUTPUT) {
-      message(
-          "chunk %zu is too full (%i of %i elements used, fill ratio is "
-          "%.2f%%), re-hashing.",
-          chunk_offset, chunk_count, HASHMAP_ELEMENTS_PER_CHUNK,
-          (100.0 * m->size) / m->table_size);
+    /* Check the elements whose tag matches. */
+    for (unsigned int match = hashmap_group_match(ctrl, tag); match;
+         match &= match - 1) {
+      hashmap_element_t *element = &m->data[offset + __builtin_ctz(match)];
+      if (element->key == key) return element;
     }
-    return NULL;
-  }
-
-  /* Linear probing (well, not really, but whatever). */
-  for (int i = 0; i < HASHMAP_MAX_CHAIN_LENGTH; i++) {
-    /* Record the chain_length, if not NULL. */
-    if (chain_length) *chain_length = i;
 
-    /* Compute the offsets within the masks of this chunk. */
-    const int mask_offset = offset_in_chunk / HASHMAP_BITS_PER_MASK;
-    const int offset_in_mask =
-        offset_in_chunk - mask_offset * HASHMAP_BITS_PER_MASK;
-
-    /* Is the offset empty? */
-    hashmap_mask_t search_mask = ((hashmap_mask_t)1) << offset_in_mask;
-    if (!(chunk->masks[mask_offset] & search_mask)) {
+    /* Any empty slot in this group means the key is not in the table. */
+    const unsigned int empty = hashmap_group_match(ctrl, HASHMAP_CTRL_EMPTY);
+    if (empty) {
       /* Quit here if we don't want to create a new element. */
       if (!create_new) return NULL;
 
-      /* Mark this element as taken and increase the size counter. */
-      chunk->masks[mask_offset] |= search_mask;
+      /* Take the first empty slot and increase the size counter. */
+      const int k = __builtin_ctz(empty);
+      ctrl[k] = tag;
       m->size += 1;
       if (created_new_element) *created_new_element = 1;
 
-      /* Set the key. */
-      chunk->data[offset_in_chunk].key = key;
-      chunk->data[offset_in_chunk].value.value_array2_dbl[0] = -FLT_MAX;
-      chunk->data[offset_in_chunk].value.value_array2_dbl[1] = -FLT_MAX;
-      chunk->data[offset_in_chunk].value.value_array2_dbl[2] = -FLT_MAX;
+      /* Set the key and initial value. */
+      hashmap_element_t *element = &m->data[offset + k];
+      hashmap_init_element(element, key);
 
       /* Return a pointer to the new element. */
-      return &chunk->data[offset_in_chunk];
-    }
-
-    /* Does the offset by chance contain the key we are looking for? */
-    else if (chunk->data[offset_in_chunk].key == key) {
-      return &chunk->data[offset_in_chunk];
+      return element;
     }
 
-    /* None of the above, so this is a collision. Re-hash, but within the same
-       chunk. I guess this is Hopscotch Hashing? */
-    else {
-      offset_in_chunk = rand_r(&curr) % HASHMAP_ELEMENTS_PER_CHUNK;
-    }
+    /* Full group without our key, move on to the next one. */
+    group = (group + step) & group_mask;
   }
+}
 
-  /* We lucked out, so return nothing. */
-  if (HASHMAP_DEBUG_OUTPUT) {
-    message("maximum chain length exceeded, re-hashing.");
+/**
+ * @brief Copy an element into a slot of a table known not to contain its
+ * key already. Used when re-hashing.
+ */
+static void hashmap_insert_unique(hashmap_t *m,
+                                  const hashmap_element_t *element) {
+  const uint64_t hash = hashmap_hash(element->key);
+  const size_t group_mask = m->table_size / HASHMAP_GROUP_SIZE - 1;
+  size_t group = (size_t)(hash >> 7) & group_mask;
+
+  for (size_t step = 1;; step++) {
+    const size_t offset = group * HASHMAP_GROUP_SIZE;
+    const unsigned int empty =
+        hashmap_group_match(&m->ctrl[offset], HASHMAP_CTRL_EMPTY);
+    if (empty) {
+      const int k = __builtin_ctz(empty);
+      m->ctrl[offset + k] = (hashmap_ctrl_t)(hash & 0x7f);
+      m->data[offset + k] = *element;
+      m->size += 1;
+      return;
+    }
+    group = (group + step) & group_mask;
   }
-  return NULL;
 }
 
 /**
@@ -259,98 +215,48 @@ hashmap_element_t *hashmap_find(hashmap_t *m, hashmap_key_t key, int create_new,
 void hashmap_grow(hashmap_t *m, size_t new_size) {
   /* Hold on to the old data. */
   const size_t old_table_size = m->table_size;
-  hashmap_chunk_t **old_chunks = m->chunks;
+  hashmap_ctrl_t *old_ctrl = m->ctrl;
+  hashmap_element_t *old_data = m->data;
+
+  /* Work out the new table size: a power of two holding at least the
+     requested number of elements (and the current ones) below the maximal
+     fill ratio. */
+  size_t table_size = HASHMAP_GROUP_SIZE;
+  if (new_size == 0 && old_table_size > 0)
+    table_size = old_table_size * HASHMAP_GROWTH_FACTOR;
+  if (new_size < m->size + 1) new_size = m->size + 1;
+  while (table_size * HASHMAP_MAX_FILL_RATIO < new_size) table_size *= 2;
 
-  /* Re-allocate the chunk array. */
-  if (new_size == 0) new_size = m->table_size * HASHMAP_GROWTH_FACTOR;
-  m->nr_chunks =
-      (new_size + HASHMAP_ELEMENTS_PER_CHUNK - 1) / HASHMAP_ELEMENTS_PER_CHUNK;
-  m->table_size = m->nr_chunks * HASHMAP_ELEMENTS_PER_CHUNK;
+  /* Nothing to do? */
+  if (table_size <= old_table_size) return;
 
   if (HASHMAP_DEBUG_OUTPUT) {
     message("Increasing hash table size from %zu (%zu kb) to %zu (%zu kb).",
             old_table_size, old_table_size * sizeof(hashmap_element_t) / 1024,
-            m->table_size, m->table_size * sizeof(hashmap_element_t) / 1024);
+            table_size, table_size * sizeof(hashmap_element_t) / 1024);
   }
 
-  if ((m->chunks = (hashmap_chunk_t **)swift_calloc(
-           "hashmap", m->nr_chunks, sizeof(hashmap_chunk_t *))) == NULL) {
-    error("Unable to allocate hashmap chunks.");
-  }
-
-  /* Reset size. */
+  /* Allocate the new table, all slots empty. */
+  if (swift_memalign("hashmap", (void **)&m->ctrl, SWIFT_STRUCT_ALIGNMENT,
+                     table_size * sizeof(hashmap_ctrl_t)) != 0)
+    error("Unable to allocate hashmap control bytes.");
+  if (swift_memalign("hashmap", (void **)&m->data, SWIFT_STRUCT_ALIGNMENT,
+                     table_size * sizeof(hashmap_element_t)) != 0)
+    error("Unable to allocate hashmap elements.");
+  memset(m->ctrl, HASHMAP_CTRL_EMPTY, table_size * sizeof(hashmap_ctrl_t));
+  m->table_size = table_size;
   m->size = 0;
 
-  /* Buffer of stray elements, in case we get overflows while re-hashing. */
-  hashmap_element_t *strays = NULL;
-  size_t strays_count = 0;
-  size_t strays_size = 0;
-
-  /* Iterate over the chunks and add their entries to the new table. */
-  for (size_t cid = 0; cid < old_table_size / HASHMAP_ELEMENTS_PER_CHUNK;
-       cid++) {
-    /* Skip empty chunks. */
-    hashmap_chunk_t *chunk = old_chunks[cid];
-    if (!chunk) continue;
-
-    /* Loop over the masks in this chunk. */
-    for (int mid = 0; mid < HASHMAP_MASKS_PER_CHUNK; mid++) {
-      /* Skip empty masks. */
-      if (chunk->masks[mid] == 0) continue;
-
-      /* Loop over the mask entries. */
-      for (int eid = 0; eid < HASHMAP_BITS_PER_MASK; eid++) {
-        hashmap_mask_t element_mask = ((hashmap_mask_t)1) << eid;
-        if (chunk->masks[mid] & element_mask) {
-          hashmap_element_t *element =
-              &chunk->data[mid * HASHMAP_BITS_PER_MASK + eid];
-
-          /* Copy the element over to the new hashmap. */
-          hashmap_element_t *new_element =
-              hashmap_find(m, element->key, /*create_new=*/1,
-                           /*chain_length=*/NULL, /*created_new_element=*/NULL);
-
-          if (new_element) {
-            new_element->value = element->value;
-          }
-          /* If copying failed, then we have an overflow in the new hashmap.
-             If this happens, store the offending element in the strays buffer
-             for now. */
-          else {
-            /* (Re)allocate strays buffer? */
-            if (strays_count == strays_size) {
-              hashmap_element_t *temp_buff;
-              strays_size = strays_size ? strays_size * 2 : 10;
-              if ((temp_buff = (hashmap_element_t *)swift_malloc(
-                       "hashmap_strays",
-                       sizeof(hashmap_element_t) * strays_size)) == NULL)
-                error("Failed to (re)allocate strays buffer.");
-              memcpy(temp_buff, strays,
-                     sizeof(hashmap_element_t) * strays_count);
-              swift_free("hashmap_strays", strays);
-              strays = temp_buff;
-            }
-            strays[strays_count++] = *element;
-          }
-        }
-      }
-    }
-
-    /* We're through with this chunk, recycle it. */
-    hashmap_release_chunk(m, chunk);
+  /* Re-insert the old elements. Keys are unique, so no comparisons are
+     needed. */
+  for (size_t k = 0; k < old_table_size; k++) {
+    if (old_ctrl[k] != HASHMAP_CTRL_EMPTY)
+      hashmap_insert_unique(m, &old_data[k]);
   }
 
-  /* Free the old list of chunks. */
-  swift_free("hashmap", old_chunks);
-
-  /* If we have any strays, add them back to the hashmap. This will inevitably
-     trigger a rehashing, but that's not our problem. */
-  if (strays_count) {
-    for (size_t k = 0; k < strays_count; k++) {
-      hashmap_put(m, strays[k].key, strays[k].value);
-    }
-    swift_free("hashmap_strays", strays);
-  }
+  /* Free the old table. */
+  if (old_ctrl != NULL) swift_free("hashmap", old_ctrl);
+  if (old_data != NULL) swift_free("hashmap", old_data);
 }
 
 void hashmap_put(hashmap_t *m, hashmap_key_t key, hashmap_value_t value) {
@@ -404,49 +310,96 @@ hashmap_value_t *hashmap_lookup(hashmap_t *m, hashmap_key_t key) {
 }
 
 void hashmap_iterate(hashmap_t *m, hashmap_mapper_t f, void *data) {
-  /* Loop over the chunks. */
-  for (size_t cid = 0; cid < m->nr_chunks; cid++) {
-    hashmap_chunk_t *chunk = m->chunks[cid];
-    if (!chunk) continue;
-
-    /* Loop over the masks. */
-    for (int mid = 0; mid < HASHMAP_MASKS_PER_CHUNK; mid++) {
-      hashmap_mask_t mask = chunk->masks[mid];
-      if (!mask) continue;
-
-      /* Loop over each element in the mask. */
-      for (int eid = 0;
-           eid < HASHMAP_BITS_PER_MASK &&
-           mid * HASHMAP_BITS_PER_MASK + eid < HASHMAP_ELEMENTS_PER_CHUNK;
-           eid++) {
-        /* If the element exists, call the function on it. */
-        if (mask & (((hashmap_mask_t)1) << eid)) {
-          hashmap_element_t *element =
-              &chunk->data[mid * HASHMAP_BITS_PER_MASK + eid];
-          f(element->key, &element->value, data);
-        }
+  /* Loop over the groups. */
+  for (size_t offset = 0; offset < m->table_size;
+       offset += HASHMAP_GROUP_SIZE) {
+
+    /* Loop over the full slots of this group. */
+    const unsigned int empty =
+        hashmap_group_match(&m->ctrl[offset], HASHMAP_CTRL_EMPTY);
+    for (unsigned int full = ~empty & ((1u << HASHMAP_GROUP_SIZE) - 1); full;
+         full &= full - 1) {
+      hashmap_element_t *element = &m->data[offset + __builtin_ctz(full)];
+      f(element->key, &element->value, data);
+    }
+  }
+}
+
+void hashmap_merge(hashmap_t *m, hashmap_t *other, hashmap_merger_t f,
+                   void *data) {
+  /* Make room for all the new elements at once. */
+  if (m->size + other->size > m->table_size * HASHMAP_MAX_FILL_RATIO)
+    hashmap_grow(m, m->size + other->size);
+
+  for (size_t k = 0; k < other->table_size; k++) {
+    if (other->ctrl[k] == HASHMAP_CTRL_EMPTY) continue;
+    const hashmap_element_t *element = &other->data[k];
+    f(element->key, hashmap_get(m, element->key), &element->value, data);
+  }
+}
+
+/* Arguments of a pairwise merge in #hashmap_merge_parallel. */
+struct hashmap_merge_pair {
+  hashmap_t *m;
+  hashmap_t *other;
+  hashmap_merger_t f;
+  void *data;
+};
+
+/**
+ * @brief Threadpool mapper merging pairs of hashmaps.
+ */
+static void hashmap_merge_pair_mapper(void *map_data, int num_elements,
+                                      void *extra_data) {
+  struct hashmap_merge_pair *pairs = (struct hashmap_merge_pair *)map_data;
+  for (int k = 0; k < num_elements; k++) {
+    hashmap_merge(pairs[k].m, pairs[k].other, pairs[k].f, pairs[k].data);
+    hashmap_free(pairs[k].other);
+  }
+}
+
+void hashmap_merge_parallel(hashmap_t *maps, int nr_maps, hashmap_merger_t f,
+                            void *data, struct threadpool *tp) {
+  if (nr_maps < 2) return;
+
+  struct hashmap_merge_pair *pairs = (struct hashmap_merge_pair *)malloc(
+      sizeof(struct hashmap_merge_pair) * (nr_maps / 2 + 1));
+  if (pairs == NULL) error("Unable to allocate hashmap merge pairs.");
+
+  /* Merge maps[k + stride] into maps[k], one level of the tree at a time. */
+  for (int stride = 1; stride < nr_maps; stride *= 2) {
+    int nr_pairs = 0;
+    for (int k = 0; k + stride < nr_maps; k += 2 * stride) {
+      /* Merge the smaller map into the larger one. */
+      if (maps[k].size < maps[k + stride].size) {
+        const hashmap_t temp = maps[k];
+        maps[k] = maps[k + stride];
+        maps[k + stride] = temp;
       }
+      pairs[nr_pairs].m = &maps[k];
+      pairs[nr_pairs].other = &maps[k + stride];
+      pairs[nr_pairs].f = f;
+      pairs[nr_pairs].data = data;
+      nr_pairs++;
     }
+    threadpool_map(tp, hashmap_merge_pair_mapper, pairs, nr_pairs,
+                   sizeof(struct hashmap_merge_pair), /*chunk=*/1,
+                   /*extra_data=*/NULL);
   }
+
+  free(pairs);
 }
 
 void hashmap_free(hashmap_t *m) {
-  /* Free the list of active chunks. Note that the actual chunks will be freed
-     as part of the allocs below. */
-  swift_free("hashmap", m->chunks);
+  /* Free the table. */
+  if (m->ctrl != NULL) swift_free("hashmap", m->ctrl);
+  if (m->data != NULL) swift_free("hashmap", m->data);
 
   /* Re-set some pointers and values, just in case. */
-  m->chunks = NULL;
-  m->graveyard = NULL;
+  m->ctrl = NULL;
+  m->data = NULL;
   m->size = 0;
   m->table_size = 0;
-  m->nr_chunks = 0;
-
-  /* Free the chunk allocs. */
-  for (size_t k = 0; k < m->allocs_count; k++) {
-    swift_free("hashmap", m->allocs[k]);
-  }
-  swift_free("hashmap", m->allocs);
 }
 
 size_t hashmap_size(hashmap_t *m) {
@@ -456,90 +409,48 @@ size_t hashmap_size(hashmap_t *m) {
     return 0;
 }
 
-#if HASHMAP_DEBUG_OUTPUT
-void hashmap_count_chain_lengths(hashmap_key_t key, hashmap_value_t *value,
-                                 void *data) {
-  hashmap_t *m = (hashmap_t *)data;
+/**
+ * @brief Mapper counting the number of groups probed to find each key.
+ */
+static void hashmap_count_probe_lengths(hashmap_key_t key,
+                                        hashmap_value_t *value, void *data) {
+  void **args = (void **)data;
+  hashmap_t *m = (hashmap_t *)args[0];
+  size_t *counts = (size_t *)args[1];
   int count = 0;
   hashmap_find(m, key, /*create_entry=*/0, &count,
                /*created_new_element=*/NULL);
-  m->chain_length_counts[count] += 1;
+  counts[count < HASHMAP_MAX_PROBE_LENGTH ? count
+                                          : HASHMAP_MAX_PROBE_LENGTH - 1] += 1;
 }
-#endif
 
 void hashmap_print_stats(hashmap_t *m) {
   /* Basic stats. */
-  message("size: %zu, table_size: %zu, nr_chunks: %zu.", m->size, m->table_size,
-          m->nr_chunks);
-
-  /* Count the number of populated chunks, graveyard chunks, and allocs. */
-  int chunk_counter = 0;
-  for (size_t k = 0; k < m->nr_chunks; k++) {
-    if (m->chunks[k]) chunk_counter += 1;
-  }
-  int graveyard_counter = 0;
-  for (hashmap_chunk_t *finger = m->graveyard; finger != NULL;
-       finger = (hashmap_chunk_t *)finger->next) {
-    graveyard_counter += 1;
-  }
-  message(
-      "populated chunks: %i (%zu kb), graveyard chunks: %i (%zu kb), allocs: "
-      "%zu",
-      chunk_counter, sizeof(hashmap_chunk_t) * chunk_counter / 1024,
-      graveyard_counter, sizeof(hashmap_chunk_t) * graveyard_counter / 1024,
-      m->allocs_count);
-
-  /* Print fill ratios. */
-  message("element-wise fill ratio: %.2f%%, chunk-wise fill ratio: %.2f%%",
-          (100.0 * m->size) / m->table_size,
-          (100.0 * chunk_counter) / m->nr_chunks);
-
-#if HASHMAP_DEBUG_OUTPUT
-  /* Compute the chain lengths. */
-  for (int k = 0; k < HASHMAP_MAX_CHAIN_LENGTH; k++) {
-    m->chain_length_counts[k] = 0;
-  }
-  hashmap_iterate(m, hashmap_count_chain_lengths, m);
-  message("chain lengths:");
-  for (int k = 0; k < HASHMAP_MAX_CHAIN_LENGTH; k++) {
-    message("  chain_length_counts[%i]: %zu (%.2f%%)", k,
-            m->chain_length_counts[k],
-            (100.0 * m->chain_length_counts[k]) / m->size);
-  }
-#endif
-
-  /* Compute chunk fill ratios. */
-  size_t chunk_fill_ratio_counts[11];
-  for (int k = 0; k < 11; k++) {
-    chunk_fill_ratio_counts[k] = 0;
-  }
-  for (size_t k = 0; k < m->nr_chunks; k++) {
-    hashmap_chunk_t *chunk = m->chunks[k];
-    if (!chunk) {
-      chunk_fill_ratio_counts[0] += 1;
-    } else {
-      int count = 0;
-      for (int j = 0; j < HASHMAP_MASKS_PER_CHUNK; j++) {
-        count += __builtin_popcountll(chunk->masks[j]);
-      }
-      chunk_fill_ratio_counts[(int)(10 * count / HASHMAP_MAX_CHUNK_FILL_RATIO /
-                                    HASHMAP_ELEMENTS_PER_CHUNK)] += 1;
-    }
-  }
-  message("chunk fill ratios:");
-  for (int k = 0; k < 11; k++) {
-    message("  %3i%% - %3i%%: %zu (%.2f%%)",
-            (int)(k * 10 * HASHMAP_MAX_CHUNK_FILL_RATIO),
-            (int)((k + 1) * 10 * HASHMAP_MAX_CHUNK_FILL_RATIO),
-            chunk_fill_ratio_counts[k],
-            (100.0 * chunk_fill_ratio_counts[k]) / m->nr_chunks);
+  message("size: %zu, table_size: %zu (%zu kb).", m->size, m->table_size,
+          m->table_size * (sizeof(hashmap_element_t) + sizeof(hashmap_ctrl_t)) /
+              1024);
+
+  /* Print fill ratio. */
+  message("element-wise fill ratio: %.2f%%",
+          m->table_size ? (100.0 * m->size) / m->table_size : 0.);
+
+  /* Compute the probe lengths. */
+  size_t probe_length_counts[HASHMAP_MAX_PROBE_LENGTH] = {0};
+  void *args[2] = {m, probe_length_counts};
+  hashmap_iterate(m, hashmap_count_probe_lengths, args);
+  message("probe lengths (groups visited beyond the first):");
+  for (int k = 0; k < HASHMAP_MAX_PROBE_LENGTH; k++) {
+    if (probe_length_counts[k] == 0) continue;
+    message("  %2i: %zu (%.2f%%)", k, probe_length_counts[k],
+            (100.0 * probe_length_counts[k]) / m->size);
   }
 
   /* Print struct sizes. */
   message("sizeof(hashmap_element_t): %zu", sizeof(hashmap_element_t));
-  message("sizeof(hashmap_chunk_t): %zu", sizeof(hashmap_chunk_t));
-  message("HASHMAP_TARGET_CHUNK_BYTES: %i", HASHMAP_TARGET_CHUNK_BYTES);
-  message("HASHMAP_BITS_PER_ELEMENT: %i", HASHMAP_BITS_PER_ELEMENT);
-  message("HASHMAP_ELEMENTS_PER_CHUNK: %i", HASHMAP_ELEMENTS_PER_CHUNK);
-  message("HASHMAP_MASKS_PER_CHUNK: %i", HASHMAP_MASKS_PER_CHUNK);
+  message("HASHMAP_GROUP_SIZE: %i", HASHMAP_GROUP_SIZE);
+#ifdef __SSE2__
+  message("Group probing: SSE2");
+#else
+  message("Group probing: scalar");
+#endif
 }
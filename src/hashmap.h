@@ -32,14 +32,13 @@
 /* Some standard headers. */
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /* Local headers. */
 #include "align.h"
 
-// Type used for chunk bitmasks.
-typedef size_t hashmap_mask_t;
-
-#define HASHMAP_BITS_PER_MASK ((int)sizeof(hashmap_mask_t) * 8)
+/* Forward declaration, we only need a pointer to the threadpool. */
+struct threadpool;
 
 // Type used for the hashmap keys (must have a valid '==' operation).
 #ifndef hashmap_key_t
@@ -65,50 +64,35 @@ typedef struct _hashmap_element {
   hashmap_value_t value;
 } hashmap_element_t;
 
-/* Make sure a chunk fits in a given size. */
-#define HASHMAP_TARGET_CHUNK_BYTES (80 * 1024)
-#define HASHMAP_BITS_PER_ELEMENT ((int)sizeof(hashmap_element_t) * 8 + 1)
-#define HASHMAP_ELEMENTS_PER_CHUNK \
-  ((HASHMAP_TARGET_CHUNK_BYTES * 8) / HASHMAP_BITS_PER_ELEMENT)
-#define HASHMAP_MASKS_PER_CHUNK                               \
-  ((HASHMAP_ELEMENTS_PER_CHUNK + HASHMAP_BITS_PER_MASK - 1) / \
-   HASHMAP_BITS_PER_MASK)
+/* Type used for the control bytes. The top bit marks an empty slot, the
+ * remaining seven bits of a full slot hold a fragment of the key's hash. */
+typedef int8_t hashmap_ctrl_t;
 
-#define HASHMAP_ALLOCS_INITIAL_SIZE (80 * 1024)
-#define HASHMAP_ALLOC_SIZE_FRACTION (0.1)
+/* Number of slots whose control bytes are probed together. */
+#define HASHMAP_GROUP_SIZE (16)
 
-#define HASHMAP_MAX_CHAIN_LENGTH (HASHMAP_ELEMENTS_PER_CHUNK / 8)
+#define HASHMAP_MAX_PROBE_LENGTH (32)
 #ifndef HASHMAP_DEBUG_OUTPUT
 #define HASHMAP_DEBUG_OUTPUT (0)
 #endif  // HASHMAP_DEBUG_OUTPUT
 
-/* A chunk of hashmap_element, with the corresponding bitmask. */
-typedef struct _hashmap_chunk {
-  union {
-    hashmap_mask_t masks[HASHMAP_MASKS_PER_CHUNK];
-    void *next;
-  };
-  hashmap_element_t data[HASHMAP_ELEMENTS_PER_CHUNK];
-} SWIFT_STRUCT_ALIGN hashmap_chunk_t;
-
 /* A hashmap has some maximum size and current size,
- * as well as the data to hold. */
+ * as well as the data to hold.
+ *
+ * The table is open-addressed: slot `i` is described by `ctrl[i]` and stored
+ * in `data[i]`. Lookups compare the control bytes of a whole group of
+ * #HASHMAP_GROUP_SIZE slots at once and only touch the elements whose hash
+ * fragment matches. */
 typedef struct _hashmap {
-  size_t table_size;
-  size_t size;
-  size_t nr_chunks;
-  hashmap_chunk_t *
-      *chunks;  // Pointer to chunks in use, but not densely populated.
-  hashmap_chunk_t
-      *graveyard;  // Pointer to allocated, but currently unused chunks.
-
-  void **allocs;        // Pointers to allocated blocks of chunks.
-  size_t allocs_size;   // Size of the allocs array.
-  size_t allocs_count;  // Number of elements in the allocs array.
+  size_t table_size;  // Number of slots, a power of two (or zero).
+  size_t size;        // Number of slots in use.
+
+  hashmap_ctrl_t *ctrl;     // Control bytes, one per slot.
+  hashmap_element_t *data;  // The elements, one per slot.
 
 #if HASHMAP_DEBUG_OUTPUT
-  /* Chain lengths, used for debugging only. */
-  size_t chain_length_counts[HASHMAP_MAX_CHAIN_LENGTH];
+  /* Probe lengths, used for debugging only. */
+  size_t chain_length_counts[HASHMAP_MAX_PROBE_LENGTH];
 #endif
 } hashmap_t;
 
@@ -118,21 +102,31 @@ typedef struct _hashmap {
  */
 typedef void (*hashmap_mapper_t)(hashmap_key_t, hashmap_value_t *, void *);
 
+/**
+ * Pointer to a function that folds the value of an element of a second
+ * hashmap (third argument) into the value stored for the same key (second
+ * argument). The last argument is a void pointer extra data payload.
+ */
+typedef void (*hashmap_merger_t)(hashmap_key_t, hashmap_value_t *,
+                                 const hashmap_value_t *, void *);
+
 /**
  * @brief Initialize a hashmap.
+ *
+ * No memory is allocated until the first element is added.
  */
 void hashmap_init(hashmap_t *m);
 
 /**
  * @brief Re-size the hashmap.
  *
- * Note that the hashmap size does not necessarily correspond to its
- * capacity, since it will grow if too many collisions occur. As a rule
- * of thumb, allocate twice as many elements as you think you will need.
+ * The table is re-hashed into one that can hold at least `new_size`
+ * elements without growing again. Calling this ahead of a bulk insertion of
+ * a known number of elements avoids intermediate re-hashing.
  *
  * @param m The hasmmap to grow.
- * @param new_size New table size. If zero, the current size will be increase
- *                 by a fixed rate.
+ * @param new_size New number of elements. If zero, the current size will be
+ *                 increase by a fixed rate.
  */
 void hashmap_grow(hashmap_t *m, size_t new_size);
 
@@ -179,6 +173,37 @@ extern hashmap_value_t *hashmap_lookup(hashmap_t *m, hashmap_key_t key);
  */
 extern void hashmap_iterate(hashmap_t *m, hashmap_mapper_t f, void *data);
 
+/**
+ * @brief Merge the elements of `other` into `m`.
+ *
+ * Elements whose key is not yet in `m` are created (with the same initial
+ * value as #hashmap_get) before `f` is called with the two values and the
+ * `void *data` argument. `other` is left untouched.
+ */
+extern void hashmap_merge(hashmap_t *m, hashmap_t *other, hashmap_merger_t f,
+                          void *data);
+
+/**
+ * @brief Merge an array of hashmaps into the first one using a threadpool.
+ *
+ * This is meant for threadpool mappers that fill one hashmap per thread
+ * (indexed by #threadpool_gettid) and need them combined at the end. The
+ * maps are merged pairwise in a tree, with the merges of one level of the
+ * tree running in parallel. All the maps but the first are freed.
+ *
+ * The smaller map of each pair is merged into the larger one, whichever of
+ * the two comes first in the array. `f` must hence give the same result
+ * whichever value it is given as the destination, and folding a value into
+ * a freshly created element must give that value back (e.g. sums, minima or
+ * maxima).
+ *
+ * `f` may be called concurrently on different pairs of maps, so it must
+ * only read from `data`.
+ */
+extern void hashmap_merge_parallel(hashmap_t *maps, int nr_maps,
+                                   hashmap_merger_t f, void *data,
+                                   struct threadpool *tp);
+
 /**
  * @brief De-allocate memory associated with this hashmap, clears all the
  * entries.
@@ -26,12 +26,18 @@
  *        with added SPHENIX physics (Borrow 2020) (interaction routines)
  */
 
+/* Some standard headers. */
+#include <float.h>
+
 #include "adaptive_softening_iact.h"
 #include "adiabatic_index.h"
+#include "dimension.h"
 #include "fvpm_geometry.h"
 #include "hydro_parameters.h"
+#include "kernel_hydro.h"
 #include "minmax.h"
 #include "signal_velocity.h"
+#include "vector.h"
 
 /**
  * @brief Density interaction between two particles.
@@ -631,4 +637,398 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_force(
 #endif
 }
 
+#ifdef WITH_VECTORIZATION
+
+/* The lane-parallel interactions below do not carry the adaptive softening,
+ * MHD, FVPM geometry or density check terms of the scalar ones. The loops
+ * only use them when none of these are compiled in. */
+#if !defined(ADAPTIVE_SOFTENING) && defined(NONE_MHD) && !defined(RT_GEAR) && \
+    !defined(SWIFT_HYDRO_DENSITY_CHECKS)
+#define HYDRO_VEC_DENSITY
+#define HYDRO_VEC_FORCE
+#endif
+
+#ifdef HYDRO_VEC_DENSITY
+
+/**
+ * @brief The fields of a particle broadcast over the lanes of a vector and
+ * the per-lane sums of its lane-parallel density interactions.
+ */
+struct runner_iact_vec_data_density {
+
+  /*! Inverse smoothing length and velocity of pi. */
+  vector hi_inv, vix, viy, viz;
+
+  /*! Sums of the density fields of pi. */
+  vector rho, rho_dh, wcount, wcount_dh, div_v, rot_vx, rot_vy, rot_vz;
+};
+
+/**
+ * @brief Prepare the lane-parallel density interactions of a particle.
+ *
+ * @param d The #runner_iact_vec_data_density to fill.
+ * @param pi The particle.
+ * @param hi Comoving smoothing-length of the particle.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_init_density(struct runner_iact_vec_data_density* d,
+                                    const struct part* restrict pi,
+                                    const float hi, const float a,
+                                    const float H) {
+
+  d->hi_inv = vector_set1(1.f / hi);
+  d->vix = vector_set1(pi->v[0]);
+  d->viy = vector_set1(pi->v[1]);
+  d->viz = vector_set1(pi->v[2]);
+
+  d->rho = vector_setzero();
+  d->rho_dh = vector_setzero();
+  d->wcount = vector_setzero();
+  d->wcount_dh = vector_setzero();
+  d->div_v = vector_setzero();
+  d->rot_vx = vector_setzero();
+  d->rot_vy = vector_setzero();
+  d->rot_vz = vector_setzero();
+}
+
+/**
+ * @brief Density interaction between a particle and a vector of neighbours
+ * (non-symmetric lane-parallel version).
+ *
+ * Lane k computes the same terms as #runner_iact_nonsym_density does for the
+ * pair (pi, pj[k]). Only the lanes set in the mask are added to the sums.
+ *
+ * @param d The #runner_iact_vec_data_density of pi.
+ * @param r2 Comoving square distances between pi and the neighbours.
+ * @param dx Comoving x separations (pi - pj).
+ * @param dy Comoving y separations (pi - pj).
+ * @param dz Comoving z separations (pi - pj).
+ * @param pj The neighbours (not updated), one per lane.
+ * @param mask The lanes to interact with.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_density(struct runner_iact_vec_data_density* d,
+                               const vector r2, const vector dx,
+                               const vector dy, const vector dz,
+                               struct part* const* pj, const mask_t mask) {
+
+  /* Gather the fields of the neighbours. */
+  vector mj, vjx, vjy, vjz;
+  for (int k = 0; k < VEC_SIZE; k++) {
+    mj.f[k] = pj[k]->mass;
+    vjx.f[k] = pj[k]->v[0];
+    vjy.f[k] = pj[k]->v[1];
+    vjz.f[k] = pj[k]->v[2];
+  }
+
+  /* Get r and r inverse (zero for particles on top of each other). */
+  vector r, r_inv;
+  mask_t r_nonzero;
+  r.v = vec_sqrt(r2.v);
+  vec_create_mask(r_nonzero, vec_cmp_gt(r.v, vec_setzero()));
+  r_inv.v = vec_and_mask(
+      vec_div(vec_set1(1.f), vec_fmax(r.v, vec_set1(FLT_MIN))), r_nonzero);
+
+  /* Compute the kernel function */
+  vector ui, wi, wi_dx, wi_dh;
+  ui.v = vec_mul(r.v, d->hi_inv.v);
+  kernel_deval_1_vec(&ui, &wi, &wi_dx);
+  wi_dh.v = vec_fma(vec_set1(hydro_dimension), wi.v, vec_mul(ui.v, wi_dx.v));
+
+  /* Compute dv dot r and dv cross r */
+  vector dvx, dvy, dvz, dvdr, curlvrx, curlvry, curlvrz;
+  dvx.v = vec_sub(d->vix.v, vjx.v);
+  dvy.v = vec_sub(d->viy.v, vjy.v);
+  dvz.v = vec_sub(d->viz.v, vjz.v);
+  dvdr.v = vec_fma(dvx.v, dx.v, vec_fma(dvy.v, dy.v, vec_mul(dvz.v, dz.v)));
+  curlvrx.v = vec_fnma(dvz.v, dy.v, vec_mul(dvy.v, dz.v));
+  curlvry.v = vec_fnma(dvx.v, dz.v, vec_mul(dvz.v, dx.v));
+  curlvrz.v = vec_fnma(dvy.v, dx.v, vec_mul(dvx.v, dy.v));
+
+  vector faci;
+  faci.v = vec_mul(mj.v, vec_mul(wi_dx.v, r_inv.v));
+
+  /* Add the contributions of the lanes in the mask. */
+  d->rho.v = vec_mask_add(d->rho.v, vec_mul(mj.v, wi.v), mask);
+  d->rho_dh.v = vec_mask_sub(d->rho_dh.v, vec_mul(mj.v, wi_dh.v), mask);
+  d->wcount.v = vec_mask_add(d->wcount.v, wi.v, mask);
+  d->wcount_dh.v = vec_mask_sub(d->wcount_dh.v, wi_dh.v, mask);
+  d->div_v.v = vec_mask_sub(d->div_v.v, vec_mul(faci.v, dvdr.v), mask);
+  d->rot_vx.v = vec_mask_add(d->rot_vx.v, vec_mul(faci.v, curlvrx.v), mask);
+  d->rot_vy.v = vec_mask_add(d->rot_vy.v, vec_mul(faci.v, curlvry.v), mask);
+  d->rot_vz.v = vec_mask_add(d->rot_vz.v, vec_mul(faci.v, curlvrz.v), mask);
+}
+
+/**
+ * @brief Add the sums of the lane-parallel density interactions of a particle
+ * to its fields.
+ *
+ * @param d The #runner_iact_vec_data_density of pi.
+ * @param pi The particle.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_reduce_density(struct runner_iact_vec_data_density* d,
+                                      struct part* restrict pi) {
+
+  VEC_HADD(d->rho, pi->rho);
+  VEC_HADD(d->rho_dh, pi->density.rho_dh);
+  VEC_HADD(d->wcount, pi->density.wcount);
+  VEC_HADD(d->wcount_dh, pi->density.wcount_dh);
+  VEC_HADD(d->div_v, pi->viscosity.div_v);
+  VEC_HADD(d->rot_vx, pi->density.rot_v[0]);
+  VEC_HADD(d->rot_vy, pi->density.rot_v[1]);
+  VEC_HADD(d->rot_vz, pi->density.rot_v[2]);
+}
+
+#endif /* HYDRO_VEC_DENSITY */
+
+#ifdef HYDRO_VEC_FORCE
+
+/**
+ * @brief The fields of a particle broadcast over the lanes of a vector and
+ * the per-lane sums of its lane-parallel force interactions.
+ */
+struct runner_iact_vec_data_force {
+
+  /*! Fields of pi read by the force interactions. */
+  vector mi, rhoi, pressurei, P_over_rho2_i, hi_inv, hid_inv, vix, viy, viz;
+  vector fi, balsara_i, alpha_visc_i, alpha_diff_i, ui, ci;
+
+  /*! Cosmological factors entering the EoMs. */
+  vector fac_mu, a2_Hubble;
+
+  /*! Sums of the time derivatives of pi. */
+  vector a_hydro_x, a_hydro_y, a_hydro_z, u_dt, h_dt;
+};
+
+/**
+ * @brief Prepare the lane-parallel force interactions of a particle.
+ *
+ * @param d The #runner_iact_vec_data_force to fill.
+ * @param pi The particle.
+ * @param hi Comoving smoothing-length of the particle.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_init_force(struct runner_iact_vec_data_force* d,
+                                  const struct part* restrict pi,
+                                  const float hi, const float a,
+                                  const float H) {
+
+  const float hi_inv = 1.f / hi;
+
+  d->mi = vector_set1(pi->mass);
+  d->rhoi = vector_set1(pi->rho);
+  d->pressurei = vector_set1(pi->force.pressure);
+  d->P_over_rho2_i = vector_set1(pi->force.pressure / (pi->rho * pi->rho));
+  d->hi_inv = vector_set1(hi_inv);
+  d->hid_inv = vector_set1(pow_dimension_plus_one(hi_inv));
+  d->vix = vector_set1(pi->v[0]);
+  d->viy = vector_set1(pi->v[1]);
+  d->viz = vector_set1(pi->v[2]);
+  d->fi = vector_set1(pi->force.f);
+  d->balsara_i = vector_set1(pi->force.balsara);
+  d->alpha_visc_i = vector_set1(pi->viscosity.alpha);
+  d->alpha_diff_i = vector_set1(pi->diffusion.alpha);
+  d->ui = vector_set1(pi->u);
+  d->ci = vector_set1(pi->force.soundspeed);
+
+  d->fac_mu = vector_set1(pow_three_gamma_minus_five_over_two(a));
+  d->a2_Hubble = vector_set1(a * a * H);
+
+  d->a_hydro_x = vector_setzero();
+  d->a_hydro_y = vector_setzero();
+  d->a_hydro_z = vector_setzero();
+  d->u_dt = vector_setzero();
+  d->h_dt = vector_setzero();
+}
+
+/**
+ * @brief Force interaction between a particle and a vector of neighbours
+ * (non-symmetric lane-parallel version).
+ *
+ * Lane k computes the same terms as #runner_iact_nonsym_force does for the
+ * pair (pi, pj[k]). Only the lanes set in the mask are added to the sums.
+ *
+ * @param d The #runner_iact_vec_data_force of pi.
+ * @param r2 Comoving square distances between pi and the neighbours.
+ * @param dx Comoving x separations (pi - pj).
+ * @param dy Comoving y separations (pi - pj).
+ * @param dz Comoving z separations (pi - pj).
+ * @param pj The neighbours (not updated), one per lane.
+ * @param mask The lanes to interact with.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_force(struct runner_iact_vec_data_force* d,
+                             const vector r2, const vector dx, const vector dy,
+                             const vector dz, struct part* const* pj,
+                             const mask_t mask) {
+
+  /* Gather the fields of the neighbours. */
+  vector mj, rhoj, pressurej, hj, vjx, vjy, vjz;
+  vector fj, balsara_j, alpha_visc_j, alpha_diff_j, uj, cj;
+  for (int k = 0; k < VEC_SIZE; k++) {
+    mj.f[k] = pj[k]->mass;
+    rhoj.f[k] = pj[k]->rho;
+    pressurej.f[k] = pj[k]->force.pressure;
+    hj.f[k] = pj[k]->h;
+    vjx.f[k] = pj[k]->v[0];
+    vjy.f[k] = pj[k]->v[1];
+    vjz.f[k] = pj[k]->v[2];
+    fj.f[k] = pj[k]->force.f;
+    balsara_j.f[k] = pj[k]->force.balsara;
+    alpha_visc_j.f[k] = pj[k]->viscosity.alpha;
+    alpha_diff_j.f[k] = pj[k]->diffusion.alpha;
+    uj.f[k] = pj[k]->u;
+    cj.f[k] = pj[k]->force.soundspeed;
+  }
+
+  /* Get r and r inverse (zero for particles on top of each other). */
+  vector r, r_inv;
+  mask_t r_nonzero;
+  r.v = vec_sqrt(r2.v);
+  vec_create_mask(r_nonzero, vec_cmp_gt(r.v, vec_setzero()));
+  r_inv.v = vec_and_mask(
+      vec_div(vec_set1(1.f), vec_fmax(r.v, vec_set1(FLT_MIN))), r_nonzero);
+
+  /* Get the kernel for hi (zero outside of it). */
+  vector xi, wi_dx, wi_dr;
+  xi.v = vec_mul(r.v, d->hi_inv.v);
+  kernel_eval_dWdx_force_vec(&xi, &wi_dx);
+  wi_dr.v = vec_mul(d->hid_inv.v, wi_dx.v);
+
+  /* Get the kernel for hj (zero outside of it). */
+  vector hj_inv, hjd_inv, xj, wj_dx, wj_dr;
+  hj_inv.v = vec_div(vec_set1(1.f), hj.v);
+  hjd_inv = pow_dimension_plus_one_vec(hj_inv);
+  xj.v = vec_mul(r.v, hj_inv.v);
+  kernel_eval_dWdx_force_vec(&xj, &wj_dx);
+  wj_dr.v = vec_mul(hjd_inv.v, wj_dx.v);
+
+  /* Compute dv dot r. */
+  vector dvdr, dvdr_Hubble;
+  dvdr.v = vec_fma(vec_sub(d->vix.v, vjx.v), dx.v,
+                   vec_fma(vec_sub(d->viy.v, vjy.v), dy.v,
+                           vec_mul(vec_sub(d->viz.v, vjz.v), dz.v)));
+
+  /* Includes the hubble flow term; not used for du/dt */
+  dvdr_Hubble.v = vec_fma(d->a2_Hubble.v, r2.v, dvdr.v);
+
+  /* Are the particles moving towards each others ? */
+  vector omega_ij, mu_ij, v_sig;
+  omega_ij.v = vec_fmin(dvdr_Hubble.v, vec_setzero());
+  mu_ij.v = vec_mul(d->fac_mu.v, vec_mul(r_inv.v, omega_ij.v));
+
+  /* Compute sound speeds and signal velocity */
+  v_sig.v = vec_fnma(vec_set1(const_viscosity_beta), mu_ij.v,
+                     vec_add(d->ci.v, cj.v));
+
+  /* Variable smoothing length term */
+  vector f_ij, f_ji;
+  f_ij.v = vec_sub(vec_set1(1.f), vec_div(d->fi.v, mj.v));
+  f_ji.v = vec_sub(vec_set1(1.f), vec_div(fj.v, d->mi.v));
+
+  /* Construct the full viscosity term */
+  vector rho_ij, visc, visc_acc_term;
+  rho_ij.v = vec_add(d->rhoi.v, rhoj.v);
+  visc.v = vec_div(
+      vec_mul(vec_mul(vec_set1(-0.25f),
+                      vec_add(d->alpha_visc_i.v, alpha_visc_j.v)),
+              vec_mul(vec_mul(v_sig.v, mu_ij.v),
+                      vec_add(d->balsara_i.v, balsara_j.v))),
+      rho_ij.v);
+
+  /* Convolve with the kernel */
+  visc_acc_term.v =
+      vec_mul(vec_mul(vec_set1(0.5f), visc.v),
+              vec_mul(vec_fma(wi_dr.v, f_ij.v, vec_mul(wj_dr.v, f_ji.v)),
+                      r_inv.v));
+
+  /* Compute gradient terms */
+  vector P_over_rho2_i, P_over_rho2_j;
+  P_over_rho2_i.v = vec_mul(d->P_over_rho2_i.v, f_ij.v);
+  P_over_rho2_j.v =
+      vec_mul(vec_div(pressurej.v, vec_mul(rhoj.v, rhoj.v)), f_ji.v);
+
+  /* SPH acceleration term */
+  vector sph_acc_term, acc;
+  sph_acc_term.v = vec_mul(
+      vec_fma(P_over_rho2_i.v, wi_dr.v, vec_mul(P_over_rho2_j.v, wj_dr.v)),
+      r_inv.v);
+
+  /* Assemble the acceleration */
+  acc.v = vec_add(sph_acc_term.v, visc_acc_term.v);
+
+  /* Get the time derivative for u. */
+  vector sph_du_term_i, visc_du_term;
+  sph_du_term_i.v =
+      vec_mul(vec_mul(P_over_rho2_i.v, dvdr.v), vec_mul(r_inv.v, wi_dr.v));
+
+  /* Viscosity term */
+  visc_du_term.v =
+      vec_mul(vec_mul(vec_set1(0.5f), visc_acc_term.v), dvdr_Hubble.v);
+
+  /* Diffusion term */
+  vector alpha_diff, v_diff, diff_du_term, du_dt_i;
+  alpha_diff.v =
+      vec_div(vec_fma(d->pressurei.v, d->alpha_diff_i.v,
+                      vec_mul(pressurej.v, alpha_diff_j.v)),
+              vec_add(d->pressurei.v, pressurej.v));
+  v_diff.v = vec_mul(
+      vec_mul(alpha_diff.v, vec_set1(0.5f)),
+      vec_add(vec_sqrt(vec_div(
+                  vec_mul(vec_set1(2.f),
+                          vec_fabs(vec_sub(d->pressurei.v, pressurej.v))),
+                  rho_ij.v)),
+              vec_fabs(vec_mul(vec_mul(d->fac_mu.v, r_inv.v),
+                               dvdr_Hubble.v))));
+  diff_du_term.v = vec_mul(
+      vec_mul(v_diff.v, vec_sub(d->ui.v, uj.v)),
+      vec_fma(vec_mul(f_ij.v, wi_dr.v), vec_div(vec_set1(1.f), d->rhoi.v),
+              vec_div(vec_mul(f_ji.v, wj_dr.v), rhoj.v)));
+
+  /* Assemble the energy equation term */
+  du_dt_i.v =
+      vec_add(vec_add(sph_du_term_i.v, visc_du_term.v), diff_du_term.v);
+
+  /* Add the contributions of the lanes in the mask. */
+  d->a_hydro_x.v =
+      vec_mask_sub(d->a_hydro_x.v, vec_mul(mj.v, vec_mul(acc.v, dx.v)), mask);
+  d->a_hydro_y.v =
+      vec_mask_sub(d->a_hydro_y.v, vec_mul(mj.v, vec_mul(acc.v, dy.v)), mask);
+  d->a_hydro_z.v =
+      vec_mask_sub(d->a_hydro_z.v, vec_mul(mj.v, vec_mul(acc.v, dz.v)), mask);
+  d->u_dt.v = vec_mask_add(d->u_dt.v, vec_mul(du_dt_i.v, mj.v), mask);
+  d->h_dt.v = vec_mask_sub(
+      d->h_dt.v,
+      vec_div(vec_mul(vec_mul(mj.v, dvdr.v), vec_mul(r_inv.v, wi_dr.v)),
+              rhoj.v),
+      mask);
+}
+
+/**
+ * @brief Add the sums of the lane-parallel force interactions of a particle
+ * to its fields.
+ *
+ * @param d The #runner_iact_vec_data_force of pi.
+ * @param pi The particle.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_reduce_force(struct runner_iact_vec_data_force* d,
+                                    struct part* restrict pi) {
+
+  VEC_HADD(d->a_hydro_x, pi->a_hydro[0]);
+  VEC_HADD(d->a_hydro_y, pi->a_hydro[1]);
+  VEC_HADD(d->a_hydro_z, pi->a_hydro[2]);
+  VEC_HADD(d->u_dt, pi->u_dt);
+  VEC_HADD(d->h_dt, pi->force.h_dt);
+}
+
+#endif /* HYDRO_VEC_FORCE */
+
+#endif /* WITH_VECTORIZATION */
+
 #endif /* SWIFT_SPHENIX_HYDRO_IACT_H */
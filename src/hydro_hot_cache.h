@@ -0,0 +1,414 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_HYDRO_HOT_CACHE_H
+#define SWIFT_HYDRO_HOT_CACHE_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <string.h>
+
+/* Local headers */
+#include "align.h"
+#include "error.h"
+#include "inline.h"
+#include "kernel_hydro.h"
+#include "memuse.h"
+#include "vector.h"
+
+/* Avoid cyclic inclusions */
+struct part;
+
+/**
+ * @brief Which particles of a #hydro_hot_cache a search returns.
+ */
+enum hydro_hot_search_mode {
+
+  /*! The particles within the kernel of the searching particle. */
+  hydro_hot_search_gather,
+
+  /*! As above, plus the active particles that have the searching particle
+     within their own kernel. */
+  hydro_hot_search_gather_active_scatter,
+
+  /*! As above, plus the inactive particles that have the searching particle
+     within their own kernel. */
+  hydro_hot_search_gather_scatter,
+};
+
+/**
+ * @brief A SoA copy of the fields of the #part of a cell that the neighbour
+ * search of the hydro loops reads.
+ *
+ * Contrary to the #cache used by the vectorised Gadget-2 loops, this only
+ * holds the scheme-independent fields: the search runs over these compact
+ * streams for every scheme and the full #part is only read for the pairs
+ * that actually interact.
+ */
+struct hydro_hot_cache {
+
+  /*! #part x position in the frame of the interaction. */
+  float *restrict x SWIFT_CACHE_ALIGN;
+
+  /*! #part y position in the frame of the interaction. */
+  float *restrict y SWIFT_CACHE_ALIGN;
+
+  /*! #part z position in the frame of the interaction. */
+  float *restrict z SWIFT_CACHE_ALIGN;
+
+  /*! #part smoothing length. */
+  float *restrict h SWIFT_CACHE_ALIGN;
+
+  /*! Is the #part active in the current loop? */
+  int *restrict active SWIFT_CACHE_ALIGN;
+
+  /*! Is the #part inhibited? */
+  int *restrict inhibited SWIFT_CACHE_ALIGN;
+
+  /*! The #part each entry was copied from. */
+  struct part **restrict part SWIFT_CACHE_ALIGN;
+
+  /*! Indices of the neighbours found by the last search. */
+  int *restrict ngb SWIFT_CACHE_ALIGN;
+
+  /*! Square of the distances to the neighbours found by the last search. */
+  float *restrict ngb_r2 SWIFT_CACHE_ALIGN;
+
+  /*! x separation between the searching particle and the neighbours. */
+  float *restrict ngb_dx SWIFT_CACHE_ALIGN;
+
+  /*! y separation between the searching particle and the neighbours. */
+  float *restrict ngb_dy SWIFT_CACHE_ALIGN;
+
+  /*! z separation between the searching particle and the neighbours. */
+  float *restrict ngb_dz SWIFT_CACHE_ALIGN;
+
+  /*! Cache size */
+  int count;
+};
+
+/**
+ * @brief Frees the memory allocated in a #hydro_hot_cache
+ *
+ * @param c The #hydro_hot_cache to free.
+ */
+static INLINE void hydro_hot_cache_clean(struct hydro_hot_cache *c) {
+
+  if (c->count > 0) {
+    swift_free("hydro_hot_cache", c->x);
+    swift_free("hydro_hot_cache", c->y);
+    swift_free("hydro_hot_cache", c->z);
+    swift_free("hydro_hot_cache", c->h);
+    swift_free("hydro_hot_cache", c->active);
+    swift_free("hydro_hot_cache", c->inhibited);
+    swift_free("hydro_hot_cache", c->part);
+    swift_free("hydro_hot_cache", c->ngb);
+    swift_free("hydro_hot_cache", c->ngb_r2);
+    swift_free("hydro_hot_cache", c->ngb_dx);
+    swift_free("hydro_hot_cache", c->ngb_dy);
+    swift_free("hydro_hot_cache", c->ngb_dz);
+  }
+  c->count = 0;
+}
+
+/**
+ * @brief Allocates memory for a #hydro_hot_cache.
+ *
+ * The cache is padded for the vector size, aligned properly and zeroed.
+ *
+ * @param c The #hydro_hot_cache to allocate.
+ * @param count The number of #part to allocate for.
+ */
+static INLINE void hydro_hot_cache_init(struct hydro_hot_cache *c,
+                                        const int count) {
+
+  const int padded_count = count - (count % VEC_SIZE) + VEC_SIZE;
+  const size_t sizeBytesF = padded_count * sizeof(float);
+  const size_t sizeBytesI = padded_count * sizeof(int);
+  const size_t sizeBytesP = padded_count * sizeof(struct part *);
+
+  /* Delete old stuff if any */
+  hydro_hot_cache_clean(c);
+
+  int e = 0;
+  e += swift_memalign("hydro_hot_cache", (void **)&c->x, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->y, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->z, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->h, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->active,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesI);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->inhibited,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesI);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->part,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesP);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->ngb,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesI);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->ngb_r2,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->ngb_dx,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->ngb_dy,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesF);
+  e += swift_memalign("hydro_hot_cache", (void **)&c->ngb_dz,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytesF);
+
+  if (e != 0)
+    error("Couldn't allocate hydro hot cache, size: %d", padded_count);
+
+  /* The searches read whole vectors, including lanes past the particles
+   * copied in by the current loop. Make sure these never hold garbage that
+   * could raise FP exceptions. */
+  bzero(c->x, sizeBytesF);
+  bzero(c->y, sizeBytesF);
+  bzero(c->z, sizeBytesF);
+  bzero(c->h, sizeBytesF);
+  bzero(c->active, sizeBytesI);
+  bzero(c->inhibited, sizeBytesI);
+  bzero(c->part, sizeBytesP);
+
+  c->count = padded_count;
+}
+
+/**
+ * @brief Make sure a #hydro_hot_cache can hold a given number of #part.
+ *
+ * @param c The #hydro_hot_cache.
+ * @param count The number of #part.
+ */
+__attribute__((always_inline)) INLINE static void hydro_hot_cache_reserve(
+    struct hydro_hot_cache *c, const int count) {
+
+  if (c->count < count) hydro_hot_cache_init(c, count);
+}
+
+/**
+ * @brief Records a neighbour found by #hydro_hot_cache_search.
+ *
+ * @param c The #hydro_hot_cache.
+ * @param num The number of neighbours found so far.
+ * @param k The index of the neighbour in the cache.
+ * @param r2 The square of the distance to the neighbour.
+ * @param dx The x separation.
+ * @param dy The y separation.
+ * @param dz The z separation.
+ */
+__attribute__((always_inline)) INLINE static void hydro_hot_cache_add_ngb(
+    struct hydro_hot_cache *restrict c, const int num, const int k,
+    const float r2, const float dx, const float dy, const float dz) {
+
+  c->ngb[num] = k;
+  c->ngb_r2[num] = r2;
+  c->ngb_dx[num] = dx;
+  c->ngb_dy[num] = dy;
+  c->ngb_dz[num] = dz;
+}
+
+/**
+ * @brief Finds the neighbours of a particle amongst a range of the particles
+ * of a #hydro_hot_cache.
+ *
+ * The distance tests are done a vector at a time over the cache's arrays.
+ * This is independent of the hydro scheme: only the interactions with the
+ * neighbours found, which the caller does one at a time, are
+ * scheme-specific. Inhibited particles are never returned.
+ *
+ * The indices of the neighbours, in increasing order, and their separations
+ * from the searching particle (pi - pj) are stored in the cache's ngb arrays.
+ *
+ * @param c The #hydro_hot_cache to search.
+ * @param first The first index of the range to search.
+ * @param last The index one past the end of the range to search.
+ * @param pix The x position of the searching particle in the cache's frame.
+ * @param piy The y position of the searching particle in the cache's frame.
+ * @param piz The z position of the searching particle in the cache's frame.
+ * @param hig2 The square of the kernel radius of the searching particle.
+ * @param mode The #hydro_hot_search_mode.
+ *
+ * @return The number of neighbours found.
+ */
+__attribute__((always_inline)) INLINE static int hydro_hot_cache_search(
+    struct hydro_hot_cache *restrict c, const int first, const int last,
+    const float pix, const float piy, const float piz, const float hig2,
+    const enum hydro_hot_search_mode mode) {
+
+  int num = 0;
+
+#ifdef WITH_VECTORIZATION
+
+  const vector v_pix = vector_set1(pix);
+  const vector v_piy = vector_set1(piy);
+  const vector v_piz = vector_set1(piz);
+  const vector v_hig2 = vector_set1(hig2);
+  const vector v_kernel_gamma2 = vector_set1(kernel_gamma2);
+
+  /* Start from the aligned vector containing the first particle. The lanes
+   * outside of the range are masked out below. They hold either zeros (see
+   * hydro_hot_cache_init()) or particles copied by an earlier loop, never
+   * uninitialised memory. */
+  for (int k = first - (first % VEC_SIZE); k < last; k += VEC_SIZE) {
+
+    /* Compute the pairwise distances. */
+    vector v_dx, v_dy, v_dz, v_r2;
+    v_dx.v = vec_sub(v_pix.v, vec_load(&c->x[k]));
+    v_dy.v = vec_sub(v_piy.v, vec_load(&c->y[k]));
+    v_dz.v = vec_sub(v_piz.v, vec_load(&c->z[k]));
+    v_r2.v = vec_mul(v_dx.v, v_dx.v);
+    v_r2.v = vec_fma(v_dy.v, v_dy.v, v_r2.v);
+    v_r2.v = vec_fma(v_dz.v, v_dz.v, v_r2.v);
+
+    /* Which particles are within the kernel of the searching one? */
+    mask_t v_doi;
+    vec_create_mask(v_doi, vec_cmp_lt(v_r2.v, v_hig2.v));
+    int doi = vec_is_mask_true(v_doi);
+
+    /* Which particles have the searching one within their kernel? */
+    int doj = 0;
+    if (mode != hydro_hot_search_gather) {
+      const vector v_h = vector_load(&c->h[k]);
+      mask_t v_doj;
+      vec_create_mask(v_doj,
+                      vec_cmp_lt(v_r2.v, vec_mul(vec_mul(v_h.v, v_h.v),
+                                                 v_kernel_gamma2.v)));
+      doj = vec_is_mask_true(v_doj) & ~doi;
+    }
+
+    /* Mask out the lanes outside of the range. */
+    int range = (1 << VEC_SIZE) - 1;
+    if (k < first) range &= ~((1 << (first - k)) - 1);
+    if (k + VEC_SIZE > last) range &= (1 << (last - k)) - 1;
+    doi &= range;
+    doj &= range;
+
+    /* Record the neighbours. */
+    while (doi | doj) {
+      const int lane = __builtin_ctz(doi | doj);
+      const int bit = 1 << lane;
+      const int kk = k + lane;
+      if (!c->inhibited[kk] &&
+          ((doi & bit) || mode == hydro_hot_search_gather_scatter ||
+           c->active[kk])) {
+        hydro_hot_cache_add_ngb(c, num, kk, v_r2.f[lane], v_dx.f[lane],
+                                v_dy.f[lane], v_dz.f[lane]);
+        num++;
+      }
+      doi &= ~bit;
+      doj &= ~bit;
+    }
+  }
+
+#else
+
+  for (int k = first; k < last; k++) {
+
+    /* Skip inhibited particles. */
+    if (c->inhibited[k]) continue;
+
+    /* Compute the pairwise distance. */
+    const float dx = pix - c->x[k];
+    const float dy = piy - c->y[k];
+    const float dz = piz - c->z[k];
+    const float r2 = dx * dx + dy * dy + dz * dz;
+
+    /* Hit or miss? */
+    int hit = (r2 < hig2);
+    if (!hit && mode != hydro_hot_search_gather)
+      hit = (mode == hydro_hot_search_gather_scatter || c->active[k]) &&
+            (r2 < c->h[k] * c->h[k] * kernel_gamma2);
+
+    if (hit) {
+      hydro_hot_cache_add_ngb(c, num, k, r2, dx, dy, dz);
+      num++;
+    }
+  }
+
+#endif /* WITH_VECTORIZATION */
+
+  return num;
+}
+
+#ifdef WITH_VECTORIZATION
+
+/**
+ * @brief Fills the entries of the neighbour arrays of a #hydro_hot_cache past
+ * the neighbours found by the last search with copies of the last one.
+ *
+ * This lets a vector of neighbours be read across the end of the list, with
+ * the extra lanes masked out of any result.
+ *
+ * @param c The #hydro_hot_cache.
+ * @param num The number of neighbours found (> 0).
+ * @param num_padded The number of entries to fill up to.
+ */
+__attribute__((always_inline)) INLINE static void hydro_hot_cache_pad_ngbs(
+    struct hydro_hot_cache *restrict c, const int num, const int num_padded) {
+
+  for (int n = num; n < num_padded; n++)
+    hydro_hot_cache_add_ngb(c, n, c->ngb[num - 1], c->ngb_r2[num - 1],
+                            c->ngb_dx[num - 1], c->ngb_dy[num - 1],
+                            c->ngb_dz[num - 1]);
+}
+
+/**
+ * @brief Reads a vector of the neighbours found by the last search of a
+ * #hydro_hot_cache.
+ *
+ * @param c The #hydro_hot_cache.
+ * @param n The index of the first neighbour (a multiple of VEC_SIZE).
+ * @param r2 (return) The square of the distances to the neighbours.
+ * @param dx (return) The x separations.
+ * @param dy (return) The y separations.
+ * @param dz (return) The z separations.
+ * @param pj (return) The #part of the neighbours.
+ */
+__attribute__((always_inline)) INLINE static void hydro_hot_cache_load_ngbs(
+    const struct hydro_hot_cache *restrict c, const int n, vector *r2,
+    vector *dx, vector *dy, vector *dz, struct part **pj) {
+
+  r2->v = vec_load(&c->ngb_r2[n]);
+  dx->v = vec_load(&c->ngb_dx[n]);
+  dy->v = vec_load(&c->ngb_dy[n]);
+  dz->v = vec_load(&c->ngb_dz[n]);
+  for (int k = 0; k < VEC_SIZE; k++) pj[k] = c->part[c->ngb[n + k]];
+}
+
+/**
+ * @brief Creates the mask of the first lanes of a vector.
+ *
+ * @param mask (return) The mask.
+ * @param num_lanes The number of lanes to set.
+ */
+__attribute__((always_inline)) INLINE static void hydro_hot_cache_lane_mask(
+    mask_t *mask, const int num_lanes) {
+
+  vector lane;
+  for (int k = 0; k < VEC_SIZE; k++) lane.f[k] = (float)k;
+
+  mask_t m;
+  vec_create_mask(m, vec_cmp_lt(lane.v, vec_set1((float)num_lanes)));
+  *mask = m;
+}
+
+#endif /* WITH_VECTORIZATION */
+
+#endif /* SWIFT_HYDRO_HOT_CACHE_H */
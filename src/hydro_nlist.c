@@ -0,0 +1,319 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "hydro_nlist.h"
+
+/* Local headers. */
+#include "cell.h"
+#include "engine.h"
+#include "error.h"
+#include "memuse.h"
+
+/* Standard headers. */
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Round a size up to a multiple of the alignment of the blocks.
+ */
+__attribute__((always_inline, const)) INLINE static size_t
+hydro_nlist_round_size(const size_t size) {
+
+  const size_t align = sizeof(void *);
+  return ((size + align - 1) / align) * align;
+}
+
+/**
+ * @brief Find (or allocate) room for a given number of bytes in an arena
+ * without using it yet.
+ *
+ * @param arena The #hydro_nlist_arena.
+ * @param size The number of bytes we need.
+ */
+static void *hydro_nlist_arena_find_room(struct hydro_nlist_arena *arena,
+                                         const size_t size) {
+
+  /* Look for a block with enough room left, from the current one on */
+  for (struct hydro_nlist_block *b = arena->current; b != NULL; b = b->next) {
+    if (b->size - b->used >= size) {
+      arena->current = b;
+      return (char *)(b + 1) + b->used;
+    }
+  }
+
+  /* Get a new block */
+  const size_t block_size =
+      size > hydro_nlist_block_size ? size : hydro_nlist_block_size;
+  struct hydro_nlist_block *b = NULL;
+  if (swift_memalign("hydro_nlist", (void **)&b, SWIFT_STRUCT_ALIGNMENT,
+                     sizeof(struct hydro_nlist_block) + block_size) != 0)
+    error("Failed to allocate memory for the neighbour lists.");
+  b->size = block_size;
+  b->used = 0;
+
+  /* And insert it after the current one */
+  if (arena->current != NULL) {
+    b->next = arena->current->next;
+    arena->current->next = b;
+  } else {
+    b->next = arena->blocks;
+    arena->blocks = b;
+  }
+  arena->current = b;
+
+  return (char *)(b + 1);
+}
+
+/**
+ * @brief Initialise an empty #hydro_nlist_arena.
+ *
+ * @param arena The #hydro_nlist_arena.
+ */
+void hydro_nlist_arena_init(struct hydro_nlist_arena *arena) {
+
+  arena->blocks = NULL;
+  arena->current = NULL;
+  arena->built = 0;
+  arena->entries = 0;
+  arena->reused = 0;
+  arena->missed = 0;
+}
+
+/**
+ * @brief Forget all the lists stored in a #hydro_nlist_arena, keeping its
+ * memory for the next ones, and reset its counters.
+ *
+ * @param arena The #hydro_nlist_arena.
+ */
+void hydro_nlist_arena_reset(struct hydro_nlist_arena *arena) {
+
+  for (struct hydro_nlist_block *b = arena->blocks; b != NULL; b = b->next)
+    b->used = 0;
+  arena->current = arena->blocks;
+  arena->built = 0;
+  arena->entries = 0;
+  arena->reused = 0;
+  arena->missed = 0;
+}
+
+/**
+ * @brief Free the memory of a #hydro_nlist_arena.
+ *
+ * @param arena The #hydro_nlist_arena.
+ */
+void hydro_nlist_arena_clean(struct hydro_nlist_arena *arena) {
+
+  struct hydro_nlist_block *b = arena->blocks;
+  while (b != NULL) {
+    struct hydro_nlist_block *next = b->next;
+    swift_free("hydro_nlist", b);
+    b = next;
+  }
+  arena->blocks = NULL;
+  arena->current = NULL;
+}
+
+/**
+ * @brief Total size (in bytes) of the memory held by a #hydro_nlist_arena.
+ *
+ * @param arena The #hydro_nlist_arena.
+ */
+size_t hydro_nlist_arena_size(const struct hydro_nlist_arena *arena) {
+
+  size_t size = 0;
+  for (const struct hydro_nlist_block *b = arena->blocks; b != NULL;
+       b = b->next)
+    size += b->size;
+  return size;
+}
+
+/**
+ * @brief Get the neighbour lists of a cell for the current launch, making
+ * room for them in the arena if they do not exist yet.
+ *
+ * The cell must be locked by the caller.
+ *
+ * @param c The #cell.
+ * @param arena The #hydro_nlist_arena of the runner building the lists.
+ * @param epoch The launch of the engine the lists are built for.
+ */
+struct hydro_nlist *hydro_nlist_get_cell_lists(
+    struct cell *c, struct hydro_nlist_arena *arena, const int epoch) {
+
+  if (c->hydro.nlists == NULL || c->hydro.nlist_epoch != epoch) {
+
+    const size_t size =
+        hydro_nlist_round_size(hydro_nlist_slots * sizeof(struct hydro_nlist));
+    struct hydro_nlist *lists =
+        (struct hydro_nlist *)hydro_nlist_arena_find_room(arena, size);
+    arena->current->used += size;
+    bzero(lists, hydro_nlist_slots * sizeof(struct hydro_nlist));
+
+    c->hydro.nlists = lists;
+    c->hydro.nlist_epoch = epoch;
+  }
+
+  return c->hydro.nlists;
+}
+
+/**
+ * @brief Make room in an arena for a list that will not exceed a given
+ * number of pairs.
+ *
+ * The room is only used once hydro_nlist_commit() is called with the
+ * actual number of pairs. Only one list can be built at a time in a given
+ * arena.
+ *
+ * @param arena The #hydro_nlist_arena.
+ * @param max_count The maximal number of pairs in the list.
+ */
+struct hydro_nlist_entry *hydro_nlist_reserve(struct hydro_nlist_arena *arena,
+                                              const size_t max_count) {
+
+  return (struct hydro_nlist_entry *)hydro_nlist_arena_find_room(
+      arena, hydro_nlist_round_size(max_count * sizeof(struct hydro_nlist_entry)));
+}
+
+/**
+ * @brief Store a list filled in the room given by hydro_nlist_reserve().
+ *
+ * @param arena The #hydro_nlist_arena.
+ * @param list The #hydro_nlist to store the list in.
+ * @param entries The pairs.
+ * @param count The number of pairs.
+ */
+void hydro_nlist_commit(struct hydro_nlist_arena *arena,
+                        struct hydro_nlist *list,
+                        struct hydro_nlist_entry *entries, const int count) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if ((char *)entries != (char *)(arena->current + 1) + arena->current->used)
+    error("Committing a neighbour list that was not reserved last.");
+#endif
+
+  arena->current->used +=
+      hydro_nlist_round_size(count * sizeof(struct hydro_nlist_entry));
+  list->entries = entries;
+  list->count = count;
+
+  arena->built++;
+  arena->entries += count;
+}
+
+/**
+ * @brief Get the neighbour list of a cell or a pair of cells built during
+ * the current launch, if it is still complete.
+ *
+ * Lists are complete as long as none of the smoothing lengths of the two
+ * cells grew by more than the skin in the ghost.
+ *
+ * @param arena The #hydro_nlist_arena of the runner (for the counters).
+ * @param ci The first #cell of the pair.
+ * @param cj The second #cell of the pair (ci for self-interactions).
+ * @param slot The direction of the pair or hydro_nlist_self_slot.
+ * @param e The #engine.
+ *
+ * @return The list, or NULL if the interactions have to be searched again.
+ */
+const struct hydro_nlist *hydro_nlist_get(struct hydro_nlist_arena *arena,
+                                          const struct cell *ci,
+                                          const struct cell *cj,
+                                          const int slot,
+                                          const struct engine *e) {
+
+  const int epoch = e->hydro_nlist_epoch;
+  const struct hydro_nlist *list = NULL;
+
+  if (ci->hydro.nlists != NULL && ci->hydro.nlist_epoch == epoch &&
+      ci->hydro.nlist_invalid_epoch != epoch &&
+      cj->hydro.nlist_invalid_epoch != epoch &&
+      ci->hydro.nlists[slot].entries != NULL)
+    list = &ci->hydro.nlists[slot];
+
+  if (list != NULL)
+    arena->reused++;
+  else
+    arena->missed++;
+
+  return list;
+}
+
+/**
+ * @brief Initialise an empty #hydro_ngb_buffer for the particles of a cell.
+ *
+ * @param buffer The #hydro_ngb_buffer.
+ * @param count The number of particles in the cell.
+ */
+void hydro_ngb_buffer_init(struct hydro_ngb_buffer *buffer, const int count) {
+
+  buffer->size = 0;
+  buffer->count = 0;
+  buffer->candidates = NULL;
+  if ((buffer->first = (size_t *)malloc(sizeof(size_t) * count)) == NULL)
+    error("Can't allocate memory for the neighbour candidates.");
+  if ((buffer->num = (int *)malloc(sizeof(int) * count)) == NULL)
+    error("Can't allocate memory for the neighbour candidates.");
+  if ((buffer->h_gather = (float *)malloc(sizeof(float) * count)) == NULL)
+    error("Can't allocate memory for the neighbour candidates.");
+  for (int k = 0; k < count; k++) buffer->num[k] = -1;
+}
+
+/**
+ * @brief Free the memory of a #hydro_ngb_buffer.
+ *
+ * @param buffer The #hydro_ngb_buffer.
+ */
+void hydro_ngb_buffer_clean(struct hydro_ngb_buffer *buffer) {
+
+  free(buffer->candidates);
+  free(buffer->first);
+  free(buffer->num);
+  free(buffer->h_gather);
+  buffer->candidates = NULL;
+  buffer->size = 0;
+  buffer->count = 0;
+}
+
+/**
+ * @brief Append a candidate to a #hydro_ngb_buffer, growing it if needed.
+ *
+ * @param buffer The #hydro_ngb_buffer.
+ *
+ * @return The (uninitialised) new candidate.
+ */
+struct hydro_ngb_candidate *hydro_ngb_buffer_add(
+    struct hydro_ngb_buffer *buffer) {
+
+  if (buffer->count == buffer->size) {
+    buffer->size = buffer->size > 0 ? 2 * buffer->size : 256;
+    struct hydro_ngb_candidate *candidates =
+        (struct hydro_ngb_candidate *)realloc(
+            buffer->candidates,
+            buffer->size * sizeof(struct hydro_ngb_candidate));
+    if (candidates == NULL)
+      error("Can't allocate memory for the neighbour candidates.");
+    buffer->candidates = candidates;
+  }
+
+  return &buffer->candidates[buffer->count++];
+}
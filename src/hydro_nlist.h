@@ -0,0 +1,175 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_HYDRO_NLIST_H
+#define SWIFT_HYDRO_NLIST_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Standard headers. */
+#include <stddef.h>
+
+/* Forward declarations */
+struct cell;
+struct engine;
+struct part;
+
+/*! Number of neighbour lists a cell can hold: one for each of the 13 pair
+ * directions in which it is the first cell and one for the cell itself */
+#define hydro_nlist_slots 14
+
+/*! Slot of the list of the interactions within a cell */
+#define hydro_nlist_self_slot 13
+
+/*! Minimal size (in bytes) of the blocks of memory of an arena */
+#define hydro_nlist_block_size (4 * 1024 * 1024)
+
+/**
+ * @brief A pair of particles within range of each other.
+ */
+struct hydro_nlist_entry {
+
+  /*! Indices of the particles in their cells' arrays */
+  int i, j;
+
+  /*! Square of the distance between the particles */
+  float r2;
+};
+
+/**
+ * @brief The pairs of particles found by the density loop in a cell or a
+ * pair of cells.
+ */
+struct hydro_nlist {
+
+  /*! The pairs, NULL if the list was not built */
+  struct hydro_nlist_entry *entries;
+
+  /*! Number of pairs */
+  int count;
+};
+
+/**
+ * @brief A block of memory of an arena.
+ */
+struct hydro_nlist_block {
+
+  /*! Next block in the arena */
+  struct hydro_nlist_block *next;
+
+  /*! Size and used part (in bytes) of the memory following this header */
+  size_t size, used;
+};
+
+/**
+ * @brief Memory in which a runner stores the neighbour lists it builds.
+ *
+ * The lists only live for one engine launch. The blocks are kept from one
+ * launch to the next, such that we only allocate memory while the lists
+ * grow.
+ */
+struct hydro_nlist_arena {
+
+  /*! The blocks of memory */
+  struct hydro_nlist_block *blocks;
+
+  /*! The block we are currently filling */
+  struct hydro_nlist_block *current;
+
+  /*! Number of lists built since the last reset */
+  long long built;
+
+  /*! Number of pairs recorded since the last reset */
+  long long entries;
+
+  /*! Number of lists re-used since the last reset */
+  long long reused;
+
+  /*! Number of times a list was not available since the last reset */
+  long long missed;
+};
+
+/**
+ * @brief A candidate neighbour of a particle whose smoothing length is being
+ * iterated in the ghost.
+ */
+struct hydro_ngb_candidate {
+
+  /*! The neighbour */
+  struct part *pj;
+
+  /*! Vector from the neighbour to the particle (including the periodic
+   * shift) */
+  float dx[3];
+
+  /*! Square of the distance between the particles */
+  float r2;
+};
+
+/**
+ * @brief The candidate neighbours of the particles of a cell whose smoothing
+ * length has not converged after the density loop.
+ *
+ * The candidates of a particle are gathered once within a radius larger than
+ * its kernel and re-used for all the following iterations, until its
+ * smoothing length grows beyond that radius.
+ */
+struct hydro_ngb_buffer {
+
+  /*! The candidates, contiguous for each particle */
+  struct hydro_ngb_candidate *candidates;
+
+  /*! Allocated and used number of candidates */
+  size_t size, count;
+
+  /*! Index of the first candidate of each particle of the cell */
+  size_t *first;
+
+  /*! Number of candidates of each particle of the cell (-1 if not gathered) */
+  int *num;
+
+  /*! Smoothing length out to which the candidates of each particle of the
+   * cell were gathered */
+  float *h_gather;
+};
+
+void hydro_nlist_arena_init(struct hydro_nlist_arena *arena);
+void hydro_nlist_arena_reset(struct hydro_nlist_arena *arena);
+void hydro_nlist_arena_clean(struct hydro_nlist_arena *arena);
+size_t hydro_nlist_arena_size(const struct hydro_nlist_arena *arena);
+
+struct hydro_nlist *hydro_nlist_get_cell_lists(
+    struct cell *c, struct hydro_nlist_arena *arena, const int epoch);
+struct hydro_nlist_entry *hydro_nlist_reserve(struct hydro_nlist_arena *arena,
+                                              const size_t max_count);
+void hydro_nlist_commit(struct hydro_nlist_arena *arena,
+                        struct hydro_nlist *list,
+                        struct hydro_nlist_entry *entries, const int count);
+const struct hydro_nlist *hydro_nlist_get(struct hydro_nlist_arena *arena,
+                                          const struct cell *ci,
+                                          const struct cell *cj,
+                                          const int slot,
+                                          const struct engine *e);
+
+void hydro_ngb_buffer_init(struct hydro_ngb_buffer *buffer, const int count);
+void hydro_ngb_buffer_clean(struct hydro_ngb_buffer *buffer);
+struct hydro_ngb_candidate *hydro_ngb_buffer_add(
+    struct hydro_ngb_buffer *buffer);
+
+#endif /* SWIFT_HYDRO_NLIST_H */
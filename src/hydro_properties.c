@@ -39,6 +39,7 @@
 #include "units.h"
 
 #define hydro_props_default_max_iterations 30
+#define hydro_props_default_ghost_buffer_factor 1.25f
 #define hydro_props_default_volume_change 1.4f
 #define hydro_props_default_h_max FLT_MAX
 #define hydro_props_default_h_min_ratio 0.f
@@ -46,6 +47,7 @@
 #define hydro_props_default_init_temp 0.f
 #define hydro_props_default_min_temp 0.f
 #define hydro_props_default_H_ionization_temperature 1e4
+#define hydro_props_default_neighbour_list_skin 0.1f
 
 /**
  * @brief Initialize the global properties of the hydro scheme.
@@ -101,6 +103,14 @@ void hydro_props_init(struct hydro_props *p,
   if (p->max_smoothing_iterations <= 10)
     error("The number of smoothing length iterations should be > 10");
 
+  /* Radius of the candidate neighbours gathered by the ghost */
+  p->ghost_buffer_factor = parser_get_opt_param_float(
+      params, "SPH:ghost_neighbour_buffer",
+      hydro_props_default_ghost_buffer_factor);
+
+  if (p->ghost_buffer_factor != 0.f && p->ghost_buffer_factor < 1.f)
+    error("The ghost neighbour buffer must be 0 or >= 1!");
+
   /* ------ Neighbour number definition ------------ */
 
   /* Non-conventional neighbour number definition */
@@ -113,6 +123,18 @@ void hydro_props_init(struct hydro_props *p,
 #endif
   }
 
+  /* ------ Neighbour lists ------------------------ */
+
+  /* Do we record the pairs found by the density loop for the next loops? */
+  p->use_neighbour_lists =
+      parser_get_opt_param_int(params, "SPH:use_neighbour_lists", 0);
+  p->neighbour_list_skin = parser_get_opt_param_float(
+      params, "SPH:neighbour_list_skin",
+      hydro_props_default_neighbour_list_skin);
+
+  if (p->neighbour_list_skin < 0.f)
+    error("The skin of the neighbour lists must be positive!");
+
   /* ------ Time integration parameters ------------ */
 
   /* Time integration properties */
@@ -245,6 +267,10 @@ void hydro_props_print(const struct hydro_props *p) {
   else
     message("Neighbour number definition: Unweighted.");
 
+  if (p->use_neighbour_lists)
+    message("Re-using the density loop's neighbour lists with a skin of %.2f.",
+            p->neighbour_list_skin);
+
   if (p->h_max != hydro_props_default_h_max)
     message("Maximal smoothing length allowed: %.4f", p->h_max);
 
@@ -255,6 +281,10 @@ void hydro_props_print(const struct hydro_props *p) {
     message("Maximal iterations in ghost task set to %d (default is %d)",
             p->max_smoothing_iterations, hydro_props_default_max_iterations);
 
+  if (p->ghost_buffer_factor != hydro_props_default_ghost_buffer_factor)
+    message("Ghost neighbour buffer set to %.2f h (default is %.2f h)",
+            p->ghost_buffer_factor, hydro_props_default_ghost_buffer_factor);
+
   if (p->initial_temperature != hydro_props_default_init_temp)
     message("Initial gas temperature set to %f", p->initial_temperature);
 
@@ -363,6 +393,9 @@ void hydro_props_init_no_hydro(struct hydro_props *p) {
   p->h_min = 0.f;
   p->h_min_ratio = hydro_props_default_h_min_ratio;
   p->max_smoothing_iterations = hydro_props_default_max_iterations;
+  p->ghost_buffer_factor = hydro_props_default_ghost_buffer_factor;
+  p->use_neighbour_lists = 0;
+  p->neighbour_list_skin = hydro_props_default_neighbour_list_skin;
   p->CFL_condition = 0.1;
   p->log_max_h_change = logf(powf(1.4, hydro_dimension_inv));
 
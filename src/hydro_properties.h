@@ -73,11 +73,24 @@ struct hydro_props {
   /*! Maximal number of iterations to converge h */
   int max_smoothing_iterations;
 
+  /*! Radius (in units of h) out to which the ghost gathers the candidate
+   * neighbours of the particles that have not converged (0 to search the
+   * cells again at every iteration) */
+  float ghost_buffer_factor;
+
   /* ------ Neighbour number definition ------------ */
 
   /*! Are we using the mass-weighted definition of neighbour number? */
   int use_mass_weighted_num_ngb;
 
+  /* ------ Neighbour lists ------------------------ */
+
+  /*! Are the gradient and force loops re-using the density loop's pairs? */
+  int use_neighbour_lists;
+
+  /*! Relative growth of the kernel radii covered by the neighbour lists */
+  float neighbour_list_skin;
+
   /* ------ Time integration parameters ------------ */
 
   /*! Time integration properties */
@@ -0,0 +1,462 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "io_async_writer.h"
+
+/* Local includes. */
+#include "clocks.h"
+#include "error.h"
+#include "memuse.h"
+
+/* Some standard headers. */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/*! The kinds of work the writer can be asked to do. */
+enum io_async_job_type {
+  io_async_job_dataset,    /*!< Write a buffer to a dataset and close it */
+  io_async_job_chunks,     /*!< Write compressed chunks and close the dataset */
+  io_async_job_end_file,   /*!< Report on a file whose datasets are written */
+  io_async_job_command,    /*!< Run a shell command */
+  io_async_job_file,       /*!< Write a buffer at an offset in a plain file */
+  io_async_job_close_file, /*!< Close a plain file and report on it */
+};
+
+/*! A job in the writer's queue. */
+struct io_async_job {
+
+  /*! What to do. */
+  enum io_async_job_type type;
+
+#ifdef HAVE_HDF5
+  /*! Dataset, memory space and memory type to write. */
+  hid_t h_data, h_space, h_mem_type;
+#endif
+
+  /*! Data to write, freed once written. */
+  void *buffer;
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+  /*! Pre-compressed chunks to write, freed once written. */
+  struct io_compressed_dataset chunks;
+#endif
+
+  /*! Size of the buffer in bytes. */
+  size_t bytes;
+
+  /*! Plain file to write to and offset of the buffer in it. */
+  int fd;
+  size_t offset;
+
+  /*! Name of the dataset or file, or command to run. */
+  char *string;
+
+  /*! Next job in the queue. */
+  struct io_async_job *next;
+};
+
+/**
+ * @brief Report on the file just completed and reset the counters.
+ */
+static void io_async_writer_report(struct io_async_writer *w,
+                                   const char *fileName) {
+  if (w->verbose)
+    message(
+        "Finished writing '%s' in the background: %.3f MB in %.3f %s "
+        "(%.3f MB/s).",
+        fileName, w->bytes_written / (1024. * 1024.), w->write_time,
+        clocks_getunit(),
+        w->write_time > 0.
+            ? w->bytes_written / (1024. * 1024.) / (w->write_time / 1000.)
+            : 0.);
+  w->bytes_written = 0;
+  w->write_time = 0.;
+}
+
+/**
+ * @brief Process one job.
+ *
+ * Called by the writing thread without holding the lock.
+ */
+static void io_async_writer_do_job(struct io_async_writer *w,
+                                   struct io_async_job *job) {
+
+  switch (job->type) {
+
+    case io_async_job_dataset: {
+#ifdef HAVE_HDF5
+      const ticks tic = getticks();
+
+      const herr_t h_err = H5Dwrite(job->h_data, job->h_mem_type, job->h_space,
+                                    H5S_ALL, H5P_DEFAULT, job->buffer);
+      if (h_err < 0) error("Error while writing data array '%s'.", job->string);
+
+      swift_free("writebuff", job->buffer);
+      H5Dclose(job->h_data);
+      H5Sclose(job->h_space);
+
+      w->bytes_written += job->bytes;
+      w->write_time += clocks_from_ticks(getticks() - tic);
+#else
+      error("Can't write datasets without HDF5.");
+#endif
+    } break;
+
+    case io_async_job_chunks: {
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+      const ticks tic = getticks();
+
+      io_parallel_compression_write(job->h_data, &job->chunks, job->string);
+
+      io_parallel_compression_free(&job->chunks);
+      H5Dclose(job->h_data);
+      H5Sclose(job->h_space);
+
+      w->bytes_written += job->bytes;
+      w->write_time += clocks_from_ticks(getticks() - tic);
+#else
+      error("Can't write compressed chunks without HDF5 and zlib.");
+#endif
+    } break;
+
+    case io_async_job_file: {
+      const ticks tic = getticks();
+
+      const char *buffer = (const char *)job->buffer;
+      size_t done = 0;
+      while (done < job->bytes) {
+        const ssize_t n = pwrite(job->fd, buffer + done, job->bytes - done,
+                                 job->offset + done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0)
+          error("Failed to write to '%s' (%s)", job->string, strerror(errno));
+        done += n;
+      }
+      free(job->buffer);
+
+      w->bytes_written += job->bytes;
+      w->write_time += clocks_from_ticks(getticks() - tic);
+    } break;
+
+    case io_async_job_close_file:
+      if (close(job->fd) != 0)
+        error("Failed to close '%s' (%s)", job->string, strerror(errno));
+      io_async_writer_report(w, job->string);
+      break;
+
+    case io_async_job_end_file:
+      io_async_writer_report(w, job->string);
+      break;
+
+    case io_async_job_command: {
+      /* Let's trust the user's command... */
+      const int result = system(job->string);
+      if (result != 0) {
+        message("Snapshot dump command returned error code %d", result);
+      }
+    } break;
+  }
+}
+
+/**
+ * @brief Main loop of the writing thread.
+ */
+static void *io_async_writer_runner(void *data) {
+
+  struct io_async_writer *w = (struct io_async_writer *)data;
+
+  pthread_mutex_lock(&w->lock);
+  while (1) {
+
+    /* Wait for something to do. */
+    while (w->first == NULL && !w->stop) pthread_cond_wait(&w->cond, &w->lock);
+    if (w->first == NULL) break;
+
+    /* Pop the next job. */
+    struct io_async_job *job = w->first;
+    w->first = job->next;
+    if (w->first == NULL) w->last = NULL;
+    w->busy = 1;
+    pthread_mutex_unlock(&w->lock);
+
+    io_async_writer_do_job(w, job);
+
+    /* Release the job's share of the budget and wake up anyone waiting. */
+    pthread_mutex_lock(&w->lock);
+    w->bytes_staged -= job->bytes;
+    w->busy = 0;
+    pthread_cond_broadcast(&w->cond);
+
+    free(job->string);
+    free(job);
+  }
+  pthread_mutex_unlock(&w->lock);
+
+  return NULL;
+}
+
+/**
+ * @brief Add a job to the queue, waiting for room in the budget first.
+ */
+static void io_async_writer_push(struct io_async_writer *w,
+                                 struct io_async_job *job) {
+
+  job->next = NULL;
+
+  pthread_mutex_lock(&w->lock);
+
+  /* Back-pressure: wait until the new data fits in the budget. A buffer
+   * larger than the whole budget is accepted once the queue has drained. */
+  while (w->bytes_staged > 0 && w->bytes_staged + job->bytes > w->max_bytes)
+    pthread_cond_wait(&w->cond, &w->lock);
+
+  if (w->last == NULL)
+    w->first = job;
+  else
+    w->last->next = job;
+  w->last = job;
+  w->bytes_staged += job->bytes;
+
+  pthread_cond_broadcast(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * @brief Allocate a job of a given type.
+ */
+static struct io_async_job *io_async_job_new(enum io_async_job_type type,
+                                             const char *string) {
+  struct io_async_job *job =
+      (struct io_async_job *)calloc(1, sizeof(struct io_async_job));
+  if (job == NULL) error("Failed to allocate an asynchronous i/o job.");
+  job->type = type;
+  job->string = strdup(string);
+  if (job->string == NULL) error("Failed to copy an asynchronous i/o string.");
+  return job;
+}
+
+/**
+ * @brief Can we write snapshots asynchronously with this build?
+ *
+ * @return 1 if the HDF5 library is thread-safe, 0 otherwise.
+ */
+int io_async_writer_is_supported(void) {
+#ifdef HAVE_HDF5
+  hbool_t is_threadsafe = 0;
+  if (H5is_library_threadsafe(&is_threadsafe) < 0) return 0;
+  return is_threadsafe ? 1 : 0;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Initialise an asynchronous writer and start its thread.
+ *
+ * @param w The #io_async_writer.
+ * @param max_bytes The maximal number of bytes that can wait to be written.
+ * @param verbose Are we talkative?
+ */
+void io_async_writer_init(struct io_async_writer *w, size_t max_bytes,
+                          int verbose) {
+
+  w->first = NULL;
+  w->last = NULL;
+  w->bytes_staged = 0;
+  w->max_bytes = max_bytes;
+  w->busy = 0;
+  w->stop = 0;
+  w->bytes_written = 0;
+  w->write_time = 0.;
+  w->verbose = verbose;
+
+  if (pthread_mutex_init(&w->lock, NULL) != 0)
+    error("Failed to initialise the asynchronous writer lock.");
+  if (pthread_cond_init(&w->cond, NULL) != 0)
+    error("Failed to initialise the asynchronous writer condition.");
+  if (pthread_create(&w->thread, NULL, &io_async_writer_runner, w) != 0)
+    error("Failed to create the asynchronous writer thread.");
+}
+
+#ifdef HAVE_HDF5
+
+/**
+ * @brief Queue the writing of a buffer to a dataset.
+ *
+ * The writer takes ownership of the buffer (allocated with the label
+ * "writebuff"), the dataset and the data space, and frees or closes them
+ * once the data has been written.
+ *
+ * @param w The #io_async_writer.
+ * @param h_data The dataset to write to.
+ * @param h_space The memory data space.
+ * @param h_mem_type The memory data type.
+ * @param buffer The data to write.
+ * @param bytes The size of the buffer in bytes.
+ * @param name The name of the dataset, for error messages.
+ */
+void io_async_writer_write_dataset(struct io_async_writer *w, hid_t h_data,
+                                   hid_t h_space, hid_t h_mem_type,
+                                   void *buffer, size_t bytes,
+                                   const char *name) {
+
+  struct io_async_job *job = io_async_job_new(io_async_job_dataset, name);
+  job->h_data = h_data;
+  job->h_space = h_space;
+  job->h_mem_type = h_mem_type;
+  job->buffer = buffer;
+  job->bytes = bytes;
+  io_async_writer_push(w, job);
+}
+
+#endif /* HAVE_HDF5 */
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+
+/**
+ * @brief Queue the writing of pre-compressed chunks to a dataset.
+ *
+ * The writer takes ownership of the chunks, the dataset and the data space,
+ * and frees or closes them once the data has been written. The content of
+ * the #io_compressed_dataset passed in is reset.
+ *
+ * @param w The #io_async_writer.
+ * @param h_data The dataset to write to.
+ * @param h_space The data space of the dataset.
+ * @param chunks The compressed chunks.
+ * @param name The name of the dataset, for error messages.
+ */
+void io_async_writer_write_chunks(struct io_async_writer *w, hid_t h_data,
+                                  hid_t h_space,
+                                  struct io_compressed_dataset *chunks,
+                                  const char *name) {
+
+  struct io_async_job *job = io_async_job_new(io_async_job_chunks, name);
+  job->h_data = h_data;
+  job->h_space = h_space;
+  job->chunks = *chunks;
+  job->bytes = chunks->compressed_bytes;
+  chunks->chunks = NULL;
+  chunks->nr_chunks = 0;
+  io_async_writer_push(w, job);
+}
+
+#endif /* IO_HAVE_PARALLEL_COMPRESSION */
+
+/**
+ * @brief Queue a marker reporting on a file once all its datasets, queued
+ * before this call, have been written.
+ *
+ * @param w The #io_async_writer.
+ * @param fileName The name of the file.
+ */
+void io_async_writer_end_file(struct io_async_writer *w, const char *fileName) {
+  io_async_writer_push(w, io_async_job_new(io_async_job_end_file, fileName));
+}
+
+/**
+ * @brief Queue the writing of a buffer at a given offset in a plain file.
+ *
+ * The writer takes ownership of the buffer, allocated with malloc(), and
+ * frees it once it has been written. The file descriptor must stay open
+ * until the file is closed with io_async_writer_close_file().
+ *
+ * @param w The #io_async_writer.
+ * @param fd The file descriptor to write to.
+ * @param offset The offset in the file.
+ * @param buffer The data to write.
+ * @param bytes The size of the buffer in bytes.
+ * @param fileName The name of the file, for error messages.
+ */
+void io_async_writer_write_file(struct io_async_writer *w, int fd,
+                                size_t offset, void *buffer, size_t bytes,
+                                const char *fileName) {
+
+  struct io_async_job *job = io_async_job_new(io_async_job_file, fileName);
+  job->fd = fd;
+  job->offset = offset;
+  job->buffer = buffer;
+  job->bytes = bytes;
+  io_async_writer_push(w, job);
+}
+
+/**
+ * @brief Queue the closing of a plain file, and a report on it, once all
+ * the buffers queued before this call have been written.
+ *
+ * @param w The #io_async_writer.
+ * @param fd The file descriptor to close.
+ * @param fileName The name of the file.
+ */
+void io_async_writer_close_file(struct io_async_writer *w, int fd,
+                                const char *fileName) {
+
+  struct io_async_job *job =
+      io_async_job_new(io_async_job_close_file, fileName);
+  job->fd = fd;
+  io_async_writer_push(w, job);
+}
+
+/**
+ * @brief Queue a shell command to be run once all the datasets queued before
+ * this call have been written.
+ *
+ * @param w The #io_async_writer.
+ * @param command The command to run.
+ */
+void io_async_writer_run_command(struct io_async_writer *w,
+                                 const char *command) {
+  io_async_writer_push(w, io_async_job_new(io_async_job_command, command));
+}
+
+/**
+ * @brief Wait until all the queued jobs have been completed.
+ *
+ * @param w The #io_async_writer.
+ */
+void io_async_writer_wait(struct io_async_writer *w) {
+  pthread_mutex_lock(&w->lock);
+  while (w->first != NULL || w->busy) pthread_cond_wait(&w->cond, &w->lock);
+  pthread_mutex_unlock(&w->lock);
+}
+
+/**
+ * @brief Complete all the queued jobs and stop the writing thread.
+ *
+ * @param w The #io_async_writer.
+ */
+void io_async_writer_clean(struct io_async_writer *w) {
+
+  pthread_mutex_lock(&w->lock);
+  w->stop = 1;
+  pthread_cond_broadcast(&w->cond);
+  pthread_mutex_unlock(&w->lock);
+
+  if (pthread_join(w->thread, NULL) != 0)
+    error("Failed to join the asynchronous writer thread.");
+
+  pthread_mutex_destroy(&w->lock);
+  pthread_cond_destroy(&w->cond);
+}
@@ -0,0 +1,119 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_IO_ASYNC_WRITER_H
+#define SWIFT_IO_ASYNC_WRITER_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <pthread.h>
+#include <stddef.h>
+
+/* Local includes. */
+#include "io_parallel_compression.h"
+
+/* Forward declaration of the queued jobs. */
+struct io_async_job;
+
+/**
+ * @brief A background thread writing snapshot datasets.
+ *
+ * The fields of a snapshot are converted to their output units in the
+ * calling thread, exactly as for a synchronous dump, and the resulting
+ * buffers, or their chunks once compressed, are handed over to this writer.
+ * The HDF5 writes (including any compression left to the library) then
+ * happen in the background while the simulation carries on. The total size
+ * of the buffers waiting to be written is bounded; queuing more data blocks
+ * the caller until enough has been written.
+ *
+ * Writing snapshots requires a thread-safe build of the HDF5 library, as the
+ * engine may make other HDF5 calls while the writer is busy. The writer can
+ * also write buffers to plain files (used for the restart files), which has
+ * no such requirement.
+ */
+struct io_async_writer {
+
+  /*! The writing thread. */
+  pthread_t thread;
+
+  /*! Lock protecting the queue and counters below. */
+  pthread_mutex_t lock;
+
+  /*! Signalled whenever a job is added or completed. */
+  pthread_cond_t cond;
+
+  /*! Queue of jobs, in the order they were added. */
+  struct io_async_job *first, *last;
+
+  /*! Number of bytes queued or currently being written. */
+  size_t bytes_staged;
+
+  /*! Maximal number of bytes that can be queued. */
+  size_t max_bytes;
+
+  /*! Is the thread processing a job? */
+  int busy;
+
+  /*! Should the thread exit once the queue is empty? */
+  int stop;
+
+  /*! Bytes and time spent writing since the last file was completed. */
+  size_t bytes_written;
+  double write_time;
+
+  /*! Are we talkative? */
+  int verbose;
+};
+
+int io_async_writer_is_supported(void);
+void io_async_writer_init(struct io_async_writer *w, size_t max_bytes,
+                          int verbose);
+void io_async_writer_run_command(struct io_async_writer *w,
+                                 const char *command);
+void io_async_writer_end_file(struct io_async_writer *w, const char *fileName);
+void io_async_writer_write_file(struct io_async_writer *w, int fd,
+                                size_t offset, void *buffer, size_t bytes,
+                                const char *fileName);
+void io_async_writer_close_file(struct io_async_writer *w, int fd,
+                                const char *fileName);
+void io_async_writer_wait(struct io_async_writer *w);
+void io_async_writer_clean(struct io_async_writer *w);
+
+#ifdef HAVE_HDF5
+
+#include <hdf5.h>
+
+void io_async_writer_write_dataset(struct io_async_writer *w, hid_t h_data,
+                                   hid_t h_space, hid_t h_mem_type,
+                                   void *buffer, size_t bytes,
+                                   const char *name);
+
+#endif /* HAVE_HDF5 */
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+
+void io_async_writer_write_chunks(struct io_async_writer *w, hid_t h_data,
+                                  hid_t h_space,
+                                  struct io_compressed_dataset *chunks,
+                                  const char *name);
+
+#endif /* IO_HAVE_PARALLEL_COMPRESSION */
+
+#endif /* SWIFT_IO_ASYNC_WRITER_H */
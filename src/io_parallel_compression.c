@@ -0,0 +1,389 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "io_parallel_compression.h"
+
+/* Local includes. */
+#include "clocks.h"
+#include "error.h"
+#include "threadpool.h"
+
+/* Some standard headers. */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @brief Report the throughput of the stages of a snapshot write.
+ *
+ * @param stats The accumulated #io_write_stats.
+ * @param fileName The name of the file written.
+ */
+void io_write_stats_print(const struct io_write_stats *stats,
+                          const char *fileName) {
+
+  const double convert_time = clocks_from_ticks(stats->convert_ticks);
+  const double compress_time = clocks_from_ticks(stats->compress_ticks);
+  const double write_time = clocks_from_ticks(stats->write_ticks);
+  const double MB = 1024. * 1024.;
+
+  message("Stages of the writing of '%s':", fileName);
+  message("  conversion:  %10.3f MB in %10.3f %s (%.3f MB/s).",
+          stats->converted_bytes / MB, convert_time, clocks_getunit(),
+          convert_time > 0. ? stats->converted_bytes / MB / convert_time * 1000.
+                            : 0.);
+  if (stats->compressed_in_bytes > 0)
+    message(
+        "  compression: %10.3f MB in %10.3f %s (%.3f MB/s, ratio %.3f).",
+        stats->compressed_in_bytes / MB, compress_time, clocks_getunit(),
+        compress_time > 0.
+            ? stats->compressed_in_bytes / MB / compress_time * 1000.
+            : 0.,
+        stats->compressed_out_bytes > 0
+            ? (double)stats->compressed_in_bytes / stats->compressed_out_bytes
+            : 0.);
+  message("  writing:     %10.3f MB in %10.3f %s (%.3f MB/s).",
+          stats->written_bytes / MB, write_time, clocks_getunit(),
+          write_time > 0. ? stats->written_bytes / MB / write_time * 1000.
+                          : 0.);
+}
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+
+/*! Data shared by all the chunks of a dataset being compressed. */
+struct io_parallel_compress_data {
+
+  /*! The data of the whole dataset. */
+  const char *data;
+
+  /*! Number of rows in the dataset and in a chunk. */
+  size_t N, chunk_rows;
+
+  /*! Number of elements per row and size of an element in bytes. */
+  int dimension;
+  size_t type_size;
+
+  /*! Deflate level. */
+  int level;
+};
+
+/**
+ * @brief Fletcher-32 check-sum, identical to the one computed by HDF5's
+ * fletcher32 filter.
+ */
+static uint32_t io_fletcher32(const uint8_t *data, size_t len) {
+
+  size_t words = len / 2;
+  uint32_t sum1 = 0, sum2 = 0;
+
+  while (words) {
+    size_t tlen = words > 360 ? 360 : words;
+    words -= tlen;
+    do {
+      sum1 += (uint32_t)(((uint16_t)data[0]) << 8) | ((uint16_t)data[1]);
+      data += 2;
+      sum2 += sum1;
+    } while (--tlen);
+    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+  }
+
+  /* Odd number of bytes */
+  if (len % 2) {
+    sum1 += (uint32_t)(((uint16_t)*data) << 8);
+    sum2 += sum1;
+    sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+    sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+  }
+
+  sum1 = (sum1 & 0xffff) + (sum1 >> 16);
+  sum2 = (sum2 & 0xffff) + (sum2 >> 16);
+
+  return (sum2 << 16) | sum1;
+}
+
+/**
+ * @brief Mapper function passing chunks through the shuffle, deflate and
+ * fletcher32 filters, in the same order as the dataset's filter pipeline.
+ */
+static void io_parallel_compress_mapper(void *map_data, int num_elements,
+                                        void *extra_data) {
+
+  struct io_compressed_chunk *chunks = (struct io_compressed_chunk *)map_data;
+  const struct io_parallel_compress_data *d =
+      (const struct io_parallel_compress_data *)extra_data;
+
+  const size_t row_size = d->dimension * d->type_size;
+  const size_t chunk_bytes = d->chunk_rows * row_size;
+  const size_t nr_elements = chunk_bytes / d->type_size;
+
+  /* Edge chunks are stored at full size, so pad them with zeros. */
+  char *raw = (char *)malloc(chunk_bytes);
+  char *shuffled = (char *)malloc(chunk_bytes);
+  if (raw == NULL || shuffled == NULL)
+    error("Failed to allocate chunk compression buffers.");
+
+  for (int k = 0; k < num_elements; k++) {
+
+    struct io_compressed_chunk *c = &chunks[k];
+    const size_t first_row = c->offset[0];
+    const size_t nr_rows = first_row + d->chunk_rows > d->N
+                               ? d->N - first_row
+                               : d->chunk_rows;
+
+    /* Get the chunk's data, padded if needs be. */
+    memcpy(raw, d->data + first_row * row_size, nr_rows * row_size);
+    if (nr_rows < d->chunk_rows)
+      memset(raw + nr_rows * row_size, 0, chunk_bytes - nr_rows * row_size);
+
+    /* Shuffle: group the i-th bytes of all the elements together. */
+    for (size_t j = 0; j < d->type_size; ++j)
+      for (size_t i = 0; i < nr_elements; ++i)
+        shuffled[j * nr_elements + i] = raw[i * d->type_size + j];
+
+    /* Deflate, leaving room for the check-sum at the end. */
+    uLongf size = compressBound(chunk_bytes);
+    uint8_t *out = (uint8_t *)malloc(size + sizeof(uint32_t));
+    if (out == NULL) error("Failed to allocate compressed chunk buffer.");
+    if (compress2(out, &size, (const Bytef *)shuffled, chunk_bytes,
+                  d->level) != Z_OK)
+      error("Failed to deflate a chunk.");
+
+    /* Append the check-sum, little-endian as HDF5 does. */
+    const uint32_t sum = io_fletcher32(out, size);
+    out[size + 0] = (uint8_t)(sum & 0xff);
+    out[size + 1] = (uint8_t)((sum >> 8) & 0xff);
+    out[size + 2] = (uint8_t)((sum >> 16) & 0xff);
+    out[size + 3] = (uint8_t)((sum >> 24) & 0xff);
+    c->size = size + sizeof(uint32_t);
+
+    /* Give back what we did not use. */
+    c->data = realloc(out, c->size);
+    if (c->data == NULL) error("Failed to shrink compressed chunk buffer.");
+  }
+
+  free(raw);
+  free(shuffled);
+}
+
+/**
+ * @brief Compress the chunks of a dataset in parallel.
+ *
+ * The chunks are passed through the same filters as set up for the snapshot
+ * datasets when lossless compression is requested (shuffle, deflate and
+ * fletcher32), such that they can be written with direct chunk writes and
+ * read back by any HDF5 reader.
+ *
+ * @param tp The #threadpool.
+ * @param data The data of the whole dataset.
+ * @param N The number of rows in the dataset.
+ * @param dimension The number of elements per row.
+ * @param type_size The size of one element in bytes.
+ * @param chunk_rows The number of rows in a chunk.
+ * @param level The deflate level.
+ * @param out (return) The compressed chunks.
+ */
+void io_parallel_compress(struct threadpool *tp, const void *data, size_t N,
+                          int dimension, size_t type_size, size_t chunk_rows,
+                          int level, struct io_compressed_dataset *out) {
+
+  const int nr_chunks = (N + chunk_rows - 1) / chunk_rows;
+
+  out->nr_chunks = nr_chunks;
+  out->chunks = (struct io_compressed_chunk *)calloc(
+      nr_chunks, sizeof(struct io_compressed_chunk));
+  if (out->chunks == NULL) error("Failed to allocate compressed chunks.");
+
+  for (int k = 0; k < nr_chunks; ++k) out->chunks[k].offset[0] = k * chunk_rows;
+
+  struct io_parallel_compress_data extra = {
+      (const char *)data, N, chunk_rows, dimension, type_size, level};
+  threadpool_map(tp, io_parallel_compress_mapper, out->chunks, nr_chunks,
+                 sizeof(struct io_compressed_chunk), /*chunk=*/1, &extra);
+
+  out->raw_bytes = N * dimension * type_size;
+  out->compressed_bytes = 0;
+  for (int k = 0; k < nr_chunks; ++k)
+    out->compressed_bytes += out->chunks[k].size;
+}
+
+/**
+ * @brief Write pre-compressed chunks to a dataset.
+ *
+ * @param h_data The dataset, created with the matching filters and chunking.
+ * @param d The compressed chunks.
+ * @param name The name of the dataset, for error messages.
+ */
+void io_parallel_compression_write(hid_t h_data,
+                                   const struct io_compressed_dataset *d,
+                                   const char *name) {
+
+  for (int k = 0; k < d->nr_chunks; ++k) {
+    const herr_t h_err =
+        H5Dwrite_chunk(h_data, H5P_DEFAULT, /*filter_mask=*/0,
+                       d->chunks[k].offset, d->chunks[k].size,
+                       d->chunks[k].data);
+    if (h_err < 0)
+      error("Error while writing chunk %d of data array '%s'.", k, name);
+  }
+}
+
+/**
+ * @brief Free the memory used by compressed chunks.
+ *
+ * @param d The compressed chunks.
+ */
+void io_parallel_compression_free(struct io_compressed_dataset *d) {
+
+  for (int k = 0; k < d->nr_chunks; ++k) free(d->chunks[k].data);
+  free(d->chunks);
+  d->chunks = NULL;
+  d->nr_chunks = 0;
+}
+
+/**
+ * @brief Check whether we can undo the filters of a dataset ourselves.
+ *
+ * We know how to undo the shuffle, deflate and fletcher32 filters, as long as
+ * the shuffling was done with the size of the elements we read.
+ *
+ * @param h_plist The creation property list of the dataset.
+ * @param type_size The size of the elements of the dataset.
+ * @param p (return) The #io_filter_pipeline.
+ *
+ * @return 1 if all the filters can be undone, 0 otherwise.
+ */
+int io_parallel_decompression_init(hid_t h_plist, size_t type_size,
+                                   struct io_filter_pipeline *p) {
+
+  const int nr_filters = H5Pget_nfilters(h_plist);
+  if (nr_filters < 0 || nr_filters > IO_MAX_FILTERS) return 0;
+
+  p->nr_filters = nr_filters;
+  p->shuffle_size = type_size;
+
+  for (int i = 0; i < nr_filters; ++i) {
+    unsigned int flags = 0;
+    size_t nr_values = 1;
+    unsigned int values[1] = {0};
+    const H5Z_filter_t filter = H5Pget_filter2(
+        h_plist, i, &flags, &nr_values, values, 0, NULL, NULL);
+
+    switch (filter) {
+      case H5Z_FILTER_DEFLATE:
+      case H5Z_FILTER_FLETCHER32:
+        break;
+      case H5Z_FILTER_SHUFFLE:
+        /* The element size is only recorded once the dataset exists. */
+        if (nr_values > 0 && values[0] != type_size) return 0;
+        break;
+      default:
+        return 0;
+    }
+    p->filters[i] = filter;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief Undo the filters applied to a chunk.
+ *
+ * The filters are undone in the reverse order of the pipeline, skipping the
+ * ones HDF5 flagged as not applied to this chunk.
+ *
+ * @param p The #io_filter_pipeline of the dataset.
+ * @param filter_mask The filters not applied to this chunk.
+ * @param raw The chunk as stored in the file. Overwritten.
+ * @param raw_size The size of the stored chunk in bytes.
+ * @param out (return) The decoded chunk.
+ * @param out_size The size of a decoded chunk in bytes.
+ * @param scratch A buffer of at least out_size bytes.
+ * @param name The name of the dataset, for error messages.
+ */
+void io_parallel_decompress_chunk(const struct io_filter_pipeline *p,
+                                  unsigned filter_mask, void *raw,
+                                  size_t raw_size, void *out, size_t out_size,
+                                  void *scratch, const char *name) {
+
+  char *cur = (char *)raw;
+  size_t cur_size = raw_size;
+
+  for (int i = p->nr_filters - 1; i >= 0; --i) {
+
+    /* Was this filter skipped when writing this chunk? */
+    if (filter_mask & (1u << i)) continue;
+
+    /* Where do we put the result? */
+    char *next = (cur == (char *)out) ? (char *)scratch : (char *)out;
+
+    switch (p->filters[i]) {
+
+      case H5Z_FILTER_FLETCHER32: {
+        if (cur_size < sizeof(uint32_t))
+          error("Invalid chunk size in data set '%s'.", name);
+        cur_size -= sizeof(uint32_t);
+        const uint8_t *stored = (const uint8_t *)cur + cur_size;
+        const uint32_t sum = (uint32_t)stored[0] | ((uint32_t)stored[1] << 8) |
+                             ((uint32_t)stored[2] << 16) |
+                             ((uint32_t)stored[3] << 24);
+        if (io_fletcher32((const uint8_t *)cur, cur_size) != sum)
+          error("Check-sum mismatch in a chunk of data set '%s'.", name);
+      } break;
+
+      case H5Z_FILTER_DEFLATE: {
+        uLongf size = out_size;
+        if (uncompress((Bytef *)next, &size, (const Bytef *)cur, cur_size) !=
+            Z_OK)
+          error("Failed to inflate a chunk of data set '%s'.", name);
+        cur = next;
+        cur_size = size;
+      } break;
+
+      case H5Z_FILTER_SHUFFLE: {
+        const size_t nr_elements = cur_size / p->shuffle_size;
+        for (size_t j = 0; j < p->shuffle_size; ++j)
+          for (size_t k = 0; k < nr_elements; ++k)
+            next[k * p->shuffle_size + j] = cur[j * nr_elements + k];
+
+        /* Left-over bytes are not shuffled. */
+        const size_t done = nr_elements * p->shuffle_size;
+        memcpy(next + done, cur + done, cur_size - done);
+        cur = next;
+      } break;
+
+      default:
+        error("Unsupported filter in data set '%s'.", name);
+    }
+  }
+
+  if (cur_size != out_size)
+    error("Unexpected chunk size in data set '%s'.", name);
+  if (cur != (char *)out) memcpy(out, cur, out_size);
+}
+
+#endif /* IO_HAVE_PARALLEL_COMPRESSION */
@@ -0,0 +1,131 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_IO_PARALLEL_COMPRESSION_H
+#define SWIFT_IO_PARALLEL_COMPRESSION_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <stddef.h>
+
+/* Local includes. */
+#include "cycle.h"
+
+/* Forward declarations. */
+struct threadpool;
+
+/**
+ * @brief Time spent and bytes processed by each stage of a snapshot write.
+ */
+struct io_write_stats {
+
+  /*! Bytes produced by the conversion of the particle fields. */
+  size_t converted_bytes;
+
+  /*! Bytes fed to, and produced by, the parallel compression. */
+  size_t compressed_in_bytes, compressed_out_bytes;
+
+  /*! Bytes handed over to HDF5. */
+  size_t written_bytes;
+
+  /*! Time spent converting, compressing and writing. */
+  ticks convert_ticks, compress_ticks, write_ticks;
+};
+
+void io_write_stats_print(const struct io_write_stats *stats,
+                          const char *fileName);
+
+#if defined(HAVE_HDF5) && defined(HAVE_ZLIB)
+
+#include <hdf5.h>
+
+/* Shuffle, deflate and check-sum chunks ourselves, and undo these filters
+ * when reading. This needs H5Dwrite_chunk() and H5Dread_chunk(), which
+ * appeared in HDF5 1.10.3. */
+#if H5_VERSION_GE(1, 10, 3)
+#define IO_HAVE_PARALLEL_COMPRESSION
+#endif
+
+#endif /* HAVE_HDF5 && HAVE_ZLIB */
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+
+/**
+ * @brief A chunk of a dataset, already passed through the filter pipeline.
+ */
+struct io_compressed_chunk {
+
+  /*! Offset of the chunk in the dataset (rows, columns). */
+  hsize_t offset[2];
+
+  /*! The filtered data and its size in bytes. */
+  void *data;
+  size_t size;
+};
+
+/**
+ * @brief A whole dataset split into filtered chunks, ready to be written
+ * with direct chunk writes.
+ */
+struct io_compressed_dataset {
+
+  /*! The chunks. */
+  struct io_compressed_chunk *chunks;
+  int nr_chunks;
+
+  /*! Number of bytes before and after filtering. */
+  size_t raw_bytes, compressed_bytes;
+};
+
+void io_parallel_compress(struct threadpool *tp, const void *data, size_t N,
+                          int dimension, size_t type_size, size_t chunk_rows,
+                          int level, struct io_compressed_dataset *out);
+void io_parallel_compression_write(hid_t h_data,
+                                   const struct io_compressed_dataset *d,
+                                   const char *name);
+void io_parallel_compression_free(struct io_compressed_dataset *d);
+
+/*! Maximal number of filters we can undo on a chunk. */
+#define IO_MAX_FILTERS 8
+
+/**
+ * @brief The filters applied to the chunks of a dataset, in the order they
+ * were applied when writing.
+ */
+struct io_filter_pipeline {
+
+  /*! The filters. */
+  H5Z_filter_t filters[IO_MAX_FILTERS];
+  int nr_filters;
+
+  /*! Element size used by the shuffle filter. */
+  size_t shuffle_size;
+};
+
+int io_parallel_decompression_init(hid_t h_plist, size_t type_size,
+                                   struct io_filter_pipeline *p);
+void io_parallel_decompress_chunk(const struct io_filter_pipeline *p,
+                                  unsigned filter_mask, void *raw,
+                                  size_t raw_size, void *out, size_t out_size,
+                                  void *scratch, const char *name);
+
+#endif /* IO_HAVE_PARALLEL_COMPRESSION */
+
+#endif /* SWIFT_IO_PARALLEL_COMPRESSION_H */
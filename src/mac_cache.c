@@ -0,0 +1,333 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "mac_cache.h"
+
+/* Local headers. */
+#include "atomic.h"
+#include "cell.h"
+#include "error.h"
+#include "gravity.h"
+#include "memuse.h"
+#include "multipole_accept.h"
+
+/* Standard headers. */
+#include <math.h>
+#include <stdint.h>
+
+/**
+ * @brief Hash of a pair of cells.
+ */
+__attribute__((always_inline, const)) INLINE static uint64_t mac_cache_hash(
+    const uintptr_t a, const uintptr_t b) {
+
+  uint64_t h = (uint64_t)a * 0x9E3779B97F4A7C15ULL;
+  h ^= (uint64_t)b + 0x7F4A7C159E3779B9ULL + (h << 6) + (h >> 2);
+  h ^= h >> 31;
+  h *= 0xBF58476D1CE4E5B9ULL;
+  h ^= h >> 29;
+  return h;
+}
+
+/**
+ * @brief Evaluate the MAC for a pair of cells and record the decision, and
+ * the range over which it can be re-used, in a slot.
+ *
+ * Refusals can always be re-used as they only lead to more accurate
+ * interactions. Acceptances are only given a validity range if the MAC
+ * still accepts the pair once both multipoles have grown by the tolerance
+ * and moved towards each other by the same amount. Otherwise, they are only
+ * valid for the current sizes and distance.
+ *
+ * @param entry The slot to fill.
+ * @param props The properties of the gravity scheme.
+ * @param multi_i The multipole of the first cell.
+ * @param multi_j The multipole of the second cell.
+ * @param r2 The square of the distance between the centres of mass.
+ * @param periodic Are we using periodic BCs?
+ * @param tolerance The fractional growth over which decisions are valid.
+ */
+static int mac_cache_evaluate(struct mac_cache_entry *entry,
+                              const struct gravity_props *props,
+                              const struct gravity_tensors *multi_i,
+                              const struct gravity_tensors *multi_j,
+                              const float r2, const int periodic,
+                              const float tolerance) {
+
+  const int accept = gravity_M2L_accept_symmetric(props, multi_i, multi_j, r2,
+                                                  /*use_rebuild_sizes=*/0,
+                                                  periodic);
+
+  const float r_max_i = multi_i->r_max;
+  const float r_max_j = multi_j->r_max;
+  const float delta = tolerance * (r_max_i + r_max_j);
+
+  /* Would we still accept the pair at the edge of the validity range? */
+  float tol = tolerance;
+  if (accept && tol > 0.f) {
+    const float r_min = sqrtf(r2) - delta;
+    const float rho_i = r_max_i * (1.f + tol);
+    const float rho_j = r_max_j * (1.f + tol);
+    if (r_min <= 0.f ||
+        !gravity_M2L_accept_sizes(props, multi_i, multi_j, rho_i, rho_j,
+                                  r_min * r_min, periodic) ||
+        !gravity_M2L_accept_sizes(props, multi_j, multi_i, rho_j, rho_i,
+                                  r_min * r_min, periodic))
+      tol = 0.f;
+  }
+
+  entry->accept = accept;
+  entry->r_max_i = r_max_i * (1.f + tol);
+  entry->r_max_j = r_max_j * (1.f + tol);
+  if (tol > 0.f) {
+    const float r = sqrtf(r2);
+    entry->r2_min = (r > delta) ? (r - delta) * (r - delta) : 0.f;
+    entry->r2_max = (r + delta) * (r + delta);
+  } else {
+    entry->r2_min = r2;
+    entry->r2_max = r2;
+  }
+
+  return accept;
+}
+
+/**
+ * @brief Can we use the MM interactions for a given pair of cells? Returns a
+ * cached decision if a valid one exists and evaluates (and caches) the MAC
+ * otherwise.
+ *
+ * @param cache The #mac_cache.
+ * @param props The properties of the gravity scheme.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param r2 The square of the (current) distance between the centres of mass.
+ * @param periodic Are we using periodic BCs?
+ * @param ti_current The current integer time.
+ */
+int mac_cache_can_use_pair_mm(struct mac_cache *cache,
+                              const struct gravity_props *props,
+                              const struct cell *ci, const struct cell *cj,
+                              const float r2, const int periodic,
+                              const integertime_t ti_current) {
+
+  /* Order the pair */
+  if ((uintptr_t)ci > (uintptr_t)cj) {
+    const struct cell *temp = ci;
+    ci = cj;
+    cj = temp;
+  }
+  const struct gravity_tensors *multi_i = ci->grav.multipole;
+  const struct gravity_tensors *multi_j = cj->grav.multipole;
+
+  /* Nothing to look into before the first tree build */
+  if (cache->size == 0)
+    return gravity_M2L_accept_symmetric(props, multi_i, multi_j, r2,
+                                        /*use_rebuild_sizes=*/0, periodic);
+
+  const size_t mask = cache->size - 1;
+  const size_t home = mac_cache_hash((uintptr_t)ci, (uintptr_t)cj) & mask;
+
+  /* Look for the pair, keeping track of a slot we could use otherwise */
+  struct mac_cache_entry *victim = NULL;
+  for (int k = 0; k < mac_cache_probe_length; ++k) {
+
+    struct mac_cache_entry *entry = &cache->entries[(home + k) & mask];
+
+    /* Quick (unlocked) check of the key. */
+    if (entry->ci == ci && entry->cj == cj) {
+
+      if (lock_lock(&entry->lock) != 0) error("Failed to lock MAC cache slot");
+
+      /* Is it still our pair? */
+      if (entry->ci == ci && entry->cj == cj) {
+
+        /* Decisions already used in this step stand. Older ones must still
+         * be within their validity range. */
+        int accept;
+        if (entry->ti_used == ti_current ||
+            (r2 >= entry->r2_min && r2 <= entry->r2_max &&
+             multi_i->r_max <= entry->r_max_i &&
+             multi_j->r_max <= entry->r_max_j)) {
+          accept = entry->accept;
+          entry->hits++;
+        } else {
+          accept = mac_cache_evaluate(entry, props, multi_i, multi_j, r2,
+                                      periodic, cache->tolerance);
+          entry->invalidations++;
+        }
+        entry->ti_used = ti_current;
+
+        if (lock_unlock(&entry->lock) != 0)
+          error("Failed to unlock MAC cache slot");
+        return accept;
+      }
+
+      if (lock_unlock(&entry->lock) != 0)
+        error("Failed to unlock MAC cache slot");
+    }
+
+    /* Empty slots and decisions not used in this step can be replaced */
+    if (victim == NULL && entry->ti_used != ti_current) victim = entry;
+  }
+
+  /* Not found, store a new decision if we can */
+  if (victim != NULL) {
+
+    if (lock_lock(&victim->lock) != 0) error("Failed to lock MAC cache slot");
+
+    /* Did anyone claim that slot in the meantime? */
+    if (victim->ti_used != ti_current) {
+
+      if (victim->ci != NULL) victim->evictions++;
+      victim->ci = ci;
+      victim->cj = cj;
+      victim->ti_used = ti_current;
+      victim->misses++;
+      const int accept = mac_cache_evaluate(victim, props, multi_i, multi_j,
+                                            r2, periodic, cache->tolerance);
+
+      if (lock_unlock(&victim->lock) != 0)
+        error("Failed to unlock MAC cache slot");
+      return accept;
+    }
+
+    if (lock_unlock(&victim->lock) != 0)
+      error("Failed to unlock MAC cache slot");
+  }
+
+  /* No room for this pair, just evaluate the MAC */
+  atomic_inc(&cache->uncached);
+  return gravity_M2L_accept_symmetric(props, multi_i, multi_j, r2,
+                                      /*use_rebuild_sizes=*/0, periodic);
+}
+
+/**
+ * @brief Initialise an empty #mac_cache.
+ *
+ * The slots are allocated at the first call to mac_cache_reset().
+ *
+ * @param cache The #mac_cache.
+ * @param tolerance The fractional growth of the multipoles over which
+ * decisions are valid.
+ * @param entries_per_cell The number of slots to reserve for each cell of
+ * the tree.
+ */
+void mac_cache_init(struct mac_cache *cache, const float tolerance,
+                    const float entries_per_cell) {
+
+  cache->entries = NULL;
+  cache->size = 0;
+  cache->tolerance = tolerance;
+  cache->entries_per_cell = entries_per_cell;
+  cache->uncached = 0;
+}
+
+/**
+ * @brief Sum the counters of all the slots of a #mac_cache.
+ *
+ * @param cache The #mac_cache.
+ * @param hits (return) The number of decisions re-used.
+ * @param misses (return) The number of decisions for new pairs.
+ * @param invalidations (return) The number of decisions re-computed as the
+ * cached one was out of its validity range.
+ * @param evictions (return) The number of decisions replaced by the one of
+ * another pair.
+ */
+void mac_cache_get_counters(const struct mac_cache *cache, long long *hits,
+                            long long *misses, long long *invalidations,
+                            long long *evictions) {
+
+  *hits = 0;
+  *misses = cache->uncached;
+  *invalidations = 0;
+  *evictions = 0;
+  for (size_t k = 0; k < cache->size; ++k) {
+    *hits += cache->entries[k].hits;
+    *misses += cache->entries[k].misses;
+    *invalidations += cache->entries[k].invalidations;
+    *evictions += cache->entries[k].evictions;
+  }
+}
+
+/**
+ * @brief Empty a #mac_cache after a tree rebuild, growing it if needed.
+ *
+ * @param cache The #mac_cache.
+ * @param nr_cells The number of cells in the new tree.
+ * @param verbose Are we talkative? If so, report the counters accumulated
+ * since the last reset.
+ */
+void mac_cache_reset(struct mac_cache *cache, const size_t nr_cells,
+                     const int verbose) {
+
+  if (verbose && cache->size > 0) {
+    long long hits, misses, invalidations, evictions;
+    mac_cache_get_counters(cache, &hits, &misses, &invalidations, &evictions);
+    const long long total = hits + misses + invalidations;
+    message(
+        "MAC cache: %lld hits, %lld misses (%lld not cached), %lld "
+        "invalidations, %lld evictions (hit rate: %.1f%%).",
+        hits, misses, cache->uncached, invalidations, evictions,
+        total > 0 ? 100. * hits / total : 0.);
+  }
+
+  /* Required number of slots */
+  size_t size = 1024;
+  while (size < nr_cells * cache->entries_per_cell) size *= 2;
+
+  for (size_t k = 0; k < cache->size; ++k)
+    if (lock_destroy(&cache->entries[k].lock) != 0)
+      error("Failed to destroy MAC cache slot");
+
+  if (size > cache->size) {
+    if (cache->entries != NULL) swift_free("mac_cache", cache->entries);
+    if (swift_memalign("mac_cache", (void **)&cache->entries,
+                       SWIFT_CACHE_ALIGNMENT,
+                       size * sizeof(struct mac_cache_entry)) != 0)
+      error("Failed to allocate the MAC cache.");
+    cache->size = size;
+  }
+
+  for (size_t k = 0; k < cache->size; ++k) {
+    struct mac_cache_entry *entry = &cache->entries[k];
+    bzero(entry, sizeof(struct mac_cache_entry));
+    entry->ti_used = -1;
+    if (lock_init(&entry->lock) != 0) error("Failed to init MAC cache slot");
+  }
+  cache->uncached = 0;
+}
+
+/**
+ * @brief Free the memory used by a #mac_cache.
+ *
+ * @param cache The #mac_cache.
+ */
+void mac_cache_clean(struct mac_cache *cache) {
+
+  for (size_t k = 0; k < cache->size; ++k)
+    if (lock_destroy(&cache->entries[k].lock) != 0)
+      error("Failed to destroy MAC cache slot");
+  if (cache->entries != NULL) swift_free("mac_cache", cache->entries);
+  cache->entries = NULL;
+  cache->size = 0;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MAC_CACHE_H
+#define SWIFT_MAC_CACHE_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Local headers. */
+#include "lock.h"
+#include "timeline.h"
+
+/* Standard headers. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Forward declarations */
+struct cell;
+struct gravity_props;
+
+/*! Number of consecutive slots searched for a given pair of cells */
+#define mac_cache_probe_length 8
+
+/**
+ * @brief The multipole acceptance criterion (MAC) decision for a pair of
+ * cells, together with the range of multipole sizes and distances over
+ * which it can be re-used.
+ */
+struct mac_cache_entry {
+
+  /*! The pair of cells (ci < cj), NULL if the slot is empty */
+  const struct cell *ci, *cj;
+
+  /*! Last step in which this decision was used */
+  integertime_t ti_used;
+
+  /*! Range of squared CoM distances over which the decision is valid */
+  float r2_min, r2_max;
+
+  /*! Maximal sizes of the multipoles for which the decision is valid */
+  float r_max_i, r_max_j;
+
+  /*! The decision itself */
+  int accept;
+
+  /*! Counters for this slot since the last reset */
+  int64_t hits, misses, invalidations, evictions;
+
+  /*! Lock protecting the slot */
+  swift_lock_type lock;
+};
+
+/**
+ * @brief Cache of the MAC decisions of the cell pairs visited by the gravity
+ * tree walk.
+ *
+ * The decisions are keyed on the pair of cells and re-used from one step to
+ * the next as long as the two multipoles have not grown, and their centres
+ * of mass not moved, by more than a fraction of their size. The cache is
+ * emptied whenever the tree is rebuilt.
+ *
+ * Decisions used in the current step are never evicted such that the
+ * activation of the tasks and the tree walk always agree.
+ */
+struct mac_cache {
+
+  /*! The slots (a power of two of them) */
+  struct mac_cache_entry *entries;
+
+  /*! Number of slots */
+  size_t size;
+
+  /*! Fractional growth of the multipoles over which decisions are valid */
+  float tolerance;
+
+  /*! Number of slots reserved for each cell of the tree */
+  float entries_per_cell;
+
+  /*! Number of decisions that could not be stored as all the candidate
+   * slots were in use */
+  long long uncached;
+};
+
+void mac_cache_init(struct mac_cache *cache, const float tolerance,
+                    const float entries_per_cell);
+void mac_cache_reset(struct mac_cache *cache, const size_t nr_cells,
+                     const int verbose);
+void mac_cache_clean(struct mac_cache *cache);
+void mac_cache_get_counters(const struct mac_cache *cache, long long *hits,
+                            long long *misses, long long *invalidations,
+                            long long *evictions);
+int mac_cache_can_use_pair_mm(struct mac_cache *cache,
+                              const struct gravity_props *props,
+                              const struct cell *ci, const struct cell *cj,
+                              const float r2, const int periodic,
+                              const integertime_t ti_current);
+
+#endif /* SWIFT_MAC_CACHE_H */
@@ -0,0 +1,255 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MESH_ASSIGNMENT_H
+#define SWIFT_MESH_ASSIGNMENT_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Local headers. */
+#include "inline.h"
+
+/* Standard headers */
+#include <math.h>
+
+/**
+ * @file mesh_assignment.h
+ * @brief Mass assignment windows of increasing order shared by the
+ * gravity mesh and the power spectrum calculation.
+ *
+ * The mesh nodes sit at integer positions in units of the mesh cell size.
+ * A window of order p spreads a particle over p nodes along each axis:
+ *
+ * - p = 1: Nearest grid point (NGP)
+ * - p = 2: Cloud in cell (CIC)
+ * - p = 3: Triangular shaped cloud (TSC)
+ * - p = 4: Piecewise cubic spline (PCS)
+ *
+ * The Fourier transform of the window of order p is sinc(k h / 2)^p along
+ * each axis.
+ */
+
+/*! Highest order of assignment window supported */
+#define MESH_ASSIGNMENT_MAX_ORDER 4
+
+/**
+ * @brief Returns the usual short name of an assignment window.
+ *
+ * @param order The order of the window.
+ */
+__attribute__((always_inline, const)) INLINE static const char*
+mesh_assignment_name(const int order) {
+
+  switch (order) {
+    case 1:
+      return "NGP";
+    case 2:
+      return "CIC";
+    case 3:
+      return "TSC";
+    case 4:
+      return "PCS";
+    default:
+      return "unknown";
+  }
+}
+
+/**
+ * @brief Computes the 1D weights of a window of a given order.
+ *
+ * @param order The order of the window (1 to #MESH_ASSIGNMENT_MAX_ORDER).
+ * @param x The position in units of the mesh cell size.
+ * @param w (return) The weights of the nodes [i, i + order[.
+ * @return The index i of the first node receiving a weight.
+ */
+__attribute__((always_inline)) INLINE static int mesh_assignment_weights(
+    const int order, const double x, double w[MESH_ASSIGNMENT_MAX_ORDER]) {
+
+  switch (order) {
+    case 1: {
+      const int i = (int)floor(x + 0.5);
+      w[0] = 1.;
+      return i;
+    }
+    case 2: {
+      const int i = (int)floor(x);
+      const double d = x - i;
+      w[0] = 1. - d;
+      w[1] = d;
+      return i;
+    }
+    case 3: {
+      /* Distance to the nearest node in [-0.5, 0.5[ */
+      const int i = (int)floor(x + 0.5);
+      const double d = x - i;
+      w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+      w[1] = 0.75 - d * d;
+      w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+      return i - 1;
+    }
+    case 4: {
+      /* Distance to the node on the left in [0, 1[ */
+      const int i = (int)floor(x);
+      const double d = x - i;
+      const double t = 1. - d;
+      w[0] = (1. / 6.) * t * t * t;
+      w[1] = (1. / 6.) * (4. - 6. * d * d + 3. * d * d * d);
+      w[2] = (1. / 6.) * (4. - 6. * t * t + 3. * t * t * t);
+      w[3] = (1. / 6.) * d * d * d;
+      return i - 1;
+    }
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Interpolates a value from a (part of a) mesh using a window of a
+ * given order.
+ *
+ * @param mesh Pointer to the first node of the window.
+ * @param stride_i The distance between two nodes along x.
+ * @param stride_j The distance between two nodes along y.
+ * @param order The order of the window.
+ * @param wx The weights along x.
+ * @param wy The weights along y.
+ * @param wz The weights along z.
+ */
+__attribute__((always_inline)) INLINE static double mesh_assignment_get(
+    const double* mesh, const int stride_i, const int stride_j,
+    const int order, const double wx[MESH_ASSIGNMENT_MAX_ORDER],
+    const double wy[MESH_ASSIGNMENT_MAX_ORDER],
+    const double wz[MESH_ASSIGNMENT_MAX_ORDER]) {
+
+  double temp = 0.;
+  for (int a = 0; a < order; ++a) {
+    for (int b = 0; b < order; ++b) {
+      const double* row = mesh + a * stride_i + b * stride_j;
+      const double wxy = wx[a] * wy[b];
+      for (int c = 0; c < order; ++c) temp += row[c] * wxy * wz[c];
+    }
+  }
+  return temp;
+}
+
+/**
+ * @brief Assigns a value to a (part of a) mesh using a window of a given
+ * order.
+ *
+ * The mesh is written to without any atomic operations.
+ *
+ * @param mesh Pointer to the first node of the window.
+ * @param stride_i The distance between two nodes along x.
+ * @param stride_j The distance between two nodes along y.
+ * @param order The order of the window.
+ * @param wx The weights along x.
+ * @param wy The weights along y.
+ * @param wz The weights along z.
+ * @param value The value to assign.
+ */
+__attribute__((always_inline)) INLINE static void mesh_assignment_set(
+    double* mesh, const int stride_i, const int stride_j, const int order,
+    const double wx[MESH_ASSIGNMENT_MAX_ORDER],
+    const double wy[MESH_ASSIGNMENT_MAX_ORDER],
+    const double wz[MESH_ASSIGNMENT_MAX_ORDER], const double value) {
+
+  for (int a = 0; a < order; ++a) {
+    for (int b = 0; b < order; ++b) {
+      double* row = mesh + a * stride_i + b * stride_j;
+      const double wxy = value * wx[a] * wy[b];
+      for (int c = 0; c < order; ++c) row[c] += wxy * wz[c];
+    }
+  }
+}
+
+/**
+ * @brief Interpolates the potential and its gradient from a (part of a) mesh
+ * using a window of a given order and a 5-point stencil.
+ *
+ * The mesh must extend 2 nodes beyond the window in every direction.
+ *
+ * @param mesh Pointer to the first node of the window.
+ * @param stride_i The distance between two nodes along x.
+ * @param stride_j The distance between two nodes along y.
+ * @param order The order of the window.
+ * @param wx The weights along x.
+ * @param wy The weights along y.
+ * @param wz The weights along z.
+ * @param p (return) The potential.
+ * @param a (return) The gradient of the potential times minus the mesh cell
+ * size.
+ */
+__attribute__((always_inline)) INLINE static void mesh_assignment_get_stencil(
+    const double* mesh, const int stride_i, const int stride_j,
+    const int order, const double wx[MESH_ASSIGNMENT_MAX_ORDER],
+    const double wy[MESH_ASSIGNMENT_MAX_ORDER],
+    const double wz[MESH_ASSIGNMENT_MAX_ORDER], double* p, double a[3]) {
+
+  const int si = stride_i, sj = stride_j;
+
+  *p = mesh_assignment_get(mesh, si, sj, order, wx, wy, wz);
+
+  a[0] = (1. / 12.) * mesh_assignment_get(mesh + 2 * si, si, sj, order, wx,
+                                          wy, wz);
+  a[0] -= (2. / 3.) * mesh_assignment_get(mesh + si, si, sj, order, wx, wy,
+                                          wz);
+  a[0] += (2. / 3.) * mesh_assignment_get(mesh - si, si, sj, order, wx, wy,
+                                          wz);
+  a[0] -= (1. / 12.) * mesh_assignment_get(mesh - 2 * si, si, sj, order, wx,
+                                           wy, wz);
+
+  a[1] = (1. / 12.) * mesh_assignment_get(mesh + 2 * sj, si, sj, order, wx,
+                                          wy, wz);
+  a[1] -= (2. / 3.) * mesh_assignment_get(mesh + sj, si, sj, order, wx, wy,
+                                          wz);
+  a[1] += (2. / 3.) * mesh_assignment_get(mesh - sj, si, sj, order, wx, wy,
+                                          wz);
+  a[1] -= (1. / 12.) * mesh_assignment_get(mesh - 2 * sj, si, sj, order, wx,
+                                           wy, wz);
+
+  a[2] = (1. / 12.) * mesh_assignment_get(mesh + 2, si, sj, order, wx, wy, wz);
+  a[2] -= (2. / 3.) * mesh_assignment_get(mesh + 1, si, sj, order, wx, wy, wz);
+  a[2] += (2. / 3.) * mesh_assignment_get(mesh - 1, si, sj, order, wx, wy, wz);
+  a[2] -= (1. / 12.) * mesh_assignment_get(mesh - 2, si, sj, order, wx, wy, wz);
+}
+
+/**
+ * @brief Computes the phase factor re-aligning the Fourier modes of a mesh
+ * assigned with all the particles shifted by half a mesh cell along each axis.
+ *
+ * Averaging the modes of the normal and shifted (interlaced) meshes cancels
+ * the leading (odd) aliased images of the assignment window.
+ *
+ * @param kx The integer wavenumber along x.
+ * @param ky The integer wavenumber along y.
+ * @param kz The integer wavenumber along z.
+ * @param N The side-length of the mesh.
+ * @param re (return) The real part of the phase factor.
+ * @param im (return) The imaginary part of the phase factor.
+ */
+__attribute__((always_inline)) INLINE static void mesh_interlacing_phase(
+    const int kx, const int ky, const int kz, const int N, double* re,
+    double* im) {
+
+  const double phase = M_PI * (double)(kx + ky + kz) / (double)N;
+  *re = cos(phase);
+  *im = sin(phase);
+}
+
+#endif /* SWIFT_MESH_ASSIGNMENT_H */
@@ -36,9 +36,12 @@
 #include "engine.h"
 #include "error.h"
 #include "gravity_properties.h"
+#include "integer_power.h"
 #include "kernel_long_gravity.h"
+#include "mesh_assignment.h"
 #include "mesh_gravity_mpi.h"
 #include "mesh_gravity_patch.h"
+#include "mesh_gravity_pencil.h"
 #include "neutrino.h"
 #include "part.h"
 #include "restart.h"
@@ -206,6 +209,90 @@ void cell_gpart_to_mesh_CIC(const struct cell* c, double* rho, const int N,
   }
 }
 
+/**
+ * @brief Assigns a given #gpart to a density mesh using a window of arbitrary
+ * order, optionally shifting the particle by a fraction of a mesh cell.
+ *
+ * @param gp The #gpart.
+ * @param rho The density mesh.
+ * @param N the size of the mesh along one axis.
+ * @param fac The width of a mesh cell.
+ * @param dim The dimensions of the simulation box.
+ * @param order The order of the assignment window.
+ * @param shift The shift to apply in units of the mesh cell size.
+ * @param nu_model Struct with neutrino constants
+ */
+INLINE static void gpart_to_mesh_window(const struct gpart* gp, double* rho,
+                                        const int N, const double fac,
+                                        const double dim[3], const int order,
+                                        const double shift,
+                                        const struct neutrino_model* nu_model) {
+
+  /* Box wrap the multipole's position */
+  const double pos_x = box_wrap(gp->x[0], 0., dim[0]);
+  const double pos_y = box_wrap(gp->x[1], 0., dim[1]);
+  const double pos_z = box_wrap(gp->x[2], 0., dim[2]);
+
+  /* Workout the window weights */
+  double wx[MESH_ASSIGNMENT_MAX_ORDER], wy[MESH_ASSIGNMENT_MAX_ORDER],
+      wz[MESH_ASSIGNMENT_MAX_ORDER];
+  const int i = mesh_assignment_weights(order, fac * pos_x + shift, wx);
+  const int j = mesh_assignment_weights(order, fac * pos_y + shift, wy);
+  const int k = mesh_assignment_weights(order, fac * pos_z + shift, wz);
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (gp->time_bin == time_bin_not_created)
+    error("Found an extra particle in mesh assignment.");
+#endif
+
+  /* Compute weight (for neutrino delta-f weighting) */
+  double weight = 1.0;
+  if (gp->type == swift_type_neutrino)
+    gpart_neutrino_weight_mesh_only(gp, nu_model, &weight);
+
+  const double value = gp->mass * weight;
+
+  /* Spread the mass over the order^3 nodes of the window */
+  for (int a = 0; a < order; ++a) {
+    for (int b = 0; b < order; ++b) {
+      const double wxy = value * wx[a] * wy[b];
+      for (int c = 0; c < order; ++c) {
+        atomic_add_d(&rho[row_major_id_periodic(i + a, j + b, k + c, N)],
+                     wxy * wz[c]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Assigns all the #gpart of a #cell to a density mesh using a window of
+ * arbitrary order.
+ *
+ * @param c The #cell.
+ * @param rho The density mesh.
+ * @param N the size of the mesh along one axis.
+ * @param fac The width of a mesh cell.
+ * @param dim The dimensions of the simulation box.
+ * @param order The order of the assignment window.
+ * @param shift The shift to apply in units of the mesh cell size.
+ * @param nu_model Struct with neutrino constants
+ */
+void cell_gpart_to_mesh_window(const struct cell* c, double* rho, const int N,
+                               const double fac, const double dim[3],
+                               const int order, const double shift,
+                               const struct neutrino_model* nu_model) {
+
+  const int gcount = c->grav.count;
+  const struct gpart* gparts = c->grav.parts;
+
+  /* Assign all the gpart of that cell to the mesh */
+  for (int i = 0; i < gcount; ++i) {
+    if (gparts[i].time_bin == time_bin_inhibited) continue;
+    gpart_to_mesh_window(&gparts[i], rho, N, fac, dim, order, shift,
+                         nu_model);
+  }
+}
+
 /**
  * @brief Shared information about the mesh to be used by all the threads in the
  * pool.
@@ -214,12 +301,18 @@ struct cic_mapper_data {
   const struct cell* cells;
   double* rho;
   double* potential;
+  double* potential_shift;
   int N;
-  int use_local_patches;
   double fac;
   double dim[3];
   float const_G;
   struct neutrino_model* nu_model;
+
+  /*! Order of the assignment window (2 for CIC) */
+  int order;
+
+  /*! Shift of the particles in units of the mesh cell size */
+  double shift;
 };
 
 void gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
@@ -230,19 +323,28 @@ void gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const struct neutrino_model* nu_model = data->nu_model;
+  const int order = data->order;
+  const double shift = data->shift;
+  const int use_CIC = (order == 2 && shift == 0.);
 
   /* Pointer to the chunk to be processed */
   const struct gpart* gparts = (const struct gpart*)map_data;
 
   for (int i = 0; i < num; ++i) {
     if (gparts[i].time_bin == time_bin_inhibited) continue;
-    gpart_to_mesh_CIC(&gparts[i], rho, N, fac, dim, nu_model);
+    if (use_CIC)
+      gpart_to_mesh_CIC(&gparts[i], rho, N, fac, dim, nu_model);
+    else
+      gpart_to_mesh_window(&gparts[i], rho, N, fac, dim, order, shift,
+                           nu_model);
   }
 }
 
 /**
  * @brief Threadpool mapper function for the mesh CIC assignment of a cell.
  *
+ * The particles are directly and atomically assigned to the global mesh.
+ *
  * @param map_data A chunk of the list of local cells.
  * @param num The number of cells in the chunk.
  * @param extra The information about the mesh and cells.
@@ -257,13 +359,13 @@ void cell_gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const struct neutrino_model* nu_model = data->nu_model;
+  const int order = data->order;
+  const double shift = data->shift;
+  const int use_CIC = (order == 2 && shift == 0.);
 
   /* Pointer to the chunk to be processed */
   int* local_cells = (int*)map_data;
 
-  /* A temporary patch of the global mesh */
-  struct pm_mesh_patch patch;
-
   /* Loop over the elements assigned to this thread */
   for (int i = 0; i < num; ++i) {
 
@@ -273,23 +375,11 @@ void cell_gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
     /* Skip empty cells */
     if (c->grav.count == 0) continue;
 
-    if (data->use_local_patches) {
-
-      /* Do a CIC interpolation of all the particles in this cell onto
-         the local patch (allocates memory in the patch) */
-      accumulate_cell_to_local_patch(N, fac, dim, c, &patch, nu_model);
-
-      /* Copy the local patch values back onto the global mesh */
-      pm_add_patch_to_global_mesh(rho, &patch);
-
-      /* Free the allocated memory */
-      pm_mesh_patch_clean(&patch);
-
-    } else {
-
-      /* Assign this cell's content directly atomically to the mesh */
+    /* Assign this cell's content directly atomically to the mesh */
+    if (use_CIC)
       cell_gpart_to_mesh_CIC(c, rho, N, fac, dim, nu_model);
-    }
+    else
+      cell_gpart_to_mesh_window(c, rho, N, fac, dim, order, shift, nu_model);
   }
 }
 
@@ -393,9 +483,117 @@ void mesh_to_gpart_CIC(struct gpart* gp, const double* pot, const int N,
   gravity_add_comoving_mesh_potential(gp, p);
 }
 
+/**
+ * @brief Interpolates the potential and its gradient at a given position
+ * from a mesh using a window of arbitrary order.
+ *
+ * @param pot The potential mesh.
+ * @param N the size of the mesh along one axis.
+ * @param fac width of a mesh cell.
+ * @param pos The (box-wrapped) position.
+ * @param order The order of the interpolation window.
+ * @param shift The shift of the mesh nodes in units of the mesh cell size.
+ * @param p (return) The potential.
+ * @param a (return) The acceleration.
+ */
+INLINE static void mesh_window_interpolate(const double* pot, const int N,
+                                           const double fac,
+                                           const double pos[3],
+                                           const int order, const double shift,
+                                           double* p, double a[3]) {
+
+  /* Workout the window weights */
+  double wx[MESH_ASSIGNMENT_MAX_ORDER], wy[MESH_ASSIGNMENT_MAX_ORDER],
+      wz[MESH_ASSIGNMENT_MAX_ORDER];
+  const int i = mesh_assignment_weights(order, fac * pos[0] + shift, wx);
+  const int j = mesh_assignment_weights(order, fac * pos[1] + shift, wy);
+  const int k = mesh_assignment_weights(order, fac * pos[2] + shift, wz);
+
+  /* First, copy the necessary part of the mesh for stencil operations */
+  /* This includes box-wrapping in all 3 dimensions. */
+  const int size = order + 4;
+  double phi[MESH_ASSIGNMENT_MAX_ORDER + 4][MESH_ASSIGNMENT_MAX_ORDER + 4]
+            [MESH_ASSIGNMENT_MAX_ORDER + 4];
+  for (int iii = 0; iii < size; ++iii) {
+    for (int jjj = 0; jjj < size; ++jjj) {
+      for (int kkk = 0; kkk < size; ++kkk) {
+        phi[iii][jjj][kkk] = pot[row_major_id_periodic(
+            i + iii - 2, j + jjj - 2, k + kkk - 2, N)];
+      }
+    }
+  }
+
+  /* Window interpolation of the potential and 5-point stencil along each
+   * axis for the accelerations */
+  const int stride_j = MESH_ASSIGNMENT_MAX_ORDER + 4;
+  const int stride_i = stride_j * stride_j;
+  mesh_assignment_get_stencil(&phi[2][2][2], stride_i, stride_j, order, wx, wy,
+                              wz, p, a);
+}
+
+/**
+ * @brief Computes the potential on a gpart from a given mesh using a window
+ * of arbitrary order.
+ *
+ * When interlacing, the forces interpolated from the normal mesh and from the
+ * mesh whose nodes are shifted by half a cell are averaged.
+ *
+ * @param gp The #gpart.
+ * @param pot The potential mesh.
+ * @param pot_shift The shifted potential mesh (NULL if not interlacing).
+ * @param N the size of the mesh along one axis.
+ * @param fac width of a mesh cell.
+ * @param dim The dimensions of the simulation box.
+ * @param order The order of the interpolation window.
+ */
+void mesh_to_gpart_window(struct gpart* gp, const double* pot,
+                          const double* pot_shift, const int N,
+                          const double fac, const double dim[3],
+                          const int order) {
+
+  /* Box wrap the gpart's position */
+  const double pos[3] = {box_wrap(gp->x[0], 0., dim[0]),
+                         box_wrap(gp->x[1], 0., dim[1]),
+                         box_wrap(gp->x[2], 0., dim[2])};
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (gp->time_bin == time_bin_not_created)
+    error("Found an extra particle when computing gravity from mesh.");
+#endif
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  if (gp->a_grav_mesh[0] != 0.) error("Particle with non-initalised stuff");
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+  if (gp->potential_mesh != 0.) error("Particle with non-initalised stuff");
+#endif
+#endif
+
+  double p = 0.;
+  double a[3] = {0.};
+  mesh_window_interpolate(pot, N, fac, pos, order, /*shift=*/0., &p, a);
+
+  if (pot_shift != NULL) {
+    double p_shift = 0.;
+    double a_shift[3] = {0.};
+    mesh_window_interpolate(pot_shift, N, fac, pos, order, /*shift=*/0.5,
+                            &p_shift, a_shift);
+    p = 0.5 * (p + p_shift);
+    a[0] = 0.5 * (a[0] + a_shift[0]);
+    a[1] = 0.5 * (a[1] + a_shift[1]);
+    a[2] = 0.5 * (a[2] + a_shift[2]);
+  }
+
+  /* Store things back */
+  gp->a_grav_mesh[0] = fac * a[0];
+  gp->a_grav_mesh[1] = fac * a[1];
+  gp->a_grav_mesh[2] = fac * a[2];
+  gravity_add_comoving_mesh_potential(gp, p);
+}
+
 void cell_mesh_to_gpart_CIC(const struct cell* c, const double* potential,
-                            const int N, const double fac, const float const_G,
-                            const double dim[3]) {
+                            const double* potential_shift, const int N,
+                            const double fac, const float const_G,
+                            const double dim[3], const int order) {
 
   const int gcount = c->grav.count;
   struct gpart* gparts = c->grav.parts;
@@ -414,7 +612,11 @@ void cell_mesh_to_gpart_CIC(const struct cell* c, const double* potential,
     gp->potential_mesh = 0.f;
 #endif
 
-    mesh_to_gpart_CIC(gp, potential, N, fac, dim);
+    if (order == 2 && potential_shift == NULL)
+      mesh_to_gpart_CIC(gp, potential, N, fac, dim);
+    else
+      mesh_to_gpart_window(gp, potential, potential_shift, N, fac, dim,
+                           order);
 
     gp->a_grav_mesh[0] *= const_G;
     gp->a_grav_mesh[1] *= const_G;
@@ -430,10 +632,12 @@ void mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
   /* Unpack the shared information */
   const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
   const double* const potential = data->potential;
+  const double* const potential_shift = data->potential_shift;
   const int N = data->N;
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const float const_G = data->const_G;
+  const int order = data->order;
 
   /* Pointer to the chunk to be processed */
   struct gpart* gparts = (struct gpart*)map_data;
@@ -451,7 +655,11 @@ void mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
     gp->potential_mesh = 0.f;
 #endif
 
-    mesh_to_gpart_CIC(gp, potential, N, fac, dim);
+    if (order == 2 && potential_shift == NULL)
+      mesh_to_gpart_CIC(gp, potential, N, fac, dim);
+    else
+      mesh_to_gpart_window(gp, potential, potential_shift, N, fac, dim,
+                           order);
 
     gp->a_grav_mesh[0] *= const_G;
     gp->a_grav_mesh[1] *= const_G;
@@ -475,10 +683,12 @@ void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
   const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
   const struct cell* cells = data->cells;
   const double* const potential = data->potential;
+  const double* const potential_shift = data->potential_shift;
   const int N = data->N;
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const float const_G = data->const_G;
+  const int order = data->order;
 
   /* Pointer to the chunk to be processed */
   int* local_cells = (int*)map_data;
@@ -490,7 +700,60 @@ void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
     const struct cell* c = &cells[local_cells[i]];
 
     /* Assign this cell's content to the mesh */
-    cell_mesh_to_gpart_CIC(c, potential, N, fac, const_G, dim);
+    cell_mesh_to_gpart_CIC(c, potential, potential_shift, N, fac, const_G, dim,
+                           order);
+  }
+}
+
+/**
+ * @brief Threadpool mapper function for the mesh CIC interpolation of a cell
+ * using a local patch.
+ *
+ * The part of the global potential mesh covering each cell (and the
+ * interpolation stencil) is first copied to a small patch such that all the
+ * subsequent reads by the particles happen in cache.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The information about the mesh and cells.
+ */
+void cell_mesh_to_gpart_CIC_patch_mapper(void* map_data, int num,
+                                         void* extra) {
+
+  /* Unpack the shared information */
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const struct cell* cells = data->cells;
+  const double* const potential = data->potential;
+  const int N = data->N;
+  const double fac = data->fac;
+  const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
+  const float const_G = data->const_G;
+  const int order = data->order;
+
+  /* Pointer to the chunk to be processed */
+  int* local_cells = (int*)map_data;
+
+  /* A temporary patch of the global mesh */
+  struct pm_mesh_patch patch;
+
+  /* Loop over the elements assigned to this thread */
+  for (int i = 0; i < num; ++i) {
+
+    /* Pointer to local cell */
+    const struct cell* c = &cells[local_cells[i]];
+
+    /* Skip empty cells */
+    if (c->grav.count == 0) continue;
+
+    /* Copy the potential around this cell to the patch */
+    pm_mesh_patch_init_stencil(&patch, c, N, fac, dim, order);
+    pm_mesh_patch_fill_from_global_mesh(&patch, potential);
+
+    /* Interpolate from the patch to the particles */
+    cell_mesh_patch_to_gpart(c, &patch, N, fac, const_G, dim, order);
+
+    /* Free the allocated memory */
+    pm_mesh_patch_clean(&patch);
   }
 }
 
@@ -507,6 +770,12 @@ struct Green_function_data {
   double k_fac;
   int slice_offset;
   int slice_width;
+  int assignment_order;
+
+  /* Fourier-space block of a pencil decomposition */
+  int ky_start;
+  int nky;
+  int kz_start;
 };
 
 /**
@@ -531,6 +800,10 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
   const double a_smooth2 = data->a_smooth2;
   const double k_fac = data->k_fac;
 
+  /* The window is deconvolved once for the assignment and once for the
+   * interpolation */
+  const unsigned int window_power = 2 * data->assignment_order;
+
   /* Find what slice of the full mesh is stored on this MPI rank */
   const int slice_offset = data->slice_offset;
 
@@ -574,13 +847,12 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
         fourier_kernel_long_grav_eval(k2 * a_smooth2, &W);
         const double green_cor = green_fac * W / (k2 + FLT_MIN);
 
-        /* Deconvolution of CIC */
-        const double CIC_cor = sinc_kx_inv * sinc_ky_inv * sinc_kz_inv;
-        const double CIC_cor2 = CIC_cor * CIC_cor;
-        const double CIC_cor4 = CIC_cor2 * CIC_cor2;
+        /* Deconvolution of the assignment window (CIC, TSC or PCS) */
+        const double window_cor =
+            integer_pow(sinc_kx_inv * sinc_ky_inv * sinc_kz_inv, window_power);
 
         /* Combined correction */
-        const double total_cor = green_cor * CIC_cor4;
+        const double total_cor = green_cor * window_cor;
 
         /* Apply to the mesh */
         const int index =
@@ -596,7 +868,7 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
  * @brief Apply the Green function in Fourier space to the density
  * array to get the potential.
  *
- * Also deconvolves the CIC kernel.
+ * Also deconvolves the mass assignment window.
  *
  * @param tp The threadpool.
  * @param frho The NxNx(N/2) complex array of the Fourier transform of the
@@ -607,11 +879,13 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
  * @param N The dimension of the array.
  * @param r_s The Green function smoothing scale.
  * @param box_size The physical size of the simulation box.
+ * @param assignment_order The order of the mass assignment window.
  */
 void mesh_apply_Green_function(struct threadpool* tp, fftw_complex* frho,
                                const int slice_offset, const int slice_width,
                                const int N, const double r_s,
-                               const double box_size) {
+                               const double box_size,
+                               const int assignment_order) {
 
   /* Some common factors */
   struct Green_function_data data;
@@ -622,6 +896,7 @@ void mesh_apply_Green_function(struct threadpool* tp, fftw_complex* frho,
   data.k_fac = M_PI / (double)N;
   data.slice_offset = slice_offset;
   data.slice_width = slice_width;
+  data.assignment_order = assignment_order;
 
   /* Parallelize the Green function application using the threadpool
      to split the x-axis loop over the threads.
@@ -637,6 +912,226 @@ void mesh_apply_Green_function(struct threadpool* tp, fftw_complex* frho,
   }
 }
 
+/**
+ * @brief Mapper function for the application of the Green function to the
+ * Fourier-space pencils of a #pm_mesh_pencil decomposition.
+ *
+ * @param map_data The array of rows (fixed ky and kz) of the pencils.
+ * @param num The number of rows to iterate on.
+ * @param extra The properties of the Green function.
+ */
+void mesh_apply_Green_function_pencil_mapper(void* map_data, const int num,
+                                             void* extra) {
+
+  const struct Green_function_data* data = (struct Green_function_data*)extra;
+
+  /* Unpack the array */
+  fftw_complex* const frho = data->frho;
+  const int N = data->N;
+  const int N_half = N / 2;
+  const int nky = data->nky;
+
+  /* Unpack the Green function properties */
+  const double green_fac = data->green_fac;
+  const double a_smooth2 = data->a_smooth2;
+  const double k_fac = data->k_fac;
+  const unsigned int window_power = 2 * data->assignment_order;
+
+  /* Range of rows handled by this call */
+  const size_t row_start = ((fftw_complex*)map_data - frho) / N;
+  const size_t row_end = row_start + num;
+
+  for (size_t row = row_start; row < row_end; ++row) {
+
+    /* The rows are stored as [kz][ky] */
+    const int j = data->ky_start + (int)(row % nky);
+    const int k = data->kz_start + (int)(row / nky);
+
+    /* ky component of vector in Fourier space and 1/sinc(ky) */
+    const int ky = (j > N_half ? j - N : j);
+    const double ky_d = (double)ky;
+    const double fy = k_fac * ky_d;
+    const double sinc_ky_inv = (ky != 0) ? fy / sin(fy) : 1.;
+
+    /* kz component of vector in Fourier space and 1/sinc(kz) */
+    const int kz = (k > N_half ? k - N : k);
+    const double kz_d = (double)kz;
+    const double fz = k_fac * kz_d;
+    const double sinc_kz_inv = (kz != 0) ? fz / (sin(fz) + FLT_MIN) : 1.;
+
+    fftw_complex* const frho_row = frho + row * N;
+
+    for (int i = 0; i < N; ++i) {
+
+      /* kx component of vector in Fourier space and 1/sinc(kx) */
+      const int kx = (i > N_half ? i - N : i);
+      const double kx_d = (double)kx;
+      const double fx = k_fac * kx_d;
+      const double sinc_kx_inv = (kx != 0) ? fx / sin(fx) : 1.;
+
+      /* Norm of vector in Fourier space */
+      const double k2 = (kx_d * kx_d + ky_d * ky_d + kz_d * kz_d);
+
+      /* Correct singularity at (0,0,0) */
+      if (k2 == 0.) {
+        frho_row[i][0] = 0.;
+        frho_row[i][1] = 0.;
+        continue;
+      }
+
+      /* Green function */
+      double W = 1.;
+      fourier_kernel_long_grav_eval(k2 * a_smooth2, &W);
+      const double green_cor = green_fac * W / (k2 + FLT_MIN);
+
+      /* Deconvolution of the assignment window */
+      const double window_cor =
+          integer_pow(sinc_kx_inv * sinc_ky_inv * sinc_kz_inv, window_power);
+
+      /* Combined correction */
+      const double total_cor = green_cor * window_cor;
+
+      frho_row[i][0] *= total_cor;
+      frho_row[i][1] *= total_cor;
+    }
+  }
+}
+
+/**
+ * @brief Apply the Green function to a chunk of the Fourier-space pencils of
+ * a #pm_mesh_pencil decomposition.
+ *
+ * This is a #pm_mesh_pencil_kernel. The extra data is a
+ * #Green_function_data carrying the constants of the Green function.
+ *
+ * @param tp The threadpool.
+ * @param frho The modes stored as [kz][ky][kx].
+ * @param kz_start The first kz mode.
+ * @param nkz The number of kz modes.
+ * @param ky_start The first ky mode.
+ * @param nky The number of ky modes.
+ * @param N The dimension of the array.
+ * @param extra The #Green_function_data.
+ */
+void mesh_apply_Green_function_pencil(struct threadpool* tp, fftw_complex* frho,
+                                      const int kz_start, const int nkz,
+                                      const int ky_start, const int nky,
+                                      const int N, void* extra) {
+
+  struct Green_function_data data = *(struct Green_function_data*)extra;
+  data.frho = frho;
+  data.ky_start = ky_start;
+  data.nky = nky;
+  data.kz_start = kz_start;
+
+  /* Parallelize over the rows of N kx modes */
+  threadpool_map(tp, mesh_apply_Green_function_pencil_mapper, frho, nkz * nky,
+                 N * sizeof(fftw_complex), threadpool_auto_chunk_size, &data);
+}
+
+/**
+ * @brief Shared information about the two meshes combined by interlacing.
+ */
+struct interlacing_data {
+  int N;
+  fftw_complex* frho;
+  fftw_complex* frho_shift;
+};
+
+/**
+ * @brief Mapper function averaging the Fourier transform of the density with
+ * the one of the density assigned with all the particles shifted by half a
+ * mesh cell.
+ *
+ * @param map_data The array of the density field Fourier transform.
+ * @param num The number of elements to iterate on (along the x-axis).
+ * @param extra The #interlacing_data.
+ */
+void mesh_interlace_mapper(void* map_data, const int num, void* extra) {
+
+  const struct interlacing_data* data = (struct interlacing_data*)extra;
+  fftw_complex* const frho = data->frho;
+  const fftw_complex* const frho_shift = data->frho_shift;
+  const int N = data->N;
+  const int N_half = N / 2;
+
+  /* Range of x coordinates handled by this call */
+  const int i_start = (fftw_complex*)map_data - frho;
+  const int i_end = i_start + num;
+
+  for (int i = i_start; i < i_end; ++i) {
+
+    const int kx = (i > N_half ? i - N : i);
+
+    for (int j = 0; j < N; ++j) {
+
+      const int ky = (j > N_half ? j - N : j);
+
+      for (int k = 0; k < N_half + 1; ++k) {
+
+        /* Phase re-aligning the shifted mesh with the normal one */
+        double re, im;
+        mesh_interlacing_phase(kx, ky, k, N, &re, &im);
+
+        const int index = N * (N_half + 1) * i + (N_half + 1) * j + k;
+        const double a = frho_shift[index][0];
+        const double b = frho_shift[index][1];
+
+        frho[index][0] = 0.5 * (frho[index][0] + a * re - b * im);
+        frho[index][1] = 0.5 * (frho[index][1] + a * im + b * re);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Mapper function constructing the Fourier transform of the potential
+ * sampled on the mesh whose nodes are shifted by half a cell.
+ *
+ * This is the inverse operation of the re-alignment done in
+ * mesh_interlace_mapper().
+ *
+ * @param map_data The array of the potential Fourier transform.
+ * @param num The number of elements to iterate on (along the x-axis).
+ * @param extra The #interlacing_data.
+ */
+void mesh_shift_potential_mapper(void* map_data, const int num, void* extra) {
+
+  const struct interlacing_data* data = (struct interlacing_data*)extra;
+  const fftw_complex* const frho = data->frho;
+  fftw_complex* const frho_shift = data->frho_shift;
+  const int N = data->N;
+  const int N_half = N / 2;
+
+  /* Range of x coordinates handled by this call */
+  const int i_start = (fftw_complex*)map_data - frho;
+  const int i_end = i_start + num;
+
+  for (int i = i_start; i < i_end; ++i) {
+
+    const int kx = (i > N_half ? i - N : i);
+
+    for (int j = 0; j < N; ++j) {
+
+      const int ky = (j > N_half ? j - N : j);
+
+      for (int k = 0; k < N_half + 1; ++k) {
+
+        /* Complex conjugate of the re-alignment phase */
+        double re, im;
+        mesh_interlacing_phase(kx, ky, k, N, &re, &im);
+
+        const int index = N * (N_half + 1) * i + (N_half + 1) * j + k;
+        const double a = frho[index][0];
+        const double b = frho[index][1];
+
+        frho_shift[index][0] = a * re + b * im;
+        frho_shift[index][1] = b * re - a * im;
+      }
+    }
+  }
+}
+
 #endif
 
 /**
@@ -686,8 +1181,8 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
   memset(local_patches, 0, nr_local_cells * sizeof(struct pm_mesh_patch));
 
   /* Calculate contributions to density field on this MPI rank */
-  mpi_mesh_accumulate_gparts_to_local_patches(tp, N, cell_fac, s,
-                                              local_patches);
+  mesh_accumulate_gparts_to_local_patches(tp, N, cell_fac, s, local_patches,
+                                          /*order=*/2, /*shift=*/0.);
   if (verbose)
     message("Accumulating mass to local patches took %.3f %s.",
             clocks_from_ticks(getticks() - tic), clocks_getunit());
@@ -759,7 +1254,7 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
 
   /* Apply Green function to local slice of the MPI mesh */
   mesh_apply_Green_function(tp, frho_slice, local_0_start, local_n0, N, r_s,
-                            box_size);
+                            box_size, /*assignment_order=*/2);
   if (verbose)
     message("Applying Green function took %.3f %s.",
             clocks_from_ticks(getticks() - tic), clocks_getunit());
@@ -825,14 +1320,14 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
 }
 
 /**
- * @brief Compute the mesh forces and potential, including periodic correction.
+ * @brief Compute the mesh forces and potential, including periodic correction,
+ * using a pencil-distributed mesh.
  *
- * Interpolates the top-level multipoles on-to a mesh, move to Fourier space,
- * compute the potential including short-range correction and move back
- * to real space. We use CIC for the interpolation.
- *
- * This version stores the full N*N*N mesh on each MPI rank and uses the
- * non-MPI version of FFTW.
+ * Same as compute_potential_distributed() but the mesh is split over a 2D
+ * grid of ranks (see #pm_mesh_pencil) rather than in slabs, such that up to
+ * N * (N/2 + 1) ranks hold a part of it. The FFTs are done with batches of
+ * 1D transforms of the serial FFTW library and explicit transposes; the
+ * last transpose is overlapped with the application of the Green function.
  *
  * The particles mesh accelerations and potentials are also updated.
  *
@@ -841,49 +1336,176 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
  * @param tp The #threadpool object used for parallelisation.
  * @param verbose Are we talkative?
  */
-void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
-                              struct threadpool* tp, const int verbose) {
+void compute_potential_distributed_pencils(struct pm_mesh* mesh,
+                                           const struct space* s,
+                                           struct threadpool* tp,
+                                           const int verbose) {
 
-#ifdef HAVE_FFTW
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
 
   const double r_s = mesh->r_s;
   const double box_size = s->dim[0];
   const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
-  const int* local_cells = s->local_cells_top;
   const int nr_local_cells = s->nr_local_cells;
 
   if (r_s <= 0.) error("Invalid value of a_smooth");
   if (mesh->dim[0] != dim[0] || mesh->dim[1] != dim[1] ||
       mesh->dim[2] != dim[2])
     error("Domain size does not match the value stored in the space.");
+  if (s->e->neutrino_properties->use_linear_response)
+    error(
+        "The linear-response neutrinos are not supported with the "
+        "pencil-distributed mesh.");
 
   /* Some useful constants */
   const int N = mesh->N;
-  const int N_half = N / 2;
   const double cell_fac = N / box_size;
 
-  /* Use the memory allocated for the potential to temporarily store rho */
-  double* restrict rho = mesh->potential_global;
-  if (rho == NULL) error("Error allocating memory for density mesh");
+  ticks tic = getticks();
 
-  /* Allocates some memory for the mesh in Fourier space */
-  fftw_complex* restrict frho =
-      (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N * N * (N_half + 1));
-  if (frho == NULL)
-    error("Error allocating memory for transform of density mesh");
-  memuse_log_allocation("fftw_frho", frho, 1,
-                        sizeof(fftw_complex) * N * N * (N_half + 1));
+  /* Create an array of mesh patches. One per local top-level cell. */
+  struct pm_mesh_patch* local_patches = (struct pm_mesh_patch*)malloc(
+      nr_local_cells * sizeof(struct pm_mesh_patch));
+  if (local_patches == NULL)
+    error("Could not allocate array of local mesh patches!");
+  memset(local_patches, 0, nr_local_cells * sizeof(struct pm_mesh_patch));
 
-  /* Prepare the FFT library */
-  fftw_plan forward_plan = fftw_plan_dft_r2c_3d(
-      N, N, N, rho, frho, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
-  fftw_plan inverse_plan = fftw_plan_dft_c2r_3d(
-      N, N, N, frho, rho, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+  /* Calculate contributions to density field on this MPI rank */
+  mesh_accumulate_gparts_to_local_patches(tp, N, cell_fac, s, local_patches,
+                                          /*order=*/2, /*shift=*/0.);
+  if (verbose)
+    message("Accumulating mass to local patches took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
 
-  ticks tic = getticks();
+  tic = getticks();
+
+  /* Decide which pencils of the density field we store on this rank */
+  struct pm_mesh_pencil pencil;
+  pm_mesh_pencil_init(&pencil, N);
+  const size_t local_size = pm_mesh_pencil_local_size(&pencil);
+  if (verbose)
+    message("Pencil process grid %dx%d, local pencils %dx%dx%d.", pencil.P0,
+            pencil.P1, pencil.nx, pencil.ny, N);
+
+  double* rho_pencil =
+      (double*)fftw_malloc(max(local_size, (size_t)1) * sizeof(double));
+  if (rho_pencil == NULL) error("Error allocating memory for the mesh pencils.");
+  memset(rho_pencil, 0, local_size * sizeof(double));
+
+  /* Construct density field pencils from contributions stored in the local
+   * patches.
+   * Note: This cleans up the local_patches entries. */
+  mpi_mesh_local_patches_to_pencils(&pencil, local_patches, nr_local_cells,
+                                    rho_pencil, tp, verbose);
+  if (verbose)
+    message("Assembling mesh pencils took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Constants of the Green function */
+  struct Green_function_data data;
+  bzero(&data, sizeof(struct Green_function_data));
+  data.N = N;
+  data.green_fac = -1. / (M_PI * box_size);
+  data.a_smooth2 = 4. * M_PI * M_PI * r_s * r_s / (box_size * box_size);
+  data.k_fac = M_PI / (double)N;
+  data.assignment_order = 2;
+
+  /* Forward FFT, Green function and inverse FFT in one go */
+  pm_mesh_pencil_convolve(&pencil, rho_pencil, tp,
+                          mesh_apply_Green_function_pencil, &data,
+                          pm_mesh_pencil_nr_chunks, verbose);
+  if (verbose)
+    message("Pencil Fourier transforms and Green function took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Fetch the mesh entries we need on this rank from other ranks */
+  mpi_mesh_fetch_potential_pencils(&pencil, cell_fac, s, rho_pencil,
+                                   local_patches, tp, verbose);
+
+  if (verbose)
+    message("Fetching local potential took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  fftw_free(rho_pencil);
+  pm_mesh_pencil_clean(&pencil);
+
+  tic = getticks();
+
+  /* Compute accelerations and potentials for the gparts */
+  mpi_mesh_update_gparts(local_patches, s, tp, N, cell_fac);
+
+  /* Clean the local patches array */
+  for (int i = 0; i < nr_local_cells; ++i)
+    pm_mesh_patch_clean(&local_patches[i]);
+  free(local_patches);
+
+  if (verbose)
+    message("Computing mesh accelerations took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+#else
+  error("No MPI and FFTW libraries available. Cannot compute pencil mesh.");
+#endif
+}
+
+/**
+ * @brief Assign the mass of all the local #gpart to a global density mesh
+ * using the mesh's assignment window (CIC, TSC or PCS).
+ *
+ * When using local patches, each top-level cell is first deposited onto its
+ * own private patch and the patches are then reduced onto the global mesh in
+ * parallel over slabs. Otherwise, the particles are atomically added to the
+ * global mesh directly.
+ *
+ * @param mesh The #pm_mesh.
+ * @param s The #space containing the particles.
+ * @param tp The #threadpool object used for parallelisation.
+ * @param rho The N*N*N density mesh to fill.
+ * @param shift Shift applied to all the particles in units of the mesh cell
+ * size (0.5 for the interlaced mesh, 0 otherwise).
+ */
+void pm_mesh_gparts_to_density(const struct pm_mesh* mesh,
+                               const struct space* s, struct threadpool* tp,
+                               double* rho, const double shift) {
+
+#ifdef HAVE_FFTW
+
+  const int N = mesh->N;
+  const double cell_fac = mesh->cell_fac;
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const int* local_cells = s->local_cells_top;
+  const int nr_local_cells = s->nr_local_cells;
 
   /* Zero everything */
-  bzero(rho, N * N * N * sizeof(double));
+  bzero(rho, (size_t)N * N * N * sizeof(double));
+
+  if (nr_local_cells > 0 && mesh->use_local_patches) {
+
+    /* Create an array of mesh patches. One per local top-level cell. */
+    struct pm_mesh_patch* local_patches = (struct pm_mesh_patch*)malloc(
+        nr_local_cells * sizeof(struct pm_mesh_patch));
+    if (local_patches == NULL)
+      error("Could not allocate array of local mesh patches!");
+    memset(local_patches, 0, nr_local_cells * sizeof(struct pm_mesh_patch));
+
+    /* Deposit the particles of each cell onto its own patch */
+    mesh_accumulate_gparts_to_local_patches(tp, N, cell_fac, s, local_patches,
+                                            mesh->assignment_order, shift);
+
+    /* Reduce the patches onto the global mesh one slab at a time */
+    pm_mesh_patches_to_global_mesh(tp, local_patches, nr_local_cells, N, rho);
+
+    /* Clean the local patches array */
+    for (int i = 0; i < nr_local_cells; ++i)
+      pm_mesh_patch_clean(&local_patches[i]);
+    free(local_patches);
+
+    return;
+  }
 
   /* Gather some neutrino constants if using delta-f weighting on the mesh */
   struct neutrino_model nu_model;
@@ -896,14 +1518,16 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   data.cells = s->cells_top;
   data.rho = rho;
   data.potential = NULL;
+  data.potential_shift = NULL;
   data.N = N;
-  data.use_local_patches = mesh->use_local_patches;
   data.fac = cell_fac;
   data.dim[0] = dim[0];
   data.dim[1] = dim[1];
   data.dim[2] = dim[2];
   data.const_G = 0.f;
   data.nu_model = &nu_model;
+  data.order = mesh->assignment_order;
+  data.shift = shift;
 
   if (nr_local_cells == 0) {
 
@@ -913,15 +1537,111 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
                    sizeof(struct gpart), threadpool_auto_chunk_size,
                    (void*)&data);
 
-  } else { /* Normal case */
+  } else {
 
-    /* Do a parallel CIC mesh assignment of the gparts but only using
+    /* Do a parallel mesh assignment of the gparts but only using
      * the local top-level cells */
     threadpool_map(tp, cell_gpart_to_mesh_CIC_mapper, (void*)local_cells,
                    nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
                    (void*)&data);
   }
 
+#else
+  error("No FFTW library found. Cannot compute periodic long-range forces.");
+#endif
+}
+
+/**
+ * @brief Compute the mesh forces and potential, including periodic correction.
+ *
+ * Interpolates the top-level multipoles on-to a mesh, move to Fourier space,
+ * compute the potential including short-range correction and move back
+ * to real space. We use CIC, TSC or PCS for the interpolation, optionally
+ * interlaced with a mesh assigned with the particles shifted by half a cell.
+ *
+ * This version stores the full N*N*N mesh on each MPI rank and uses the
+ * non-MPI version of FFTW.
+ *
+ * The particles mesh accelerations and potentials are also updated.
+ *
+ * @param mesh The #pm_mesh used to store the potential.
+ * @param s The #space containing the particles.
+ * @param tp The #threadpool object used for parallelisation.
+ * @param verbose Are we talkative?
+ */
+void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
+                              struct threadpool* tp, const int verbose) {
+
+#ifdef HAVE_FFTW
+
+  const double r_s = mesh->r_s;
+  const double box_size = s->dim[0];
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const int* local_cells = s->local_cells_top;
+  const int nr_local_cells = s->nr_local_cells;
+
+  if (r_s <= 0.) error("Invalid value of a_smooth");
+  if (mesh->dim[0] != dim[0] || mesh->dim[1] != dim[1] ||
+      mesh->dim[2] != dim[2])
+    error("Domain size does not match the value stored in the space.");
+
+  /* Some useful constants */
+  const int N = mesh->N;
+  const int N_half = N / 2;
+  const double cell_fac = N / box_size;
+
+  /* Use the memory allocated for the potential to temporarily store rho */
+  double* restrict rho = mesh->potential_global;
+  if (rho == NULL) error("Error allocating memory for density mesh");
+
+  /* Allocates some memory for the mesh in Fourier space */
+  fftw_complex* restrict frho =
+      (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N * N * (N_half + 1));
+  if (frho == NULL)
+    error("Error allocating memory for transform of density mesh");
+  memuse_log_allocation("fftw_frho", frho, 1,
+                        sizeof(fftw_complex) * N * N * (N_half + 1));
+
+  /* Prepare the FFT library */
+  fftw_plan forward_plan = fftw_plan_dft_r2c_3d(
+      N, N, N, rho, frho, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+  fftw_plan inverse_plan = fftw_plan_dft_c2r_3d(
+      N, N, N, frho, rho, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+
+  /* When interlacing, we need a second density mesh (and its transform)
+   * with all the particles shifted by half a mesh cell. It is then re-used
+   * for the potential sampled at the shifted mesh nodes. */
+  double* restrict rho_shift = NULL;
+  fftw_complex* restrict frho_shift = NULL;
+  fftw_plan forward_plan_shift = NULL;
+  fftw_plan inverse_plan_shift = NULL;
+  struct interlacing_data interlacing_data;
+  if (mesh->interlacing) {
+    rho_shift = (double*)fftw_malloc(sizeof(double) * N * N * N);
+    frho_shift = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N * N *
+                                            (N_half + 1));
+    if (rho_shift == NULL || frho_shift == NULL)
+      error("Error allocating memory for the interlaced density mesh");
+    memuse_log_allocation("fftw_rho_shift", rho_shift, 1,
+                          sizeof(double) * N * N * N);
+    memuse_log_allocation("fftw_frho_shift", frho_shift, 1,
+                          sizeof(fftw_complex) * N * N * (N_half + 1));
+    forward_plan_shift = fftw_plan_dft_r2c_3d(
+        N, N, N, rho_shift, frho_shift, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+    inverse_plan_shift = fftw_plan_dft_c2r_3d(
+        N, N, N, frho_shift, rho_shift, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+    interlacing_data.N = N;
+    interlacing_data.frho = frho;
+    interlacing_data.frho_shift = frho_shift;
+  }
+
+  ticks tic = getticks();
+
+  /* Assign the mass of the local particles to the density mesh */
+  pm_mesh_gparts_to_density(mesh, s, tp, rho, /*shift=*/0.);
+  if (mesh->interlacing)
+    pm_mesh_gparts_to_density(mesh, s, tp, rho_shift, /*shift=*/0.5);
+
   if (verbose)
     message("Gpart assignment took %.3f %s.",
             clocks_from_ticks(getticks() - tic), clocks_getunit());
@@ -934,6 +1654,9 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   /* Merge everybody's share of the density mesh */
   MPI_Allreduce(MPI_IN_PLACE, rho, N * N * N, MPI_DOUBLE, MPI_SUM,
                 MPI_COMM_WORLD);
+  if (mesh->interlacing)
+    MPI_Allreduce(MPI_IN_PLACE, rho_shift, N * N * N, MPI_DOUBLE, MPI_SUM,
+                  MPI_COMM_WORLD);
 
   if (verbose)
     message("Mesh MPI-reduction took %.3f %s.",
@@ -955,11 +1678,26 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   /* frho now contains the Fourier transform of the density field */
   /* frho contains NxNx(N/2+1) complex numbers */
 
+  if (mesh->interlacing) {
+
+    tic = getticks();
+
+    /* Transform the shifted mesh and average it with the normal one */
+    fftw_execute(forward_plan_shift);
+    threadpool_map(tp, mesh_interlace_mapper, frho, N, sizeof(fftw_complex),
+                   threadpool_auto_chunk_size, &interlacing_data);
+
+    if (verbose)
+      message("Interlacing the density meshes took %.3f %s.",
+              clocks_from_ticks(getticks() - tic), clocks_getunit());
+  }
+
   tic = getticks();
 
-  /* Now de-convolve the CIC kernel and apply the Green function */
+  /* Now de-convolve the assignment window and apply the Green function */
   mesh_apply_Green_function(tp, frho, /*slice_offset=*/0, /*slice_width=*/N,
-                            /* mesh_size=*/N, r_s, box_size);
+                            /* mesh_size=*/N, r_s, box_size,
+                            mesh->assignment_order);
 
   if (verbose)
     message("Applying Green function took %.3f %s.",
@@ -979,6 +1717,14 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
     tic = getticks();
   }
 
+  /* Sample the potential at the shifted mesh nodes too */
+  if (mesh->interlacing) {
+    threadpool_map(tp, mesh_shift_potential_mapper, frho, N,
+                   sizeof(fftw_complex), threadpool_auto_chunk_size,
+                   &interlacing_data);
+    fftw_execute(inverse_plan_shift);
+  }
+
   /* Fourier transform to come back from magic-land */
   fftw_execute(inverse_plan);
 
@@ -998,15 +1744,20 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   tic = getticks();
 
   /* Gather the mesh shared information to be used by the threads */
+  struct cic_mapper_data data;
   data.cells = s->cells_top;
   data.rho = NULL;
   data.potential = mesh->potential_global;
+  data.potential_shift = rho_shift;
   data.N = N;
   data.fac = cell_fac;
   data.dim[0] = dim[0];
   data.dim[1] = dim[1];
   data.dim[2] = dim[2];
   data.const_G = s->e->physical_constants->const_newton_G;
+  data.nu_model = NULL;
+  data.order = mesh->assignment_order;
+  data.shift = 0.;
 
   if (nr_local_cells == 0) {
 
@@ -1016,6 +1767,14 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
                    sizeof(struct gpart), threadpool_auto_chunk_size,
                    (void*)&data);
 
+  } else if (mesh->use_local_patches && !mesh->interlacing) {
+
+    /* Do a parallel CIC mesh interpolation onto the gparts of the local
+       top-level cells, reading from a cache-resident copy of the mesh */
+    threadpool_map(tp, cell_mesh_to_gpart_CIC_patch_mapper,
+                   (void*)local_cells, nr_local_cells, sizeof(int),
+                   threadpool_auto_chunk_size, (void*)&data);
+
   } else { /* Normal case */
 
     /* Do a parallel CIC mesh interpolation onto the gparts but only using
@@ -1034,6 +1793,14 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   fftw_destroy_plan(inverse_plan);
   memuse_log_allocation("fftw_frho", frho, 0, 0);
   fftw_free(frho);
+  if (mesh->interlacing) {
+    fftw_destroy_plan(forward_plan_shift);
+    fftw_destroy_plan(inverse_plan_shift);
+    memuse_log_allocation("fftw_rho_shift", rho_shift, 0, 0);
+    memuse_log_allocation("fftw_frho_shift", frho_shift, 0, 0);
+    fftw_free(rho_shift);
+    fftw_free(frho_shift);
+  }
 
 #else
   error("No FFTW library found. Cannot compute periodic long-range forces.");
@@ -1057,7 +1824,9 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
  */
 void pm_mesh_compute_potential(struct pm_mesh* mesh, const struct space* s,
                                struct threadpool* tp, const int verbose) {
-  if (mesh->distributed_mesh) {
+  if (mesh->distributed_mesh && mesh->distributed_mesh_pencils) {
+    compute_potential_distributed_pencils(mesh, s, tp, verbose);
+  } else if (mesh->distributed_mesh) {
     compute_potential_distributed(mesh, s, tp, verbose);
   } else {
     compute_potential_global(mesh, s, tp, verbose);
@@ -1154,7 +1923,10 @@ void pm_mesh_init(struct pm_mesh* mesh, const struct gravity_props* props,
   mesh->periodic = 1;
   mesh->N = N;
   mesh->distributed_mesh = props->distributed_mesh;
+  mesh->distributed_mesh_pencils = props->distributed_mesh_pencils;
   mesh->use_local_patches = props->mesh_uses_local_patches;
+  mesh->assignment_order = props->mesh_assignment_order;
+  mesh->interlacing = props->mesh_interlacing;
   mesh->dim[0] = dim[0];
   mesh->dim[1] = dim[1];
   mesh->dim[2] = dim[2];
@@ -50,10 +50,21 @@ struct pm_mesh {
   /*! Whether mesh is distributed between MPI ranks */
   int distributed_mesh;
 
+  /*! Whether the distributed mesh uses a pencil rather than a slab
+   * decomposition */
+  int distributed_mesh_pencils;
+
   /*! Whether or not to use local patches rather than
    * direct atomic writes to the mesh when running without MPI */
   int use_local_patches;
 
+  /*! Order of the mass assignment window (2: CIC, 3: TSC, 4: PCS) */
+  int assignment_order;
+
+  /*! Whether or not to use a second mesh shifted by half a cell to reduce
+   * the aliasing of the mass assignment */
+  int interlacing;
+
   /*! Integer time-step end of the mesh force for the last step */
   integertime_t ti_end_mesh_last;
 
@@ -93,6 +104,9 @@ void pm_mesh_init(struct pm_mesh *mesh, const struct gravity_props *props,
 void pm_mesh_init_no_mesh(struct pm_mesh *mesh, double dim[3]);
 void pm_mesh_compute_potential(struct pm_mesh *mesh, const struct space *s,
                                struct threadpool *tp, int verbose);
+void pm_mesh_gparts_to_density(const struct pm_mesh *mesh,
+                               const struct space *s, struct threadpool *tp,
+                               double *rho, const double shift);
 void pm_mesh_clean(struct pm_mesh *mesh);
 
 void pm_mesh_allocate(struct pm_mesh *mesh);
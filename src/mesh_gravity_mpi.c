@@ -35,7 +35,9 @@
 #include "error.h"
 #include "exchange_structs.h"
 #include "lock.h"
+#include "mesh_assignment.h"
 #include "mesh_gravity_patch.h"
+#include "mesh_gravity_pencil.h"
 #include "mesh_gravity_sort.h"
 #include "neutrino.h"
 #include "part.h"
@@ -57,61 +59,130 @@
  * @param cell The #cell containing the particles.
  * @param patch The local mesh patch
  * @param nu_model Struct with neutrino constants
+ * @param order The order of the assignment window (2 for CIC)
+ * @param shift The shift to apply to the particles in units of the mesh cell
+ * size (0.5 for the second mesh when interlacing, 0 otherwise)
  *
  */
 void accumulate_cell_to_local_patch(const int N, const double fac,
                                     const double *dim, const struct cell *cell,
                                     struct pm_mesh_patch *patch,
-                                    const struct neutrino_model *nu_model) {
+                                    const struct neutrino_model *nu_model,
+                                    const int order, const double shift) {
 
   /* If the cell is empty, then there's nothing to do
      (and the code to find the extent of the cell would fail) */
   if (cell->grav.count == 0) return;
 
+  /* Plain CIC only needs one extra element on each side. The wider windows
+   * (and the shift) need one more. */
+  const int use_CIC = (order == 2 && shift == 0.);
+  const int boundary_size = use_CIC ? 1 : 2;
+
   /* Initialise the local mesh patch */
-  pm_mesh_patch_init(patch, cell, N, fac, dim, /*boundary_size=*/1);
+  pm_mesh_patch_init(patch, cell, N, fac, dim, boundary_size);
   pm_mesh_patch_zero(patch);
 
-  /* Loop over particles in this cell */
-  for (int ipart = 0; ipart < cell->grav.count; ipart++) {
+  const int gcount = cell->grav.count;
+  const struct gpart *gparts = cell->grav.parts;
+
+  /* Local copies of the patch geometry */
+  const double wrap_min[3] = {patch->wrap_min[0], patch->wrap_min[1],
+                              patch->wrap_min[2]};
+  const double wrap_max[3] = {patch->wrap_max[0], patch->wrap_max[1],
+                              patch->wrap_max[2]};
+  const int mesh_min[3] = {patch->mesh_min[0], patch->mesh_min[1],
+                           patch->mesh_min[2]};
+
+  /* Temporary SoA buffers for one block of particles */
+  double pos_x[PM_MESH_PATCH_BLOCK_SIZE], pos_y[PM_MESH_PATCH_BLOCK_SIZE],
+      pos_z[PM_MESH_PATCH_BLOCK_SIZE], value[PM_MESH_PATCH_BLOCK_SIZE];
+  double dx[PM_MESH_PATCH_BLOCK_SIZE], dy[PM_MESH_PATCH_BLOCK_SIZE],
+      dz[PM_MESH_PATCH_BLOCK_SIZE];
+  int ii[PM_MESH_PATCH_BLOCK_SIZE], jj[PM_MESH_PATCH_BLOCK_SIZE],
+      kk[PM_MESH_PATCH_BLOCK_SIZE];
+
+  /* Loop over particles in this cell, one block at a time */
+  int ipart = 0;
+  while (ipart < gcount) {
+
+    /* Gather the next block of non-inhibited particles */
+    int count = 0;
+    for (; ipart < gcount && count < PM_MESH_PATCH_BLOCK_SIZE; ipart++) {
+
+      const struct gpart *gp = &gparts[ipart];
+
+      if (gp->time_bin == time_bin_inhibited) continue;
+
+      /* Compute weight (for neutrino delta-f weighting) */
+      double weight = 1.0;
+      if (gp->type == swift_type_neutrino)
+        gpart_neutrino_weight_mesh_only(gp, nu_model, &weight);
+
+      pos_x[count] = gp->x[0];
+      pos_y[count] = gp->x[1];
+      pos_z[count] = gp->x[2];
+      value[count] = gp->mass * weight;
+      count++;
+    }
+
+    /* Higher-order windows: assign the particles one by one */
+    if (!use_CIC) {
+
+      const int stride_i = patch->mesh_size[1] * patch->mesh_size[2];
+      const int stride_j = patch->mesh_size[2];
+
+      for (int n = 0; n < count; n++) {
 
-    const struct gpart *gp = &(cell->grav.parts[ipart]);
+        const double x =
+            fac * box_wrap(pos_x[n], wrap_min[0], wrap_max[0]) + shift;
+        const double y =
+            fac * box_wrap(pos_y[n], wrap_min[1], wrap_max[1]) + shift;
+        const double z =
+            fac * box_wrap(pos_z[n], wrap_min[2], wrap_max[2]) + shift;
 
-    /* Box wrap the particle's position to the copy nearest the cell centre */
-    const double pos_x =
-        box_wrap(gp->x[0], patch->wrap_min[0], patch->wrap_max[0]);
-    const double pos_y =
-        box_wrap(gp->x[1], patch->wrap_min[1], patch->wrap_max[1]);
-    const double pos_z =
-        box_wrap(gp->x[2], patch->wrap_min[2], patch->wrap_max[2]);
+        double wx[MESH_ASSIGNMENT_MAX_ORDER], wy[MESH_ASSIGNMENT_MAX_ORDER],
+            wz[MESH_ASSIGNMENT_MAX_ORDER];
+        const int i = mesh_assignment_weights(order, x, wx) - mesh_min[0];
+        const int j = mesh_assignment_weights(order, y, wy) - mesh_min[1];
+        const int k = mesh_assignment_weights(order, z, wz) - mesh_min[2];
 
-    /* Workout the CIC coefficients */
-    int i = (int)floor(fac * pos_x);
-    const double dx = fac * pos_x - i;
-    const double tx = 1. - dx;
+        mesh_assignment_set(patch->mesh + pm_mesh_patch_index(patch, i, j, k),
+                            stride_i, stride_j, order, wx, wy, wz, value[n]);
+      }
+      continue;
+    }
 
-    int j = (int)floor(fac * pos_y);
-    const double dy = fac * pos_y - j;
-    const double ty = 1. - dy;
+    /* Workout the CIC coefficients of the whole block.
+     * This loop has no dependencies and can be vectorized. */
+    for (int n = 0; n < count; n++) {
 
-    int k = (int)floor(fac * pos_z);
-    const double dz = fac * pos_z - k;
-    const double tz = 1. - dz;
+      /* Box wrap the particle's position to the copy nearest the cell centre
+       */
+      const double x = fac * box_wrap(pos_x[n], wrap_min[0], wrap_max[0]);
+      const double y = fac * box_wrap(pos_y[n], wrap_min[1], wrap_max[1]);
+      const double z = fac * box_wrap(pos_z[n], wrap_min[2], wrap_max[2]);
 
-    /* Get coordinates within the mesh patch */
-    const int ii = i - patch->mesh_min[0];
-    const int jj = j - patch->mesh_min[1];
-    const int kk = k - patch->mesh_min[2];
+      const double fx = floor(x);
+      const double fy = floor(y);
+      const double fz = floor(z);
 
-    /* Compute weight (for neutrino delta-f weighting) */
-    double weight = 1.0;
-    if (gp->type == swift_type_neutrino)
-      gpart_neutrino_weight_mesh_only(gp, nu_model, &weight);
+      dx[n] = x - fx;
+      dy[n] = y - fy;
+      dz[n] = z - fz;
+
+      /* Get coordinates within the mesh patch */
+      ii[n] = (int)fx - mesh_min[0];
+      jj[n] = (int)fy - mesh_min[1];
+      kk[n] = (int)fz - mesh_min[2];
+    }
 
     /* Accumulate contributions to the local mesh patch */
-    const double mass = gp->mass;
-    const double value = mass * weight;
-    pm_mesh_patch_CIC_set(patch, ii, jj, kk, tx, ty, tz, dx, dy, dz, value);
+    for (int n = 0; n < count; n++) {
+      pm_mesh_patch_CIC_set(patch, ii[n], jj[n], kk[n], 1. - dx[n],
+                            1. - dy[n], 1. - dz[n], dx[n], dy[n], dz[n],
+                            value[n]);
+    }
   }
 }
 
@@ -127,6 +198,8 @@ struct accumulate_mapper_data {
   double fac;
   double dim[3];
   struct neutrino_model *nu_model;
+  int order;
+  double shift;
 };
 
 /**
@@ -147,6 +220,8 @@ void accumulate_cell_to_local_patches_mapper(void *map_data, int num,
   const double fac = data->fac;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const struct neutrino_model *nu_model = data->nu_model;
+  const int order = data->order;
+  const double shift = data->shift;
 
   /* Pointer to the chunk to be processed */
   int *local_cells = (int *)map_data;
@@ -165,7 +240,8 @@ void accumulate_cell_to_local_patches_mapper(void *map_data, int num,
     if (c->grav.count == 0) continue;
 
     /* Assign this cell's content to the mesh */
-    accumulate_cell_to_local_patch(N, fac, dim, c, &local_patches[i], nu_model);
+    accumulate_cell_to_local_patch(N, fac, dim, c, &local_patches[i], nu_model,
+                                   order, shift);
   }
 }
 
@@ -180,13 +256,15 @@ void accumulate_cell_to_local_patches_mapper(void *map_data, int num,
  * @param fac Inverse of the cell size
  * @param s The #space containing the particles.
  * @param local_patches The array of *local* mesh patches.
+ * @param order The order of the assignment window (2 for CIC)
+ * @param shift The shift to apply to the particles in units of the mesh cell
+ * size
  *
  */
-void mpi_mesh_accumulate_gparts_to_local_patches(
+void mesh_accumulate_gparts_to_local_patches(
     struct threadpool *tp, const int N, const double fac, const struct space *s,
-    struct pm_mesh_patch *local_patches) {
+    struct pm_mesh_patch *local_patches, const int order, const double shift) {
 
-#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
   const int *local_cells = s->local_cells_top;
   const int nr_local_cells = s->nr_local_cells;
   const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
@@ -208,14 +286,11 @@ void mpi_mesh_accumulate_gparts_to_local_patches(
   data.dim[1] = dim[1];
   data.dim[2] = dim[2];
   data.nu_model = &nu_model;
+  data.order = order;
+  data.shift = shift;
   threadpool_map(tp, accumulate_cell_to_local_patches_mapper,
                  (void *)local_cells, nr_local_cells, sizeof(int),
                  threadpool_auto_chunk_size, (void *)&data);
-  if (lock_destroy(&lock) != 0) error("Impossible to destroy lock!");
-
-#else
-  error("FFTW MPI not found - unable to use distributed mesh");
-#endif
 }
 
 void mesh_patches_to_sorted_array(const struct pm_mesh_patch *local_patches,
@@ -655,29 +730,10 @@ void fill_local_patches_from_mesh_cells(
     /* Skip empty cells */
     if (cell->grav.count == 0) continue;
 
-    patch->N = N;
-    patch->fac = fac;
-
-    /* Will need to wrap particles to position nearest the cell centre */
-    for (int i = 0; i < 3; i++) {
-      patch->wrap_min[i] = cell->loc[i] + 0.5 * cell->width[i] - 0.5 * dim[i];
-      patch->wrap_max[i] = cell->loc[i] + 0.5 * cell->width[i] + 0.5 * dim[i];
-    }
-
-    int num_cells = 1;
-    for (int i = 0; i < 3; i++) {
-      const double xmin = cell->loc[i] - 2.01 / fac;
-      const double xmax = cell->loc[i] + cell->width[i] + 3.01 / fac;
-      patch->mesh_min[i] = (int)floor(xmin * fac);
-      patch->mesh_max[i] = (int)floor(xmax * fac);
-      patch->mesh_size[i] = patch->mesh_max[i] - patch->mesh_min[i] + 1;
-      num_cells *= patch->mesh_size[i];
-    }
-
-    /* Allocate the mesh */
-    if (swift_memalign("mesh_patch", (void **)&patch->mesh,
-                       SWIFT_CACHE_ALIGNMENT, num_cells * sizeof(double)) != 0)
-      error("Failed to allocate array for mesh patch!");
+    /* Allocate a patch covering the cell and the interpolation stencil */
+    pm_mesh_patch_init_stencil(patch, cell, N, fac, dim, /*order=*/2);
+    const int num_cells =
+        patch->mesh_size[0] * patch->mesh_size[1] * patch->mesh_size[2];
 
 #ifdef SWIFT_DEBUG_CHECKS
     int count = 0;
@@ -986,6 +1042,316 @@ void mpi_mesh_fetch_potential(const int N, const double fac,
 #endif
 }
 
+/**
+ * @brief Convert the array of local patches to a pencil-distributed 3D mesh
+ *
+ * Same as mpi_mesh_local_patches_to_slices() but for a #pm_mesh_pencil
+ * decomposition: the mesh cells are sorted by the rank holding their
+ * (x, y) pencil rather than by x-coordinate before being exchanged.
+ *
+ * This function will clean the memory allocated by each of the entry
+ * in the local_patches array.
+ *
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param local_patches The array of local patches.
+ * @param nr_patches The number of local patches.
+ * @param mesh Pointer to the output data buffer (the local pencils).
+ * @param tp The #threadpool object.
+ * @param verbose Are we talkative?
+ */
+void mpi_mesh_local_patches_to_pencils(const struct pm_mesh_pencil *pencil,
+                                       struct pm_mesh_patch *local_patches,
+                                       const int nr_patches, double *mesh,
+                                       struct threadpool *tp,
+                                       const int verbose) {
+
+#ifdef WITH_MPI
+
+  /* Determine number of ranks */
+  int nr_nodes;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+
+  const int N = pencil->N;
+
+  ticks tic = getticks();
+
+  /* Count the total number of mesh cells we have.
+   *
+   * Note: There might be duplicates. We don't care at this point. */
+  size_t count = 0;
+  for (int i = 0; i < nr_patches; ++i) {
+    const struct pm_mesh_patch *p = &local_patches[i];
+    count += p->mesh_size[0] * p->mesh_size[1] * p->mesh_size[2];
+  }
+
+  /* Create an array to contain all the individual mesh cells we have
+   * on this node. For now, this is in random order */
+  struct mesh_key_value_rho *mesh_sendbuf_unsorted;
+  if (swift_memalign("mesh_sendbuf_unsorted", (void **)&mesh_sendbuf_unsorted,
+                     SWIFT_CACHE_ALIGNMENT,
+                     count * sizeof(struct mesh_key_value_rho)) != 0)
+    error("Failed to allocate array for unsorted mesh send buffer!");
+
+  /* Make an array with the (key, value) pairs from the mesh patches. */
+  mesh_patches_to_sorted_array(local_patches, nr_patches, mesh_sendbuf_unsorted,
+                               count);
+
+  /* Clean the local patches array */
+  for (int i = 0; i < nr_patches; ++i) pm_mesh_patch_clean(&local_patches[i]);
+
+  if (verbose)
+    message(" - Converting mesh patches to array took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  struct mesh_key_value_rho *mesh_sendbuf;
+  if (swift_memalign("mesh_sendbuf", (void **)&mesh_sendbuf,
+                     SWIFT_CACHE_ALIGNMENT,
+                     count * sizeof(struct mesh_key_value_rho)) != 0)
+    error("Failed to allocate array for unsorted mesh send buffer!");
+
+  size_t *sorted_offsets = (size_t *)malloc(nr_nodes * sizeof(size_t));
+
+  /* Do a bucket sort of the mesh elements by destination rank */
+  bucket_sort_mesh_key_value_rho_pencil(mesh_sendbuf_unsorted, count, pencil,
+                                        nr_nodes, tp, mesh_sendbuf,
+                                        sorted_offsets);
+
+  swift_free("mesh_sendbuf_unsorted", mesh_sendbuf_unsorted);
+  mesh_sendbuf_unsorted = NULL;
+
+  /* The buckets are the ranks, so the counts follow from the offsets */
+  size_t *nr_send = (size_t *)malloc(nr_nodes * sizeof(size_t));
+  for (int i = 0; i < nr_nodes; ++i) {
+    const size_t end = (i < nr_nodes - 1) ? sorted_offsets[i + 1] : count;
+    nr_send[i] = end - sorted_offsets[i];
+  }
+  free(sorted_offsets);
+
+  if (verbose)
+    message(" - Sorting of mesh cells took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Determine how many mesh cells we'll receive from each MPI rank */
+  size_t *nr_recv = (size_t *)malloc(sizeof(size_t) * nr_nodes);
+  MPI_Alltoall(nr_send, sizeof(size_t), MPI_BYTE, nr_recv, sizeof(size_t),
+               MPI_BYTE, MPI_COMM_WORLD);
+  size_t nr_recv_tot = 0;
+  for (int i = 0; i < nr_nodes; i++) {
+    nr_recv_tot += nr_recv[i];
+  }
+
+  /* Allocate the receive buffer */
+  struct mesh_key_value_rho *mesh_recvbuf;
+  if (swift_memalign("mesh_recvbuf", (void **)&mesh_recvbuf,
+                     SWIFT_CACHE_ALIGNMENT,
+                     nr_recv_tot * sizeof(struct mesh_key_value_rho)) != 0)
+    error("Failed to allocate receive buffer for constructing MPI FFT mesh");
+
+  /* Carry out the communication */
+  exchange_structs(nr_send, (char *)mesh_sendbuf, nr_recv, (char *)mesh_recvbuf,
+                   sizeof(struct mesh_key_value_rho));
+
+  if (verbose)
+    message(" - MPI exchange took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Copy received data to the local pencils */
+  for (size_t i = 0; i < nr_recv_tot; i++) {
+
+    const size_t key = mesh_recvbuf[i].key;
+    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+    const int mesh_y = get_ycoord_from_padded_row_major_id(key, N);
+    const int mesh_z = get_zcoord_from_padded_row_major_id(key, N);
+
+#ifdef SWIFT_DEBUG_CHECKS
+    if (mesh_x < pencil->x_start || mesh_x >= pencil->x_start + pencil->nx ||
+        mesh_y < pencil->y_start || mesh_y >= pencil->y_start + pencil->ny)
+      error("Received mesh cell is not in the local pencils");
+#endif
+
+    mesh[pm_mesh_pencil_index(pencil, mesh_x, mesh_y, mesh_z)] +=
+        mesh_recvbuf[i].value;
+  }
+
+  if (verbose)
+    message(" - Filling of the density values took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* Tidy up */
+  free(nr_send);
+  free(nr_recv);
+  swift_free("mesh_recvbuf", mesh_recvbuf);
+  swift_free("mesh_sendbuf", mesh_sendbuf);
+#else
+  error("MPI not available - unable to use the pencil-distributed mesh");
+#endif
+}
+
+/**
+ * @brief Retrieve the potential in the mesh cells we need to
+ * compute the force on particles on this MPI rank from a pencil-distributed
+ * mesh and store it in the local patches.
+ *
+ * Same as mpi_mesh_fetch_potential() but with the requests sorted by the
+ * rank holding the (x, y) pencil of each mesh cell.
+ *
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param fac Inverse of the FFT mesh cell size
+ * @param s The #space containing the particles.
+ * @param potential Array with the potential on the local pencils.
+ * @param local_patches The array of local patches to fill.
+ * @param tp The #threadpool object.
+ * @param verbose Are we talkative?
+ */
+void mpi_mesh_fetch_potential_pencils(const struct pm_mesh_pencil *pencil,
+                                      const double fac, const struct space *s,
+                                      const double *potential,
+                                      struct pm_mesh_patch *local_patches,
+                                      struct threadpool *tp,
+                                      const int verbose) {
+
+#ifdef WITH_MPI
+
+  /* Determine number of ranks */
+  int nr_nodes;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+
+  const int N = pencil->N;
+
+  ticks tic = getticks();
+
+  /* Determine how many mesh cells we will need to request */
+  const size_t nr_send_tot = count_required_mesh_cells(N, fac, s);
+
+  struct mesh_key_value_pot *send_cells_unsorted;
+  if (swift_memalign("send_cells_unsorted", (void **)&send_cells_unsorted,
+                     SWIFT_CACHE_ALIGNMENT,
+                     nr_send_tot * sizeof(struct mesh_key_value_pot)) != 0)
+    error("Failed to allocate array for cells to request!");
+
+  /* Initialise the mesh cells we will request */
+  const size_t check_count =
+      init_required_mesh_cells(N, fac, s, send_cells_unsorted);
+
+  if (nr_send_tot != check_count)
+    error("Count and initialisation incompatible!");
+
+  struct mesh_key_value_pot *send_cells;
+  if (swift_memalign("send_cells", (void **)&send_cells, SWIFT_CACHE_ALIGNMENT,
+                     nr_send_tot * sizeof(struct mesh_key_value_pot)) != 0)
+    error("Failed to allocate array for cells to request!");
+
+  size_t *sorted_offsets = (size_t *)malloc(nr_nodes * sizeof(size_t));
+
+  /* Do a bucket sort of the requests by destination rank */
+  bucket_sort_mesh_key_value_pot_pencil(send_cells_unsorted, nr_send_tot,
+                                        pencil, nr_nodes, tp, send_cells,
+                                        sorted_offsets);
+
+  swift_free("send_cells_unsorted", send_cells_unsorted);
+  send_cells_unsorted = NULL;
+
+  /* The buckets are the ranks, so the counts follow from the offsets */
+  size_t *nr_send = (size_t *)malloc(nr_nodes * sizeof(size_t));
+  for (int i = 0; i < nr_nodes; ++i) {
+    const size_t end = (i < nr_nodes - 1) ? sorted_offsets[i + 1] : nr_send_tot;
+    nr_send[i] = end - sorted_offsets[i];
+  }
+  free(sorted_offsets);
+
+  if (verbose)
+    message(" - 1st mesh patches sort took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Determine how many requests we'll receive from each MPI rank */
+  size_t *nr_recv = (size_t *)malloc(sizeof(size_t) * nr_nodes);
+  MPI_Alltoall(nr_send, sizeof(size_t), MPI_BYTE, nr_recv, sizeof(size_t),
+               MPI_BYTE, MPI_COMM_WORLD);
+  size_t nr_recv_tot = 0;
+  for (int i = 0; i < nr_nodes; i++) {
+    nr_recv_tot += nr_recv[i];
+  }
+
+  /* Allocate buffer to receive requests */
+  struct mesh_key_value_pot *recv_cells;
+  if (swift_memalign("recv_cells", (void **)&recv_cells, SWIFT_CACHE_ALIGNMENT,
+                     nr_recv_tot * sizeof(struct mesh_key_value_pot)) != 0)
+    error("Failed to allocate array for mesh receive buffer!");
+
+  /* Send requests for cells to other ranks */
+  exchange_structs(nr_send, (char *)send_cells, nr_recv, (char *)recv_cells,
+                   sizeof(struct mesh_key_value_pot));
+
+  /* Look up potential in the requested cells */
+  for (size_t i = 0; i < nr_recv_tot; i++) {
+
+    const size_t key = recv_cells[i].key;
+    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+    const int mesh_y = get_ycoord_from_padded_row_major_id(key, N);
+    const int mesh_z = get_zcoord_from_padded_row_major_id(key, N);
+
+#ifdef SWIFT_DEBUG_CHECKS
+    if (mesh_x < pencil->x_start || mesh_x >= pencil->x_start + pencil->nx ||
+        mesh_y < pencil->y_start || mesh_y >= pencil->y_start + pencil->ny)
+      error("Requested potential mesh cell is not in the local pencils");
+#endif
+
+    recv_cells[i].value =
+        potential[pm_mesh_pencil_index(pencil, mesh_x, mesh_y, mesh_z)];
+  }
+
+  /* Return the results */
+  exchange_structs(nr_recv, (char *)recv_cells, nr_send, (char *)send_cells,
+                   sizeof(struct mesh_key_value_pot));
+
+  if (verbose)
+    message(" - Exchanges of the potential took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Tidy up */
+  swift_free("recv_cells", recv_cells);
+  free(nr_send);
+  free(nr_recv);
+
+  struct mesh_key_value_pot *send_cells_sorted;
+  if (swift_memalign("send_cells_sorted", (void **)&send_cells_sorted,
+                     SWIFT_CACHE_ALIGNMENT,
+                     nr_send_tot * sizeof(struct mesh_key_value_pot)) != 0)
+    error("Failed to allocate array for cells to request!");
+
+  /* Now sort the mesh cells by top-level cell index (i.e. by the patch they
+   * belong to) */
+  bucket_sort_mesh_key_value_pot_index(
+      send_cells, nr_send_tot, s->nr_local_cells, tp, send_cells_sorted);
+
+  swift_free("send_cells", send_cells);
+  send_cells = NULL;
+
+  /* Initialise the local patches with the data we just received */
+  fill_local_patches_from_mesh_cells(N, fac, s, send_cells_sorted,
+                                     local_patches, nr_send_tot);
+
+  if (verbose)
+    message(" - Filling the local patches took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  swift_free("send_cells_sorted", send_cells_sorted);
+
+#else
+  error("MPI not available - unable to use the pencil-distributed mesh");
+#endif
+}
+
 /**
  * @brief Computes the potential on a gpart from a given mesh using the CIC
  * method.
@@ -993,7 +1359,6 @@ void mpi_mesh_fetch_potential(const int N, const double fac,
  * @param gp The #gpart.
  * @param patch The local mesh patch
  */
-#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
 void mesh_patch_to_gparts_CIC(struct gpart *gp,
                               const struct pm_mesh_patch *patch) {
 
@@ -1073,29 +1438,82 @@ void mesh_patch_to_gparts_CIC(struct gpart *gp,
   gp->a_grav_mesh[2] = fac * a[2];
   gravity_add_comoving_mesh_potential(gp, p);
 }
+
+/**
+ * @brief Computes the potential on a gpart from a given mesh using a TSC or
+ * PCS window.
+ *
+ * @param gp The #gpart.
+ * @param patch The local mesh patch
+ * @param order The order of the interpolation window.
+ */
+void mesh_patch_to_gparts_high_order(struct gpart *gp,
+                                     const struct pm_mesh_patch *patch,
+                                     const int order) {
+
+  const double fac = patch->fac;
+
+  /* Box wrap the gpart's position to the copy nearest the cell centre */
+  const double pos_x =
+      box_wrap(gp->x[0], patch->wrap_min[0], patch->wrap_max[0]);
+  const double pos_y =
+      box_wrap(gp->x[1], patch->wrap_min[1], patch->wrap_max[1]);
+  const double pos_z =
+      box_wrap(gp->x[2], patch->wrap_min[2], patch->wrap_max[2]);
+
+  /* Workout the window weights and the first node in the patch */
+  double wx[MESH_ASSIGNMENT_MAX_ORDER], wy[MESH_ASSIGNMENT_MAX_ORDER],
+      wz[MESH_ASSIGNMENT_MAX_ORDER];
+  const int ii = mesh_assignment_weights(order, fac * pos_x, wx) -
+                 patch->mesh_min[0];
+  const int jj = mesh_assignment_weights(order, fac * pos_y, wy) -
+                 patch->mesh_min[1];
+  const int kk = mesh_assignment_weights(order, fac * pos_z, wz) -
+                 patch->mesh_min[2];
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  if (gp->a_grav_mesh[0] != 0.) error("Particle with non-initalised stuff");
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+  if (gp->potential_mesh != 0.) error("Particle with non-initalised stuff");
+#endif
 #endif
 
+  /* Window interpolation of the potential and 5-point stencil along each
+   * axis for the accelerations */
+  double p = 0.;
+  double a[3] = {0.};
+  mesh_assignment_get_stencil(
+      patch->mesh + pm_mesh_patch_index(patch, ii, jj, kk),
+      patch->mesh_size[1] * patch->mesh_size[2], patch->mesh_size[2], order,
+      wx, wy, wz, &p, a);
+
+  /* Store things back */
+  gp->a_grav_mesh[0] = fac * a[0];
+  gp->a_grav_mesh[1] = fac * a[1];
+  gp->a_grav_mesh[2] = fac * a[2];
+  gravity_add_comoving_mesh_potential(gp, p);
+}
+
 /**
  * @brief Interpolate the forces and potential from the mesh to the #gpart.
  *
- * This is for the case where the mesh is distributed between MPI ranks
- * and stored in the form of a hashmap. This function updates the particles
- * in one #cell.
+ * This is for the case where the potential covering the cell has been
+ * copied to a local patch, either from a mesh distributed between MPI ranks
+ * or from the global mesh. This function updates the particles in one #cell.
  *
  * @param c The #cell containing the #gpart to update
- * @param potential Hashmap containing the potential to interpolate from.
+ * @param patch The #pm_mesh_patch containing the potential to interpolate
+ * from.
  * @param N Size of the full mesh
  * @param fac Inverse of the FFT mesh cell size
  * @param const_G Gravitional constant
  * @param dim Dimensions of the #space
+ * @param order The order of the interpolation window (2 for CIC)
  */
-void cell_distributed_mesh_to_gpart_CIC(const struct cell *c,
-                                        const struct pm_mesh_patch *patch,
-                                        const int N, const double fac,
-                                        const float const_G,
-                                        const double dim[3]) {
-
-#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+void cell_mesh_patch_to_gpart(const struct cell *c,
+                              const struct pm_mesh_patch *patch, const int N,
+                              const double fac, const float const_G,
+                              const double dim[3], const int order) {
 
   const int gcount = c->grav.count;
   struct gpart *gparts = c->grav.parts;
@@ -1103,7 +1521,7 @@ void cell_distributed_mesh_to_gpart_CIC(const struct cell *c,
   /* Check for empty cell as this would cause problems finding the extent */
   if (gcount == 0) return;
 
-  /* Get the potential from the mesh patch to the active gparts using CIC */
+  /* Get the potential from the mesh patch to the active gparts */
   for (int i = 0; i < gcount; ++i) {
     struct gpart *gp = &gparts[i];
 
@@ -1116,7 +1534,10 @@ void cell_distributed_mesh_to_gpart_CIC(const struct cell *c,
     gp->potential_mesh = 0.f;
 #endif
 
-    mesh_patch_to_gparts_CIC(gp, patch);
+    if (order == 2)
+      mesh_patch_to_gparts_CIC(gp, patch);
+    else
+      mesh_patch_to_gparts_high_order(gp, patch, order);
 
     gp->a_grav_mesh[0] *= const_G;
     gp->a_grav_mesh[1] *= const_G;
@@ -1125,10 +1546,6 @@ void cell_distributed_mesh_to_gpart_CIC(const struct cell *c,
     gp->potential_mesh *= const_G;
 #endif
   }
-
-#else
-  error("FFTW MPI not found - unable to use distributed mesh");
-#endif
 }
 
 /**
@@ -1155,7 +1572,7 @@ struct distributed_cic_mapper_data {
 void cell_distributed_mesh_to_gpart_CIC_mapper(void *map_data, int num,
                                                void *extra) {
 
-#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+#ifdef WITH_MPI
 
   /* Unpack the shared information */
   const struct distributed_cic_mapper_data *data =
@@ -1180,12 +1597,12 @@ void cell_distributed_mesh_to_gpart_CIC_mapper(void *map_data, int num,
     const struct cell *c = &cells[local_cells[i]];
 
     /* Update acceleration and potential for gparts in this cell */
-    cell_distributed_mesh_to_gpart_CIC(c, &local_patches[i], N, fac, const_G,
-                                       dim);
+    cell_mesh_patch_to_gpart(c, &local_patches[i], N, fac, const_G, dim,
+                             /*order=*/2);
   }
 
 #else
-  error("FFTW MPI not found - unable to use distributed mesh");
+  error("No MPI support - unable to use distributed mesh");
 #endif
 }
 
@@ -1193,7 +1610,7 @@ void mpi_mesh_update_gparts(struct pm_mesh_patch *local_patches,
                             const struct space *s, struct threadpool *tp,
                             const int N, const double cell_fac) {
 
-#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+#ifdef WITH_MPI
 
   const int *local_cells = s->local_cells_top;
   const int nr_local_cells = s->nr_local_cells;
@@ -1219,6 +1636,6 @@ void mpi_mesh_update_gparts(struct pm_mesh_patch *local_patches,
                    threadpool_auto_chunk_size, (void *)&data);
   }
 #else
-  error("FFTW MPI not found - unable to use distributed mesh");
+  error("No MPI support - unable to use distributed mesh");
 #endif
 }
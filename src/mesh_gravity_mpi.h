@@ -28,16 +28,23 @@ struct cell;
 struct threadpool;
 struct pm_mesh;
 struct pm_mesh_patch;
+struct pm_mesh_pencil;
 struct neutrino_model;
 
 void accumulate_cell_to_local_patch(const int N, const double fac,
                                     const double *dim, const struct cell *cell,
                                     struct pm_mesh_patch *patch,
-                                    const struct neutrino_model *nu_model);
+                                    const struct neutrino_model *nu_model,
+                                    const int order, const double shift);
 
-void mpi_mesh_accumulate_gparts_to_local_patches(
+void mesh_accumulate_gparts_to_local_patches(
     struct threadpool *tp, const int N, const double fac, const struct space *s,
-    struct pm_mesh_patch *local_patches);
+    struct pm_mesh_patch *local_patches, const int order, const double shift);
+
+void cell_mesh_patch_to_gpart(const struct cell *c,
+                              const struct pm_mesh_patch *patch, const int N,
+                              const double fac, const float const_G,
+                              const double dim[3], const int order);
 
 void mpi_mesh_local_patches_to_slices(const int N, const int local_n0,
                                       struct pm_mesh_patch *local_patches,
@@ -50,6 +57,19 @@ void mpi_mesh_fetch_potential(const int N, const double fac,
                               struct pm_mesh_patch *local_patches,
                               struct threadpool *tp, const int verbose);
 
+void mpi_mesh_local_patches_to_pencils(const struct pm_mesh_pencil *pencil,
+                                       struct pm_mesh_patch *local_patches,
+                                       const int nr_patches, double *mesh,
+                                       struct threadpool *tp,
+                                       const int verbose);
+
+void mpi_mesh_fetch_potential_pencils(const struct pm_mesh_pencil *pencil,
+                                      const double fac, const struct space *s,
+                                      const double *potential,
+                                      struct pm_mesh_patch *local_patches,
+                                      struct threadpool *tp,
+                                      const int verbose);
+
 void mpi_mesh_update_gparts(struct pm_mesh_patch *local_patches,
                             const struct space *s, struct threadpool *tp,
                             const int N, const double cell_fac);
@@ -22,6 +22,8 @@
 
 /* System includes. */
 #include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
 /* This object's header. */
 #include "mesh_gravity_patch.h"
@@ -31,6 +33,7 @@
 #include "cell.h"
 #include "error.h"
 #include "row_major_id.h"
+#include "threadpool.h"
 
 /**
  * @brief Initialize a mesh patch to cover a cell
@@ -101,6 +104,56 @@ void pm_mesh_patch_init(struct pm_mesh_patch *patch, const struct cell *cell,
     error("Failed to allocate array for mesh patch!");
 }
 
+/**
+ * @brief Initialize a mesh patch to cover a cell and the stencil used to
+ * interpolate the potential and forces back onto its particles.
+ *
+ * Contrary to pm_mesh_patch_init(), the extent of the patch only depends on
+ * the cell's geometry and not on the particle distribution.
+ *
+ * @param patch A pointer to the mesh patch
+ * @param cell The cell which the mesh should cover
+ * @param N Size of the full mesh
+ * @param fac Inverse of the FFT mesh size
+ * @param dim Size of the full volume in each dimension
+ * @param order The order of the interpolation window (2 for CIC)
+ */
+void pm_mesh_patch_init_stencil(struct pm_mesh_patch *patch,
+                                const struct cell *cell, const int N,
+                                const double fac, const double dim[3],
+                                const int order) {
+
+  patch->N = N;
+  patch->fac = fac;
+
+  /* Will need to wrap particles to position nearest the cell centre */
+  for (int i = 0; i < 3; i++) {
+    patch->wrap_min[i] = cell->loc[i] + 0.5 * cell->width[i] - 0.5 * dim[i];
+    patch->wrap_max[i] = cell->loc[i] + 0.5 * cell->width[i] + 0.5 * dim[i];
+  }
+
+  /* The 5-point stencil of the CIC interpolation needs 2 extra elements in
+   * the negative direction and 3 in the positive one. The wider TSC and PCS
+   * windows reach one more element on the negative side and two more on the
+   * positive one. */
+  const double extra_min = (order > 2) ? 3.01 : 2.01;
+  const double extra_max = (order > 2) ? 4.01 : 3.01;
+  int num_cells = 1;
+  for (int i = 0; i < 3; i++) {
+    const double xmin = cell->loc[i] - extra_min / fac;
+    const double xmax = cell->loc[i] + cell->width[i] + extra_max / fac;
+    patch->mesh_min[i] = (int)floor(xmin * fac);
+    patch->mesh_max[i] = (int)floor(xmax * fac);
+    patch->mesh_size[i] = patch->mesh_max[i] - patch->mesh_min[i] + 1;
+    num_cells *= patch->mesh_size[i];
+  }
+
+  /* Allocate the mesh */
+  if (swift_memalign("mesh_patch", (void **)&patch->mesh, SWIFT_CACHE_ALIGNMENT,
+                     num_cells * sizeof(double)) != 0)
+    error("Failed to allocate array for mesh patch!");
+}
+
 /**
  * @brief Write the content of a mesh patch back to the global mesh
  * using atomic operations.
@@ -140,6 +193,198 @@ void pm_add_patch_to_global_mesh(double *const global_mesh,
   }
 }
 
+/**
+ * @brief A plane (fixed x index) of a mesh patch.
+ */
+struct patch_plane {
+
+  /*! Index of the patch in the array of patches */
+  int patch;
+
+  /*! Index of the plane in the patch */
+  int i;
+};
+
+/**
+ * @brief Shared information about the patches to be reduced onto the global
+ * mesh by all the threads in the pool.
+ */
+struct patches_to_global_mesh_data {
+  const struct pm_mesh_patch *patches;
+  int N;
+  double *global_mesh;
+
+  /*! Planes of the patches, bucketed by the slab of the global mesh they
+   * fall in */
+  const struct patch_plane *planes;
+
+  /*! Start of the planes of each slab in the list (one extra entry at the
+   * end) */
+  const int *slab_start;
+};
+
+/**
+ * @brief Threadpool mapper adding all the patches to a range of slabs of the
+ * global mesh.
+ *
+ * Each thread owns a set of consecutive slabs (x-planes) of the global mesh
+ * and is the only one writing to them. No atomics are hence required and
+ * the order in which the patches are summed is independent of the number of
+ * threads. Only the planes of the patches falling in these slabs are visited.
+ *
+ * @param map_data The first slab of the global mesh to update.
+ * @param num The number of slabs to update.
+ * @param extra The #patches_to_global_mesh_data.
+ */
+void pm_mesh_patches_to_global_mesh_mapper(void *map_data, int num,
+                                           void *extra) {
+
+  const struct patches_to_global_mesh_data *data =
+      (struct patches_to_global_mesh_data *)extra;
+  const struct pm_mesh_patch *patches = data->patches;
+  const struct patch_plane *planes = data->planes;
+  const int *slab_start = data->slab_start;
+  const int N = data->N;
+  double *const global_mesh = data->global_mesh;
+
+  /* Range of slabs (x coordinates) handled by this call */
+  const int i_start = (double *)map_data - global_mesh;
+  const int i_end = i_start + num;
+
+  for (int ii = i_start; ii < i_end; ++ii) {
+    for (int n = slab_start[ii]; n < slab_start[ii + 1]; ++n) {
+
+      const struct pm_mesh_patch *patch = &patches[planes[n].patch];
+      const int i = planes[n].i;
+
+      const int size_j = patch->mesh_size[1];
+      const int size_k = patch->mesh_size[2];
+      const int mesh_min_j = patch->mesh_min[1];
+      const int mesh_min_k = patch->mesh_min[2];
+
+      /* Remind the compiler that the arrays are nicely aligned */
+      swift_declare_aligned_ptr(const double, mesh, patch->mesh,
+                                SWIFT_CACHE_ALIGNMENT);
+
+      for (int j = 0; j < size_j; ++j) {
+
+        const int jj = (j + mesh_min_j + N) % N;
+        double *const row = global_mesh + ((size_t)ii * N + jj) * N;
+        const double *const patch_row =
+            mesh + (size_t)pm_mesh_patch_index(patch, i, j, 0);
+
+        for (int k = 0; k < size_k; ++k) {
+          const int kk = (k + mesh_min_k + N) % N;
+          row[kk] += patch_row[k];
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Add the content of a set of mesh patches to the global mesh.
+ *
+ * The reduction is parallelised over slabs of the global mesh rather than
+ * over patches such that no atomic operations are required. The planes of
+ * the patches are first bucketed by slab such that each thread only visits
+ * the planes it has to add.
+ *
+ * @param tp The #threadpool.
+ * @param patches The array of #pm_mesh_patch to add.
+ * @param nr_patches The number of patches.
+ * @param N Size of the full mesh.
+ * @param global_mesh The global N*N*N mesh to write to.
+ */
+void pm_mesh_patches_to_global_mesh(struct threadpool *tp,
+                                    const struct pm_mesh_patch *patches,
+                                    const int nr_patches, const int N,
+                                    double *const global_mesh) {
+
+  /* Count the planes falling in each slab... */
+  int *slab_start = (int *)calloc(N + 1, sizeof(int));
+  if (slab_start == NULL) error("Failed to allocate the slab counts.");
+  for (int p = 0; p < nr_patches; ++p) {
+
+    /* Skip patches of empty cells */
+    if (patches[p].mesh == NULL) continue;
+
+    for (int i = 0; i < patches[p].mesh_size[0]; ++i)
+      slab_start[(i + patches[p].mesh_min[0] + N) % N + 1]++;
+  }
+  for (int ii = 0; ii < N; ++ii) slab_start[ii + 1] += slab_start[ii];
+
+  /* ...and list them slab by slab, in the order of the patches. */
+  struct patch_plane *planes = (struct patch_plane *)malloc(
+      (slab_start[N] > 0 ? slab_start[N] : 1) * sizeof(struct patch_plane));
+  int *fill = (int *)malloc(N * sizeof(int));
+  if (planes == NULL || fill == NULL)
+    error("Failed to allocate the list of patch planes.");
+  memcpy(fill, slab_start, N * sizeof(int));
+  for (int p = 0; p < nr_patches; ++p) {
+    if (patches[p].mesh == NULL) continue;
+    for (int i = 0; i < patches[p].mesh_size[0]; ++i) {
+      const int ii = (i + patches[p].mesh_min[0] + N) % N;
+      planes[fill[ii]].patch = p;
+      planes[fill[ii]].i = i;
+      fill[ii]++;
+    }
+  }
+  free(fill);
+
+  struct patches_to_global_mesh_data data;
+  data.patches = patches;
+  data.N = N;
+  data.global_mesh = global_mesh;
+  data.planes = planes;
+  data.slab_start = slab_start;
+
+  /* Use the threadpool to split the x-axis over the threads. We pass the
+   * global mesh as a list of N elements and re-construct the slab index from
+   * the pointer difference. */
+  threadpool_map(tp, pm_mesh_patches_to_global_mesh_mapper, global_mesh, N,
+                 sizeof(double), threadpool_auto_chunk_size, &data);
+
+  free(planes);
+  free(slab_start);
+}
+
+/**
+ * @brief Copy the values of the global mesh covered by a patch into the
+ * patch.
+ *
+ * @param patch The #pm_mesh_patch to fill.
+ * @param global_mesh The global N*N*N mesh to read from.
+ */
+void pm_mesh_patch_fill_from_global_mesh(struct pm_mesh_patch *patch,
+                                         const double *const global_mesh) {
+
+  const int N = patch->N;
+  const int size_i = patch->mesh_size[0];
+  const int size_j = patch->mesh_size[1];
+  const int size_k = patch->mesh_size[2];
+
+  /* Remind the compiler that the arrays are nicely aligned */
+  swift_declare_aligned_ptr(double, mesh, patch->mesh, SWIFT_CACHE_ALIGNMENT);
+
+  for (int i = 0; i < size_i; ++i) {
+
+    const int ii = (i + patch->mesh_min[0] + N) % N;
+
+    for (int j = 0; j < size_j; ++j) {
+
+      const int jj = (j + patch->mesh_min[1] + N) % N;
+      const double *const row = global_mesh + ((size_t)ii * N + jj) * N;
+      double *const patch_row = mesh + pm_mesh_patch_index(patch, i, j, 0);
+
+      for (int k = 0; k < size_k; ++k) {
+        const int kk = (k + patch->mesh_min[2] + N) % N;
+        patch_row[k] = row[kk];
+      }
+    }
+  }
+}
+
 /**
  * @brief Set all values in a mesh patch to zero
  *
@@ -30,6 +30,11 @@
 
 /* Forward declarations */
 struct cell;
+struct threadpool;
+
+/*! Number of particles whose CIC weights are computed together when
+ * depositing onto a patch */
+#define PM_MESH_PATCH_BLOCK_SIZE 32
 
 /**
  * @brief Data structure for a patch of mesh covering a cell
@@ -65,6 +70,11 @@ void pm_mesh_patch_init(struct pm_mesh_patch *patch, const struct cell *cell,
                         const int N, const double fac, const double dim[3],
                         const int boundary_size);
 
+void pm_mesh_patch_init_stencil(struct pm_mesh_patch *patch,
+                                const struct cell *cell, const int N,
+                                const double fac, const double dim[3],
+                                const int order);
+
 void pm_mesh_patch_zero(struct pm_mesh_patch *patch);
 
 void pm_mesh_patch_clean(struct pm_mesh_patch *patch);
@@ -170,4 +180,12 @@ __attribute__((always_inline)) INLINE static void pm_mesh_patch_CIC_set(
 void pm_add_patch_to_global_mesh(double *const global_mesh,
                                  const struct pm_mesh_patch *patch);
 
+void pm_mesh_patches_to_global_mesh(struct threadpool *tp,
+                                    const struct pm_mesh_patch *patches,
+                                    const int nr_patches, const int N,
+                                    double *const global_mesh);
+
+void pm_mesh_patch_fill_from_global_mesh(struct pm_mesh_patch *patch,
+                                         const double *const global_mesh);
+
 #endif
@@ -0,0 +1,589 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "mesh_gravity_pencil.h"
+
+/* Local includes. */
+#include "clocks.h"
+#include "error.h"
+#include "minmax.h"
+
+/* Standard includes */
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Initialise the pencil decomposition of a mesh over all the ranks.
+ *
+ * The ranks are arranged in a 2D grid as square as possible. The first
+ * dimension of the grid is the largest, such that the N/2 + 1 kz modes get
+ * split over the smallest number of ranks.
+ *
+ * @param pencil The #pm_mesh_pencil to initialise.
+ * @param N The side-length of the mesh.
+ */
+void pm_mesh_pencil_init(struct pm_mesh_pencil *pencil, const int N) {
+
+  int nodeID = 0;
+  int dims[2] = {1, 1};
+
+#ifdef WITH_MPI
+  int nr_nodes;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &nodeID);
+  dims[0] = 0;
+  dims[1] = 0;
+  if (MPI_Dims_create(nr_nodes, 2, dims) != MPI_SUCCESS)
+    error("Failed to create the process grid for the pencil decomposition.");
+#endif
+
+  pencil->N = N;
+  pencil->Nc = N / 2 + 1;
+  pencil->P0 = dims[0];
+  pencil->P1 = dims[1];
+  pencil->p0 = nodeID / pencil->P1;
+  pencil->p1 = nodeID % pencil->P1;
+
+  const int P0 = pencil->P0, P1 = pencil->P1;
+  const int p0 = pencil->p0, p1 = pencil->p1;
+  const int Nc = pencil->Nc;
+
+  /* Real-space blocks */
+  pencil->x_start = pm_mesh_pencil_block(p0, N, P0);
+  pencil->nx = pm_mesh_pencil_block(p0 + 1, N, P0) - pencil->x_start;
+  pencil->y_start = pm_mesh_pencil_block(p1, N, P1);
+  pencil->ny = pm_mesh_pencil_block(p1 + 1, N, P1) - pencil->y_start;
+
+  /* Fourier-space blocks */
+  pencil->ky_start = pm_mesh_pencil_block(p0, N, P0);
+  pencil->nky = pm_mesh_pencil_block(p0 + 1, N, P0) - pencil->ky_start;
+  pencil->kz_start = pm_mesh_pencil_block(p1, Nc, P1);
+  pencil->nkz = pm_mesh_pencil_block(p1 + 1, Nc, P1) - pencil->kz_start;
+
+#ifdef WITH_MPI
+  /* The rank in the row (column) communicator is p1 (p0) */
+  MPI_Comm_split(MPI_COMM_WORLD, p0, p1, &pencil->row_comm);
+  MPI_Comm_split(MPI_COMM_WORLD, p1, p0, &pencil->col_comm);
+#endif
+}
+
+/**
+ * @brief Free the resources used by a pencil decomposition.
+ *
+ * @param pencil The #pm_mesh_pencil to clean.
+ */
+void pm_mesh_pencil_clean(struct pm_mesh_pencil *pencil) {
+
+#ifdef WITH_MPI
+  MPI_Comm_free(&pencil->row_comm);
+  MPI_Comm_free(&pencil->col_comm);
+#endif
+}
+
+#ifdef HAVE_FFTW
+
+/**
+ * @brief Description of an all-to-all exchange of complex values between
+ * the ranks of a row or column of the process grid.
+ */
+struct pencil_exchange {
+
+  /*! Number of ranks in the exchange */
+  int nr_peers;
+
+  /*! Offsets and counts of the data sent to each rank */
+  size_t *send_offsets, *send_counts;
+
+  /*! Offsets and counts of the data received from each rank */
+  size_t *recv_offsets, *recv_counts;
+
+#ifdef WITH_MPI
+  /*! The communicator */
+  MPI_Comm comm;
+
+  /*! The requests in flight (one send and one receive per rank) */
+  MPI_Request *requests;
+#endif
+};
+
+/**
+ * @brief Allocate the arrays of a #pencil_exchange.
+ */
+static void pencil_exchange_init(struct pencil_exchange *ex,
+                                 const int nr_peers) {
+
+  ex->nr_peers = nr_peers;
+  ex->send_offsets = (size_t *)calloc(4 * nr_peers, sizeof(size_t));
+  if (ex->send_offsets == NULL)
+    error("Failed to allocate the pencil exchange counts.");
+  ex->send_counts = ex->send_offsets + nr_peers;
+  ex->recv_offsets = ex->send_offsets + 2 * nr_peers;
+  ex->recv_counts = ex->send_offsets + 3 * nr_peers;
+
+#ifdef WITH_MPI
+  ex->requests = (MPI_Request *)malloc(2 * nr_peers * sizeof(MPI_Request));
+  if (ex->requests == NULL)
+    error("Failed to allocate the pencil exchange requests.");
+  for (int i = 0; i < 2 * nr_peers; ++i) ex->requests[i] = MPI_REQUEST_NULL;
+#endif
+}
+
+/**
+ * @brief Free the arrays of a #pencil_exchange.
+ */
+static void pencil_exchange_clean(struct pencil_exchange *ex) {
+
+  free(ex->send_offsets);
+#ifdef WITH_MPI
+  free(ex->requests);
+#endif
+}
+
+/**
+ * @brief Start an exchange.
+ *
+ * In reverse mode, the data travels back along the same routes: the
+ * receive buffer is sent and the send buffer is received.
+ *
+ * @param ex The #pencil_exchange.
+ * @param sendbuf The buffer laid out with the send offsets.
+ * @param recvbuf The buffer laid out with the receive offsets.
+ * @param reverse Are we running the exchange backwards?
+ * @param tag The MPI tag distinguishing the exchanges in flight.
+ */
+static void pencil_exchange_start(struct pencil_exchange *ex,
+                                  fftw_complex *sendbuf,
+                                  fftw_complex *recvbuf, const int reverse,
+                                  const int tag) {
+
+  fftw_complex *from = reverse ? recvbuf : sendbuf;
+  fftw_complex *to = reverse ? sendbuf : recvbuf;
+  const size_t *send_offsets = reverse ? ex->recv_offsets : ex->send_offsets;
+  const size_t *send_counts = reverse ? ex->recv_counts : ex->send_counts;
+  const size_t *recv_offsets = reverse ? ex->send_offsets : ex->recv_offsets;
+  const size_t *recv_counts = reverse ? ex->send_counts : ex->recv_counts;
+
+#ifdef WITH_MPI
+  const int nr_peers = ex->nr_peers;
+
+  /* Post the receives first */
+  for (int i = 0; i < nr_peers; ++i) {
+    if (recv_counts[i] > 0) {
+      if (2 * recv_counts[i] > INT_MAX)
+        error("Pencil exchange message too large!");
+      MPI_Irecv(to[recv_offsets[i]], (int)(2 * recv_counts[i]),
+                MPI_DOUBLE, i, tag, ex->comm, &ex->requests[i]);
+    } else {
+      ex->requests[i] = MPI_REQUEST_NULL;
+    }
+  }
+
+  /* And now the sends */
+  for (int i = 0; i < nr_peers; ++i) {
+    if (send_counts[i] > 0) {
+      if (2 * send_counts[i] > INT_MAX)
+        error("Pencil exchange message too large!");
+      MPI_Isend(from[send_offsets[i]], (int)(2 * send_counts[i]),
+                MPI_DOUBLE, i, tag, ex->comm, &ex->requests[nr_peers + i]);
+    } else {
+      ex->requests[nr_peers + i] = MPI_REQUEST_NULL;
+    }
+  }
+#else
+  /* Only one rank: the exchange is a copy */
+  if (send_counts[0] != recv_counts[0])
+    error("Inconsistent pencil exchange counts!");
+  memcpy(to[recv_offsets[0]], from[send_offsets[0]],
+         send_counts[0] * sizeof(fftw_complex));
+#endif
+}
+
+/**
+ * @brief Wait for an exchange to complete.
+ *
+ * @param ex The #pencil_exchange.
+ */
+static void pencil_exchange_wait(struct pencil_exchange *ex) {
+
+#ifdef WITH_MPI
+  MPI_Waitall(2 * ex->nr_peers, ex->requests, MPI_STATUSES_IGNORE);
+#endif
+}
+
+/**
+ * @brief Allocate an array of complex values (possibly empty).
+ *
+ * @param count The number of elements.
+ */
+static fftw_complex *pencil_malloc(const size_t count) {
+
+  fftw_complex *ptr =
+      (fftw_complex *)fftw_malloc(max(count, (size_t)1) * sizeof(fftw_complex));
+  if (ptr == NULL) error("Failed to allocate the pencil FFT buffers.");
+  return ptr;
+}
+
+/**
+ * @brief Plan and execute a batch of contiguous 1D complex transforms.
+ *
+ * @param data The data to transform in-place.
+ * @param n The length of the transforms.
+ * @param howmany The number of transforms.
+ * @param sign The direction of the transforms.
+ */
+static void pencil_fft_c2c(fftw_complex *data, const int n, const int howmany,
+                           const int sign) {
+
+  if (howmany == 0) return;
+  fftw_plan plan = fftw_plan_many_dft(1, &n, howmany, data, NULL, 1, n, data,
+                                      NULL, 1, n, sign, FFTW_ESTIMATE);
+  fftw_execute(plan);
+  fftw_destroy_plan(plan);
+}
+
+/**
+ * @brief Convolve a pencil-distributed real mesh with a kernel.
+ *
+ * The mesh is transformed to Fourier space with three batches of 1D FFTs
+ * separated by two transposes, the kernel is applied and the mesh is
+ * transformed back. As with FFTW, the round trip is not normalised.
+ *
+ * The first transpose is within the rows of the process grid and the
+ * second within its columns. The second transpose is split in chunks of kz
+ * modes such that the communication of one chunk overlaps with the FFT
+ * along x, the kernel application and the inverse FFT of the previous one.
+ *
+ * The input mesh is stored as [x - x_start][y - y_start][z] and is
+ * overwritten with the result.
+ *
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param rho The local real-space pencils.
+ * @param tp The #threadpool object passed to the kernel.
+ * @param kernel The #pm_mesh_pencil_kernel to apply in Fourier space.
+ * @param extra Extra data passed to the kernel.
+ * @param nr_chunks The number of chunks of the second transpose.
+ * @param verbose Are we talkative?
+ */
+void pm_mesh_pencil_convolve(struct pm_mesh_pencil *pencil, double *rho,
+                             struct threadpool *tp,
+                             pm_mesh_pencil_kernel kernel, void *extra,
+                             const int nr_chunks, const int verbose) {
+
+  const int N = pencil->N;
+  const int Nc = pencil->Nc;
+  const int P0 = pencil->P0, P1 = pencil->P1;
+  const int nx = pencil->nx, ny = pencil->ny;
+  const int nky = pencil->nky, nkz = pencil->nkz;
+
+  if (nr_chunks < 1) error("Invalid number of pencil chunks.");
+
+  ticks tic = getticks();
+
+  /* Allocate the work arrays */
+  const size_t size_z = (size_t)nx * ny * Nc;
+  const size_t size_y = (size_t)nx * nkz * N;
+  const size_t size_x = (size_t)nkz * nky * N;
+  fftw_complex *zpencil = pencil_malloc(size_z);
+  fftw_complex *ypencil = pencil_malloc(size_y);
+  fftw_complex *sendbuf = pencil_malloc(max(size_z, size_y));
+  fftw_complex *recvbuf = pencil_malloc(max(size_y, size_x));
+
+  /* 1D r2c transforms along z */
+  if (nx * ny > 0) {
+    fftw_plan plan = fftw_plan_many_dft_r2c(1, &N, nx * ny, rho, NULL, 1, N,
+                                            zpencil, NULL, 1, Nc,
+                                            FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+    fftw_execute(plan);
+    fftw_destroy_plan(plan);
+  }
+
+  if (verbose)
+    message(" - Pencil FFT along z took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* First transpose (within the row): from [x][y][all kz] to [x][kz][all y].
+   * We send the kz block of each rank of the row and receive its y block. */
+  struct pencil_exchange ex_row;
+  pencil_exchange_init(&ex_row, P1);
+#ifdef WITH_MPI
+  ex_row.comm = pencil->row_comm;
+#endif
+  for (int q = 0; q < P1; ++q) {
+    const int kz_q = pm_mesh_pencil_block(q, Nc, P1);
+    const int nkz_q = pm_mesh_pencil_block(q + 1, Nc, P1) - kz_q;
+    const int y_q = pm_mesh_pencil_block(q, N, P1);
+    const int ny_q = pm_mesh_pencil_block(q + 1, N, P1) - y_q;
+    ex_row.send_offsets[q] = (size_t)nx * ny * kz_q;
+    ex_row.send_counts[q] = (size_t)nx * ny * nkz_q;
+    ex_row.recv_offsets[q] = (size_t)nx * y_q * nkz;
+    ex_row.recv_counts[q] = (size_t)nx * ny_q * nkz;
+
+    /* Pack the data going to q as [x][y][kz_q] */
+    fftw_complex *buf = sendbuf + ex_row.send_offsets[q];
+    for (int i = 0; i < nx; ++i)
+      for (int j = 0; j < ny; ++j)
+        memcpy(buf[((size_t)i * ny + j) * nkz_q],
+               zpencil[((size_t)i * ny + j) * Nc + kz_q],
+               nkz_q * sizeof(fftw_complex));
+  }
+
+  pencil_exchange_start(&ex_row, sendbuf, recvbuf, /*reverse=*/0, /*tag=*/0);
+  pencil_exchange_wait(&ex_row);
+
+  /* Unpack the data coming from q, stored as [x][y_q][kz] */
+  for (int q = 0; q < P1; ++q) {
+    const int y_q = pm_mesh_pencil_block(q, N, P1);
+    const int ny_q = pm_mesh_pencil_block(q + 1, N, P1) - y_q;
+    const fftw_complex *buf = recvbuf + ex_row.recv_offsets[q];
+    for (int i = 0; i < nx; ++i)
+      for (int j = 0; j < ny_q; ++j)
+        for (int k = 0; k < nkz; ++k) {
+          const size_t from = ((size_t)i * ny_q + j) * nkz + k;
+          const size_t to = ((size_t)i * nkz + k) * N + y_q + j;
+          ypencil[to][0] = buf[from][0];
+          ypencil[to][1] = buf[from][1];
+        }
+  }
+
+  if (verbose)
+    message(" - Pencil row transpose took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* 1D transforms along y */
+  pencil_fft_c2c(ypencil, N, nx * nkz, FFTW_FORWARD);
+
+  if (verbose)
+    message(" - Pencil FFT along y took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Second transpose (within the column), one chunk of kz modes at a time:
+   * from [x][kz][all ky] to [kz][ky][all x]. We send the ky block of each
+   * rank of the column and receive its x block. Chunk c occupies the range
+   * [nx * kc * N, nx * (kc + nkc) * N[ of the send buffer and
+   * [kc * nky * N, (kc + nkc) * nky * N[ of the receive buffer. */
+  struct pencil_exchange *ex_col = (struct pencil_exchange *)malloc(
+      nr_chunks * sizeof(struct pencil_exchange));
+  if (ex_col == NULL) error("Failed to allocate the pencil chunks.");
+  for (int c = 0; c < nr_chunks; ++c) {
+    const int kc = pm_mesh_pencil_block(c, nkz, nr_chunks);
+    const int nkc = pm_mesh_pencil_block(c + 1, nkz, nr_chunks) - kc;
+    pencil_exchange_init(&ex_col[c], P0);
+#ifdef WITH_MPI
+    ex_col[c].comm = pencil->col_comm;
+#endif
+    for (int q = 0; q < P0; ++q) {
+      const int ky_q = pm_mesh_pencil_block(q, N, P0);
+      const int nky_q = pm_mesh_pencil_block(q + 1, N, P0) - ky_q;
+      const int x_q = pm_mesh_pencil_block(q, N, P0);
+      const int nx_q = pm_mesh_pencil_block(q + 1, N, P0) - x_q;
+      ex_col[c].send_offsets[q] = (size_t)nx * kc * N + (size_t)nx * nkc * ky_q;
+      ex_col[c].send_counts[q] = (size_t)nx * nkc * nky_q;
+      ex_col[c].recv_offsets[q] =
+          (size_t)kc * nky * N + (size_t)x_q * nkc * nky;
+      ex_col[c].recv_counts[q] = (size_t)nx_q * nkc * nky;
+    }
+  }
+
+  /* Pack a chunk and start sending it */
+  for (int c = 0; c < min(2, nr_chunks); ++c) {
+    const int kc = pm_mesh_pencil_block(c, nkz, nr_chunks);
+    const int nkc = pm_mesh_pencil_block(c + 1, nkz, nr_chunks) - kc;
+    for (int q = 0; q < P0; ++q) {
+      const int ky_q = pm_mesh_pencil_block(q, N, P0);
+      const int nky_q = pm_mesh_pencil_block(q + 1, N, P0) - ky_q;
+      fftw_complex *buf = sendbuf + ex_col[c].send_offsets[q];
+      for (int i = 0; i < nx; ++i)
+        for (int k = 0; k < nkc; ++k)
+          memcpy(buf[((size_t)i * nkc + k) * nky_q],
+                 ypencil[((size_t)i * nkz + kc + k) * N + ky_q],
+                 nky_q * sizeof(fftw_complex));
+    }
+    pencil_exchange_start(&ex_col[c], sendbuf, recvbuf, /*reverse=*/0,
+                          /*tag=*/2 * c);
+  }
+
+  /* Work array for one chunk of x-pencils */
+  int nkc_max = 0;
+  for (int c = 0; c < nr_chunks; ++c)
+    nkc_max = max(nkc_max, pm_mesh_pencil_block(c + 1, nkz, nr_chunks) -
+                               pm_mesh_pencil_block(c, nkz, nr_chunks));
+  fftw_complex *xpencil = pencil_malloc((size_t)nkc_max * nky * N);
+
+  for (int c = 0; c < nr_chunks; ++c) {
+
+    const int kc = pm_mesh_pencil_block(c, nkz, nr_chunks);
+    const int nkc = pm_mesh_pencil_block(c + 1, nkz, nr_chunks) - kc;
+
+    /* Wait for this chunk to arrive */
+    pencil_exchange_wait(&ex_col[c]);
+
+    /* Keep the next-but-one chunk in flight while we work on this one */
+    if (c + 2 < nr_chunks) {
+      const int c2 = c + 2;
+      const int kc2 = pm_mesh_pencil_block(c2, nkz, nr_chunks);
+      const int nkc2 = pm_mesh_pencil_block(c2 + 1, nkz, nr_chunks) - kc2;
+      for (int q = 0; q < P0; ++q) {
+        const int ky_q = pm_mesh_pencil_block(q, N, P0);
+        const int nky_q = pm_mesh_pencil_block(q + 1, N, P0) - ky_q;
+        fftw_complex *buf = sendbuf + ex_col[c2].send_offsets[q];
+        for (int i = 0; i < nx; ++i)
+          for (int k = 0; k < nkc2; ++k)
+            memcpy(buf[((size_t)i * nkc2 + k) * nky_q],
+                   ypencil[((size_t)i * nkz + kc2 + k) * N + ky_q],
+                   nky_q * sizeof(fftw_complex));
+      }
+      pencil_exchange_start(&ex_col[c2], sendbuf, recvbuf, /*reverse=*/0,
+                            /*tag=*/2 * c2);
+    }
+
+    /* Unpack the data coming from q, stored as [x_q][kz][ky] */
+    for (int q = 0; q < P0; ++q) {
+      const int x_q = pm_mesh_pencil_block(q, N, P0);
+      const int nx_q = pm_mesh_pencil_block(q + 1, N, P0) - x_q;
+      const fftw_complex *buf = recvbuf + ex_col[c].recv_offsets[q];
+      for (int i = 0; i < nx_q; ++i)
+        for (int k = 0; k < nkc; ++k)
+          for (int j = 0; j < nky; ++j) {
+            const size_t from = ((size_t)i * nkc + k) * nky + j;
+            const size_t to = ((size_t)k * nky + j) * N + x_q + i;
+            xpencil[to][0] = buf[from][0];
+            xpencil[to][1] = buf[from][1];
+          }
+    }
+
+    /* Forward along x, apply the kernel, backward along x */
+    pencil_fft_c2c(xpencil, N, nkc * nky, FFTW_FORWARD);
+    if (nkc * nky > 0)
+      kernel(tp, xpencil, pencil->kz_start + kc, nkc, pencil->ky_start, nky, N,
+             extra);
+    pencil_fft_c2c(xpencil, N, nkc * nky, FFTW_BACKWARD);
+
+    /* Pack the chunk back in the receive buffer and return it */
+    for (int q = 0; q < P0; ++q) {
+      const int x_q = pm_mesh_pencil_block(q, N, P0);
+      const int nx_q = pm_mesh_pencil_block(q + 1, N, P0) - x_q;
+      fftw_complex *buf = recvbuf + ex_col[c].recv_offsets[q];
+      for (int i = 0; i < nx_q; ++i)
+        for (int k = 0; k < nkc; ++k)
+          for (int j = 0; j < nky; ++j) {
+            const size_t to = ((size_t)i * nkc + k) * nky + j;
+            const size_t from = ((size_t)k * nky + j) * N + x_q + i;
+            buf[to][0] = xpencil[from][0];
+            buf[to][1] = xpencil[from][1];
+          }
+    }
+    pencil_exchange_start(&ex_col[c], sendbuf, recvbuf, /*reverse=*/1,
+                          /*tag=*/2 * c + 1);
+  }
+
+  fftw_free(xpencil);
+
+  /* Collect the returned chunks */
+  for (int c = 0; c < nr_chunks; ++c) {
+
+    const int kc = pm_mesh_pencil_block(c, nkz, nr_chunks);
+    const int nkc = pm_mesh_pencil_block(c + 1, nkz, nr_chunks) - kc;
+
+    pencil_exchange_wait(&ex_col[c]);
+
+    for (int q = 0; q < P0; ++q) {
+      const int ky_q = pm_mesh_pencil_block(q, N, P0);
+      const int nky_q = pm_mesh_pencil_block(q + 1, N, P0) - ky_q;
+      const fftw_complex *buf = sendbuf + ex_col[c].send_offsets[q];
+      for (int i = 0; i < nx; ++i)
+        for (int k = 0; k < nkc; ++k)
+          memcpy(ypencil[((size_t)i * nkz + kc + k) * N + ky_q],
+                 buf[((size_t)i * nkc + k) * nky_q],
+                 nky_q * sizeof(fftw_complex));
+    }
+    pencil_exchange_clean(&ex_col[c]);
+  }
+  free(ex_col);
+
+  if (verbose)
+    message(
+        " - Pencil column transposes, FFTs along x and kernel took %.3f %s.",
+        clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Inverse 1D transforms along y */
+  pencil_fft_c2c(ypencil, N, nx * nkz, FFTW_BACKWARD);
+
+  /* Inverse of the first transpose */
+  for (int q = 0; q < P1; ++q) {
+    const int y_q = pm_mesh_pencil_block(q, N, P1);
+    const int ny_q = pm_mesh_pencil_block(q + 1, N, P1) - y_q;
+    fftw_complex *buf = recvbuf + ex_row.recv_offsets[q];
+    for (int i = 0; i < nx; ++i)
+      for (int j = 0; j < ny_q; ++j)
+        for (int k = 0; k < nkz; ++k) {
+          const size_t to = ((size_t)i * ny_q + j) * nkz + k;
+          const size_t from = ((size_t)i * nkz + k) * N + y_q + j;
+          buf[to][0] = ypencil[from][0];
+          buf[to][1] = ypencil[from][1];
+        }
+  }
+
+  pencil_exchange_start(&ex_row, sendbuf, recvbuf, /*reverse=*/1, /*tag=*/1);
+  pencil_exchange_wait(&ex_row);
+
+  for (int q = 0; q < P1; ++q) {
+    const int kz_q = pm_mesh_pencil_block(q, Nc, P1);
+    const int nkz_q = pm_mesh_pencil_block(q + 1, Nc, P1) - kz_q;
+    const fftw_complex *buf = sendbuf + ex_row.send_offsets[q];
+    for (int i = 0; i < nx; ++i)
+      for (int j = 0; j < ny; ++j)
+        memcpy(zpencil[((size_t)i * ny + j) * Nc + kz_q],
+               buf[((size_t)i * ny + j) * nkz_q],
+               nkz_q * sizeof(fftw_complex));
+  }
+  pencil_exchange_clean(&ex_row);
+
+  /* Inverse 1D c2r transforms along z */
+  if (nx * ny > 0) {
+    fftw_plan plan = fftw_plan_many_dft_c2r(1, &N, nx * ny, zpencil, NULL, 1,
+                                            Nc, rho, NULL, 1, N,
+                                            FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+    fftw_execute(plan);
+    fftw_destroy_plan(plan);
+  }
+
+  if (verbose)
+    message(" - Pencil inverse FFTs along y and z took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  fftw_free(zpencil);
+  fftw_free(ypencil);
+  fftw_free(sendbuf);
+  fftw_free(recvbuf);
+}
+
+#endif /* HAVE_FFTW */
@@ -0,0 +1,193 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MESH_GRAVITY_PENCIL_H
+#define SWIFT_MESH_GRAVITY_PENCIL_H
+
+/* Config parameters. */
+#include <config.h>
+
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+/* Local headers */
+#include "inline.h"
+
+/* Standard headers */
+#include <stddef.h>
+
+/* Forward declarations */
+struct threadpool;
+
+/*! Number of chunks in which the last transpose is split to overlap the
+ * communication with the Fourier-space work */
+#define pm_mesh_pencil_nr_chunks 4
+
+/**
+ * @brief Pencil decomposition of an N^3 mesh over a 2D grid of MPI ranks.
+ *
+ * The ranks are arranged in a P0 x P1 grid with rank = p0 * P1 + p1.
+ *
+ * In real space, each rank holds all the z values of the mesh cells with
+ * an x coordinate in its block of the P0 split of [0, N[ and a y coordinate
+ * in its block of the P1 split of [0, N[ (z-pencils).
+ *
+ * In Fourier space, each rank holds all the kx values of the modes with a
+ * ky in its block of the P0 split of [0, N[ and a kz in its block of the P1
+ * split of [0, N/2 + 1[ (x-pencils).
+ *
+ * Contrary to the FFTW MPI slab decomposition, up to N * (N/2 + 1) ranks can
+ * hold a part of the mesh.
+ */
+struct pm_mesh_pencil {
+
+  /*! Side-length of the mesh */
+  int N;
+
+  /*! Number of complex modes along the last axis (N/2 + 1) */
+  int Nc;
+
+  /*! Size of the process grid */
+  int P0, P1;
+
+  /*! Coordinates of this rank in the process grid */
+  int p0, p1;
+
+  /*! Range of x coordinates of the real-space pencils on this rank */
+  int x_start, nx;
+
+  /*! Range of y coordinates of the real-space pencils on this rank */
+  int y_start, ny;
+
+  /*! Range of ky modes of the Fourier-space pencils on this rank */
+  int ky_start, nky;
+
+  /*! Range of kz modes of the Fourier-space pencils on this rank */
+  int kz_start, nkz;
+
+#ifdef WITH_MPI
+  /*! Communicator linking the ranks with the same p0 */
+  MPI_Comm row_comm;
+
+  /*! Communicator linking the ranks with the same p1 */
+  MPI_Comm col_comm;
+#endif
+};
+
+#ifdef HAVE_FFTW
+
+/**
+ * @brief Function applied to the Fourier-space pencils.
+ *
+ * The modes are stored as [kz - kz_start][ky - ky_start][kx] with kx in
+ * [0, N[, ky in [ky_start, ky_start + nky[ and kz in [kz_start, kz_start +
+ * nkz[.
+ *
+ * @param tp The #threadpool object.
+ * @param frho The modes to operate on.
+ * @param kz_start The first kz mode.
+ * @param nkz The number of kz modes.
+ * @param ky_start The first ky mode.
+ * @param nky The number of ky modes.
+ * @param N The side-length of the mesh.
+ * @param extra Extra data passed through to the function.
+ */
+typedef void (*pm_mesh_pencil_kernel)(struct threadpool *tp,
+                                      fftw_complex *frho, const int kz_start,
+                                      const int nkz, const int ky_start,
+                                      const int nky, const int N, void *extra);
+
+#endif
+
+/**
+ * @brief Returns the first element of the p-th block of a split of n
+ * elements in P blocks.
+ */
+__attribute__((always_inline, const)) INLINE static int pm_mesh_pencil_block(
+    const int p, const int n, const int P) {
+  return (int)(((long long)p * n) / P);
+}
+
+/**
+ * @brief Returns the block of a split of n elements in P blocks containing
+ * the element i.
+ */
+__attribute__((always_inline, const)) INLINE static int
+pm_mesh_pencil_block_owner(const int i, const int n, const int P) {
+  return (int)((((long long)i + 1) * P - 1) / n);
+}
+
+/**
+ * @brief Returns the rank holding the real-space mesh cell (i, j, k).
+ *
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param i The x coordinate in [0, N[.
+ * @param j The y coordinate in [0, N[.
+ */
+__attribute__((always_inline)) INLINE static int pm_mesh_pencil_owner(
+    const struct pm_mesh_pencil *pencil, const int i, const int j) {
+
+  const int p0 = pm_mesh_pencil_block_owner(i, pencil->N, pencil->P0);
+  const int p1 = pm_mesh_pencil_block_owner(j, pencil->N, pencil->P1);
+  return p0 * pencil->P1 + p1;
+}
+
+/**
+ * @brief Returns the index of the real-space mesh cell (i, j, k) in the
+ * pencils held by this rank.
+ *
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param i The x coordinate in [0, N[.
+ * @param j The y coordinate in [0, N[.
+ * @param k The z coordinate in [0, N[.
+ */
+__attribute__((always_inline)) INLINE static size_t pm_mesh_pencil_index(
+    const struct pm_mesh_pencil *pencil, const int i, const int j,
+    const int k) {
+
+  return ((size_t)(i - pencil->x_start) * pencil->ny + (j - pencil->y_start)) *
+             pencil->N +
+         k;
+}
+
+/**
+ * @brief Returns the number of real-space mesh cells held by this rank.
+ *
+ * @param pencil The #pm_mesh_pencil decomposition.
+ */
+__attribute__((always_inline)) INLINE static size_t pm_mesh_pencil_local_size(
+    const struct pm_mesh_pencil *pencil) {
+  return (size_t)pencil->nx * pencil->ny * pencil->N;
+}
+
+void pm_mesh_pencil_init(struct pm_mesh_pencil *pencil, const int N);
+void pm_mesh_pencil_clean(struct pm_mesh_pencil *pencil);
+
+#ifdef HAVE_FFTW
+void pm_mesh_pencil_convolve(struct pm_mesh_pencil *pencil, double *rho,
+                             struct threadpool *tp,
+                             pm_mesh_pencil_kernel kernel, void *extra,
+                             const int nr_chunks, const int verbose);
+#endif
+
+#endif /* SWIFT_MESH_GRAVITY_PENCIL_H */
@@ -27,6 +27,7 @@
 #include "align.h"
 #include "atomic.h"
 #include "error.h"
+#include "mesh_gravity_pencil.h"
 #include "row_major_id.h"
 #include "threadpool.h"
 
@@ -39,6 +40,18 @@ struct mapper_extra_data {
   size_t *bucket_counts;
 };
 
+struct pencil_mapper_extra_data {
+
+  /* Pencil decomposition of the mesh */
+  const struct pm_mesh_pencil *pencil;
+
+  /* Number of buckets (i.e. of MPI ranks) */
+  int nr_nodes;
+
+  /* Buckets */
+  size_t *bucket_counts;
+};
+
 /**
  * @param Count how may mesh cells will end up in each x-coord bucket.
  */
@@ -419,3 +432,230 @@ void bucket_sort_mesh_key_value_pot_index(
   free(bucket_offsets);
   free(bucket_counts);
 }
+
+/**
+ * @brief Returns the rank holding a mesh cell in a pencil decomposition.
+ *
+ * @param key The padded row-major id of the mesh cell.
+ * @param pencil The #pm_mesh_pencil decomposition.
+ */
+__attribute__((always_inline)) INLINE static int mesh_key_pencil_owner(
+    const size_t key, const struct pm_mesh_pencil *pencil) {
+
+  const int N = pencil->N;
+  const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+  const int mesh_y = get_ycoord_from_padded_row_major_id(key, N);
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (mesh_x < 0 || mesh_x >= N) error("Invalid mesh cell x-coordinate");
+  if (mesh_y < 0 || mesh_y >= N) error("Invalid mesh cell y-coordinate");
+#endif
+
+  return pm_mesh_pencil_owner(pencil, mesh_x, mesh_y);
+}
+
+/**
+ * @param Count how may mesh cells will end up on each rank of a pencil
+ * decomposition.
+ */
+void bucket_sort_mesh_key_value_rho_pencil_count_mapper(void *map_data,
+                                                        int nr_parts,
+                                                        void *extra_data) {
+
+  /* Unpack the data */
+  const struct mesh_key_value_rho *array_in =
+      (const struct mesh_key_value_rho *)map_data;
+  struct pencil_mapper_extra_data *data =
+      (struct pencil_mapper_extra_data *)extra_data;
+  const int nr_nodes = data->nr_nodes;
+  size_t *global_bucket_counts = data->bucket_counts;
+
+  /* Local buckets */
+  size_t *local_bucket_counts = (size_t *)calloc(nr_nodes, sizeof(size_t));
+
+  /* Count how many items will land in each bucket. */
+  for (int i = 0; i < nr_parts; ++i) {
+    const int rank = mesh_key_pencil_owner(array_in[i].key, data->pencil);
+    local_bucket_counts[rank]++;
+  }
+
+  /* Now write back to memory */
+  for (int i = 0; i < nr_nodes; ++i) {
+    atomic_add(&global_bucket_counts[i], local_bucket_counts[i]);
+  }
+
+  /* Clean up */
+  free(local_bucket_counts);
+}
+
+/**
+ * @param Count how may mesh cells will end up on each rank of a pencil
+ * decomposition.
+ */
+void bucket_sort_mesh_key_value_pot_pencil_count_mapper(void *map_data,
+                                                        int nr_parts,
+                                                        void *extra_data) {
+
+  /* Unpack the data */
+  const struct mesh_key_value_pot *array_in =
+      (const struct mesh_key_value_pot *)map_data;
+  struct pencil_mapper_extra_data *data =
+      (struct pencil_mapper_extra_data *)extra_data;
+  const int nr_nodes = data->nr_nodes;
+  size_t *global_bucket_counts = data->bucket_counts;
+
+  /* Local buckets */
+  size_t *local_bucket_counts = (size_t *)calloc(nr_nodes, sizeof(size_t));
+
+  /* Count how many items will land in each bucket. */
+  for (int i = 0; i < nr_parts; ++i) {
+    const int rank = mesh_key_pencil_owner(array_in[i].key, data->pencil);
+    local_bucket_counts[rank]++;
+  }
+
+  /* Now write back to memory */
+  for (int i = 0; i < nr_nodes; ++i) {
+    atomic_add(&global_bucket_counts[i], local_bucket_counts[i]);
+  }
+
+  /* Clean up */
+  free(local_bucket_counts);
+}
+
+/**
+ * @brief Bucket sort of the array of mesh cells based on the rank holding
+ * them in a pencil decomposition.
+ *
+ * Note the two mesh_key_value_rho arrays must be aligned on
+ * SWIFT_CACHE_ALIGNMENT.
+ *
+ * @param array_in The unsorted array of mesh-key value pairs.
+ * @param count The number of elements in the mesh-key value pair arrays.
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param nr_nodes The number of MPI ranks (i.e. of buckets).
+ * @param tp The #threadpool object.
+ * @param array_out The sorted array of mesh-key value pairs (to be filled).
+ * @param bucket_offsets The offsets in the sorted array where we change rank
+ * (to be filled).
+ */
+void bucket_sort_mesh_key_value_rho_pencil(
+    const struct mesh_key_value_rho *array_in, const size_t count,
+    const struct pm_mesh_pencil *pencil, const int nr_nodes,
+    struct threadpool *tp, struct mesh_key_value_rho *array_out,
+    size_t *bucket_offsets) {
+
+  /* Create an array of bucket counts */
+  size_t *bucket_counts = (size_t *)calloc(nr_nodes, sizeof(size_t));
+
+  struct pencil_mapper_extra_data extra_data;
+  extra_data.pencil = pencil;
+  extra_data.nr_nodes = nr_nodes;
+  extra_data.bucket_counts = bucket_counts;
+
+  /* Collect the number of items that will end up in each bucket */
+  threadpool_map(tp, bucket_sort_mesh_key_value_rho_pencil_count_mapper,
+                 (void *)array_in, count, sizeof(struct mesh_key_value_rho),
+                 threadpool_auto_chunk_size, &extra_data);
+
+  /* Now we can build the array of offsets (cumsum of the counts) */
+  bucket_offsets[0] = 0;
+  for (int i = 1; i < nr_nodes; ++i) {
+    bucket_offsets[i] = bucket_offsets[i - 1] + bucket_counts[i - 1];
+  }
+
+  /* Remind the compiler that the array is nicely aligned */
+  swift_declare_aligned_ptr(struct mesh_key_value_rho, array_out_aligned,
+                            array_out, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const struct mesh_key_value_rho, array_in_aligned,
+                            array_in, SWIFT_CACHE_ALIGNMENT);
+
+  /* Now, we can do the actual sorting */
+  for (size_t i = 0; i < count; ++i) {
+
+    const int rank = mesh_key_pencil_owner(array_in_aligned[i].key, pencil);
+
+    /* Copy the element to its correct position */
+    memcpy(&array_out_aligned[bucket_offsets[rank]], &array_in_aligned[i],
+           sizeof(struct mesh_key_value_rho));
+
+    /* Move the start of this bucket by one */
+    bucket_offsets[rank]++;
+  }
+
+  /* Restore the bucket offsets to their former glory */
+  for (int i = 0; i < nr_nodes; ++i) {
+    bucket_offsets[i] -= bucket_counts[i];
+  }
+
+  /* Clean up! */
+  free(bucket_counts);
+}
+
+/**
+ * @brief Bucket sort of the array of mesh cells based on the rank holding
+ * them in a pencil decomposition.
+ *
+ * Note the two mesh_key_value_pot arrays must be aligned on
+ * SWIFT_CACHE_ALIGNMENT.
+ *
+ * @param array_in The unsorted array of mesh-key value pairs.
+ * @param count The number of elements in the mesh-key value pair arrays.
+ * @param pencil The #pm_mesh_pencil decomposition.
+ * @param nr_nodes The number of MPI ranks (i.e. of buckets).
+ * @param tp The #threadpool object.
+ * @param array_out The sorted array of mesh-key value pairs (to be filled).
+ * @param bucket_offsets The offsets in the sorted array where we change rank
+ * (to be filled).
+ */
+void bucket_sort_mesh_key_value_pot_pencil(
+    const struct mesh_key_value_pot *array_in, const size_t count,
+    const struct pm_mesh_pencil *pencil, const int nr_nodes,
+    struct threadpool *tp, struct mesh_key_value_pot *array_out,
+    size_t *bucket_offsets) {
+
+  /* Create an array of bucket counts */
+  size_t *bucket_counts = (size_t *)calloc(nr_nodes, sizeof(size_t));
+
+  struct pencil_mapper_extra_data extra_data;
+  extra_data.pencil = pencil;
+  extra_data.nr_nodes = nr_nodes;
+  extra_data.bucket_counts = bucket_counts;
+
+  /* Collect the number of items that will end up in each bucket */
+  threadpool_map(tp, bucket_sort_mesh_key_value_pot_pencil_count_mapper,
+                 (void *)array_in, count, sizeof(struct mesh_key_value_pot),
+                 threadpool_auto_chunk_size, &extra_data);
+
+  /* Now we can build the array of offsets (cumsum of the counts) */
+  bucket_offsets[0] = 0;
+  for (int i = 1; i < nr_nodes; ++i) {
+    bucket_offsets[i] = bucket_offsets[i - 1] + bucket_counts[i - 1];
+  }
+
+  /* Remind the compiler that the array is nicely aligned */
+  swift_declare_aligned_ptr(struct mesh_key_value_pot, array_out_aligned,
+                            array_out, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(const struct mesh_key_value_pot, array_in_aligned,
+                            array_in, SWIFT_CACHE_ALIGNMENT);
+
+  /* Now, we can do the actual sorting */
+  for (size_t i = 0; i < count; ++i) {
+
+    const int rank = mesh_key_pencil_owner(array_in_aligned[i].key, pencil);
+
+    /* Copy the element to its correct position */
+    memcpy(&array_out_aligned[bucket_offsets[rank]], &array_in_aligned[i],
+           sizeof(struct mesh_key_value_pot));
+
+    /* Move the start of this bucket by one */
+    bucket_offsets[rank]++;
+  }
+
+  /* Restore the bucket offsets to their former glory */
+  for (int i = 0; i < nr_nodes; ++i) {
+    bucket_offsets[i] -= bucket_counts[i];
+  }
+
+  /* Clean up! */
+  free(bucket_counts);
+}
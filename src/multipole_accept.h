@@ -63,7 +63,7 @@ __attribute__((const)) INLINE static float gravity_f_MAC_inverse(
 
 /**
  * @brief Checks whether The multipole in B can be used to update the field
- * tensor in A.
+ * tensor in A given explicit sizes for the two multipoles.
  *
  * We use the MAC of Dehnen 2014 eq. 16.
  *
@@ -73,23 +73,19 @@ __attribute__((const)) INLINE static float gravity_f_MAC_inverse(
  * @param props The properties of the gravity scheme.
  * @param A The gravity tensors that we want to update (sink).
  * @param B The gravity tensors that act as a source.
+ * @param rho_A The size of the multipole A.
+ * @param rho_B The size of the multipole B.
  * @param r2 The square of the distance between the centres of mass of A and B.
- * @param use_rebuild_sizes Are we considering the sizes at the last tree-build
- * (1) or current sizes (0)?
  * @param periodic Are we using periodic BCs?
  */
-__attribute__((nonnull, pure)) INLINE static int gravity_M2L_accept(
+__attribute__((nonnull, pure)) INLINE static int gravity_M2L_accept_sizes(
     const struct gravity_props *props, const struct gravity_tensors *restrict A,
-    const struct gravity_tensors *restrict B, const float r2,
-    const int use_rebuild_sizes, const int periodic) {
+    const struct gravity_tensors *restrict B, const float rho_A,
+    const float rho_B, const float r2, const int periodic) {
 
   /* Order of the expansion */
   const int p = 2;
 
-  /* Sizes of the multipoles */
-  const float rho_A = use_rebuild_sizes ? A->r_max_rebuild : A->r_max;
-  const float rho_B = use_rebuild_sizes ? B->r_max_rebuild : B->r_max;
-
   /* Max size of both multipoles */
   const float rho_max = max(rho_A, rho_B);
 
@@ -182,6 +178,35 @@ __attribute__((nonnull, pure)) INLINE static int gravity_M2L_accept(
   }
 }
 
+/**
+ * @brief Checks whether The multipole in B can be used to update the field
+ * tensor in A.
+ *
+ * We use the MAC of Dehnen 2014 eq. 16.
+ *
+ * Note: this is *not* symmetric in A<->B unless the purely geometric criterion
+ * is used.
+ *
+ * @param props The properties of the gravity scheme.
+ * @param A The gravity tensors that we want to update (sink).
+ * @param B The gravity tensors that act as a source.
+ * @param r2 The square of the distance between the centres of mass of A and B.
+ * @param use_rebuild_sizes Are we considering the sizes at the last tree-build
+ * (1) or current sizes (0)?
+ * @param periodic Are we using periodic BCs?
+ */
+__attribute__((nonnull, pure)) INLINE static int gravity_M2L_accept(
+    const struct gravity_props *props, const struct gravity_tensors *restrict A,
+    const struct gravity_tensors *restrict B, const float r2,
+    const int use_rebuild_sizes, const int periodic) {
+
+  /* Sizes of the multipoles */
+  const float rho_A = use_rebuild_sizes ? A->r_max_rebuild : A->r_max;
+  const float rho_B = use_rebuild_sizes ? B->r_max_rebuild : B->r_max;
+
+  return gravity_M2L_accept_sizes(props, A, B, rho_A, rho_B, r2, periodic);
+}
+
 /**
  * @brief Checks whether The multipole in B can be used to update the field
  * tensor in A and whether the multipole in A can be used to update the field
@@ -38,6 +38,7 @@
 /* Local includes. */
 #include "cooling.h"
 #include "engine.h"
+#include "mesh_assignment.h"
 #include "minmax.h"
 #include "neutrino.h"
 #include "random.h"
@@ -50,6 +51,7 @@
 #define power_data_default_grid_side_length 256
 #define power_data_default_fold_factor 4
 #define power_data_default_window_order 3
+#define power_data_default_interlacing 0
 
 #ifdef HAVE_FFTW
 
@@ -160,6 +162,7 @@ struct grid_mapper_data {
   int N;
   enum power_type type;
   int windoworder;
+  double shift;
   double dim[3];
   double fac;
   const struct engine* e;
@@ -561,6 +564,41 @@ INLINE static void gpart_to_grid_CIC(const struct gpart* gp, double* rho,
   CIC_set(rho, N, i, j, k, tx, ty, tz, dx, dy, dz, value);
 }
 
+/**
+ * @brief Assigns a quantity to the (padded) power grid using a window of
+ * arbitrary order, optionally shifting the particle by a fraction of a grid
+ * cell (for interlacing).
+ */
+INLINE static void gpart_to_grid_window(const struct gpart* gp, double* rho,
+                                        const int N, const double fac,
+                                        const double dim[3], const int order,
+                                        const double shift,
+                                        const double value) {
+
+  /* Fold the particle position position */
+  const double pos_x = box_wrap_multiple(gp->x[0], 0., dim[0]) * fac + shift;
+  const double pos_y = box_wrap_multiple(gp->x[1], 0., dim[1]) * fac + shift;
+  const double pos_z = box_wrap_multiple(gp->x[2], 0., dim[2]) * fac + shift;
+
+  /* Workout the window weights */
+  double wx[MESH_ASSIGNMENT_MAX_ORDER], wy[MESH_ASSIGNMENT_MAX_ORDER],
+      wz[MESH_ASSIGNMENT_MAX_ORDER];
+  const int i = mesh_assignment_weights(order, pos_x, wx);
+  const int j = mesh_assignment_weights(order, pos_y, wy);
+  const int k = mesh_assignment_weights(order, pos_z, wz);
+
+  for (int a = 0; a < order; ++a) {
+    for (int b = 0; b < order; ++b) {
+      const double wxy = value * wx[a] * wy[b];
+      for (int c = 0; c < order; ++c) {
+        atomic_add_d(&rho[row_major_id_periodic_with_padding(i + a, j + b,
+                                                             k + c, N, 2)],
+                     wxy * wz[c]);
+      }
+    }
+  }
+}
+
 INLINE static void gpart_to_grid_NGP(const struct gpart* gp, double* rho,
                                      const int N, const double fac,
                                      const double dim[3], const double value) {
@@ -586,12 +624,14 @@ INLINE static void gpart_to_grid_NGP(const struct gpart* gp, double* rho,
  * @param fac Conversion factor of wrapped position to grid.
  * @param type The #power_type we want to assign to the grid.
  * @param windoworder The window to use for grid assignment.
+ * @param shift The shift of the particles in units of the grid cell size.
  * @param e The #engine.
  */
 void cell_to_powgrid(const struct cell* c, double* rho, const int N,
                      const double fac, const enum power_type type,
-                     const int windoworder, const double dim[3],
-                     const struct engine* e, struct neutrino_model* nu_model) {
+                     const int windoworder, const double shift,
+                     const double dim[3], const struct engine* e,
+                     struct neutrino_model* nu_model) {
 
   const int gcount = c->grav.count;
   const struct gpart* gparts = c->grav.parts;
@@ -641,6 +681,13 @@ void cell_to_powgrid(const struct cell* c, double* rho, const int N,
       quantity = gparts[i].mass * weight;
     }
 
+    /* Assign the quantity to the interlaced grid */
+    if (shift != 0.) {
+      gpart_to_grid_window(&gparts[i], rho, N, fac, dim, windoworder, shift,
+                           quantity);
+      continue;
+    }
+
     /* Assign the quantity to the grid */
     switch (windoworder) {
       case 1:
@@ -652,6 +699,10 @@ void cell_to_powgrid(const struct cell* c, double* rho, const int N,
       case 3:
         gpart_to_grid_TSC(&gparts[i], rho, N, fac, dim, quantity);
         break;
+      case 4:
+        gpart_to_grid_window(&gparts[i], rho, N, fac, dim, windoworder,
+                             /*shift=*/0., quantity);
+        break;
       default:
 #ifdef SWIFT_DEBUG_CHECKS
         error("Not implemented!");
@@ -678,6 +729,7 @@ void cell_to_powgrid_mapper(void* map_data, int num, void* extra) {
   const int Ngrid = data->N;
   const enum power_type type = data->type;
   const int order = data->windoworder;
+  const double shift = data->shift;
   const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
   const double gridfac = data->fac;
   const struct engine* e = data->e;
@@ -692,7 +744,8 @@ void cell_to_powgrid_mapper(void* map_data, int num, void* extra) {
     const struct cell* c = &cells[local_cells[i]];
 
     /* Assign this cell's content to the grid */
-    cell_to_powgrid(c, grid, Ngrid, gridfac, type, order, dim, e, nu_model);
+    cell_to_powgrid(c, grid, Ngrid, gridfac, type, order, shift, dim, e,
+                    nu_model);
   }
 }
 
@@ -808,6 +861,63 @@ void pow_from_grid_mapper(void* map_data, const int num, void* extra) {
   } /* Loop over z */
 }
 
+/**
+ * @brief Shared information needed to combine a Fourier grid with its
+ * interlaced counterpart.
+ */
+struct interlace_mapper_data {
+  fftw_complex* powgridft;
+  const fftw_complex* powgridft_shift;
+  int Ngrid;
+};
+
+/**
+ * @brief Mapper function averaging the Fourier grid with the one computed
+ * from the particles shifted by half a grid cell.
+ *
+ * @param map_data The array of the density field Fourier transform.
+ * @param num The number of elements to iterate on (along the x-axis).
+ * @param extra The #interlace_mapper_data.
+ */
+void interlace_grid_mapper(void* map_data, const int num, void* extra) {
+
+  const struct interlace_mapper_data* data =
+      (struct interlace_mapper_data*)extra;
+  fftw_complex* restrict powgridft = data->powgridft;
+  const fftw_complex* restrict powgridft_shift = data->powgridft_shift;
+  const int Ngrid = data->Ngrid;
+  const int Nhalf = Ngrid / 2;
+
+  /* Range handled by this call */
+  const int xi_start = (fftw_complex*)map_data - powgridft;
+  const int xi_end = xi_start + num;
+
+  for (int xi = xi_start; xi < xi_end; ++xi) {
+
+    int kx = xi;
+    if (kx > Nhalf) kx -= Ngrid;
+
+    for (int yi = 0; yi < Ngrid; ++yi) {
+
+      int ky = yi;
+      if (ky > Nhalf) ky -= Ngrid;
+
+      for (int zi = 0; zi < (Nhalf + 1); ++zi) {
+
+        double re, im;
+        mesh_interlacing_phase(kx, ky, zi, Ngrid, &re, &im);
+
+        const int index = (xi * Ngrid + yi) * (Nhalf + 1) + zi;
+        const double a = powgridft_shift[index][0];
+        const double b = powgridft_shift[index][1];
+
+        powgridft[index][0] = 0.5 * (powgridft[index][0] + a * re - b * im);
+        powgridft[index][1] = 0.5 * (powgridft[index][1] + a * im + b * re);
+      }
+    }
+  }
+}
+
 /**
  * @brief Initialize a power spectrum output file
  *
@@ -936,6 +1046,22 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
     pow_data->powgridft2 = pow_data->powgridft;
   }
 
+  /* When interlacing, we also need grid(s) for the particles shifted by half
+   * a grid cell */
+  double* powgrid_shift = NULL;
+  double* powgrid_shift2 = NULL;
+  if (pow_data->interlacing) {
+    powgrid_shift = fftw_alloc_real(Ngrid2 * (Ngrid + 2));
+    memuse_log_allocation("fftw_grid.grid_shift", powgrid_shift, 1,
+                          sizeof(double) * Ngrid2 * (Ngrid + 2));
+    if (type1 != type2) {
+      powgrid_shift2 = fftw_alloc_real(Ngrid2 * (Ngrid + 2));
+      memuse_log_allocation("fftw_grid.grid_shift2", powgrid_shift2, 1,
+                            sizeof(double) * Ngrid2 * (Ngrid + 2));
+    }
+  }
+  double* const shift_grids[2] = {powgrid_shift, powgrid_shift2};
+
   /* Constants used for the normalization */
   double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
   const double volume = dim[0] * dim[1] * dim[2]; /* units Mpc^3 */
@@ -975,6 +1101,7 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
   densdata.N = Ngrid;
   densdata.type = type1;
   densdata.windoworder = pow_data->windoworder;
+  densdata.shift = 0.;
   densdata.e = s->e;
   densdata.nu_model = &nu_model;
   if (type1 != type2) {
@@ -983,6 +1110,7 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
     densdata2.N = Ngrid;
     densdata2.type = type2;
     densdata2.windoworder = pow_data->windoworder;
+    densdata2.shift = 0.;
     densdata2.e = s->e;
     densdata2.nu_model = &nu_model;
   }
@@ -1102,6 +1230,28 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
       threadpool_map(tp, cell_to_powgrid_mapper, (void*)local_cells,
                      nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
                      (void*)&densdata2);
+
+    /* Same for the grid(s) of the shifted particles */
+    if (pow_data->interlacing) {
+
+      struct grid_mapper_data densdata_shift = densdata;
+      densdata_shift.dens = powgrid_shift;
+      densdata_shift.shift = 0.5;
+      bzero(powgrid_shift, Ngrid2 * (Ngrid + 2) * sizeof(double));
+      threadpool_map(tp, cell_to_powgrid_mapper, (void*)local_cells,
+                     nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                     (void*)&densdata_shift);
+
+      if (type1 != type2) {
+        struct grid_mapper_data densdata_shift2 = densdata2;
+        densdata_shift2.dens = powgrid_shift2;
+        densdata_shift2.shift = 0.5;
+        bzero(powgrid_shift2, Ngrid2 * (Ngrid + 2) * sizeof(double));
+        threadpool_map(tp, cell_to_powgrid_mapper, (void*)local_cells,
+                       nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                       (void*)&densdata_shift2);
+      }
+    }
 #ifdef WITH_MPI
     /* Merge everybody's share of the grid onto rank 0 */
     if (e->nodeID == 0)
@@ -1121,6 +1271,19 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
         MPI_Reduce(pow_data->powgrid2, NULL, Ngrid2 * (Ngrid + 2), MPI_DOUBLE,
                    MPI_SUM, 0, MPI_COMM_WORLD);
     }
+
+    /* And for the grid(s) of the shifted particles */
+    for (int g = 0; g < 2; ++g) {
+
+      if (shift_grids[g] == NULL) continue;
+
+      if (e->nodeID == 0)
+        MPI_Reduce(MPI_IN_PLACE, shift_grids[g], Ngrid2 * (Ngrid + 2),
+                   MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+      else
+        MPI_Reduce(shift_grids[g], NULL, Ngrid2 * (Ngrid + 2), MPI_DOUBLE,
+                   MPI_SUM, 0, MPI_COMM_WORLD);
+    }
 #endif
 
     /* Only rank 0 needs to perform all the remaining work */
@@ -1154,6 +1317,46 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
         fftw_execute_dft_r2c(pow_data->fftplanpow2, pow_data->powgrid2,
                              pow_data->powgridft2);
 
+      /* Average the grid(s) with the interlaced one(s) */
+      if (pow_data->interlacing) {
+
+        double* grids[2] = {pow_data->powgrid, pow_data->powgrid2};
+        const double invcellmeans[2] = {invcellmean, invcellmean2};
+
+        for (int g = 0; g < 2; ++g) {
+
+          if (shift_grids[g] == NULL) continue;
+
+          /* Convert mass to density contrast or pressure to eV/cm^3 */
+          convdata.grid = shift_grids[g];
+          convdata.invcellmean = invcellmeans[g];
+          if (Ngrid < 32) {
+            mass_to_contrast_mapper(shift_grids[g], Ngrid, &convdata);
+          } else {
+            threadpool_map(tp, mass_to_contrast_mapper, shift_grids[g], Ngrid,
+                           sizeof(double), threadpool_auto_chunk_size,
+                           &convdata);
+          }
+
+          /* FFT in-place */
+          fftw_execute_dft_r2c(pow_data->fftplanpow, shift_grids[g],
+                               (fftw_complex*)shift_grids[g]);
+
+          /* Combine with the normal grid */
+          struct interlace_mapper_data interdata;
+          interdata.powgridft = (fftw_complex*)grids[g];
+          interdata.powgridft_shift = (fftw_complex*)shift_grids[g];
+          interdata.Ngrid = Ngrid;
+          if (Ngrid < 32) {
+            interlace_grid_mapper(grids[g], Ngrid, &interdata);
+          } else {
+            threadpool_map(tp, interlace_grid_mapper, grids[g], Ngrid,
+                           sizeof(fftw_complex), threadpool_auto_chunk_size,
+                           &interdata);
+          }
+        }
+      }
+
       powmapdata.powgridft = pow_data->powgridft;
       powmapdata.powgridft2 = pow_data->powgridft2;
 
@@ -1264,6 +1467,14 @@ void power_spectrum(const enum power_type type1, const enum power_type type2,
   free(powersum);
   free(modecounts);
   free(kbin);
+  if (powgrid_shift != NULL) {
+    memuse_log_allocation("fftw_grid.grid_shift", powgrid_shift, 0, 0);
+    fftw_free(powgrid_shift);
+  }
+  if (powgrid_shift2 != NULL) {
+    memuse_log_allocation("fftw_grid.grid_shift2", powgrid_shift2, 0, 0);
+    fftw_free(powgrid_shift2);
+  }
   if (type1 != type2) {
     memuse_log_allocation("fftw_grid.grid2", pow_data->powgrid2, 0, 0);
     fftw_free(pow_data->powgrid2);
@@ -1301,7 +1512,10 @@ void power_init(struct power_spectrum_data* p, struct swift_params* params,
   p->windoworder = parser_get_opt_param_int(
       params, "PowerSpectrum:window_order", power_data_default_window_order);
 
-  if (p->windoworder > 3 || p->windoworder < 1)
+  p->interlacing = parser_get_opt_param_int(
+      params, "PowerSpectrum:interlacing", power_data_default_interlacing);
+
+  if (p->windoworder > 4 || p->windoworder < 1)
     error("Power spectrum calculation is not implemented for %dth order!",
           p->windoworder);
   if (p->windoworder == 1)
@@ -71,6 +71,9 @@ struct power_spectrum_data {
   /*! The order of the mass assignment window */
   int windoworder;
 
+  /*! Are we interlacing the grid with a grid shifted by half a cell? */
+  int interlacing;
+
   /* Shall we correct the position of the k-space bin? */
   int shift_centre_small_k_bins;
 
@@ -29,6 +29,8 @@
 #include "engine.h"
 #include "error.h"
 #include "restart.h"
+#include "restart_stream.h"
+#include "threadpool.h"
 #include "version.h"
 
 #include <errno.h>
@@ -52,6 +54,9 @@ struct header {
   char label[LABLEN + 1]; /* A label for data */
 };
 
+/* The restart file in the stream format being written or read, if any. */
+static struct restart_stream *restart_current_stream = NULL;
+
 /**
  * @brief generate a name for a restart file.
  *
@@ -130,6 +135,10 @@ void restart_write(struct engine *e, const char *filename) {
 
   ticks tic = getticks();
 
+  /* The previous dump may still be being written in the background. */
+  if (e->restart_async_writer != NULL)
+    io_async_writer_wait(e->restart_async_writer);
+
   /* Save a backup the existing restart file, if requested. */
   if (e->restart_save) restart_save_previous(filename);
 
@@ -156,6 +165,15 @@ void restart_write(struct engine *e, const char *filename) {
   if (stream == NULL)
     error("Failed to open restart file: %s (%s)", filename, strerror(errno));
 
+  /* Use independently compressed ranges written by all the threads? */
+  struct restart_stream rs;
+  const int use_stream = e->restart_stream_format;
+  if (use_stream) {
+    restart_stream_write_begin(&rs, stream, filename, e->restart_compression,
+                               &e->threadpool, e->restart_async_writer);
+    restart_current_stream = &rs;
+  }
+
   /* Dump our signature and version. */
   restart_write_blocks((void *)SWIFT_RESTART_SIGNATURE,
                        strlen(SWIFT_RESTART_SIGNATURE), 1, stream, "signature",
@@ -170,6 +188,16 @@ void restart_write(struct engine *e, const char *filename) {
                        strlen(SWIFT_RESTART_END_SIGNATURE), 1, stream,
                        "endsignature", "SWIFT end signature");
 
+  const int report = e->verbose || e->nodeID == 0;
+  if (use_stream) {
+    restart_current_stream = NULL;
+    restart_stream_write_end(&rs, report);
+  } else if (report) {
+    message("Wrote '%s': %.3f MB in %.3f %s.", filename,
+            ftell(stream) / (1024. * 1024.),
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+  }
+
   fclose(stream);
 
   if (e->verbose)
@@ -182,8 +210,9 @@ void restart_write(struct engine *e, const char *filename) {
  *
  * @param e the engine to recover from the saved state.
  * @param filename name of the file containing the staved state.
+ * @param nr_threads number of threads to decompress the file with.
  */
-void restart_read(struct engine *e, const char *filename) {
+void restart_read(struct engine *e, const char *filename, int nr_threads) {
 
   const ticks tic = getticks();
 
@@ -191,6 +220,13 @@ void restart_read(struct engine *e, const char *filename) {
   if (stream == NULL)
     error("Failed to open restart file: %s (%s)", filename, strerror(errno));
 
+  /* Files made of compressed ranges are decoded in parallel. */
+  struct threadpool tp;
+  struct restart_stream rs;
+  threadpool_init(&tp, nr_threads);
+  const int use_stream = restart_stream_read_begin(&rs, stream, filename, &tp);
+  if (use_stream) restart_current_stream = &rs;
+
   /* Get our version and signature back. These should match. */
   char signature[strlen(SWIFT_RESTART_SIGNATURE) + 1];
   int len = strlen(SWIFT_RESTART_SIGNATURE);
@@ -216,6 +252,17 @@ void restart_read(struct engine *e, const char *filename) {
         package_version(), version);
 
   engine_struct_restore(e, stream);
+
+  const int report = e->verbose || e->nodeID == 0;
+  if (use_stream) {
+    restart_current_stream = NULL;
+    restart_stream_read_end(&rs, report);
+  } else if (report) {
+    message("Read '%s': %.3f MB in %.3f %s.", filename,
+            ftell(stream) / (1024. * 1024.),
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+  }
+  threadpool_clean(&tp);
   fclose(stream);
 
   if (e->verbose)
@@ -239,11 +286,18 @@ void restart_read(struct engine *e, const char *filename) {
 void restart_read_blocks(void *ptr, size_t size, size_t nblocks, FILE *stream,
                          char *label, const char *errstr) {
   if (size > 0) {
+    struct restart_stream *rs = restart_current_stream;
+    if (rs != NULL && rs->file != stream) rs = NULL;
+
     struct header head;
-    size_t nread = fread(&head, sizeof(struct header), 1, stream);
-    if (nread != 1)
-      error("Failed to read the %s header from restart file (%s)", errstr,
-            strerror(errno));
+    if (rs != NULL) {
+      restart_stream_read(rs, &head, sizeof(struct header), errstr);
+    } else {
+      size_t nread = fread(&head, sizeof(struct header), 1, stream);
+      if (nread != 1)
+        error("Failed to read the %s header from restart file (%s)", errstr,
+              strerror(errno));
+    }
 
     /* Check that the stored length is the same as the expected one. */
     if (head.len != nblocks * size)
@@ -256,7 +310,12 @@ void restart_read_blocks(void *ptr, size_t size, size_t nblocks, FILE *stream,
       strncpy(label, head.label, LABLEN + 1);
     }
 
-    nread = fread(ptr, size, nblocks, stream);
+    if (rs != NULL) {
+      restart_stream_read(rs, ptr, nblocks * size, errstr);
+      return;
+    }
+
+    const size_t nread = fread(ptr, size, nblocks, stream);
     if (nread != nblocks)
       error("Failed to restore %s from restart file (%s)", errstr,
             ferror(stream) ? strerror(errno) : "unexpected end of file");
@@ -281,10 +340,20 @@ void restart_write_blocks(void *ptr, size_t size, size_t nblocks, FILE *stream,
 
     /* Add a preamble header. */
     struct header head;
+    bzero(&head, sizeof(struct header));
     head.len = nblocks * size;
     strncpy(head.label, label, LABLEN);
     head.label[LABLEN] = '\0';
 
+    /* Part of a file made of compressed ranges? */
+    if (restart_current_stream != NULL &&
+        restart_current_stream->file == stream) {
+      restart_stream_write(restart_current_stream, &head,
+                           sizeof(struct header));
+      restart_stream_write(restart_current_stream, ptr, nblocks * size);
+      return;
+    }
+
     /* Now dump it and the data. */
     size_t nwrite = fwrite(&head, sizeof(struct header), 1, stream);
     if (nwrite != 1)
@@ -24,7 +24,7 @@
 struct engine;
 
 void restart_write(struct engine *e, const char *filename);
-void restart_read(struct engine *e, const char *filename);
+void restart_read(struct engine *e, const char *filename, int nr_threads);
 
 char **restart_locate(const char *dir, const char *basename, int *nfiles);
 void restart_locate_free(int nfiles, char **files);
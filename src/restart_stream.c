@@ -0,0 +1,686 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/**
+ *  @file restart_stream.c
+ *  @brief Restart files made of independently compressed ranges.
+ */
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "restart_stream.h"
+
+/* Local includes. */
+#include "atomic.h"
+#include "clocks.h"
+#include "error.h"
+#include "io_async_writer.h"
+#include "threadpool.h"
+
+/* Some standard headers. */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/* The signatures at the start and at the end of a stream file. */
+#define RESTART_STREAM_SIGNATURE "SWIFT-restart-stream"
+#define RESTART_STREAM_END_SIGNATURE "SWIFT-restart-stream:end"
+#define RESTART_STREAM_SIGLEN 32
+
+/**
+ * @brief Check whether a file starts with the signature of the stream
+ * format.
+ */
+static int restart_stream_has_signature(int fd) {
+  char signature[RESTART_STREAM_SIGLEN];
+  if (pread(fd, signature, RESTART_STREAM_SIGLEN, 0) != RESTART_STREAM_SIGLEN)
+    return 0;
+  return strncmp(signature, RESTART_STREAM_SIGNATURE, RESTART_STREAM_SIGLEN) ==
+         0;
+}
+
+#ifdef HAVE_ZLIB
+
+/**
+ * @brief The footer at the end of a stream file, locating the index.
+ */
+struct restart_stream_footer {
+
+  /*! Offset of the index in the file. */
+  uint64_t index_offset;
+
+  /*! Number of ranges in the index. */
+  uint64_t nr_ranges;
+
+  /*! Total number of bytes of the stream. */
+  uint64_t raw_size;
+
+  /*! CRC-32 of the index. */
+  uint32_t index_checksum;
+
+  /*! Unused, keeps the signature aligned. */
+  uint32_t padding;
+
+  /*! #RESTART_STREAM_END_SIGNATURE, to spot truncated files. */
+  char signature[RESTART_STREAM_SIGLEN];
+};
+
+/**
+ * @brief A range to (de-)compress in parallel.
+ */
+struct restart_range_job {
+
+  /*! Index of the range. */
+  size_t index;
+
+  /*! The raw bytes to write, or where to put the bytes read. */
+  char *data;
+
+  /*! Number of raw bytes. */
+  size_t size;
+
+  /*! Is data a staging buffer to free once written? */
+  int owned;
+};
+
+/**
+ * @brief CRC-32 of a range of raw bytes.
+ */
+static uint32_t restart_stream_checksum(const void *data, size_t size) {
+  return crc32(crc32(0L, Z_NULL, 0), (const Bytef *)data, (uInt)size);
+}
+
+/**
+ * @brief Write all the bytes of a buffer at a given offset in a file.
+ */
+static void restart_stream_pwrite(int fd, const void *buffer, size_t bytes,
+                                  size_t offset, const char *name) {
+  size_t done = 0;
+  while (done < bytes) {
+    const ssize_t n =
+        pwrite(fd, (const char *)buffer + done, bytes - done, offset + done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0)
+      error("Failed to write to restart file '%s' (%s)", name,
+            strerror(errno));
+    done += n;
+  }
+}
+
+/**
+ * @brief Read all the bytes of a buffer from a given offset in a file.
+ */
+static void restart_stream_pread(int fd, void *buffer, size_t bytes,
+                                 size_t offset, const char *name) {
+  size_t done = 0;
+  while (done < bytes) {
+    const ssize_t n =
+        pread(fd, (char *)buffer + done, bytes - done, offset + done);
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0)
+      error("Failed to read from restart file '%s' (%s)", name,
+            strerror(errno));
+    if (n == 0)
+      error("Failed to read from restart file '%s' (unexpected end of file)",
+            name);
+    done += n;
+  }
+}
+
+/**
+ * @brief Write a buffer at a given offset, or queue it for the background
+ * writer.
+ *
+ * @param rs The #restart_stream.
+ * @param buffer The bytes to write.
+ * @param bytes The number of bytes.
+ * @param offset The offset in the file.
+ * @param owned Was the buffer allocated with malloc() for this write only?
+ * If so, it is freed once written.
+ */
+static void restart_stream_put(struct restart_stream *rs, void *buffer,
+                               size_t bytes, size_t offset, int owned) {
+
+  if (bytes == 0) {
+    if (owned) free(buffer);
+    return;
+  }
+
+  if (rs->async != NULL) {
+
+    /* The writer needs a buffer of its own. */
+    if (!owned) {
+      void *copy = malloc(bytes);
+      if (copy == NULL) error("Failed to allocate a restart file buffer.");
+      memcpy(copy, buffer, bytes);
+      buffer = copy;
+    }
+    io_async_writer_write_file(rs->async, rs->fd, offset, buffer, bytes,
+                               rs->name);
+
+  } else {
+    restart_stream_pwrite(rs->fd, buffer, bytes, offset, rs->name);
+    if (owned) free(buffer);
+  }
+}
+
+/**
+ * @brief Add a range to the list of those to process in parallel.
+ */
+static void restart_stream_add_job(struct restart_stream *rs, size_t index,
+                                   char *data, size_t size, int owned) {
+
+  if (rs->nr_pending == rs->size_pending) {
+    rs->size_pending = rs->size_pending > 0 ? 2 * rs->size_pending : 64;
+    rs->pending = (struct restart_range_job *)realloc(
+        rs->pending, rs->size_pending * sizeof(struct restart_range_job));
+    if (rs->pending == NULL) error("Failed to allocate restart range jobs.");
+  }
+
+  struct restart_range_job *job = &rs->pending[rs->nr_pending++];
+  job->index = index;
+  job->data = data;
+  job->size = size;
+  job->owned = owned;
+}
+
+/**
+ * @brief Add a new range at the end of the stream and queue it for writing.
+ */
+static void restart_stream_new_range(struct restart_stream *rs, char *data,
+                                     size_t size, int owned) {
+
+  if (rs->nr_ranges == rs->size_ranges) {
+    rs->size_ranges = rs->size_ranges > 0 ? 2 * rs->size_ranges : 64;
+    rs->ranges = (struct restart_range *)realloc(
+        rs->ranges, rs->size_ranges * sizeof(struct restart_range));
+    if (rs->ranges == NULL) error("Failed to allocate restart file index.");
+  }
+
+  restart_stream_add_job(rs, rs->nr_ranges++, data, size, owned);
+  rs->raw_size += size;
+}
+
+/**
+ * @brief Compress, check-sum and write ranges of the stream.
+ *
+ * Each thread reserves the space for its ranges in the file once it knows
+ * their compressed size, so the ranges are written concurrently and in no
+ * particular order.
+ */
+static void restart_stream_write_mapper(void *map_data, int num_elements,
+                                        void *extra_data) {
+
+  struct restart_stream *rs = (struct restart_stream *)extra_data;
+  struct restart_range_job *jobs = (struct restart_range_job *)map_data;
+
+  for (int k = 0; k < num_elements; k++) {
+    struct restart_range_job *job = &jobs[k];
+    struct restart_range *r = &rs->ranges[job->index];
+
+    r->raw_size = job->size;
+    r->checksum = restart_stream_checksum(job->data, job->size);
+    r->compressed = 0;
+
+    void *out = job->data;
+    size_t out_size = job->size;
+    int out_owned = job->owned;
+
+    /* Keep the compressed bytes unless they do not save anything. */
+    if (rs->level > 0) {
+      uLongf size = compressBound(job->size);
+      Bytef *compressed = (Bytef *)malloc(size);
+      if (compressed == NULL) error("Failed to allocate a compression buffer.");
+
+      if (compress2(compressed, &size, (const Bytef *)job->data, job->size,
+                    rs->level) == Z_OK &&
+          size < job->size) {
+        if (job->owned) free(job->data);
+        out = compressed;
+        out_size = size;
+        out_owned = 1;
+        r->compressed = 1;
+      } else {
+        free(compressed);
+      }
+    }
+
+    r->stored_size = out_size;
+    r->offset = atomic_add(&rs->file_offset, out_size);
+    restart_stream_put(rs, out, out_size, r->offset, out_owned);
+  }
+}
+
+/**
+ * @brief Compress and write all the pending ranges.
+ */
+static void restart_stream_flush(struct restart_stream *rs) {
+  if (rs->nr_pending == 0) return;
+  threadpool_map(rs->tp, restart_stream_write_mapper, rs->pending,
+                 rs->nr_pending, sizeof(struct restart_range_job),
+                 /*chunk=*/1, rs);
+  rs->nr_pending = 0;
+}
+
+/**
+ * @brief Read, decompress and verify one range.
+ */
+static void restart_stream_decode(struct restart_stream *rs,
+                                  const struct restart_range_job *job) {
+
+  const struct restart_range *r = &rs->ranges[job->index];
+
+  if (r->compressed) {
+    Bytef *in = (Bytef *)malloc(r->stored_size);
+    if (in == NULL) error("Failed to allocate a decompression buffer.");
+    restart_stream_pread(rs->fd, in, r->stored_size, r->offset, rs->name);
+
+    uLongf size = job->size;
+    if (uncompress((Bytef *)job->data, &size, in, r->stored_size) != Z_OK ||
+        size != job->size)
+      error("Failed to decompress range %zu of restart file '%s'.",
+            job->index, rs->name);
+    free(in);
+
+  } else {
+    restart_stream_pread(rs->fd, job->data, job->size, r->offset, rs->name);
+  }
+
+  if (restart_stream_checksum(job->data, job->size) != r->checksum)
+    error("Check-sum mismatch in range %zu of restart file '%s'.", job->index,
+          rs->name);
+}
+
+/**
+ * @brief Read, decompress and verify ranges of the stream.
+ */
+static void restart_stream_read_mapper(void *map_data, int num_elements,
+                                       void *extra_data) {
+
+  struct restart_stream *rs = (struct restart_stream *)extra_data;
+  struct restart_range_job *jobs = (struct restart_range_job *)map_data;
+
+  for (int k = 0; k < num_elements; k++) restart_stream_decode(rs, &jobs[k]);
+}
+
+#endif /* HAVE_ZLIB */
+
+/**
+ * @brief Can restart files be written in the stream format with this build?
+ *
+ * @return 1 if zlib is available, 0 otherwise.
+ */
+int restart_stream_is_supported(void) {
+#ifdef HAVE_ZLIB
+  return 1;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * @brief Start writing a restart file in the stream format.
+ *
+ * @param rs The #restart_stream to initialise.
+ * @param file The opened (empty) restart file.
+ * @param name The name of the file.
+ * @param level Deflate level of the ranges, 0 to store them uncompressed.
+ * @param tp The #threadpool compressing and writing the ranges.
+ * @param async If not NULL, the writer to leave the writes to.
+ */
+void restart_stream_write_begin(struct restart_stream *rs, FILE *file,
+                                const char *name, int level,
+                                struct threadpool *tp,
+                                struct io_async_writer *async) {
+#ifdef HAVE_ZLIB
+  bzero(rs, sizeof(struct restart_stream));
+  rs->tic = getticks();
+  rs->file = file;
+  rs->tp = tp;
+  rs->async = async;
+  rs->level = level;
+  strncpy(rs->name, name, sizeof(rs->name) - 1);
+
+  /* The file may be closed by the background writer after the stream
+   * itself. */
+  rs->fd = dup(fileno(file));
+  if (rs->fd < 0)
+    error("Failed to duplicate restart file descriptor (%s)", strerror(errno));
+
+  /* The signature comes first, followed by the ranges. */
+  char signature[RESTART_STREAM_SIGLEN];
+  bzero(signature, RESTART_STREAM_SIGLEN);
+  strcpy(signature, RESTART_STREAM_SIGNATURE);
+  restart_stream_put(rs, signature, RESTART_STREAM_SIGLEN, 0, /*owned=*/0);
+  rs->file_offset = RESTART_STREAM_SIGLEN;
+#else
+  error("Writing restart files in the stream format requires zlib.");
+#endif
+}
+
+/**
+ * @brief Append some bytes to a restart file in the stream format.
+ *
+ * The bytes are gathered in a staging buffer unless they fill whole ranges,
+ * which are then compressed straight from the caller's memory before
+ * returning.
+ *
+ * @param rs The #restart_stream.
+ * @param ptr The bytes to write.
+ * @param bytes The number of bytes.
+ */
+void restart_stream_write(struct restart_stream *rs, const void *ptr,
+                          size_t bytes) {
+#ifdef HAVE_ZLIB
+  const char *p = (const char *)ptr;
+  int direct = 0;
+
+  while (bytes > 0) {
+    if (rs->staged == 0 && bytes >= RESTART_STREAM_RANGE_SIZE) {
+
+      /* A whole range we can compress where it is. */
+      restart_stream_new_range(rs, (char *)p, RESTART_STREAM_RANGE_SIZE,
+                               /*owned=*/0);
+      p += RESTART_STREAM_RANGE_SIZE;
+      bytes -= RESTART_STREAM_RANGE_SIZE;
+      direct = 1;
+
+    } else {
+
+      if (rs->staging == NULL) {
+        rs->staging = (char *)malloc(RESTART_STREAM_RANGE_SIZE);
+        if (rs->staging == NULL)
+          error("Failed to allocate a restart staging buffer.");
+      }
+
+      const size_t n = bytes < RESTART_STREAM_RANGE_SIZE - rs->staged
+                           ? bytes
+                           : RESTART_STREAM_RANGE_SIZE - rs->staged;
+      memcpy(rs->staging + rs->staged, p, n);
+      rs->staged += n;
+      p += n;
+      bytes -= n;
+
+      if (rs->staged == RESTART_STREAM_RANGE_SIZE) {
+        restart_stream_new_range(rs, rs->staging, RESTART_STREAM_RANGE_SIZE,
+                                 /*owned=*/1);
+        rs->staging = NULL;
+        rs->staged = 0;
+      }
+    }
+  }
+
+  /* Ranges pointing to the caller's memory must be written before we
+   * return. The staged ones wait until there is one for each thread. */
+  if (direct || rs->nr_pending >= rs->tp->num_threads)
+    restart_stream_flush(rs);
+#else
+  error("Writing restart files in the stream format requires zlib.");
+#endif
+}
+
+/**
+ * @brief Complete a restart file in the stream format.
+ *
+ * Writes the last ranges, the index and the footer, and closes the file
+ * descriptor, or queues all that for the background writer.
+ *
+ * @param rs The #restart_stream.
+ * @param verbose Whether to report on the file.
+ */
+void restart_stream_write_end(struct restart_stream *rs, int verbose) {
+#ifdef HAVE_ZLIB
+  if (rs->staged > 0)
+    restart_stream_new_range(rs, rs->staging, rs->staged, /*owned=*/1);
+  else
+    free(rs->staging);
+  rs->staging = NULL;
+  rs->staged = 0;
+  restart_stream_flush(rs);
+
+  /* The index and footer. */
+  const size_t index_bytes = rs->nr_ranges * sizeof(struct restart_range);
+  struct restart_stream_footer footer;
+  bzero(&footer, sizeof(struct restart_stream_footer));
+  footer.index_offset = rs->file_offset;
+  footer.nr_ranges = rs->nr_ranges;
+  footer.raw_size = rs->raw_size;
+  footer.index_checksum = restart_stream_checksum(rs->ranges, index_bytes);
+  strcpy(footer.signature, RESTART_STREAM_END_SIGNATURE);
+
+  restart_stream_put(rs, rs->ranges, index_bytes, rs->file_offset,
+                     /*owned=*/0);
+  restart_stream_put(rs, &footer, sizeof(struct restart_stream_footer),
+                     rs->file_offset + index_bytes, /*owned=*/0);
+  const size_t file_size = rs->file_offset + index_bytes +
+                           sizeof(struct restart_stream_footer);
+
+  if (rs->async != NULL) {
+    io_async_writer_close_file(rs->async, rs->fd, rs->name);
+  } else if (close(rs->fd) != 0) {
+    error("Failed to close restart file '%s' (%s)", rs->name,
+          strerror(errno));
+  }
+
+  if (verbose) {
+    const double time = clocks_from_ticks(getticks() - rs->tic);
+    message(
+        "%s '%s': %.3f MB (%.3f MB uncompressed, %zu ranges) in %.3f %s "
+        "(%.3f MB/s)%s.",
+        rs->async != NULL ? "Compressed" : "Wrote", rs->name,
+        file_size / (1024. * 1024.), rs->raw_size / (1024. * 1024.),
+        rs->nr_ranges, time, clocks_getunit(),
+        time > 0. ? rs->raw_size / (1024. * 1024.) / (time / 1000.) : 0.,
+        rs->async != NULL ? ", writing it in the background" : "");
+  }
+
+  free(rs->ranges);
+  free(rs->pending);
+  rs->ranges = NULL;
+  rs->pending = NULL;
+#else
+  error("Writing restart files in the stream format requires zlib.");
+#endif
+}
+
+/**
+ * @brief Start reading a restart file, if it is in the stream format.
+ *
+ * Verifies the footer and loads the index of the ranges.
+ *
+ * @param rs The #restart_stream to initialise.
+ * @param file The opened restart file.
+ * @param name The name of the file.
+ * @param tp The #threadpool decompressing the ranges.
+ *
+ * @return 1 if the file is in the stream format, 0 if it is a plain restart
+ * file, in which case the file is left untouched.
+ */
+int restart_stream_read_begin(struct restart_stream *rs, FILE *file,
+                              const char *name, struct threadpool *tp) {
+
+  if (!restart_stream_has_signature(fileno(file))) return 0;
+
+#ifdef HAVE_ZLIB
+  bzero(rs, sizeof(struct restart_stream));
+  rs->tic = getticks();
+  rs->file = file;
+  rs->fd = fileno(file);
+  rs->tp = tp;
+  strncpy(rs->name, name, sizeof(rs->name) - 1);
+
+  struct stat buf;
+  if (fstat(rs->fd, &buf) != 0)
+    error("Failed to stat restart file '%s' (%s)", name, strerror(errno));
+  const size_t file_size = buf.st_size;
+  if (file_size < RESTART_STREAM_SIGLEN + sizeof(struct restart_stream_footer))
+    error("Restart file '%s' is truncated.", name);
+
+  struct restart_stream_footer footer;
+  restart_stream_pread(rs->fd, &footer, sizeof(struct restart_stream_footer),
+                       file_size - sizeof(struct restart_stream_footer), name);
+  if (strncmp(footer.signature, RESTART_STREAM_END_SIGNATURE,
+              RESTART_STREAM_SIGLEN) != 0)
+    error("Restart file '%s' is truncated (no end signature).", name);
+
+  const size_t index_bytes = footer.nr_ranges * sizeof(struct restart_range);
+  if (footer.index_offset + index_bytes +
+          sizeof(struct restart_stream_footer) !=
+      file_size)
+    error("Inconsistent index in restart file '%s'.", name);
+
+  rs->nr_ranges = footer.nr_ranges;
+  rs->size_ranges = footer.nr_ranges;
+  rs->raw_size = footer.raw_size;
+  rs->file_offset = file_size;
+  rs->ranges = (struct restart_range *)malloc(index_bytes);
+  if (rs->ranges == NULL && index_bytes > 0)
+    error("Failed to allocate restart file index.");
+  restart_stream_pread(rs->fd, rs->ranges, index_bytes, footer.index_offset,
+                       name);
+  if (restart_stream_checksum(rs->ranges, index_bytes) !=
+      footer.index_checksum)
+    error("Check-sum mismatch in the index of restart file '%s'.", name);
+
+  for (size_t k = 0; k < rs->nr_ranges; k++)
+    if (rs->ranges[k].raw_size > RESTART_STREAM_RANGE_SIZE)
+      error("Range %zu of restart file '%s' is too large.", k, name);
+
+  return 1;
+#else
+  error("Reading restart file '%s' in the stream format requires zlib.",
+        name);
+  return 0;
+#endif
+}
+
+/**
+ * @brief Read some bytes from a restart file in the stream format.
+ *
+ * The ranges lying entirely inside the requested bytes are decompressed in
+ * parallel straight into the destination.
+ *
+ * @param rs The #restart_stream.
+ * @param ptr Where to put the bytes.
+ * @param bytes The number of bytes.
+ * @param errstr A context string to qualify any errors.
+ */
+void restart_stream_read(struct restart_stream *rs, void *ptr, size_t bytes,
+                         const char *errstr) {
+#ifdef HAVE_ZLIB
+  char *p = (char *)ptr;
+
+  while (bytes > 0) {
+
+    /* Anything left in the current range? */
+    if (rs->buffer_pos < rs->buffer_size) {
+      const size_t n = bytes < rs->buffer_size - rs->buffer_pos
+                           ? bytes
+                           : rs->buffer_size - rs->buffer_pos;
+      memcpy(p, rs->buffer + rs->buffer_pos, n);
+      rs->buffer_pos += n;
+      p += n;
+      bytes -= n;
+      continue;
+    }
+
+    if (rs->next_range == rs->nr_ranges)
+      error("Failed to restore %s from restart file (unexpected end of file)",
+            errstr);
+
+    /* Decode the whole ranges we need directly into place. */
+    size_t covered = 0;
+    while (rs->next_range < rs->nr_ranges &&
+           covered + rs->ranges[rs->next_range].raw_size <= bytes) {
+      restart_stream_add_job(rs, rs->next_range, p + covered,
+                             rs->ranges[rs->next_range].raw_size,
+                             /*owned=*/0);
+      covered += rs->ranges[rs->next_range].raw_size;
+      rs->next_range++;
+    }
+
+    if (rs->nr_pending > 0) {
+      threadpool_map(rs->tp, restart_stream_read_mapper, rs->pending,
+                     rs->nr_pending, sizeof(struct restart_range_job),
+                     /*chunk=*/1, rs);
+      rs->nr_pending = 0;
+      p += covered;
+      bytes -= covered;
+      continue;
+    }
+
+    /* Otherwise go through the buffer. */
+    if (rs->buffer == NULL) {
+      rs->buffer = (char *)malloc(RESTART_STREAM_RANGE_SIZE);
+      if (rs->buffer == NULL)
+        error("Failed to allocate a restart read buffer.");
+    }
+    struct restart_range_job job;
+    job.index = rs->next_range;
+    job.data = rs->buffer;
+    job.size = rs->ranges[rs->next_range].raw_size;
+    job.owned = 0;
+    restart_stream_decode(rs, &job);
+    rs->buffer_size = job.size;
+    rs->buffer_pos = 0;
+    rs->next_range++;
+  }
+#else
+  error("Reading restart files in the stream format requires zlib.");
+#endif
+}
+
+/**
+ * @brief Finish reading a restart file in the stream format.
+ *
+ * The file itself is left open.
+ *
+ * @param rs The #restart_stream.
+ * @param verbose Whether to report on the file.
+ */
+void restart_stream_read_end(struct restart_stream *rs, int verbose) {
+#ifdef HAVE_ZLIB
+  if (verbose) {
+    const double time = clocks_from_ticks(getticks() - rs->tic);
+    message(
+        "Read '%s': %.3f MB (%.3f MB uncompressed, %zu ranges) in %.3f %s "
+        "(%.3f MB/s).",
+        rs->name, rs->file_offset / (1024. * 1024.),
+        rs->raw_size / (1024. * 1024.), rs->nr_ranges, time, clocks_getunit(),
+        time > 0. ? rs->raw_size / (1024. * 1024.) / (time / 1000.) : 0.);
+  }
+
+  free(rs->ranges);
+  free(rs->pending);
+  free(rs->buffer);
+  rs->ranges = NULL;
+  rs->pending = NULL;
+  rs->buffer = NULL;
+#else
+  error("Reading restart files in the stream format requires zlib.");
+#endif
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_RESTART_STREAM_H
+#define SWIFT_RESTART_STREAM_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Local includes. */
+#include "cycle.h"
+
+/* Forward declarations. */
+struct io_async_writer;
+struct threadpool;
+
+/*! Number of bytes of the stream in each independently compressed range. */
+#define RESTART_STREAM_RANGE_SIZE (4 * 1024 * 1024)
+
+/**
+ * @brief A range of the restart stream as stored in the file.
+ */
+struct restart_range {
+
+  /*! Offset of the stored bytes in the file. */
+  uint64_t offset;
+
+  /*! Number of bytes in the file and once decompressed. */
+  uint64_t stored_size, raw_size;
+
+  /*! CRC-32 of the decompressed bytes. */
+  uint32_t checksum;
+
+  /*! Were the bytes deflated (1) or stored as they are (0)? */
+  uint32_t compressed;
+};
+
+/**
+ * @brief A restart file made of independently compressed ranges.
+ *
+ * The restart data is the same stream of labelled blocks as in the plain
+ * format, but is cut into ranges of #RESTART_STREAM_RANGE_SIZE bytes that
+ * are deflated, check-summed and written by the threads of a threadpool.
+ * Ranges lying entirely inside a large block (e.g. the particle arrays) are
+ * compressed straight from memory, the small blocks are gathered in staging
+ * buffers. The ranges end up in the file in the order in which they were
+ * completed and are located through an index written at the end of the
+ * file, followed by a footer.
+ *
+ * Reading mirrors this: ranges covering a large block are read, inflated
+ * and verified in parallel straight into the destination memory.
+ */
+struct restart_stream {
+
+  /*! The stream passed to the dump and restore functions. */
+  FILE *file;
+
+  /*! File descriptor used for all the actual reads and writes. */
+  int fd;
+
+  /*! Name of the file, for the messages. */
+  char name[200];
+
+  /*! Threads used to (de-)compress the ranges. */
+  struct threadpool *tp;
+
+  /*! If not NULL, the writes are left to this background writer. */
+  struct io_async_writer *async;
+
+  /*! Deflate level, 0 to store the ranges uncompressed. */
+  int level;
+
+  /*! The index of the ranges. */
+  struct restart_range *ranges;
+  size_t nr_ranges, size_ranges;
+
+  /*! Next free offset in the file. */
+  size_t file_offset;
+
+  /*! Total number of bytes of the stream. */
+  size_t raw_size;
+
+  /*! Range being filled with small blocks. */
+  char *staging;
+  size_t staged;
+
+  /*! Ranges waiting to be compressed and written. */
+  struct restart_range_job *pending;
+  int nr_pending, size_pending;
+
+  /*! Decoded range from which the small blocks are read back. */
+  char *buffer;
+  size_t buffer_size, buffer_pos;
+
+  /*! Next range to read. */
+  size_t next_range;
+
+  /*! Time spent since the file was opened. */
+  ticks tic;
+};
+
+int restart_stream_is_supported(void);
+
+void restart_stream_write_begin(struct restart_stream *rs, FILE *file,
+                                const char *name, int level,
+                                struct threadpool *tp,
+                                struct io_async_writer *async);
+void restart_stream_write(struct restart_stream *rs, const void *ptr,
+                          size_t bytes);
+void restart_stream_write_end(struct restart_stream *rs, int verbose);
+
+int restart_stream_read_begin(struct restart_stream *rs, FILE *file,
+                              const char *name, struct threadpool *tp);
+void restart_stream_read(struct restart_stream *rs, void *ptr, size_t bytes,
+                         const char *errstr);
+void restart_stream_read_end(struct restart_stream *rs, int verbose);
+
+#endif /* SWIFT_RESTART_STREAM_H */
@@ -29,6 +29,8 @@
 /* Local headers. */
 #include "cache.h"
 #include "gravity_cache.h"
+#include "hydro_hot_cache.h"
+#include "hydro_nlist.h"
 
 struct cell;
 struct engine;
@@ -49,6 +51,16 @@ struct task;
 #define TASK_LOOP_RT_GRADIENT 11
 #define TASK_LOOP_RT_TRANSPORT 12
 
+/**
+ * @brief The ways the sort arrays of a leaf cell can be (re-)built.
+ */
+enum runner_sort_type {
+  runner_sort_full,          /* Sorted from scratch */
+  runner_sort_repaired,      /* Previous order repaired */
+  runner_sort_repair_failed, /* Repair given up, then sorted from scratch */
+  runner_sort_count
+};
+
 /**
  * @brief A struct representing a runner's thread and its data.
  */
@@ -72,9 +84,27 @@ struct runner {
   /*! The particle gravity_cache of cell cj. */
   struct gravity_cache cj_gravity_cache;
 
+  /*! The hydro neighbour search cache of cell ci. */
+  struct hydro_hot_cache ci_hot_cache;
+
+  /*! The hydro neighbour search cache of cell cj. */
+  struct hydro_hot_cache cj_hot_cache;
+
   /*! Time this runner was active during the last engine_launch. */
   ticks active_time;
 
+  /*! Number of leaf sort arrays built in each way during the last
+   * engine_launch. */
+  int sort_counts[runner_sort_count];
+
+  /*! Number of sub-cell pairs of hydro tasks skipped during the last
+   * engine_launch. */
+  int culled_subpairs;
+
+  /*! The neighbour lists built by this runner during the current
+   * engine_launch. */
+  struct hydro_nlist_arena nlist_arena;
+
 #ifdef WITH_VECTORIZATION
 
   /*! The particle cache of cell ci. */
@@ -99,6 +129,8 @@ void runner_do_black_holes_density_ghost(struct runner *r, struct cell *c,
 void runner_do_black_holes_swallow_ghost(struct runner *r, struct cell *c,
                                          int timer);
 void runner_do_init_grav(struct runner *r, struct cell *c, int timer);
+void runner_do_sort_ascending(struct sort_entry *sort, int N);
+void runner_do_sort_ascending_radix(struct sort_entry *sort, int N);
 void runner_do_hydro_sort(struct runner *r, struct cell *c, int flag,
                           int cleanup, int rt_requests_sort, int clock);
 void runner_do_stars_sort(struct runner *r, struct cell *c, int flag,
@@ -175,5 +207,6 @@ void *runner_main(void *data);
 
 ticks runner_get_active_time(const struct runner *restrict r);
 void runner_reset_active_time(struct runner *restrict r);
+void runner_reset_sort_counts(struct runner *restrict r);
 
 #endif /* SWIFT_RUNNER_H */
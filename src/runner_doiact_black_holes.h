@@ -79,6 +79,9 @@
 #define _TIMER_DOSUB_PAIR_BH(f) PASTE(timer_dosub_pair_bh, f)
 #define TIMER_DOSUB_PAIR_BH _TIMER_DOSUB_PAIR_BH(FUNCTION)
 
+#define _HOT_CACHE_READ_BH_GAS(f) PASTE(runner_hot_cache_read_gas_bh, f)
+#define HOT_CACHE_READ_BH_GAS _HOT_CACHE_READ_BH_GAS(FUNCTION)
+
 #define _IACT_BH_GAS(f) PASTE(runner_iact_nonsym_bh_gas, f)
 #define IACT_BH_GAS _IACT_BH_GAS(FUNCTION)
 
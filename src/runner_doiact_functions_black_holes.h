@@ -26,6 +26,28 @@
 
 #include "runner_doiact_black_holes.h"
 
+/**
+ * @brief Copy the fields of a #part that the neighbour search of the black
+ * hole loops reads into a #hydro_hot_cache.
+ *
+ * @param e The #engine.
+ * @param p The #part.
+ * @param loc The origin of the frame of the interaction.
+ * @param hot The #hydro_hot_cache.
+ * @param k The index of the entry to fill.
+ */
+__attribute__((always_inline)) INLINE static void HOT_CACHE_READ_BH_GAS(
+    const struct engine *e, const struct part *restrict p, const double loc[3],
+    struct hydro_hot_cache *restrict hot, const int k) {
+
+  hot->x[k] = p->x[0] - loc[0];
+  hot->y[k] = p->x[1] - loc[1];
+  hot->z[k] = p->x[2] - loc[2];
+  hot->h[k] = p->h;
+  hot->active[k] = 1;
+  hot->inhibited[k] = part_is_inhibited(p, e);
+}
+
 /**
  * @brief Calculate the number density of #part around the #bpart
  *
@@ -60,6 +82,10 @@ void DOSELF1_BH(struct runner *r, struct cell *c, int timer) {
   /* Do we actually have any gas neighbours? */
   if (c->hydro.count != 0) {
 
+    /* The gas is copied to the cache when the first active BH is found. */
+    struct hydro_hot_cache *restrict hot = &r->cj_hot_cache;
+    int num_hot = 0;
+
     /* Loop over the bparts in ci. */
     for (int bid = 0; bid < bcount; bid++) {
 
@@ -69,29 +95,33 @@ void DOSELF1_BH(struct runner *r, struct cell *c, int timer) {
       /* Skip inactive particles */
       if (!bpart_is_active(bi, e)) continue;
 
+      if (num_hot == 0) {
+        hydro_hot_cache_reserve(hot, count);
+        for (; num_hot < count; num_hot++)
+          HOT_CACHE_READ_BH_GAS(e, &parts[num_hot], c->loc, hot, num_hot);
+      }
+
       const float hi = bi->h;
       const float hig2 = hi * hi * kernel_gamma2;
       const float bix[3] = {(float)(bi->x[0] - c->loc[0]),
                             (float)(bi->x[1] - c->loc[1]),
                             (float)(bi->x[2] - c->loc[2])};
 
-      /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count; pjd++) {
+      /* Find the neighbours of bi amongst the parts. */
+      const int num_ngb = hydro_hot_cache_search(
+          hot, 0, count, bix[0], bix[1], bix[2], hig2, hydro_hot_search_gather);
+
+      /* Loop over the neighbours. */
+      for (int n = 0; n < num_ngb; n++) {
 
         /* Get a pointer to the jth particle. */
+        const int pjd = hot->ngb[n];
         struct part *restrict pj = &parts[pjd];
         struct xpart *restrict xpj = &xparts[pjd];
-        const float hj = pj->h;
-
-        /* Early abort? */
-        if (part_is_inhibited(pj, e)) continue;
+        const float hj = hot->h[pjd];
 
-        /* Compute the pairwise distance. */
-        const float pjx[3] = {(float)(pj->x[0] - c->loc[0]),
-                              (float)(pj->x[1] - c->loc[1]),
-                              (float)(pj->x[2] - c->loc[2])};
-        const float dx[3] = {bix[0] - pjx[0], bix[1] - pjx[1], bix[2] - pjx[2]};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        const float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+        const float r2 = hot->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
         /* Check that particles have been drifted to the current time */
@@ -101,19 +131,26 @@ void DOSELF1_BH(struct runner *r, struct cell *c, int timer) {
           error("Particle pj not drifted to current time");
 #endif
 
-        if (r2 < hig2) {
-          IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
-                      e->gravity_properties, e->black_holes_properties,
-                      e->entropy_floor, ti_current, e->time);
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+        const char pj_sync = pj->limiter_data.to_be_synchronized;
+#endif
+
+        IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+                    e->gravity_properties, e->black_holes_properties,
+                    e->entropy_floor, ti_current, e->time);
 
-          if (bi_is_local) {
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+        if (!pj_sync && pj->limiter_data.to_be_synchronized)
+          cell_add_sync_candidate(c, pj);
+#endif
+
+        if (bi_is_local) {
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_SWALLOW)
-            runner_iact_nonsym_bh_gas_repos(
-                r2, dx, hi, pj->h, bi, pj, xpj, with_cosmology, cosmo,
-                e->gravity_properties, e->black_holes_properties,
-                e->entropy_floor, ti_current, e->time);
+          runner_iact_nonsym_bh_gas_repos(
+              r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+              e->gravity_properties, e->black_holes_properties,
+              e->entropy_floor, ti_current, e->time);
 #endif
-          }
         }
       } /* loop over the parts in ci. */
     } /* loop over the bparts in ci. */
@@ -230,6 +267,10 @@ void DO_NONSYM_PAIR1_BH_NAIVE(struct runner *r, struct cell *restrict ci,
   /* Do we actually have any gas neighbours? */
   if (cj->hydro.count != 0) {
 
+    /* The gas is copied to the cache when the first active BH is found. */
+    struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+    int num_hot = 0;
+
     /* Loop over the bparts in ci. */
     for (int bid = 0; bid < bcount_i; bid++) {
 
@@ -239,29 +280,35 @@ void DO_NONSYM_PAIR1_BH_NAIVE(struct runner *r, struct cell *restrict ci,
       /* Skip inactive particles */
       if (!bpart_is_active(bi, e)) continue;
 
+      if (num_hot == 0) {
+        hydro_hot_cache_reserve(hot_j, count_j);
+        for (; num_hot < count_j; num_hot++)
+          HOT_CACHE_READ_BH_GAS(e, &parts_j[num_hot], cj->loc, hot_j, num_hot);
+      }
+
       const float hi = bi->h;
       const float hig2 = hi * hi * kernel_gamma2;
       const float bix[3] = {(float)(bi->x[0] - (cj->loc[0] + shift[0])),
                             (float)(bi->x[1] - (cj->loc[1] + shift[1])),
                             (float)(bi->x[2] - (cj->loc[2] + shift[2]))};
 
-      /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j; pjd++) {
+      /* Find the neighbours of bi amongst the parts of cj. */
+      const int num_ngb =
+          hydro_hot_cache_search(hot_j, 0, count_j, bix[0], bix[1], bix[2],
+                                 hig2, hydro_hot_search_gather);
+
+      /* Loop over the neighbours in cj. */
+      for (int n = 0; n < num_ngb; n++) {
 
         /* Get a pointer to the jth particle. */
+        const int pjd = hot_j->ngb[n];
         struct part *restrict pj = &parts_j[pjd];
         struct xpart *restrict xpj = &xparts_j[pjd];
-        const float hj = pj->h;
-
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
+        const float hj = hot_j->h[pjd];
 
-        /* Compute the pairwise distance. */
-        const float pjx[3] = {(float)(pj->x[0] - cj->loc[0]),
-                              (float)(pj->x[1] - cj->loc[1]),
-                              (float)(pj->x[2] - cj->loc[2])};
-        const float dx[3] = {bix[0] - pjx[0], bix[1] - pjx[1], bix[2] - pjx[2]};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        const float dx[3] = {hot_j->ngb_dx[n], hot_j->ngb_dy[n],
+                             hot_j->ngb_dz[n]};
+        const float r2 = hot_j->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
         /* Check that particles have been drifted to the current time */
@@ -271,19 +318,26 @@ void DO_NONSYM_PAIR1_BH_NAIVE(struct runner *r, struct cell *restrict ci,
           error("Particle pj not drifted to current time");
 #endif
 
-        if (r2 < hig2) {
-          IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
-                      e->gravity_properties, e->black_holes_properties,
-                      e->entropy_floor, ti_current, e->time);
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+        const char pj_sync = pj->limiter_data.to_be_synchronized;
+#endif
+
+        IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+                    e->gravity_properties, e->black_holes_properties,
+                    e->entropy_floor, ti_current, e->time);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+        if (!pj_sync && pj->limiter_data.to_be_synchronized)
+          cell_add_sync_candidate(cj, pj);
+#endif
 
-          if (bi_is_local) {
+        if (bi_is_local) {
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_SWALLOW)
-            runner_iact_nonsym_bh_gas_repos(
-                r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
-                e->gravity_properties, e->black_holes_properties,
-                e->entropy_floor, ti_current, e->time);
+          runner_iact_nonsym_bh_gas_repos(
+              r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+              e->gravity_properties, e->black_holes_properties,
+              e->entropy_floor, ti_current, e->time);
 #endif
-          }
         }
       } /* loop over the parts in cj. */
     } /* loop over the bparts in ci. */
@@ -412,6 +466,12 @@ void DOPAIR1_SUBSET_BH_NAIVE(struct runner *r, struct cell *restrict ci,
   /* Early abort? */
   if (count_j == 0) return;
 
+  /* Copy the parts of cj to the cache. */
+  struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot_j, count_j);
+  for (int pjd = 0; pjd < count_j; pjd++)
+    HOT_CACHE_READ_BH_GAS(e, &parts_j[pjd], cj->loc, hot_j, pjd);
+
   /* Loop over the parts_i. */
   for (int bid = 0; bid < bcount; bid++) {
 
@@ -429,44 +489,49 @@ void DOPAIR1_SUBSET_BH_NAIVE(struct runner *r, struct cell *restrict ci,
       error("Trying to correct smoothing length of inactive particle !");
 #endif
 
-    /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count_j; pjd++) {
+    /* Find the neighbours of bi amongst the parts of cj. */
+    const int num_ngb = hydro_hot_cache_search(
+        hot_j, 0, count_j, (float)(bix - cj->loc[0]), (float)(biy - cj->loc[1]),
+        (float)(biz - cj->loc[2]), hig2, hydro_hot_search_gather);
+
+    /* Loop over the neighbours in cj. */
+    for (int n = 0; n < num_ngb; n++) {
 
       /* Get a pointer to the jth particle. */
+      const int pjd = hot_j->ngb[n];
       struct part *restrict pj = &parts_j[pjd];
       struct xpart *restrict xpj = &xparts_j[pjd];
+      const float hj = hot_j->h[pjd];
 
-      /* Skip inhibited particles */
-      if (part_is_inhibited(pj, e)) continue;
-
-      const double pjx = pj->x[0];
-      const double pjy = pj->x[1];
-      const double pjz = pj->x[2];
-      const float hj = pj->h;
-
-      /* Compute the pairwise distance. */
-      const float dx[3] = {(float)(bix - pjx), (float)(biy - pjy),
-                           (float)(biz - pjz)};
-      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+      const float dx[3] = {hot_j->ngb_dx[n], hot_j->ngb_dy[n],
+                           hot_j->ngb_dz[n]};
+      const float r2 = hot_j->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
       /* Check that particles have been drifted to the current time */
       if (pj->ti_drift != e->ti_current)
         error("Particle pj not drifted to current time");
 #endif
-      /* Hit or miss? */
-      if (r2 < hig2) {
-        IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
-                    e->gravity_properties, e->black_holes_properties,
-                    e->entropy_floor, ti_current, e->time);
-        if (bi_is_local) {
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+      const char pj_sync = pj->limiter_data.to_be_synchronized;
+#endif
+
+      IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+                  e->gravity_properties, e->black_holes_properties,
+                  e->entropy_floor, ti_current, e->time);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+      if (!pj_sync && pj->limiter_data.to_be_synchronized)
+        cell_add_sync_candidate(cj, pj);
+#endif
+      if (bi_is_local) {
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_SWALLOW)
-          runner_iact_nonsym_bh_gas_repos(
-              r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
-              e->gravity_properties, e->black_holes_properties,
-              e->entropy_floor, ti_current, e->time);
+        runner_iact_nonsym_bh_gas_repos(
+            r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+            e->gravity_properties, e->black_holes_properties,
+            e->entropy_floor, ti_current, e->time);
 #endif
-        }
       }
     } /* loop over the parts in cj. */
   } /* loop over the parts in ci. */
@@ -503,6 +568,12 @@ void DOSELF1_SUBSET_BH(struct runner *r, struct cell *restrict ci,
   /* Early abort? */
   if (count_i == 0) return;
 
+  /* Copy the parts to the cache. */
+  struct hydro_hot_cache *restrict hot = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot, count_i);
+  for (int pjd = 0; pjd < count_i; pjd++)
+    HOT_CACHE_READ_BH_GAS(e, &parts_j[pjd], ci->loc, hot, pjd);
+
   /* Loop over the parts in ci. */
   for (int bid = 0; bid < bcount; bid++) {
 
@@ -518,22 +589,21 @@ void DOSELF1_SUBSET_BH(struct runner *r, struct cell *restrict ci,
     if (!bpart_is_active(bi, e)) error("Inactive particle in subset function!");
 #endif
 
-    /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count_i; pjd++) {
+    /* Find the neighbours of bi amongst the parts. */
+    const int num_ngb = hydro_hot_cache_search(
+        hot, 0, count_i, bix[0], bix[1], bix[2], hig2, hydro_hot_search_gather);
+
+    /* Loop over the neighbours. */
+    for (int n = 0; n < num_ngb; n++) {
 
       /* Get a pointer to the jth particle. */
+      const int pjd = hot->ngb[n];
       struct part *restrict pj = &parts_j[pjd];
       struct xpart *restrict xpj = &xparts_j[pjd];
+      const float hj = hot->h[pjd];
 
-      /* Early abort? */
-      if (part_is_inhibited(pj, e)) continue;
-
-      /* Compute the pairwise distance. */
-      const float pjx[3] = {(float)(pj->x[0] - ci->loc[0]),
-                            (float)(pj->x[1] - ci->loc[1]),
-                            (float)(pj->x[2] - ci->loc[2])};
-      const float dx[3] = {bix[0] - pjx[0], bix[1] - pjx[1], bix[2] - pjx[2]};
-      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+      const float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+      const float r2 = hot->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
       /* Check that particles have been drifted to the current time */
@@ -541,20 +611,26 @@ void DOSELF1_SUBSET_BH(struct runner *r, struct cell *restrict ci,
         error("Particle pj not drifted to current time");
 #endif
 
-      /* Hit or miss? */
-      if (r2 < hig2) {
-        IACT_BH_GAS(r2, dx, hi, pj->h, bi, pj, xpj, with_cosmology, cosmo,
-                    e->gravity_properties, e->black_holes_properties,
-                    e->entropy_floor, ti_current, e->time);
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+      const char pj_sync = pj->limiter_data.to_be_synchronized;
+#endif
 
-        if (bi_is_local) {
+      IACT_BH_GAS(r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+                  e->gravity_properties, e->black_holes_properties,
+                  e->entropy_floor, ti_current, e->time);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+      if (!pj_sync && pj->limiter_data.to_be_synchronized)
+        cell_add_sync_candidate(ci, pj);
+#endif
+
+      if (bi_is_local) {
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_SWALLOW)
-          runner_iact_nonsym_bh_gas_repos(
-              r2, dx, hi, pj->h, bi, pj, xpj, with_cosmology, cosmo,
-              e->gravity_properties, e->black_holes_properties,
-              e->entropy_floor, ti_current, e->time);
+        runner_iact_nonsym_bh_gas_repos(
+            r2, dx, hi, hj, bi, pj, xpj, with_cosmology, cosmo,
+            e->gravity_properties, e->black_holes_properties,
+            e->entropy_floor, ti_current, e->time);
 #endif
-        }
       }
     } /* loop over the parts in cj. */
   } /* loop over the parts in ci. */
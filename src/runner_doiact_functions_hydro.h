@@ -1062,9 +1062,1009 @@ void DOSELF_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
 #endif
 }
 
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY) ||  \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT) || \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+
+/**
+ * @brief Non-symmetric interaction between two particles, including all the
+ * extra physics of the loop, for the versions of the loops running over
+ * neighbour lists.
+ *
+ * @param e The #engine.
+ * @param r2 The square of the distance between the particles.
+ * @param dx The vector from pj to pi.
+ * @param hi The smoothing length of pi.
+ * @param hj The smoothing length of pj.
+ * @param pi The particle to update.
+ * @param pj The other particle.
+ * @param a The current scale-factor.
+ * @param H The current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void IACT_NONSYM_NLIST(
+    const struct engine *e, const float r2, const float dx[3], const float hi,
+    const float hj, struct part *restrict pi, struct part *restrict pj,
+    const float a, const float H) {
+
+  GET_MU0();
+  IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+  IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+  runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                          e->sink_properties->cut_off_radius);
+#endif
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H, e->time_base,
+                               e->ti_current, e->cosmology,
+                               (e->policy & engine_policy_cosmology));
+#endif
+}
+
+/**
+ * @brief Symmetric interaction between two particles, including all the
+ * extra physics of the loop, for the versions of the loops running over
+ * neighbour lists.
+ *
+ * @param e The #engine.
+ * @param r2 The square of the distance between the particles.
+ * @param dx The vector from pj to pi.
+ * @param hi The smoothing length of pi.
+ * @param hj The smoothing length of pj.
+ * @param pi The first particle.
+ * @param pj The second particle.
+ * @param a The current scale-factor.
+ * @param H The current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void IACT_NLIST(
+    const struct engine *e, const float r2, const float dx[3], const float hi,
+    const float hj, struct part *restrict pi, struct part *restrict pj,
+    const float a, const float H) {
+
+  GET_MU0();
+  IACT(r2, dx, hi, hj, pi, pj, a, H);
+  IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+  runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
+                   e->sink_properties->cut_off_radius);
+#endif
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+  runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, e->time_base,
+                        e->ti_current, e->cosmology,
+                        (e->policy & engine_policy_cosmology));
+#endif
+}
+
+#endif /* density, gradient or force loop */
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+
+/**
+ * @brief Compute the density interactions between a cell pair
+ * (non-symmetric) and record the pairs of particles found for the gradient
+ * and force loops.
+ *
+ * We record all the pairs with at least one active particle and closer than
+ * the largest of their two kernel radii, increased by the skin of the lists.
+ * The lists hence remain complete as long as no smoothing length grows by
+ * more than the skin in the ghost. The search is organised as in DOPAIR2
+ * such that each pair is only found once.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param sid The direction of the pair.
+ * @param shift The shift vector to apply to the particles in ci.
+ */
+void DOPAIR1_BUILD_NLIST(struct runner *r, struct cell *ci, struct cell *cj,
+                         const int sid, const double *shift) {
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+  const float skin = 1.f + e->hydro_properties->neighbour_list_skin;
+  const float skin2 = skin * skin;
+
+  TIMER_TIC;
+
+  /* Get the cutoff shift. */
+  double rshift = 0.0;
+  for (int k = 0; k < 3; k++) rshift += shift[k] * runner_shift[sid][k];
+
+  /* Pick-out the sorted lists. */
+  const struct sort_entry *restrict sort_i = cell_get_hydro_sorts(ci, sid);
+  const struct sort_entry *restrict sort_j = cell_get_hydro_sorts(cj, sid);
+
+  /* Get some other useful values. */
+  const double hi_max = ci->hydro.h_max * kernel_gamma * skin;
+  const double hj_max = cj->hydro.h_max * kernel_gamma * skin;
+  const int count_i = ci->hydro.count;
+  const int count_j = cj->hydro.count;
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const int ci_active = CELL_IS_ACTIVE(ci, e);
+  const int cj_active = CELL_IS_ACTIVE(cj, e);
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Maximal displacement since last rebuild */
+  const double dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
+
+  /* Position on the axis of the particles closest to the interface */
+  const double di_max = sort_i[count_i - 1].d;
+  const double dj_min = sort_j[0].d;
+
+  /* Shifts to apply to the particles to be in a good frame */
+  const double shift_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                             cj->loc[2] + shift[2]};
+  const double shift_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
+
+  /* Make room for the list */
+  struct hydro_nlist_arena *arena = &r->nlist_arena;
+  struct hydro_nlist *lists =
+      hydro_nlist_get_cell_lists(ci, arena, e->hydro_nlist_epoch);
+  struct hydro_nlist_entry *restrict entries =
+      hydro_nlist_reserve(arena, (size_t)count_i * count_j);
+  int num_pairs = 0;
+
+  /* Loop over the parts in ci starting from the centre until we are out of
+     range of anything in cj (using the maximal hi with the skin). */
+  for (int pid = count_i - 1;
+       pid >= 0 && sort_i[pid].d + hi_max + dx_max - rshift > dj_min; pid--) {
+
+    /* Get a hold of the ith part in ci. */
+    struct part *restrict pi = &parts_i[sort_i[pid].i];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pi, e)) continue;
+
+    /* Is there anything active on either side? */
+    const int pi_active = PART_IS_ACTIVE(pi, e);
+    if (!pi_active && !cj_active) continue;
+
+    const float hi = pi->h;
+
+    /* Is there anything we need to interact with (for this specific hi) ? */
+    const double di =
+        sort_i[pid].d + hi * kernel_gamma * skin + dx_max - rshift;
+    if (di < dj_min) continue;
+
+    /* Get some additional information about pi */
+    const float hig2 = hi * hi * kernel_gamma2;
+    const float pix = pi->x[0] - shift_i[0];
+    const float piy = pi->x[1] - shift_i[1];
+    const float piz = pi->x[2] - shift_i[2];
+
+    /* Loop over the parts in cj. */
+    for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+
+      /* Recover pj */
+      struct part *restrict pj = &parts_j[sort_j[pjd].i];
+
+      /* Skip inhibited particles. */
+      if (part_is_inhibited(pj, e)) continue;
+
+      /* Skip pairs of inactive particles */
+      const int pj_active = PART_IS_ACTIVE(pj, e);
+      if (!pi_active && !pj_active) continue;
+
+      const float hj = pj->h;
+      const float pjx = pj->x[0] - shift_j[0];
+      const float pjy = pj->x[1] - shift_j[1];
+      const float pjz = pj->x[2] - shift_j[2];
+
+      /* Compute the pairwise distance. */
+      const float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
+      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+
+#if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
+      /* Check that particles have been drifted to the current time */
+      if (pi->ti_drift != e->ti_current)
+        error("Particle pi not drifted to current time");
+      if (pj->ti_drift != e->ti_current)
+        error("Particle pj not drifted to current time");
+#endif
+
+      /* Within range of pi (with the skin)? */
+      if (r2 >= hig2 * skin2) continue;
+
+      entries[num_pairs].i = sort_i[pid].i;
+      entries[num_pairs].j = sort_j[pjd].i;
+      entries[num_pairs].r2 = r2;
+      num_pairs++;
+
+      if (pi_active && r2 < hig2)
+        IACT_NONSYM_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+      if (pj_active && r2 < hj * hj * kernel_gamma2) {
+        const float dx_ji[3] = {-dx[0], -dx[1], -dx[2]};
+        IACT_NONSYM_NLIST(e, r2, dx_ji, hj, hi, pj, pi, a, H);
+      }
+    } /* loop over the parts in cj. */
+  }   /* loop over the parts in ci. */
+
+  /* Loop over the parts in cj starting from the centre until we are out of
+     range of anything in ci (using the maximal hj with the skin). */
+  for (int pjd = 0;
+       pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max - rshift;
+       pjd++) {
+
+    /* Get a hold of the jth part in cj. */
+    struct part *restrict pj = &parts_j[sort_j[pjd].i];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pj, e)) continue;
+
+    /* Is there anything active on either side? */
+    const int pj_active = PART_IS_ACTIVE(pj, e);
+    if (!pj_active && !ci_active) continue;
+
+    const float hj = pj->h;
+
+    /* Is there anything we need to interact with (for this specific hj) ? */
+    const double dj = sort_j[pjd].d - hj * kernel_gamma * skin - dx_max;
+    if (dj > di_max - rshift) continue;
+
+    /* Get some additional information about pj */
+    const float hjg2 = hj * hj * kernel_gamma2;
+    const float pjx = pj->x[0] - shift_j[0];
+    const float pjy = pj->x[1] - shift_j[1];
+    const float pjz = pj->x[2] - shift_j[2];
+
+    /* Loop over the parts in ci. */
+    for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d - rshift > dj;
+         pid--) {
+
+      /* Recover pi */
+      struct part *restrict pi = &parts_i[sort_i[pid].i];
+
+      /* Skip inhibited particles. */
+      if (part_is_inhibited(pi, e)) continue;
+
+      /* Skip pairs of inactive particles */
+      if (!pj_active && !PART_IS_ACTIVE(pi, e)) continue;
+
+      const float hi = pi->h;
+      const float pix = pi->x[0] - shift_i[0];
+      const float piy = pi->x[1] - shift_i[1];
+      const float piz = pi->x[2] - shift_i[2];
+
+      /* Compute the pairwise distance. */
+      const float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
+      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+
+      /* Within range of pj but not of pi (with the skin), as we already
+       * recorded those pairs? */
+      if (r2 >= hjg2 * skin2 || r2 < hi * hi * kernel_gamma2 * skin2) continue;
+
+      entries[num_pairs].i = sort_i[pid].i;
+      entries[num_pairs].j = sort_j[pjd].i;
+      entries[num_pairs].r2 = r2;
+      num_pairs++;
+
+      /* Only pj can need updating as pi is out of range */
+      if (pj_active && r2 < hjg2) {
+        const float dx_ji[3] = {-dx[0], -dx[1], -dx[2]};
+        IACT_NONSYM_NLIST(e, r2, dx_ji, hj, hi, pj, pi, a, H);
+      }
+    } /* loop over the parts in ci. */
+  }   /* loop over the parts in cj. */
+
+  hydro_nlist_commit(arena, &lists[sid], entries, num_pairs);
+
+  TIMER_TOC(TIMER_DOPAIR);
+}
+
+/**
+ * @brief Compute the density interactions within a cell (non-symmetric) and
+ * record the pairs of particles found for the gradient and force loops.
+ *
+ * See DOPAIR1_BUILD_NLIST() for the pairs we record.
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ */
+void DOSELF1_BUILD_NLIST(struct runner *r, struct cell *restrict c) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+  const float skin = 1.f + e->hydro_properties->neighbour_list_skin;
+  const float skin2 = skin * skin;
+
+  TIMER_TIC;
+
+  struct part *restrict parts = c->hydro.parts;
+  const int count = c->hydro.count;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Make room for the list */
+  struct hydro_nlist_arena *arena = &r->nlist_arena;
+  struct hydro_nlist *lists =
+      hydro_nlist_get_cell_lists(c, arena, e->hydro_nlist_epoch);
+  struct hydro_nlist_entry *restrict entries =
+      hydro_nlist_reserve(arena, (size_t)count * (count - 1) / 2);
+  int num_pairs = 0;
+
+  /* Loop over the particles in the cell. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a pointer to the ith particle. */
+    struct part *restrict pi = &parts[pid];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pi, e)) continue;
+
+    /* Get the particle position and radius. */
+    double pix[3];
+    for (int k = 0; k < 3; k++) pix[k] = pi->x[k];
+    const float hi = pi->h;
+    const float hig2 = hi * hi * kernel_gamma2;
+    const int pi_active = PART_IS_ACTIVE(pi, e);
+
+    /* Loop over the other particles .*/
+    for (int pjd = pid + 1; pjd < count; pjd++) {
+
+      /* Get a pointer to the jth particle. */
+      struct part *restrict pj = &parts[pjd];
+
+      /* Skip inhibited particles. */
+      if (part_is_inhibited(pj, e)) continue;
+
+      /* Skip pairs of inactive particles */
+      const int pj_active = PART_IS_ACTIVE(pj, e);
+      if (!pi_active && !pj_active) continue;
+
+      const float hj = pj->h;
+      const float hjg2 = hj * hj * kernel_gamma2;
+
+      /* Compute the pairwise distance. */
+      float r2 = 0.0f;
+      float dx[3];
+      for (int k = 0; k < 3; k++) {
+        dx[k] = pix[k] - pj->x[k];
+        r2 += dx[k] * dx[k];
+      }
+
+#if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
+      /* Check that particles have been drifted to the current time */
+      if (pi->ti_drift != e->ti_current)
+        error("Particle pi not drifted to current time");
+      if (pj->ti_drift != e->ti_current)
+        error("Particle pj not drifted to current time");
+#endif
+
+      /* Within range of either particle (with the skin)? */
+      if (r2 >= hig2 * skin2 && r2 >= hjg2 * skin2) continue;
+
+      entries[num_pairs].i = pid;
+      entries[num_pairs].j = pjd;
+      entries[num_pairs].r2 = r2;
+      num_pairs++;
+
+      /* Which parts need to be updated? */
+      const int doi = pi_active && (r2 < hig2);
+      const int doj = pj_active && (r2 < hjg2);
+      if (doi && doj) {
+        IACT_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+      } else if (doi) {
+        IACT_NONSYM_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+      } else if (doj) {
+        dx[0] = -dx[0];
+        dx[1] = -dx[1];
+        dx[2] = -dx[2];
+        IACT_NONSYM_NLIST(e, r2, dx, hj, hi, pj, pi, a, H);
+      }
+    } /* loop over all other particles. */
+  }   /* loop over all particles. */
+
+  hydro_nlist_commit(arena, &lists[hydro_nlist_self_slot], entries, num_pairs);
+
+  TIMER_TOC(TIMER_DOSELF);
+}
+
+#endif /* FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY */
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT)
+
+/**
+ * @brief Compute the interactions between a cell pair (non-symmetric) using
+ * the pairs recorded by the density loop.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param shift The shift vector to apply to the particles in ci.
+ * @param nlist The neighbour list of the pair.
+ */
+void DOPAIR1_NLIST(struct runner *r, struct cell *ci, struct cell *cj,
+                   const double *shift, const struct hydro_nlist *nlist) {
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const struct hydro_nlist_entry *restrict entries = nlist->entries;
+  const int num_pairs = nlist->count;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Shifts to apply to the particles to be in a good frame */
+  const double shift_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                             cj->loc[2] + shift[2]};
+  const double shift_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
+
+  for (int k = 0; k < num_pairs; k++) {
+
+    struct part *restrict pi = &parts_i[entries[k].i];
+    struct part *restrict pj = &parts_j[entries[k].j];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pi, e) || part_is_inhibited(pj, e)) continue;
+
+    /* Which parts need to be updated? */
+    const float r2 = entries[k].r2;
+    const float hi = pi->h;
+    const float hj = pj->h;
+    const int doi = PART_IS_ACTIVE(pi, e) && (r2 < hi * hi * kernel_gamma2);
+    const int doj = PART_IS_ACTIVE(pj, e) && (r2 < hj * hj * kernel_gamma2);
+    if (!doi && !doj) continue;
+
+    const float pix = pi->x[0] - shift_i[0];
+    const float piy = pi->x[1] - shift_i[1];
+    const float piz = pi->x[2] - shift_i[2];
+    const float pjx = pj->x[0] - shift_j[0];
+    const float pjy = pj->x[1] - shift_j[1];
+    const float pjz = pj->x[2] - shift_j[2];
+
+    if (doi) {
+      const float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
+      IACT_NONSYM_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+    }
+    if (doj) {
+      const float dx[3] = {pjx - pix, pjy - piy, pjz - piz};
+      IACT_NONSYM_NLIST(e, r2, dx, hj, hi, pj, pi, a, H);
+    }
+  }
+
+  TIMER_TOC(TIMER_DOPAIR);
+}
+
+/**
+ * @brief Compute the cell self-interaction (non-symmetric) using the pairs
+ * recorded by the density loop.
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ * @param nlist The neighbour list of the cell.
+ */
+void DOSELF1_NLIST(struct runner *r, struct cell *restrict c,
+                   const struct hydro_nlist *nlist) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  struct part *restrict parts = c->hydro.parts;
+  const struct hydro_nlist_entry *restrict entries = nlist->entries;
+  const int num_pairs = nlist->count;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  for (int k = 0; k < num_pairs; k++) {
+
+    struct part *restrict pi = &parts[entries[k].i];
+    struct part *restrict pj = &parts[entries[k].j];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pi, e) || part_is_inhibited(pj, e)) continue;
+
+    /* Which parts need to be updated? */
+    const float r2 = entries[k].r2;
+    const float hi = pi->h;
+    const float hj = pj->h;
+    const int doi = PART_IS_ACTIVE(pi, e) && (r2 < hi * hi * kernel_gamma2);
+    const int doj = PART_IS_ACTIVE(pj, e) && (r2 < hj * hj * kernel_gamma2);
+    if (!doi && !doj) continue;
+
+    float dx[3];
+    for (int d = 0; d < 3; d++) dx[d] = pi->x[d] - pj->x[d];
+
+    if (doi && doj) {
+      IACT_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+    } else if (doi) {
+      IACT_NONSYM_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+    } else {
+      dx[0] = -dx[0];
+      dx[1] = -dx[1];
+      dx[2] = -dx[2];
+      IACT_NONSYM_NLIST(e, r2, dx, hj, hi, pj, pi, a, H);
+    }
+  }
+
+  TIMER_TOC(TIMER_DOSELF);
+}
+
+#endif /* FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT */
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+
+/**
+ * @brief Compute the interactions between a cell pair (symmetric) using the
+ * pairs recorded by the density loop.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param shift The shift vector to apply to the particles in ci.
+ * @param nlist The neighbour list of the pair.
+ */
+void DOPAIR2_NLIST(struct runner *r, struct cell *ci, struct cell *cj,
+                   const double *shift, const struct hydro_nlist *nlist) {
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const struct hydro_nlist_entry *restrict entries = nlist->entries;
+  const int num_pairs = nlist->count;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Shifts to apply to the particles to be in a good frame */
+  const double shift_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                             cj->loc[2] + shift[2]};
+  const double shift_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
+
+  for (int k = 0; k < num_pairs; k++) {
+
+    struct part *restrict pi = &parts_i[entries[k].i];
+    struct part *restrict pj = &parts_j[entries[k].j];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pi, e) || part_is_inhibited(pj, e)) continue;
+
+    /* Hit or miss? */
+    const float r2 = entries[k].r2;
+    const float hi = pi->h;
+    const float hj = pj->h;
+    const float hig2 = hi * hi * kernel_gamma2;
+    if (r2 >= hig2 && r2 >= hj * hj * kernel_gamma2) continue;
+
+    const int pi_active = PART_IS_ACTIVE(pi, e);
+    const int pj_active = PART_IS_ACTIVE(pj, e);
+
+    const float pix = pi->x[0] - shift_i[0];
+    const float piy = pi->x[1] - shift_i[1];
+    const float piz = pi->x[2] - shift_i[2];
+    const float pjx = pj->x[0] - shift_j[0];
+    const float pjy = pj->x[1] - shift_j[1];
+    const float pjz = pj->x[2] - shift_j[2];
+    const float dx_ij[3] = {pix - pjx, piy - pjy, piz - pjz};
+    const float dx_ji[3] = {pjx - pix, pjy - piy, pjz - piz};
+
+    /* Which parts need to be updated? (in the same order as DOPAIR2) */
+    if (pi_active && pj_active) {
+      if (r2 < hig2)
+        IACT_NLIST(e, r2, dx_ij, hi, hj, pi, pj, a, H);
+      else
+        IACT_NLIST(e, r2, dx_ji, hj, hi, pj, pi, a, H);
+    } else if (pi_active) {
+      IACT_NONSYM_NLIST(e, r2, dx_ij, hi, hj, pi, pj, a, H);
+    } else if (pj_active) {
+      IACT_NONSYM_NLIST(e, r2, dx_ji, hj, hi, pj, pi, a, H);
+    }
+  }
+
+  TIMER_TOC(TIMER_DOPAIR);
+}
+
+/**
+ * @brief Compute the cell self-interaction (symmetric) using the pairs
+ * recorded by the density loop.
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ * @param nlist The neighbour list of the cell.
+ */
+void DOSELF2_NLIST(struct runner *r, struct cell *restrict c,
+                   const struct hydro_nlist *nlist) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  struct part *restrict parts = c->hydro.parts;
+  const struct hydro_nlist_entry *restrict entries = nlist->entries;
+  const int num_pairs = nlist->count;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  for (int k = 0; k < num_pairs; k++) {
+
+    struct part *restrict pi = &parts[entries[k].i];
+    struct part *restrict pj = &parts[entries[k].j];
+
+    /* Skip inhibited particles. */
+    if (part_is_inhibited(pi, e) || part_is_inhibited(pj, e)) continue;
+
+    /* Hit or miss? */
+    const float r2 = entries[k].r2;
+    const float hi = pi->h;
+    const float hj = pj->h;
+    if (r2 >= hi * hi * kernel_gamma2 && r2 >= hj * hj * kernel_gamma2)
+      continue;
+
+    const int pi_active = PART_IS_ACTIVE(pi, e);
+    const int pj_active = PART_IS_ACTIVE(pj, e);
+
+    float dx[3];
+    for (int d = 0; d < 3; d++) dx[d] = pi->x[d] - pj->x[d];
+
+    /* Which parts need to be updated? */
+    if (pi_active && pj_active) {
+      IACT_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+    } else if (pi_active) {
+      IACT_NONSYM_NLIST(e, r2, dx, hi, hj, pi, pj, a, H);
+    } else if (pj_active) {
+      dx[0] = -dx[0];
+      dx[1] = -dx[1];
+      dx[2] = -dx[2];
+      IACT_NONSYM_NLIST(e, r2, dx, hj, hi, pj, pi, a, H);
+    }
+  }
+
+  TIMER_TOC(TIMER_DOSELF);
+}
+
+#endif /* FUNCTION_TASK_LOOP == TASK_LOOP_FORCE */
+
+/**
+ * @brief Copy the fields of a #part read by the neighbour search to a
+ * #hydro_hot_cache.
+ *
+ * @param e The #engine.
+ * @param p The #part.
+ * @param loc The origin of the frame in which to store the position.
+ * @param hot The #hydro_hot_cache.
+ * @param k The index in the cache.
+ */
+__attribute__((always_inline)) INLINE static void HOT_CACHE_READ(
+    const struct engine *e, struct part *restrict p, const double loc[3],
+    struct hydro_hot_cache *restrict hot, const int k) {
+
+  hot->x[k] = p->x[0] - loc[0];
+  hot->y[k] = p->x[1] - loc[1];
+  hot->z[k] = p->x[2] - loc[2];
+  hot->h[k] = p->h;
+  hot->active[k] = PART_IS_ACTIVE(p, e);
+  hot->inhibited[k] = part_is_inhibited(p, e);
+  hot->part[k] = p;
+}
+
+#ifdef DO_VEC_IACT
+
+/**
+ * @brief Interact a particle with the neighbours found by the last search of
+ * a #hydro_hot_cache (non-symmetric).
+ *
+ * The hydro interactions are done a vector of neighbours at a time with the
+ * scheme's lane-parallel functions. The neighbours left after the last whole
+ * vector are done as one more vector with the empty lanes masked out if they
+ * fill at least half of it, and one at a time with the scalar function
+ * otherwise. The interactions of the other modules stay scalar.
+ *
+ * @param e The #engine.
+ * @param hot The #hydro_hot_cache holding the neighbours.
+ * @param num_ngb The number of neighbours.
+ * @param pi The #part to update.
+ * @param hi Comoving smoothing-length of pi.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void IACT_NONSYM_NGBS(
+    const struct engine *e, struct hydro_hot_cache *restrict hot,
+    const int num_ngb, struct part *restrict pi, const float hi, const float a,
+    const float H) {
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  const struct cosmology *restrict cosmo = e->cosmology;
+  const double time_base = e->time_base;
+  const integertime_t t_current = e->ti_current;
+  const int with_cosmology = (e->policy & engine_policy_cosmology);
+#endif
+  GET_MU0();
+
+  /* How many neighbours are done with vectors? */
+  const int num_whole = num_ngb - (num_ngb % VEC_SIZE);
+  const int num_left = num_ngb - num_whole;
+  const int num_vec = (2 * num_left >= VEC_SIZE) ? num_ngb + VEC_SIZE - num_left
+                                                 : num_whole;
+  if (num_vec > num_ngb) hydro_hot_cache_pad_ngbs(hot, num_ngb, num_vec);
+
+  /* Lane-parallel interactions */
+  struct IACT_VEC_DATA data;
+  IACT_NONSYM_VEC_INIT(&data, pi, hi, a, H);
+
+  mask_t mask;
+  vec_init_mask_true(mask);
+  for (int n = 0; n < num_vec; n += VEC_SIZE) {
+
+    /* Mask out the padding of the last vector. */
+    if (n == num_whole) hydro_hot_cache_lane_mask(&mask, num_left);
+
+    vector r2, dx, dy, dz;
+    struct part *pj[VEC_SIZE];
+    hydro_hot_cache_load_ngbs(hot, n, &r2, &dx, &dy, &dz, pj);
+    IACT_NONSYM_VEC(&data, r2, dx, dy, dz, pj, mask);
+  }
+
+  IACT_NONSYM_VEC_REDUCE(&data, pi);
+
+  /* Scalar remainder */
+  for (int n = num_vec; n < num_ngb; n++) {
+    const int k = hot->ngb[n];
+    const float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+    IACT_NONSYM(hot->ngb_r2[n], dx, hi, hot->h[k], pi, hot->part[k], a, H);
+  }
+
+  /* Interactions of the other modules */
+  for (int n = 0; n < num_ngb; n++) {
+
+    const int k = hot->ngb[n];
+    struct part *restrict pj = hot->part[k];
+    const float hj = hot->h[k];
+    const float r2 = hot->ngb_r2[n];
+    const float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+
+#if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
+    /* Check that particles have been drifted to the current time */
+    if (pi->ti_drift != e->ti_current)
+      error("Particle pi not drifted to current time");
+    if (pj->ti_drift != e->ti_current)
+      error("Particle pj not drifted to current time");
+#endif
+
+    IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+    runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                            e->sink_properties->cut_off_radius);
+#endif
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+    runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
+                                 t_current, cosmo, with_cosmology);
+#endif
+  }
+}
+
+/**
+ * @brief Compute the interactions between a cell pair with the lane-parallel
+ * interactions (non-symmetric).
+ *
+ * Every active particle gathers the contributions of its neighbours in the
+ * other cell and only ever updates itself. Pairs of active particles are
+ * hence computed twice, once from each side, but all the interactions can
+ * be done a vector of neighbours at a time.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param sid The direction of the pair.
+ * @param shift The shift vector to apply to the particles in ci.
+ */
+void DOPAIR_VEC(struct runner *r, struct cell *ci, struct cell *cj,
+                const int sid, const double *shift) {
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  /* Get the cutoff shift. */
+  double rshift = 0.0;
+  for (int k = 0; k < 3; k++) rshift += shift[k] * runner_shift[sid][k];
+
+  /* Pick-out the sorted lists. */
+  const struct sort_entry *restrict sort_i = cell_get_hydro_sorts(ci, sid);
+  const struct sort_entry *restrict sort_j = cell_get_hydro_sorts(cj, sid);
+
+  /* Get some other useful values. */
+  const int count_i = ci->hydro.count;
+  const int count_j = cj->hydro.count;
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const double di_max = sort_i[count_i - 1].d - rshift;
+  const double dj_min = sort_j[0].d;
+  const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
+  const double h_max = max(ci->hydro.h_max, cj->hydro.h_max) * kernel_gamma;
+
+  /* The force loop also needs the neighbours that have the particle within
+   * their own kernel. */
+  const int with_scatter = (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE);
+  const enum hydro_hot_search_mode mode =
+      with_scatter ? hydro_hot_search_gather_scatter : hydro_hot_search_gather;
+  const double hi_max_scatter = with_scatter ? ci->hydro.h_max : 0.;
+  const double hj_max_scatter = with_scatter ? cj->hydro.h_max : 0.;
+
+  /* Both cells are moved to the frame of cj. The particles of ci are stored
+   * in the cache from the right end of the sorted list, those of cj from the
+   * left end, as far as any interaction can reach. */
+  const double loc_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                           cj->loc[2] + shift[2]};
+  const double loc_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
+  struct hydro_hot_cache *restrict hot_i = &r->ci_hot_cache;
+  struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot_i, count_i);
+  hydro_hot_cache_reserve(hot_j, count_j);
+
+  int num_i = 0, num_j = 0;
+  for (; num_i < count_i &&
+         sort_i[count_i - 1 - num_i].d - rshift + h_max + dx_max > dj_min;
+       num_i++)
+    HOT_CACHE_READ(e, &parts_i[sort_i[count_i - 1 - num_i].i], loc_i, hot_i,
+                   num_i);
+  for (; num_j < count_j && sort_j[num_j].d - h_max - dx_max < di_max; num_j++)
+    HOT_CACHE_READ(e, &parts_j[sort_j[num_j].i], loc_j, hot_j, num_j);
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  if (CELL_IS_ACTIVE(ci, e)) {
+
+    /* Loop over the parts in ci. */
+    for (int ki = 0; ki < num_i; ki++) {
+
+      /* Skip inactive particles */
+      if (!hot_i->active[ki]) continue;
+
+      /* Is there anything we need to interact with ? */
+      const int pid = count_i - 1 - ki;
+      const float hi = hot_i->h[ki];
+      const double di = sort_i[pid].d - rshift + dx_max +
+                        max(hi, hj_max_scatter) * kernel_gamma;
+      if (di < dj_min) continue;
+
+      /* Find the neighbours of pi amongst the parts of cj in range. */
+      int last_j = 0;
+      while (last_j < num_j && sort_j[last_j].d < di) last_j++;
+      const int num_ngb = hydro_hot_cache_search(
+          hot_j, 0, last_j, hot_i->x[ki], hot_i->y[ki], hot_i->z[ki],
+          hi * hi * kernel_gamma2, mode);
+
+      IACT_NONSYM_NGBS(e, hot_j, num_ngb, &parts_i[sort_i[pid].i], hi, a, H);
+    }
+  }
+
+  if (CELL_IS_ACTIVE(cj, e)) {
+
+    /* Loop over the parts in cj. */
+    for (int kj = 0; kj < num_j; kj++) {
+
+      /* Skip inactive particles */
+      if (!hot_j->active[kj]) continue;
+
+      /* Is there anything we need to interact with ? */
+      const float hj = hot_j->h[kj];
+      const double dj = sort_j[kj].d - dx_max -
+                        max(hj, hi_max_scatter) * kernel_gamma;
+      if (dj > di_max) continue;
+
+      /* Find the neighbours of pj amongst the parts of ci in range. */
+      int last_i = 0;
+      while (last_i < num_i && sort_i[count_i - 1 - last_i].d - rshift > dj)
+        last_i++;
+      const int num_ngb = hydro_hot_cache_search(
+          hot_i, 0, last_i, hot_j->x[kj], hot_j->y[kj], hot_j->z[kj],
+          hj * hj * kernel_gamma2, mode);
+
+      IACT_NONSYM_NGBS(e, hot_i, num_ngb, &parts_j[sort_j[kj].i], hj, a, H);
+    }
+  }
+
+  TIMER_TOC(TIMER_DOPAIR);
+}
+
+/**
+ * @brief Compute the cell self-interaction with the lane-parallel
+ * interactions (non-symmetric).
+ *
+ * As in #DOPAIR_VEC, every active particle gathers the contributions of all
+ * of its neighbours and only ever updates itself.
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ */
+void DOSELF_VEC(struct runner *r, struct cell *restrict c) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  struct part *restrict parts = c->hydro.parts;
+  const int count = c->hydro.count;
+
+  /* The force loop also needs the neighbours that have the particle within
+   * their own kernel. */
+  const enum hydro_hot_search_mode mode =
+      (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+          ? hydro_hot_search_gather_scatter
+          : hydro_hot_search_gather;
+
+  /* Copy the fields read by the neighbour search, in the frame of the
+   * cell. */
+  struct hydro_hot_cache *restrict hot = &r->ci_hot_cache;
+  hydro_hot_cache_reserve(hot, count);
+  const double loc[3] = {c->loc[0], c->loc[1], c->loc[2]};
+  for (int k = 0; k < count; k++) HOT_CACHE_READ(e, &parts[k], loc, hot, k);
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Loop over the particles in the cell. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Skip inactive particles */
+    if (!hot->active[pid]) continue;
+
+    /* Find the neighbours of pi amongst all the other particles. It is
+     * flagged as inhibited for the search not to return it. */
+    const float hi = hot->h[pid];
+    hot->inhibited[pid] = 1;
+    const int num_ngb =
+        hydro_hot_cache_search(hot, 0, count, hot->x[pid], hot->y[pid],
+                               hot->z[pid], hi * hi * kernel_gamma2, mode);
+    hot->inhibited[pid] = 0;
+
+    IACT_NONSYM_NGBS(e, hot, num_ngb, &parts[pid], hi, a, H);
+  }
+
+  TIMER_TOC(TIMER_DOSELF);
+}
+
+#endif /* DO_VEC_IACT */
+
 /**
  * @brief Compute the interactions between a cell pair (non-symmetric).
  *
+ * The neighbour search runs over copies of the positions, smoothing lengths
+ * and activity flags of the particles in the runner's #hydro_hot_cache and
+ * only the pairs that interact read the full #part.
+ *
  * @param r The #runner.
  * @param ci The first #cell.
  * @param cj The second #cell.
@@ -1117,53 +2117,106 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   const double dj_min = sort_j[0].d;
   const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
 
+  /* Both cells are moved to the frame of cj. The particles of ci are stored
+   * in the cache from the right end of the sorted list, those of cj from the
+   * left end. */
+  const double loc_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                           cj->loc[2] + shift[2]};
+  const double loc_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
+  struct hydro_hot_cache *restrict hot_i = &r->ci_hot_cache;
+  struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot_i, count_i);
+  hydro_hot_cache_reserve(hot_j, count_j);
+
+  /* Copy the particles that the loops over ci and cj will visit and find how
+   * far into the other cell their interactions reach. */
+  const int ci_active = CELL_IS_ACTIVE(ci, e);
+  const int cj_active = CELL_IS_ACTIVE(cj, e);
+  int num_i = 0, num_j = 0;
+  double di_reach = -FLT_MAX, dj_reach = FLT_MAX;
+  if (ci_active) {
+    for (; num_i < count_i &&
+           sort_i[count_i - 1 - num_i].d + hi_max + dx_max > dj_min;
+         num_i++) {
+      const int pid = count_i - 1 - num_i;
+      HOT_CACHE_READ(e, &parts_i[sort_i[pid].i], loc_i, hot_i, num_i);
+      if (hot_i->active[num_i])
+        di_reach = max(di_reach, sort_i[pid].d + hot_i->h[num_i] * kernel_gamma +
+                                     dx_max - rshift);
+    }
+  }
+  if (cj_active) {
+    for (; num_j < count_j && sort_j[num_j].d - hj_max - dx_max < di_max;
+         num_j++) {
+      HOT_CACHE_READ(e, &parts_j[sort_j[num_j].i], loc_j, hot_j, num_j);
+      if (hot_j->active[num_j])
+        dj_reach = min(dj_reach, sort_j[num_j].d -
+                                     hot_j->h[num_j] * kernel_gamma - dx_max +
+                                     rshift);
+    }
+  }
+  for (; num_j < count_j && sort_j[num_j].d < di_reach; num_j++)
+    HOT_CACHE_READ(e, &parts_j[sort_j[num_j].i], loc_j, hot_j, num_j);
+  for (; num_i < count_i && sort_i[count_i - 1 - num_i].d > dj_reach; num_i++)
+    HOT_CACHE_READ(e, &parts_i[sort_i[count_i - 1 - num_i].i], loc_i, hot_i,
+                   num_i);
+
   /* Cosmological terms and physical constants */
   const float a = cosmo->a;
   const float H = cosmo->H;
   GET_MU0();
 
-  if (CELL_IS_ACTIVE(ci, e)) {
+  if (ci_active) {
 
     /* Loop over the parts in ci. */
     for (int pid = count_i - 1;
          pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
 
       /* Get a hold of the ith part in ci. */
-      struct part *restrict pi = &parts_i[sort_i[pid].i];
-      const float hi = pi->h;
+      const int ki = count_i - 1 - pid;
+      const float hi = hot_i->h[ki];
 
       /* Skip inactive particles */
-      if (!PART_IS_ACTIVE(pi, e)) continue;
+      if (!hot_i->active[ki]) continue;
 
       /* Is there anything we need to interact with ? */
       const double di = sort_i[pid].d + hi * kernel_gamma + dx_max - rshift;
       if (di < dj_min) continue;
 
       /* Get some additional information about pi */
+      struct part *restrict pi = &parts_i[sort_i[pid].i];
       const float hig2 = hi * hi * kernel_gamma2;
-      const float pix = pi->x[0] - (cj->loc[0] + shift[0]);
-      const float piy = pi->x[1] - (cj->loc[1] + shift[1]);
-      const float piz = pi->x[2] - (cj->loc[2] + shift[2]);
+      const float pix = hot_i->x[ki];
+      const float piy = hot_i->y[ki];
+      const float piz = hot_i->z[ki];
 
-      /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      /* Find the neighbours of pi amongst the parts of cj in range. */
+      int last_j = 0;
+      while (last_j < count_j && sort_j[last_j].d < di) last_j++;
 
-        /* Recover pj */
-        struct part *pj = &parts_j[sort_j[pjd].i];
+#ifdef SWIFT_DEBUG_CHECKS
+      if (last_j > num_j) error("Particle pj is not in the hot cache.");
+#endif
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
+      const int num_ngb = hydro_hot_cache_search(
+          hot_j, 0, last_j, pix, piy, piz, hig2, hydro_hot_search_gather);
 
-        const float hj = pj->h;
-        const float pjx = pj->x[0] - cj->loc[0];
-        const float pjy = pj->x[1] - cj->loc[1];
-        const float pjz = pj->x[2] - cj->loc[2];
+      /* Loop over the neighbours in cj. */
+      for (int n = 0; n < num_ngb; n++) {
 
-        /* Compute the pairwise distance. */
-        float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        /* Recover pj */
+        const int pjd = hot_j->ngb[n];
+        struct part *pj = &parts_j[sort_j[pjd].i];
+        const float hj = hot_j->h[pjd];
+
+        float dx[3] = {hot_j->ngb_dx[n], hot_j->ngb_dy[n], hot_j->ngb_dz[n]};
+        const float r2 = hot_j->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
+        const float pjx = hot_j->x[pjd];
+        const float pjy = hot_j->y[pjd];
+        const float pjz = hot_j->z[pjd];
+
         /* Check that particles are in the correct frame after the shifts */
         if (pix > shift_threshold_x || pix < -shift_threshold_x)
           error(
@@ -1199,71 +2252,75 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 #endif
 #endif
 
-        /* Hit or miss? */
-        if (r2 < hig2) {
-
-          IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
-          IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+        IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+        IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-          runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-          runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-          runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-          runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
-                                  e->sink_properties->cut_off_radius);
+        runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                                e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-          runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
-          runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-          runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
-                                       t_current, cosmo, with_cosmology);
+        runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
+                                     t_current, cosmo, with_cosmology);
 #endif
-        }
       } /* loop over the parts in cj. */
     } /* loop over the parts in ci. */
   } /* Cell ci is active */
 
-  if (CELL_IS_ACTIVE(cj, e)) {
+  if (cj_active) {
 
     /* Loop over the parts in cj. */
     for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
          pjd++) {
 
       /* Get a hold of the jth part in cj. */
-      struct part *pj = &parts_j[sort_j[pjd].i];
-      const float hj = pj->h;
+      const float hj = hot_j->h[pjd];
 
       /* Skip inactive particles */
-      if (!PART_IS_ACTIVE(pj, e)) continue;
+      if (!hot_j->active[pjd]) continue;
 
       /* Is there anything we need to interact with ? */
       const double dj = sort_j[pjd].d - hj * kernel_gamma - dx_max + rshift;
       if (dj - rshift > di_max) continue;
 
       /* Get some additional information about pj */
+      struct part *pj = &parts_j[sort_j[pjd].i];
       const float hjg2 = hj * hj * kernel_gamma2;
-      const float pjx = pj->x[0] - cj->loc[0];
-      const float pjy = pj->x[1] - cj->loc[1];
-      const float pjz = pj->x[2] - cj->loc[2];
+      const float pjx = hot_j->x[pjd];
+      const float pjy = hot_j->y[pjd];
+      const float pjz = hot_j->z[pjd];
 
-      /* Loop over the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d > dj; pid--) {
+      /* Find the neighbours of pj amongst the parts of ci in range. */
+      int last_i = 0;
+      while (last_i < count_i && sort_i[count_i - 1 - last_i].d > dj) last_i++;
 
-        /* Recover pi */
-        struct part *pi = &parts_i[sort_i[pid].i];
+#ifdef SWIFT_DEBUG_CHECKS
+      if (last_i > num_i) error("Particle pi is not in the hot cache.");
+#endif
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pi, e)) continue;
+      const int num_ngb = hydro_hot_cache_search(
+          hot_i, 0, last_i, pjx, pjy, pjz, hjg2, hydro_hot_search_gather);
 
-        const float hi = pi->h;
-        const float pix = pi->x[0] - (cj->loc[0] + shift[0]);
-        const float piy = pi->x[1] - (cj->loc[1] + shift[1]);
-        const float piz = pi->x[2] - (cj->loc[2] + shift[2]);
+      /* Loop over the neighbours in ci. */
+      for (int n = 0; n < num_ngb; n++) {
 
-        /* Compute the pairwise distance. */
-        float dx[3] = {pjx - pix, pjy - piy, pjz - piz};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        /* Recover pi */
+        const int ki = hot_i->ngb[n];
+        struct part *pi = &parts_i[sort_i[count_i - 1 - ki].i];
+        const float hi = hot_i->h[ki];
+
+        float dx[3] = {hot_i->ngb_dx[n], hot_i->ngb_dy[n], hot_i->ngb_dz[n]};
+        const float r2 = hot_i->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
+        const float pix = hot_i->x[ki];
+        const float piy = hot_i->y[ki];
+        const float piz = hot_i->z[ki];
+
         /* Check that particles are in the correct frame after the shifts */
         if (pix > shift_threshold_x || pix < -shift_threshold_x)
           error(
@@ -1299,25 +2356,21 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 #endif
 #endif
 
-        /* Hit or miss? */
-        if (r2 < hjg2) {
-
-          IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
-          IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
+        IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+        IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-          runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
-          runner_iact_nonsym_pressure_floor(r2, dx, hj, hi, pj, pi, a, H);
-          runner_iact_nonsym_star_formation(r2, dx, hj, hi, pj, pi, a, H);
-          runner_iact_nonsym_sink(r2, dx, hj, hi, pj, pi, a, H,
-                                  e->sink_properties->cut_off_radius);
+        runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
+        runner_iact_nonsym_pressure_floor(r2, dx, hj, hi, pj, pi, a, H);
+        runner_iact_nonsym_star_formation(r2, dx, hj, hi, pj, pi, a, H);
+        runner_iact_nonsym_sink(r2, dx, hj, hi, pj, pi, a, H,
+                                e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-          runner_iact_nonsym_timebin(r2, dx, hj, hi, pj, pi, a, H);
-          runner_iact_nonsym_rt_timebin(r2, dx, hj, hi, pj, pi, a, H);
-          runner_iact_nonsym_diffusion(r2, dx, hj, hi, pj, pi, a, H, time_base,
-                                       t_current, cosmo, with_cosmology);
+        runner_iact_nonsym_timebin(r2, dx, hj, hi, pj, pi, a, H);
+        runner_iact_nonsym_rt_timebin(r2, dx, hj, hi, pj, pi, a, H);
+        runner_iact_nonsym_diffusion(r2, dx, hj, hi, pj, pi, a, H, time_base,
+                                     t_current, cosmo, with_cosmology);
 #endif
-        }
       } /* loop over the parts in ci. */
     } /* loop over the parts in cj. */
   } /* Cell cj is active */
@@ -1405,8 +2458,31 @@ void DOPAIR1_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
   }
 #endif /* SWIFT_DEBUG_CHECKS */
 
+#if !defined(SWIFT_USE_NAIVE_INTERACTIONS)
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+  /* Record the pairs for the next loops? */
+  if (e->hydro_properties->use_neighbour_lists && ci->nodeID == e->nodeID &&
+      cj->nodeID == e->nodeID) {
+    DOPAIR1_BUILD_NLIST(r, ci, cj, sid, shift);
+    return;
+  }
+#elif (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT)
+  /* Can we re-use the pairs found by the density loop? */
+  if (e->hydro_properties->use_neighbour_lists) {
+    const struct hydro_nlist *nlist =
+        hydro_nlist_get(&r->nlist_arena, ci, cj, sid, e);
+    if (nlist != NULL) {
+      DOPAIR1_NLIST(r, ci, cj, shift, nlist);
+      return;
+    }
+  }
+#endif
+#endif
+
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOPAIR1_NAIVE(r, ci, cj);
+#elif defined(DO_VEC_IACT)
+  DOPAIR_VEC(r, ci, cj, sid, shift);
 #elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
   if (!sort_is_corner(sid))
@@ -1421,6 +2497,9 @@ void DOPAIR1_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
 /**
  * @brief Compute the interactions between a cell pair (symmetric)
  *
+ * As in #DOPAIR1, the neighbour search runs over the runner's
+ * #hydro_hot_cache.
+ *
  * @param r The #runner.
  * @param ci The first #cell.
  * @param cj The second #cell.
@@ -1487,43 +2566,71 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
                              cj->loc[2] + shift[2]};
   const double shift_j[3] = {cj->loc[0], cj->loc[1], cj->loc[2]};
 
+  /* Copy the particles that the loops over ci and cj will visit to the
+   * caches. The particles of ci are stored from the right end of the sorted
+   * list, those of cj from the left end. */
+  struct hydro_hot_cache *restrict hot_i = &r->ci_hot_cache;
+  struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot_i, count_i);
+  hydro_hot_cache_reserve(hot_j, count_j);
+  int num_i = 0, num_j = 0;
+  double di_reach = -FLT_MAX, dj_reach = FLT_MAX;
+  for (; num_i < count_i && sort_i[count_i - 1 - num_i].d +
+                                    hi_max * kernel_gamma + dx_max - rshift >
+                                dj_min;
+       num_i++) {
+    const int pid = count_i - 1 - num_i;
+    HOT_CACHE_READ(e, &parts_i[sort_i[pid].i], shift_i, hot_i, num_i);
+    if (!hot_i->inhibited[num_i])
+      di_reach = max(di_reach, sort_i[pid].d + hot_i->h[num_i] * kernel_gamma +
+                                   dx_max - rshift);
+  }
+  for (; num_j < count_j && sort_j[num_j].d - hj_max * kernel_gamma - dx_max <
+                                di_max - rshift;
+       num_j++) {
+    HOT_CACHE_READ(e, &parts_j[sort_j[num_j].i], shift_j, hot_j, num_j);
+    if (!hot_j->inhibited[num_j])
+      dj_reach = min(dj_reach, sort_j[num_j].d -
+                                   hot_j->h[num_j] * kernel_gamma - dx_max);
+  }
+  for (; num_j < count_j && sort_j[num_j].d < di_reach; num_j++)
+    HOT_CACHE_READ(e, &parts_j[sort_j[num_j].i], shift_j, hot_j, num_j);
+  for (; num_i < count_i && sort_i[count_i - 1 - num_i].d - rshift > dj_reach;
+       num_i++)
+    HOT_CACHE_READ(e, &parts_i[sort_i[count_i - 1 - num_i].i], shift_i, hot_i,
+                   num_i);
+
+  /* Collect the active particles of the caches. The sort entries point to
+   * the particles' positions in the caches rather than in the cells. */
   int count_active_i = 0, count_active_j = 0;
   struct sort_entry *restrict sort_active_i = NULL;
   struct sort_entry *restrict sort_active_j = NULL;
 
-  // MATTHIEU: temporary disable this optimization
-  if (0 /*&& cell_is_all_active_hydro(ci, e)*/) {
-    /* If everybody is active don't bother copying */
-    sort_active_i = sort_i;
-    count_active_i = count_i;
-  } else if (CELL_IS_ACTIVE(ci, e)) {
+  if (CELL_IS_ACTIVE(ci, e)) {
     if (posix_memalign((void **)&sort_active_i, SWIFT_CACHE_ALIGNMENT,
                        sizeof(struct sort_entry) * count_i) != 0)
       error("Failed to allocate active sortlists.");
 
     /* Collect the active particles in ci */
-    for (int k = 0; k < count_i; k++) {
-      if (PART_IS_ACTIVE(&parts_i[sort_i[k].i], e)) {
-        sort_active_i[count_active_i] = sort_i[k];
+    for (int k = num_i - 1; k >= 0; k--) {
+      if (hot_i->active[k]) {
+        sort_active_i[count_active_i].d = sort_i[count_i - 1 - k].d;
+        sort_active_i[count_active_i].i = k;
         count_active_i++;
       }
     }
   }
 
-  // MATTHIEU: temporary disable this optimization
-  if (0 /*&& cell_is_all_active_hydro(cj, e)*/) {
-    /* If everybody is active don't bother copying */
-    sort_active_j = sort_j;
-    count_active_j = count_j;
-  } else if (CELL_IS_ACTIVE(cj, e)) {
+  if (CELL_IS_ACTIVE(cj, e)) {
     if (posix_memalign((void **)&sort_active_j, SWIFT_CACHE_ALIGNMENT,
                        sizeof(struct sort_entry) * count_j) != 0)
       error("Failed to allocate active sortlists.");
 
     /* Collect the active particles in cj */
-    for (int k = 0; k < count_j; k++) {
-      if (PART_IS_ACTIVE(&parts_j[sort_j[k].i], e)) {
-        sort_active_j[count_active_j] = sort_j[k];
+    for (int k = 0; k < num_j; k++) {
+      if (hot_j->active[k]) {
+        sort_active_j[count_active_j].d = sort_j[k].d;
+        sort_active_j[count_active_j].i = k;
         count_active_j++;
       }
     }
@@ -1537,47 +2644,48 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
        pid--) {
 
     /* Get a hold of the ith part in ci. */
-    struct part *pi = &parts_i[sort_i[pid].i];
+    const int ki = count_i - 1 - pid;
 
     /* Skip inhibited particles. */
-    if (part_is_inhibited(pi, e)) continue;
+    if (hot_i->inhibited[ki]) continue;
 
-    const float hi = pi->h;
+    const float hi = hot_i->h[ki];
 
     /* Is there anything we need to interact with (for this specific hi) ? */
     const double di = sort_i[pid].d + hi * kernel_gamma + dx_max - rshift;
     if (di < dj_min) continue;
 
     /* Get some additional information about pi */
+    struct part *pi = &parts_i[sort_i[pid].i];
     const float hig2 = hi * hi * kernel_gamma2;
-    const float pix = pi->x[0] - shift_i[0];
-    const float piy = pi->x[1] - shift_i[1];
-    const float piz = pi->x[2] - shift_i[2];
+    const float pix = hot_i->x[ki];
+    const float piy = hot_i->y[ki];
+    const float piz = hot_i->z[ki];
 
     /* Do we need to only check active parts in cj
        (i.e. pi does not need updating) ? */
-    if (!PART_IS_ACTIVE(pi, e)) {
+    if (!hot_i->active[ki]) {
 
       /* Loop over the *active* parts in cj within range of pi */
       for (int pjd = 0; pjd < count_active_j && sort_active_j[pjd].d < di;
            pjd++) {
 
         /* Recover pj */
-        struct part *pj = &parts_j[sort_active_j[pjd].i];
+        const int kj = sort_active_j[pjd].i;
 
         /* Skip inhibited particles.
          * Note we are looping over active particles but in the case where
          * the cell thinks all the particles are active (because of the
          * ti_end_max), particles may have nevertheless been inhibted by BH
          * swallowing in the mean time. */
-        if (part_is_inhibited(pj, e)) continue;
+        if (hot_j->inhibited[kj]) continue;
 
-        const float hj = pj->h;
+        const float hj = hot_j->h[kj];
 
         /* Get the position of pj in the right frame */
-        const float pjx = pj->x[0] - shift_j[0];
-        const float pjy = pj->x[1] - shift_j[1];
-        const float pjz = pj->x[2] - shift_j[2];
+        const float pjx = hot_j->x[kj];
+        const float pjy = hot_j->y[kj];
+        const float pjz = hot_j->z[kj];
 
         /* Compute the pairwise distance. */
         const float dx[3] = {pjx - pix, pjy - piy, pjz - piz};
@@ -1615,7 +2723,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         if (pi->ti_drift != e->ti_current)
           error("Particle pi not drifted to current time");
 
-        if (pj->ti_drift != e->ti_current)
+        if (parts_j[sort_j[kj].i].ti_drift != e->ti_current)
           error("Particle pj not drifted to current time");
 #endif
 #endif
@@ -1623,6 +2731,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         /* Hit or miss?
            (note that we will do the other condition in the reverse loop) */
         if (r2 < hig2) {
+          struct part *pj = &parts_j[sort_j[kj].i];
           IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
           IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -1644,27 +2753,35 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
     else { /* pi is active, we may need to update pi and pj */
 
-      /* Loop over *all* the parts in cj in range of pi. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      /* Find the neighbours of pi amongst the parts of cj in range. */
+      int last_j = 0;
+      while (last_j < count_j && sort_j[last_j].d < di) last_j++;
 
-        /* Recover pj */
-        struct part *pj = &parts_j[sort_j[pjd].i];
+#ifdef SWIFT_DEBUG_CHECKS
+      if (last_j > num_j) error("Particle pj is not in the hot cache.");
+#endif
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
+      const int num_ngb = hydro_hot_cache_search(
+          hot_j, 0, last_j, pix, piy, piz, hig2, hydro_hot_search_gather);
 
-        const float hj = pj->h;
+      /* Loop over the neighbours in cj.
+         (note that we will do the other condition in the reverse loop) */
+      for (int n = 0; n < num_ngb; n++) {
 
-        /* Get the position of pj in the right frame */
-        const float pjx = pj->x[0] - shift_j[0];
-        const float pjy = pj->x[1] - shift_j[1];
-        const float pjz = pj->x[2] - shift_j[2];
+        /* Recover pj */
+        const int pjd = hot_j->ngb[n];
+        struct part *pj = &parts_j[sort_j[pjd].i];
+        const float hj = hot_j->h[pjd];
 
-        /* Compute the pairwise distance. */
-        const float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        const float dx[3] = {hot_j->ngb_dx[n], hot_j->ngb_dy[n],
+                             hot_j->ngb_dz[n]};
+        const float r2 = hot_j->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
+        const float pjx = hot_j->x[pjd];
+        const float pjy = hot_j->y[pjd];
+        const float pjz = hot_j->z[pjd];
+
         /* Check that particles are in the correct frame after the shifts */
         if (pix > shift_threshold_x || pix < -shift_threshold_x)
           error(
@@ -1700,45 +2817,41 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
           error("Particle pj not drifted to current time");
 #endif
 #endif
-        /* Hit or miss?
-           (note that we will do the other condition in the reverse loop) */
-        if (r2 < hig2) {
 
-          /* Does pj need to be updated too? */
-          if (PART_IS_ACTIVE(pj, e)) {
-            IACT(r2, dx, hi, hj, pi, pj, a, H);
-            IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+        /* Does pj need to be updated too? */
+        if (hot_j->active[pjd]) {
+          IACT(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
-                             e->sink_properties->cut_off_radius);
+          runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
+                           e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
-                                  t_current, cosmo, with_cosmology);
+          runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
+                                t_current, cosmo, with_cosmology);
 #endif
-          } else {
-            IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
-            IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+        } else {
+          IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
-                                    e->sink_properties->cut_off_radius);
+          runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                                  e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H,
-                                         time_base, t_current, cosmo,
-                                         with_cosmology);
+          runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H,
+                                       time_base, t_current, cosmo,
+                                       with_cosmology);
 #endif
-          }
         }
       } /* loop over the parts in cj. */
     } /* Is pi active? */
@@ -1748,52 +2861,50 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
      we are out of range of anything in ci (using the maximal hj). */
   for (int pjd = 0;
        pjd < count_j &&
-       sort_j[pjd].d - hj_max * kernel_gamma - dx_max < di_max - rshift;
-       pjd++) {
-
-    /* Get a hold of the jth part in cj. */
-    struct part *pj = &parts_j[sort_j[pjd].i];
+       sort_j[pjd].d - hj_max * kernel_gamma - dx_max < di_max - rshift;
+       pjd++) {
 
     /* Skip inhibited particles. */
-    if (part_is_inhibited(pj, e)) continue;
+    if (hot_j->inhibited[pjd]) continue;
 
-    const float hj = pj->h;
+    const float hj = hot_j->h[pjd];
 
     /* Is there anything we need to interact with (for this specific hj) ? */
     const double dj = sort_j[pjd].d - hj * kernel_gamma - dx_max;
     if (dj > di_max - rshift) continue;
 
     /* Get some additional information about pj */
+    struct part *pj = &parts_j[sort_j[pjd].i];
     const float hjg2 = hj * hj * kernel_gamma2;
-    const float pjx = pj->x[0] - shift_j[0];
-    const float pjy = pj->x[1] - shift_j[1];
-    const float pjz = pj->x[2] - shift_j[2];
+    const float pjx = hot_j->x[pjd];
+    const float pjy = hot_j->y[pjd];
+    const float pjz = hot_j->z[pjd];
 
     /* Do we need to only check active parts in ci
        (i.e. pj does not need updating) ? */
-    if (!PART_IS_ACTIVE(pj, e)) {
+    if (!hot_j->active[pjd]) {
 
       /* Loop over the *active* parts in ci. */
       for (int pid = count_active_i - 1;
            pid >= 0 && sort_active_i[pid].d - rshift > dj; pid--) {
 
         /* Recover pi */
-        struct part *pi = &parts_i[sort_active_i[pid].i];
+        const int ki = sort_active_i[pid].i;
 
         /* Skip inhibited particles.
          * Note we are looping over active particles but in the case where
          * the cell thinks all the particles are active (because of the
          * ti_end_max), particles may have nevertheless been inhibted by BH
          * swallowing in the mean time. */
-        if (part_is_inhibited(pi, e)) continue;
+        if (hot_i->inhibited[ki]) continue;
 
-        const float hi = pi->h;
+        const float hi = hot_i->h[ki];
         const float hig2 = hi * hi * kernel_gamma2;
 
         /* Get the position of pi in the right frame */
-        const float pix = pi->x[0] - shift_i[0];
-        const float piy = pi->x[1] - shift_i[1];
-        const float piz = pi->x[2] - shift_i[2];
+        const float pix = hot_i->x[ki];
+        const float piy = hot_i->y[ki];
+        const float piz = hot_i->z[ki];
 
         /* Compute the pairwise distance. */
         const float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
@@ -1828,7 +2939,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
 #if defined(DO_DRIFT_DEBUG_CHECKS)
         /* Check that particles have been drifted to the current time */
-        if (pi->ti_drift != e->ti_current)
+        if (parts_i[sort_i[count_i - 1 - ki].i].ti_drift != e->ti_current)
           error("Particle pi not drifted to current time");
         if (pj->ti_drift != e->ti_current)
           error("Particle pj not drifted to current time");
@@ -1838,6 +2949,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         /* Hit or miss?
            (note that we must avoid the r2 < hig2 cases we already processed) */
         if (r2 < hjg2 && r2 >= hig2) {
+          struct part *pi = &parts_i[sort_i[count_i - 1 - ki].i];
           IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
           IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -1859,29 +2971,36 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
     else { /* pj is active, we may need to update pj and pi */
 
-      /* Loop over *all* the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d - rshift > dj;
-           pid--) {
+      /* Find the neighbours of pj amongst the parts of ci in range. */
+      int last_i = 0;
+      while (last_i < count_i && sort_i[count_i - 1 - last_i].d - rshift > dj)
+        last_i++;
 
-        /* Recover pi */
-        struct part *pi = &parts_i[sort_i[pid].i];
+#ifdef SWIFT_DEBUG_CHECKS
+      if (last_i > num_i) error("Particle pi is not in the hot cache.");
+#endif
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pi, e)) continue;
+      const int num_ngb = hydro_hot_cache_search(
+          hot_i, 0, last_i, pjx, pjy, pjz, hjg2, hydro_hot_search_gather);
 
-        const float hi = pi->h;
-        const float hig2 = hi * hi * kernel_gamma2;
+      /* Loop over the neighbours in ci. */
+      for (int n = 0; n < num_ngb; n++) {
 
-        /* Get the position of pi in the right frame */
-        const float pix = pi->x[0] - shift_i[0];
-        const float piy = pi->x[1] - shift_i[1];
-        const float piz = pi->x[2] - shift_i[2];
+        /* Recover pi */
+        const int ki = hot_i->ngb[n];
+        struct part *pi = &parts_i[sort_i[count_i - 1 - ki].i];
+        const float hi = hot_i->h[ki];
+        const float hig2 = hi * hi * kernel_gamma2;
 
-        /* Compute the pairwise distance. */
-        const float dx[3] = {pjx - pix, pjy - piy, pjz - piz};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        const float dx[3] = {hot_i->ngb_dx[n], hot_i->ngb_dy[n],
+                             hot_i->ngb_dz[n]};
+        const float r2 = hot_i->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
+        const float pix = hot_i->x[ki];
+        const float piy = hot_i->y[ki];
+        const float piz = hot_i->z[ki];
+
         /* Check that particles are in the correct frame after the shifts */
         if (pix > shift_threshold_x || pix < -shift_threshold_x)
           error(
@@ -1919,10 +3038,10 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
         /* Hit or miss?
            (note that we must avoid the r2 < hig2 cases we already processed) */
-        if (r2 < hjg2 && r2 >= hig2) {
+        if (r2 >= hig2) {
 
           /* Does pi need to be updated too? */
-          if (PART_IS_ACTIVE(pi, e)) {
+          if (hot_i->active[ki]) {
             IACT(r2, dx, hj, hi, pj, pi, a, H);
             IACT_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -1961,11 +3080,9 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     } /* Is pj active? */
   } /* Loop over all cj */
 
-  /* Clean-up if necessary */  // MATTHIEU: temporary disable this optimization
-  if (CELL_IS_ACTIVE(ci, e))   // && !cell_is_all_active_hydro(ci, e))
-    free(sort_active_i);
-  if (CELL_IS_ACTIVE(cj, e))  // && !cell_is_all_active_hydro(cj, e))
-    free(sort_active_j);
+  /* Clean-up if necessary */
+  if (CELL_IS_ACTIVE(ci, e)) free(sort_active_i);
+  if (CELL_IS_ACTIVE(cj, e)) free(sort_active_j);
 
   TIMER_TOC(TIMER_DOPAIR);
 }
@@ -2050,8 +3167,23 @@ void DOPAIR2_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
   }
 #endif /* SWIFT_DEBUG_CHECKS */
 
+#if !defined(SWIFT_USE_NAIVE_INTERACTIONS) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  /* Can we re-use the pairs found by the density loop? */
+  if (e->hydro_properties->use_neighbour_lists) {
+    const struct hydro_nlist *nlist =
+        hydro_nlist_get(&r->nlist_arena, ci, cj, sid, e);
+    if (nlist != NULL) {
+      DOPAIR2_NLIST(r, ci, cj, shift, nlist);
+      return;
+    }
+  }
+#endif
+
 #ifdef SWIFT_USE_NAIVE_INTERACTIONS
   DOPAIR2_NAIVE(r, ci, cj);
+#elif defined(DO_VEC_IACT)
+  DOPAIR_VEC(r, ci, cj, sid, shift);
 #elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
   if (!sort_is_corner(sid))
@@ -2066,6 +3198,9 @@ void DOPAIR2_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
 /**
  * @brief Compute the cell self-interaction (non-symmetric).
  *
+ * As in #DOPAIR1, the neighbour search runs over the runner's
+ * #hydro_hot_cache.
+ *
  * @param r The #runner.
  * @param c The #cell.
  */
@@ -2084,6 +3219,13 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
   struct part *restrict parts = c->hydro.parts;
   const int count = c->hydro.count;
 
+  /* Copy the fields read by the neighbour search, in the frame of the
+   * cell. */
+  struct hydro_hot_cache *restrict hot = &r->ci_hot_cache;
+  hydro_hot_cache_reserve(hot, count);
+  const double loc[3] = {c->loc[0], c->loc[1], c->loc[2]};
+  for (int k = 0; k < count; k++) HOT_CACHE_READ(e, &parts[k], loc, hot, k);
+
   /* Set up indt. */
   int *indt = NULL;
   int countdt = 0, firstdt = 0;
@@ -2091,7 +3233,7 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
                      count * sizeof(int)) != 0)
     error("Failed to allocate indt.");
   for (int k = 0; k < count; k++)
-    if (PART_IS_ACTIVE(&parts[k], e)) {
+    if (hot->active[k]) {
       indt[countdt] = k;
       countdt += 1;
     }
@@ -2104,47 +3246,45 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
   /* Loop over the particles in the cell. */
   for (int pid = 0; pid < count; pid++) {
 
+    /* Skip inhibited particles. */
+    if (hot->inhibited[pid]) continue;
+
     /* Get a pointer to the ith particle. */
     struct part *restrict pi = &parts[pid];
 
-    /* Skip inhibited particles. */
-    if (part_is_inhibited(pi, e)) continue;
-
     /* Get the particle position and radius. */
-    double pix[3];
-    for (int k = 0; k < 3; k++) pix[k] = pi->x[k];
-    const float hi = pi->h;
+    const float pix[3] = {hot->x[pid], hot->y[pid], hot->z[pid]};
+    const float hi = hot->h[pid];
     const float hig2 = hi * hi * kernel_gamma2;
 
     /* Is the ith particle inactive? */
-    if (!PART_IS_ACTIVE(pi, e)) {
+    if (!hot->active[pid]) {
 
       /* Loop over the other particles .*/
       for (int pjd = firstdt; pjd < countdt; pjd++) {
 
-        /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts[indt[pjd]];
-        const float hj = pj->h;
+        const int kj = indt[pjd];
+        const float hj = hot->h[kj];
 
 #if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
         /* Check that particles have been drifted to the current time */
         if (pi->ti_drift != e->ti_current)
           error("Particle pi not drifted to current time");
-        if (pj->ti_drift != e->ti_current)
+        if (parts[kj].ti_drift != e->ti_current)
           error("Particle pj not drifted to current time");
 #endif
 
         /* Compute the pairwise distance. */
-        float r2 = 0.0f;
-        float dx[3];
-        for (int k = 0; k < 3; k++) {
-          dx[k] = pj->x[k] - pix[k];
-          r2 += dx[k] * dx[k];
-        }
+        float dx[3] = {hot->x[kj] - pix[0], hot->y[kj] - pix[1],
+                       hot->z[kj] - pix[2]};
+        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
 
         /* Hit or miss? */
         if (r2 < hj * hj * kernel_gamma2) {
 
+          /* Get a pointer to the jth particle. */
+          struct part *restrict pj = &parts[kj];
+
           IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
           IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -2170,27 +3310,22 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
       /* We caught a live one! */
       firstdt += 1;
 
-      /* Loop over the other particles .*/
-      for (int pjd = pid + 1; pjd < count; pjd++) {
+      /* Find the neighbours of pi amongst the other particles. */
+      const int num_ngb = hydro_hot_cache_search(
+          hot, pid + 1, count, pix[0], pix[1], pix[2], hig2,
+          hydro_hot_search_gather_active_scatter);
+
+      /* Loop over the neighbours. */
+      for (int n = 0; n < num_ngb; n++) {
 
         /* Get a pointer to the jth particle. */
+        const int pjd = hot->ngb[n];
         struct part *restrict pj = &parts[pjd];
+        const float hj = hot->h[pjd];
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
-
-        const float hj = pj->h;
-
-        /* Compute the pairwise distance. */
-        float r2 = 0.0f;
-        float dx[3];
-        for (int k = 0; k < 3; k++) {
-          dx[k] = pix[k] - pj->x[k];
-          r2 += dx[k] * dx[k];
-        }
-        const int doj =
-            (PART_IS_ACTIVE(pj, e)) && (r2 < hj * hj * kernel_gamma2);
-
+        float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+        const float r2 = hot->ngb_r2[n];
+        const int doj = hot->active[pjd] && (r2 < hj * hj * kernel_gamma2);
         const int doi = (r2 < hig2);
 
 #if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
@@ -2201,67 +3336,63 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
           error("Particle pj not drifted to current time");
 #endif
 
-        /* Hit or miss? */
-        if (doi || doj) {
-
-          /* Which parts need to be updated? */
-          if (doi && doj) {
+        /* Which parts need to be updated? */
+        if (doi && doj) {
 
-            IACT(r2, dx, hi, hj, pi, pj, a, H);
-            IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+          IACT(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
-                             e->sink_properties->cut_off_radius);
+          runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
+                           e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
-                                  t_current, cosmo, with_cosmology);
+          runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
+                                t_current, cosmo, with_cosmology);
 #endif
-          } else if (doi) {
+        } else if (doi) {
 
-            IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
-            IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+          IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
-                                    e->sink_properties->cut_off_radius);
+          runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                                  e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H,
-                                         time_base, t_current, cosmo,
-                                         with_cosmology);
+          runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H,
+                                       time_base, t_current, cosmo,
+                                       with_cosmology);
 #endif
-          } else if (doj) {
+        } else if (doj) {
 
-            dx[0] = -dx[0];
-            dx[1] = -dx[1];
-            dx[2] = -dx[2];
-            IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
-            IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
+          dx[0] = -dx[0];
+          dx[1] = -dx[1];
+          dx[2] = -dx[2];
+          IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+          IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
-            runner_iact_nonsym_pressure_floor(r2, dx, hj, hi, pj, pi, a, H);
-            runner_iact_nonsym_star_formation(r2, dx, hj, hi, pj, pi, a, H);
-            runner_iact_nonsym_sink(r2, dx, hj, hi, pj, pi, a, H,
-                                    e->sink_properties->cut_off_radius);
+          runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
+          runner_iact_nonsym_pressure_floor(r2, dx, hj, hi, pj, pi, a, H);
+          runner_iact_nonsym_star_formation(r2, dx, hj, hi, pj, pi, a, H);
+          runner_iact_nonsym_sink(r2, dx, hj, hi, pj, pi, a, H,
+                                  e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_nonsym_timebin(r2, dx, hj, hi, pj, pi, a, H);
-            runner_iact_nonsym_rt_timebin(r2, dx, hj, hi, pj, pi, a, H);
-            runner_iact_nonsym_diffusion(r2, dx, hj, hi, pj, pi, a, H,
-                                         time_base, t_current, cosmo,
-                                         with_cosmology);
+          runner_iact_nonsym_timebin(r2, dx, hj, hi, pj, pi, a, H);
+          runner_iact_nonsym_rt_timebin(r2, dx, hj, hi, pj, pi, a, H);
+          runner_iact_nonsym_diffusion(r2, dx, hj, hi, pj, pi, a, H,
+                                       time_base, t_current, cosmo,
+                                       with_cosmology);
 #endif
-          }
         }
       } /* loop over all other particles. */
     }
@@ -2297,8 +3428,30 @@ void DOSELF1_BRANCH(struct runner *r, struct cell *c) {
   /* Check that cells are drifted. */
   if (!CELL_ARE_PART_DRIFTED(c, e)) error("Interacting undrifted cell.");
 
+#if !defined(SWIFT_USE_NAIVE_INTERACTIONS)
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+  /* Record the pairs for the next loops? */
+  if (e->hydro_properties->use_neighbour_lists && c->nodeID == e->nodeID) {
+    DOSELF1_BUILD_NLIST(r, c);
+    return;
+  }
+#elif (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT)
+  /* Can we re-use the pairs found by the density loop? */
+  if (e->hydro_properties->use_neighbour_lists) {
+    const struct hydro_nlist *nlist =
+        hydro_nlist_get(&r->nlist_arena, c, c, hydro_nlist_self_slot, e);
+    if (nlist != NULL) {
+      DOSELF1_NLIST(r, c, nlist);
+      return;
+    }
+  }
+#endif
+#endif
+
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOSELF1_NAIVE(r, c);
+#elif defined(DO_VEC_IACT)
+  DOSELF_VEC(r, c);
 #elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
   runner_doself1_density_vec(r, c);
@@ -2310,6 +3463,9 @@ void DOSELF1_BRANCH(struct runner *r, struct cell *c) {
 /**
  * @brief Compute the cell self-interaction (symmetric).
  *
+ * As in #DOSELF1, the neighbour search runs over the runner's
+ * #hydro_hot_cache.
+ *
  * @param r The #runner.
  * @param c The #cell.
  */
@@ -2328,6 +3484,13 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
   struct part *restrict parts = c->hydro.parts;
   const int count = c->hydro.count;
 
+  /* Copy the fields read by the neighbour search, in the frame of the
+   * cell. */
+  struct hydro_hot_cache *restrict hot = &r->ci_hot_cache;
+  hydro_hot_cache_reserve(hot, count);
+  const double loc[3] = {c->loc[0], c->loc[1], c->loc[2]};
+  for (int k = 0; k < count; k++) HOT_CACHE_READ(e, &parts[k], loc, hot, k);
+
   /* Set up indt. */
   int *indt = NULL;
   int countdt = 0, firstdt = 0;
@@ -2335,7 +3498,7 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
                      count * sizeof(int)) != 0)
     error("Failed to allocate indt.");
   for (int k = 0; k < count; k++)
-    if (PART_IS_ACTIVE(&parts[k], e)) {
+    if (hot->active[k]) {
       indt[countdt] = k;
       countdt += 1;
     }
@@ -2348,47 +3511,45 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
   /* Loop over the particles in the cell. */
   for (int pid = 0; pid < count; pid++) {
 
+    /* Skip inhibited particles. */
+    if (hot->inhibited[pid]) continue;
+
     /* Get a pointer to the ith particle. */
     struct part *restrict pi = &parts[pid];
 
-    /* Skip inhibited particles. */
-    if (part_is_inhibited(pi, e)) continue;
-
     /* Get the particle position and radius. */
-    double pix[3];
-    for (int k = 0; k < 3; k++) pix[k] = pi->x[k];
-    const float hi = pi->h;
+    const float pix[3] = {hot->x[pid], hot->y[pid], hot->z[pid]};
+    const float hi = hot->h[pid];
     const float hig2 = hi * hi * kernel_gamma2;
 
     /* Is the ith particle not active? */
-    if (!PART_IS_ACTIVE(pi, e)) {
+    if (!hot->active[pid]) {
 
       /* Loop over the other particles .*/
       for (int pjd = firstdt; pjd < countdt; pjd++) {
 
-        /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts[indt[pjd]];
-        const float hj = pj->h;
+        const int kj = indt[pjd];
+        const float hj = hot->h[kj];
 
         /* Compute the pairwise distance. */
-        float r2 = 0.0f;
-        float dx[3];
-        for (int k = 0; k < 3; k++) {
-          dx[k] = pj->x[k] - pix[k];
-          r2 += dx[k] * dx[k];
-        }
+        float dx[3] = {hot->x[kj] - pix[0], hot->y[kj] - pix[1],
+                       hot->z[kj] - pix[2]};
+        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
 
 #if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
         /* Check that particles have been drifted to the current time */
         if (pi->ti_drift != e->ti_current)
           error("Particle pi not drifted to current time");
-        if (pj->ti_drift != e->ti_current)
+        if (parts[kj].ti_drift != e->ti_current)
           error("Particle pj not drifted to current time");
 #endif
 
         /* Hit or miss? */
         if (r2 < hig2 || r2 < hj * hj * kernel_gamma2) {
 
+          /* Get a pointer to the jth particle. */
+          struct part *restrict pj = &parts[kj];
+
           IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
           IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -2414,24 +3575,21 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
       /* We caught a live one! */
       firstdt += 1;
 
-      /* Loop over the other particles .*/
-      for (int pjd = pid + 1; pjd < count; pjd++) {
+      /* Find the neighbours of pi amongst the other particles. */
+      const int num_ngb = hydro_hot_cache_search(
+          hot, pid + 1, count, pix[0], pix[1], pix[2], hig2,
+          hydro_hot_search_gather_scatter);
+
+      /* Loop over the neighbours. */
+      for (int n = 0; n < num_ngb; n++) {
 
         /* Get a pointer to the jth particle. */
+        const int pjd = hot->ngb[n];
         struct part *restrict pj = &parts[pjd];
+        const float hj = hot->h[pjd];
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
-
-        const float hj = pj->h;
-
-        /* Compute the pairwise distance. */
-        float r2 = 0.0f;
-        float dx[3];
-        for (int k = 0; k < 3; k++) {
-          dx[k] = pix[k] - pj->x[k];
-          r2 += dx[k] * dx[k];
-        }
+        float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+        const float r2 = hot->ngb_r2[n];
 
 #if defined(SWIFT_DEBUG_CHECKS) && defined(DO_DRIFT_DEBUG_CHECKS)
         /* Check that particles have been drifted to the current time */
@@ -2441,44 +3599,40 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
           error("Particle pj not drifted to current time");
 #endif
 
-        /* Hit or miss? */
-        if (r2 < hig2 || r2 < hj * hj * kernel_gamma2) {
-
-          /* Does pj need to be updated too? */
-          if (PART_IS_ACTIVE(pj, e)) {
-            IACT(r2, dx, hi, hj, pi, pj, a, H);
-            IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+        /* Does pj need to be updated too? */
+        if (hot->active[pjd]) {
+          IACT(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
-                             e->sink_properties->cut_off_radius);
+          runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_sink(r2, dx, hi, hj, pi, pj, a, H,
+                           e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
-                                  t_current, cosmo, with_cosmology);
+          runner_iact_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_diffusion(r2, dx, hi, hj, pi, pj, a, H, time_base,
+                                t_current, cosmo, with_cosmology);
 #endif
-          } else {
-            IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
-            IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+        } else {
+          IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-            runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
-                                    e->sink_properties->cut_off_radius);
+          runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                                  e->sink_properties->cut_off_radius);
 #endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
-            runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
-            runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H,
-                                         time_base, t_current, cosmo,
-                                         with_cosmology);
+          runner_iact_nonsym_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_rt_timebin(r2, dx, hi, hj, pi, pj, a, H);
+          runner_iact_nonsym_diffusion(r2, dx, hi, hj, pi, pj, a, H,
+                                       time_base, t_current, cosmo,
+                                       with_cosmology);
 #endif
-          }
         }
       } /* loop over all other particles. */
     }
@@ -2514,8 +3668,23 @@ void DOSELF2_BRANCH(struct runner *r, struct cell *c) {
   /* Check that cells are drifted. */
   if (!CELL_ARE_PART_DRIFTED(c, e)) error("Interacting undrifted cell.");
 
+#if !defined(SWIFT_USE_NAIVE_INTERACTIONS) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
+  /* Can we re-use the pairs found by the density loop? */
+  if (e->hydro_properties->use_neighbour_lists) {
+    const struct hydro_nlist *nlist =
+        hydro_nlist_get(&r->nlist_arena, c, c, hydro_nlist_self_slot, e);
+    if (nlist != NULL) {
+      DOSELF2_NLIST(r, c, nlist);
+      return;
+    }
+  }
+#endif
+
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOSELF2_NAIVE(r, c);
+#elif defined(DO_VEC_IACT)
+  DOSELF_VEC(r, c);
 #elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
   runner_doself2_force_vec(r, c);
@@ -2558,8 +3727,15 @@ void DOSUB_PAIR1(struct runner *r, struct cell *ci, struct cell *cj,
     for (int k = 0; k < csp->count; k++) {
       const int pid = csp->pairs[k].pid;
       const int pjd = csp->pairs[k].pjd;
-      if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL)
+      if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL) {
+        if (cell_can_skip_drifted_pair_hydro_task(
+                ci->progeny[pid], cj->progeny[pjd], shift, r->e->ti_current,
+                r->e->nodeID)) {
+          r->culled_subpairs++;
+          continue;
+        }
         DOSUB_PAIR1(r, ci->progeny[pid], cj->progeny[pjd], 0);
+      }
     }
   }
 
@@ -2609,12 +3785,20 @@ void DOSUB_SELF1(struct runner *r, struct cell *ci, int gettimer) {
   if (cell_can_recurse_in_self_hydro_task(ci)) {
 
     /* Loop over all progeny. */
+    const double shift[3] = {0., 0., 0.};
     for (int k = 0; k < 8; k++)
       if (ci->progeny[k] != NULL) {
         DOSUB_SELF1(r, ci->progeny[k], 0);
-        for (int j = k + 1; j < 8; j++)
-          if (ci->progeny[j] != NULL)
-            DOSUB_PAIR1(r, ci->progeny[k], ci->progeny[j], 0);
+        for (int j = k + 1; j < 8; j++) {
+          if (ci->progeny[j] == NULL) continue;
+          if (cell_can_skip_drifted_pair_hydro_task(
+                  ci->progeny[k], ci->progeny[j], shift, r->e->ti_current,
+                  r->e->nodeID)) {
+            r->culled_subpairs++;
+            continue;
+          }
+          DOSUB_PAIR1(r, ci->progeny[k], ci->progeny[j], 0);
+        }
       }
   }
 
@@ -2664,8 +3848,15 @@ void DOSUB_PAIR2(struct runner *r, struct cell *ci, struct cell *cj,
     for (int k = 0; k < csp->count; k++) {
       const int pid = csp->pairs[k].pid;
       const int pjd = csp->pairs[k].pjd;
-      if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL)
+      if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL) {
+        if (cell_can_skip_drifted_pair_hydro_task(
+                ci->progeny[pid], cj->progeny[pjd], shift, r->e->ti_current,
+                r->e->nodeID)) {
+          r->culled_subpairs++;
+          continue;
+        }
         DOSUB_PAIR2(r, ci->progeny[pid], cj->progeny[pjd], 0);
+      }
     }
   }
 
@@ -2715,12 +3906,20 @@ void DOSUB_SELF2(struct runner *r, struct cell *ci, int gettimer) {
   if (cell_can_recurse_in_self_hydro_task(ci)) {
 
     /* Loop over all progeny. */
+    const double shift[3] = {0., 0., 0.};
     for (int k = 0; k < 8; k++)
       if (ci->progeny[k] != NULL) {
         DOSUB_SELF2(r, ci->progeny[k], 0);
-        for (int j = k + 1; j < 8; j++)
-          if (ci->progeny[j] != NULL)
-            DOSUB_PAIR2(r, ci->progeny[k], ci->progeny[j], 0);
+        for (int j = k + 1; j < 8; j++) {
+          if (ci->progeny[j] == NULL) continue;
+          if (cell_can_skip_drifted_pair_hydro_task(
+                  ci->progeny[k], ci->progeny[j], shift, r->e->ti_current,
+                  r->e->nodeID)) {
+            r->culled_subpairs++;
+            continue;
+          }
+          DOSUB_PAIR2(r, ci->progeny[k], ci->progeny[j], 0);
+        }
       }
 
   }
@@ -2817,3 +4016,165 @@ void DOSUB_SUBSET(struct runner *r, struct cell *ci, struct part *parts,
 
   if (gettimer) TIMER_TOC(timer_dosub_subset);
 }
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+
+/**
+ * @brief Recursively gather the particles of a cell that lie within a given
+ * distance of a particle.
+ *
+ * @param e The #engine.
+ * @param c The #cell to gather from.
+ * @param pi The particle we gather candidates for.
+ * @param pix The position of pi, shifted to the frame of @c c.
+ * @param r2_gather The square of the gathering radius.
+ * @param buffer The #hydro_ngb_buffer to append the candidates to.
+ */
+static void DO_GATHER_RECURSE(const struct engine *e, struct cell *c,
+                              const struct part *pi, const double pix[3],
+                              const float r2_gather,
+                              struct hydro_ngb_buffer *buffer) {
+
+  if (c->hydro.count == 0) return;
+
+  /* Distance between the particle and the cell, accounting for the
+   * particles that moved out of the cell since the last rebuild. */
+  const double dx_max = c->hydro.dx_max_part;
+  double d2 = 0.;
+  for (int k = 0; k < 3; k++) {
+    const double lo = c->loc[k] - dx_max;
+    const double hi = c->loc[k] + c->width[k] + dx_max;
+    const double d = pix[k] < lo ? lo - pix[k] : (pix[k] > hi ? pix[k] - hi : 0.);
+    d2 += d * d;
+  }
+  if (d2 >= r2_gather) return;
+
+  if (c->split) {
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        DO_GATHER_RECURSE(e, c->progeny[k], pi, pix, r2_gather, buffer);
+    return;
+  }
+
+  struct part *restrict parts = c->hydro.parts;
+  const int count = c->hydro.count;
+  for (int pjd = 0; pjd < count; pjd++) {
+
+    struct part *restrict pj = &parts[pjd];
+
+    /* Skip oneself and inhibited particles. */
+    if (pj == pi) continue;
+    if (part_is_inhibited(pj, e)) continue;
+
+    /* Compute the pairwise distance. */
+    float r2 = 0.0f;
+    float dx[3];
+    for (int k = 0; k < 3; k++) {
+      dx[k] = pix[k] - pj->x[k];
+      r2 += dx[k] * dx[k];
+    }
+
+    if (r2 < r2_gather) {
+      struct hydro_ngb_candidate *cand = hydro_ngb_buffer_add(buffer);
+      cand->pj = pj;
+      cand->dx[0] = dx[0];
+      cand->dx[1] = dx[1];
+      cand->dx[2] = dx[2];
+      cand->r2 = r2;
+    }
+  }
+}
+
+/**
+ * @brief Gather the candidate neighbours of a particle whose smoothing length
+ * has not converged, for one of the density interactions of its cell.
+ *
+ * This covers the same particles as DOSUB_SUBSET() would for this
+ * interaction, but within a radius set by @c h_gather rather than by the
+ * current smoothing length of the particle.
+ *
+ * @param r The #runner.
+ * @param ci The #cell of the interaction containing the particle.
+ * @param pi The particle.
+ * @param cj The other #cell of the interaction, NULL for a self-interaction.
+ * @param h_gather The smoothing length out to which we gather.
+ * @param buffer The #hydro_ngb_buffer to append the candidates to.
+ */
+void DOSUB_SUBSET_GATHER(struct runner *r, struct cell *ci,
+                         const struct part *pi, struct cell *cj,
+                         const float h_gather,
+                         struct hydro_ngb_buffer *buffer) {
+
+  const struct engine *e = r->e;
+  const float r2_gather = h_gather * h_gather * kernel_gamma2;
+
+  if (cj == NULL) {
+    const double pix[3] = {pi->x[0], pi->x[1], pi->x[2]};
+    DO_GATHER_RECURSE(e, ci, pi, pix, r2_gather, buffer);
+    return;
+  }
+
+  /* Get the relative distance between the pairs, wrapping. */
+  double shift[3] = {0.0, 0.0, 0.0};
+  for (int k = 0; k < 3; k++) {
+    if (cj->loc[k] - ci->loc[k] < -e->s->dim[k] / 2)
+      shift[k] = e->s->dim[k];
+    else if (cj->loc[k] - ci->loc[k] > e->s->dim[k] / 2)
+      shift[k] = -e->s->dim[k];
+  }
+
+  const double pix[3] = {pi->x[0] - shift[0], pi->x[1] - shift[1],
+                         pi->x[2] - shift[2]};
+  DO_GATHER_RECURSE(e, cj, pi, pix, r2_gather, buffer);
+}
+
+/**
+ * @brief Compute the density interactions of a particle with its candidate
+ * neighbours.
+ *
+ * @param r The #runner.
+ * @param pi The particle to update.
+ * @param candidates The candidates of the particle.
+ * @param num The number of candidates.
+ */
+void DO_CANDIDATES(struct runner *r, struct part *restrict pi,
+                   const struct hydro_ngb_candidate *restrict candidates,
+                   const int num) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+  GET_MU0();
+
+  const float hi = pi->h;
+  const float hig2 = hi * hi * kernel_gamma2;
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (!part_is_active(pi, e))
+    error("Trying to correct smoothing length of inactive particle !");
+#endif
+
+  for (int k = 0; k < num; k++) {
+
+    /* Hit or miss? */
+    const float r2 = candidates[k].r2;
+    if (r2 >= hig2) continue;
+
+    struct part *restrict pj = candidates[k].pj;
+    const float *dx = candidates[k].dx;
+    const float hj = pj->h;
+
+    IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+    IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+    runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+    runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                            e->sink_properties->cut_off_radius);
+  }
+}
+
+#endif /* FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY */
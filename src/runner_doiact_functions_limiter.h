@@ -26,6 +26,26 @@
 
 #include "runner_doiact_limiter.h"
 
+/**
+ * @brief Apply the non-symmetric interaction of pi on pj and record pj in the
+ * wake-up candidates of its leaf if this interaction is the one waking it up.
+ *
+ * @param c The #cell containing pj or NULL if pj is not local.
+ */
+__attribute__((always_inline)) INLINE static void IACT_NONSYM_WAKEUP(
+    const float r2, const float dx[3], const float hi, const float hj,
+    struct part *restrict pi, struct part *restrict pj, const float a,
+    const float H, struct cell *c) {
+
+  const timebin_t wakeup_old = pj->limiter_data.wakeup;
+
+  IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+
+  if (c != NULL && wakeup_old == time_bin_not_awake &&
+      pj->limiter_data.wakeup != time_bin_not_awake)
+    cell_add_limiter_candidate(c, pj);
+}
+
 /**
  * @brief Compute the interactions between a cell pair (non-symmetric case).
  *
@@ -55,6 +75,10 @@ void DOPAIR1_NAIVE(struct runner *r, struct cell *restrict ci,
   const float a = cosmo->a;
   const float H = cosmo->H;
 
+  /* Cells in which to record the woken up particles (local ones only) */
+  struct cell *ci_wakeup = (ci->nodeID == e->nodeID) ? ci : NULL;
+  struct cell *cj_wakeup = (cj->nodeID == e->nodeID) ? cj : NULL;
+
   /* Get the relative distance between the pairs, wrapping. */
   double shift[3] = {0.0, 0.0, 0.0};
   for (int k = 0; k < 3; k++) {
@@ -111,7 +135,7 @@ void DOPAIR1_NAIVE(struct runner *r, struct cell *restrict ci,
       /* Hit or miss? */
       if (r2 < hig2 && pi_active) {
 
-        IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+        IACT_NONSYM_WAKEUP(r2, dx, hi, hj, pi, pj, a, H, cj_wakeup);
       }
       if (r2 < hjg2 && pj_active) {
 
@@ -119,7 +143,7 @@ void DOPAIR1_NAIVE(struct runner *r, struct cell *restrict ci,
         dx[1] = -dx[1];
         dx[2] = -dx[2];
 
-        IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+        IACT_NONSYM_WAKEUP(r2, dx, hj, hi, pj, pi, a, H, ci_wakeup);
       }
 
     } /* loop over the parts in cj. */
@@ -206,14 +230,14 @@ void DOSELF1_NAIVE(struct runner *r, struct cell *restrict c) {
         IACT(r2, dx, hi, hj, pi, pj, a, H);
       } else if (doi) {
 
-        IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+        IACT_NONSYM_WAKEUP(r2, dx, hi, hj, pi, pj, a, H, c);
       } else if (doj) {
 
         dx[0] = -dx[0];
         dx[1] = -dx[1];
         dx[2] = -dx[2];
 
-        IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+        IACT_NONSYM_WAKEUP(r2, dx, hj, hi, pj, pi, a, H, c);
       }
     } /* loop over the parts in cj. */
   } /* loop over the parts in ci. */
@@ -238,6 +262,10 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
   TIMER_TIC;
 
+  /* Cells in which to record the woken up particles (local ones only) */
+  struct cell *ci_wakeup = (ci->nodeID == e->nodeID) ? ci : NULL;
+  struct cell *cj_wakeup = (cj->nodeID == e->nodeID) ? cj : NULL;
+
   /* Get the cutoff shift. */
   double rshift = 0.0;
   for (int k = 0; k < 3; k++) rshift += shift[k] * runner_shift[sid][k];
@@ -352,7 +380,7 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         /* Hit or miss? */
         if (r2 < hig2) {
 
-          IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_NONSYM_WAKEUP(r2, dx, hi, hj, pi, pj, a, H, cj_wakeup);
         }
       } /* loop over the parts in cj. */
     } /* loop over the parts in ci. */
@@ -436,7 +464,7 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         /* Hit or miss? */
         if (r2 < hjg2) {
 
-          IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+          IACT_NONSYM_WAKEUP(r2, dx, hj, hi, pj, pi, a, H, ci_wakeup);
         }
       } /* loop over the parts in ci. */
     } /* loop over the parts in cj. */
@@ -608,7 +636,7 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
         /* Hit or miss? */
         if (r2 < hj * hj * kernel_gamma2) {
 
-          IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+          IACT_NONSYM_WAKEUP(r2, dx, hj, hi, pj, pi, a, H, c);
         }
       } /* loop over all other particles. */
     }
@@ -659,13 +687,13 @@ void DOSELF1(struct runner *r, struct cell *restrict c) {
             IACT(r2, dx, hi, hj, pi, pj, a, H);
           } else if (doi) {
 
-            IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+            IACT_NONSYM_WAKEUP(r2, dx, hi, hj, pi, pj, a, H, c);
           } else if (doj) {
 
             dx[0] = -dx[0];
             dx[1] = -dx[1];
             dx[2] = -dx[2];
-            IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+            IACT_NONSYM_WAKEUP(r2, dx, hj, hi, pj, pi, a, H, c);
           }
         }
       } /* loop over all other particles. */
@@ -749,8 +777,15 @@ void DOSUB_PAIR1(struct runner *r, struct cell *ci, struct cell *cj,
     for (int k = 0; k < csp->count; k++) {
       const int pid = csp->pairs[k].pid;
       const int pjd = csp->pairs[k].pjd;
-      if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL)
+      if (ci->progeny[pid] != NULL && cj->progeny[pjd] != NULL) {
+        if (cell_can_skip_drifted_pair_hydro_task(
+                ci->progeny[pid], cj->progeny[pjd], shift, r->e->ti_current,
+                r->e->nodeID)) {
+          r->culled_subpairs++;
+          continue;
+        }
         DOSUB_PAIR1(r, ci->progeny[pid], cj->progeny[pjd], 0);
+      }
     }
   }
 
@@ -806,12 +841,20 @@ void DOSUB_SELF1(struct runner *r, struct cell *ci, int gettimer) {
   if (cell_can_recurse_in_self_hydro_task(ci)) {
 
     /* Loop over all progeny. */
+    const double shift[3] = {0., 0., 0.};
     for (int k = 0; k < 8; k++)
       if (ci->progeny[k] != NULL) {
         DOSUB_SELF1(r, ci->progeny[k], 0);
-        for (int j = k + 1; j < 8; j++)
-          if (ci->progeny[j] != NULL)
-            DOSUB_PAIR1(r, ci->progeny[k], ci->progeny[j], 0);
+        for (int j = k + 1; j < 8; j++) {
+          if (ci->progeny[j] == NULL) continue;
+          if (cell_can_skip_drifted_pair_hydro_task(
+                  ci->progeny[k], ci->progeny[j], shift, r->e->ti_current,
+                  r->e->nodeID)) {
+            r->culled_subpairs++;
+            continue;
+          }
+          DOSUB_PAIR1(r, ci->progeny[k], ci->progeny[j], 0);
+        }
       }
   }
 
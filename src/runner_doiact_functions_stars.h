@@ -37,9 +37,103 @@
 #endif
 #endif
 
+/**
+ * @brief Copy the fields of a #part that the neighbour search of the stars
+ * loops reads into a #hydro_hot_cache.
+ *
+ * The search over the gas is vectorised. The density interactions of the
+ * stellar models that provide lane-parallel versions of them (GEAR) are then
+ * done a vector of neighbours at a time by #IACT_STARS_NGBS. All the other
+ * interactions with the neighbours found stay scalar: the EAGLE density loops
+ * are dominated by the per-ray arc-length and distance minimisations, keyed
+ * on the gas IDs, and the feedback loops scatter into the gas particles with
+ * per-pair random draws.
+ *
+ * @param e The #engine.
+ * @param p The #part.
+ * @param loc The origin of the frame of the interaction.
+ * @param hot The #hydro_hot_cache.
+ * @param k The index of the entry to fill.
+ */
+__attribute__((always_inline)) INLINE static void HOT_CACHE_READ_STARS_GAS(
+    const struct engine *e, struct part *restrict p, const double loc[3],
+    struct hydro_hot_cache *restrict hot, const int k) {
+
+  hot->x[k] = p->x[0] - loc[0];
+  hot->y[k] = p->x[1] - loc[1];
+  hot->z[k] = p->x[2] - loc[2];
+  hot->h[k] = p->h;
+  hot->active[k] = 1;
+  hot->inhibited[k] = part_is_inhibited(p, e);
+  hot->part[k] = p;
+}
+
+#ifdef DO_VEC_IACT
+
+/**
+ * @brief Density interactions of a #spart with the gas neighbours found by
+ * the last search of a #hydro_hot_cache.
+ *
+ * The kernel-weighted sums only need the distances to the neighbours, which
+ * the search leaves packed in the cache. They are read a vector at a time.
+ * The neighbours left after the last whole vector are done as one more
+ * vector with the empty lanes masked out if they fill at least half of it,
+ * and one at a time with the scalar function otherwise.
+ *
+ * @param hot The #hydro_hot_cache holding the neighbours.
+ * @param num_ngb The number of neighbours.
+ * @param si The #spart to update.
+ * @param hi Comoving smoothing-length of si.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void IACT_STARS_NGBS(
+    struct hydro_hot_cache *restrict hot, const int num_ngb,
+    struct spart *restrict si, const float hi, const float a, const float H) {
+
+  /* How many neighbours are done with vectors? */
+  const int num_whole = num_ngb - (num_ngb % VEC_SIZE);
+  const int num_left = num_ngb - num_whole;
+  const int num_vec = (2 * num_left >= VEC_SIZE) ? num_ngb + VEC_SIZE - num_left
+                                                 : num_whole;
+  if (num_vec > num_ngb) hydro_hot_cache_pad_ngbs(hot, num_ngb, num_vec);
+
+  /* Lane-parallel interactions */
+  struct IACT_STARS_VEC_DATA data;
+  IACT_STARS_VEC_INIT(&data, hi);
+
+  mask_t mask;
+  vec_init_mask_true(mask);
+  for (int n = 0; n < num_vec; n += VEC_SIZE) {
+
+    /* Mask out the padding of the last vector. */
+    if (n == num_whole) hydro_hot_cache_lane_mask(&mask, num_left);
+
+    vector r2;
+    r2.v = vec_load(&hot->ngb_r2[n]);
+    IACT_STARS_VEC(&data, r2, mask);
+  }
+
+  IACT_STARS_VEC_REDUCE(&data, si);
+
+  /* Scalar remainder */
+  for (int n = num_vec; n < num_ngb; n++) {
+    const int k = hot->ngb[n];
+    float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+    IACT_STARS(hot->ngb_r2[n], dx, hi, hot->h[k], si, hot->part[k], a, H);
+  }
+}
+
+#endif /* DO_VEC_IACT */
+
 /**
  * @brief Calculate the number density of #part around the #spart
  *
+ * The neighbours of each #spart are found by a vectorised search over copies
+ * of the gas positions in the runner's #hydro_hot_cache, which the density
+ * interactions then sum over a vector of neighbours at a time when the
+ * stellar model allows it.
+ *
  * @param r runner task
  * @param c cell
  * @param timer 1 if the time is to be recorded.
@@ -74,6 +168,10 @@ void DOSELF1_STARS(struct runner *r, struct cell *c, int timer) {
 
   const int with_rt = WITH_RT;
 
+  /* The gas is copied to the cache when the first active star is found. */
+  struct hydro_hot_cache *restrict hot = &r->cj_hot_cache;
+  int num_hot = 0;
+
   /* Loop over the sparts in ci. */
   for (int sid = 0; sid < scount; sid++) {
 
@@ -90,31 +188,40 @@ void DOSELF1_STARS(struct runner *r, struct cell *c, int timer) {
     int si_active_feedback = feedback_is_active(si, e);
     if (!si_active_feedback && !with_rt) continue;
 
+    if (num_hot == 0) {
+      hydro_hot_cache_reserve(hot, count);
+      for (; num_hot < count; num_hot++)
+        HOT_CACHE_READ_STARS_GAS(e, &parts[num_hot], c->loc, hot, num_hot);
+    }
+
     const float hi = si->h;
     const float hig2 = hi * hi * kernel_gamma2;
     const float six[3] = {(float)(si->x[0] - c->loc[0]),
                           (float)(si->x[1] - c->loc[1]),
                           (float)(si->x[2] - c->loc[2])};
 
-    /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count; pjd++) {
+    /* Find the neighbours of si amongst the parts. */
+    const int num_ngb = hydro_hot_cache_search(
+        hot, 0, count, six[0], six[1], six[2], hig2, hydro_hot_search_gather);
+
+#ifdef DO_VEC_IACT
+    /* The density interactions, a vector of neighbours at a time. */
+    if (si_active_feedback) IACT_STARS_NGBS(hot, num_ngb, si, hi, a, H);
+#endif
+
+    /* Loop over the neighbours. */
+    for (int n = 0; n < num_ngb; n++) {
 
       /* Get a pointer to the jth particle. */
+      const int pjd = hot->ngb[n];
       struct part *restrict pj = &parts[pjd];
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
       struct xpart *restrict xpj = &xparts[pjd];
 #endif
-      const float hj = pj->h;
-
-      /* Early abort? */
-      if (part_is_inhibited(pj, e)) continue;
+      const float hj = hot->h[pjd];
 
-      /* Compute the pairwise distance. */
-      const float pjx[3] = {(float)(pj->x[0] - c->loc[0]),
-                            (float)(pj->x[1] - c->loc[1]),
-                            (float)(pj->x[2] - c->loc[2])};
-      float dx[3] = {six[0] - pjx[0], six[1] - pjx[1], six[2] - pjx[2]};
-      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+      float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+      const float r2 = hot->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
       /* Check that particles have been drifted to the current time */
@@ -122,8 +229,10 @@ void DOSELF1_STARS(struct runner *r, struct cell *c, int timer) {
         error("Particle pj not drifted to current time");
 #endif
 
-      if (r2 < hig2 && si_active_feedback) {
+      if (si_active_feedback) {
+#ifndef DO_VEC_IACT
         IACT_STARS(r2, dx, hi, hj, si, pj, a, H);
+#endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
         runner_iact_nonsym_feedback_density(r2, dx, hi, hj, si, pj, NULL, cosmo,
                                             e->feedback_props, ti_current);
@@ -134,12 +243,15 @@ void DOSELF1_STARS(struct runner *r, struct cell *c, int timer) {
         runner_iact_nonsym_feedback_prep2(r2, dx, hi, hj, si, pj, NULL, cosmo,
                                           ti_current);
 #elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+        const char pj_sync = pj->limiter_data.to_be_synchronized;
         runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, si, pj, xpj, cosmo,
                                           e->hydro_properties,
                                           e->feedback_props, ti_current);
+        if (!pj_sync && pj->limiter_data.to_be_synchronized)
+          cell_add_sync_candidate(c, pj);
 #endif
       }
-      if (r2 < hig2 && with_rt) {
+      if (with_rt) {
         /* If we're running RT, we don't care whether star is active for
          * feedback, just that the star is active. */
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -264,9 +376,12 @@ void DO_NONSYM_PAIR1_STARS_NAIVE(struct runner *r, struct cell *restrict ci,
         runner_iact_nonsym_feedback_prep2(r2, dx, hi, hj, si, pj, NULL, cosmo,
                                           ti_current);
 #elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+        const char pj_sync = pj->limiter_data.to_be_synchronized;
         runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, si, pj, xpj, cosmo,
                                           e->hydro_properties,
                                           e->feedback_props, ti_current);
+        if (!pj_sync && pj->limiter_data.to_be_synchronized)
+          cell_add_sync_candidate(cj, pj);
 #endif
       }
       if (r2 < hig2 && with_rt) {
@@ -286,6 +401,12 @@ void DO_NONSYM_PAIR1_STARS_NAIVE(struct runner *r, struct cell *restrict ci,
 /**
  * @brief Compute the interactions between a cell pair.
  *
+ * The gas of the other cell is copied, in sorted order and only as far as
+ * the active stars reach, to the runner's #hydro_hot_cache, over which the
+ * neighbours of each #spart are found by a vectorised search. As in
+ * #DOSELF1_STARS, the density interactions are then done a vector of
+ * neighbours at a time when the stellar model allows it.
+ *
  * @param r The #runner.
  * @param ci The first #cell.
  * @param cj The second #cell.
@@ -356,6 +477,12 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
     const float dx_max = (ci->stars.dx_max_sort + cj->hydro.dx_max_sort);
     const float hydro_dx_max_rshift = cj->hydro.dx_max_sort - rshift;
 
+    /* The parts of cj are copied to the cache from the left end of the
+     * sorted list, as far as the stars reach. */
+    struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+    hydro_hot_cache_reserve(hot_j, count_j);
+    int num_j = 0;
+
     /* Loop over the sparts in ci. */
     for (int pid = count_i - 1;
          pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
@@ -389,28 +516,41 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
       const float piy = spi->x[1] - (cj->loc[1] + shift[1]);
       const float piz = spi->x[2] - (cj->loc[2] + shift[2]);
 
-      /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      /* Find the parts of cj in range and make sure they are in the cache. */
+      int last_j = 0;
+      while (last_j < count_j && sort_j[last_j].d < di) last_j++;
+      for (; num_j < last_j; num_j++)
+        HOT_CACHE_READ_STARS_GAS(e, &parts_j[sort_j[num_j].i], cj->loc,
+                                 hot_j, num_j);
+
+      /* Find the neighbours of spi amongst them. */
+      const int num_ngb = hydro_hot_cache_search(
+          hot_j, 0, last_j, pix, piy, piz, hig2, hydro_hot_search_gather);
+
+#ifdef DO_VEC_IACT
+      /* The density interactions, a vector of neighbours at a time. */
+      if (spi_active_feedback) IACT_STARS_NGBS(hot_j, num_ngb, spi, hi, a, H);
+#endif
+
+      /* Loop over the neighbours in cj. */
+      for (int n = 0; n < num_ngb; n++) {
 
         /* Recover pj */
+        const int pjd = hot_j->ngb[n];
         struct part *pj = &parts_j[sort_j[pjd].i];
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
         struct xpart *xpj = &xparts_j[sort_j[pjd].i];
 #endif
+        const float hj = hot_j->h[pjd];
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
-
-        const float hj = pj->h;
-        const float pjx = pj->x[0] - cj->loc[0];
-        const float pjy = pj->x[1] - cj->loc[1];
-        const float pjz = pj->x[2] - cj->loc[2];
-
-        /* Compute the pairwise distance. */
-        float dx[3] = {pix - pjx, piy - pjy, piz - pjz};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        float dx[3] = {hot_j->ngb_dx[n], hot_j->ngb_dy[n], hot_j->ngb_dz[n]};
+        const float r2 = hot_j->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
+        const float pjx = hot_j->x[pjd];
+        const float pjy = hot_j->y[pjd];
+        const float pjz = hot_j->z[pjd];
+
         /* Check that particles are in the correct frame after the shifts */
         if (pix > shift_threshold_x || pix < -shift_threshold_x)
           error(
@@ -444,9 +584,10 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
           error("Particle pj not drifted to current time");
 #endif
 
-        /* Hit or miss? */
-        if (r2 < hig2 && spi_active_feedback) {
+        if (spi_active_feedback) {
+#ifndef DO_VEC_IACT
           IACT_STARS(r2, dx, hi, hj, spi, pj, a, H);
+#endif
 
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
           runner_iact_nonsym_feedback_density(r2, dx, hi, hj, spi, pj, NULL,
@@ -459,12 +600,15 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
           runner_iact_nonsym_feedback_prep2(r2, dx, hi, hj, spi, pj, NULL,
                                             cosmo, ti_current);
 #elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+          const char pj_sync = pj->limiter_data.to_be_synchronized;
           runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, spi, pj, xpj, cosmo,
                                             e->hydro_properties,
                                             e->feedback_props, ti_current);
+          if (!pj_sync && pj->limiter_data.to_be_synchronized)
+            cell_add_sync_candidate(cj, pj);
 #endif
         }
-        if (r2 < hig2 && with_rt) {
+        if (with_rt) {
           /* If we're running RT, we don't care whether star is active for
            * feedback, just that the star is active. */
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -509,6 +653,14 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
     const float dx_max = (ci->hydro.dx_max_sort + cj->stars.dx_max_sort);
     const float hydro_dx_max_rshift = ci->hydro.dx_max_sort - rshift;
 
+    /* The parts of ci are moved to the frame of cj and copied to the cache
+     * from the right end of the sorted list, as far as the stars reach. */
+    const double loc_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                             cj->loc[2] + shift[2]};
+    struct hydro_hot_cache *restrict hot_i = &r->ci_hot_cache;
+    hydro_hot_cache_reserve(hot_i, count_i);
+    int num_i = 0;
+
     /* Loop over the parts in cj. */
     for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
          pjd++) {
@@ -542,28 +694,42 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
       const float pjy = spj->x[1] - cj->loc[1];
       const float pjz = spj->x[2] - cj->loc[2];
 
-      /* Loop over the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d > dj; pid--) {
+      /* Find the parts of ci in range and make sure they are in the cache. */
+      int last_i = 0;
+      while (last_i < count_i && sort_i[count_i - 1 - last_i].d > dj) last_i++;
+      for (; num_i < last_i; num_i++)
+        HOT_CACHE_READ_STARS_GAS(e, &parts_i[sort_i[count_i - 1 - num_i].i],
+                                 loc_i, hot_i, num_i);
+
+      /* Find the neighbours of spj amongst them. */
+      const int num_ngb = hydro_hot_cache_search(
+          hot_i, 0, last_i, pjx, pjy, pjz, hjg2, hydro_hot_search_gather);
+
+#ifdef DO_VEC_IACT
+      /* The density interactions, a vector of neighbours at a time. */
+      if (spj_active_feedback) IACT_STARS_NGBS(hot_i, num_ngb, spj, hj, a, H);
+#endif
+
+      /* Loop over the neighbours in ci. */
+      for (int n = 0; n < num_ngb; n++) {
 
         /* Recover pi */
+        const int ki = hot_i->ngb[n];
+        const int pid = count_i - 1 - ki;
         struct part *pi = &parts_i[sort_i[pid].i];
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
         struct xpart *xpi = &xparts_i[sort_i[pid].i];
 #endif
+        const float hi = hot_i->h[ki];
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pi, e)) continue;
-
-        const float hi = pi->h;
-        const float pix = pi->x[0] - (cj->loc[0] + shift[0]);
-        const float piy = pi->x[1] - (cj->loc[1] + shift[1]);
-        const float piz = pi->x[2] - (cj->loc[2] + shift[2]);
-
-        /* Compute the pairwise distance. */
-        float dx[3] = {pjx - pix, pjy - piy, pjz - piz};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        float dx[3] = {hot_i->ngb_dx[n], hot_i->ngb_dy[n], hot_i->ngb_dz[n]};
+        const float r2 = hot_i->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
+        const float pix = hot_i->x[ki];
+        const float piy = hot_i->y[ki];
+        const float piz = hot_i->z[ki];
+
         /* Check that particles are in the correct frame after the shifts */
         if (pix > shift_threshold_x || pix < -shift_threshold_x)
           error(
@@ -597,10 +763,11 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
           error("Particle spj not drifted to current time");
 #endif
 
-        /* Hit or miss? */
-        if (r2 < hjg2 && spj_active_feedback) {
+        if (spj_active_feedback) {
 
+#ifndef DO_VEC_IACT
           IACT_STARS(r2, dx, hj, hi, spj, pi, a, H);
+#endif
 
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
           runner_iact_nonsym_feedback_density(r2, dx, hj, hi, spj, pi, NULL,
@@ -613,12 +780,15 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
           runner_iact_nonsym_feedback_prep2(r2, dx, hj, hi, spj, pi, NULL,
                                             cosmo, ti_current);
 #elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
+          const char pi_sync = pi->limiter_data.to_be_synchronized;
           runner_iact_nonsym_feedback_apply(r2, dx, hj, hi, spj, pi, xpi, cosmo,
                                             e->hydro_properties,
                                             e->feedback_props, ti_current);
+          if (!pi_sync && pi->limiter_data.to_be_synchronized)
+            cell_add_sync_candidate(ci, pi);
 #endif
         }
-        if (r2 < hjg2 && with_rt) {
+        if (with_rt) {
           /* If we're running RT, we don't care whether star is active for
            * feedback, just that the star is active. */
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
@@ -661,7 +831,8 @@ void DOPAIR1_STARS_NAIVE(struct runner *r, struct cell *restrict ci,
  * @brief Compute the interactions between a cell pair, but only for the
  *      given indices in ci.
  *
- * Version using a brute-force algorithm.
+ * The parts of cj are copied, in sorted order and only as far as the sparts
+ * reach, to the runner's #hydro_hot_cache in the frame of cj.
  *
  * @param r The #runner.
  * @param ci The first #cell.
@@ -695,131 +866,88 @@ void DOPAIR1_SUBSET_STARS(struct runner *r, struct cell *restrict ci,
   const struct sort_entry *restrict sort_j = cell_get_hydro_sorts(cj, sid);
   const float dxj = cj->hydro.dx_max_sort;
 
-  /* Sparts are on the left? */
-  if (!flipped) {
+  /* The cache of the parts of cj, filled as far as needed. */
+  struct hydro_hot_cache *restrict hot_j = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot_j, count_j);
+  int num_j = 0;
 
-    /* Loop over the sparts_i. */
-    for (int pid = 0; pid < scount; pid++) {
+  /* Loop over the sparts_i. */
+  for (int pid = 0; pid < scount; pid++) {
 
-      /* Get a hold of the ith spart in ci. */
-      struct spart *restrict spi = &sparts_i[ind[pid]];
-      const double pix = spi->x[0] - (shift[0]);
-      const double piy = spi->x[1] - (shift[1]);
-      const double piz = spi->x[2] - (shift[2]);
-      const float hi = spi->h;
-      const float hig2 = hi * hi * kernel_gamma2;
+    /* Get a hold of the ith spart in ci. */
+    struct spart *restrict spi = &sparts_i[ind[pid]];
+    const double pix = spi->x[0] - (shift[0]);
+    const double piy = spi->x[1] - (shift[1]);
+    const double piz = spi->x[2] - (shift[2]);
+    const float hi = spi->h;
+    const float hig2 = hi * hi * kernel_gamma2;
+
+    /* Find the parts of cj in range and make sure they are in the cache.
+     * When the sparts are on the right, the cache holds the sorted list from
+     * its right end. */
+    int last_j = 0;
+    if (!flipped) {
       const double di = hi * kernel_gamma + dxj + pix * runner_shift[sid][0] +
                         piy * runner_shift[sid][1] + piz * runner_shift[sid][2];
-
-      /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
-
-        /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts_j[sort_j[pjd].i];
-
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
-
-        const double pjx = pj->x[0];
-        const double pjy = pj->x[1];
-        const double pjz = pj->x[2];
-        const float hj = pj->h;
-
-        /* Compute the pairwise distance. */
-        float dx[3] = {(float)(pix - pjx), (float)(piy - pjy),
-                       (float)(piz - pjz)};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
-
-#ifdef SWIFT_DEBUG_CHECKS
-        /* Check that particles have been drifted to the current time */
-        if (spi->ti_drift != e->ti_current)
-          error("Particle pi not drifted to current time");
-        if (pj->ti_drift != e->ti_current)
-          error("Particle pj not drifted to current time");
-#endif
-
-        /* Hit or miss? */
-        if (r2 < hig2) {
-          IACT_STARS(r2, dx, hi, hj, spi, pj, a, H);
-
-#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-          runner_iact_nonsym_feedback_density(r2, dx, hi, hj, spi, pj, NULL,
-                                              cosmo, e->feedback_props,
-                                              e->ti_current);
-          runner_iact_nonsym_rt_injection_prep(r2, dx, hi, hj, spi, pj, cosmo,
-                                               e->rt_props);
-#elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
-          error("No subset feedback iact functions do (or should) exist!");
-          /* runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, spi, pj, xpj,
-           * cosmo, ti_current); */
-#endif
-        }
-      } /* loop over the parts in cj. */
-    } /* loop over the sparts in ci. */
-  }
-
-  /* Sparts are on the right. */
-  else {
-
-    /* Loop over the sparts_i. */
-    for (int pid = 0; pid < scount; pid++) {
-
-      /* Get a hold of the ith spart in ci. */
-      struct spart *restrict spi = &sparts_i[ind[pid]];
-      const double pix = spi->x[0] - (shift[0]);
-      const double piy = spi->x[1] - (shift[1]);
-      const double piz = spi->x[2] - (shift[2]);
-      const float hi = spi->h;
-      const float hig2 = hi * hi * kernel_gamma2;
+      while (last_j < count_j && sort_j[last_j].d < di) last_j++;
+      for (; num_j < last_j; num_j++)
+        HOT_CACHE_READ_STARS_GAS(e, &parts_j[sort_j[num_j].i], cj->loc,
+                                 hot_j, num_j);
+    } else {
       const double di = -hi * kernel_gamma - dxj + pix * runner_shift[sid][0] +
                         piy * runner_shift[sid][1] + piz * runner_shift[sid][2];
+      while (last_j < count_j && di < sort_j[count_j - 1 - last_j].d) last_j++;
+      for (; num_j < last_j; num_j++)
+        HOT_CACHE_READ_STARS_GAS(e, &parts_j[sort_j[count_j - 1 - num_j].i],
+                                 cj->loc, hot_j, num_j);
+    }
 
-      /* Loop over the parts in cj. */
-      for (int pjd = count_j - 1; pjd >= 0 && di < sort_j[pjd].d; pjd--) {
+    /* Find the neighbours of spi amongst them. */
+    const int num_ngb = hydro_hot_cache_search(
+        hot_j, 0, last_j, (float)(pix - cj->loc[0]), (float)(piy - cj->loc[1]),
+        (float)(piz - cj->loc[2]), hig2, hydro_hot_search_gather);
 
-        /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts_j[sort_j[pjd].i];
+#ifdef DO_VEC_IACT
+    /* The density interactions, a vector of neighbours at a time. */
+    IACT_STARS_NGBS(hot_j, num_ngb, spi, hi, a, H);
+#endif
 
-        /* Skip inhibited particles. */
-        if (part_is_inhibited(pj, e)) continue;
+    /* Loop over the neighbours in cj. */
+    for (int n = 0; n < num_ngb; n++) {
 
-        const double pjx = pj->x[0];
-        const double pjy = pj->x[1];
-        const double pjz = pj->x[2];
-        const float hj = pj->h;
+      /* Get a pointer to the jth particle. */
+      const int kj = hot_j->ngb[n];
+      const int pjd = flipped ? count_j - 1 - kj : kj;
+      struct part *restrict pj = &parts_j[sort_j[pjd].i];
+      const float hj = hot_j->h[kj];
 
-        /* Compute the pairwise distance. */
-        float dx[3] = {(float)(pix - pjx), (float)(piy - pjy),
-                       (float)(piz - pjz)};
-        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+      float dx[3] = {hot_j->ngb_dx[n], hot_j->ngb_dy[n], hot_j->ngb_dz[n]};
+      const float r2 = hot_j->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
-        /* Check that particles have been drifted to the current time */
-        if (spi->ti_drift != e->ti_current)
-          error("Particle pi not drifted to current time");
-        if (pj->ti_drift != e->ti_current)
-          error("Particle pj not drifted to current time");
+      /* Check that particles have been drifted to the current time */
+      if (spi->ti_drift != e->ti_current)
+        error("Particle pi not drifted to current time");
+      if (pj->ti_drift != e->ti_current)
+        error("Particle pj not drifted to current time");
 #endif
 
-        /* Hit or miss? */
-        if (r2 < hig2) {
-          IACT_STARS(r2, dx, hi, hj, spi, pj, a, H);
+#ifndef DO_VEC_IACT
+      IACT_STARS(r2, dx, hi, hj, spi, pj, a, H);
+#endif
 
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-          runner_iact_nonsym_feedback_density(r2, dx, hi, hj, spi, pj, NULL,
-                                              cosmo, e->feedback_props,
-                                              e->ti_current);
-          runner_iact_nonsym_rt_injection_prep(r2, dx, hi, hj, spi, pj, cosmo,
-                                               e->rt_props);
+      runner_iact_nonsym_feedback_density(r2, dx, hi, hj, spi, pj, NULL, cosmo,
+                                          e->feedback_props, e->ti_current);
+      runner_iact_nonsym_rt_injection_prep(r2, dx, hi, hj, spi, pj, cosmo,
+                                           e->rt_props);
 #elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
-          error("No subset feedback iact functions do (or should) exist!");
-          /* runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, spi, pj, xpj,
-           * cosmo, ti_current); */
+      error("No subset feedback iact functions do (or should) exist!");
+      /* runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, spi, pj, xpj,
+       * cosmo, ti_current); */
 #endif
-        }
-      } /* loop over the parts in cj. */
-    } /* loop over the sparts in ci. */
-  }
+    } /* loop over the parts in cj. */
+  } /* loop over the sparts in ci. */
 }
 
 /**
@@ -949,6 +1077,12 @@ void DOSELF1_SUBSET_STARS(struct runner *r, struct cell *restrict ci,
   /* Early abort? */
   if (count_i == 0) return;
 
+  /* Copy the parts to the cache. */
+  struct hydro_hot_cache *restrict hot = &r->cj_hot_cache;
+  hydro_hot_cache_reserve(hot, count_i);
+  for (int pjd = 0; pjd < count_i; pjd++)
+    HOT_CACHE_READ_STARS_GAS(e, &parts_j[pjd], ci->loc, hot, pjd);
+
   /* Loop over the parts in ci. */
   for (int spid = 0; spid < scount; spid++) {
 
@@ -965,21 +1099,26 @@ void DOSELF1_SUBSET_STARS(struct runner *r, struct cell *restrict ci,
       error("Inactive particle in subset function!");
 #endif
 
-    /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count_i; pjd++) {
+    /* Find the neighbours of spi amongst the parts. */
+    const int num_ngb = hydro_hot_cache_search(hot, 0, count_i, spix[0],
+                                               spix[1], spix[2], hig2,
+                                               hydro_hot_search_gather);
+
+#ifdef DO_VEC_IACT
+    /* The density interactions, a vector of neighbours at a time. */
+    IACT_STARS_NGBS(hot, num_ngb, spi, hi, a, H);
+#endif
+
+    /* Loop over the neighbours. */
+    for (int n = 0; n < num_ngb; n++) {
 
       /* Get a pointer to the jth particle. */
+      const int pjd = hot->ngb[n];
       struct part *restrict pj = &parts_j[pjd];
+      const float hj = hot->h[pjd];
 
-      /* Early abort? */
-      if (part_is_inhibited(pj, e)) continue;
-
-      /* Compute the pairwise distance. */
-      const float pjx[3] = {(float)(pj->x[0] - ci->loc[0]),
-                            (float)(pj->x[1] - ci->loc[1]),
-                            (float)(pj->x[2] - ci->loc[2])};
-      float dx[3] = {spix[0] - pjx[0], spix[1] - pjx[1], spix[2] - pjx[2]};
-      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+      float dx[3] = {hot->ngb_dx[n], hot->ngb_dy[n], hot->ngb_dz[n]};
+      const float r2 = hot->ngb_r2[n];
 
 #ifdef SWIFT_DEBUG_CHECKS
       /* Check that particles have been drifted to the current time */
@@ -987,21 +1126,19 @@ void DOSELF1_SUBSET_STARS(struct runner *r, struct cell *restrict ci,
         error("Particle pj not drifted to current time");
 #endif
 
-      /* Hit or miss? */
-      if (r2 < hig2) {
-        IACT_STARS(r2, dx, hi, pj->h, spi, pj, a, H);
+#ifndef DO_VEC_IACT
+      IACT_STARS(r2, dx, hi, hj, spi, pj, a, H);
+#endif
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
-        runner_iact_nonsym_feedback_density(r2, dx, hi, pj->h, spi, pj, NULL,
-                                            cosmo, e->feedback_props,
-                                            e->ti_current);
-        runner_iact_nonsym_rt_injection_prep(r2, dx, hi, pj->h, spi, pj, cosmo,
-                                             e->rt_props);
+      runner_iact_nonsym_feedback_density(r2, dx, hi, hj, spi, pj, NULL, cosmo,
+                                          e->feedback_props, e->ti_current);
+      runner_iact_nonsym_rt_injection_prep(r2, dx, hi, hj, spi, pj, cosmo,
+                                           e->rt_props);
 #elif (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
-        error("No subset feedback iact functions do (or should) exist!");
-        /* runner_iact_nonsym_feedback_apply(r2, dx, hi, pj->h, spi, pj, xpj, */
-        /*                                   cosmo, e, ti_current); */
+      error("No subset feedback iact functions do (or should) exist!");
+      /* runner_iact_nonsym_feedback_apply(r2, dx, hi, hj, spi, pj, xpj, */
+      /*                                   cosmo, e, ti_current); */
 #endif
-      }
     } /* loop over the parts in cj. */
   } /* loop over the parts in ci. */
 }
@@ -33,6 +33,10 @@
 #include "space_getsid.h"
 #include "timers.h"
 
+/*! Fraction of active particles above which the self P-P interactions are
+ * computed using the symmetric kernels */
+#define gravity_pp_symmetric_min_active_fraction 0.6f
+
 /**
  * @brief Clear the unskip flags of this cell.
  *
@@ -1679,6 +1683,333 @@ static INLINE void runner_doself_grav_pp_truncated(
   }
 }
 
+/**
+ * @brief Compute the full gravity interactions between all particles
+ * of a cell using Newton's third law.
+ *
+ * Each pair of particles is visited only once: the interaction is added to
+ * the first particle and its reaction to the second one. The reactions are
+ * accumulated in the cache, which is only written back for the active
+ * particles, hence every particle (active or not) must act as a source.
+ * This is cheaper than the non-symmetric version when most of the particles
+ * of the cell are active. The loop over the j cache should auto-vectorize.
+ *
+ * @param ci_cache #gravity_cache contaning the particles to be updated.
+ * @param gcount The number of particles in the cell.
+ * @param gcount_padded The number of particles in the cell padded to the
+ * vector length.
+ *
+ * @param e The #engine (for debugging checks only).
+ * @param gparts The #gpart in the cell (for debugging checks only).
+ */
+static INLINE void runner_doself_grav_pp_full_symmetric(
+    struct gravity_cache *restrict ci_cache, const int gcount,
+    const int gcount_padded, const struct engine *e, struct gpart *gparts) {
+
+  /* Make the compiler understand we are in happy vectorization land */
+  swift_declare_aligned_ptr(float, x, ci_cache->x, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, y, ci_cache->y, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, z, ci_cache->z, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, m, ci_cache->m, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, epsilon, ci_cache->epsilon,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, a_x, ci_cache->a_x, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, a_y, ci_cache->a_y, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, a_z, ci_cache->a_z, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, pot, ci_cache->pot, SWIFT_CACHE_ALIGNMENT);
+  swift_assume_size(gcount_padded, VEC_SIZE);
+
+  /* Loop over all particles in ci... */
+  for (int pid = 0; pid < gcount; pid++) {
+
+    const float x_i = x[pid];
+    const float y_i = y[pid];
+    const float z_i = z[pid];
+    const float mass_i = m[pid];
+    const float h_i = epsilon[pid];
+
+#ifdef SWIFT_DEBUG_CHECKS
+    /* The gravity_cache are sometimes allocated with more
+       place than required => flag with mass=0 */
+    if (gparts[pid].time_bin == time_bin_not_created && mass_i != 0.) {
+      error("Found an extra gpart in the gravity interaction");
+    }
+
+    /* Check that particles have been drifted to the current time */
+    if (gparts[pid].ti_drift != e->ti_current &&
+        !gpart_is_inhibited(&gparts[pid], e))
+      error("gpi not drifted to current time");
+
+    /* Check that we are not updated an inhibited particle */
+    if (ci_cache->active[pid] && gpart_is_inhibited(&gparts[pid], e))
+      error("Updating an inhibited particle!");
+
+    /* Check that the particle we interact with was not inhibited */
+    if (gpart_is_inhibited(&gparts[pid], e) && mass_i != 0.f)
+      error("Inhibited particle used as gravity source.");
+
+    /* Check that the particle was initialised */
+    if (ci_cache->active[pid] && gparts[pid].initialised == 0)
+      error("Adding forces to an un-initialised gpart.");
+#endif
+
+    /* Local accumulators for the acceleration and potential */
+    float a_x_i = 0.f, a_y_i = 0.f, a_z_i = 0.f, pot_i = 0.f;
+
+    /* Loop over the particles further down the cell. */
+    for (int pjd = pid + 1; pjd < gcount_padded; pjd++) {
+
+      /* Get info about j */
+      const float x_j = x[pjd];
+      const float y_j = y[pjd];
+      const float z_j = z[pjd];
+      const float mass_j = m[pjd];
+      const float h_j = epsilon[pjd];
+
+      /* Compute the pairwise (square) distance. */
+      /* Note: no need for periodic wrapping inside a cell */
+      const float dx = x_j - x_i;
+      const float dy = y_j - y_i;
+      const float dz = z_j - z_i;
+      const float r2 = dx * dx + dy * dy + dz * dz;
+
+      /* Pick the maximal softening length of i and j */
+      const float h = max(h_i, h_j);
+      const float h2 = h * h;
+      const float h_inv = 1.f / h;
+      const float h_inv_3 = h_inv * h_inv * h_inv;
+
+#ifdef SWIFT_DEBUG_CHECKS
+      if (pjd < gcount && r2 == 0.f && h2 == 0.)
+        error("Interacting particles with 0 distance and 0 softening.");
+#endif
+
+      /* Interact with a unit mass as the kernel is symmetric */
+      float f_ij, pot_ij;
+      runner_iact_grav_pp_full(r2, h2, h_inv, h_inv_3, /*mass=*/1.f, &f_ij,
+                               &pot_ij);
+
+      /* Action of j on i */
+      a_x_i += mass_j * f_ij * dx;
+      a_y_i += mass_j * f_ij * dy;
+      a_z_i += mass_j * f_ij * dz;
+      pot_i += mass_j * pot_ij;
+
+      /* Reaction of i on j */
+      a_x[pjd] -= mass_i * f_ij * dx;
+      a_y[pjd] -= mass_i * f_ij * dy;
+      a_z[pjd] -= mass_i * f_ij * dz;
+      pot[pjd] += mass_i * pot_ij;
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+      /* Update the interaction counters if it's not a padded gpart */
+      if (pjd < gcount) {
+        if (ci_cache->active[pid] && !gpart_is_inhibited(&gparts[pjd], e)) {
+#ifdef SWIFT_DEBUG_CHECKS
+          accumulate_inc_ll(&gparts[pid].num_interacted);
+#endif
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+          accumulate_inc_ll(&gparts[pid].num_interacted_p2p);
+#endif
+        }
+        if (ci_cache->active[pjd] && !gpart_is_inhibited(&gparts[pid], e)) {
+#ifdef SWIFT_DEBUG_CHECKS
+          accumulate_inc_ll(&gparts[pjd].num_interacted);
+#endif
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+          accumulate_inc_ll(&gparts[pjd].num_interacted_p2p);
+#endif
+        }
+      }
+#endif
+    }
+
+    /* Store everything back in cache */
+    a_x[pid] += a_x_i;
+    a_y[pid] += a_y_i;
+    a_z[pid] += a_z_i;
+    pot[pid] += pot_i;
+  }
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  /* The cache only contains the P2P contributions at this stage */
+  for (int pid = 0; pid < gcount; pid++) {
+    if (!ci_cache->active[pid]) continue;
+    accumulate_add_f(&gparts[pid].a_grav_p2p[0], a_x[pid]);
+    accumulate_add_f(&gparts[pid].a_grav_p2p[1], a_y[pid]);
+    accumulate_add_f(&gparts[pid].a_grav_p2p[2], a_z[pid]);
+  }
+#endif
+}
+
+/**
+ * @brief Compute the truncated gravity interactions between all particles
+ * of a cell using Newton's third law.
+ *
+ * Each pair of particles is visited only once: the interaction is added to
+ * the first particle and its reaction to the second one. The reactions are
+ * accumulated in the cache, which is only written back for the active
+ * particles, hence every particle (active or not) must act as a source.
+ * This is cheaper than the non-symmetric version when most of the particles
+ * of the cell are active. The loop over the j cache should auto-vectorize.
+ *
+ * This function only makes sense in periodic BCs.
+ *
+ * @param ci_cache #gravity_cache contaning the particles to be updated.
+ * @param gcount The number of particles in the cell.
+ * @param gcount_padded The number of particles in the cell padded to the
+ * vector length.
+ * @param r_s_inv The inverse of the gravity-mesh smoothing-scale.
+ *
+ * @param e The #engine (for debugging checks only).
+ * @param gparts The #gpart in the cell (for debugging checks only).
+ */
+static INLINE void runner_doself_grav_pp_truncated_symmetric(
+    struct gravity_cache *restrict ci_cache, const int gcount,
+    const int gcount_padded, const float r_s_inv, const struct engine *e,
+    struct gpart *gparts) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (!e->s->periodic)
+    error("Calling truncated PP function in non-periodic setup.");
+#endif
+
+  /* Make the compiler understand we are in happy vectorization land */
+  swift_declare_aligned_ptr(float, x, ci_cache->x, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, y, ci_cache->y, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, z, ci_cache->z, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, m, ci_cache->m, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, epsilon, ci_cache->epsilon,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, a_x, ci_cache->a_x, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, a_y, ci_cache->a_y, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, a_z, ci_cache->a_z, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, pot, ci_cache->pot, SWIFT_CACHE_ALIGNMENT);
+  swift_assume_size(gcount_padded, VEC_SIZE);
+
+  /* Loop over all particles in ci... */
+  for (int pid = 0; pid < gcount; pid++) {
+
+    const float x_i = x[pid];
+    const float y_i = y[pid];
+    const float z_i = z[pid];
+    const float mass_i = m[pid];
+    const float h_i = epsilon[pid];
+
+#ifdef SWIFT_DEBUG_CHECKS
+    /* The gravity_cache are sometimes allocated with more
+       place than required => flag with mass=0 */
+    if (gparts[pid].time_bin == time_bin_not_created && mass_i != 0.) {
+      error("Found an extra gpart in the gravity interaction");
+    }
+
+    /* Check that particles have been drifted to the current time */
+    if (gparts[pid].ti_drift != e->ti_current &&
+        !gpart_is_inhibited(&gparts[pid], e))
+      error("gpi not drifted to current time");
+
+    /* Check that we are not updated an inhibited particle */
+    if (ci_cache->active[pid] && gpart_is_inhibited(&gparts[pid], e))
+      error("Updating an inhibited particle!");
+
+    /* Check that the particle we interact with was not inhibited */
+    if (gpart_is_inhibited(&gparts[pid], e) && mass_i != 0.f)
+      error("Inhibited particle used as gravity source.");
+
+    /* Check that the particle was initialised */
+    if (ci_cache->active[pid] && gparts[pid].initialised == 0)
+      error("Adding forces to an un-initialised gpart.");
+#endif
+
+    /* Local accumulators for the acceleration and potential */
+    float a_x_i = 0.f, a_y_i = 0.f, a_z_i = 0.f, pot_i = 0.f;
+
+    /* Loop over the particles further down the cell. */
+    for (int pjd = pid + 1; pjd < gcount_padded; pjd++) {
+
+      /* Get info about j */
+      const float x_j = x[pjd];
+      const float y_j = y[pjd];
+      const float z_j = z[pjd];
+      const float mass_j = m[pjd];
+      const float h_j = epsilon[pjd];
+
+      /* Compute the pairwise (square) distance. */
+      /* Note: no need for periodic wrapping inside a cell */
+      const float dx = x_j - x_i;
+      const float dy = y_j - y_i;
+      const float dz = z_j - z_i;
+      const float r2 = dx * dx + dy * dy + dz * dz;
+
+      /* Pick the maximal softening length of i and j */
+      const float h = max(h_i, h_j);
+      const float h2 = h * h;
+      const float h_inv = 1.f / h;
+      const float h_inv_3 = h_inv * h_inv * h_inv;
+
+#ifdef SWIFT_DEBUG_CHECKS
+      if (pjd < gcount && r2 == 0.f && h2 == 0.)
+        error("Interacting particles with 0 distance and 0 softening.");
+#endif
+
+      /* Interact with a unit mass as the kernel is symmetric */
+      float f_ij, pot_ij;
+      runner_iact_grav_pp_truncated(r2, h2, h_inv, h_inv_3, /*mass=*/1.f,
+                                    r_s_inv, &f_ij, &pot_ij);
+
+      /* Action of j on i */
+      a_x_i += mass_j * f_ij * dx;
+      a_y_i += mass_j * f_ij * dy;
+      a_z_i += mass_j * f_ij * dz;
+      pot_i += mass_j * pot_ij;
+
+      /* Reaction of i on j */
+      a_x[pjd] -= mass_i * f_ij * dx;
+      a_y[pjd] -= mass_i * f_ij * dy;
+      a_z[pjd] -= mass_i * f_ij * dz;
+      pot[pjd] += mass_i * pot_ij;
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+      /* Update the interaction counters if it's not a padded gpart */
+      if (pjd < gcount) {
+        if (ci_cache->active[pid] && !gpart_is_inhibited(&gparts[pjd], e)) {
+#ifdef SWIFT_DEBUG_CHECKS
+          accumulate_inc_ll(&gparts[pid].num_interacted);
+#endif
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+          accumulate_inc_ll(&gparts[pid].num_interacted_p2p);
+#endif
+        }
+        if (ci_cache->active[pjd] && !gpart_is_inhibited(&gparts[pid], e)) {
+#ifdef SWIFT_DEBUG_CHECKS
+          accumulate_inc_ll(&gparts[pjd].num_interacted);
+#endif
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+          accumulate_inc_ll(&gparts[pjd].num_interacted_p2p);
+#endif
+        }
+      }
+#endif
+    }
+
+    /* Store everything back in cache */
+    a_x[pid] += a_x_i;
+    a_y[pid] += a_y_i;
+    a_z[pid] += a_z_i;
+    pot[pid] += pot_i;
+  }
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  /* The cache only contains the P2P contributions at this stage */
+  for (int pid = 0; pid < gcount; pid++) {
+    if (!ci_cache->active[pid]) continue;
+    accumulate_add_f(&gparts[pid].a_grav_p2p[0], a_x[pid]);
+    accumulate_add_f(&gparts[pid].a_grav_p2p[1], a_y[pid]);
+    accumulate_add_f(&gparts[pid].a_grav_p2p[2], a_z[pid]);
+  }
+#endif
+}
+
 /**
  * @brief Computes the interaction of all the particles in a cell with all the
  * other ones.
@@ -1733,31 +2064,38 @@ void runner_doself_grav_pp(struct runner *r, struct cell *c) {
                                   gcount, gcount_padded, loc, c,
                                   e->gravity_properties);
 
-  /* Can we use the Newtonian version or do we need the truncated one ? */
-  if (!periodic) {
+  /* Count the active particles. The symmetric kernels visit each of the
+   * gcount^2 / 2 pairs once whilst the non-symmetric ones visit
+   * gcount_active * gcount pairs, each at a lower cost. */
+  int gcount_active = 0;
+  for (int i = 0; i < gcount; ++i) gcount_active += ci_cache->active[i];
+  const int symmetric =
+      (gcount_active > gravity_pp_symmetric_min_active_fraction * gcount);
 
-    /* Not periodic -> Can always use Newtonian potential */
-    runner_doself_grav_pp_full(ci_cache, gcount, gcount_padded, e,
-                               c->grav.parts);
-
-  } else {
+  /* Can we use the Newtonian version or do we need the truncated one ? */
+  int truncated = 0;
+  if (periodic) {
 
     /* Get the maximal distance between any two particles */
     const double max_r = 2. * c->grav.multipole->r_max;
 
-    /* Do we need to use the truncated interactions ? */
-    if (max_r > min_trunc) {
-
-      /* Periodic but far-away cells must use the truncated potential */
-      runner_doself_grav_pp_truncated(ci_cache, gcount, gcount_padded, r_s_inv,
-                                      e, c->grav.parts);
-
-    } else {
+    /* Periodic but far-away cells must use the truncated potential, close-by
+     * cells can use the full Newtonian potential */
+    truncated = (max_r > min_trunc);
+  }
 
-      /* Periodic but close-by cells can use the full Newtonian potential */
-      runner_doself_grav_pp_full(ci_cache, gcount, gcount_padded, e,
-                                 c->grav.parts);
-    }
+  if (truncated && symmetric) {
+    runner_doself_grav_pp_truncated_symmetric(ci_cache, gcount, gcount_padded,
+                                              r_s_inv, e, c->grav.parts);
+  } else if (truncated) {
+    runner_doself_grav_pp_truncated(ci_cache, gcount, gcount_padded, r_s_inv,
+                                    e, c->grav.parts);
+  } else if (symmetric) {
+    runner_doself_grav_pp_full_symmetric(ci_cache, gcount, gcount_padded, e,
+                                         c->grav.parts);
+  } else {
+    runner_doself_grav_pp_full(ci_cache, gcount, gcount_padded, e,
+                               c->grav.parts);
   }
 
   /* Write back to the particles */
@@ -2197,9 +2535,8 @@ void runner_dopair_recursive_grav(struct runner *r, struct cell *ci,
     runner_dopair_grav_pp_no_cache(r, cj, ci);
 
     /* Can we use M-M interactions ? */
-  } else if (gravity_M2L_accept_symmetric(e->gravity_properties, multi_i,
-                                          multi_j, r2,
-                                          /* use_rebuild_sizes=*/0, periodic)) {
+  } else if (cell_can_use_pair_mm(ci, cj, e, e->s, /*use_rebuild_data=*/0,
+                                  /*is_tree_walk=*/1)) {
 
     /* Go M-M */
     runner_dopair_grav_mm(r, ci, cj);
@@ -95,12 +95,57 @@
 #define _DOSUB_SUBSET(f) PASTE(runner_dosub_subset, f)
 #define DOSUB_SUBSET _DOSUB_SUBSET(FUNCTION)
 
+#define _DOSUB_SUBSET_GATHER(f) PASTE(runner_dosub_subset_gather, f)
+#define DOSUB_SUBSET_GATHER _DOSUB_SUBSET_GATHER(FUNCTION)
+
+#define _DO_GATHER_RECURSE(f) PASTE(runner_do_gather_recurse, f)
+#define DO_GATHER_RECURSE _DO_GATHER_RECURSE(FUNCTION)
+
+#define _DO_CANDIDATES(f) PASTE(runner_do_candidates, f)
+#define DO_CANDIDATES _DO_CANDIDATES(FUNCTION)
+
+#define _DOPAIR1_BUILD_NLIST(f) PASTE(runner_dopair1_build_nlist, f)
+#define DOPAIR1_BUILD_NLIST _DOPAIR1_BUILD_NLIST(FUNCTION)
+
+#define _DOSELF1_BUILD_NLIST(f) PASTE(runner_doself1_build_nlist, f)
+#define DOSELF1_BUILD_NLIST _DOSELF1_BUILD_NLIST(FUNCTION)
+
+#define _DOPAIR1_NLIST(f) PASTE(runner_dopair1_nlist, f)
+#define DOPAIR1_NLIST _DOPAIR1_NLIST(FUNCTION)
+
+#define _DOPAIR2_NLIST(f) PASTE(runner_dopair2_nlist, f)
+#define DOPAIR2_NLIST _DOPAIR2_NLIST(FUNCTION)
+
+#define _DOSELF1_NLIST(f) PASTE(runner_doself1_nlist, f)
+#define DOSELF1_NLIST _DOSELF1_NLIST(FUNCTION)
+
+#define _DOSELF2_NLIST(f) PASTE(runner_doself2_nlist, f)
+#define DOSELF2_NLIST _DOSELF2_NLIST(FUNCTION)
+
+#define _HOT_CACHE_READ(f) PASTE(runner_hot_cache_read, f)
+#define HOT_CACHE_READ _HOT_CACHE_READ(FUNCTION)
+
+#define _DOPAIR_VEC(f) PASTE(runner_dopair_vec, f)
+#define DOPAIR_VEC _DOPAIR_VEC(FUNCTION)
+
+#define _DOSELF_VEC(f) PASTE(runner_doself_vec, f)
+#define DOSELF_VEC _DOSELF_VEC(FUNCTION)
+
+#define _IACT_NONSYM_NGBS(f) PASTE(runner_iact_nonsym_ngbs, f)
+#define IACT_NONSYM_NGBS _IACT_NONSYM_NGBS(FUNCTION)
+
 #define _IACT_NONSYM(f) PASTE(runner_iact_nonsym, f)
 #define IACT_NONSYM _IACT_NONSYM(FUNCTION)
 
 #define _IACT(f) PASTE(runner_iact, f)
 #define IACT _IACT(FUNCTION)
 
+#define _IACT_NONSYM_NLIST(f) PASTE(runner_iact_nonsym_nlist, f)
+#define IACT_NONSYM_NLIST _IACT_NONSYM_NLIST(FUNCTION)
+
+#define _IACT_NLIST(f) PASTE(runner_iact_nlist, f)
+#define IACT_NLIST _IACT_NLIST(FUNCTION)
+
 #if ((FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY) ||  \
      (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT) || \
      (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE))
@@ -147,6 +192,22 @@
 #define _IACT_VEC(f) PASTE(runner_iact_vec, f)
 #define IACT_VEC _IACT_VEC(FUNCTION)
 
+#define _IACT_NONSYM_VEC_INIT(f) PASTE(runner_iact_nonsym_vec_init, f)
+#define IACT_NONSYM_VEC_INIT _IACT_NONSYM_VEC_INIT(FUNCTION)
+
+#define _IACT_NONSYM_VEC_REDUCE(f) PASTE(runner_iact_nonsym_vec_reduce, f)
+#define IACT_NONSYM_VEC_REDUCE _IACT_NONSYM_VEC_REDUCE(FUNCTION)
+
+#define _IACT_VEC_DATA(f) PASTE(runner_iact_vec_data, f)
+#define IACT_VEC_DATA _IACT_VEC_DATA(FUNCTION)
+
+/* Does the hydro scheme have lane-parallel interactions for this loop? */
+#if ((FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY) && \
+     defined(HYDRO_VEC_DENSITY)) ||               \
+    ((FUNCTION_TASK_LOOP == TASK_LOOP_FORCE) && defined(HYDRO_VEC_FORCE))
+#define DO_VEC_IACT 1
+#endif
+
 #define _TIMER_DOSELF(f) PASTE(timer_doself, f)
 #define TIMER_DOSELF _TIMER_DOSELF(FUNCTION)
 
@@ -189,3 +250,14 @@ void DOPAIR_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
 
 void DOSUB_SUBSET(struct runner *r, struct cell *ci, struct part *parts,
                   int *ind, int count, struct cell *cj, int gettimer);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+void DOSUB_SUBSET_GATHER(struct runner *r, struct cell *ci,
+                         const struct part *pi, struct cell *cj,
+                         const float h_gather,
+                         struct hydro_ngb_buffer *buffer);
+
+void DO_CANDIDATES(struct runner *r, struct part *restrict pi,
+                   const struct hydro_ngb_candidate *restrict candidates,
+                   const int num);
+#endif
@@ -77,6 +77,9 @@
 #define _IACT_NONSYM(f) PASTE(runner_iact_nonsym, f)
 #define IACT_NONSYM _IACT_NONSYM(FUNCTION)
 
+#define _IACT_NONSYM_WAKEUP(f) PASTE(runner_iact_nonsym_wakeup, f)
+#define IACT_NONSYM_WAKEUP _IACT_NONSYM_WAKEUP(FUNCTION)
+
 #define _IACT(f) PASTE(runner_iact, f)
 #define IACT _IACT(FUNCTION)
 
@@ -71,6 +71,9 @@
 #define _DOSUB_SELF1_STARS(f) PASTE(runner_dosub_self_stars, f)
 #define DOSUB_SELF1_STARS _DOSUB_SELF1_STARS(FUNCTION)
 
+#define _HOT_CACHE_READ_STARS_GAS(f) PASTE(runner_hot_cache_read_gas_stars, f)
+#define HOT_CACHE_READ_STARS_GAS _HOT_CACHE_READ_STARS_GAS(FUNCTION)
+
 #define _TIMER_DOSELF_STARS(f) PASTE(timer_doself_stars, f)
 #define TIMER_DOSELF_STARS _TIMER_DOSELF_STARS(FUNCTION)
 
@@ -86,6 +89,26 @@
 #define _IACT_STARS(f) PASTE(runner_iact_nonsym_stars, f)
 #define IACT_STARS _IACT_STARS(FUNCTION)
 
+#define _IACT_STARS_NGBS(f) PASTE(runner_iact_nonsym_ngbs_stars, f)
+#define IACT_STARS_NGBS _IACT_STARS_NGBS(FUNCTION)
+
+#define _IACT_STARS_VEC(f) PASTE(runner_iact_nonsym_vec_stars, f)
+#define IACT_STARS_VEC _IACT_STARS_VEC(FUNCTION)
+
+#define _IACT_STARS_VEC_INIT(f) PASTE(runner_iact_nonsym_vec_init_stars, f)
+#define IACT_STARS_VEC_INIT _IACT_STARS_VEC_INIT(FUNCTION)
+
+#define _IACT_STARS_VEC_REDUCE(f) PASTE(runner_iact_nonsym_vec_reduce_stars, f)
+#define IACT_STARS_VEC_REDUCE _IACT_STARS_VEC_REDUCE(FUNCTION)
+
+#define _IACT_STARS_VEC_DATA(f) PASTE(runner_iact_vec_data_stars, f)
+#define IACT_STARS_VEC_DATA _IACT_STARS_VEC_DATA(FUNCTION)
+
+/* Does the stellar model have lane-parallel interactions for this loop? */
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY) && defined(STARS_VEC_DENSITY)
+#define DO_VEC_IACT 1
+#endif
+
 void DOSELF1_BRANCH_STARS(struct runner *r, struct cell *c);
 void DOPAIR1_BRANCH_STARS(struct runner *r, struct cell *ci, struct cell *cj);
 
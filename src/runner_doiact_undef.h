@@ -41,3 +41,4 @@
 #undef CELL_IS_ACTIVE
 #undef CELL_ARE_PART_DRIFTED
 #undef DO_DRIFT_DEBUG_CHECKS
+#undef DO_VEC_IACT
@@ -1075,6 +1075,48 @@ void runner_do_extra_ghost(struct runner *r, struct cell *c, int timer) {
 #endif
 }
 
+/**
+ * @brief Gather the candidate neighbours of a gas particle from all the
+ * density interactions of its cell and of the cell's parents.
+ *
+ * @param r The runner thread.
+ * @param c The (leaf) cell containing the particle.
+ * @param p The #part.
+ * @param h_gather The smoothing length out to which we gather.
+ * @param buffer The #hydro_ngb_buffer to append the candidates to.
+ */
+static void runner_ghost_gather_candidates(struct runner *r, struct cell *c,
+                                           const struct part *p,
+                                           const float h_gather,
+                                           struct hydro_ngb_buffer *buffer) {
+
+  /* Climb up the cell hierarchy. */
+  for (struct cell *finger = c; finger != NULL; finger = finger->parent) {
+
+    /* Run through this cell's density interactions. */
+    for (struct link *l = finger->hydro.density; l != NULL; l = l->next) {
+
+      /* Self-interaction? */
+      if (l->t->type == task_type_self || l->t->type == task_type_sub_self)
+        runner_dosub_subset_gather_density(r, finger, p, NULL, h_gather,
+                                           buffer);
+
+      /* Otherwise, pair interaction? */
+      else if (l->t->type == task_type_pair ||
+               l->t->type == task_type_sub_pair) {
+
+        /* Left or right? */
+        if (l->t->ci == finger)
+          runner_dosub_subset_gather_density(r, finger, p, l->t->cj, h_gather,
+                                             buffer);
+        else
+          runner_dosub_subset_gather_density(r, finger, p, l->t->ci, h_gather,
+                                             buffer);
+      }
+    }
+  }
+}
+
 /**
  * @brief Intermediate task after the density to check that the smoothing
  * lengths are correct.
@@ -1107,7 +1149,10 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
   const int use_mass_weighted_num_ngb =
       e->hydro_properties->use_mass_weighted_num_ngb;
   const int max_smoothing_iter = e->hydro_properties->max_smoothing_iterations;
-  int redo = 0, count = 0;
+  const float ghost_buffer_factor = e->hydro_properties->ghost_buffer_factor;
+  const int with_nlists = e->hydro_properties->use_neighbour_lists;
+  const float nlist_h_factor = 1.f + e->hydro_properties->neighbour_list_skin;
+  int redo = 0, count = 0, nlist_invalid = 0;
 
   /* Running value of the maximal smoothing length */
   float h_max = c->hydro.h_max;
@@ -1132,6 +1177,11 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
     }
   } else {
 
+    /* Candidate neighbours of the particles that have to be updated, only
+     * allocated if some particles need more than one re-run. */
+    struct hydro_ngb_buffer buffer;
+    int have_buffer = 0;
+
     /* Init the list of active particles that have to be updated and their
      * current smoothing lengths. */
     int *pid = NULL;
@@ -1313,6 +1363,10 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
               rt_reset_part(p, cosmo);
             }
 
+            /* Did h grow out of the neighbour lists? */
+            if (with_nlists && p->h > nlist_h_factor * h_init)
+              nlist_invalid = 1;
+
             /* Ok, we are done with this particle */
             continue;
           }
@@ -1427,6 +1481,9 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
         h_max = max(h_max, p->h);
         h_max_active = max(h_max_active, p->h);
 
+        /* Did h grow out of the neighbour lists? */
+        if (with_nlists && p->h > nlist_h_factor * h_init) nlist_invalid = 1;
+
         ghost_stats_converged_hydro(&c->ghost_statistics, p);
 
         /* Update gravitational softening (in adaptive softening case) */
@@ -1504,7 +1561,40 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
 
       /* Re-set the counter for the next loop (potentially). */
       count = redo;
-      if (count > 0) {
+
+      /* The first re-run searches the cells as the density loop did. The
+       * particles that still have not converged after that get a buffer of
+       * candidate neighbours, gathered once within a larger radius, and
+       * iterate over it rather than walking the cells again. */
+      if (count > 0 && ghost_buffer_factor > 0.f && num_reruns > 0) {
+
+        if (!have_buffer) {
+          hydro_ngb_buffer_init(&buffer, c->hydro.count);
+          have_buffer = 1;
+        }
+
+        for (int i = 0; i < count; i++) {
+
+          struct part *p = &parts[pid[i]];
+
+          /* (Re-)gather the candidates of the particles that do not have
+           * any yet or whose kernel grew beyond them. This is the only
+           * place where we walk the cells again. */
+          if (buffer.num[pid[i]] < 0 || p->h > buffer.h_gather[pid[i]]) {
+            const float h_gather = ghost_buffer_factor * p->h;
+            buffer.first[pid[i]] = buffer.count;
+            buffer.h_gather[pid[i]] = h_gather;
+            runner_ghost_gather_candidates(r, c, p, h_gather, &buffer);
+            buffer.num[pid[i]] = buffer.count - buffer.first[pid[i]];
+          }
+
+          /* Compute the density over the candidates */
+          runner_do_candidates_density(
+              r, p, &buffer.candidates[buffer.first[pid[i]]],
+              buffer.num[pid[i]]);
+        }
+
+      } else if (count > 0) {
 
         /* Climb up the cell hierarchy. */
         for (struct cell *finger = c; finger != NULL; finger = finger->parent) {
@@ -1571,6 +1661,14 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
     free(right);
     free(pid);
     free(h_0);
+    if (have_buffer) hydro_ngb_buffer_clean(&buffer);
+
+    /* The neighbour lists of this cell and of its parents are now
+     * incomplete, the next loops will have to search for the neighbours. */
+    if (nlist_invalid) {
+      for (struct cell *tmp = c; tmp != NULL; tmp = tmp->parent)
+        atomic_max(&tmp->hydro.nlist_invalid_epoch, e->hydro_nlist_epoch);
+    }
   }
 
   /* Update h_max */
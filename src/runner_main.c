@@ -640,3 +640,8 @@ ticks runner_get_active_time(const struct runner *restrict r) {
 }
 
 void runner_reset_active_time(struct runner *restrict r) { r->active_time = 0; }
+
+void runner_reset_sort_counts(struct runner *restrict r) {
+  for (int k = 0; k < runner_sort_count; k++) r->sort_counts[k] = 0;
+  r->culled_subpairs = 0;
+}
@@ -34,6 +34,10 @@
 /*! The size of the sorting stack used at the leaf level */
 const int sort_stack_size = 10;
 
+/*! The largest number of entries for which the radix sort buffer lives on
+ * the stack */
+#define sort_radix_stack_buffer_size 1024
+
 /**
  * @brief Sorts again all the stars in a given cell hierarchy.
  *
@@ -162,6 +166,29 @@ void runner_do_sort_ascending(struct sort_entry *sort, int N) {
   }
 }
 
+/**
+ * @brief Sort the entries in ascending order using a radix sort.
+ *
+ * Small arrays use a buffer on the stack, larger ones a temporary
+ * allocation.
+ *
+ * @param sort The entries
+ * @param N The number of entries.
+ */
+void runner_do_sort_ascending_radix(struct sort_entry *sort, int N) {
+
+  if (N <= sort_radix_stack_buffer_size) {
+    struct sort_entry buff[sort_radix_stack_buffer_size];
+    sort_radix_ascending(sort, buff, N);
+  } else {
+    struct sort_entry *buff =
+        (struct sort_entry *)malloc(N * sizeof(struct sort_entry));
+    if (buff == NULL) error("Failed to allocate the radix sort buffer.");
+    sort_radix_ascending(sort, buff, N);
+    free(buff);
+  }
+}
+
 #ifdef SWIFT_DEBUG_CHECKS
 /**
  * @brief Recursively checks that the flags are consistent in a cell hierarchy.
@@ -203,11 +230,9 @@ RUNNER_CHECK_SORTS(stars)
 void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
                           int cleanup, int rt_requests_sort, int clock) {
 
-  struct sort_entry *fingers[8];
   const int count = c->hydro.count;
   const struct part *parts = c->hydro.parts;
   struct xpart *xparts = c->hydro.xparts;
-  float buff[8];
 
   TIMER_TIC;
 
@@ -298,47 +323,18 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
         else
           off[k] = off[k - 1];
 
-      /* Init the entries and indices. */
-      int inds[8];
+      /* Init the entries, pointing empty progeny at a sentinel. */
+      static const struct sort_entry sentinel = {FLT_MAX, 0};
+      const struct sort_entry *fingers[8];
       for (int k = 0; k < 8; k++) {
-        inds[k] = k;
-        if (c->progeny[k] != NULL && c->progeny[k]->hydro.count > 0) {
+        if (c->progeny[k] != NULL && c->progeny[k]->hydro.count > 0)
           fingers[k] = cell_get_hydro_sorts(c->progeny[k], j);
-          buff[k] = fingers[k]->d;
-          off[k] = off[k];
-        } else
-          buff[k] = FLT_MAX;
+        else
+          fingers[k] = &sentinel;
       }
 
-      /* Sort the buffer. */
-      for (int i = 0; i < 7; i++)
-        for (int k = i + 1; k < 8; k++)
-          if (buff[inds[k]] < buff[inds[i]]) {
-            int temp_i = inds[i];
-            inds[i] = inds[k];
-            inds[k] = temp_i;
-          }
-
-      /* For each entry in the new sort list. */
-      struct sort_entry *finger = cell_get_hydro_sorts(c, j);
-      for (int ind = 0; ind < count; ind++) {
-
-        /* Copy the minimum into the new sort array. */
-        finger[ind].d = buff[inds[0]];
-        finger[ind].i = fingers[inds[0]]->i + off[inds[0]];
-
-        /* Update the buffer. */
-        fingers[inds[0]] += 1;
-        buff[inds[0]] = fingers[inds[0]]->d;
-
-        /* Find the smallest entry. */
-        for (int k = 1; k < 8 && buff[inds[k]] < buff[inds[k - 1]]; k++) {
-          int temp_i = inds[k - 1];
-          inds[k - 1] = inds[k];
-          inds[k] = temp_i;
-        }
-
-      } /* Merge. */
+      /* Merge the progeny's lists. */
+      sort_merge_loser_tree(cell_get_hydro_sorts(c, j), fingers, off, count);
 
       /* Add a sentinel. */
 
@@ -356,6 +352,9 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
   /* Otherwise, just sort. */
   else {
 
+    /* Arrays whose previous order we repair rather than sort from scratch */
+    int repair = 0;
+
     /* Reset the sort distance */
     if (c->hydro.sorted == 0) {
 #ifdef SWIFT_DEBUG_CHECKS
@@ -365,11 +364,22 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
 
       /* And the individual sort distances if we are a local cell */
       if (xparts != NULL) {
+        float dx2_sum = 0.f;
         for (int k = 0; k < count; k++) {
+          dx2_sum += xparts[k].x_diff_sort[0] * xparts[k].x_diff_sort[0] +
+                     xparts[k].x_diff_sort[1] * xparts[k].x_diff_sort[1] +
+                     xparts[k].x_diff_sort[2] * xparts[k].x_diff_sort[2];
           xparts[k].x_diff_sort[0] = 0.0f;
           xparts[k].x_diff_sort[1] = 0.0f;
           xparts[k].x_diff_sort[2] = 0.0f;
         }
+
+        /* Repairing the previous order is only worth it if the particles
+         * moved little compared to their spacing along the axes, i.e. if
+         * count * rms displacement is small compared to the cell size. */
+        const float max_disp = sort_repair_max_displaced_entries * c->dmin;
+        if (count * dx2_sum < max_disp * max_disp)
+          repair = flags & c->hydro.sort_reusable;
       }
       c->hydro.dx_max_sort_old = 0.f;
       c->hydro.dx_max_sort = 0.f;
@@ -379,7 +389,7 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
     for (int k = 0; k < count; k++) {
       const double px[3] = {parts[k].x[0], parts[k].x[1], parts[k].x[2]};
       for (int j = 0; j < 13; j++)
-        if (flags & (1 << j)) {
+        if ((flags & ~repair) & (1 << j)) {
           struct sort_entry *entries = cell_get_hydro_sorts(c, j);
           entries[k].i = k;
           entries[k].d = px[0] * runner_shift[j][0] +
@@ -389,16 +399,42 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
     }
 
     /* Add the sentinel and sort. */
-    for (int j = 0; j < 13; j++)
-      if (flags & (1 << j)) {
-        struct sort_entry *entries = cell_get_hydro_sorts(c, j);
-        entries[count].d = FLT_MAX;
-        entries[count].i = 0;
-        runner_do_sort_ascending(entries, count);
-        atomic_or(&c->hydro.sorted, 1 << j);
+    for (int j = 0; j < 13; j++) {
+      if (!(flags & (1 << j))) continue;
+
+      struct sort_entry *entries = cell_get_hydro_sorts(c, j);
+      entries[count].d = FLT_MAX;
+      entries[count].i = 0;
+
+      if (repair & (1 << j)) {
+
+        /* Update the distances in the previous order and repair it */
+        for (int k = 0; k < count; k++) {
+          const struct part *p = &parts[entries[k].i];
+          entries[k].d = p->x[0] * runner_shift[j][0] +
+                         p->x[1] * runner_shift[j][1] +
+                         p->x[2] * runner_shift[j][2];
+        }
+        if (sort_repair_ascending(entries, count,
+                                  sort_repair_max_moves_per_entry * count)) {
+          r->sort_counts[runner_sort_repaired]++;
+        } else {
+          runner_do_sort_ascending_radix(entries, count);
+          r->sort_counts[runner_sort_repair_failed]++;
+        }
+
+      } else {
+        runner_do_sort_ascending_radix(entries, count);
+        r->sort_counts[runner_sort_full]++;
       }
+
+      atomic_or(&c->hydro.sorted, 1 << j);
+    }
   }
 
+  /* The arrays now hold an order we may repair next time */
+  c->hydro.sort_reusable |= flags;
+
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify the sorting. */
   for (int j = 0; j < 13; j++) {
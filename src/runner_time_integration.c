@@ -1360,8 +1360,22 @@ void runner_do_limiter(struct runner *r, struct cell *c, int force,
     ti_gravity_end_min = c->grav.ti_end_min;
     ti_gravity_beg_max = c->grav.ti_beg_max;
 
+    /* Only visit the particles woken up in the limiter loop, unless their
+     * list overflowed or is missing (or all particles need their fake
+     * self-contribution) */
+    struct cell_hydro_candidates *list = c->hydro.candidates;
+#ifdef SWIFT_HYDRO_DENSITY_CHECKS
+    const int use_candidates = 0;
+#else
+    const int use_candidates =
+        list != NULL && list->limiter_count <= cell_hydro_max_candidates;
+#endif
+    const int num = use_candidates ? list->limiter_count : count;
+
     /* Loop over the gas particles in this cell. */
-    for (int k = 0; k < count; k++) {
+    for (int n = 0; n < num; n++) {
+
+      const int k = use_candidates ? list->limiter[n] : n;
 
       /* Get a handle on the part. */
       struct part *restrict p = &parts[k];
@@ -1432,6 +1446,9 @@ void runner_do_limiter(struct runner *r, struct cell *c, int force,
     c->hydro.ti_beg_max = max(c->hydro.ti_beg_max, ti_hydro_beg_max);
     c->grav.ti_end_min = min(c->grav.ti_end_min, ti_gravity_end_min);
     c->grav.ti_beg_max = max(c->grav.ti_beg_max, ti_gravity_beg_max);
+
+    /* All the candidates have been dealt with */
+    if (list != NULL) list->limiter_count = 0;
   }
 
   /* Clear the limiter flags. */
@@ -1512,8 +1529,17 @@ void runner_do_sync(struct runner *r, struct cell *c, int force,
     ti_gravity_end_min = c->grav.ti_end_min;
     ti_gravity_beg_max = c->grav.ti_beg_max;
 
+    /* Only visit the particles flagged for synchronization, unless their
+     * list overflowed or is missing */
+    struct cell_hydro_candidates *list = c->hydro.candidates;
+    const int use_candidates =
+        list != NULL && list->sync_count <= cell_hydro_max_candidates;
+    const int num = use_candidates ? list->sync_count : count;
+
     /* Loop over the gas particles in this cell. */
-    for (int k = 0; k < count; k++) {
+    for (int n = 0; n < num; n++) {
+
+      const int k = use_candidates ? list->sync[n] : n;
 
       /* Get a handle on the part. */
       struct part *restrict p = &parts[k];
@@ -1604,6 +1630,9 @@ void runner_do_sync(struct runner *r, struct cell *c, int force,
     c->hydro.ti_beg_max = max(c->hydro.ti_beg_max, ti_hydro_beg_max);
     c->grav.ti_end_min = min(c->grav.ti_end_min, ti_gravity_end_min);
     c->grav.ti_beg_max = max(c->grav.ti_beg_max, ti_gravity_beg_max);
+
+    /* All the candidates have been dealt with */
+    if (list != NULL) list->sync_count = 0;
   }
 
   /* Clear the sync flags. */
@@ -81,6 +81,9 @@ struct scheduler {
   int *tid_active;
   int active_count;
 
+  /* Number of sub-cell pairs of hydro tasks skipped during the activation. */
+  int nr_culled_subpairs;
+
   /* The task unlocks. */
   struct task **volatile unlocks;
   int *volatile unlock_ind;
@@ -24,13 +24,17 @@
 #if defined(HAVE_HDF5) && !defined(WITH_MPI)
 
 /* Some standard headers. */
+#include <fcntl.h>
 #include <hdf5.h>
 #include <math.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <time.h>
+#include <unistd.h>
 
 /* This object's header. */
 #include "single_io.h"
@@ -47,6 +51,7 @@
 #include "hydro_io.h"
 #include "hydro_properties.h"
 #include "io_compression.h"
+#include "io_parallel_compression.h"
 #include "io_properties.h"
 #include "memuse.h"
 #include "mhd_io.h"
@@ -58,6 +63,7 @@
 #include "sink_io.h"
 #include "star_formation_io.h"
 #include "stars_io.h"
+#include "threadpool.h"
 #include "tools.h"
 #include "units.h"
 #include "version.h"
@@ -66,9 +72,444 @@
 /* Max number of entries that can be written for a given particle type */
 static const int io_max_size_output_list = 100;
 
+/**
+ * @brief A read-only memory map of a whole IC file, used to read the
+ * datasets stored contiguously and without filters straight into the
+ * particle arrays.
+ */
+struct io_ic_map {
+
+  /*! Start of the mapping, NULL if the file could not be mapped. */
+  const char* data;
+
+  /*! Size of the file in bytes. */
+  size_t size;
+
+  /*! Bytes read through the map, chunk by chunk in parallel and through
+   * HDF5. */
+  size_t mapped_bytes, chunked_bytes, hdf5_bytes;
+
+  /*! Time spent reading through the map, the chunks and HDF5. */
+  ticks mapped_ticks, chunked_ticks, hdf5_ticks;
+};
+
+/**
+ * @brief Map a file in memory.
+ *
+ * Failing to map the file is not an error; the datasets are then all read
+ * with HDF5.
+ *
+ * @param map The #io_ic_map to initialise.
+ * @param fileName The name of the file.
+ */
+static void io_ic_map_init(struct io_ic_map* map, const char* fileName) {
+
+  bzero(map, sizeof(struct io_ic_map));
+
+  const int fd = open(fileName, O_RDONLY);
+  if (fd < 0) return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      map->data = (const char*)data;
+      map->size = st.st_size;
+    }
+  }
+
+  /* The mapping stays valid once the file is closed. */
+  close(fd);
+}
+
+/**
+ * @brief Report the read speeds and unmap the file.
+ *
+ * @param map The #io_ic_map.
+ */
+static void io_ic_map_clean(struct io_ic_map* map) {
+
+  const double GB = 1024. * 1024. * 1024.;
+  const double mapped_time = clocks_from_ticks(map->mapped_ticks);
+  const double chunked_time = clocks_from_ticks(map->chunked_ticks);
+  const double hdf5_time = clocks_from_ticks(map->hdf5_ticks);
+  const double total_time = mapped_time + chunked_time + hdf5_time;
+  const size_t total_bytes =
+      map->mapped_bytes + map->chunked_bytes + map->hdf5_bytes;
+
+  if (total_bytes > 0)
+    message(
+        "Read %.3f GB of particle data in %.3f %s (%.3f GB/s), of which %.3f "
+        "GB directly from the mapped file (%.3f GB/s) and %.3f GB decoded in "
+        "parallel from chunks (%.3f GB/s).",
+        total_bytes / GB, total_time, clocks_getunit(),
+        total_time > 0. ? total_bytes / GB / total_time * 1000. : 0.,
+        map->mapped_bytes / GB,
+        mapped_time > 0. ? map->mapped_bytes / GB / mapped_time * 1000. : 0.,
+        map->chunked_bytes / GB,
+        chunked_time > 0. ? map->chunked_bytes / GB / chunked_time * 1000.
+                          : 0.);
+
+  if (map->data != NULL) munmap((void*)map->data, map->size);
+  map->data = NULL;
+}
+
+/*! Data needed to scatter a mapped dataset into the particle arrays. */
+struct io_ic_scatter_data {
+
+  /*! The field to fill. */
+  struct io_props props;
+
+  /*! Start of the dataset in the mapped file. */
+  const char* src;
+
+  /*! Which factors to apply to the values read? */
+  int do_unit, do_h, do_vel;
+
+  /*! The factors, in double and in float precision. */
+  double unit_factor, h_factor_d, vel_factor_d;
+  float h_factor_f, vel_factor_f;
+};
+
+/**
+ * @brief Copy rows of a dataset into the particle arrays and apply the unit,
+ * h and sqrt(a) conversions on the way.
+ *
+ * The conversions are applied one after the other in the same precision as
+ * in #read_array_single such that all the paths give identical values.
+ *
+ * @param d The #io_ic_scatter_data.
+ * @param src The rows to copy.
+ * @param first The index of the first particle to fill.
+ * @param count The number of rows.
+ */
+static void io_ic_scatter_rows(const struct io_ic_scatter_data* d,
+                               const char* src, size_t first, size_t count) {
+
+  const struct io_props* props = &d->props;
+  const size_t typeSize = io_sizeof_type(props->type);
+  const size_t copySize = typeSize * props->dimension;
+  char* dest = props->field + first * props->partSize;
+
+  const int convert = d->do_unit || d->do_h || d->do_vel;
+
+  if (!convert) {
+    for (size_t k = 0; k < count; ++k)
+      memcpy(dest + k * props->partSize, src + k * copySize, copySize);
+
+  } else if (props->type == DOUBLE) {
+    for (size_t k = 0; k < count; ++k) {
+      double temp[props->dimension];
+      memcpy(temp, src + k * copySize, copySize);
+      for (int j = 0; j < props->dimension; ++j) {
+        if (d->do_unit) temp[j] *= d->unit_factor;
+        if (d->do_h) temp[j] *= d->h_factor_d;
+        if (d->do_vel) temp[j] *= d->vel_factor_d;
+      }
+      memcpy(dest + k * props->partSize, temp, copySize);
+    }
+
+  } else {
+    for (size_t k = 0; k < count; ++k) {
+      float temp[props->dimension];
+      memcpy(temp, src + k * copySize, copySize);
+      for (int j = 0; j < props->dimension; ++j) {
+        if (d->do_unit) temp[j] *= d->unit_factor;
+        if (d->do_h) temp[j] *= d->h_factor_f;
+        if (d->do_vel) temp[j] *= d->vel_factor_f;
+      }
+      memcpy(dest + k * props->partSize, temp, copySize);
+    }
+  }
+}
+
+/**
+ * @brief Mapper function copying a mapped dataset into the particle arrays.
+ */
+static void io_ic_scatter_mapper(void* map_data, int num_elements,
+                                 void* extra_data) {
+
+  const struct io_ic_scatter_data* d =
+      (const struct io_ic_scatter_data*)extra_data;
+  const size_t copySize = io_sizeof_type(d->props.type) * d->props.dimension;
+
+  /* How far are we with this chunk? */
+  const ptrdiff_t delta =
+      ((char*)map_data - d->props.field) / d->props.partSize;
+
+  io_ic_scatter_rows(d, d->src + delta * copySize, delta, num_elements);
+}
+
+/**
+ * @brief Can a dataset be read straight from the mapped file?
+ *
+ * This is the case if the data is stored contiguously, without filters and
+ * in exactly the type we want in memory.
+ *
+ * @param h_data The dataset.
+ * @param props The #io_props of the field to read.
+ * @param N The number of particles.
+ * @param map The #io_ic_map.
+ * @param offset (return) The offset of the data in the file.
+ */
+static int io_ic_map_can_read(hid_t h_data, const struct io_props props,
+                              size_t N, const struct io_ic_map* map,
+                              size_t* offset) {
+
+  if (map->data == NULL || N == 0) return 0;
+
+  const size_t bytes = N * props.dimension * io_sizeof_type(props.type);
+
+  /* Contiguous, unfiltered and allocated? */
+  const hid_t h_plist = H5Dget_create_plist(h_data);
+  const int contiguous = H5Pget_layout(h_plist) == H5D_CONTIGUOUS &&
+                         H5Pget_nfilters(h_plist) == 0 &&
+                         H5Pget_external_count(h_plist) == 0;
+  H5Pclose(h_plist);
+  if (!contiguous) return 0;
+
+  const haddr_t addr = H5Dget_offset(h_data);
+  if (addr == HADDR_UNDEF || addr + bytes > map->size) return 0;
+  if (H5Dget_storage_size(h_data) != bytes) return 0;
+
+  /* Same type on disk and in memory, including the byte order? */
+  const hid_t h_type = H5Dget_type(h_data);
+  const htri_t same_type = H5Tequal(h_type, io_hdf5_type(props.type));
+  H5Tclose(h_type);
+  if (same_type <= 0) return 0;
+
+  *offset = addr;
+  return 1;
+}
+
+/* Reading the raw chunks needs HDF5 >= 1.10.3, which this implies. Older
+ * libraries read everything with H5Dread(). */
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+
+/*! A chunk of an IC dataset to decode. */
+struct io_ic_chunk {
+
+  /*! Index of the chunk along the particles. */
+  size_t index;
+
+  /*! The chunk as stored in the file, if already read, and its size. */
+  void* raw;
+  size_t raw_size;
+
+  /*! The filters that were not applied to this chunk. */
+  unsigned int filter_mask;
+};
+
+/*! Data shared by all the chunks of an IC dataset being decoded. */
+struct io_ic_chunk_data {
+
+  /*! Where and how to copy the decoded data. */
+  struct io_ic_scatter_data scatter;
+
+  /*! The dataset. */
+  hid_t h_data;
+
+  /*! The filters to undo. */
+  struct io_filter_pipeline pipeline;
+
+  /*! Number of rows in the dataset and in a chunk. */
+  size_t N, chunk_rows;
+};
+
+/**
+ * @brief Read a chunk, as stored in the file, of an IC dataset.
+ *
+ * Chunks that were never written are returned with a size of 0.
+ */
+static void io_ic_read_chunk(hid_t h_data, struct io_ic_chunk* c,
+                             size_t chunk_rows, const char* name) {
+
+  const hsize_t offset[2] = {c->index * chunk_rows, 0};
+
+  hsize_t size = 0;
+  if (H5Dget_chunk_storage_size(h_data, offset, &size) < 0)
+    error("Error while getting the size of a chunk of data set '%s'.", name);
+
+  c->raw_size = size;
+  c->raw = NULL;
+  c->filter_mask = 0;
+  if (size == 0) return;
+
+  c->raw = malloc(size);
+  if (c->raw == NULL) error("Unable to allocate memory for a chunk");
+
+  uint32_t filter_mask = 0;
+  if (H5Dread_chunk(h_data, H5P_DEFAULT, offset, &filter_mask, c->raw) < 0)
+    error("Error while reading a chunk of data set '%s'.", name);
+  c->filter_mask = filter_mask;
+}
+
+/**
+ * @brief Mapper function decoding chunks of an IC dataset and copying them
+ * into the particle arrays.
+ *
+ * Chunks that have not been read yet are read here, such that with a
+ * thread-safe HDF5 library, the threads take turns reading while the others
+ * decode.
+ */
+static void io_ic_chunk_mapper(void* map_data, int num_elements,
+                               void* extra_data) {
+
+  struct io_ic_chunk* chunks = (struct io_ic_chunk*)map_data;
+  const struct io_ic_chunk_data* d = (const struct io_ic_chunk_data*)extra_data;
+  const struct io_props* props = &d->scatter.props;
+  const size_t chunk_bytes =
+      d->chunk_rows * io_sizeof_type(props->type) * props->dimension;
+
+  char* out = (char*)malloc(chunk_bytes);
+  char* scratch = (char*)malloc(chunk_bytes);
+  if (out == NULL || scratch == NULL)
+    error("Unable to allocate memory for chunk decoding buffers");
+
+  for (int k = 0; k < num_elements; ++k) {
+
+    struct io_ic_chunk* c = &chunks[k];
+    const size_t first = c->index * d->chunk_rows;
+    const size_t count =
+        first + d->chunk_rows > d->N ? d->N - first : d->chunk_rows;
+
+    if (c->raw == NULL)
+      io_ic_read_chunk(d->h_data, c, d->chunk_rows, props->name);
+
+    /* Unwritten chunks hold the (default) fill value. */
+    if (c->raw_size == 0)
+      bzero(out, chunk_bytes);
+    else
+      io_parallel_decompress_chunk(&d->pipeline, c->filter_mask, c->raw,
+                                   c->raw_size, out, chunk_bytes, scratch,
+                                   props->name);
+    free(c->raw);
+    c->raw = NULL;
+
+    io_ic_scatter_rows(&d->scatter, out, first, count);
+  }
+
+  free(out);
+  free(scratch);
+}
+
+/**
+ * @brief Can a dataset be read chunk by chunk in parallel?
+ *
+ * This is the case if the data is chunked along the particles only, with
+ * filters we know how to undo, the default fill value and exactly the type we
+ * want in memory.
+ *
+ * @param h_data The dataset.
+ * @param props The #io_props of the field to read.
+ * @param N The number of particles.
+ * @param pipeline (return) The filters applied to the chunks.
+ * @param chunk_rows (return) The number of rows in a chunk.
+ */
+static int io_ic_can_read_chunks(hid_t h_data, const struct io_props props,
+                                 size_t N, struct io_filter_pipeline* pipeline,
+                                 size_t* chunk_rows) {
+
+  if (N == 0) return 0;
+
+  /* Same type on disk and in memory, including the byte order? */
+  const hid_t h_type = H5Dget_type(h_data);
+  const htri_t same_type = H5Tequal(h_type, io_hdf5_type(props.type));
+  H5Tclose(h_type);
+  if (same_type <= 0) return 0;
+
+  const hid_t h_plist = H5Dget_create_plist(h_data);
+  int ok = H5Pget_layout(h_plist) == H5D_CHUNKED;
+
+  /* Chunks must span whole rows. */
+  const int rank = props.dimension > 1 ? 2 : 1;
+  hsize_t chunk_shape[2] = {0, 0};
+  if (ok) ok = H5Pget_chunk(h_plist, 2, chunk_shape) == rank;
+  if (ok && rank == 2) ok = chunk_shape[1] == (hsize_t)props.dimension;
+
+  /* Unwritten chunks must be zeros. */
+  H5D_fill_value_t fill_status;
+  if (ok)
+    ok = H5Pfill_value_defined(h_plist, &fill_status) >= 0 &&
+         fill_status != H5D_FILL_VALUE_USER_DEFINED;
+
+  if (ok)
+    ok = io_parallel_decompression_init(h_plist, io_sizeof_type(props.type),
+                                        pipeline);
+
+  H5Pclose(h_plist);
+
+  *chunk_rows = chunk_shape[0];
+  return ok && chunk_shape[0] > 0;
+}
+
+/**
+ * @brief Read a chunked dataset by decoding its chunks in parallel.
+ *
+ * @param h_data The dataset.
+ * @param scatter Where and how to copy the data.
+ * @param pipeline The filters applied to the chunks.
+ * @param N The number of particles.
+ * @param chunk_rows The number of rows in a chunk.
+ * @param tp The #threadpool.
+ */
+static void io_ic_read_chunks(hid_t h_data,
+                              const struct io_ic_scatter_data* scatter,
+                              const struct io_filter_pipeline* pipeline,
+                              size_t N, size_t chunk_rows,
+                              struct threadpool* tp) {
+
+  const size_t nr_chunks = (N + chunk_rows - 1) / chunk_rows;
+
+  struct io_ic_chunk_data data;
+  data.scatter = *scatter;
+  data.h_data = h_data;
+  data.pipeline = *pipeline;
+  data.N = N;
+  data.chunk_rows = chunk_rows;
+
+  /* With a thread-safe library, all the chunks are handed to the threads,
+   * which read them as they go. Otherwise, we read the chunks of a batch
+   * here first. */
+  hbool_t is_threadsafe = 0;
+  if (H5is_library_threadsafe(&is_threadsafe) < 0) is_threadsafe = 0;
+  const size_t batch_size =
+      is_threadsafe ? nr_chunks : (size_t)(4 * tp->num_threads);
+
+  struct io_ic_chunk* chunks =
+      (struct io_ic_chunk*)malloc(batch_size * sizeof(struct io_ic_chunk));
+  if (chunks == NULL) error("Unable to allocate memory for the chunk list");
+
+  for (size_t first = 0; first < nr_chunks; first += batch_size) {
+
+    const size_t count =
+        first + batch_size > nr_chunks ? nr_chunks - first : batch_size;
+
+    for (size_t k = 0; k < count; ++k) {
+      chunks[k].index = first + k;
+      if (is_threadsafe)
+        chunks[k].raw = NULL;
+      else
+        io_ic_read_chunk(h_data, &chunks[k], chunk_rows, scatter->props.name);
+    }
+
+    threadpool_map(tp, io_ic_chunk_mapper, chunks, count,
+                   sizeof(struct io_ic_chunk), /*chunk=*/1, &data);
+  }
+
+  free(chunks);
+}
+
+#endif /* IO_HAVE_PARALLEL_COMPRESSION */
+
 /**
  * @brief Reads a data array from a given HDF5 group.
  *
+ * Datasets stored contiguously and without filters are copied straight from
+ * the mapped file into the particle arrays, in parallel and without going
+ * through a temporary buffer. Chunked datasets whose filters we can undo are
+ * read chunk by chunk and decoded in parallel. The others are read with HDF5.
+ *
  * @param h_grp The group from which to read.
  * @param prop The #io_props of the field to read
  * @param N The number of particles.
@@ -79,6 +520,8 @@ static const int io_max_size_output_list = 100;
  * IC velocities?
  * @param h The value of the reduced Hubble constant.
  * @param a The current value of the scale-factor.
+ * @param map The #io_ic_map of the file.
+ * @param tp The #threadpool.
  *
  * @todo A better version using HDF5 hyper-slabs to read the file directly into
  * the part array will be written once the structures have been stabilized.
@@ -86,7 +529,8 @@ static const int io_max_size_output_list = 100;
 void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
                        const struct unit_system* internal_units,
                        const struct unit_system* ic_units, int cleanup_h,
-                       int cleanup_sqrt_a, double h, double a) {
+                       int cleanup_sqrt_a, double h, double a,
+                       struct io_ic_map* map, struct threadpool* tp) {
 
   const size_t typeSize = io_sizeof_type(props.type);
   const size_t copySize = typeSize * props.dimension;
@@ -122,6 +566,78 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
   const hid_t h_data = H5Dopen(h_grp, props.name, H5P_DEFAULT);
   if (h_data < 0) error("Error while opening data space '%s'.", props.name);
 
+  const ticks tic = getticks();
+
+  /* Which conversions will we need? */
+  const double unit_factor =
+      units_conversion_factor(ic_units, internal_units, props.units);
+  const float h_factor_exp = units_h_factor(internal_units, props.units);
+  const int do_unit = unit_factor != 1.;
+  const int do_h = cleanup_h && h_factor_exp != 0.f;
+  const int do_vel =
+      cleanup_sqrt_a && a != 1. && (strcmp(props.name, "Velocities") == 0);
+  int can_convert = props.type == FLOAT || props.type == DOUBLE;
+#ifdef SWIFT_DEBUG_CHECKS
+  /* Leave the range checks of float conversions to the code below. */
+  if (props.type == FLOAT && do_unit) can_convert = 0;
+#endif
+
+  /* Where and how to copy the data if we do not use HDF5 to do so. */
+  struct io_ic_scatter_data scatter;
+  scatter.props = props;
+  scatter.src = NULL;
+  scatter.do_unit = do_unit;
+  scatter.do_h = do_h;
+  scatter.do_vel = do_vel;
+  scatter.unit_factor = unit_factor;
+  scatter.h_factor_d = do_h ? pow(h, h_factor_exp) : 1.;
+  scatter.h_factor_f = do_h ? pow(h, h_factor_exp) : 1.f;
+  scatter.vel_factor_d = do_vel ? sqrt(a) : 1.;
+  scatter.vel_factor_f = do_vel ? sqrt(a) : 1.f;
+  const int can_scatter = can_convert || !(do_unit || do_h || do_vel);
+
+  /* Can we read the data straight from the mapped file? */
+  size_t offset = 0;
+  if (can_scatter && io_ic_map_can_read(h_data, props, N, map, &offset)) {
+
+    scatter.src = map->data + offset;
+
+    /* Ask for the pages ahead of the threads and give them back once the
+     * copy is done. */
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t page_start = offset - offset % page_size;
+    const size_t length = offset + num_elements * typeSize - page_start;
+    madvise((void*)(map->data + page_start), length, MADV_WILLNEED);
+
+    threadpool_map(tp, io_ic_scatter_mapper, props.field, N, props.partSize,
+                   threadpool_auto_chunk_size, &scatter);
+
+    madvise((void*)(map->data + page_start), length, MADV_DONTNEED);
+
+    map->mapped_bytes += num_elements * typeSize;
+    map->mapped_ticks += getticks() - tic;
+
+    H5Dclose(h_data);
+    return;
+  }
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+  /* Can we decode the chunks ourselves? */
+  struct io_filter_pipeline pipeline;
+  size_t chunk_rows = 0;
+  if (can_scatter &&
+      io_ic_can_read_chunks(h_data, props, N, &pipeline, &chunk_rows)) {
+
+    io_ic_read_chunks(h_data, &scatter, &pipeline, N, chunk_rows, tp);
+
+    map->chunked_bytes += num_elements * typeSize;
+    map->chunked_ticks += getticks() - tic;
+
+    H5Dclose(h_data);
+    return;
+  }
+#endif
+
   /* Allocate temporary buffer */
   void* temp = malloc(num_elements * typeSize);
   if (temp == NULL) error("Unable to allocate memory for temporary buffer");
@@ -134,8 +650,6 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
   if (h_err < 0) error("Error while reading data array '%s'.", props.name);
 
   /* Unit conversion if necessary */
-  const double unit_factor =
-      units_conversion_factor(ic_units, internal_units, props.units);
   if (unit_factor != 1. && exist != 0) {
 
     /* message("Converting ! factor=%e", factor); */
@@ -181,7 +695,6 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
   }
 
   /* Clean-up h if necessary */
-  const float h_factor_exp = units_h_factor(internal_units, props.units);
   if (cleanup_h && h_factor_exp != 0.f && exist != 0) {
 
     /* message("Multipltying '%s' by h^%f=%f", props.name, h_factor_exp,
@@ -217,6 +730,9 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
   for (size_t i = 0; i < N; ++i)
     memcpy(props.field + i * props.partSize, &temp_c[i * copySize], copySize);
 
+  map->hdf5_bytes += num_elements * typeSize;
+  map->hdf5_ticks += getticks() - tic;
+
   /* Free and close everything */
   free(temp);
   H5Dclose(h_data);
@@ -233,8 +749,10 @@ void read_array_single(hid_t h_grp, const struct io_props props, size_t N,
  * the HDF5 file.
  * @param props The #io_props of the field to read
  * @param N The number of particles to write.
+ * @param lossy_compression Level of lossy compression to use for this field.
  * @param internal_units The #unit_system used internally
  * @param snapshot_units The #unit_system used in the snapshots
+ * @param stats (return) The #io_write_stats to update.
  *
  * @todo A better version using HDF5 hyper-slabs to write the file directly from
  * the part array will be written once the structures have been stabilized.
@@ -244,7 +762,8 @@ void write_array_single(const struct engine* e, hid_t grp, const char* fileName,
                         const struct io_props props, const size_t N,
                         const enum lossy_compression_schemes lossy_compression,
                         const struct unit_system* internal_units,
-                        const struct unit_system* snapshot_units) {
+                        const struct unit_system* snapshot_units,
+                        struct io_write_stats* stats) {
 
   const size_t typeSize = io_sizeof_type(props.type);
   const size_t num_elements = N * props.dimension;
@@ -258,16 +777,33 @@ void write_array_single(const struct engine* e, hid_t grp, const char* fileName,
     error("Unable to allocate temporary i/o buffer");
 
   /* Copy the particle data to the temporary buffer */
+  ticks tic = getticks();
   io_copy_temp_buffer(temp, e, props, N, internal_units, snapshot_units);
+  stats->convert_ticks += getticks() - tic;
+  stats->converted_bytes += num_elements * typeSize;
 
   /* Create data space */
   const hid_t h_space = H5Screate(H5S_SIMPLE);
   if (h_space < 0)
     error("Error while creating data space for field '%s'.", props.name);
 
+  /* Can we run the lossless filters ourselves, in parallel over the chunks,
+   * rather than leave them to HDF5? */
+  int parallel_compression = 0;
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+  parallel_compression = N > 0 && e->snapshot_compression > 0 &&
+                         lossy_compression == compression_write_lossless;
+#endif
+
   /* Decide what chunk size to use based on compression */
   int log2_chunk_size = 20;
 
+  /* Use smaller chunks if there are not enough to keep all threads busy. */
+  if (parallel_compression)
+    while (log2_chunk_size > 16 &&
+           (N >> log2_chunk_size) < (size_t)(4 * e->threadpool.num_threads))
+      log2_chunk_size--;
+
   int rank;
   hsize_t shape[2];
   hsize_t chunk_shape[2];
@@ -340,10 +876,42 @@ void write_array_single(const struct engine* e, hid_t grp, const char* fileName,
                                  h_prop, H5P_DEFAULT);
   if (h_data < 0) error("Error while creating dataspace '%s'.", props.name);
 
-  /* Write temporary buffer to HDF5 dataspace */
-  h_err = H5Dwrite(h_data, io_hdf5_type(props.type), h_space, H5S_ALL,
-                   H5P_DEFAULT, temp);
-  if (h_err < 0) error("Error while writing data array '%s'.", props.name);
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+  /* Compress the chunks and release the uncompressed data. */
+  struct io_compressed_dataset compressed = {NULL, 0, 0, 0};
+  if (parallel_compression) {
+    tic = getticks();
+    io_parallel_compress((struct threadpool*)&e->threadpool, temp, N,
+                         props.dimension, typeSize, chunk_shape[0],
+                         e->snapshot_compression, &compressed);
+    stats->compress_ticks += getticks() - tic;
+    stats->compressed_in_bytes += compressed.raw_bytes;
+    stats->compressed_out_bytes += compressed.compressed_bytes;
+
+    swift_free("writebuff", temp);
+    temp = NULL;
+  }
+#endif
+
+  /* Write temporary buffer to HDF5 dataspace, unless the background writer
+   * does it once the attributes are in place. */
+  if (e->snapshot_async_writer == NULL) {
+    tic = getticks();
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+    if (parallel_compression) {
+      io_parallel_compression_write(h_data, &compressed, props.name);
+      stats->written_bytes += compressed.compressed_bytes;
+      io_parallel_compression_free(&compressed);
+    } else
+#endif
+    {
+      h_err = H5Dwrite(h_data, io_hdf5_type(props.type), h_space, H5S_ALL,
+                       H5P_DEFAULT, temp);
+      if (h_err < 0) error("Error while writing data array '%s'.", props.name);
+      stats->written_bytes += num_elements * typeSize;
+    }
+    stats->write_ticks += getticks() - tic;
+  }
 
   /* Write XMF description for this data set */
   if (xmfFile != NULL)
@@ -389,8 +957,25 @@ void write_array_single(const struct engine* e, hid_t grp, const char* fileName,
   /* Write the full description */
   io_write_attribute_s(h_data, "Description", props.description);
 
+  /* Hand the data over to the background writer, which will free the buffer
+   * and close the dataset once written. */
+  if (e->snapshot_async_writer != NULL) {
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+    if (parallel_compression)
+      io_async_writer_write_chunks(e->snapshot_async_writer, h_data, h_space,
+                                   &compressed, props.name);
+    else
+#endif
+      io_async_writer_write_dataset(e->snapshot_async_writer, h_data, h_space,
+                                    io_hdf5_type(props.type), temp,
+                                    num_elements * typeSize, props.name);
+    H5Tclose(h_type);
+    H5Pclose(h_prop);
+    return;
+  }
+
   /* Free and close everything */
-  swift_free("writebuff", temp);
+  if (temp != NULL) swift_free("writebuff", temp);
   H5Tclose(h_type);
   H5Pclose(h_prop);
   H5Dclose(h_data);
@@ -472,6 +1057,17 @@ void read_ic_single(
   h_file = H5Fopen(fileName, H5F_ACC_RDONLY, H5P_DEFAULT);
   if (h_file < 0) error("Error while opening file '%s'.", fileName);
 
+  /* Map it as well, to read what we can directly into the particles */
+  struct io_ic_map map;
+  if (!dry_run)
+    io_ic_map_init(&map, fileName);
+  else
+    bzero(&map, sizeof(struct io_ic_map));
+
+  /* Let's initialise a bit of thread parallelism here */
+  struct threadpool tp;
+  if (!dry_run) threadpool_init(&tp, n_threads);
+
   /* Open header to read simulation properties */
   /* message("Reading file header..."); */
   h_grp = H5Gopen(h_file, "/Header", H5P_DEFAULT);
@@ -738,7 +1334,7 @@ void read_ic_single(
 
         /* Read array. */
         read_array_single(h_grp, list[i], Nparticles, internal_units, ic_units,
-                          cleanup_h, cleanup_sqrt_a, h, a);
+                          cleanup_h, cleanup_sqrt_a, h, a, &map, &tp);
       }
 
     /* Close particle group */
@@ -751,10 +1347,6 @@ void read_ic_single(
   /* Duplicate the parts for gravity */
   if (!dry_run && with_gravity) {
 
-    /* Let's initialise a bit of thread parallelism here */
-    struct threadpool tp;
-    threadpool_init(&tp, n_threads);
-
     /* Prepare the DM particles */
     io_prepare_dm_gparts(&tp, *gparts, Ndm);
 
@@ -786,13 +1378,15 @@ void read_ic_single(
       io_duplicate_black_holes_gparts(
           &tp, *bparts, *gparts, *Nblackholes,
           Ndm + Ndm_background + Ndm_neutrino + *Ngas + *Nsinks + *Nstars);
-
-    threadpool_clean(&tp);
   }
 
   /* message("Done Reading particles..."); */
 
   /* Clean up */
+  if (!dry_run) {
+    threadpool_clean(&tp);
+    io_ic_map_clean(&map);
+  }
   free(ic_units);
 
   /* Close file */
@@ -856,6 +1450,10 @@ void write_output_single(struct engine* e,
   const size_t Nsinks = e->s->nr_sinks;
   const size_t Nblackholes = e->s->nr_bparts;
 
+  /* Time spent in each stage of the writing of the particle arrays */
+  struct io_write_stats stats;
+  bzero(&stats, sizeof(struct io_write_stats));
+
   /* Determine if we are writing a reduced snapshot, and if so which
    * output selection type to use */
   char current_selection_name[FIELD_BUFFER_SIZE] =
@@ -1455,7 +2053,7 @@ void write_output_single(struct engine* e,
       if (compression_level != compression_do_not_write) {
         write_array_single(e, h_grp, fileName, xmfFile, partTypeGroupName,
                            list[i], N, compression_level, internal_units,
-                           snapshot_units);
+                           snapshot_units, &stats);
         num_fields_written++;
       }
     }
@@ -1485,9 +2083,14 @@ void write_output_single(struct engine* e,
 
   /* message("Done writing particles..."); */
 
-  /* Close file */
+  /* Close file. If datasets are still being written in the background, the
+   * library keeps it open until the last one is closed. */
   H5Fclose(h_file);
   H5Pclose(h_props);
+  if (e->snapshot_async_writer != NULL)
+    io_async_writer_end_file(e->snapshot_async_writer, fileName);
+
+  if (e->verbose) io_write_stats_print(&stats, fileName);
 
   e->snapshot_output_count++;
   if (e->snapshot_invoke_stf) e->stf_output_count++;
@@ -25,6 +25,12 @@
 
 /* Local includes. */
 #include "inline.h"
+#include "minmax.h"
+
+/* Standard headers. */
+#include <float.h>
+#include <stdint.h>
+#include <string.h>
 
 /**
  * @brief Entry in a list of sorted indices.
@@ -300,4 +306,233 @@ INLINE static double sort_get_cell_min_dist(const int sid,
          pos[2] * runner_shift[sid][2];
 }
 
+/*! Number of entries below which the radix sort hands over to an insertion
+ * sort */
+#define sort_radix_min_count 32
+
+/*! Maximal number of entries within the rms displacement of the particles
+ * since the last sort (i.e. count * dx_rms / cell size) for which the
+ * previous order is repaired rather than sorted again from scratch */
+#define sort_repair_max_displaced_entries 2.f
+
+/*! Average number of entries a repair may move per entry before handing over
+ * to a full sort */
+#define sort_repair_max_moves_per_entry 2
+
+/*! Number of bits of the key processed per radix pass */
+#define sort_radix_bits 8
+
+/*! Number of buckets per radix pass */
+#define sort_radix_buckets (1 << sort_radix_bits)
+
+/*! Number of radix passes over the 32 bits of the key */
+#define sort_radix_passes (32 / sort_radix_bits)
+
+/**
+ * @brief Maps a float onto an unsigned integer with the same ordering.
+ *
+ * The sign bit is flipped for positive numbers and all the bits are flipped
+ * for negative ones.
+ *
+ * @param d The float to map.
+ */
+__attribute__((always_inline, const)) INLINE static uint32_t sort_radix_key(
+    const float d) {
+
+  union {
+    float f;
+    uint32_t u;
+  } key;
+  key.f = d;
+  const uint32_t mask = (uint32_t)(-(int32_t)(key.u >> 31)) | 0x80000000u;
+  return key.u ^ mask;
+}
+
+/**
+ * @brief Sort the entries in ascending order using an insertion sort.
+ *
+ * Only efficient for very small or nearly-sorted arrays.
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ */
+__attribute__((always_inline)) INLINE static void sort_insertion_ascending(
+    struct sort_entry *sort, const int N) {
+
+  for (int i = 1; i < N; i++) {
+    const struct sort_entry temp = sort[i];
+    int j = i - 1;
+    while (j >= 0 && sort[j].d > temp.d) {
+      sort[j + 1] = sort[j];
+      j--;
+    }
+    sort[j + 1] = temp;
+  }
+}
+
+/**
+ * @brief Repair the order of entries that were sorted before their distances
+ * changed slightly, using an insertion sort that gives up after a given
+ * amount of work.
+ *
+ * Entries already in order with their predecessor (i.e. the sorted runs) are
+ * skipped at the cost of a single comparison. The others are moved back to
+ * their position. If the total number of moves exceeds the budget, the
+ * entries are left in an arbitrary order and the function returns 0.
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ * @param max_moves The maximal number of entries moved.
+ *
+ * @return 1 if the entries are sorted, 0 if we gave up.
+ */
+__attribute__((always_inline)) INLINE static int sort_repair_ascending(
+    struct sort_entry *sort, const int N, const int max_moves) {
+
+  int moves = 0;
+  for (int i = 1; i < N; i++) {
+
+    /* Still part of a sorted run? */
+    if (sort[i].d >= sort[i - 1].d) continue;
+
+    const struct sort_entry temp = sort[i];
+    int j = i - 1;
+    while (j >= 0 && sort[j].d > temp.d) {
+      sort[j + 1] = sort[j];
+      j--;
+    }
+    sort[j + 1] = temp;
+
+    moves += i - 1 - j;
+    if (moves > max_moves) return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Sort the entries in ascending order using a least-significant-digit
+ * radix sort on the bits of the distances.
+ *
+ * The histograms of all the digits are built in a single pass over the keys.
+ * Passes over digits that are identical for all the entries (e.g. the
+ * exponent of particles in a small cell) are skipped.
+ *
+ * @param sort The entries.
+ * @param buff A buffer of at least N entries.
+ * @param N The number of entries.
+ */
+__attribute__((always_inline)) INLINE static void sort_radix_ascending(
+    struct sort_entry *restrict sort, struct sort_entry *restrict buff,
+    const int N) {
+
+  if (N < sort_radix_min_count) {
+    sort_insertion_ascending(sort, N);
+    return;
+  }
+
+  /* Histograms of all the digits */
+  int hist[sort_radix_passes][sort_radix_buckets];
+  memset(hist, 0, sizeof(hist));
+  for (int k = 0; k < N; k++) {
+    const uint32_t key = sort_radix_key(sort[k].d);
+    for (int p = 0; p < sort_radix_passes; p++)
+      hist[p][(key >> (p * sort_radix_bits)) & (sort_radix_buckets - 1)]++;
+  }
+
+  struct sort_entry *restrict in = sort;
+  struct sort_entry *restrict out = buff;
+
+  for (int p = 0; p < sort_radix_passes; p++) {
+
+    const int shift = p * sort_radix_bits;
+    int *restrict h = hist[p];
+
+    /* All the entries share this digit? */
+    if (h[(sort_radix_key(in[0].d) >> shift) & (sort_radix_buckets - 1)] == N)
+      continue;
+
+    /* Offsets of the buckets */
+    int sum = 0;
+    for (int b = 0; b < sort_radix_buckets; b++) {
+      const int temp = h[b];
+      h[b] = sum;
+      sum += temp;
+    }
+
+    /* Scatter (stable) */
+    for (int k = 0; k < N; k++) {
+      const int b = (sort_radix_key(in[k].d) >> shift) & (sort_radix_buckets - 1);
+      out[h[b]++] = in[k];
+    }
+
+    struct sort_entry *restrict temp = in;
+    in = out;
+    out = temp;
+  }
+
+  /* Did we end up in the buffer? */
+  if (in != sort) memcpy(sort, in, N * sizeof(struct sort_entry));
+}
+
+/**
+ * @brief Merge up to 8 sorted lists of entries into one using a loser tree.
+ *
+ * Each list must be terminated by a sentinel entry with d = FLT_MAX. Empty
+ * lists can be pointed at a sentinel directly. The internal nodes of the tree
+ * store the loser of each match, and its key, such that replaying the path
+ * from the winning list to the root only requires 3 branch-free comparisons
+ * per entry.
+ *
+ * @param out The array to write the merged list to.
+ * @param fingers The 8 lists to merge (modified).
+ * @param off The offset to add to the indices of the entries of each list.
+ * @param count The total number of entries to merge.
+ */
+__attribute__((always_inline)) INLINE static void sort_merge_loser_tree(
+    struct sort_entry *restrict out, const struct sort_entry *fingers[8],
+    const int off[8], const int count) {
+
+  /* Play the initial tournament, storing the losers (and their keys) in the
+   * internal nodes */
+  float win_key[16], loser_key[8];
+  int win[16], loser[8];
+  for (int k = 0; k < 8; k++) {
+    win[8 + k] = k;
+    win_key[8 + k] = fingers[k]->d;
+  }
+  for (int n = 7; n > 0; n--) {
+    const int b_wins = win_key[2 * n + 1] < win_key[2 * n];
+    win[n] = b_wins ? win[2 * n + 1] : win[2 * n];
+    win_key[n] = b_wins ? win_key[2 * n + 1] : win_key[2 * n];
+    loser[n] = b_wins ? win[2 * n] : win[2 * n + 1];
+    loser_key[n] = b_wins ? win_key[2 * n] : win_key[2 * n + 1];
+  }
+  int winner = win[1];
+
+  for (int ind = 0; ind < count; ind++) {
+
+    /* Copy the minimum into the new sort array. */
+    const struct sort_entry *restrict finger = fingers[winner];
+    out[ind].d = finger->d;
+    out[ind].i = finger->i + off[winner];
+
+    /* Advance that list */
+    fingers[winner] = finger + 1;
+    float key = finger[1].d;
+
+    /* Replay its path to the root. The path only depends on the list we
+     * advanced, so the loads of the nodes do not wait on the comparisons.
+     * The swaps are done with masks to avoid (unpredictable) branches. */
+    for (int n = (winner + 8) >> 1; n > 0; n >>= 1) {
+      const float node_key = loser_key[n];
+      const int swap_mask = -(node_key < key);
+      const int swap = (winner ^ loser[n]) & swap_mask;
+      loser_key[n] = max(node_key, key);
+      key = min(node_key, key);
+      loser[n] ^= swap;
+      winner ^= swap;
+    }
+  }
+}
+
 #endif /* SWIFT_SORT_PART_H */
@@ -89,6 +89,10 @@ int space_extra_gparts = space_extra_gparts_default;
 /*! Number of extra #sink we allocate memory for per top-level cell */
 int space_extra_sinks = space_extra_sinks_default;
 
+/*! Space-filling curve along which the particles of the leaves are ordered
+ * (a #space_sfc_ordering_type) */
+int space_sfc_ordering = space_sfc_ordering_default;
+
 /*! Maximum number of particles per ghost */
 int engine_max_parts_per_ghost = engine_max_parts_per_ghost_default;
 int engine_max_sparts_per_ghost = engine_max_sparts_per_ghost_default;
@@ -1262,6 +1266,13 @@ void space_init(struct space *s, struct swift_params *params,
       params, "Scheduler:cell_extra_bparts", space_extra_bparts_default);
   space_extra_sinks = parser_get_opt_param_int(
       params, "Scheduler:cell_extra_sinks", space_extra_sinks_default);
+  space_sfc_ordering = parser_get_opt_param_int(
+      params, "Scheduler:cell_sfc_ordering", space_sfc_ordering_default);
+  if (space_sfc_ordering < space_sfc_ordering_none ||
+      space_sfc_ordering > space_sfc_ordering_hilbert)
+    error("Invalid Scheduler:cell_sfc_ordering %d (0: none, 1: Morton, 2: "
+          "Hilbert)",
+          space_sfc_ordering);
 
   engine_max_parts_per_ghost =
       parser_get_opt_param_int(params, "Scheduler:engine_max_parts_per_ghost",
@@ -2426,6 +2437,7 @@ void space_clean(struct space *s) {
   swift_free("cells_with_particles_top", s->cells_with_particles_top);
   swift_free("local_cells_with_particles_top",
              s->local_cells_with_particles_top);
+  swift_free("hydro_candidates", s->hydro_candidates);
   swift_free("parts", s->parts);
   swift_free("xparts", s->xparts);
   swift_free("gparts", s->gparts);
@@ -2489,6 +2501,8 @@ void space_struct_dump(struct space *s, FILE *stream) {
                        "space_extra_sparts", "space_extra_sparts");
   restart_write_blocks(&space_extra_bparts, sizeof(int), 1, stream,
                        "space_extra_bparts", "space_extra_bparts");
+  restart_write_blocks(&space_sfc_ordering, sizeof(int), 1, stream,
+                       "space_sfc_ordering", "space_sfc_ordering");
   restart_write_blocks(&space_expected_max_nr_strays, sizeof(int), 1, stream,
                        "space_expected_max_nr_strays",
                        "space_expected_max_nr_strays");
@@ -2576,6 +2590,8 @@ void space_struct_restore(struct space *s, FILE *stream) {
                       "space_extra_sparts");
   restart_read_blocks(&space_extra_bparts, sizeof(int), 1, stream, NULL,
                       "space_extra_bparts");
+  restart_read_blocks(&space_sfc_ordering, sizeof(int), 1, stream, NULL,
+                      "space_sfc_ordering");
   restart_read_blocks(&space_expected_max_nr_strays, sizeof(int), 1, stream,
                       NULL, "space_expected_max_nr_strays");
   restart_read_blocks(&engine_max_parts_per_ghost, sizeof(int), 1, stream, NULL,
@@ -2600,6 +2616,9 @@ void space_struct_restore(struct space *s, FILE *stream) {
   s->local_cells_with_tasks_top = NULL;
   s->cells_with_particles_top = NULL;
   s->local_cells_with_particles_top = NULL;
+  s->hydro_candidates = NULL;
+  s->nr_hydro_candidates = 0;
+  s->size_hydro_candidates = 0;
   s->nr_local_cells_with_tasks = 0;
   s->nr_cells_with_particles = 0;
 #ifdef WITH_MPI
@@ -39,6 +39,7 @@
 
 /* Avoid cyclic inclusions */
 struct cell;
+struct cell_hydro_candidates;
 struct cosmology;
 struct gravity_props;
 struct star_formation;
@@ -63,9 +64,20 @@ struct hydro_props;
 #define space_subsize_self_grav_default 32000
 #define space_subdepth_diff_grav_default 4
 #define space_max_top_level_cells_default 12
+#define space_sfc_ordering_default space_sfc_ordering_none
 #define space_stretch 1.10f
 #define space_maxreldx 0.1f
 
+/**
+ * @brief The space-filling curves along which the particles of the leaf
+ * cells can be ordered at rebuild time.
+ */
+enum space_sfc_ordering_type {
+  space_sfc_ordering_none,
+  space_sfc_ordering_morton,
+  space_sfc_ordering_hilbert
+};
+
 /* Maximum allowed depth of cell splits. */
 #define space_cell_maxdepth 52
 
@@ -86,6 +98,7 @@ extern int space_extra_gparts;
 extern int space_extra_sparts;
 extern int space_extra_bparts;
 extern int space_extra_sinks;
+extern int space_sfc_ordering;
 extern double engine_redistribute_alloc_margin;
 extern double engine_foreign_alloc_margin;
 
@@ -181,6 +194,15 @@ struct space {
   /*! The indices of the top-level cells that have >0 particles (of any kind) */
   int *local_cells_with_particles_top;
 
+  /*! The time-step limiter and sync candidates of the local leaf cells */
+  struct cell_hydro_candidates *hydro_candidates;
+
+  /*! Number of lists in hydro_candidates in use */
+  int nr_hydro_candidates;
+
+  /*! Number of lists allocated in hydro_candidates */
+  int size_hydro_candidates;
+
   /*! The total number of #part in the space. */
   size_t nr_parts;
 
@@ -106,6 +106,10 @@ void space_rebuild_recycle_mapper(void *map_data, int num_elements,
     c->black_holes.dx_max_part = 0.f;
     c->hydro.sorted = 0;
     c->hydro.sort_allocated = 0;
+    c->hydro.sort_reusable = 0;
+    c->hydro.nlists = NULL;
+    c->hydro.nlist_epoch = 0;
+    c->hydro.nlist_invalid_epoch = 0;
     c->stars.sorted = 0;
     c->hydro.count = 0;
     c->hydro.count_total = 0;
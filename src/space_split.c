@@ -22,6 +22,9 @@
 /* Config parameters. */
 #include <config.h>
 
+/* Some standard headers. */
+#include <float.h>
+
 /* This object's header. */
 #include "space.h"
 
@@ -68,6 +71,8 @@ void space_split_recursive(struct space *s, struct cell *c,
   int maxdepth = 0;
   float h_max = 0.0f;
   float h_max_active = 0.0f;
+  double bbox_min[3] = {DBL_MAX, DBL_MAX, DBL_MAX};
+  double bbox_max[3] = {-DBL_MAX, -DBL_MAX, -DBL_MAX};
   float stars_h_max = 0.f;
   float stars_h_max_active = 0.f;
   float black_holes_h_max = 0.f;
@@ -300,6 +305,15 @@ void space_split_recursive(struct space *s, struct cell *c,
         /* Update the cell-wide properties */
         h_max = max(h_max, cp->hydro.h_max);
         h_max_active = max(h_max_active, cp->hydro.h_max_active);
+        if (cp->hydro.count > 0) {
+          double cp_min[3], cp_max[3];
+          cell_bbox_load(cp, cp->hydro.bbox_min_rebuild,
+                         cp->hydro.bbox_max_rebuild, cp_min, cp_max);
+          for (int i = 0; i < 3; i++) {
+            bbox_min[i] = min(bbox_min[i], cp_min[i]);
+            bbox_max[i] = max(bbox_max[i], cp_max[i]);
+          }
+        }
         stars_h_max = max(stars_h_max, cp->stars.h_max);
         stars_h_max_active = max(stars_h_max_active, cp->stars.h_max_active);
         black_holes_h_max = max(black_holes_h_max, cp->black_holes.h_max);
@@ -465,6 +479,13 @@ void space_split_recursive(struct space *s, struct cell *c,
     ti_rt_beg_max = 0;
     ti_rt_min_step_size = max_nr_timesteps;
 
+    /* Order the particles along a space-filling curve? */
+    if (space_sfc_ordering != space_sfc_ordering_none) {
+      cell_sfc_order_leaf(c, parts - s->parts, sparts - s->sparts,
+                          bparts - s->bparts, sinks - s->sinks,
+                          (enum space_sfc_ordering_type)space_sfc_ordering);
+    }
+
     /* parts: Get dt_min/dt_max and h_max. */
     for (int k = 0; k < count; k++) {
 #ifdef SWIFT_DEBUG_CHECKS
@@ -504,6 +525,11 @@ void space_split_recursive(struct space *s, struct cell *c,
       if (part_is_active(&parts[k], e))
         h_max_active = max(h_max_active, parts[k].h);
 
+      for (int i = 0; i < 3; i++) {
+        bbox_min[i] = min(bbox_min[i], parts[k].x[i]);
+        bbox_max[i] = max(bbox_max[i], parts[k].x[i]);
+      }
+
       /* Collect SFR from the particles after rebuilt */
       star_formation_logger_log_inactive_part(&parts[k], &xparts[k],
                                               &c->stars.sfh);
@@ -653,6 +679,12 @@ void space_split_recursive(struct space *s, struct cell *c,
   /* Set the values for this cell. */
   c->hydro.h_max = h_max;
   c->hydro.h_max_active = h_max_active;
+  cell_bbox_store(c, bbox_min, bbox_max, c->hydro.bbox_min_rebuild,
+                  c->hydro.bbox_max_rebuild);
+  for (int i = 0; i < 3; i++) {
+    c->hydro.bbox_min[i] = c->hydro.bbox_min_rebuild[i];
+    c->hydro.bbox_max[i] = c->hydro.bbox_max_rebuild[i];
+  }
   c->hydro.ti_end_min = ti_hydro_end_min;
   c->hydro.ti_beg_max = ti_hydro_beg_max;
   c->rt.ti_rt_end_min = ti_rt_end_min;
@@ -745,6 +777,158 @@ void space_split_mapper(void *map_data, int num_cells, void *extra_data) {
     atomic_max_f(&s->max_mpole_power[n], max_mpole_power[n]);
 }
 
+/**
+ * @brief Count the leaves holding #part below a cell.
+ *
+ * @param c The #cell.
+ */
+static int space_count_hydro_leaves(const struct cell *c) {
+
+  if (!c->split) return c->hydro.count_total > 0;
+
+  int count = 0;
+  for (int k = 0; k < 8; k++)
+    if (c->progeny[k] != NULL) count += space_count_hydro_leaves(c->progeny[k]);
+  return count;
+}
+
+/**
+ * @brief Give an empty list of time-step limiter and sync candidates to each
+ * leaf holding #part below a cell, and none to the other cells.
+ *
+ * @param c The #cell.
+ * @param next The next unused list.
+ *
+ * @return The next unused list once the tree is done.
+ */
+static struct cell_hydro_candidates *space_assign_hydro_candidates(
+    struct cell *c, struct cell_hydro_candidates *next) {
+
+  c->hydro.candidates = NULL;
+
+  if (c->split) {
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        next = space_assign_hydro_candidates(c->progeny[k], next);
+  } else if (c->hydro.count_total > 0) {
+    c->hydro.candidates = next;
+    next->limiter_count = 0;
+    next->sync_count = 0;
+    next++;
+  }
+
+  return next;
+}
+
+/*! Data passed to the mappers handing out the candidate lists */
+struct space_hydro_candidates_data {
+
+  /*! The #space */
+  struct space *s;
+
+  /*! Index of the first list of each top-level cell with particles */
+  int *offsets;
+};
+
+/**
+ * @brief #threadpool mapper function to count the leaves holding #part in
+ * each top-level cell.
+ *
+ * @param map_data Pointer towards the top-cells.
+ * @param num_cells The number of cells to treat.
+ * @param extra_data Pointer to a #space_hydro_candidates_data.
+ */
+static void space_count_hydro_leaves_mapper(void *map_data, int num_cells,
+                                            void *extra_data) {
+
+  struct space_hydro_candidates_data *data =
+      (struct space_hydro_candidates_data *)extra_data;
+  struct space *s = data->s;
+  int *local_cells_with_particles = (int *)map_data;
+  const ptrdiff_t first =
+      local_cells_with_particles - s->local_cells_with_particles_top;
+
+  for (int ind = 0; ind < num_cells; ind++) {
+    const struct cell *c = &s->cells_top[local_cells_with_particles[ind]];
+    data->offsets[first + ind + 1] = space_count_hydro_leaves(c);
+  }
+}
+
+/**
+ * @brief #threadpool mapper function to hand out the candidate lists to the
+ * leaves of each top-level cell.
+ *
+ * @param map_data Pointer towards the top-cells.
+ * @param num_cells The number of cells to treat.
+ * @param extra_data Pointer to a #space_hydro_candidates_data.
+ */
+static void space_assign_hydro_candidates_mapper(void *map_data, int num_cells,
+                                                 void *extra_data) {
+
+  struct space_hydro_candidates_data *data =
+      (struct space_hydro_candidates_data *)extra_data;
+  struct space *s = data->s;
+  int *local_cells_with_particles = (int *)map_data;
+  const ptrdiff_t first =
+      local_cells_with_particles - s->local_cells_with_particles_top;
+
+  for (int ind = 0; ind < num_cells; ind++) {
+    struct cell *c = &s->cells_top[local_cells_with_particles[ind]];
+    space_assign_hydro_candidates(
+        c, s->hydro_candidates + data->offsets[first + ind]);
+  }
+}
+
+/**
+ * @brief Give the local leaves holding #part their lists of time-step limiter
+ * and sync candidates.
+ *
+ * The lists are kept in an array of the #space rather than in the cells, as
+ * only a fraction of the cells need one.
+ *
+ * @param s The #space.
+ */
+static void space_split_hydro_candidates(struct space *s) {
+
+  /* Start from a clean slate, including the top-level cells that are now
+   * foreign or empty. */
+  for (int k = 0; k < s->nr_cells; k++) s->cells_top[k].hydro.candidates = NULL;
+  s->nr_hydro_candidates = 0;
+  if (!s->with_hydro) return;
+
+  const int nr_top = s->nr_local_cells_with_particles;
+  struct space_hydro_candidates_data data;
+  data.s = s;
+  data.offsets = (int *)malloc((nr_top + 1) * sizeof(int));
+  if (data.offsets == NULL) error("Failed to allocate the candidate offsets.");
+
+  /* Count the leaves of each top-level cell... */
+  data.offsets[0] = 0;
+  threadpool_map(&s->e->threadpool, space_count_hydro_leaves_mapper,
+                 s->local_cells_with_particles_top, nr_top, sizeof(int),
+                 threadpool_auto_chunk_size, &data);
+  for (int k = 0; k < nr_top; k++) data.offsets[k + 1] += data.offsets[k];
+  s->nr_hydro_candidates = data.offsets[nr_top];
+
+  /* ...make room for their lists... */
+  if (s->nr_hydro_candidates > s->size_hydro_candidates) {
+    swift_free("hydro_candidates", s->hydro_candidates);
+    s->size_hydro_candidates = s->nr_hydro_candidates;
+    s->hydro_candidates = (struct cell_hydro_candidates *)swift_malloc(
+        "hydro_candidates",
+        s->size_hydro_candidates * sizeof(struct cell_hydro_candidates));
+    if (s->hydro_candidates == NULL)
+      error("Failed to allocate the limiter and sync candidates.");
+  }
+
+  /* ...and hand them out. */
+  threadpool_map(&s->e->threadpool, space_assign_hydro_candidates_mapper,
+                 s->local_cells_with_particles_top, nr_top, sizeof(int),
+                 threadpool_auto_chunk_size, &data);
+
+  free(data.offsets);
+}
+
 /**
  * @brief Split particles between cells of a hierarchy.
  *
@@ -767,6 +951,8 @@ void space_split(struct space *s, int verbose) {
                  s->nr_local_cells_with_particles, sizeof(int),
                  threadpool_auto_chunk_size, s);
 
+  space_split_hydro_candidates(s);
+
   if (verbose)
     message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
             clocks_getunit());
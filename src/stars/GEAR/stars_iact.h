@@ -19,6 +19,10 @@
 #ifndef SWIFT_GEAR_STARS_IACT_H
 #define SWIFT_GEAR_STARS_IACT_H
 
+/* Local headers. */
+#include "kernel_hydro.h"
+#include "vector.h"
+
 /**
  * @brief Density interaction between two particles (non-symmetric).
  *
@@ -91,4 +95,84 @@ runner_iact_nonsym_stars_feedback(const float r2, const float *dx,
 #endif
 }
 
+#if defined(WITH_VECTORIZATION) && !defined(DEBUG_INTERACTIONS_STARS)
+
+/* The density interactions only need the distances to the gas, so that they
+ * can be done a vector of neighbours at a time. */
+#define STARS_VEC_DENSITY
+
+/**
+ * @brief The inverse smoothing length of a star broadcast over the lanes of
+ * a vector and the per-lane sums of its lane-parallel density interactions.
+ */
+struct runner_iact_vec_data_stars_density {
+
+  /*! Inverse smoothing length of si. */
+  vector hi_inv;
+
+  /*! Sums of the neighbour number and its derivative. */
+  vector wcount, wcount_dh;
+};
+
+/**
+ * @brief Prepare the lane-parallel density interactions of a star.
+ *
+ * @param d The #runner_iact_vec_data_stars_density to fill.
+ * @param hi Comoving smoothing-length of the star.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_init_stars_density(
+    struct runner_iact_vec_data_stars_density *d, const float hi) {
+
+  d->hi_inv = vector_set1(1.f / hi);
+  d->wcount = vector_setzero();
+  d->wcount_dh = vector_setzero();
+}
+
+/**
+ * @brief Density interaction between a star and a vector of gas neighbours
+ * (non-symmetric lane-parallel version).
+ *
+ * Lane k adds the same kernel weights as #runner_iact_nonsym_stars_density
+ * does for the neighbour at distance sqrt(r2[k]). Only the lanes set in the
+ * mask are added to the sums.
+ *
+ * @param d The #runner_iact_vec_data_stars_density of si.
+ * @param r2 Comoving square distances between si and the neighbours.
+ * @param mask The lanes to interact with.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_stars_density(
+    struct runner_iact_vec_data_stars_density *d, const vector r2,
+    const mask_t mask) {
+
+  /* Compute the kernel function */
+  vector ui, wi, wi_dx;
+  ui.v = vec_mul(vec_sqrt(r2.v), d->hi_inv.v);
+  kernel_deval_1_vec(&ui, &wi, &wi_dx);
+
+  /* Compute contribution to the number of neighbours */
+  d->wcount.v = vec_mask_add(d->wcount.v, wi.v, mask);
+  d->wcount_dh.v = vec_mask_sub(
+      d->wcount_dh.v,
+      vec_fma(vec_set1(hydro_dimension), wi.v, vec_mul(ui.v, wi_dx.v)), mask);
+}
+
+/**
+ * @brief Add the sums of the lane-parallel density interactions of a star
+ * to its fields.
+ *
+ * @param d The #runner_iact_vec_data_stars_density of si.
+ * @param si The star.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_vec_reduce_stars_density(
+    struct runner_iact_vec_data_stars_density *d, struct spart *restrict si) {
+
+  VEC_HADD(d->wcount, si->density.wcount);
+  VEC_HADD(d->wcount_dh, si->density.wcount_dh);
+}
+
+#endif /* WITH_VECTORIZATION && !DEBUG_INTERACTIONS_STARS */
+
 #endif /* SWIFT_GEAR_STARS_IACT_H */
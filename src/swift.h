@@ -53,14 +53,18 @@
 #include "gravity_properties.h"
 #include "hashmap.h"
 #include "hydro.h"
+#include "hydro_nlist.h"
 #include "hydro_properties.h"
 #include "ic_info.h"
 #include "lightcone/lightcone_array.h"
 #include "line_of_sight.h"
 #include "lock.h"
+#include "mac_cache.h"
 #include "map.h"
 #include "memuse.h"
+#include "mesh_assignment.h"
 #include "mesh_gravity.h"
+#include "mesh_gravity_pencil.h"
 #include "minmax.h"
 #include "mpiuse.h"
 #include "multipole.h"
@@ -986,7 +986,7 @@ int main(int argc, char *argv[]) {
 #endif
 
     /* Now read it. */
-    restart_read(&e, restart_file);
+    restart_read(&e, restart_file, nr_threads);
 
 #ifdef WITH_MPI
     integertime_t min_ti_current = e.ti_current;
@@ -570,6 +570,7 @@ int main(int argc, char *argv[]) {
   hp.eta_neighbours = h;
   hp.h_tolerance = 1e0;
   hp.h_max = FLT_MAX;
+  hp.use_neighbour_lists = 0;
   hp.h_min = 0.f;
   hp.h_min_ratio = 0.f;
   hp.max_smoothing_iterations = 10;
@@ -595,6 +596,10 @@ int main(int argc, char *argv[]) {
 
   struct runner runner;
   runner.e = &engine;
+  runner.ci_hot_cache.count = 0;
+  runner.cj_hot_cache.count = 0;
+  hydro_hot_cache_init(&runner.ci_hot_cache, 512);
+  hydro_hot_cache_init(&runner.cj_hot_cache, 512);
 
   struct lightcone_array_props lightcone_array_properties;
   lightcone_array_properties.nr_lightcones = 0;
@@ -972,6 +977,8 @@ int main(int argc, char *argv[]) {
   cache_clean(&runner.ci_cache);
   cache_clean(&runner.cj_cache);
 #endif
+  hydro_hot_cache_clean(&runner.ci_hot_cache);
+  hydro_hot_cache_clean(&runner.cj_hot_cache);
 
   return 0;
 }
@@ -408,6 +408,10 @@ int main(int argc, char *argv[]) {
 
   struct runner runner;
   runner.e = &engine;
+  runner.ci_hot_cache.count = 0;
+  runner.cj_hot_cache.count = 0;
+  hydro_hot_cache_init(&runner.ci_hot_cache, 512);
+  hydro_hot_cache_init(&runner.cj_hot_cache, 512);
 
   struct lightcone_array_props lightcone_array_properties;
   lightcone_array_properties.nr_lightcones = 0;
@@ -558,6 +562,8 @@ int main(int argc, char *argv[]) {
 
   /* Clean things to make the sanitizer happy ... */
   for (int i = 0; i < 27; ++i) clean_up(cells[i]);
+  hydro_hot_cache_clean(&runner.ci_hot_cache);
+  hydro_hot_cache_clean(&runner.cj_hot_cache);
 
   return 0;
 }
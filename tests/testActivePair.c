@@ -660,6 +660,10 @@ int main(int argc, char *argv[]) {
   }
 
   runner->e = &engine;
+  runner->ci_hot_cache.count = 0;
+  runner->cj_hot_cache.count = 0;
+  hydro_hot_cache_init(&runner->ci_hot_cache, 512);
+  hydro_hot_cache_init(&runner->cj_hot_cache, 512);
 
   /* Create output file names. */
   sprintf(swiftOutputFileName, "swift_dopair_%.150s.dat",
@@ -756,6 +760,8 @@ int main(int argc, char *argv[]) {
   cache_clean(&runner->ci_cache);
   cache_clean(&runner->cj_cache);
 #endif
+  hydro_hot_cache_clean(&runner->ci_hot_cache);
+  hydro_hot_cache_clean(&runner->cj_hot_cache);
   free(runner);
   return 0;
 }
@@ -0,0 +1,370 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#if defined(HAVE_HDF5) && !defined(WITH_MPI)
+
+#include <hdf5.h>
+
+/* Number of gas particles to write */
+#define num_parts 100000
+
+/* Size of the background writer's staging area, small enough for the
+ * snapshot to go through the back-pressure. */
+#define async_max_bytes (1024 * 1024)
+
+/**
+ * @brief Fill the gas particles with random values.
+ */
+static void make_parts(struct part *parts, struct xpart *xparts,
+                       const size_t N, const double dim[3]) {
+
+  bzero(parts, N * sizeof(struct part));
+  bzero(xparts, N * sizeof(struct xpart));
+  for (size_t i = 0; i < N; i++) {
+    struct part *p = &parts[i];
+    for (int d = 0; d < 3; d++) {
+      p->x[d] = random_uniform(0., dim[d]);
+      p->v[d] = random_uniform(-1., 1.);
+      xparts[i].v_full[d] = p->v[d];
+    }
+    p->id = i + 1;
+    p->h = random_uniform(0.01, 0.02);
+    hydro_set_mass(p, 1.f);
+    hydro_set_init_internal_energy(p, random_uniform(1., 2.));
+    p->time_bin = 0;
+  }
+}
+
+/**
+ * @brief Compare the content of an attribute in two files.
+ */
+static void compare_attribute(hid_t h_obj, hid_t h_obj_ref, const char *name,
+                              const char *path) {
+
+  /* The date is the only meta-data allowed to change between two dumps */
+  if (strcmp(name, "SnapshotDate") == 0) return;
+
+  if (H5Aexists(h_obj_ref, name) <= 0)
+    error("Attribute '%s' of '%s' is missing in one of the files.", name,
+          path);
+
+  const hid_t h_attr = H5Aopen(h_obj, name, H5P_DEFAULT);
+  const hid_t h_attr_ref = H5Aopen(h_obj_ref, name, H5P_DEFAULT);
+  const hid_t h_type = H5Aget_type(h_attr);
+  const hid_t h_type_ref = H5Aget_type(h_attr_ref);
+  if (H5Tequal(h_type, h_type_ref) <= 0)
+    error("Attribute '%s' of '%s' has a different type.", name, path);
+
+  const hid_t h_space = H5Aget_space(h_attr);
+  const size_t size =
+      H5Sget_simple_extent_npoints(h_space) * H5Tget_size(h_type);
+  char *data = (char *)calloc(size + 1, 1);
+  char *data_ref = (char *)calloc(size + 1, 1);
+  if (data == NULL || data_ref == NULL)
+    error("Failed to allocate attribute buffers.");
+  if (H5Aread(h_attr, h_type, data) < 0 ||
+      H5Aread(h_attr_ref, h_type, data_ref) < 0)
+    error("Failed to read attribute '%s' of '%s'.", name, path);
+  if (memcmp(data, data_ref, size) != 0)
+    error("Attribute '%s' of '%s' differs.", name, path);
+
+  free(data);
+  free(data_ref);
+  H5Sclose(h_space);
+  H5Tclose(h_type);
+  H5Tclose(h_type_ref);
+  H5Aclose(h_attr);
+  H5Aclose(h_attr_ref);
+}
+
+/*! The two files being compared and the statistics of the comparison. */
+struct compare_data {
+  hid_t h_file, h_file_ref;
+  hid_t h_obj_ref;
+  const char *path;
+  int nr_datasets, nr_attributes;
+};
+
+/**
+ * @brief Compare an attribute with its counterpart in the reference file.
+ *
+ * Called by H5Aiterate2() for all the attributes of an object.
+ */
+static herr_t compare_attribute_op(hid_t h_obj, const char *name,
+                                   const H5A_info_t *info, void *op_data) {
+
+  struct compare_data *data = (struct compare_data *)op_data;
+  compare_attribute(h_obj, data->h_obj_ref, name, data->path);
+  data->nr_attributes++;
+  return 0;
+}
+
+/**
+ * @brief Compare an object, its attributes and its children with their
+ * counterparts in the reference file.
+ *
+ * Called by H5Literate() for all the links of a group.
+ */
+static herr_t compare_object(hid_t h_group, const char *name,
+                             const H5L_info_t *info, void *op_data) {
+
+  struct compare_data *data = (struct compare_data *)op_data;
+
+  /* Full path of the object */
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/%s", data->path, name);
+
+  if (H5Lexists(data->h_file_ref, path, H5P_DEFAULT) <= 0)
+    error("Object '%s' is missing in one of the files.", path);
+
+  const hid_t h_obj = H5Oopen(data->h_file, path, H5P_DEFAULT);
+  const hid_t h_obj_ref = H5Oopen(data->h_file_ref, path, H5P_DEFAULT);
+
+  /* The attributes, such that all those of the object are in the reference.
+   * The other direction is checked when swapping the files. */
+  struct compare_data attr_data = *data;
+  attr_data.h_obj_ref = h_obj_ref;
+  attr_data.path = path;
+  H5Aiterate2(h_obj, H5_INDEX_NAME, H5_ITER_INC, NULL, compare_attribute_op,
+              &attr_data);
+  data->nr_attributes = attr_data.nr_attributes;
+
+  if (H5Iget_type(h_obj) == H5I_GROUP) {
+
+    /* Recurse */
+    struct compare_data child_data = *data;
+    child_data.path = path;
+    H5Literate(h_obj, H5_INDEX_NAME, H5_ITER_INC, NULL, compare_object,
+               &child_data);
+    data->nr_datasets = child_data.nr_datasets;
+    data->nr_attributes = child_data.nr_attributes;
+
+  } else if (H5Iget_type(h_obj) == H5I_DATASET) {
+
+    const hid_t h_type = H5Dget_type(h_obj);
+    const hid_t h_type_ref = H5Dget_type(h_obj_ref);
+    if (H5Tequal(h_type, h_type_ref) <= 0)
+      error("Dataset '%s' has a different type.", path);
+
+    const hid_t h_space = H5Dget_space(h_obj);
+    const hid_t h_space_ref = H5Dget_space(h_obj_ref);
+    if (H5Sextent_equal(h_space, h_space_ref) <= 0)
+      error("Dataset '%s' has a different shape.", path);
+
+    const size_t size =
+        H5Sget_simple_extent_npoints(h_space) * H5Tget_size(h_type);
+    char *buf = (char *)malloc(size + 1);
+    char *buf_ref = (char *)malloc(size + 1);
+    if (buf == NULL || buf_ref == NULL)
+      error("Failed to allocate dataset buffers.");
+    if (H5Dread(h_obj, h_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf) < 0 ||
+        H5Dread(h_obj_ref, h_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, buf_ref) < 0)
+      error("Failed to read dataset '%s'.", path);
+    if (memcmp(buf, buf_ref, size) != 0) error("Dataset '%s' differs.", path);
+    data->nr_datasets++;
+
+    free(buf);
+    free(buf_ref);
+    H5Sclose(h_space);
+    H5Sclose(h_space_ref);
+    H5Tclose(h_type);
+    H5Tclose(h_type_ref);
+  }
+
+  H5Oclose(h_obj);
+  H5Oclose(h_obj_ref);
+  return 0;
+}
+
+/**
+ * @brief Check that two snapshots hold the same datasets and attributes.
+ */
+static void compare_files(const char *fileName, const char *fileName_ref) {
+
+  struct compare_data data;
+  data.h_file = H5Fopen(fileName, H5F_ACC_RDONLY, H5P_DEFAULT);
+  data.h_file_ref = H5Fopen(fileName_ref, H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (data.h_file < 0 || data.h_file_ref < 0)
+    error("Failed to open the snapshots to compare.");
+  data.path = "";
+  data.nr_datasets = 0;
+  data.nr_attributes = 0;
+
+  /* Everything in the asynchronous file is in the synchronous one... */
+  H5Literate(data.h_file, H5_INDEX_NAME, H5_ITER_INC, NULL, compare_object,
+             &data);
+  const int nr_datasets = data.nr_datasets;
+  const int nr_attributes = data.nr_attributes;
+
+  /* ... and the other way round. */
+  const hid_t h_tmp = data.h_file;
+  data.h_file = data.h_file_ref;
+  data.h_file_ref = h_tmp;
+  data.nr_datasets = 0;
+  data.nr_attributes = 0;
+  H5Literate(data.h_file, H5_INDEX_NAME, H5_ITER_INC, NULL, compare_object,
+             &data);
+
+  if (nr_datasets == 0) error("No dataset found in '%s'.", fileName);
+  if (data.nr_datasets != nr_datasets || data.nr_attributes != nr_attributes)
+    error("The files do not hold the same number of objects.");
+  message("'%s' matches '%s': %d datasets and %d attributes.", fileName,
+          fileName_ref, nr_datasets, nr_attributes);
+
+  H5Fclose(data.h_file);
+  H5Fclose(data.h_file_ref);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  if (!io_async_writer_is_supported()) {
+    message("The HDF5 library is not thread-safe, nothing to test.");
+    return 0;
+  }
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  struct swift_params params;
+  parser_init("", &params);
+  parser_set_param(&params, "SPH:resolution_eta:1.2348");
+  parser_set_param(&params, "SPH:CFL_condition:0.1");
+
+  struct output_options output_options;
+  output_options_init(&params, 0, &output_options);
+
+  struct unit_system us;
+  units_init_cgs(&us);
+  struct phys_const prog_const;
+  phys_const_init(&us, &params, &prog_const);
+  struct cosmology cosmo;
+  cosmology_init_no_cosmo(&cosmo);
+  struct hydro_props hydro_properties;
+  hydro_props_init(&hydro_properties, &prog_const, &us, &params);
+  struct cooling_function_data cooling;
+  bzero(&cooling, sizeof(struct cooling_function_data));
+  struct ic_info ics_metadata;
+  ic_info_init(&ics_metadata, &params);
+
+  /* A box of gas only */
+  const double dim[3] = {1., 1., 1.};
+  struct part *parts = NULL;
+  struct xpart *xparts = NULL;
+  if (posix_memalign((void **)&parts, part_align,
+                     num_parts * sizeof(struct part)) != 0 ||
+      posix_memalign((void **)&xparts, xpart_align,
+                     num_parts * sizeof(struct xpart)) != 0)
+    error("Failed to allocate the particles.");
+  make_parts(parts, xparts, num_parts, dim);
+
+  struct space s;
+  bzero(&s, sizeof(struct space));
+  s.periodic = 1;
+  for (int d = 0; d < 3; d++) s.dim[d] = dim[d];
+  s.parts = parts;
+  s.xparts = xparts;
+  s.nr_parts = num_parts;
+
+  struct engine e;
+  bzero(&e, sizeof(struct engine));
+  e.s = &s;
+  e.cooling_func = &cooling;
+  e.parameter_file = &params;
+  e.output_options = &output_options;
+  e.cosmology = &cosmo;
+  e.physical_constants = &prog_const;
+  e.hydro_properties = &hydro_properties;
+  e.ics_metadata = &ics_metadata;
+  e.internal_units = &us;
+  e.snapshot_units = &us;
+  e.policy = engine_policy_hydro;
+  e.verbose = 0;
+  threadpool_init(&e.threadpool, 1);
+  sprintf(e.run_name, "Asynchronous snapshot test");
+  sprintf(e.snapshot_subdir, ".");
+
+  io_prepare_output_fields(&output_options, /*with_cosmology=*/0,
+                           /*with_fof=*/0, /*with_structure_finding=*/0,
+                           /*verbose=*/0);
+
+  struct io_async_writer writer;
+  io_async_writer_init(&writer, async_max_bytes, /*verbose=*/0);
+
+  /* Without compression, and with the compression done either by HDF5 or
+   * by us (depending on the build) */
+  const int levels[2] = {0, 4};
+  for (int k = 0; k < 2; k++) {
+    e.snapshot_compression = levels[k];
+
+    /* Write the same snapshot synchronously... */
+    sprintf(e.snapshot_base_name, "testAsyncSnapshot_sync");
+    e.snapshot_output_count = 0;
+    e.snapshot_async_writer = NULL;
+    write_output_single(&e, &us, &us, /*fof=*/0);
+
+    /* ... and in the background. */
+    sprintf(e.snapshot_base_name, "testAsyncSnapshot_async");
+    e.snapshot_output_count = 0;
+    e.snapshot_async_writer = &writer;
+    write_output_single(&e, &us, &us, /*fof=*/0);
+    io_async_writer_wait(&writer);
+
+    message("Compression level %d:", levels[k]);
+    compare_files("./testAsyncSnapshot_async_0000.hdf5",
+                  "./testAsyncSnapshot_sync_0000.hdf5");
+  }
+
+  remove("./testAsyncSnapshot_sync_0000.hdf5");
+  remove("./testAsyncSnapshot_async_0000.hdf5");
+  remove("./testAsyncSnapshot_sync.xmf");
+  remove("./testAsyncSnapshot_async.xmf");
+
+  io_async_writer_clean(&writer);
+  threadpool_clean(&e.threadpool);
+  output_options_clean(&output_options);
+  cosmology_clean(&cosmo);
+  free(parts);
+  free(xparts);
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+  message("Snapshots are not written from a single rank in this build.");
+  return 0;
+}
+
+#endif /* HAVE_HDF5 && !WITH_MPI */
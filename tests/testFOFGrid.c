@@ -0,0 +1,237 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "fof_union_find.h"
+#include "swift.h"
+
+#ifdef WITH_FOF
+
+/* Size of the periodic box, made of 3 cells of size 1 along x */
+#define box_size_x 3.
+
+/* Number of particles in each of the two cells */
+#define num_parts 3000
+
+/* Linking length */
+#define linking_length 0.04
+
+/* Leaf searches of fof.c, which are not part of its public interface. */
+void fof_search_self_cell(const struct fof_props *props, const double l_x2,
+                          const struct gpart *const space_gparts,
+                          const struct cell *c);
+void fof_search_pair_cells(const struct fof_props *props, const double dim[3],
+                           const double l_x2, const int periodic,
+                           const struct gpart *const space_gparts,
+                           const struct cell *restrict ci,
+                           const struct cell *restrict cj);
+
+/* The particle types linked, attached and ignored by fof.c */
+extern int current_fof_linking_type;
+extern int current_fof_attach_type;
+extern int current_fof_ignore_type;
+
+/**
+ * @brief Fill a cell with clumps of particles (some of which cannot link)
+ * on top of a uniform background.
+ */
+static void make_cell(struct cell *c, struct gpart *gparts, const double x0) {
+
+  bzero(c, sizeof(struct cell));
+  c->loc[0] = x0;
+  c->width[0] = c->width[1] = c->width[2] = 1.;
+  c->grav.parts = gparts;
+  c->grav.count = num_parts;
+
+  double centres[8][3];
+  for (int k = 0; k < 8; k++)
+    for (int d = 0; d < 3; d++) centres[k][d] = random_uniform(0.05, 0.95);
+
+  /* Put some clumps against the boundaries of the cell */
+  centres[0][0] = 0.01;
+  centres[1][0] = 0.99;
+
+  for (int i = 0; i < num_parts; i++) {
+    struct gpart *gp = &gparts[i];
+    bzero(gp, sizeof(struct gpart));
+    if (i % 3 == 0) {
+      for (int d = 0; d < 3; d++) gp->x[d] = random_uniform(0., 1.);
+    } else {
+      const int k = rand() % 8;
+      for (int d = 0; d < 3; d++) {
+        const double y = centres[k][d] + random_uniform(-0.05, 0.05);
+        gp->x[d] = y < 0. ? 0. : (y > 0.999999 ? 0.999999 : y);
+      }
+    }
+    gp->x[0] += x0;
+    gp->type = (i % 7 == 0) ? swift_type_gas : swift_type_dark_matter;
+    gp->time_bin = (i % 101 == 0) ? time_bin_inhibited : 0;
+  }
+}
+
+/**
+ * @brief Can a particle link to others?
+ */
+static int links(const struct gpart *gp) {
+  return gp->time_bin < time_bin_inhibited &&
+         (current_fof_linking_type & (1 << (gp->type + 1)));
+}
+
+/**
+ * @brief Reference: link all the pairs of particles of two arrays closer
+ * than the linking length, with the same single-precision distance as
+ * fof.c.
+ */
+static void link_brute_force(const struct gpart *gparts_i, const size_t first_i,
+                             const struct gpart *gparts_j, const size_t first_j,
+                             const int same, const double shift,
+                             size_t *group_index) {
+
+  const double l_x2 = linking_length * linking_length;
+  for (int i = 0; i < num_parts; i++) {
+    if (!links(&gparts_i[i])) continue;
+    for (int j = same ? i + 1 : 0; j < num_parts; j++) {
+      if (!links(&gparts_j[j])) continue;
+      float dx[3], r2 = 0.0f;
+      dx[0] = (gparts_i[i].x[0] - shift) - gparts_j[j].x[0];
+      dx[1] = gparts_i[i].x[1] - gparts_j[j].x[1];
+      dx[2] = gparts_i[i].x[2] - gparts_j[j].x[2];
+      for (int k = 0; k < 3; k++) r2 += dx[k] * dx[k];
+      if (r2 < l_x2) {
+        size_t root_i = fof_find(first_i + i, group_index);
+        const size_t root_j = fof_find(first_j + j, group_index);
+        if (root_i != root_j) fof_union(&root_i, root_j, group_index);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Check that two sets of group indices describe the same groups.
+ */
+static void compare_groups(size_t *group_index, size_t *reference,
+                           const size_t N, const char *what) {
+
+  /* Label each group by its first particle in both sets */
+  size_t *first = (size_t *)malloc(N * sizeof(size_t));
+  size_t *first_ref = (size_t *)malloc(N * sizeof(size_t));
+  if (first == NULL || first_ref == NULL) error("Failed to allocate labels.");
+  for (size_t n = 0; n < N; n++) first[n] = first_ref[n] = N;
+
+  size_t num_groups = 0;
+  for (size_t n = 0; n < N; n++) {
+    const size_t root = fof_find(n, group_index);
+    const size_t root_ref = fof_find(n, reference);
+    if (first[root] == N) first[root] = n;
+    if (first_ref[root_ref] == N) {
+      first_ref[root_ref] = n;
+      num_groups++;
+    }
+    if (first[root] != first_ref[root_ref])
+      error("%s: particle %zu is not in the same group as in the reference.",
+            what, n);
+  }
+  message("%s: %zu groups match the brute-force search.", what, num_groups);
+
+  free(first);
+  free(first_ref);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  /* Link the dark matter only, attach the gas */
+  current_fof_linking_type = (1 << (swift_type_dark_matter + 1));
+  current_fof_attach_type = (1 << (swift_type_gas + 1));
+  current_fof_ignore_type =
+      ~(current_fof_linking_type | current_fof_attach_type);
+
+  /* Two cells at opposite ends of a periodic box, such that their pair
+   * search goes through the periodic wrapping. */
+  const size_t N = 2 * num_parts;
+  struct gpart *gparts = NULL;
+  if (posix_memalign((void **)&gparts, gpart_align,
+                     N * sizeof(struct gpart)) != 0)
+    error("Failed to allocate the particles.");
+  struct cell ci, cj;
+  make_cell(&ci, gparts, 0.);
+  make_cell(&cj, gparts + num_parts, 2.);
+
+  size_t *group_index = (size_t *)malloc(N * sizeof(size_t));
+  size_t *reference = (size_t *)malloc(N * sizeof(size_t));
+  if (group_index == NULL || reference == NULL)
+    error("Failed to allocate the group indices.");
+  for (size_t n = 0; n < N; n++) group_index[n] = reference[n] = n;
+
+  struct fof_props props;
+  bzero(&props, sizeof(struct fof_props));
+  props.group_index = group_index;
+
+  const double dim[3] = {box_size_x, 1., 1.};
+  const double l_x2 = linking_length * linking_length;
+
+  /* Self searches, large enough to go through the grid */
+  fof_search_self_cell(&props, l_x2, gparts, &ci);
+  fof_search_self_cell(&props, l_x2, gparts, &cj);
+  link_brute_force(ci.grav.parts, 0, ci.grav.parts, 0, 1, 0., reference);
+  link_brute_force(cj.grav.parts, num_parts, cj.grav.parts, num_parts, 1, 0.,
+                   reference);
+  compare_groups(group_index, reference, N, "self");
+
+  /* Pair search across the periodic boundary */
+  fof_search_pair_cells(&props, dim, l_x2, /*periodic=*/1, gparts, &ci, &cj);
+  link_brute_force(ci.grav.parts, 0, cj.grav.parts, num_parts, 0, -box_size_x,
+                   reference);
+  compare_groups(group_index, reference, N, "self+pair");
+
+  free(group_index);
+  free(reference);
+  free(gparts);
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+  message("FOF is not available in this build.");
+  return 0;
+}
+
+#endif /* WITH_FOF */
@@ -0,0 +1,315 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "fof_union_find.h"
+#include "swift.h"
+
+#ifdef WITH_FOF
+
+/* Number of top-level cells along each axis of the unit periodic box */
+#define cdim_top 4
+
+/* Number of particles */
+#define num_parts 20000
+
+/* Linking length */
+#define linking_length 0.01
+
+/* Displacement, in units of the linking length, below which links are kept */
+#define tolerance_ratio 0.1
+
+/* Number of incremental calls */
+#define num_steps 4
+
+/* The particle types linked, attached and ignored by fof.c */
+extern int current_fof_linking_type;
+extern int current_fof_attach_type;
+extern int current_fof_ignore_type;
+
+/**
+ * @brief Sort the particles into the top-level cells, in a random order
+ * within each cell such that they never keep their index between calls.
+ */
+static void make_cells(struct space *s, struct gpart *scratch) {
+
+  const size_t N = s->nr_gparts;
+  const int num_cells = cdim_top * cdim_top * cdim_top;
+
+  /* Shuffle the particles */
+  memcpy(scratch, s->gparts, N * sizeof(struct gpart));
+  for (size_t i = N - 1; i > 0; i--) {
+    const size_t j = rand() % (i + 1);
+    const struct gpart temp = scratch[i];
+    scratch[i] = scratch[j];
+    scratch[j] = temp;
+  }
+
+  /* Count the particles of each cell... */
+  int *cell_id = (int *)malloc(N * sizeof(int));
+  int count[cdim_top * cdim_top * cdim_top + 1];
+  if (cell_id == NULL) error("Failed to allocate the cell indices.");
+  bzero(count, sizeof(count));
+  for (size_t i = 0; i < N; i++) {
+    int ind[3];
+    for (int k = 0; k < 3; k++)
+      ind[k] = min((int)(scratch[i].x[k] * cdim_top), cdim_top - 1);
+    cell_id[i] = cell_getid(s->cdim, ind[0], ind[1], ind[2]);
+    count[cell_id[i] + 1]++;
+  }
+  for (int c = 0; c < num_cells; c++) count[c + 1] += count[c];
+
+  /* ...and put them in place. */
+  for (int c = 0; c < num_cells; c++) {
+    struct cell *cell = &s->cells_top[c];
+    cell->grav.parts = s->gparts + count[c];
+    cell->grav.count = count[c + 1] - count[c];
+  }
+  for (size_t i = 0; i < N; i++) s->gparts[count[cell_id[i]]++] = scratch[i];
+
+  free(cell_id);
+}
+
+/**
+ * @brief Start with every particle in its own group, as fof_allocate() does.
+ */
+static void reset_groups(const struct fof_props *props, struct space *s) {
+  for (size_t n = 0; n < s->nr_gparts; n++) props->group_index[n] = n;
+}
+
+/**
+ * @brief Link all the particles closer than the linking length, by the
+ * self and pair searches of all the top-level cells.
+ */
+static void run_search(const struct fof_props *props, struct space *s) {
+
+  for (int cid = 0; cid < s->nr_cells; cid++) {
+    struct cell *ci = &s->cells_top[cid];
+    rec_fof_search_self(props, s->dim, props->l_x2, s->periodic, s->gparts,
+                        ci);
+
+    const int i = cid / (cdim_top * cdim_top);
+    const int j = (cid / cdim_top) % cdim_top;
+    const int k = cid % cdim_top;
+    for (int ii = -1; ii < 2; ii++)
+      for (int jj = -1; jj < 2; jj++)
+        for (int kk = -1; kk < 2; kk++) {
+          const int cjd = cell_getid(s->cdim, (i + ii + cdim_top) % cdim_top,
+                                     (j + jj + cdim_top) % cdim_top,
+                                     (k + kk + cdim_top) % cdim_top);
+          if (cid >= cjd) continue;
+          rec_fof_search_pair(props, s->dim, props->l_x2, s->periodic,
+                              s->gparts, ci, &s->cells_top[cjd]);
+        }
+  }
+}
+
+/**
+ * @brief Check that two sets of group indices describe the same groups.
+ */
+static void compare_groups(size_t *group_index, size_t *reference,
+                           const size_t N, const int step) {
+
+  /* Label each group by its first particle in both sets */
+  size_t *first = (size_t *)malloc(N * sizeof(size_t));
+  size_t *first_ref = (size_t *)malloc(N * sizeof(size_t));
+  if (first == NULL || first_ref == NULL) error("Failed to allocate labels.");
+  for (size_t n = 0; n < N; n++) first[n] = first_ref[n] = N;
+
+  size_t num_groups = 0;
+  for (size_t n = 0; n < N; n++) {
+    const size_t root = fof_find(n, group_index);
+    const size_t root_ref = fof_find(n, reference);
+    if (first[root] == N) first[root] = n;
+    if (first_ref[root_ref] == N) {
+      first_ref[root_ref] = n;
+      num_groups++;
+    }
+    if (first[root] != first_ref[root_ref])
+      error("Step %d: particle %zu is not in the same group as in the full "
+            "search.",
+            step, n);
+  }
+  message("Step %d: %zu groups match the full search.", step, num_groups);
+
+  free(first);
+  free(first_ref);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  /* Link the dark matter only */
+  current_fof_linking_type = (1 << (swift_type_dark_matter + 1));
+  current_fof_attach_type = 0;
+  current_fof_ignore_type = ~current_fof_linking_type;
+
+  /* A unit periodic box of top-level cells */
+  static struct engine e;
+  static struct space s;
+  bzero(&e, sizeof(struct engine));
+  bzero(&s, sizeof(struct space));
+  e.s = &s;
+  s.e = &e;
+  threadpool_init(&e.threadpool, 1);
+  s.periodic = 1;
+  for (int k = 0; k < 3; k++) {
+    s.dim[k] = 1.;
+    s.cdim[k] = cdim_top;
+  }
+  s.nr_cells = cdim_top * cdim_top * cdim_top;
+  s.nr_local_cells = s.nr_cells;
+  s.cells_top = (struct cell *)calloc(s.nr_cells, sizeof(struct cell));
+  s.local_cells_top = (int *)malloc(s.nr_cells * sizeof(int));
+  if (s.cells_top == NULL || s.local_cells_top == NULL)
+    error("Failed to allocate the cells.");
+  for (int c = 0; c < s.nr_cells; c++) {
+    struct cell *cell = &s.cells_top[c];
+    cell->loc[0] = (c / (cdim_top * cdim_top)) * (1. / cdim_top);
+    cell->loc[1] = ((c / cdim_top) % cdim_top) * (1. / cdim_top);
+    cell->loc[2] = (c % cdim_top) * (1. / cdim_top);
+    cell->width[0] = cell->width[1] = cell->width[2] = 1. / cdim_top;
+    s.local_cells_top[c] = c;
+  }
+
+  /* Clumps of particles on top of a uniform background */
+  const size_t N = num_parts;
+  struct gpart *scratch = NULL;
+  if (posix_memalign((void **)&s.gparts, gpart_align,
+                     N * sizeof(struct gpart)) != 0 ||
+      posix_memalign((void **)&scratch, gpart_align,
+                     N * sizeof(struct gpart)) != 0)
+    error("Failed to allocate the particles.");
+  s.nr_gparts = N;
+
+  double centres[32][3];
+  for (int c = 0; c < 32; c++)
+    for (int k = 0; k < 3; k++) centres[c][k] = random_uniform(0., 1.);
+
+  for (size_t i = 0; i < N; i++) {
+    struct gpart *gp = &s.gparts[i];
+    bzero(gp, sizeof(struct gpart));
+    const int c = rand() % 32;
+    for (int k = 0; k < 3; k++) {
+      const double x = (i % 4 == 0) ? random_uniform(0., 1.)
+                                    : centres[c][k] + random_uniform(-.03, .03);
+      gp->x[k] = box_wrap(x, 0., 1.);
+    }
+    gp->id_or_neg_offset = i + 1;
+    gp->type = swift_type_dark_matter;
+    gp->time_bin = (i % 101 == 0) ? time_bin_inhibited : 0;
+  }
+  make_cells(&s, scratch);
+
+  /* The incremental FOF and the full search used as the reference */
+  size_t *group_index = (size_t *)malloc(N * sizeof(size_t));
+  size_t *reference = (size_t *)malloc(N * sizeof(size_t));
+  if (group_index == NULL || reference == NULL)
+    error("Failed to allocate the group indices.");
+
+  struct fof_props props, props_ref;
+  bzero(&props, sizeof(struct fof_props));
+  props.l_x2 = linking_length * linking_length;
+  props.incremental_tolerance_ratio = tolerance_ratio;
+  props_ref = props;
+  props_ref.incremental_tolerance_ratio = 0.;
+  props.group_index = group_index;
+  props_ref.group_index = reference;
+  e.fof_properties = &props;
+
+  /* The first call is always a full search */
+  reset_groups(&props, &s);
+  fof_prepare_incremental(&props, &s, /*allow_incremental=*/1);
+  if (props.incremental_search) error("The first search is incremental!");
+  run_search(&props, &s);
+  fof_store_incremental_labels(&props, &s);
+
+  int num_incremental = 0;
+  for (int step = 1; step <= num_steps; step++) {
+
+    /* Move all the particles a bit, with one slab strongly perturbed... */
+    const double l = linking_length;
+    for (size_t i = 0; i < N; i++) {
+      struct gpart *gp = &s.gparts[i];
+      const double amplitude = (gp->x[0] < 0.125) ? 0.3 * l : 0.01 * l;
+      for (int k = 0; k < 3; k++)
+        gp->x[k] = box_wrap(gp->x[k] + random_uniform(-amplitude, amplitude),
+                            0., 1.);
+    }
+
+    /* ...and one particle disappearing or re-appearing. */
+    struct gpart *gp = &s.gparts[rand() % N];
+    gp->time_bin =
+        (gp->time_bin == time_bin_inhibited) ? 0 : time_bin_inhibited;
+    make_cells(&s, scratch);
+
+    reset_groups(&props, &s);
+    fof_prepare_incremental(&props, &s, /*allow_incremental=*/1);
+    num_incremental += props.incremental_search;
+    run_search(&props, &s);
+    fof_store_incremental_labels(&props, &s);
+
+    reset_groups(&props_ref, &s);
+    run_search(&props_ref, &s);
+    compare_groups(group_index, reference, N, step);
+  }
+
+  if (num_incremental == 0) error("No search was incremental!");
+  message("%d of %d searches were incremental.", num_incremental, num_steps);
+
+  swift_free("fof_incremental_records", props.incremental_records);
+  free(group_index);
+  free(reference);
+  free(scratch);
+  free(s.gparts);
+  free(s.cells_top);
+  free(s.local_cells_top);
+  threadpool_clean(&e.threadpool);
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+  message("FOF is not available in this build.");
+  return 0;
+}
+
+#endif /* WITH_FOF */
@@ -0,0 +1,341 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Local headers. */
+#include "fof_union_find.h"
+#include "swift.h"
+
+/* Linking length in units of the mean inter-particle separation */
+#define linking_length_ratio 0.2
+
+/* Number of particles of the small (test10000.hdf5-like) and large sets */
+#define num_parts_small 10000
+#define num_parts_large 200000
+
+/**
+ * @brief A pair of particles within the linking length of each other.
+ */
+struct fof_link {
+  size_t i, j;
+};
+
+/**
+ * @brief Data passed to the linking and flattening mappers.
+ */
+struct link_data {
+  size_t *group_index;
+  struct fof_link *links;
+};
+
+/**
+ * @brief Place particles uniformly at random in the unit box.
+ */
+void make_uniform(double *x, const size_t N) {
+  for (size_t k = 0; k < 3 * N; k++) x[k] = random_uniform(0., 1.);
+}
+
+/**
+ * @brief Place particles in a set of Gaussian clumps of random sizes on top of
+ * a uniform background, in the unit box.
+ */
+void make_clustered(double *x, const size_t N) {
+
+  const int num_clumps = 64;
+  double centres[64][4];
+  for (int c = 0; c < num_clumps; c++) {
+    for (int k = 0; k < 3; k++) centres[c][k] = random_uniform(0., 1.);
+    centres[c][3] = random_uniform(0.005, 0.03);
+  }
+
+  for (size_t n = 0; n < N; n++) {
+
+    /* 20% of background particles */
+    if (random_uniform(0., 1.) < 0.2) {
+      for (int k = 0; k < 3; k++) x[3 * n + k] = random_uniform(0., 1.);
+      continue;
+    }
+
+    const int c = rand() % num_clumps;
+    for (int k = 0; k < 3; k++) {
+      const double u1 = random_uniform(1e-12, 1.);
+      const double u2 = random_uniform(0., 1.);
+      const double g = sqrt(-2. * log(u1)) * cos(2. * M_PI * u2);
+      x[3 * n + k] = fmod(centres[c][k] + centres[c][3] * g + 10., 1.);
+    }
+  }
+}
+
+/**
+ * @brief Find all the pairs of particles closer than the linking length in a
+ * periodic unit box using a grid of cells.
+ *
+ * @param x The positions.
+ * @param N The number of particles.
+ * @param l The linking length.
+ * @param num_links (return) The number of pairs found.
+ */
+struct fof_link *find_links(const double *x, const size_t N, const double l,
+                        size_t *num_links) {
+
+  const int cdim = (int)(1. / l) < 256 ? (int)(1. / l) : 256;
+  const int num_cells = cdim * cdim * cdim;
+
+  /* Bin the particles in the cells */
+  int *cell_of = (int *)malloc(N * sizeof(int));
+  size_t *cell_start = (size_t *)calloc(num_cells + 1, sizeof(size_t));
+  size_t *sorted = (size_t *)malloc(N * sizeof(size_t));
+  if (cell_of == NULL || cell_start == NULL || sorted == NULL)
+    error("Failed to allocate the grid.");
+  for (size_t n = 0; n < N; n++) {
+    int ind[3];
+    for (int k = 0; k < 3; k++) {
+      ind[k] = (int)(x[3 * n + k] * cdim);
+      if (ind[k] >= cdim) ind[k] = cdim - 1;
+    }
+    cell_of[n] = (ind[0] * cdim + ind[1]) * cdim + ind[2];
+    cell_start[cell_of[n] + 1]++;
+  }
+  for (int c = 0; c < num_cells; c++) cell_start[c + 1] += cell_start[c];
+  size_t *fill = (size_t *)malloc(num_cells * sizeof(size_t));
+  if (fill == NULL) error("Failed to allocate the grid.");
+  memcpy(fill, cell_start, num_cells * sizeof(size_t));
+  for (size_t n = 0; n < N; n++) sorted[fill[cell_of[n]]++] = n;
+  free(fill);
+
+  size_t size = 4 * N, count = 0;
+  struct fof_link *links = (struct fof_link *)malloc(size * sizeof(struct fof_link));
+  if (links == NULL) error("Failed to allocate the links.");
+
+  const double l2 = l * l;
+  for (int ci = 0; ci < cdim; ci++) {
+    for (int cj = 0; cj < cdim; cj++) {
+      for (int ck = 0; ck < cdim; ck++) {
+        const int c = (ci * cdim + cj) * cdim + ck;
+
+        /* Visit each pair of neighbouring cells once */
+        for (int di = -1; di <= 1; di++) {
+          for (int dj = -1; dj <= 1; dj++) {
+            for (int dk = -1; dk <= 1; dk++) {
+              const int d = ((ci + di + cdim) % cdim * cdim +
+                             (cj + dj + cdim) % cdim) *
+                                cdim +
+                            (ck + dk + cdim) % cdim;
+              if (d < c) continue;
+
+              for (size_t a = cell_start[c]; a < cell_start[c + 1]; a++) {
+                const size_t i = sorted[a];
+                const size_t b_start = (d == c) ? a + 1 : cell_start[d];
+                for (size_t b = b_start; b < cell_start[d + 1]; b++) {
+                  const size_t j = sorted[b];
+                  double r2 = 0.;
+                  for (int k = 0; k < 3; k++) {
+                    double dx = x[3 * i + k] - x[3 * j + k];
+                    dx = nearest(dx, 1.);
+                    r2 += dx * dx;
+                  }
+                  if (r2 < l2) {
+                    if (count == size) {
+                      size *= 2;
+                      links = (struct fof_link *)realloc(
+                          links, size * sizeof(struct fof_link));
+                      if (links == NULL) error("Failed to grow the links.");
+                    }
+                    links[count].i = i;
+                    links[count].j = j;
+                    count++;
+                  }
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  free(cell_of);
+  free(cell_start);
+  free(sorted);
+  *num_links = count;
+  return links;
+}
+
+/**
+ * @brief Serial reference: the smallest index of the group of each particle.
+ */
+void find_groups_serial(const struct fof_link *links, const size_t num_links,
+                        const size_t N, size_t *min_index) {
+
+  for (size_t n = 0; n < N; n++) min_index[n] = n;
+  for (size_t l = 0; l < num_links; l++) {
+    size_t a = links[l].i, b = links[l].j;
+    while (min_index[a] != a) a = min_index[a] = min_index[min_index[a]];
+    while (min_index[b] != b) b = min_index[b] = min_index[min_index[b]];
+    if (a < b)
+      min_index[b] = a;
+    else if (b < a)
+      min_index[a] = b;
+  }
+  for (size_t n = 0; n < N; n++) {
+    size_t a = n;
+    while (min_index[a] != a) a = min_index[a];
+    min_index[n] = a;
+  }
+}
+
+/**
+ * @brief Link the particles of a chunk of the list of links the way
+ * fof_search_pair_cells() does.
+ */
+void link_mapper(void *map_data, int num_elements, void *extra_data) {
+
+  struct link_data *data = (struct link_data *)extra_data;
+  size_t *group_index = data->group_index;
+  const struct fof_link *links = (const struct fof_link *)map_data;
+
+  for (int k = 0; k < num_elements; k++) {
+    size_t root_i = fof_find(links[k].i, group_index);
+    const size_t root_j = fof_find(links[k].j, group_index);
+    if (root_i != root_j) fof_union(&root_i, root_j, group_index);
+  }
+}
+
+/**
+ * @brief Point a chunk of particles directly at their root.
+ */
+void flatten_mapper(void *map_data, int num_elements, void *extra_data) {
+
+  struct link_data *data = (struct link_data *)extra_data;
+  size_t *group_index = data->group_index;
+  const size_t offset = (size_t *)map_data - group_index;
+
+  for (int k = 0; k < num_elements; k++)
+    group_index[offset + k] = fof_find(offset + k, group_index);
+}
+
+/**
+ * @brief Time the linking of a set of particles with increasing numbers of
+ * threads and check the groups against the serial reference.
+ */
+void time_linking(const char *name, const double *x, const size_t N,
+                  const int max_threads, const int runs) {
+
+  const double l = linking_length_ratio / cbrt((double)N);
+  size_t num_links = 0;
+  struct fof_link *links = find_links(x, N, l, &num_links);
+
+  size_t *reference = (size_t *)malloc(N * sizeof(size_t));
+  size_t *group_index = (size_t *)malloc(N * sizeof(size_t));
+  if (reference == NULL || group_index == NULL)
+    error("Failed to allocate the group indices.");
+  find_groups_serial(links, num_links, N, reference);
+
+  size_t num_groups = 0;
+  for (size_t n = 0; n < N; n++) num_groups += (reference[n] == n);
+
+  message("%s: N=%zu, %zu links, %zu groups.", name, N, num_links,
+          num_groups);
+  message("%8s | %14s | %21s | %13s", "threads", "link time [ms]",
+          "links/s/thread [1e6]", "flatten [ms]");
+
+  struct link_data data = {group_index, links};
+
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+
+    struct threadpool tp;
+    threadpool_init(&tp, num_threads);
+
+    double time_link = 0., time_flatten = 0.;
+    for (int r = 0; r < runs; r++) {
+      for (size_t n = 0; n < N; n++) group_index[n] = n;
+
+      ticks tic = getticks();
+      threadpool_map(&tp, link_mapper, links, num_links, sizeof(struct fof_link),
+                     threadpool_auto_chunk_size, &data);
+      time_link += clocks_from_ticks(getticks() - tic);
+
+      tic = getticks();
+      threadpool_map(&tp, flatten_mapper, group_index, N, sizeof(size_t),
+                     threadpool_auto_chunk_size, &data);
+      time_flatten += clocks_from_ticks(getticks() - tic);
+
+      /* Links always go to the smallest index of a group */
+      for (size_t n = 0; n < N; n++)
+        if (group_index[n] != reference[n])
+          error("%s: particle %zu in group %zu instead of %zu (%d threads).",
+                name, n, group_index[n], reference[n], num_threads);
+    }
+
+    message("%8d | %14.3f | %21.2f | %13.3f", num_threads, time_link / runs,
+            1e-3 * num_links * runs / time_link / num_threads,
+            time_flatten / runs);
+
+    threadpool_clean(&tp);
+  }
+
+  free(links);
+  free(reference);
+  free(group_index);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  /* Number of threads to go up to */
+  int max_threads = 4;
+  if (argc > 1) max_threads = atoi(argv[1]);
+  if (max_threads < 1) error("Invalid number of threads.");
+
+  double *x = (double *)malloc(3 * num_parts_large * sizeof(double));
+  if (x == NULL) error("Failed to allocate the positions.");
+
+  make_uniform(x, num_parts_small);
+  time_linking("uniform", x, num_parts_small, max_threads, 20);
+
+  make_clustered(x, num_parts_small);
+  time_linking("clustered", x, num_parts_small, max_threads, 20);
+
+  make_clustered(x, num_parts_large);
+  time_linking("clustered", x, num_parts_large, max_threads, 3);
+
+  free(x);
+  return 0;
+}
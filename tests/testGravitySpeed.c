@@ -32,6 +32,7 @@
 const int num_M2L_runs = 1 << 23;
 const int num_M2P_runs = 1 << 23;
 const int num_PP_runs = 1;  // << 8;
+const int num_self_PP_runs = 1 << 8;
 
 void make_cell(struct cell *c, int N, const double loc[3], double width,
                int id_base, const struct gravity_props *grav_props) {
@@ -324,6 +325,35 @@ int main(int argc, char *argv[]) {
   // gravity_field_tensors_print(&ci.grav.multipole->pot);
   // gravity_field_tensors_print(&cj.grav.multipole->pot);
 
+  /* Self-interactions of a full leaf cell with a varying fraction of active
+   * particles, to compare the symmetric and non-symmetric P-P kernels */
+  struct cell c_self;
+  const double loc_self[3] = {2., 2., 2.};
+  grav_props.epsilon_DM_cur = 0.01;
+  grav_props.epsilon_baryon_cur = 0.01;
+  make_cell(&c_self, space_splitsize, loc_self, 1., 2 * num_particles,
+            &grav_props);
+  c_self.grav.ti_end_min = e.ti_current;
+  e.max_active_bin = 1;
+  const int active_percent[4] = {100, 60, 40, 25};
+  for (int k = 0; k < 4; ++k) {
+
+    for (int i = 0; i < c_self.grav.count; ++i)
+      c_self.grav.parts[i].time_bin =
+          (100 * i < active_percent[k] * c_self.grav.count) ? 1 : 2;
+
+    tic = getticks();
+    for (int n = 0; n < num_self_PP_runs; ++n) {
+      runner_doself_grav_pp(&r, &c_self);
+    }
+    toc = getticks();
+    message("%23s (%3d%%) at order %d took %4d %s.", "doself_grav_pp",
+            active_percent[k], SELF_GRAVITY_MULTIPOLE_ORDER,
+            (int)(1e3 * clocks_from_ticks(toc - tic) / num_self_PP_runs),
+            "us");
+  }
+  e.max_active_bin = 56;
+
   tic = getticks();
   for (int n = 0; n < num_PP_runs; ++n) {
     runner_dopair_grav_pp(&r, &ci, &cj, 1, 0);
@@ -347,8 +377,10 @@ int main(int argc, char *argv[]) {
   free(tensors_j);
   free(ci.grav.parts);
   free(cj.grav.parts);
+  free(c_self.grav.parts);
   free(ci.grav.multipole);
   free(cj.grav.multipole);
+  free(c_self.grav.multipole);
 
   return 0;
 }
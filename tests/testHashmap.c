@@ -27,6 +27,31 @@
 #include "swift.h"
 
 #define NUM_KEYS (26 * 1000 * 1000)
+#define NUM_MERGE_KEYS (4 * 1000 * 1000)
+#define NUM_MERGE_COPIES (3)
+#define NUM_THREADS (4)
+
+/* Keys handed to the threads by #fill_mapper. */
+static hashmap_key_t *merge_keys;
+
+/* Threadpool mapper counting each key in the hash table of its thread. */
+void fill_mapper(void *map_data, int num_elements, void *extra_data) {
+  hashmap_t *maps = (hashmap_t *)extra_data;
+  hashmap_t *m = &maps[threadpool_gettid()];
+  const hashmap_key_t *keys = (const hashmap_key_t *)map_data;
+  for (int k = 0; k < num_elements; k++) {
+    hashmap_value_t *value = hashmap_get(m, keys[k]);
+    value->value_st += 1;
+    value->value_dbl += (double)keys[k];
+  }
+}
+
+/* Merger adding the counts of two hash tables. */
+void count_merger(hashmap_key_t key, hashmap_value_t *value,
+                  const hashmap_value_t *other, void *data) {
+  value->value_st += other->value_st;
+  value->value_dbl += other->value_dbl;
+}
 
 int main(int argc, char *argv[]) {
 
@@ -45,16 +70,20 @@ int main(int argc, char *argv[]) {
   hashmap_init(&m);
 
   message("Populating hash table...");
+  ticks tic = getticks();
   for (hashmap_key_t key = 0; key < NUM_KEYS; key++) {
     hashmap_value_t value;
     value.value_st = (long long)key;
     hashmap_put(&m, key, value);
   }
+  message("Inserting %d keys took %.3f %s.", NUM_KEYS,
+          clocks_from_ticks(getticks() - tic), clocks_getunit());
 
   message("Dumping hashmap stats.");
   hashmap_print_stats(&m);
 
   message("Retrieving elements from the hash table...");
+  tic = getticks();
   for (hashmap_key_t key = 0; key < NUM_KEYS; key++) {
     hashmap_value_t value = *hashmap_lookup(&m, key);
 
@@ -63,6 +92,8 @@ int main(int argc, char *argv[]) {
             (long long)key);
     // else message("Retrieved element, Key: %zu Value: %zu", key, value);
   }
+  message("Retrieving %d keys took %.3f %s.", NUM_KEYS,
+          clocks_from_ticks(getticks() - tic), clocks_getunit());
 
   message("Checking for invalid key...");
   if (hashmap_lookup(&m, NUM_KEYS + 1) != NULL)
@@ -77,4 +108,61 @@ int main(int argc, char *argv[]) {
 
   message("Freeing hash table...");
   hashmap_free(&m);
+
+  /* Now fill one hash table per thread with a shuffled list of keys, each
+   * appearing several times, and merge them. */
+  message("Filling %d thread-local hash tables...", NUM_THREADS);
+  const size_t num_merge_keys = (size_t)NUM_MERGE_KEYS * NUM_MERGE_COPIES;
+  merge_keys = (hashmap_key_t *)malloc(num_merge_keys * sizeof(hashmap_key_t));
+  if (merge_keys == NULL) error("Failed to allocate the keys.");
+  for (size_t k = 0; k < num_merge_keys; k++)
+    merge_keys[k] = (hashmap_key_t)(k % NUM_MERGE_KEYS) * 7919;
+  srand(1234);
+  for (size_t k = num_merge_keys - 1; k > 0; k--) {
+    const size_t j = ((size_t)rand() * RAND_MAX + rand()) % (k + 1);
+    const hashmap_key_t temp = merge_keys[k];
+    merge_keys[k] = merge_keys[j];
+    merge_keys[j] = temp;
+  }
+
+  struct threadpool tp;
+  threadpool_init(&tp, NUM_THREADS);
+  hashmap_t maps[NUM_THREADS];
+  for (int k = 0; k < NUM_THREADS; k++) hashmap_init(&maps[k]);
+
+  tic = getticks();
+  threadpool_map(&tp, fill_mapper, merge_keys, num_merge_keys,
+                 sizeof(hashmap_key_t), threadpool_auto_chunk_size, maps);
+  message("Inserting %zu keys took %.3f %s.", num_merge_keys,
+          clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  message("Merging the thread-local hash tables...");
+  tic = getticks();
+  hashmap_merge_parallel(maps, NUM_THREADS, count_merger, /*data=*/NULL, &tp);
+  message("Merging took %.3f %s.", clocks_from_ticks(getticks() - tic),
+          clocks_getunit());
+
+  message("Checking the merged hash table...");
+  if (maps[0].size != NUM_MERGE_KEYS)
+    error("Merged hash table has %zu elements instead of %d.", maps[0].size,
+          NUM_MERGE_KEYS);
+  for (int k = 1; k < NUM_THREADS; k++)
+    if (maps[k].size != 0 || maps[k].ctrl != NULL)
+      error("Hash table %d was not freed after the merge.", k);
+  for (hashmap_key_t k = 0; k < NUM_MERGE_KEYS; k++) {
+    const hashmap_key_t key = k * 7919;
+    hashmap_value_t *value = hashmap_lookup(&maps[0], key);
+    if (value == NULL) error("Key %lld lost in the merge.", (long long)key);
+    if (value->value_st != NUM_MERGE_COPIES ||
+        value->value_dbl != (double)NUM_MERGE_COPIES * key)
+      error("Incorrect count (%lld) or sum (%e) for key: %lld",
+            value->value_st, value->value_dbl, (long long)key);
+  }
+
+  message("Freeing hash tables...");
+  hashmap_free(&maps[0]);
+  threadpool_clean(&tp);
+  free(merge_keys);
+
+  return 0;
 }
@@ -0,0 +1,201 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#define num_cells 32
+#define num_steps 50
+
+/**
+ * @brief Give a cell a multipole of a given size centred on a given point.
+ */
+void set_multipole(struct cell *c, const double CoM[3], const float r_max) {
+
+  struct gravity_tensors *m = c->grav.multipole;
+  m->CoM[0] = CoM[0];
+  m->CoM[1] = CoM[1];
+  m->CoM[2] = CoM[2];
+  m->r_max = r_max;
+  m->m_pole.M_000 = 1.f;
+  m->m_pole.max_softening = 0.f;
+}
+
+/**
+ * @brief Square of the distance between the centres of mass of two cells.
+ */
+float distance2(const struct cell *ci, const struct cell *cj) {
+
+  const double dx = ci->grav.multipole->CoM[0] - cj->grav.multipole->CoM[0];
+  const double dy = ci->grav.multipole->CoM[1] - cj->grav.multipole->CoM[1];
+  const double dz = ci->grav.multipole->CoM[2] - cj->grav.multipole->CoM[2];
+  return dx * dx + dy * dy + dz * dz;
+}
+
+/**
+ * @brief Look a pair up and check it against the direct evaluation of the MAC.
+ *
+ * Cached acceptances must always be acceptable for the current multipoles.
+ * Cached refusals are allowed to be over-cautious.
+ */
+int check_pair(struct mac_cache *cache, const struct gravity_props *props,
+               const struct cell *ci, const struct cell *cj,
+               const integertime_t ti_current, const int exact) {
+
+  const float r2 = distance2(ci, cj);
+  const int cached = mac_cache_can_use_pair_mm(cache, props, ci, cj, r2,
+                                               /*periodic=*/0, ti_current);
+  const int direct = gravity_M2L_accept_symmetric(
+      props, ci->grav.multipole, cj->grav.multipole, r2,
+      /*use_rebuild_sizes=*/0, /*periodic=*/0);
+
+  if (cached && !direct)
+    error("Cached acceptance not valid any more (r2=%e r_max=%e %e)", r2,
+          ci->grav.multipole->r_max, cj->grav.multipole->r_max);
+  if (exact && cached != direct)
+    error("Cached decision differs from the MAC (%d vs. %d)", cached, direct);
+
+  return cached;
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FP-exceptions */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* A purely geometric MAC */
+  struct gravity_props props;
+  bzero(&props, sizeof(struct gravity_props));
+  props.theta_crit = 0.5f;
+  props.use_tree_below_softening = 1;
+
+  /* Some cells */
+  struct cell *cells = (struct cell *)calloc(num_cells, sizeof(struct cell));
+  struct gravity_tensors *multipoles = (struct gravity_tensors *)calloc(
+      num_cells, sizeof(struct gravity_tensors));
+  if (cells == NULL || multipoles == NULL)
+    error("Impossible to allocate the cells.");
+  for (int i = 0; i < num_cells; ++i) cells[i].grav.multipole = &multipoles[i];
+
+  struct mac_cache cache;
+  mac_cache_init(&cache, /*tolerance=*/0.1f, /*entries_per_cell=*/4.f);
+  long long hits, misses, invalidations, evictions;
+
+  /* Before the first reset, we just evaluate the MAC */
+  const double origin[3] = {0., 0., 0.};
+  const double far[3] = {10., 0., 0.};
+  set_multipole(&cells[0], origin, 1.f);
+  set_multipole(&cells[1], far, 1.f);
+  check_pair(&cache, &props, &cells[0], &cells[1], 0, /*exact=*/1);
+
+  mac_cache_reset(&cache, num_cells, /*verbose=*/0);
+  if (cache.size < num_cells * cache.entries_per_cell)
+    error("MAC cache too small");
+
+  /* A new pair is a miss, then a hit (in either order) */
+  if (!check_pair(&cache, &props, &cells[0], &cells[1], 1, /*exact=*/1))
+    error("Well-separated pair refused");
+  check_pair(&cache, &props, &cells[1], &cells[0], 1, /*exact=*/1);
+  mac_cache_get_counters(&cache, &hits, &misses, &invalidations, &evictions);
+  if (hits != 1 || misses != 1 || invalidations != 0 || evictions != 0)
+    error("Wrong counters: %lld %lld %lld %lld", hits, misses, invalidations,
+          evictions);
+
+  /* Small growth in the next step: still a hit */
+  cells[0].grav.multipole->r_max = 1.05f;
+  check_pair(&cache, &props, &cells[0], &cells[1], 2, /*exact=*/1);
+  mac_cache_get_counters(&cache, &hits, &misses, &invalidations, &evictions);
+  if (hits != 2) error("Decision within tolerance not re-used");
+
+  /* Growth beyond the tolerance: the decision is re-evaluated... */
+  cells[0].grav.multipole->r_max = 4.f;
+  if (check_pair(&cache, &props, &cells[0], &cells[1], 3, /*exact=*/1))
+    error("Badly-separated pair accepted");
+  mac_cache_get_counters(&cache, &hits, &misses, &invalidations, &evictions);
+  if (invalidations != 1) error("Decision out of tolerance not invalidated");
+
+  /* ... but stands for the rest of the step */
+  cells[0].grav.multipole->r_max = 1.f;
+  if (check_pair(&cache, &props, &cells[0], &cells[1], 3, /*exact=*/0))
+    error("Decision changed within a step");
+
+  /* A rebuild empties the cache */
+  mac_cache_reset(&cache, num_cells, /*verbose=*/0);
+  mac_cache_get_counters(&cache, &hits, &misses, &invalidations, &evictions);
+  if (hits != 0 || misses != 0 || invalidations != 0 || evictions != 0)
+    error("Counters not reset");
+
+  /* Now let a random set of multipoles drift and grow over many steps and
+   * check every decision along the way. */
+  srand(0);
+  for (int i = 0; i < num_cells; ++i) {
+    const double CoM[3] = {10. * rand() / RAND_MAX, 10. * rand() / RAND_MAX,
+                           10. * rand() / RAND_MAX};
+    set_multipole(&cells[i], CoM, 0.2f + 0.5f * rand() / RAND_MAX);
+  }
+  int num_accepted = 0;
+  for (int step = 0; step < num_steps; ++step) {
+    const integertime_t ti_current = 10 + step;
+    for (int i = 0; i < num_cells; ++i) {
+      for (int j = i + 1; j < num_cells; ++j) {
+        /* Look the pair up twice, as the unskip and tree walk would do */
+        const int first =
+            check_pair(&cache, &props, &cells[i], &cells[j], ti_current, 0);
+        const int second =
+            check_pair(&cache, &props, &cells[j], &cells[i], ti_current, 0);
+        if (first != second) error("Inconsistent decisions within a step");
+        num_accepted += first;
+      }
+    }
+    for (int i = 0; i < num_cells; ++i) {
+      struct gravity_tensors *m = cells[i].grav.multipole;
+      for (int k = 0; k < 3; ++k)
+        m->CoM[k] += 0.01 * m->r_max * (2. * rand() / RAND_MAX - 1.);
+      m->r_max *= 1.f + 0.01f * rand() / RAND_MAX;
+    }
+  }
+  if (num_accepted == 0) error("No pair accepted");
+
+  mac_cache_get_counters(&cache, &hits, &misses, &invalidations, &evictions);
+  message(
+      "%lld hits, %lld misses, %lld invalidations, %lld evictions, %d "
+      "accepted",
+      hits, misses, invalidations, evictions, num_accepted);
+  if (hits < misses + invalidations)
+    error("The cache was barely used (%lld hits)", hits);
+
+  mac_cache_clean(&cache);
+  free(multipoles);
+  free(cells);
+  return 0;
+}
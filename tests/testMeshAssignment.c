@@ -0,0 +1,422 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#ifndef HAVE_FFTW
+
+int main(int argc, char *argv[]) { return 0; }
+
+#else
+
+/**
+ * @brief Generate particle positions in the box.
+ *
+ * Half of the particles are uniformly distributed, the other half are placed
+ * in compact clumps (one per top-level cell) such that the density field has
+ * power on all scales.
+ */
+void make_clumps(double *x, double *mass, const size_t nr_gparts,
+                 const int cdim, const double dim[3]) {
+
+  const int nr_cells = cdim * cdim * cdim;
+  const size_t count = max(nr_gparts / nr_cells, (size_t)1);
+
+  double centre[3] = {0., 0., 0.};
+  for (size_t n = 0; n < nr_gparts; ++n) {
+
+    /* Centre of the next clump */
+    if (n % count == 0)
+      for (int d = 0; d < 3; ++d)
+        centre[d] = dim[d] * rand() / ((double)RAND_MAX + 1.);
+
+    for (int d = 0; d < 3; ++d) {
+      const double u = rand() / ((double)RAND_MAX + 1.);
+      if (n % 2 == 0)
+        x[3 * n + d] = dim[d] * u;
+      else
+        x[3 * n + d] = centre[d] + 0.1 * dim[d] / cdim * (u - 0.5);
+      x[3 * n + d] = box_wrap(x[3 * n + d], 0., dim[d]);
+    }
+    mass[n] = 1.;
+  }
+}
+
+#ifdef HAVE_HDF5
+/**
+ * @brief Read the dark matter particles of a (Gadget-like) initial
+ * conditions file, such as the one used by testparamgpu.yml.
+ *
+ * @param file_name The name of the file.
+ * @param dim (return) The size of the box.
+ * @param x (return) The positions of the particles (allocated here).
+ * @param mass (return) Their masses (allocated here).
+ *
+ * @return The number of particles.
+ */
+size_t read_ic(const char *file_name, double dim[3], double **x,
+               double **mass) {
+
+  const hid_t h_file = H5Fopen(file_name, H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (h_file < 0) error("Could not open the IC file '%s'.", file_name);
+
+  /* Size of the box, as a scalar or a vector */
+  const hid_t h_grp = H5Gopen(h_file, "/Header", H5P_DEFAULT);
+  const hid_t h_attr = H5Aopen(h_grp, "BoxSize", H5P_DEFAULT);
+  const hid_t h_space = H5Aget_space(h_attr);
+  const int nr_dims = H5Sget_simple_extent_npoints(h_space);
+  double box[3];
+  if (h_grp < 0 || h_attr < 0 ||
+      H5Aread(h_attr, H5T_NATIVE_DOUBLE, box) < 0)
+    error("Could not read the size of the box in '%s'.", file_name);
+  for (int d = 0; d < 3; ++d) dim[d] = (nr_dims == 3) ? box[d] : box[0];
+  H5Sclose(h_space);
+  H5Aclose(h_attr);
+  H5Gclose(h_grp);
+
+  /* Positions of the particles... */
+  const hid_t h_data = H5Dopen(h_file, "/PartType1/Coordinates", H5P_DEFAULT);
+  if (h_data < 0) error("No dark matter particles in '%s'.", file_name);
+  const hid_t h_data_space = H5Dget_space(h_data);
+  hsize_t shape[2];
+  H5Sget_simple_extent_dims(h_data_space, shape, NULL);
+  const size_t nr_gparts = shape[0];
+  *x = (double *)malloc(3 * nr_gparts * sizeof(double));
+  *mass = (double *)malloc(nr_gparts * sizeof(double));
+  if (*x == NULL || *mass == NULL)
+    error("Impossible to allocate memory for the particles.");
+  if (H5Dread(h_data, H5T_NATIVE_DOUBLE, H5S_ALL, H5S_ALL, H5P_DEFAULT, *x) <
+      0)
+    error("Could not read the positions in '%s'.", file_name);
+  H5Sclose(h_data_space);
+  H5Dclose(h_data);
+
+  /* ...and their masses, all the same in the mesh calculation. */
+  for (size_t n = 0; n < nr_gparts; ++n) {
+    (*mass)[n] = 1.;
+    for (int d = 0; d < 3; ++d)
+      (*x)[3 * n + d] = box_wrap((*x)[3 * n + d], 0., dim[d]);
+  }
+
+  H5Fclose(h_file);
+  return nr_gparts;
+}
+#endif
+
+/**
+ * @brief Sort a set of particles into a grid of top-level cells.
+ */
+void make_cells(struct space *s, const int cdim, const double *x,
+                const double *mass, const size_t nr_gparts) {
+
+  const int nr_cells = cdim * cdim * cdim;
+
+  if (posix_memalign((void **)&s->gparts, gpart_align,
+                     nr_gparts * sizeof(struct gpart)) != 0)
+    error("Impossible to allocate memory for gparts.");
+  bzero(s->gparts, nr_gparts * sizeof(struct gpart));
+
+  if (posix_memalign((void **)&s->cells_top, cell_align,
+                     nr_cells * sizeof(struct cell)) != 0)
+    error("Impossible to allocate memory for cells.");
+  bzero(s->cells_top, nr_cells * sizeof(struct cell));
+
+  s->local_cells_top = (int *)malloc(nr_cells * sizeof(int));
+  int *cell_index = (int *)malloc(nr_gparts * sizeof(int));
+  if (s->local_cells_top == NULL || cell_index == NULL)
+    error("Impossible to allocate memory for the list of cells.");
+
+  s->nr_gparts = nr_gparts;
+  s->nr_cells = nr_cells;
+  s->nr_local_cells = nr_cells;
+
+  /* Count the particles in each cell... */
+  for (size_t n = 0; n < nr_gparts; ++n) {
+    int ind[3];
+    for (int d = 0; d < 3; ++d)
+      ind[d] = min((int)(x[3 * n + d] * cdim / s->dim[d]), cdim - 1);
+    cell_index[n] = (ind[0] * cdim + ind[1]) * cdim + ind[2];
+    s->cells_top[cell_index[n]].grav.count++;
+  }
+
+  size_t offset = 0;
+  for (int i = 0; i < cdim; ++i) {
+    for (int j = 0; j < cdim; ++j) {
+      for (int k = 0; k < cdim; ++k) {
+
+        const int cid = (i * cdim + j) * cdim + k;
+        struct cell *c = &s->cells_top[cid];
+        s->local_cells_top[cid] = cid;
+
+        c->loc[0] = i * s->dim[0] / cdim;
+        c->loc[1] = j * s->dim[1] / cdim;
+        c->loc[2] = k * s->dim[2] / cdim;
+        c->width[0] = s->dim[0] / cdim;
+        c->width[1] = s->dim[1] / cdim;
+        c->width[2] = s->dim[2] / cdim;
+        c->grav.parts = &s->gparts[offset];
+        offset += c->grav.count;
+        c->grav.count = 0;
+      }
+    }
+  }
+
+  /* ...and put them in place. */
+  for (size_t n = 0; n < nr_gparts; ++n) {
+    struct cell *c = &s->cells_top[cell_index[n]];
+    struct gpart *gp = &c->grav.parts[c->grav.count++];
+    for (int d = 0; d < 3; ++d) gp->x[d] = x[3 * n + d];
+    gp->mass = mass[n];
+    gp->type = swift_type_dark_matter;
+    gp->time_bin = 1;
+  }
+
+  free(cell_index);
+}
+
+/**
+ * @brief Compute the mesh accelerations of all the particles with a given
+ * mass assignment scheme.
+ *
+ * @return The time spent in the mesh calculation in milli-seconds.
+ */
+double compute_mesh_forces(struct space *s, struct threadpool *tp,
+                           const struct gravity_props *props, const int runs) {
+
+  struct pm_mesh mesh;
+  pm_mesh_init(&mesh, props, s->dim, tp->num_threads);
+
+  const ticks tic = getticks();
+  for (int r = 0; r < runs; ++r) {
+    for (size_t i = 0; i < s->nr_gparts; ++i) {
+      s->gparts[i].a_grav_mesh[0] = 0.f;
+      s->gparts[i].a_grav_mesh[1] = 0.f;
+      s->gparts[i].a_grav_mesh[2] = 0.f;
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+      s->gparts[i].potential_mesh = 0.f;
+#endif
+    }
+    pm_mesh_compute_potential(&mesh, s, tp, /*verbose=*/0);
+  }
+  const ticks toc = getticks();
+
+  pm_mesh_free(&mesh);
+
+  return clocks_from_ticks(toc - tic) / runs;
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FP-exceptions */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  srand(0);
+
+  int nr_threads = 1;
+  int runs = 1;
+  int cdim = 4;
+  int N = 32;
+  double parts_per_mesh_cell = 1.;
+  const char *ic_file_name = "../test10000.hdf5";
+
+  int c;
+  while ((c = getopt(argc, argv, "t:r:c:n:p:f:s")) != -1) {
+    switch (c) {
+      case 't':
+        sscanf(optarg, "%d", &nr_threads);
+        break;
+      case 'r':
+        sscanf(optarg, "%d", &runs);
+        break;
+      case 'c':
+        sscanf(optarg, "%d", &cdim);
+        break;
+      case 'n':
+        sscanf(optarg, "%d", &N);
+        break;
+      case 'p':
+        sscanf(optarg, "%lf", &parts_per_mesh_cell);
+        break;
+      case 'f':
+        ic_file_name = optarg;
+        break;
+      case 's':
+        ic_file_name = NULL;
+        break;
+      case '?':
+        printf(
+            "\nUsage: %s [OPTIONS...]\n"
+            "\nMeasures the accuracy and cost of the long-range mesh forces "
+            "for the CIC, TSC and PCS mass assignment schemes, with and "
+            "without interlacing. The reference is obtained with PCS and "
+            "interlacing on a mesh twice as fine with the same smoothing "
+            "scale. The particles are read from the initial conditions used "
+            "by testparamgpu.yml, if found, or generated in clumps."
+            "\n\nOptions:"
+            "\n-t NR_THREADS   - Number of threads to use (default: 1)"
+            "\n-r NR_RUNS      - Number of runs to time (default: 1)"
+            "\n-c CDIM         - Number of top-level cells along each axis "
+            "(default: 4)"
+            "\n-n MESH_SIZE    - Side-length of the mesh (default: 32)"
+            "\n-p PARTS        - Number of particles per mesh cell, when "
+            "generated (default: 1)"
+            "\n-f FILE         - Initial conditions to read the dark matter "
+            "particles from (default: ../test10000.hdf5)"
+            "\n-s              - Generate the particles in clumps instead\n",
+            argv[0]);
+        exit(1);
+    }
+  }
+
+  struct threadpool tp;
+  threadpool_init(&tp, nr_threads);
+
+  /* Minimal engine used to access the constants */
+  struct neutrino_props neutrino_properties;
+  bzero(&neutrino_properties, sizeof(struct neutrino_props));
+  struct phys_const phys_const;
+  bzero(&phys_const, sizeof(struct phys_const));
+  phys_const.const_newton_G = 1.;
+  struct engine e;
+  bzero(&e, sizeof(struct engine));
+  e.neutrino_properties = &neutrino_properties;
+  e.physical_constants = &phys_const;
+
+  /* Build the infrastructure */
+  struct space s;
+  bzero(&s, sizeof(struct space));
+  s.periodic = 1;
+  s.e = &e;
+
+  /* Use the testparamgpu.yml initial conditions if we can */
+  double *x = NULL, *mass = NULL;
+  size_t nr_gparts = 0;
+#ifdef HAVE_HDF5
+  if (ic_file_name != NULL && access(ic_file_name, R_OK) == 0) {
+    nr_gparts = read_ic(ic_file_name, s.dim, &x, &mass);
+    message("Initial conditions: %s", ic_file_name);
+  }
+#endif
+  if (x == NULL) {
+    s.dim[0] = 1.;
+    s.dim[1] = 1.;
+    s.dim[2] = 1.;
+    nr_gparts = (size_t)(parts_per_mesh_cell * N * N * N);
+    x = (double *)malloc(3 * nr_gparts * sizeof(double));
+    mass = (double *)malloc(nr_gparts * sizeof(double));
+    if (x == NULL || mass == NULL)
+      error("Impossible to allocate memory for the particles.");
+    make_clumps(x, mass, nr_gparts, cdim, s.dim);
+    message("Initial conditions: clumps");
+  }
+  make_cells(&s, cdim, x, mass, nr_gparts);
+  free(x);
+  free(mass);
+
+  message("Number of threads: %d", nr_threads);
+  message("Mesh size:         %d^3", N);
+  message("Number of gparts:  %zd", s.nr_gparts);
+
+  struct gravity_props props;
+  bzero(&props, sizeof(struct gravity_props));
+  props.mesh_uses_local_patches = 1;
+  props.r_cut_max_ratio = 4.5f;
+  props.r_cut_min_ratio = 0.1f;
+
+  /* Reference: finer mesh, same smoothing scale in physical units */
+  props.mesh_size = 2 * N;
+  props.a_smooth = 2.f * 1.25f;
+  props.mesh_assignment_order = 4;
+  props.mesh_interlacing = 1;
+  compute_mesh_forces(&s, &tp, &props, /*runs=*/1);
+
+  double *a_ref = (double *)malloc(3 * s.nr_gparts * sizeof(double));
+  if (a_ref == NULL) error("Impossible to allocate the reference forces.");
+  double norm = 0.;
+  for (size_t i = 0; i < s.nr_gparts; ++i) {
+    for (int d = 0; d < 3; ++d) {
+      a_ref[3 * i + d] = s.gparts[i].a_grav_mesh[d];
+      norm += a_ref[3 * i + d] * a_ref[3 * i + d];
+    }
+  }
+
+  /* Now, all the schemes on the mesh we test */
+  props.mesh_size = N;
+  props.a_smooth = 1.25f;
+
+  double error_CIC = 0., error_best = 0.;
+  for (int order = 2; order <= MESH_ASSIGNMENT_MAX_ORDER; ++order) {
+    for (int interlacing = 0; interlacing < 2; ++interlacing) {
+
+      props.mesh_assignment_order = order;
+      props.mesh_interlacing = interlacing;
+      const double time = compute_mesh_forces(&s, &tp, &props, runs);
+
+      /* RMS error relative to the RMS reference force */
+      double diff = 0.;
+      for (size_t i = 0; i < s.nr_gparts; ++i) {
+        for (int d = 0; d < 3; ++d) {
+          const double delta = s.gparts[i].a_grav_mesh[d] - a_ref[3 * i + d];
+          diff += delta * delta;
+        }
+      }
+      const double rms_error = sqrt(diff / norm);
+
+      message("%s interlacing=%d: RMS force error %.3e, time %8.2f %s",
+              mesh_assignment_name(order), interlacing, rms_error, time,
+              clocks_getunit());
+
+      if (order == 2 && !interlacing) error_CIC = rms_error;
+      if (order == MESH_ASSIGNMENT_MAX_ORDER && interlacing)
+        error_best = rms_error;
+    }
+  }
+
+  /* The highest-order scheme must beat plain CIC */
+  if (!(error_best < error_CIC))
+    error("PCS with interlacing (%e) is not more accurate than CIC (%e)",
+          error_best, error_CIC);
+
+  free(a_ref);
+  free(s.gparts);
+  free(s.cells_top);
+  free(s.local_cells_top);
+  threadpool_clean(&tp);
+
+  return 0;
+}
+
+#endif
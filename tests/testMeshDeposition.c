@@ -0,0 +1,279 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#ifndef HAVE_FFTW
+
+int main(int argc, char *argv[]) { return 0; }
+
+#else
+
+/**
+ * @brief Fill a grid of top-level cells with uniformly distributed particles.
+ *
+ * The particles are stored contiguously, cell after cell, as they would be
+ * after a call to space_rebuild().
+ */
+void make_cells(struct space *s, const int cdim, const size_t nr_gparts) {
+
+  const int nr_cells = cdim * cdim * cdim;
+  const double width = s->dim[0] / cdim;
+  const size_t count = nr_gparts / nr_cells;
+
+  if (posix_memalign((void **)&s->gparts, gpart_align,
+                     count * nr_cells * sizeof(struct gpart)) != 0)
+    error("Impossible to allocate memory for gparts.");
+  bzero(s->gparts, count * nr_cells * sizeof(struct gpart));
+
+  if (posix_memalign((void **)&s->cells_top, cell_align,
+                     nr_cells * sizeof(struct cell)) != 0)
+    error("Impossible to allocate memory for cells.");
+  bzero(s->cells_top, nr_cells * sizeof(struct cell));
+
+  s->local_cells_top = (int *)malloc(nr_cells * sizeof(int));
+  if (s->local_cells_top == NULL)
+    error("Impossible to allocate memory for the list of local cells.");
+
+  s->nr_gparts = count * nr_cells;
+  s->nr_cells = nr_cells;
+  s->nr_local_cells = nr_cells;
+
+  for (int i = 0; i < cdim; ++i) {
+    for (int j = 0; j < cdim; ++j) {
+      for (int k = 0; k < cdim; ++k) {
+
+        const int cid = (i * cdim + j) * cdim + k;
+        struct cell *c = &s->cells_top[cid];
+        s->local_cells_top[cid] = cid;
+
+        c->loc[0] = i * width;
+        c->loc[1] = j * width;
+        c->loc[2] = k * width;
+        c->width[0] = width;
+        c->width[1] = width;
+        c->width[2] = width;
+        c->grav.count = count;
+        c->grav.parts = &s->gparts[cid * count];
+
+        for (size_t n = 0; n < count; ++n) {
+          struct gpart *gp = &c->grav.parts[n];
+          gp->x[0] = c->loc[0] + width * rand() / ((double)RAND_MAX + 1.);
+          gp->x[1] = c->loc[1] + width * rand() / ((double)RAND_MAX + 1.);
+          gp->x[2] = c->loc[2] + width * rand() / ((double)RAND_MAX + 1.);
+          gp->mass = 1.f;
+          gp->type = swift_type_dark_matter;
+          gp->time_bin = 1;
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Time the deposition of the particles onto the mesh.
+ *
+ * @return The number of particles deposited per second.
+ */
+double time_deposition(struct pm_mesh *mesh, const struct space *s,
+                       struct threadpool *tp, double *rho, const double shift,
+                       const int runs) {
+
+  const ticks tic = getticks();
+  for (int r = 0; r < runs; ++r)
+    pm_mesh_gparts_to_density(mesh, s, tp, rho, shift);
+  const ticks toc = getticks();
+
+  return runs * s->nr_gparts / (clocks_from_ticks(toc - tic) / 1000.);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FP-exceptions */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  srand(0);
+
+  int nr_threads = 1;
+  int runs = 1;
+  int cdim = 8;
+  double parts_per_mesh_cell = 1.;
+
+  int c;
+  while ((c = getopt(argc, argv, "t:r:c:p:")) != -1) {
+    switch (c) {
+      case 't':
+        sscanf(optarg, "%d", &nr_threads);
+        break;
+      case 'r':
+        sscanf(optarg, "%d", &runs);
+        break;
+      case 'c':
+        sscanf(optarg, "%d", &cdim);
+        break;
+      case 'p':
+        sscanf(optarg, "%lf", &parts_per_mesh_cell);
+        break;
+      case '?':
+        printf(
+            "\nUsage: %s [OPTIONS...] [MESH_SIZE...]\n"
+            "\nCompares the direct (atomic) and patch-based CIC, TSC and PCS "
+            "deposition of particles (with and without the half-cell shift "
+            "used for interlacing) onto a mesh of each of the given sizes "
+            "(default: 64)."
+            "\n\nOptions:"
+            "\n-t NR_THREADS   - Number of threads to use (default: 1)"
+            "\n-r NR_RUNS      - Number of runs to time (default: 1)"
+            "\n-c CDIM         - Number of top-level cells along each axis "
+            "(default: 8)"
+            "\n-p PARTS        - Number of particles per mesh cell "
+            "(default: 1)\n",
+            argv[0]);
+        exit(1);
+    }
+  }
+
+  /* Default mesh size if none are specified */
+  const int default_mesh_size = 64;
+  const int *mesh_sizes = &default_mesh_size;
+  int nr_mesh_sizes = 1;
+  int *user_mesh_sizes = NULL;
+  if (optind < argc) {
+    nr_mesh_sizes = argc - optind;
+    user_mesh_sizes = (int *)malloc(nr_mesh_sizes * sizeof(int));
+    for (int i = 0; i < nr_mesh_sizes; ++i)
+      user_mesh_sizes[i] = atoi(argv[optind + i]);
+    mesh_sizes = user_mesh_sizes;
+  }
+
+  struct threadpool tp;
+  threadpool_init(&tp, nr_threads);
+
+  /* Minimal engine used to access the neutrino properties */
+  struct neutrino_props neutrino_properties;
+  bzero(&neutrino_properties, sizeof(struct neutrino_props));
+  struct engine e;
+  bzero(&e, sizeof(struct engine));
+  e.neutrino_properties = &neutrino_properties;
+
+  message("Number of threads: %d", nr_threads);
+  message("Top-level cells:   %d^3", cdim);
+
+  for (int n = 0; n < nr_mesh_sizes; ++n) {
+
+    const int N = mesh_sizes[n];
+    const size_t nr_gparts = (size_t)(parts_per_mesh_cell * N * N * N);
+
+    /* Build the infrastructure */
+    struct space s;
+    bzero(&s, sizeof(struct space));
+    s.dim[0] = 1.;
+    s.dim[1] = 1.;
+    s.dim[2] = 1.;
+    s.periodic = 1;
+    s.e = &e;
+    make_cells(&s, cdim, nr_gparts);
+
+    struct pm_mesh mesh;
+    bzero(&mesh, sizeof(struct pm_mesh));
+    mesh.N = N;
+    mesh.periodic = 1;
+    mesh.cell_fac = N / s.dim[0];
+    mesh.dim[0] = s.dim[0];
+    mesh.dim[1] = s.dim[1];
+    mesh.dim[2] = s.dim[2];
+
+    double *rho_direct = NULL, *rho_patches = NULL;
+    const size_t mesh_size = (size_t)N * N * N * sizeof(double);
+    if (posix_memalign((void **)&rho_direct, SWIFT_CACHE_ALIGNMENT,
+                       mesh_size) != 0 ||
+        posix_memalign((void **)&rho_patches, SWIFT_CACHE_ALIGNMENT,
+                       mesh_size) != 0)
+      error("Impossible to allocate memory for the meshes.");
+
+    for (int order = 2; order <= MESH_ASSIGNMENT_MAX_ORDER; ++order) {
+      for (int shifted = 0; shifted < 2; ++shifted) {
+
+        const double shift = shifted ? 0.5 : 0.;
+        mesh.assignment_order = order;
+
+        /* Time both deposition methods */
+        mesh.use_local_patches = 0;
+        const double rate_direct =
+            time_deposition(&mesh, &s, &tp, rho_direct, shift, runs);
+        mesh.use_local_patches = 1;
+        const double rate_patches =
+            time_deposition(&mesh, &s, &tp, rho_patches, shift, runs);
+
+        message(
+            "N=%4d^3 gparts=%zd %s shift=%.1f: direct %8.2f Mparts/s, "
+            "patches %8.2f Mparts/s (speed-up %.2f)",
+            N, s.nr_gparts, mesh_assignment_name(order), shift,
+            rate_direct / 1e6, rate_patches / 1e6, rate_patches / rate_direct);
+
+        /* Check that both methods deposited the same mass */
+        double max_rho = 0., max_diff = 0., total_direct = 0.,
+               total_patches = 0.;
+        for (size_t i = 0; i < (size_t)N * N * N; ++i) {
+          max_rho = max(max_rho, fabs(rho_direct[i]));
+          max_diff = max(max_diff, fabs(rho_direct[i] - rho_patches[i]));
+          total_direct += rho_direct[i];
+          total_patches += rho_patches[i];
+        }
+        if (max_diff > 1e-10 * max_rho)
+          error("Deposition methods disagree: max diff=%e max rho=%e",
+                max_diff, max_rho);
+        if (fabs(total_direct - s.nr_gparts) > 1e-8 * s.nr_gparts ||
+            fabs(total_patches - s.nr_gparts) > 1e-8 * s.nr_gparts)
+          error("Mass not conserved: direct=%f patches=%f expected=%zd",
+                total_direct, total_patches, s.nr_gparts);
+      }
+    }
+
+    free(rho_direct);
+    free(rho_patches);
+    free(s.gparts);
+    free(s.cells_top);
+    free(s.local_cells_top);
+  }
+
+  threadpool_clean(&tp);
+  if (user_mesh_sizes != NULL) free(user_mesh_sizes);
+
+  return 0;
+}
+
+#endif
@@ -0,0 +1,192 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* System includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "../src/clocks.h"
+#include "../src/error.h"
+#include "../src/io_parallel_compression.h"
+#include "../src/threadpool.h"
+
+#define NUM_THREADS (4)
+
+#ifdef IO_HAVE_PARALLEL_COMPRESSION
+
+/**
+ * @brief Create a chunked dataset with the filters used for the snapshots.
+ */
+static hid_t create_dataset(hid_t h_file, const char *name, hid_t h_type,
+                            size_t N, int dimension, size_t chunk_rows) {
+
+  const int rank = dimension > 1 ? 2 : 1;
+  const hsize_t shape[2] = {N, (hsize_t)dimension};
+  const hsize_t chunk_shape[2] = {chunk_rows, (hsize_t)dimension};
+
+  const hid_t h_space = H5Screate_simple(rank, shape, NULL);
+  const hid_t h_prop = H5Pcreate(H5P_DATASET_CREATE);
+  H5Pset_chunk(h_prop, rank, chunk_shape);
+  H5Pset_shuffle(h_prop);
+  H5Pset_deflate(h_prop, 4);
+  H5Pset_fletcher32(h_prop);
+
+  const hid_t h_data = H5Dcreate(h_file, name, h_type, h_space, H5P_DEFAULT,
+                                 h_prop, H5P_DEFAULT);
+  if (h_data < 0) error("Could not create dataset '%s'.", name);
+
+  H5Pclose(h_prop);
+  H5Sclose(h_space);
+  return h_data;
+}
+
+/**
+ * @brief Compress a dataset in parallel, write it and check that both HDF5
+ * and our own decoding give back the original data. Also times HDF5's own
+ * compression for comparison.
+ */
+static void check_dataset(struct threadpool *tp, hid_t h_file,
+                          const char *name, hid_t h_type, const void *data,
+                          size_t N, int dimension, size_t chunk_rows) {
+
+  const size_t type_size = H5Tget_size(h_type);
+  const size_t bytes = N * dimension * type_size;
+
+  /* Let HDF5 do it. */
+  char serial_name[64];
+  sprintf(serial_name, "%s_serial", name);
+  ticks tic = getticks();
+  hid_t h_data =
+      create_dataset(h_file, serial_name, h_type, N, dimension, chunk_rows);
+  if (H5Dwrite(h_data, h_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, data) < 0)
+    error("Could not write dataset '%s'.", serial_name);
+  H5Dclose(h_data);
+  const double serial_time = clocks_from_ticks(getticks() - tic);
+
+  /* Do it ourselves. */
+  tic = getticks();
+  h_data = create_dataset(h_file, name, h_type, N, dimension, chunk_rows);
+  struct io_compressed_dataset compressed;
+  io_parallel_compress(tp, data, N, dimension, type_size, chunk_rows, 4,
+                       &compressed);
+  io_parallel_compression_write(h_data, &compressed, name);
+  const double parallel_time = clocks_from_ticks(getticks() - tic);
+
+  /* Undo the filters ourselves and check we get the data back. */
+  struct io_filter_pipeline pipeline;
+  const hid_t h_plist = H5Dget_create_plist(h_data);
+  if (!io_parallel_decompression_init(h_plist, type_size, &pipeline))
+    error("Cannot undo the filters of '%s'.", name);
+  H5Pclose(h_plist);
+  H5Dclose(h_data);
+
+  const size_t chunk_bytes = chunk_rows * dimension * type_size;
+  char *out = (char *)malloc(chunk_bytes);
+  char *scratch = (char *)malloc(chunk_bytes);
+  for (int k = 0; k < compressed.nr_chunks; ++k) {
+    const size_t first = compressed.chunks[k].offset[0];
+    const size_t rows = first + chunk_rows > N ? N - first : chunk_rows;
+    io_parallel_decompress_chunk(&pipeline, /*filter_mask=*/0,
+                                 compressed.chunks[k].data,
+                                 compressed.chunks[k].size, out, chunk_bytes,
+                                 scratch, name);
+    if (memcmp(out, (const char *)data + first * dimension * type_size,
+               rows * dimension * type_size) != 0)
+      error("Chunk %d of '%s' does not decode to the original data.", k,
+            name);
+  }
+  free(out);
+  free(scratch);
+
+  message(
+      "'%s': %zd chunks, ratio %.3f, HDF5 took %.3f %s, parallel took %.3f "
+      "%s.",
+      name, (size_t)compressed.nr_chunks,
+      (double)compressed.raw_bytes / compressed.compressed_bytes, serial_time,
+      clocks_getunit(), parallel_time, clocks_getunit());
+  io_parallel_compression_free(&compressed);
+
+  /* Read it back through the filter pipeline, which verifies the
+   * check-sums. */
+  void *check = malloc(bytes);
+  h_data = H5Dopen(h_file, name, H5P_DEFAULT);
+  if (H5Dread(h_data, h_type, H5S_ALL, H5S_ALL, H5P_DEFAULT, check) < 0)
+    error("Could not read back dataset '%s'.", name);
+  H5Dclose(h_data);
+
+  if (memcmp(data, check, bytes) != 0)
+    error("Dataset '%s' does not match the original data.", name);
+
+  free(check);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  struct threadpool tp;
+  threadpool_init(&tp, NUM_THREADS);
+
+  const hid_t h_file = H5Fcreate("testParallelCompression.hdf5", H5F_ACC_TRUNC,
+                                 H5P_DEFAULT, H5P_DEFAULT);
+  if (h_file < 0) error("Could not create the test file.");
+
+  /* Vectors of floats, with a partial chunk at the end. */
+  const size_t N_f = 1000003;
+  float *data_f = (float *)malloc(3 * N_f * sizeof(float));
+  for (size_t i = 0; i < 3 * N_f; ++i) data_f[i] = 1e-3f * (i % 100003);
+  check_dataset(&tp, h_file, "Coordinates", H5T_NATIVE_FLOAT, data_f, N_f, 3,
+                1 << 16);
+  free(data_f);
+
+  /* Scalars of long long. */
+  const size_t N_l = 777777;
+  long long *data_l = (long long *)malloc(N_l * sizeof(long long));
+  for (size_t i = 0; i < N_l; ++i) data_l[i] = 1000000000000LL + 7 * i;
+  check_dataset(&tp, h_file, "ParticleIDs", H5T_NATIVE_LLONG, data_l, N_l, 1,
+                1 << 17);
+  free(data_l);
+
+  /* A dataset that is a single, full, chunk. */
+  const size_t N_d = 5;
+  double data_d[5] = {1., -2., 3.5, 1e300, 0.};
+  check_dataset(&tp, h_file, "Masses", H5T_NATIVE_DOUBLE, data_d, N_d, 1, N_d);
+
+  H5Fclose(h_file);
+  remove("testParallelCompression.hdf5");
+  threadpool_clean(&tp);
+
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+  message("Parallel compression is not available in this build.");
+  return 0;
+}
+
+#endif /* IO_HAVE_PARALLEL_COMPRESSION */
@@ -0,0 +1,246 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#ifndef HAVE_FFTW
+
+int main(int argc, char *argv[]) { return 0; }
+
+#else
+
+/**
+ * @brief Filter applied to the modes: a real and even function of k.
+ */
+INLINE static double test_filter(const int i, const int j, const int k,
+                                 const int N) {
+
+  const int kx = (i > N / 2 ? i - N : i);
+  const int ky = (j > N / 2 ? j - N : j);
+  const int kz = (k > N / 2 ? k - N : k);
+  return 1. / (1. + kx * kx + 2. * ky * ky + 3. * kz * kz);
+}
+
+/**
+ * @brief #pm_mesh_pencil_kernel applying the test filter and counting the
+ * modes it has seen.
+ */
+void test_kernel(struct threadpool *tp, fftw_complex *frho, const int kz_start,
+                 const int nkz, const int ky_start, const int nky, const int N,
+                 void *extra) {
+
+  size_t *count = (size_t *)extra;
+
+  for (int k = 0; k < nkz; ++k) {
+    for (int j = 0; j < nky; ++j) {
+      for (int i = 0; i < N; ++i) {
+        const double f = test_filter(i, ky_start + j, kz_start + k, N);
+        const size_t index = ((size_t)k * nky + j) * N + i;
+        frho[index][0] *= f;
+        frho[index][1] *= f;
+      }
+    }
+  }
+  *count += (size_t)nkz * nky * N;
+}
+
+int main(int argc, char *argv[]) {
+
+#ifdef WITH_MPI
+  MPI_Init(&argc, &argv);
+#endif
+  int nr_nodes = 1, myrank = 0;
+#ifdef WITH_MPI
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+#endif
+  engine_rank = myrank;
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FP-exceptions */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  int N = 18;
+  int runs = 1;
+
+  int c;
+  while ((c = getopt(argc, argv, "n:r:")) != -1) {
+    switch (c) {
+      case 'n':
+        sscanf(optarg, "%d", &N);
+        break;
+      case 'r':
+        sscanf(optarg, "%d", &runs);
+        break;
+      case '?':
+        printf(
+            "\nUsage: %s [OPTIONS...]\n"
+            "\nCompares the convolution of a random field done with the "
+            "pencil-distributed FFT against the one done with the serial "
+            "3D FFT. Run it with many MPI ranks to exercise the transposes."
+            "\n\nOptions:"
+            "\n-n MESH_SIZE    - Side-length of the mesh (default: 18)"
+            "\n-r NR_RUNS      - Number of runs to time (default: 1)\n",
+            argv[0]);
+        exit(1);
+    }
+  }
+
+  if (N % 2 != 0) error("The mesh side-length must be even.");
+
+  struct threadpool tp;
+  threadpool_init(&tp, 1);
+
+  /* A random field, identical on all the ranks */
+  srand(0);
+  const size_t size = (size_t)N * N * N;
+  double *field = (double *)malloc(size * sizeof(double));
+  double *reference = (double *)fftw_malloc(size * sizeof(double));
+  fftw_complex *freference =
+      (fftw_complex *)fftw_malloc(N * N * (N / 2 + 1) * sizeof(fftw_complex));
+  if (field == NULL || reference == NULL || freference == NULL)
+    error("Impossible to allocate the meshes.");
+  for (size_t i = 0; i < size; ++i) {
+    field[i] = rand() / ((double)RAND_MAX) - 0.5;
+    reference[i] = field[i];
+  }
+
+  /* The reference: serial 3D FFT */
+  fftw_plan forward =
+      fftw_plan_dft_r2c_3d(N, N, N, reference, freference, FFTW_ESTIMATE);
+  fftw_execute(forward);
+  fftw_destroy_plan(forward);
+  for (int i = 0; i < N; ++i)
+    for (int j = 0; j < N; ++j)
+      for (int k = 0; k < N / 2 + 1; ++k) {
+        const double f = test_filter(i, j, k, N);
+        const size_t index = ((size_t)i * N + j) * (N / 2 + 1) + k;
+        freference[index][0] *= f;
+        freference[index][1] *= f;
+      }
+  fftw_plan backward =
+      fftw_plan_dft_c2r_3d(N, N, N, freference, reference, FFTW_ESTIMATE);
+  fftw_execute(backward);
+  fftw_destroy_plan(backward);
+
+  double max_ref = 0.;
+  for (size_t i = 0; i < size; ++i) max_ref = max(max_ref, fabs(reference[i]));
+
+  /* Now the pencils */
+  struct pm_mesh_pencil pencil;
+  pm_mesh_pencil_init(&pencil, N);
+  if (myrank == 0)
+    message("N=%d, %d ranks in a %dx%d grid", N, nr_nodes, pencil.P0,
+            pencil.P1);
+
+  const size_t local_size = pm_mesh_pencil_local_size(&pencil);
+  double *rho = (double *)fftw_malloc((local_size + 1) * sizeof(double));
+  if (rho == NULL) error("Impossible to allocate the pencils.");
+
+  /* Try a few chunkings of the pipelined transpose, including more chunks
+   * than kz modes */
+  const int chunks[3] = {1, pm_mesh_pencil_nr_chunks, N};
+  for (int n = 0; n < 3; ++n) {
+
+    double time = 0.;
+    size_t count = 0;
+    for (int r = 0; r < runs; ++r) {
+
+      for (int i = 0; i < pencil.nx; ++i)
+        for (int j = 0; j < pencil.ny; ++j)
+          for (int k = 0; k < N; ++k)
+            rho[pm_mesh_pencil_index(&pencil, pencil.x_start + i,
+                                     pencil.y_start + j, k)] =
+                field[((size_t)(pencil.x_start + i) * N + pencil.y_start + j) *
+                          N +
+                      k];
+
+      count = 0;
+      const ticks tic = getticks();
+      pm_mesh_pencil_convolve(&pencil, rho, &tp, test_kernel, &count,
+                              chunks[n], /*verbose=*/0);
+      time += clocks_from_ticks(getticks() - tic);
+    }
+
+    /* Compare to the reference */
+    double max_diff = 0.;
+    for (int i = 0; i < pencil.nx; ++i)
+      for (int j = 0; j < pencil.ny; ++j)
+        for (int k = 0; k < N; ++k) {
+          const double ref =
+              reference[((size_t)(pencil.x_start + i) * N + pencil.y_start +
+                         j) *
+                            N +
+                        k];
+          const double val = rho[pm_mesh_pencil_index(
+              &pencil, pencil.x_start + i, pencil.y_start + j, k)];
+          max_diff = max(max_diff, fabs(val - ref));
+        }
+
+#ifdef WITH_MPI
+    MPI_Allreduce(MPI_IN_PLACE, &max_diff, 1, MPI_DOUBLE, MPI_MAX,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &count, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM,
+                  MPI_COMM_WORLD);
+    MPI_Allreduce(MPI_IN_PLACE, &time, 1, MPI_DOUBLE, MPI_MAX,
+                  MPI_COMM_WORLD);
+#endif
+
+    if (myrank == 0)
+      message("chunks=%2d: max rel. diff %.3e, time %8.3f %s", chunks[n],
+              max_diff / max_ref, time / runs, clocks_getunit());
+
+    /* Every mode must have been filtered exactly once */
+    if (count != (size_t)N * N * (N / 2 + 1))
+      error("Wrong number of modes seen by the kernel: %zd instead of %zd",
+            count, (size_t)N * N * (N / 2 + 1));
+    if (max_diff > 1e-10 * max_ref)
+      error("Pencil convolution does not match the serial one (%e)",
+            max_diff / max_ref);
+  }
+
+  pm_mesh_pencil_clean(&pencil);
+  fftw_free(rho);
+  fftw_free(reference);
+  fftw_free(freference);
+  free(field);
+  threadpool_clean(&tp);
+
+#ifdef WITH_MPI
+  MPI_Finalize();
+#endif
+  return 0;
+}
+
+#endif
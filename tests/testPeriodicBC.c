@@ -486,6 +486,7 @@ int main(int argc, char *argv[]) {
 
   struct hydro_props hp;
   hp.h_max = FLT_MAX;
+  hp.use_neighbour_lists = 0;
 
   struct engine engine;
   engine.s = &space;
@@ -502,6 +503,10 @@ int main(int argc, char *argv[]) {
   struct runner real_runner;
   struct runner *runner = &real_runner;
   runner->e = &engine;
+  runner->ci_hot_cache.count = 0;
+  runner->cj_hot_cache.count = 0;
+  hydro_hot_cache_init(&runner->ci_hot_cache, 512);
+  hydro_hot_cache_init(&runner->cj_hot_cache, 512);
 
   struct cosmology cosmo;
   cosmology_init_no_cosmo(&cosmo);
@@ -618,6 +623,8 @@ int main(int argc, char *argv[]) {
 
   /* Clean things to make the sanitizer happy ... */
   for (int i = 0; i < dim * dim * dim; ++i) clean_up(cells[i]);
+  hydro_hot_cache_clean(&runner->ci_hot_cache);
+  hydro_hot_cache_clean(&runner->cj_hot_cache);
 
   return 0;
 }
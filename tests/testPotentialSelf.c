@@ -205,6 +205,94 @@ int main(int argc, char *argv[]) {
     // message("x=%e f=%e f_true=%e", gp->x[0], gp->a_grav[0], acc_true);
   }
 
+  /* Now a cloud of massive particles. With all of them active, the
+   * interactions are computed using the symmetric kernel; with only a few,
+   * using the non-symmetric one. */
+  const int num_cloud = 2 * num_tests;
+  free(c.grav.parts);
+  c.grav.count = num_cloud;
+  if (posix_memalign((void **)&c.grav.parts, gpart_align,
+                     c.grav.count * sizeof(struct gpart)) != 0)
+    error("Impossible to allocate memory for the gparts.");
+
+  srand(1234);
+  for (int n = 0; n < num_cloud; ++n) {
+    struct gpart *gp = &c.grav.parts[n];
+    bzero(gp, sizeof(struct gpart));
+    gp->x[0] = rand() / ((double)RAND_MAX);
+    gp->x[1] = rand() / ((double)RAND_MAX);
+    gp->x[2] = rand() / ((double)RAND_MAX);
+    gp->mass = 0.5 + rand() / ((double)RAND_MAX);
+    gp->type = swift_type_dark_matter;
+    gp->id_or_neg_offset = n + 1;
+#ifdef MULTI_SOFTENING_GRAVITY
+    gp->epsilon = eps;
+#endif
+#ifdef SWIFT_DEBUG_CHECKS
+    gp->ti_drift = 8;
+    gp->initialised = 1;
+#endif
+  }
+
+  e.max_active_bin = 1;
+  const int active_stride[2] = {1, 5};
+  for (int k = 0; k < 2; ++k) {
+
+    /* Reset the particles */
+    for (int n = 0; n < num_cloud; ++n) {
+      struct gpart *gp = &c.grav.parts[n];
+      gp->time_bin = (n % active_stride[k] == 0) ? 1 : 2;
+      gp->a_grav[0] = 0.f;
+      gp->a_grav[1] = 0.f;
+      gp->a_grav[2] = 0.f;
+      gp->potential = 0.f;
+    }
+
+    /* Now compute the forces */
+    runner_doself_grav_pp(&r, &c);
+
+    /* Verify everything against a direct summation */
+    for (int n = 0; n < num_cloud; ++n) {
+      const struct gpart *gp = &c.grav.parts[n];
+
+      /* The inactive particles must not have been touched */
+      if (gp->time_bin != 1) {
+        if (gp->a_grav[0] != 0.f || gp->a_grav[1] != 0.f ||
+            gp->a_grav[2] != 0.f || gp->potential != 0.f)
+          error("Inactive particle %d was updated!", n);
+        continue;
+      }
+
+      const double epsilon = gravity_get_softening(gp, &props);
+      double acc_true[3] = {0., 0., 0.}, pot_true = 0., norm = 0.;
+      for (int m = 0; m < num_cloud; ++m) {
+        if (m == n) continue;
+        const struct gpart *gpj = &c.grav.parts[m];
+        const double dx[3] = {gp->x[0] - gpj->x[0], gp->x[1] - gpj->x[1],
+                              gp->x[2] - gpj->x[2]};
+        const double r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+        const double r_ij = sqrt(r2);
+        const double acc = acceleration(gpj->mass, r_ij, epsilon, rlr) / r_ij;
+        acc_true[0] += acc * dx[0];
+        acc_true[1] += acc * dx[1];
+        acc_true[2] += acc * dx[2];
+        pot_true += potential(gpj->mass, r_ij, epsilon, rlr);
+        norm += fabs(acc) * r_ij;
+      }
+
+      /* Compare to the sum of the magnitudes to be immune to cancellations */
+      for (int d = 0; d < 3; ++d)
+        if (fabs(gp->a_grav[d] - acc_true[d]) > 1e-5 * norm)
+          error("Acceleration is inconsistent: %e %e (particle %d, axis %d)",
+                gp->a_grav[d], acc_true[d], n, d);
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+      if (fabs(gp->potential - pot_true) > 1e-5 * fabs(pot_true))
+        error("Potential is inconsistent: %e %e (particle %d)", gp->potential,
+              pot_true, n);
+#endif
+    }
+  }
+
   free(c.grav.parts);
 
   /* Clean up the caches */
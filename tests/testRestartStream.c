@@ -0,0 +1,137 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* System includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "../src/clocks.h"
+#include "../src/error.h"
+#include "../src/io_async_writer.h"
+#include "../src/restart_stream.h"
+#include "../src/threadpool.h"
+
+#define NUM_THREADS (4)
+#define FILENAME "testRestartStream.rst"
+
+/* Sizes of the blocks written, small ones around large ones. */
+static const size_t block_sizes[] = {
+    4,
+    29,
+    3 * RESTART_STREAM_RANGE_SIZE + 17,
+    8,
+    RESTART_STREAM_RANGE_SIZE,
+    1000000,
+    RESTART_STREAM_RANGE_SIZE - 5,
+    2 * RESTART_STREAM_RANGE_SIZE,
+    0,
+    12345};
+static const int nr_blocks = sizeof(block_sizes) / sizeof(size_t);
+
+/**
+ * @brief Write the blocks, read them back and compare.
+ *
+ * The blocks are read back in the pieces they were written in and, again,
+ * all at once.
+ */
+static void check_stream(struct threadpool *tp, const char *data,
+                         size_t total, int level, int async) {
+
+  struct io_async_writer writer;
+  if (async) io_async_writer_init(&writer, 16 * 1024 * 1024, /*verbose=*/1);
+
+  FILE *file = fopen(FILENAME, "w");
+  if (file == NULL) error("Could not create the test file.");
+  struct restart_stream rs;
+  restart_stream_write_begin(&rs, file, FILENAME, level, tp,
+                             async ? &writer : NULL);
+  size_t offset = 0;
+  for (int k = 0; k < nr_blocks; k++) {
+    restart_stream_write(&rs, data + offset, block_sizes[k]);
+    offset += block_sizes[k];
+  }
+  restart_stream_write_end(&rs, /*verbose=*/1);
+  fclose(file);
+  if (async) io_async_writer_clean(&writer);
+
+  char *check = (char *)malloc(total);
+  for (int all_at_once = 0; all_at_once < 2; all_at_once++) {
+    memset(check, 0, total);
+
+    file = fopen(FILENAME, "r");
+    if (file == NULL) error("Could not open the test file.");
+    if (!restart_stream_read_begin(&rs, file, FILENAME, tp))
+      error("The test file is not in the stream format.");
+
+    if (all_at_once) {
+      restart_stream_read(&rs, check, total, "all the blocks");
+    } else {
+      offset = 0;
+      for (int k = 0; k < nr_blocks; k++) {
+        restart_stream_read(&rs, check + offset, block_sizes[k], "a block");
+        offset += block_sizes[k];
+      }
+    }
+    restart_stream_read_end(&rs, /*verbose=*/1);
+    fclose(file);
+
+    if (memcmp(data, check, total) != 0)
+      error("Data read back does not match (level=%d, async=%d).", level,
+            async);
+  }
+  free(check);
+  remove(FILENAME);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  if (!restart_stream_is_supported()) {
+    message("Restart streams are not available in this build.");
+    return 0;
+  }
+
+  struct threadpool tp;
+  threadpool_init(&tp, NUM_THREADS);
+
+  size_t total = 0;
+  for (int k = 0; k < nr_blocks; k++) total += block_sizes[k];
+
+  /* Some compressible and some random data. */
+  char *data = (char *)malloc(total);
+  for (size_t i = 0; i < total; ++i)
+    data[i] = (i / 4096) % 2 ? (char)(i % 7) : (char)rand();
+
+  for (int level = 0; level < 2; level++)
+    for (int async = 0; async < 2; async++)
+      check_stream(&tp, data, total, level, async);
+
+  free(data);
+  threadpool_clean(&tp);
+
+  return 0;
+}
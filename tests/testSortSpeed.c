@@ -0,0 +1,410 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Some standard headers. */
+#include <config.h>
+
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Local headers. */
+#include "swift.h"
+
+/* Typical values of Scheduler:cell_split_size */
+#define num_split_sizes 6
+const int split_sizes[num_split_sizes] = {50, 100, 200, 400, 800, 1000};
+
+/**
+ * @brief Fill the 13 sort arrays of a random set of particles in a cell.
+ *
+ * @param sorts The 13 arrays of N + 1 entries.
+ * @param N The number of particles.
+ * @param loc The location of the cell.
+ * @param width The width of the cell.
+ */
+void fill_sorts(struct sort_entry *sorts, const int N, const double loc[3],
+                const double width) {
+
+  for (int k = 0; k < N; k++) {
+    const double x[3] = {loc[0] + width * random_uniform(0., 1.),
+                         loc[1] + width * random_uniform(0., 1.),
+                         loc[2] + width * random_uniform(0., 1.)};
+    for (int j = 0; j < 13; j++) {
+      struct sort_entry *entries = &sorts[j * (N + 1)];
+      entries[k].i = k;
+      entries[k].d = x[0] * runner_shift[j][0] + x[1] * runner_shift[j][1] +
+                     x[2] * runner_shift[j][2];
+    }
+  }
+  for (int j = 0; j < 13; j++) {
+    sorts[j * (N + 1) + N].d = FLT_MAX;
+    sorts[j * (N + 1) + N].i = 0;
+  }
+}
+
+/**
+ * @brief Check that an array is sorted and a permutation of the original.
+ */
+void check_sort(const struct sort_entry *sorted,
+                const struct sort_entry *original, const int N,
+                const char *name) {
+
+  char *seen = (char *)calloc(N, sizeof(char));
+  for (int k = 0; k < N; k++) {
+    if (k > 0 && sorted[k].d < sorted[k - 1].d)
+      error("%s: entries %d and %d not in order", name, k - 1, k);
+    const int i = sorted[k].i;
+    if (i < 0 || i >= N || seen[i]) error("%s: invalid index %d", name, i);
+    if (sorted[k].d != original[i].d) error("%s: distance mismatch", name);
+    seen[i] = 1;
+  }
+  if (sorted[N].d != FLT_MAX) error("%s: sentinel lost", name);
+  free(seen);
+}
+
+/**
+ * @brief Time the re-sorts of the particles of a cell after they have moved
+ * by up to a given fraction of the cell size.
+ *
+ * @param N The number of particles.
+ * @param runs The number of runs.
+ * @param drift The maximal displacement in units of the cell size.
+ * @param time_full (return) The time spent re-sorting from scratch.
+ * @param time_repair (return) The time spent repairing the previous order
+ * (and re-sorting from scratch if the repair gave up).
+ * @param inversions (return) The average number of inversions per entry.
+ * @param given_up (return) The fraction of repairs that gave up.
+ */
+void time_resorts(const int N, const int runs, const double drift,
+                  double *time_full, double *time_repair, double *inversions,
+                  double *given_up) {
+
+  double *x = (double *)malloc(3 * N * sizeof(double));
+  struct sort_entry *full =
+      (struct sort_entry *)malloc(13 * (N + 1) * sizeof(struct sort_entry));
+  struct sort_entry *repaired =
+      (struct sort_entry *)malloc(13 * (N + 1) * sizeof(struct sort_entry));
+  if (x == NULL || full == NULL || repaired == NULL)
+    error("Failed to allocate the sort arrays.");
+
+  const double width = 0.1;
+  *time_full = 0.;
+  *time_repair = 0.;
+  long long num_inversions = 0;
+  int num_given_up = 0;
+
+  for (int r = 0; r < runs; ++r) {
+
+    /* Sort a random set of particles */
+    for (int k = 0; k < 3 * N; k++) x[k] = width * random_uniform(0., 1.);
+    for (int j = 0; j < 13; j++) {
+      struct sort_entry *entries = &repaired[j * (N + 1)];
+      for (int k = 0; k < N; k++) {
+        entries[k].i = k;
+        entries[k].d = x[3 * k + 0] * runner_shift[j][0] +
+                       x[3 * k + 1] * runner_shift[j][1] +
+                       x[3 * k + 2] * runner_shift[j][2];
+      }
+      entries[N].d = FLT_MAX;
+      runner_do_sort_ascending_radix(entries, N);
+    }
+
+    /* Move them */
+    const double dx_max = drift * width / sqrt(3.);
+    for (int k = 0; k < 3 * N; k++) x[k] += random_uniform(-dx_max, dx_max);
+
+    /* Re-sort from scratch */
+    ticks tic = getticks();
+    for (int j = 0; j < 13; j++) {
+      struct sort_entry *entries = &full[j * (N + 1)];
+      for (int k = 0; k < N; k++) {
+        entries[k].i = k;
+        entries[k].d = x[3 * k + 0] * runner_shift[j][0] +
+                       x[3 * k + 1] * runner_shift[j][1] +
+                       x[3 * k + 2] * runner_shift[j][2];
+      }
+      entries[N].d = FLT_MAX;
+      runner_do_sort_ascending_radix(entries, N);
+    }
+    *time_full += clocks_from_ticks(getticks() - tic);
+
+    /* Keep the old order in the (no longer needed) full sorts */
+    memcpy(full, repaired, 13 * (N + 1) * sizeof(struct sort_entry));
+
+    /* Repair the previous order, as the leaf sorts do */
+    tic = getticks();
+    for (int j = 0; j < 13; j++) {
+      struct sort_entry *entries = &repaired[j * (N + 1)];
+      for (int k = 0; k < N; k++) {
+        const int i = entries[k].i;
+        entries[k].d = x[3 * i + 0] * runner_shift[j][0] +
+                       x[3 * i + 1] * runner_shift[j][1] +
+                       x[3 * i + 2] * runner_shift[j][2];
+      }
+      if (!sort_repair_ascending(entries, N,
+                                 sort_repair_max_moves_per_entry * N)) {
+        runner_do_sort_ascending_radix(entries, N);
+        num_given_up++;
+      }
+    }
+    *time_repair += clocks_from_ticks(getticks() - tic);
+
+    /* Count the inversions of the old order */
+    if (r == 0) {
+      for (int j = 0; j < 13; j++) {
+        struct sort_entry *entries = &full[j * (N + 1)];
+        for (int k = 0; k < N; k++) {
+          const int i = entries[k].i;
+          entries[k].d = x[3 * i + 0] * runner_shift[j][0] +
+                         x[3 * i + 1] * runner_shift[j][1] +
+                         x[3 * i + 2] * runner_shift[j][2];
+        }
+        for (int k = 0; k < N; k++)
+          for (int l = k + 1; l < N; l++)
+            num_inversions += entries[l].d < entries[k].d;
+      }
+    }
+
+    /* Check the result */
+    for (int j = 0; j < 13; j++) {
+      struct sort_entry *entries = &full[j * (N + 1)];
+      for (int k = 0; k < N; k++) {
+        entries[k].i = k;
+        entries[k].d = x[3 * k + 0] * runner_shift[j][0] +
+                       x[3 * k + 1] * runner_shift[j][1] +
+                       x[3 * k + 2] * runner_shift[j][2];
+      }
+      check_sort(&repaired[j * (N + 1)], entries, N, "repair");
+    }
+  }
+
+  *inversions = (double)num_inversions / (13. * N);
+  *given_up = (double)num_given_up / (13. * runs);
+
+  free(x);
+  free(full);
+  free(repaired);
+}
+
+/**
+ * @brief Merge 8 sorted lists by insertion into a sorted buffer of their
+ * heads. This is the merge previously used by runner_do_hydro_sort() and
+ * serves as a reference.
+ */
+void merge_insertion(struct sort_entry *out, const struct sort_entry *in[8],
+                     const int off[8], const int count) {
+
+  const struct sort_entry *fingers[8];
+  float buff[8];
+  int inds[8];
+  for (int k = 0; k < 8; k++) {
+    inds[k] = k;
+    fingers[k] = in[k];
+    buff[k] = fingers[k]->d;
+  }
+
+  for (int i = 0; i < 7; i++)
+    for (int k = i + 1; k < 8; k++)
+      if (buff[inds[k]] < buff[inds[i]]) {
+        int temp_i = inds[i];
+        inds[i] = inds[k];
+        inds[k] = temp_i;
+      }
+
+  for (int ind = 0; ind < count; ind++) {
+    out[ind].d = buff[inds[0]];
+    out[ind].i = fingers[inds[0]]->i + off[inds[0]];
+    fingers[inds[0]] += 1;
+    buff[inds[0]] = fingers[inds[0]]->d;
+    for (int k = 1; k < 8 && buff[inds[k]] < buff[inds[k - 1]]; k++) {
+      int temp_i = inds[k - 1];
+      inds[k - 1] = inds[k];
+      inds[k] = temp_i;
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FP-exceptions */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  int runs = 200;
+
+  int c;
+  while ((c = getopt(argc, argv, "r:")) != -1) {
+    switch (c) {
+      case 'r':
+        sscanf(optarg, "%d", &runs);
+        break;
+      case '?':
+        printf(
+            "\nUsage: %s [OPTIONS...]\n"
+            "\nTimes the sorts of the particles of a cell along the 13 axes "
+            "(leaf sorts) and the merges of the sorts of 8 progeny for a "
+            "range of cell sizes.\n\nOptions:"
+            "\n-r NR_RUNS      - Number of runs per cell size (default: 200)\n",
+            argv[0]);
+        exit(1);
+    }
+  }
+
+  srand(0);
+  const double loc[3] = {12.5, 3.25, 101.};
+
+  message("   N | qsort [sorts/s] | radix [sorts/s] | insert. merge [merges/s] "
+          "| loser tree [merges/s]");
+
+  for (int n = 0; n < num_split_sizes; ++n) {
+
+    const int N = split_sizes[n];
+    const size_t size = 13 * (N + 1) * sizeof(struct sort_entry);
+    struct sort_entry *original = (struct sort_entry *)malloc(size);
+    struct sort_entry *work = (struct sort_entry *)malloc(size);
+    struct sort_entry *merged = (struct sort_entry *)malloc(size);
+    if (original == NULL || work == NULL || merged == NULL)
+      error("Failed to allocate the sort arrays.");
+
+    /* Leaf sorts */
+    double time_qsort = 0., time_radix = 0.;
+    for (int r = 0; r < runs; ++r) {
+
+      fill_sorts(original, N, loc, 0.1);
+
+      memcpy(work, original, size);
+      ticks tic = getticks();
+      for (int j = 0; j < 13; j++)
+        runner_do_sort_ascending(&work[j * (N + 1)], N);
+      time_qsort += clocks_from_ticks(getticks() - tic);
+      if (r == 0)
+        for (int j = 0; j < 13; j++)
+          check_sort(&work[j * (N + 1)], &original[j * (N + 1)], N, "qsort");
+
+      memcpy(work, original, size);
+      tic = getticks();
+      for (int j = 0; j < 13; j++)
+        runner_do_sort_ascending_radix(&work[j * (N + 1)], N);
+      time_radix += clocks_from_ticks(getticks() - tic);
+      if (r == 0)
+        for (int j = 0; j < 13; j++)
+          check_sort(&work[j * (N + 1)], &original[j * (N + 1)], N, "radix");
+    }
+
+    /* Merges of 8 sorted progeny of (roughly) N / 8 particles each */
+    int counts[8], off[8];
+    for (int k = 0; k < 8; k++) counts[k] = N / 8 + (k < N % 8);
+    off[0] = 0;
+    for (int k = 1; k < 8; k++) off[k] = off[k - 1] + counts[k - 1];
+
+    struct sort_entry *progeny[8];
+    for (int k = 0; k < 8; k++)
+      progeny[k] = (struct sort_entry *)malloc(13 * (counts[k] + 1) *
+                                               sizeof(struct sort_entry));
+
+    double time_insert = 0., time_loser = 0.;
+    for (int r = 0; r < runs; ++r) {
+
+      /* Sorted progeny and the parent's entries they came from */
+      for (int k = 0; k < 8; k++) {
+        const double loc_k[3] = {loc[0] + 0.05 * ((k >> 2) & 1),
+                                 loc[1] + 0.05 * ((k >> 1) & 1),
+                                 loc[2] + 0.05 * (k & 1)};
+        fill_sorts(progeny[k], counts[k], loc_k, 0.05);
+        for (int j = 0; j < 13; j++) {
+          struct sort_entry *p = &progeny[k][j * (counts[k] + 1)];
+          for (int i = 0; i < counts[k]; i++) {
+            original[j * (N + 1) + off[k] + i].d = p[i].d;
+            original[j * (N + 1) + off[k] + i].i = off[k] + i;
+          }
+          runner_do_sort_ascending_radix(p, counts[k]);
+        }
+      }
+
+      const struct sort_entry *fingers[8];
+
+      ticks tic = getticks();
+      for (int j = 0; j < 13; j++) {
+        for (int k = 0; k < 8; k++)
+          fingers[k] = &progeny[k][j * (counts[k] + 1)];
+        merge_insertion(&work[j * (N + 1)], fingers, off, N);
+        work[j * (N + 1) + N].d = FLT_MAX;
+      }
+      time_insert += clocks_from_ticks(getticks() - tic);
+
+      tic = getticks();
+      for (int j = 0; j < 13; j++) {
+        for (int k = 0; k < 8; k++)
+          fingers[k] = &progeny[k][j * (counts[k] + 1)];
+        sort_merge_loser_tree(&merged[j * (N + 1)], fingers, off, N);
+        merged[j * (N + 1) + N].d = FLT_MAX;
+      }
+      time_loser += clocks_from_ticks(getticks() - tic);
+
+      if (r == 0)
+        for (int j = 0; j < 13; j++) {
+          check_sort(&merged[j * (N + 1)], &original[j * (N + 1)], N,
+                     "loser tree");
+          for (int i = 0; i < N; i++)
+            if (merged[j * (N + 1) + i].d != work[j * (N + 1) + i].d)
+              error("Merges differ at entry %d", i);
+        }
+    }
+
+    /* Times are in ms, report the number of full (13-axis) operations per
+     * second */
+    message("%4d | %15.0f | %15.0f | %24.0f | %21.0f", N,
+            1e3 * runs / time_qsort, 1e3 * runs / time_radix,
+            1e3 * runs / time_insert, 1e3 * runs / time_loser);
+
+    for (int k = 0; k < 8; k++) free(progeny[k]);
+    free(original);
+    free(work);
+    free(merged);
+  }
+
+  /* Re-sorts after a drift, up to the one triggering a re-sort */
+  message("   N | drift | full [sorts/s] | repair [sorts/s] | inversions per "
+          "entry | given up | repair used");
+  const double drifts[3] = {0.01, 0.03, space_maxreldx};
+  for (int n = 0; n < num_split_sizes; ++n) {
+    for (int d = 0; d < 3; ++d) {
+      double time_full, time_repair, inversions, given_up;
+      time_resorts(split_sizes[n], runs, drifts[d], &time_full, &time_repair,
+                   &inversions, &given_up);
+      /* The rms displacement is drift / sqrt(3) */
+      const int used = split_sizes[n] * drifts[d] / sqrt(3.) <
+                       sort_repair_max_displaced_entries;
+      message("%4d | %5.2f | %14.0f | %16.0f | %20.2f | %7.1f%% | %11s",
+              split_sizes[n], drifts[d], 1e3 * runs / time_full,
+              1e3 * runs / time_repair, inversions, 100. * given_up,
+              used ? "yes" : "no");
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,353 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#if defined(SPHENIX_SPH) && defined(HYDRO_VEC_DENSITY) && \
+    defined(HYDRO_VEC_FORCE)
+
+/* Number of cells along each axis */
+#define cdim 2
+
+/* Number of cells */
+#define num_cells (cdim * cdim * cdim)
+
+/* Cube root of the number of particles per cell */
+#define n_side 6
+
+/* Number of particles per cell */
+#define num_parts (n_side * n_side * n_side)
+
+/* Width of the cells */
+#define cell_size 1.
+
+/* The interaction loops, declared in runner_doiact_hydro.h */
+void runner_doself1_branch_density(struct runner *r, struct cell *c);
+void runner_dopair1_branch_density(struct runner *r, struct cell *ci,
+                                   struct cell *cj);
+void runner_doself2_branch_force(struct runner *r, struct cell *c);
+void runner_dopair2_branch_force(struct runner *r, struct cell *ci,
+                                 struct cell *cj);
+
+/**
+ * @brief Constructs a cell of randomly placed particles with varying
+ * smoothing lengths and a mix of active and inactive particles.
+ */
+static void make_cell(struct cell *c, const double offset[3],
+                      long long *partId) {
+
+  bzero(c, sizeof(struct cell));
+  if (posix_memalign((void **)&c->hydro.parts, part_align,
+                     num_parts * sizeof(struct part)) != 0)
+    error("Failed to allocate the particles.");
+  bzero(c->hydro.parts, num_parts * sizeof(struct part));
+
+  float h_max = 0.f;
+  for (int i = 0; i < num_parts; i++) {
+    struct part *p = &c->hydro.parts[i];
+    for (int k = 0; k < 3; k++) {
+      p->x[k] = offset[k] + random_uniform(0., cell_size);
+      p->v[k] = random_uniform(-0.05, 0.05);
+    }
+    p->h = 1.2348 * cell_size / n_side * random_uniform(1., 1.6);
+    p->mass = random_uniform(0.9, 1.1) / (num_cells * num_parts);
+    p->id = ++(*partId);
+    p->time_bin = (rand() % 3 == 0) ? 4 : 1;
+#ifdef SWIFT_DEBUG_CHECKS
+    p->ti_drift = 8;
+    p->ti_kick = 8;
+#endif
+    h_max = fmaxf(h_max, p->h);
+  }
+
+  c->split = 0;
+  c->hydro.h_max = h_max;
+  c->hydro.h_max_active = h_max;
+  c->hydro.count = num_parts;
+  for (int k = 0; k < 3; k++) {
+    c->width[k] = cell_size;
+    c->loc[k] = offset[k];
+  }
+  c->hydro.super = c;
+  c->hydro.ti_old_part = 8;
+  c->hydro.ti_end_min = 8;
+  c->nodeID = 0;
+}
+
+/**
+ * @brief Prepares the particles for a density loop.
+ */
+static void init_density(struct cell *c) {
+  for (int i = 0; i < c->hydro.count; i++) {
+    hydro_init_part(&c->hydro.parts[i], NULL);
+    mhd_init_part(&c->hydro.parts[i]);
+  }
+}
+
+/**
+ * @brief Gives the particles the fields read by the force loop.
+ */
+static void init_force(struct cell *c) {
+  for (int i = 0; i < c->hydro.count; i++) {
+    struct part *p = &c->hydro.parts[i];
+    p->rho = random_uniform(0.8, 1.2);
+    p->u = random_uniform(0.5, 1.5);
+    p->force.pressure = hydro_gamma_minus_one * p->rho * p->u;
+    p->force.soundspeed = sqrtf(hydro_gamma * p->force.pressure / p->rho);
+    p->force.f = random_uniform(-0.1, 0.1) * p->mass;
+    p->force.balsara = random_uniform(0., 1.);
+    p->viscosity.alpha = random_uniform(0.1, 2.);
+    p->diffusion.alpha = random_uniform(0., 1.);
+    p->a_hydro[0] = p->a_hydro[1] = p->a_hydro[2] = 0.f;
+    p->u_dt = 0.f;
+    p->force.h_dt = 0.f;
+    p->viscosity.v_sig = 0.f;
+  }
+}
+
+/**
+ * @brief Runs a loop over all the particles of all the cells, one at a time
+ * with the scalar interactions.
+ */
+static void brute_force(struct part *parts, const int count,
+                        const struct engine *e, const int force) {
+
+  const float a = e->cosmology->a;
+  const float H = e->cosmology->H;
+
+  for (int i = 0; i < count; i++) {
+    struct part *pi = &parts[i];
+    if (!part_is_active(pi, e)) continue;
+    const float hi = pi->h;
+
+    for (int j = 0; j < count; j++) {
+      if (i == j) continue;
+      const struct part *pj = &parts[j];
+      const float hj = pj->h;
+
+      float dx[3];
+      for (int k = 0; k < 3; k++) dx[k] = pi->x[k] - pj->x[k];
+      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+
+      if (!force && r2 < hi * hi * kernel_gamma2)
+        runner_iact_nonsym_density(r2, dx, hi, hj, pi, pj, a, H);
+      if (force && (r2 < hi * hi * kernel_gamma2 ||
+                    r2 < hj * hj * kernel_gamma2))
+        runner_iact_nonsym_force(r2, dx, hi, hj, pi, pj, a, H);
+    }
+  }
+}
+
+/**
+ * @brief Runs a loop over all the cells with the task functions.
+ */
+static void run_tasks(struct runner *r, struct cell *cells, const int force) {
+  for (int i = 0; i < num_cells; i++) {
+    if (force)
+      runner_doself2_branch_force(r, &cells[i]);
+    else
+      runner_doself1_branch_density(r, &cells[i]);
+    for (int j = i + 1; j < num_cells; j++) {
+      if (force)
+        runner_dopair2_branch_force(r, &cells[i], &cells[j]);
+      else
+        runner_dopair1_branch_density(r, &cells[i], &cells[j]);
+    }
+  }
+}
+
+/**
+ * @brief Compares one field of the particles to the scalar reference.
+ *
+ * @return The number of particles that differ by more than the tolerance.
+ */
+static int compare_field(const struct cell *cells, const struct part *ref,
+                         const size_t offset, const char *name) {
+
+  /* Scale of the field, for the values that sum to almost zero */
+  float scale = 0.f;
+  for (int i = 0; i < num_cells * num_parts; i++)
+    scale = fmaxf(scale, fabsf(*(float *)((char *)&ref[i] + offset)));
+
+  int num_wrong = 0;
+  for (int c = 0; c < num_cells; c++) {
+    for (int i = 0; i < num_parts; i++) {
+      const struct part *p = &cells[c].hydro.parts[i];
+      const struct part *p_ref = &ref[c * num_parts + i];
+      const float v = *(const float *)((const char *)p + offset);
+      const float v_ref = *(const float *)((const char *)p_ref + offset);
+      if (fabsf(v - v_ref) > 1e-4f * fabsf(v_ref) + 1e-5f * scale) {
+        if (num_wrong == 0)
+          message("%s of particle %lld: %e instead of %e", name, p->id, v,
+                  v_ref);
+        num_wrong++;
+      }
+    }
+  }
+  return num_wrong;
+}
+
+#define compare(field) \
+  compare_field(cells, ref, offsetof(struct part, field), #field)
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  message("Vector size: %d", VEC_SIZE);
+  message("Kernel: %s", kernel_name);
+
+  /* Build the infrastructure */
+  static struct space space;
+  space.periodic = 0;
+  for (int k = 0; k < 3; k++) space.dim[k] = cdim * cell_size;
+
+  struct hydro_props hp;
+  hydro_props_init_no_hydro(&hp);
+  hp.use_neighbour_lists = 0;
+
+  static struct engine engine;
+  engine.s = &space;
+  engine.time = 0.1f;
+  engine.ti_current = 8;
+  engine.time_base = 1e-5;
+  engine.max_active_bin = 2;
+  engine.hydro_properties = &hp;
+  engine.nodeID = 0;
+
+  struct phys_const prog_const;
+  prog_const.const_vacuum_permeability = 1.0;
+  engine.physical_constants = &prog_const;
+
+  struct cosmology cosmo;
+  cosmology_init_no_cosmo(&cosmo);
+  engine.cosmology = &cosmo;
+
+  struct sink_props sink_props;
+  bzero(&sink_props, sizeof(struct sink_props));
+  engine.sink_properties = &sink_props;
+
+  struct lightcone_array_props lightcone_array_properties;
+  lightcone_array_properties.nr_lightcones = 0;
+  engine.lightcone_array_properties = &lightcone_array_properties;
+
+  struct pressure_floor_props pressure_floor;
+  engine.pressure_floor_props = &pressure_floor;
+
+  static struct runner runner;
+  runner.e = &engine;
+  hydro_hot_cache_init(&runner.ci_hot_cache, 512);
+  hydro_hot_cache_init(&runner.cj_hot_cache, 512);
+
+  /* Construct the cells */
+  struct cell cells[num_cells];
+  long long partId = 0;
+  for (int c = 0; c < num_cells; c++) {
+    const double offset[3] = {(c / (cdim * cdim)) * cell_size,
+                              ((c / cdim) % cdim) * cell_size,
+                              (c % cdim) * cell_size};
+    make_cell(&cells[c], offset, &partId);
+    runner_do_drift_part(&runner, &cells[c], 0);
+    runner_do_hydro_sort(&runner, &cells[c], 0x1FFF, 0, 0, 0);
+  }
+
+  struct part *ref = NULL;
+  if (posix_memalign((void **)&ref, part_align,
+                     num_cells * num_parts * sizeof(struct part)) != 0)
+    error("Failed to allocate the reference particles.");
+
+  /* Density loop */
+  for (int c = 0; c < num_cells; c++) {
+    init_density(&cells[c]);
+    memcpy(&ref[c * num_parts], cells[c].hydro.parts,
+           num_parts * sizeof(struct part));
+  }
+  run_tasks(&runner, cells, /*force=*/0);
+  brute_force(ref, num_cells * num_parts, &engine, /*force=*/0);
+
+  int num_wrong = 0;
+  num_wrong += compare(rho);
+  num_wrong += compare(density.rho_dh);
+  num_wrong += compare(density.wcount);
+  num_wrong += compare(density.wcount_dh);
+  num_wrong += compare(viscosity.div_v);
+  num_wrong += compare(density.rot_v[0]);
+  num_wrong += compare(density.rot_v[1]);
+  num_wrong += compare(density.rot_v[2]);
+  if (num_wrong) error("The density loop differs from the scalar one.");
+  message("The density loop matches the scalar one.");
+
+  /* Force loop */
+  for (int c = 0; c < num_cells; c++) {
+    init_force(&cells[c]);
+    memcpy(&ref[c * num_parts], cells[c].hydro.parts,
+           num_parts * sizeof(struct part));
+  }
+  run_tasks(&runner, cells, /*force=*/1);
+  brute_force(ref, num_cells * num_parts, &engine, /*force=*/1);
+
+  num_wrong += compare(a_hydro[0]);
+  num_wrong += compare(a_hydro[1]);
+  num_wrong += compare(a_hydro[2]);
+  num_wrong += compare(u_dt);
+  num_wrong += compare(force.h_dt);
+  if (num_wrong) error("The force loop differs from the scalar one.");
+  message("The force loop matches the scalar one.");
+
+  /* Clean things to make the sanitizer happy ... */
+  for (int c = 0; c < num_cells; c++) {
+    free(cells[c].hydro.parts);
+    free(cells[c].hydro.sort);
+  }
+  free(ref);
+  hydro_hot_cache_clean(&runner.ci_hot_cache);
+  hydro_hot_cache_clean(&runner.cj_hot_cache);
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+  message("The hydro scheme has no lane-parallel interactions to test.");
+  return 0;
+}
+
+#endif
@@ -0,0 +1,300 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 the SWIFT collaboration.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "swift.h"
+
+#if defined(STARS_GEAR) && defined(STARS_VEC_DENSITY)
+
+/* Number of cells along each axis */
+#define cdim 2
+
+/* Number of cells */
+#define num_cells (cdim * cdim * cdim)
+
+/* Cube root of the number of gas particles per cell */
+#define n_side 6
+
+/* Number of gas particles per cell */
+#define num_parts (n_side * n_side * n_side)
+
+/* Number of star particles per cell */
+#define num_sparts 50
+
+/* Width of the cells */
+#define cell_size 1.
+
+/* The interaction loops, declared in runner_doiact_stars.h */
+void runner_doself_branch_stars_density(struct runner *r, struct cell *c);
+void runner_dopair_branch_stars_density(struct runner *r, struct cell *ci,
+                                        struct cell *cj);
+
+/**
+ * @brief Constructs a cell of randomly placed gas and stars, with varying
+ * smoothing lengths and a mix of active and inactive stars.
+ */
+static void make_cell(struct cell *c, const double offset[3],
+                      long long *partId) {
+
+  bzero(c, sizeof(struct cell));
+  if (posix_memalign((void **)&c->hydro.parts, part_align,
+                     num_parts * sizeof(struct part)) != 0 ||
+      posix_memalign((void **)&c->stars.parts, spart_align,
+                     num_sparts * sizeof(struct spart)) != 0)
+    error("Failed to allocate the particles.");
+  bzero(c->hydro.parts, num_parts * sizeof(struct part));
+  bzero(c->stars.parts, num_sparts * sizeof(struct spart));
+
+  float h_max = 0.f;
+  for (int i = 0; i < num_parts; i++) {
+    struct part *p = &c->hydro.parts[i];
+    for (int k = 0; k < 3; k++)
+      p->x[k] = offset[k] + random_uniform(0., cell_size);
+    p->h = 1.2348 * cell_size / n_side;
+    p->id = ++(*partId);
+    p->time_bin = 1;
+#ifdef SWIFT_DEBUG_CHECKS
+    p->ti_drift = 8;
+    p->ti_kick = 8;
+#endif
+    h_max = fmaxf(h_max, p->h);
+  }
+
+  float stars_h_max = 0.f;
+  for (int i = 0; i < num_sparts; i++) {
+    struct spart *sp = &c->stars.parts[i];
+    for (int k = 0; k < 3; k++)
+      sp->x[k] = offset[k] + random_uniform(0., cell_size);
+    sp->h = 1.2348 * cell_size / n_side * random_uniform(0.5, 1.6);
+    sp->id = ++(*partId);
+    sp->time_bin = (rand() % 3 == 0) ? 4 : 1;
+#ifdef SWIFT_DEBUG_CHECKS
+    sp->ti_drift = 8;
+    sp->ti_kick = 8;
+#endif
+    stars_h_max = fmaxf(stars_h_max, sp->h);
+  }
+
+  c->split = 0;
+  c->hydro.h_max = h_max;
+  c->hydro.count = num_parts;
+  c->stars.h_max = stars_h_max;
+  c->stars.h_max_active = stars_h_max;
+  c->stars.count = num_sparts;
+  for (int k = 0; k < 3; k++) {
+    c->width[k] = cell_size;
+    c->loc[k] = offset[k];
+  }
+  c->hydro.super = c;
+  c->stars.ti_old_part = 8;
+  c->stars.ti_end_min = 8;
+  c->hydro.ti_old_part = 8;
+  c->hydro.ti_end_min = 8;
+  c->grav.ti_old_part = 8;
+  c->grav.ti_end_min = 8;
+  c->nodeID = 0;
+}
+
+/**
+ * @brief Runs the density loop over all the stars and all the gas of all the
+ * cells, one pair at a time with the scalar interaction.
+ */
+static void brute_force(struct cell *cells, struct spart *sparts,
+                        const struct engine *e) {
+
+  const float a = e->cosmology->a;
+  const float H = e->cosmology->H;
+
+  for (int i = 0; i < num_cells * num_sparts; i++) {
+    struct spart *si = &sparts[i];
+    if (!spart_is_active(si, e)) continue;
+    const float hi = si->h;
+
+    for (int c = 0; c < num_cells; c++) {
+      for (int j = 0; j < num_parts; j++) {
+        const struct part *pj = &cells[c].hydro.parts[j];
+
+        float dx[3];
+        for (int k = 0; k < 3; k++) dx[k] = si->x[k] - pj->x[k];
+        const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+
+        if (r2 < hi * hi * kernel_gamma2)
+          runner_iact_nonsym_stars_density(r2, dx, hi, pj->h, si, pj, a, H);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Compares one field of the stars to the scalar reference.
+ *
+ * @return The number of stars that differ by more than the tolerance.
+ */
+static int compare_field(const struct cell *cells, const struct spart *ref,
+                         const size_t offset, const char *name) {
+
+  /* Scale of the field, for the values that sum to almost zero */
+  float scale = 0.f;
+  for (int i = 0; i < num_cells * num_sparts; i++)
+    scale = fmaxf(scale, fabsf(*(float *)((char *)&ref[i] + offset)));
+
+  int num_wrong = 0;
+  for (int c = 0; c < num_cells; c++) {
+    for (int i = 0; i < num_sparts; i++) {
+      const struct spart *sp = &cells[c].stars.parts[i];
+      const struct spart *sp_ref = &ref[c * num_sparts + i];
+      const float v = *(const float *)((const char *)sp + offset);
+      const float v_ref = *(const float *)((const char *)sp_ref + offset);
+      if (fabsf(v - v_ref) > 1e-4f * fabsf(v_ref) + 1e-5f * scale) {
+        if (num_wrong == 0)
+          message("%s of star %lld: %e instead of %e", name, sp->id, v, v_ref);
+        num_wrong++;
+      }
+    }
+  }
+  return num_wrong;
+}
+
+#define compare(field) \
+  compare_field(cells, ref, offsetof(struct spart, field), #field)
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+/* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  message("Vector size: %d", VEC_SIZE);
+  message("Kernel: %s", kernel_name);
+
+  /* Build the infrastructure */
+  static struct space space;
+  space.periodic = 0;
+  for (int k = 0; k < 3; k++) space.dim[k] = cdim * cell_size;
+
+  struct hydro_props hp;
+  hydro_props_init_no_hydro(&hp);
+
+  struct stars_props stars_p;
+  bzero(&stars_p, sizeof(struct stars_props));
+
+  static struct engine engine;
+  engine.s = &space;
+  engine.time = 0.1f;
+  engine.ti_current = 8;
+  engine.max_active_bin = 2;
+  engine.hydro_properties = &hp;
+  engine.stars_properties = &stars_p;
+  engine.nodeID = 0;
+
+  struct cosmology cosmo;
+  cosmology_init_no_cosmo(&cosmo);
+  engine.cosmology = &cosmo;
+
+  struct lightcone_array_props lightcone_array_properties;
+  lightcone_array_properties.nr_lightcones = 0;
+  engine.lightcone_array_properties = &lightcone_array_properties;
+
+  static struct runner runner;
+  runner.e = &engine;
+  hydro_hot_cache_init(&runner.ci_hot_cache, 512);
+  hydro_hot_cache_init(&runner.cj_hot_cache, 512);
+
+  /* Construct the cells */
+  struct cell cells[num_cells];
+  long long partId = 0;
+  for (int c = 0; c < num_cells; c++) {
+    const double offset[3] = {(c / (cdim * cdim)) * cell_size,
+                              ((c / cdim) % cdim) * cell_size,
+                              (c % cdim) * cell_size};
+    make_cell(&cells[c], offset, &partId);
+    runner_do_drift_part(&runner, &cells[c], 0);
+    runner_do_drift_spart(&runner, &cells[c], 0);
+    runner_do_hydro_sort(&runner, &cells[c], 0x1FFF, 0, 0, 0);
+    runner_do_stars_sort(&runner, &cells[c], 0x1FFF, 0, 0);
+  }
+
+  /* Prepare the stars and a copy of them for the reference */
+  struct spart *ref = NULL;
+  if (posix_memalign((void **)&ref, spart_align,
+                     num_cells * num_sparts * sizeof(struct spart)) != 0)
+    error("Failed to allocate the reference particles.");
+  for (int c = 0; c < num_cells; c++) {
+    for (int i = 0; i < num_sparts; i++)
+      stars_init_spart(&cells[c].stars.parts[i]);
+    memcpy(&ref[c * num_sparts], cells[c].stars.parts,
+           num_sparts * sizeof(struct spart));
+  }
+
+  /* Run all the self and pair tasks... */
+  for (int i = 0; i < num_cells; i++) {
+    runner_doself_branch_stars_density(&runner, &cells[i]);
+    for (int j = i + 1; j < num_cells; j++)
+      runner_dopair_branch_stars_density(&runner, &cells[i], &cells[j]);
+  }
+
+  /* ...and compare them to the scalar loop. */
+  brute_force(cells, ref, &engine);
+
+  int num_wrong = 0;
+  num_wrong += compare(density.wcount);
+  num_wrong += compare(density.wcount_dh);
+  if (num_wrong) error("The density loop differs from the scalar one.");
+  message("The density loop matches the scalar one.");
+
+  /* Clean things to make the sanitizer happy ... */
+  for (int c = 0; c < num_cells; c++) {
+    free(cells[c].hydro.parts);
+    free(cells[c].stars.parts);
+    free(cells[c].hydro.sort);
+    free(cells[c].stars.sort);
+  }
+  free(ref);
+  hydro_hot_cache_clean(&runner.ci_hot_cache);
+  hydro_hot_cache_clean(&runner.cj_hot_cache);
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[]) {
+  message("The stellar model has no lane-parallel interactions to test.");
+  return 0;
+}
+
+#endif